@@ -458,6 +458,8 @@ class Memb(steps_swig.Memb):
             more than 3 neighbours. Specify optimization method with opt_method (default = 1): 
             1 = principal axis ordering (quick to set up but usually results in slower simulation than method 2). 
             2 = breadth first search (can be time-consuming to set up, but usually faster simulation), 
+            3 = reverse Cuthill-McKee (fast to set up, bandwidth comparable to method 2),
+            4 = nested dissection (for the sparse EField solvers, e.g. EF_DV_PCG),
             If a filename (with full path) is given in optional argument opt_file_name the membrane optimization will be loaded from file,
             which was saved previously for this membrane with solver method steps.solver.Tetexact.saveMembOpt()
             
@@ -67,6 +67,7 @@ EF_DEFAULT = steps_swig.EF_DEFAULT
 EF_DV_BDSYS = steps_swig.EF_DV_BDSYS
 EF_DV_SLUSYS = steps_swig.EF_DV_SLUSYS
 EF_DV_PETSC = steps_swig.EF_DV_PETSC
+EF_DV_DIST = steps_swig.EF_DV_DIST
 
 # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
 # Well-mixed RK4
@@ -14,6 +14,70 @@ def castToTmComp(_py_Comp base):
 def castToTmPatch(_py_Patch base):
     return _py_TmPatch.from_ptr( <TmPatch*>(base.ptr()) )
 
+def _py_partitionTets(_py_Tetmesh mesh, unsigned int nparts, std.vector[double] tet_weights=(), std.vector[double] tri_weights=(), double max_imbalance=1.03):
+    """
+    Partition the tetrahedrons of a mesh into nparts parts by multilevel
+    k-way partitioning of its dual graph, keeping the part weights within
+    max_imbalance times the mean and the weight of the cut triangles low.
+    The tetrahedrons on both sides of a patch triangle share a part.
+
+    Syntax::
+
+        partitionTets(mesh, nparts, tet_weights=[], tri_weights=[], max_imbalance=1.03)
+
+    Arguments:
+        * steps.geom.Tetmesh mesh
+        * uint nparts
+        * list<float> tet_weights (weight of every tetrahedron, 1 if empty)
+        * list<float> tri_weights (cost of cutting every triangle, 1 if empty)
+        * float max_imbalance
+
+    Return:
+        list<uint>, the part of every tetrahedron, e.g. tet_hosts of TetOpSplit.
+    """
+    return partitionTets(mesh.ptrx(), nparts, tet_weights, tri_weights, max_imbalance)
+
+def _py_partitionTris(_py_Tetmesh mesh, std.vector[unsigned int] tet_parts):
+    """
+    Get the part of every patch triangle of a mesh, the part of its
+    neighbouring tetrahedrons, given the part of every tetrahedron.
+
+    Syntax::
+
+        partitionTris(mesh, tet_parts)
+
+    Arguments:
+        * steps.geom.Tetmesh mesh
+        * list<uint> tet_parts
+
+    Return:
+        dict{uint: uint}, e.g. tri_hosts of TetOpSplit.
+    """
+    return partitionTris(mesh.ptrx(), tet_parts)
+
+def _py_partitionWeights(_py_Tetmesh mesh, _py_Model model, std.vector[double] tet_rates=()):
+    """
+    Get tetrahedron and triangle weights for partitionTets: the number of
+    kinetic processes of every tetrahedron, plus its relative expected
+    event rate if tet_rates is given, and the diffusion flux coefficient
+    of every triangle relative to the mean.
+
+    Syntax::
+
+        partitionWeights(mesh, model, tet_rates=[])
+
+    Arguments:
+        * steps.geom.Tetmesh mesh
+        * steps.model.Model model
+        * list<float> tet_rates
+
+    Return:
+        (list<float>, list<float>), the tetrahedron and triangle weights.
+    """
+    cdef std.vector[double] tet_weights, tri_weights
+    partitionWeights(mesh.ptrx(), model.ptr(), tet_weights, tri_weights, tet_rates)
+    return tet_weights, tri_weights
+
 
 # ----------------------------------------------------------------------------------------------------------------------
 cdef class _py_Geom(_py__base):
@@ -600,6 +664,32 @@ cdef class _py_Memb(_py__base):
         return <Memb*> self._ptr
 
     def __init__(self, std.string id, _py_Tetmesh container, list patches, bool verify=False, unsigned int opt_method=1, double search_percent=100.0, std.string opt_file_name=""):
+        """
+        Construct a Memb object with identifier string id over the triangles
+        of all TmPatches in patches. If verify is True, warn if the membrane
+        is an open surface or if a triangle has more than 3 neighbours.
+
+        The EField vertices are ordered by opt_method:
+            1 = principal axis ordering (quick to set up, usually slower to simulate than 2),
+            2 = breadth first search from search_percent of the vertices (slow to set up),
+            3 = reverse Cuthill-McKee (fast to set up, bandwidth comparable to 2),
+            4 = nested dissection (for the sparse EField solvers, e.g. EF_DV_PCG).
+        If opt_file_name is given, the ordering is loaded from a file saved
+        for this membrane with saveMembOpt() instead.
+
+        Syntax::
+
+            Memb(id, container, patches, verify=False, opt_method=1, search_percent=100.0, opt_file_name='')
+
+        Arguments:
+            * string id
+            * steps.geom.Tetmesh container
+            * list<steps.geom.TmPatch> patches
+            * bool verify
+            * uint opt_method
+            * float search_percent
+            * string opt_file_name
+        """
         cdef std.vector[TmPatch*] _patches
         for elem in patches:
             _patches.push_back( (<_py_TmPatch>elem).ptrx() )
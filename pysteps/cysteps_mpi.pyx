@@ -27,12 +27,12 @@ cdef class _py_TetOpSplitP(_py_API):
     cdef TetOpSplitP *ptrx(self):
         return <TetOpSplitP*> self._ptr
 
-    def __init__(self, _py_Model model, _py_Geom geom, _py_RNG rng, int calcMembPot=0, std.vector[uint] tet_hosts = [], dict tri_hosts = {}, std.vector[uint] wm_hosts = []):
+    def __init__(self, _py_Model model, _py_Geom geom, _py_RNG rng, int calcMembPot=0, std.vector[uint] tet_hosts = [], dict tri_hosts = {}, std.vector[uint] wm_hosts = [], bool distribute_elems = False):
         cdef std.map[uint, uint] _tri_hosts
         for key, elem in tri_hosts.items():
             _tri_hosts[key] = elem
         # We constructed a map. Now call constructor
-        self._ptr = new TetOpSplitP(model.ptr(), geom.ptr(), rng.ptr(), calcMembPot, tet_hosts, _tri_hosts, wm_hosts)
+        self._ptr = new TetOpSplitP(model.ptr(), geom.ptr(), rng.ptr(), calcMembPot, tet_hosts, _tri_hosts, wm_hosts, distribute_elems)
 
     def getSolverName(self, ):
         return self.ptrx().getSolverName()
@@ -70,6 +70,18 @@ cdef class _py_TetOpSplitP(_py_API):
     def efdt(self, ):
         return self.ptrx().efdt()
 
+    def setEfieldAdaptive(self, bool adaptive, double dtmin, double dtmax, double errtol):
+        self.ptrx().setEfieldAdaptive(adaptive, dtmin, dtmax, errtol)
+
+    def getEfieldAdaptive(self, ):
+        return self.ptrx().getEfieldAdaptive()
+
+    def getEfieldNStepsWithinTolerance(self, ):
+        return self.ptrx().getEfieldNStepsWithinTolerance()
+
+    def getEfieldNStepsOverTolerance(self, ):
+        return self.ptrx().getEfieldNStepsOverTolerance()
+
     def setTemp(self, double t):
         self.ptrx().setTemp(t)
 
@@ -155,6 +167,45 @@ cdef class _py_TetOpSplitP(_py_API):
     def sumBatchTriOhmicIsNP(self, uint[:] tri_array, std.string ghk):
         return self.ptrx().sumBatchTriOhmicIsNP(&tri_array[0], tri_array.shape[0], ghk)
 
+    def setBatchTetCountsNP(self, uint[:] index_array, std.string s, double[:] values):
+        self.ptrx().setBatchTetCountsNP(&index_array[0], index_array.shape[0], s, &values[0], values.shape[0])
+
+    def setBatchTriCountsNP(self, uint[:] index_array, std.string s, double[:] values):
+        self.ptrx().setBatchTriCountsNP(&index_array[0], index_array.shape[0], s, &values[0], values.shape[0])
+
+    # Reaction and surface reaction accessors. Each call takes a single
+    # collective step regardless of the number of elements. Active flags
+    # are given as uint8 arrays.
+    def getBatchTetReacKNP(self, uint[:] index_array, std.string r, double[:] values):
+        self.ptrx().getBatchTetReacKNP(&index_array[0], index_array.shape[0], r, &values[0], values.shape[0])
+
+    def setBatchTetReacKNP(self, uint[:] index_array, std.string r, double[:] values):
+        self.ptrx().setBatchTetReacKNP(&index_array[0], index_array.shape[0], r, &values[0], values.shape[0])
+
+    def getBatchTetReacActiveNP(self, uint[:] index_array, std.string r, unsigned char[:] values):
+        self.ptrx().getBatchTetReacActiveNP(&index_array[0], index_array.shape[0], r, &values[0], values.shape[0])
+
+    def setBatchTetReacActiveNP(self, uint[:] index_array, std.string r, unsigned char[:] values):
+        self.ptrx().setBatchTetReacActiveNP(&index_array[0], index_array.shape[0], r, &values[0], values.shape[0])
+
+    def getBatchTetReacANP(self, uint[:] index_array, std.string r, double[:] values):
+        self.ptrx().getBatchTetReacANP(&index_array[0], index_array.shape[0], r, &values[0], values.shape[0])
+
+    def getBatchTriSReacKNP(self, uint[:] index_array, std.string sr, double[:] values):
+        self.ptrx().getBatchTriSReacKNP(&index_array[0], index_array.shape[0], sr, &values[0], values.shape[0])
+
+    def setBatchTriSReacKNP(self, uint[:] index_array, std.string sr, double[:] values):
+        self.ptrx().setBatchTriSReacKNP(&index_array[0], index_array.shape[0], sr, &values[0], values.shape[0])
+
+    def getBatchTriSReacActiveNP(self, uint[:] index_array, std.string sr, unsigned char[:] values):
+        self.ptrx().getBatchTriSReacActiveNP(&index_array[0], index_array.shape[0], sr, &values[0], values.shape[0])
+
+    def setBatchTriSReacActiveNP(self, uint[:] index_array, std.string sr, unsigned char[:] values):
+        self.ptrx().setBatchTriSReacActiveNP(&index_array[0], index_array.shape[0], sr, &values[0], values.shape[0])
+
+    def getBatchTriSReacANP(self, uint[:] index_array, std.string sr, double[:] values):
+        self.ptrx().getBatchTriSReacANP(&index_array[0], index_array.shape[0], sr, &values[0], values.shape[0])
+
     # ---------------------------------------------------------------------------------
     # ROI section
     # ---------------------------------------------------------------------------------
@@ -246,6 +297,15 @@ cdef class _py_TetOpSplitP(_py_API):
     def getWMVolHostRank(self, unsigned int idx):
         return self.ptrx().getWMVolHostRank(idx)
 
+    def getDistributedElems(self, ):
+        return self.ptrx().getDistributedElems()
+
+    def countLocalTets(self, ):
+        return self.ptrx().countLocalTets()
+
+    def countLocalTris(self, ):
+        return self.ptrx().countLocalTris()
+
     def addNeighHost(self, int host):
         self.ptrx().addNeighHost(host)
 
@@ -270,6 +330,12 @@ cdef class _py_TetOpSplitP(_py_API):
     def getUpdPeriod(self, ):
         return self.ptrx().getUpdPeriod()
 
+    def setUpdPeriodLevels(self, uint nlevels):
+        self.ptrx().setUpdPeriodLevels(nlevels)
+
+    def getUpdPeriodLevels(self, ):
+        return self.ptrx().getUpdPeriodLevels()
+
     def getCompTime(self, ):
         return self.ptrx().getCompTime()
 
@@ -288,11 +354,68 @@ cdef class _py_TetOpSplitP(_py_API):
     def getDataExchangeTime(self, ):
         return self.ptrx().getDataExchangeTime()
 
+    def setProfiling(self, bool enabled):
+        self.ptrx().setProfiling(enabled)
+
+    def getProfiling(self, ):
+        return self.ptrx().getProfiling()
+
+    def resetProfile(self, ):
+        self.ptrx().resetProfile()
+
+    def getProfile(self, bool local=False):
+        return self.ptrx().getProfile(local)
+
+    def countProfileRows(self, ):
+        return self.ptrx().countProfileRows()
+
+    def getProfileNP(self, double[:] table, bool local=False):
+        self.ptrx().getProfileNP(&table[0], table.shape[0], local)
+
     def repartitionAndReset(self, std.vector[uint] tet_hosts=(), dict tri_hosts=None, std.vector[uint] wm_hosts=()):
         if tri_hosts is None: tri_hosts = {}
         cdef std.map[uint, uint] _tri_hosts = tri_hosts
         self.ptrx().repartitionAndReset(tet_hosts, _tri_hosts, wm_hosts)
 
+    def setRebalancePeriods(self, uint nperiods):
+        self.ptrx().setRebalancePeriods(nperiods)
+
+    def getRebalancePeriods(self, ):
+        return self.ptrx().getRebalancePeriods()
+
+    def setRebalanceThreshold(self, double max_imbalance):
+        self.ptrx().setRebalanceThreshold(max_imbalance)
+
+    def getRebalanceThreshold(self, ):
+        return self.ptrx().getRebalanceThreshold()
+
+    def rebalance(self, ):
+        return self.ptrx().rebalance()
+
+    def getNRebalanceChecks(self, ):
+        return self.ptrx().getNRebalanceChecks()
+
+    def addTetRecording(self, std.vector[uint] tets, std.vector[std.string] specs):
+        return self.ptrx().addTetRecording(tets, specs)
+
+    def addTriRecording(self, std.vector[uint] tris, std.vector[std.string] specs):
+        return self.ptrx().addTriRecording(tris, specs)
+
+    def addROIRecording(self, std.string ROI_id, std.vector[std.string] specs):
+        return self.ptrx().addROIRecording(ROI_id, specs)
+
+    def startRecording(self, std.string file_name, uint chunk_size=64, bool compress=False):
+        self.ptrx().startRecording(file_name, chunk_size, compress)
+
+    def record(self, ):
+        self.ptrx().record()
+
+    def stopRecording(self, ):
+        self.ptrx().stopRecording()
+
+    def getRecording(self, ):
+        return self.ptrx().getRecording()
+
 
     @staticmethod
     cdef _py_TetOpSplitP from_ptr(TetOpSplitP *ptr):
@@ -208,6 +208,9 @@ cdef class _py_Tetexact(_py_API):
     def checkpoint(self, std.string file_name):
         self.ptrx().checkpoint(file_name)
 
+    def checkpointLegacy(self, std.string file_name):
+        self.ptrx().checkpointLegacy(file_name)
+
     def restore(self, std.string file_name):
         self.ptrx().restore(file_name)
 
@@ -217,6 +220,24 @@ cdef class _py_Tetexact(_py_API):
     def efdt(self, ):
         return self.ptrx().efdt()
 
+    def setEfieldVTolerance(self, double tol):
+        self.ptrx().setEfieldVTolerance(tol)
+
+    def getEfieldVTolerance(self, ):
+        return self.ptrx().getEfieldVTolerance()
+
+    def setEfieldAdaptive(self, bool adaptive, double dtmin, double dtmax, double errtol):
+        self.ptrx().setEfieldAdaptive(adaptive, dtmin, dtmax, errtol)
+
+    def getEfieldAdaptive(self, ):
+        return self.ptrx().getEfieldAdaptive()
+
+    def getEfieldNStepsWithinTolerance(self, ):
+        return self.ptrx().getEfieldNStepsWithinTolerance()
+
+    def getEfieldNStepsOverTolerance(self, ):
+        return self.ptrx().getEfieldNStepsOverTolerance()
+
     def setTemp(self, double t):
         self.ptrx().setTemp(t)
 
@@ -226,12 +247,72 @@ cdef class _py_Tetexact(_py_API):
     def saveMembOpt(self, std.string opt_file_name):
         self.ptrx().saveMembOpt(opt_file_name)
 
+    def setNumDomains(self, unsigned int ndomains):
+        self.ptrx().setNumDomains(ndomains)
+
+    def setTetDomains(self, std.vector[unsigned int] domains):
+        self.ptrx().setTetDomains(domains)
+
+    def getNumDomains(self, ):
+        return self.ptrx().getNumDomains()
+
+    def getTetDomains(self, ):
+        return self.ptrx().getTetDomains()
+
+    def setProfiling(self, bool enabled):
+        self.ptrx().setProfiling(enabled)
+
+    def getProfiling(self, ):
+        return self.ptrx().getProfiling()
+
+    def resetProfile(self, ):
+        self.ptrx().resetProfile()
+
+    def getProfile(self, ):
+        return self.ptrx().getProfile()
+
+    def countProfileRows(self, ):
+        return self.ptrx().countProfileRows()
+
+    def getProfileNP(self, double[:] table):
+        self.ptrx().getProfileNP(&table[0], table.shape[0])
+
+    def setTauLeaping(self, bool enabled):
+        self.ptrx().setTauLeaping(enabled)
+
+    def getTauLeaping(self, ):
+        return self.ptrx().getTauLeaping()
+
+    def setTauLeapEpsilon(self, double eps):
+        self.ptrx().setTauLeapEpsilon(eps)
+
+    def getTauLeapEpsilon(self, ):
+        return self.ptrx().getTauLeapEpsilon()
+
+    def setTauLeapCriticalCount(self, unsigned int n):
+        self.ptrx().setTauLeapCriticalCount(n)
+
+    def getTauLeapCriticalCount(self, ):
+        return self.ptrx().getTauLeapCriticalCount()
+
+    def getNLeapedEvents(self, ):
+        return self.ptrx().getNLeapedEvents()
+
+    def getNExactEvents(self, ):
+        return self.ptrx().getNExactEvents()
+
     def getTime(self, ):
         return self.ptrx().getTime()
 
     def getA0(self, ):
         return self.ptrx().getA0()
 
+    def setA0RecomputeInterval(self, unsigned int nupdates):
+        self.ptrx().setA0RecomputeInterval(nupdates)
+
+    def getA0RecomputeInterval(self, ):
+        return self.ptrx().getA0RecomputeInterval()
+
     def getNSteps(self, ):
         return self.ptrx().getNSteps()
 
@@ -334,6 +415,18 @@ cdef class _py_TetODE(_py_API):
     def nefverts(self, ):
         return self.ptrx().nefverts()
 
+    def setEfieldAdaptive(self, bool adaptive, double dtmin, double dtmax, double errtol):
+        self.ptrx().setEfieldAdaptive(adaptive, dtmin, dtmax, errtol)
+
+    def getEfieldAdaptive(self, ):
+        return self.ptrx().getEfieldAdaptive()
+
+    def getEfieldNStepsWithinTolerance(self, ):
+        return self.ptrx().getEfieldNStepsWithinTolerance()
+
+    def getEfieldNStepsOverTolerance(self, ):
+        return self.ptrx().getEfieldNStepsOverTolerance()
+
     @staticmethod
     cdef _py_TetODE from_ptr(TetODE *ptr):
         cdef _py_TetODE obj = _py_TetODE.__new__(_py_TetODE)
@@ -363,6 +456,9 @@ cdef class _py_API(_py__base):
     EF_DV_BDSYS  = steps_solver.EF_DV_BDSYS
     EF_DV_SLUSYS = steps_solver.EF_DV_SLUSYS
     EF_DV_PETSC  = steps_solver.EF_DV_PETSC
+    EF_DV_DIST   = steps_solver.EF_DV_DIST
+    EF_DV_PCG    = steps_solver.EF_DV_PCG
+    EF_DV_CONDENSED = steps_solver.EF_DV_CONDENSED
 
     cdef API *ptr(self):
         return <API*> self._ptr
@@ -25,6 +25,9 @@
 from steps import stepslib
 castToTmComp = stepslib.castToTmComp
 castToTmPatch = stepslib.castToTmPatch
+partitionTets = stepslib._py_partitionTets
+partitionTris = stepslib._py_partitionTris
+partitionWeights = stepslib._py_partitionWeights
 
 class Geom(stepslib._py_Geom): pass
 class Comp(stepslib._py_Comp): pass
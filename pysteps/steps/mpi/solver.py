@@ -49,6 +49,9 @@ EF_DEFAULT = stepslib._py_API.EF_DEFAULT
 EF_DV_BDSYS = stepslib._py_API.EF_DV_BDSYS
 EF_DV_SLUSYS = stepslib._py_API.EF_DV_SLUSYS
 EF_DV_PETSC  = stepslib._py_API.EF_DV_PETSC
+EF_DV_DIST   = stepslib._py_API.EF_DV_DIST
+EF_DV_PCG    = stepslib._py_API.EF_DV_PCG
+EF_DV_CONDENSED = stepslib._py_API.EF_DV_CONDENSED
 
 # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
 # Tetrahedral Direct SSA
@@ -123,6 +123,37 @@ def linearPartition(mesh, partition_info):
 
 ################################################################################
 
+def graphPartition(mesh, nparts, model = None, tet_rates = [], max_imbalance = 1.03):
+    """
+    Partition the mesh by multilevel k-way partitioning of its tetrahedron
+    graph, which cuts far fewer triangles than binning along the axes.
+    
+    Parameters:
+        * mesh                STEPS Tetmesh object
+        * nparts              Number of partitions
+        * model               STEPS Model object (Optional); if given, tetrahedrons are weighted by
+                              their number of kinetic processes and triangles by their diffusion flux
+        * tet_rates           Expected event rate of every tetrahedron (Optional, requires model)
+        * max_imbalance       Largest partition weight allowed, relative to the mean
+    
+    Return:
+        (tet_partitions, tri_partitions) for parallel TetOpsplit solver
+    """
+    import steps.geom as sgeom
+    tet_weights = []
+    tri_weights = []
+    if model != None:
+        tet_weights, tri_weights = sgeom.partitionWeights(mesh, model, tet_rates)
+    tet_partitions = sgeom.partitionTets(mesh, nparts, tet_weights, tri_weights, max_imbalance)
+    tri_partitions = sgeom.partitionTris(mesh, tet_partitions)
+    return tet_partitions, tri_partitions
+
+################################################################################
+
+# # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # # #
+
+################################################################################
+
 def partitionTris(mesh, tet_partitions, tri_list):
     """
     Partition trangles according to partitioning information of their attached tetrahedrons.
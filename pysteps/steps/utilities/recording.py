@@ -0,0 +1,154 @@
+####################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+###
+
+"""
+Reader of the recordings written by TetOpSplitP.startRecording().
+
+Example::
+
+    rec = Recording("counts.rec")
+    times = rec.times
+    counts = rec.getSelection(0)    # samples x elements x species
+"""
+
+import struct
+import numpy
+
+REC_MAGIC = b'\x89STEPSRC'
+REC_FLAG_DELTA_VARINT = 0x01
+REC_ELEM_KINDS = {0: 'tet', 1: 'tri'}
+
+################################################################################
+
+def _decodeVarintDeltas(buf, n):
+    """Decode n zigzag varint differences into the counts they encode."""
+    values = numpy.zeros(n)
+    last = 0
+    pos = 0
+    for s in range(n):
+        z = 0
+        shift = 0
+        while True:
+            b = buf[pos]
+            pos += 1
+            z |= (b & 0x7f) << shift
+            shift += 7
+            if b < 0x80:
+                break
+        last += (z >> 1) ^ -(z & 1)
+        values[s] = last
+    return values
+
+################################################################################
+
+class Recording(object):
+    """
+    A recording file, read completely on construction.
+
+    Attributes:
+        * selections    List of dictionaries with the 'kind' ('tet' or
+                        'tri'), 'elems' and 'specs' of every selection
+        * times         Sample times
+    """
+    def __init__(self, file_name):
+        with open(file_name, 'rb') as f:
+            data = f.read()
+        self._data = bytearray(data)
+
+        magic, version, byte_order, flags, nsels, ncols, offset = \
+            struct.unpack_from('<8sIIIIQQ', data, 0)
+        if magic != REC_MAGIC:
+            raise IOError("%s is not a STEPS recording." % file_name)
+        if byte_order != 0x01020304:
+            raise IOError("%s was written with a different byte order." % file_name)
+        if version != 1:
+            raise IOError("Unsupported recording version %d." % version)
+        self._compressed = (flags & REC_FLAG_DELTA_VARINT) != 0
+        self._ncols = ncols
+
+        # Selection table
+        self.selections = []
+        self._firstcol = []
+        pos = struct.calcsize('<8sIIIIQQ')
+        col = 0
+        for i in range(nsels):
+            kind, nspecs, nelems = struct.unpack_from('<IIQ', data, pos)
+            pos += 16
+            elems = numpy.frombuffer(data, numpy.uint32, nelems, pos)
+            pos += 4 * nelems
+            specs = []
+            for s in range(nspecs):
+                end = data.index(b'\0', pos)
+                specs.append(data[pos:end].decode())
+                pos = end + 1
+            pos = (pos + 7) & ~7
+            self.selections.append({'kind': REC_ELEM_KINDS[kind], 'elems': elems, 'specs': specs})
+            self._firstcol.append(col)
+            col += nelems * nspecs
+
+        # Chunk layout
+        self._chunks = []
+        times = []
+        pos = offset
+        while pos < len(data):
+            nsamples, size = struct.unpack_from('<QQ', data, pos)
+            pos += 16
+            times.append(numpy.frombuffer(data, numpy.float64, nsamples, pos))
+            pos += 8 * nsamples
+            index = numpy.frombuffer(data, numpy.uint64, 2 * ncols, pos).reshape(ncols, 2)
+            pos += 16 * ncols
+            self._chunks.append((nsamples, pos, index))
+            pos += size
+        if len(times) != 0:
+            self.times = numpy.concatenate(times)
+        else:
+            self.times = numpy.zeros(0)
+
+    def getColumn(self, col):
+        """Return all samples of column col of the file."""
+        parts = []
+        for nsamples, start, index in self._chunks:
+            offset, size = int(index[col, 0]), int(index[col, 1])
+            if self._compressed:
+                parts.append(_decodeVarintDeltas(self._data[start + offset:start + offset + size], nsamples))
+            else:
+                parts.append(numpy.frombuffer(self._data, numpy.float64, nsamples, start + offset))
+        if len(parts) == 0:
+            return numpy.zeros(0)
+        return numpy.concatenate(parts)
+
+    def getSelection(self, sel):
+        """
+        Return the counts of selection sel as an array of
+        samples x elements x species.
+        """
+        s = self.selections[sel]
+        nelems = len(s['elems'])
+        nspecs = len(s['specs'])
+        first = self._firstcol[sel]
+        counts = numpy.zeros((len(self.times), nelems, nspecs))
+        for e in range(nelems):
+            for sp in range(nspecs):
+                counts[:, e, sp] = self.getColumn(first + e * nspecs + sp)
+        return counts
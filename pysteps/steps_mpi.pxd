@@ -331,7 +331,7 @@ cdef extern from "steps/mpi/tetopsplit/tetopsplit.hpp" namespace "steps::mpi::te
 
     ###### Cybinding for TetOpSplitP ######
     cdef cppclass TetOpSplitP:
-        TetOpSplitP(steps_model.Model*, steps_wm.Geom*, steps_rng.RNG*, int, std.vector[unsigned int], std.map[unsigned int,unsigned int], std.vector[unsigned int])
+        TetOpSplitP(steps_model.Model*, steps_wm.Geom*, steps_rng.RNG*, int, std.vector[unsigned int], std.map[unsigned int,unsigned int], std.vector[unsigned int], bool)
         std.string getSolverName()
         std.string getSolverDesc()
         std.string getSolverAuthors()
@@ -344,6 +344,10 @@ cdef extern from "steps/mpi/tetopsplit/tetopsplit.hpp" namespace "steps::mpi::te
         void restore(std.string)
         void setEfieldDT(double)
         double efdt()
+        void setEfieldAdaptive(bool, double, double, double)
+        bool getEfieldAdaptive()
+        unsigned long getEfieldNStepsWithinTolerance()
+        unsigned long getEfieldNStepsOverTolerance()
         void setTemp(double)
         double getTemp()
         void saveMembOpt(std.string)
@@ -372,6 +376,18 @@ cdef extern from "steps/mpi/tetopsplit/tetopsplit.hpp" namespace "steps::mpi::te
         double sumBatchTriCountsNP(unsigned int*, int, std.string)
         double sumBatchTriGHKIsNP(unsigned int*, int, std.string)
         double sumBatchTriOhmicIsNP(unsigned int*, int, std.string)
+        void setBatchTetCountsNP(unsigned int*, int, std.string, double*, int) except +
+        void setBatchTriCountsNP(unsigned int*, int, std.string, double*, int) except +
+        void getBatchTetReacKNP(unsigned int*, int, std.string, double*, int) except +
+        void setBatchTetReacKNP(unsigned int*, int, std.string, double*, int) except +
+        void getBatchTetReacActiveNP(unsigned int*, int, std.string, unsigned char*, int) except +
+        void setBatchTetReacActiveNP(unsigned int*, int, std.string, unsigned char*, int) except +
+        void getBatchTetReacANP(unsigned int*, int, std.string, double*, int) except +
+        void getBatchTriSReacKNP(unsigned int*, int, std.string, double*, int) except +
+        void setBatchTriSReacKNP(unsigned int*, int, std.string, double*, int) except +
+        void getBatchTriSReacActiveNP(unsigned int*, int, std.string, unsigned char*, int) except +
+        void setBatchTriSReacActiveNP(unsigned int*, int, std.string, unsigned char*, int) except +
+        void getBatchTriSReacANP(unsigned int*, int, std.string, double*, int) except +
         std.vector[double] getROITetCounts(std.string, std.string)
         std.vector[double] getROITriCounts(std.string, std.string)
 #         void getROITetCountsNP(std.string, std.string, double*, int)
@@ -401,6 +417,9 @@ cdef extern from "steps/mpi/tetopsplit/tetopsplit.hpp" namespace "steps::mpi::te
         unsigned int getTetHostRank(unsigned int)
         unsigned int getTriHostRank(unsigned int)
         unsigned int getWMVolHostRank(unsigned int)
+        bool getDistributedElems()
+        unsigned int countLocalTets()
+        unsigned int countLocalTris()
         void addNeighHost(int)
         #void registerRemoteChange(SubVolType, unsigned int, unsigned int, int)
         double getReacExtent(bool)
@@ -410,10 +429,31 @@ cdef extern from "steps/mpi/tetopsplit/tetopsplit.hpp" namespace "steps::mpi::te
         double getSyncTime()
         double getIdleTime()
         double getUpdPeriod()
+        void setUpdPeriodLevels(unsigned int)
+        unsigned int getUpdPeriodLevels()
         double getEFieldTime()
         double getRDTime()
         double getDataExchangeTime()
+        void setProfiling(bool)
+        bool getProfiling()
+        void resetProfile()
+        std.vector[steps_solver.KProcProfileRow] getProfile(bool)
+        unsigned int countProfileRows()
+        void getProfileNP(double*, int, bool)
         void repartitionAndReset(std.vector[unsigned int],std.map[unsigned int, unsigned int], std.vector[unsigned int])
+        void setRebalancePeriods(unsigned int)
+        unsigned int getRebalancePeriods()
+        void setRebalanceThreshold(double)
+        double getRebalanceThreshold()
+        bool rebalance()
+        unsigned long getNRebalanceChecks()
+        unsigned int addTetRecording(std.vector[unsigned int], std.vector[std.string])
+        unsigned int addTriRecording(std.vector[unsigned int], std.vector[std.string])
+        unsigned int addROIRecording(std.string, std.vector[std.string])
+        void startRecording(std.string, unsigned int, bool)
+        void record()
+        void stopRecording()
+        bool getRecording()
 
 
 # # ======================================================================================================================
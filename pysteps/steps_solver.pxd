@@ -607,6 +607,9 @@ cdef extern from "steps/solver/api.hpp" namespace "steps::solver::API":
         EF_DV_BDSYS
         EF_DV_SLUSYS
         EF_DV_PETSC
+        EF_DV_DIST
+        EF_DV_PCG
+        EF_DV_CONDENSED
 
 # ======================================================================================================================
 cdef extern from "steps/solver/api.hpp" namespace "steps::solver":
@@ -792,3 +795,15 @@ cdef extern from "steps/solver/api.hpp" namespace "steps::solver":
         void resetROISReacExtent(std.string, std.string)
         unsigned int getROIDiffExtent(std.string, std.string)
         void resetROIDiffExtent(std.string, std.string)
+
+# ======================================================================================================================
+cdef extern from "steps/solver/kprocprofile.hpp" namespace "steps::solver":
+# ----------------------------------------------------------------------------------------------------------------------
+    cdef struct KProcProfileRow:
+        unsigned int type
+        unsigned int rule
+        unsigned int container
+        unsigned long nevents
+        unsigned long napplies
+        unsigned long nupdates
+        double time
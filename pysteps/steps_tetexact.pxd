@@ -6,6 +6,7 @@
 __copyright__ = "Copyright 2016 EPFL BBP-project"
 # =====================================================================================================================
 from cython.operator cimport dereference as deref
+from libcpp cimport bool
 cimport std
 cimport steps_solver
 cimport steps_model
@@ -22,13 +23,12 @@ cdef extern from "steps/tetexact/vdeptrans.hpp" namespace "steps::tetexact":
         TEVDepTrans(steps_solver.VDepTransdef*, TETri*)
         # void checkpoint(std.fstream)
         # void restore(std.fstream)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/diff.hpp" namespace "steps::tetexact":
@@ -43,13 +43,12 @@ cdef extern from "steps/tetexact/diff.hpp" namespace "steps::tetexact":
         # double dcst(int)
         # void setDcst(double)
         # void setDirectionDcst(int, double)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
         # void setDiffBndActive(unsigned int, bool)
         # bool getDiffBndActive(unsigned int)
 
@@ -72,7 +71,7 @@ cdef extern from "steps/tetexact/kproc.hpp" namespace "steps::tetexact":
         # unsigned int flags()
         # unsigned int schedIDX()
         # void setSchedIDX(unsigned int)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
@@ -80,8 +79,7 @@ cdef extern from "steps/tetexact/kproc.hpp" namespace "steps::tetexact":
         # double rate(Tetexact*)
         # double c()
         # double h()
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
         # unsigned int getExtent()
         # void resetExtent()
 
@@ -142,9 +140,9 @@ cdef extern from "steps/tetexact/crstruct.hpp" namespace "steps::tetexact":
         CRGroup(int, unsigned int)
         void free_indices()
 
-    ###### Cybinding for CRKProcData ######
-    cdef cppclass CRKProcData:
-        CRKProcData()
+    ###### Cybinding for CRKProcTable ######
+    cdef cppclass CRKProcTable:
+        CRKProcTable()
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/sdiff.hpp" namespace "steps::tetexact":
@@ -159,13 +157,12 @@ cdef extern from "steps/tetexact/sdiff.hpp" namespace "steps::tetexact":
         # double dcst(int)
         # void setDcst(double)
         # void setDirectionDcst(int, double)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()        
+        # unsigned int apply(steps.rng.RNG*, double, double)
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/tetexact.hpp" namespace "steps::tetexact":
@@ -190,14 +187,41 @@ cdef extern from "steps/tetexact/tetexact.hpp" namespace "steps::tetexact":
         void advance(double)
         void step()
         void checkpoint(std.string)
+        void checkpointLegacy(std.string)
         void restore(std.string)
         void setEfieldDT(double)
         double efdt()
+        void setEfieldVTolerance(double)
+        double getEfieldVTolerance()
+        void setEfieldAdaptive(bool, double, double, double)
+        bool getEfieldAdaptive()
+        unsigned long getEfieldNStepsWithinTolerance()
+        unsigned long getEfieldNStepsOverTolerance()
         void setTemp(double)
         double getTemp()
         void saveMembOpt(std.string)
+        void setNumDomains(unsigned int)
+        void setTetDomains(std.vector[unsigned int])
+        unsigned int getNumDomains()
+        std.vector[unsigned int] getTetDomains()
+        void setProfiling(bool)
+        bool getProfiling()
+        void resetProfile()
+        std.vector[steps_solver.KProcProfileRow] getProfile()
+        unsigned int countProfileRows()
+        void getProfileNP(double*, int)
+        void setTauLeaping(bool)
+        bool getTauLeaping()
+        void setTauLeapEpsilon(double)
+        double getTauLeapEpsilon()
+        void setTauLeapCriticalCount(unsigned int)
+        unsigned int getTauLeapCriticalCount()
+        unsigned long getNLeapedEvents()
+        unsigned long getNExactEvents()
         double getTime()
         double getA0()
+        void setA0RecomputeInterval(unsigned int)
+        unsigned int getA0RecomputeInterval()
         unsigned int getNSteps()
         void setTime(double)
         void setNSteps(unsigned int)
@@ -282,13 +306,12 @@ cdef extern from "steps/tetexact/vdepsreac.hpp" namespace "steps::tetexact":
         TEVDepSReac(steps_solver.VDepSReacdef*, TETri*)
         # void checkpoint(std.fstream)
         # void restore(std.fstream)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/reac.hpp" namespace "steps::tetexact":
@@ -304,13 +327,12 @@ cdef extern from "steps/tetexact/reac.hpp" namespace "steps::tetexact":
         # double kcst()
         # void setKcst(double)
         # double h()
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/sreac.hpp" namespace "steps::tetexact":
@@ -326,13 +348,12 @@ cdef extern from "steps/tetexact/sreac.hpp" namespace "steps::tetexact":
         # double kcst()
         # void setKcst(double)
         # double h()
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
-        # unsigned int updVecSize()
+        # unsigned int apply(steps.rng.RNG*, double, double)
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/wmvol.hpp" namespace "steps::tetexact":
@@ -378,15 +399,14 @@ cdef extern from "steps/tetexact/ghkcurr.hpp" namespace "steps::tetexact":
         TEGHKcurr(steps_solver.GHKcurrdef*, TETri*)
         # void checkpoint(std.fstream)
         # void restore(std.fstream)
-        # void setupDeps()
+        # void setupDeps(std.vector[std.vector[unsigned int]]&)
         # bool depSpecTet(unsigned int, WmVol*)
         # bool depSpecTri(unsigned int, Tri*)
         # void reset()
         # double rate(Tetexact*)
-        # std.vector[TEKProc*] apply(steps.rng.RNG*, double, double)
+        # unsigned int apply(steps.rng.RNG*, double, double)
         # bool efflux()
         # void setEffFlux(bool)
-        # unsigned int updVecSize()
 
 # ======================================================================================================================
 cdef extern from "steps/tetexact/patch.hpp" namespace "steps::tetexact":
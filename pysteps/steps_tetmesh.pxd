@@ -9,6 +9,7 @@ from cython.operator cimport dereference as deref
 from libcpp cimport bool
 cimport std
 cimport steps_wm
+cimport steps_model
 
 # ======================================================================================================================
 cdef extern from "steps/geom/tmpatch.hpp" namespace "steps::tetmesh":
@@ -203,3 +204,16 @@ cdef extern from "steps/geom/tetmesh.hpp" namespace "steps::tetmesh":
         double getROIArea(std.string)
         void reduceROITetPointCountsNP(std.string, unsigned int*, int, double)
         void reduceROITriPointCountsNP(std.string, unsigned int*, int, double)
+
+
+# ======================================================================================================================
+cdef extern from "steps/geom/tetmesh_partition.hpp" namespace "steps::tetmesh":
+# ----------------------------------------------------------------------------------------------------------------------
+    # Partition the tets of a mesh into nparts parts by multilevel k-way graph partitioning.
+    std.vector[unsigned int] partitionTets(Tetmesh*, unsigned int, std.vector[double], std.vector[double], double)
+
+    # Part of every patch tri, given the part of every tet.
+    std.map[unsigned int, unsigned int] partitionTris(Tetmesh*, std.vector[unsigned int])
+
+    # Tet and tri weights for partitionTets derived from a model.
+    void partitionWeights(Tetmesh*, steps_model.Model*, std.vector[double]&, std.vector[double]&, std.vector[double])
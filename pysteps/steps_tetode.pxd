@@ -75,6 +75,10 @@ cdef extern from "steps/tetode/tetode.hpp" namespace "steps::tetode":
         unsigned int neftets()
         unsigned int neftris()
         unsigned int nefverts()
+        void setEfieldAdaptive(bool, double, double, double)
+        bool getEfieldAdaptive()
+        unsigned long getEfieldNStepsWithinTolerance()
+        unsigned long getEfieldNStepsOverTolerance()
 
 # ======================================================================================================================
 cdef extern from "steps/tetode/tet.hpp" namespace "steps::tetode":
@@ -70,8 +70,8 @@ stetmesh::Memb::Memb(std::string const & id, Tetmesh * container,
     if (patches.size() == 0)
         throw ArgErr("No Patches provided to Membrane initializer function.");
 
-    if (pOpt_method != 1 && pOpt_method != 2)
-        throw ArgErr("Unknown optimization method. Choices are 1 or 2.");
+    if (pOpt_method < 1 || pOpt_method > 4)
+        throw ArgErr("Unknown optimization method. Choices are 1, 2, 3 or 4.");
 
     if (pSearch_percent > 100.0)
         throw ArgErr("Search percentage is greater than 100.");
@@ -633,6 +633,16 @@ std::vector<uint>  stetmesh::Tetmesh::getTet(uint tidx) const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+steps::util::hash_type stetmesh::Tetmesh::fingerprint(void) const
+{
+    steps::util::hash_type h = steps::util::fnv1a(pVertsN, pTrisN, pTetsN);
+    for (uint t = 0; t < pTetsN; ++t) h = steps::util::fnv1a_combine(h, pTets[t]);
+    for (uint t = 0; t < pTrisN; ++t) h = steps::util::fnv1a_combine(h, pTris[t]);
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double stetmesh::Tetmesh::getMeshVolume() const
 {
     return std::accumulate(pTet_vols.begin(),pTet_vols.end(),0.0);
@@ -38,6 +38,7 @@
 #include "steps/geom/memb.hpp"
 #include "steps/geom/diffboundary.hpp"
 #include "steps/geom/sdiffboundary.hpp"
+#include "steps/util/fnv_hash.hpp"
 
 // STL headers
 #include <vector>
@@ -333,6 +334,10 @@ public:
     inline uint countTets(void) const
     { return pTetsN; }
 
+    /// Hash of the vertex indices of all tetrahedrons and triangles,
+    /// identifying the mesh in checkpoints.
+    steps::util::hash_type fingerprint(void) const;
+
     /// Return the volume of a tetrahedron by its index.
     ///
     /// \param tidx Index of the tetrahedron.
@@ -0,0 +1,596 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/geom/tetmesh.hpp"
+#include "steps/geom/tetmesh_partition.hpp"
+#include "steps/geom/tmcomp.hpp"
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/diff.hpp"
+#include "steps/model/model.hpp"
+#include "steps/model/surfsys.hpp"
+#include "steps/model/volsys.hpp"
+
+namespace stetmesh = steps::tetmesh;
+
+using steps::tetmesh::Tetmesh;
+using steps::tetmesh::TmComp;
+using steps::tetmesh::TmPatch;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const uint NO_VERTEX = std::numeric_limits<uint>::max();
+
+// Coarsening stops at this many vertices per part, or when a level
+// shrinks the graph by less than COARSEN_MIN_SHRINK.
+const uint COARSEN_VERTICES_PER_PART = 30;
+const double COARSEN_MIN_SHRINK = 0.95;
+
+// Seeds tried for every bisection of the coarsest graph, and refinement
+// passes on every level.
+const uint BISECT_TRIALS = 4;
+const uint REFINE_PASSES = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Undirected graph with weighted vertices and edges in compressed rows.
+struct Graph
+{
+    std::vector<uint>                   xadj;
+    std::vector<uint>                   adj;
+    std::vector<double>                 ewgt;
+    std::vector<double>                 vwgt;
+
+    uint size(void) const
+    { return vwgt.size(); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Deterministic permutation of 0..n-1, independent of the standard
+// library implementation.
+std::vector<uint> permutation(uint n, uint seed)
+{
+    std::vector<uint> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    uint64_t x = 0x9e3779b97f4a7c15ULL ^ seed;
+    for (uint i = n; i > 1; --i)
+    {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::swap(perm[i - 1], perm[(x >> 33) % i]);
+    }
+    return perm;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Merge every vertex with the unmatched neighbour it shares the heaviest
+// edge with, as long as the merged vertex stays below max_vwgt. Returns
+// the coarse graph and the coarse vertex of every vertex in cmap.
+void coarsen(Graph const & g, double max_vwgt, uint seed, Graph & c, std::vector<uint> & cmap)
+{
+    uint n = g.size();
+    std::vector<uint> match(n, NO_VERTEX);
+    for (uint v: permutation(n, seed))
+    {
+        if (match[v] != NO_VERTEX) continue;
+        uint best = v;
+        double best_w = -1.0;
+        for (uint e = g.xadj[v]; e < g.xadj[v + 1]; ++e)
+        {
+            uint u = g.adj[e];
+            if (match[u] != NO_VERTEX || g.vwgt[v] + g.vwgt[u] > max_vwgt) continue;
+            if (g.ewgt[e] > best_w)
+            {
+                best = u;
+                best_w = g.ewgt[e];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    cmap.assign(n, NO_VERTEX);
+    uint nc = 0;
+    for (uint v = 0; v < n; ++v)
+    {
+        if (cmap[v] != NO_VERTEX) continue;
+        cmap[v] = nc;
+        cmap[match[v]] = nc;
+        ++nc;
+    }
+
+    c.xadj.assign(1, 0);
+    c.adj.clear();
+    c.ewgt.clear();
+    c.vwgt.assign(nc, 0.0);
+    std::vector<uint> slot(nc, NO_VERTEX);
+    for (uint v = 0; v < n; ++v)
+    {
+        uint u = match[v];
+        if (u < v) continue;
+        uint cv = cmap[v];
+        uint row = c.adj.size();
+        c.vwgt[cv] = g.vwgt[v] + ((u != v) ? g.vwgt[u] : 0.0);
+        for (uint m: {v, u})
+        {
+            for (uint e = g.xadj[m]; e < g.xadj[m + 1]; ++e)
+            {
+                uint cu = cmap[g.adj[e]];
+                if (cu == cv) continue;
+                if (slot[cu] == NO_VERTEX || slot[cu] < row)
+                {
+                    slot[cu] = c.adj.size();
+                    c.adj.push_back(cu);
+                    c.ewgt.push_back(g.ewgt[e]);
+                }
+                else c.ewgt[slot[cu]] += g.ewgt[e];
+            }
+            if (u == v) break;
+        }
+        c.xadj.push_back(c.adj.size());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Grow a region of weight target within the vertices marked in_set from
+// seed, always adding the vertex most connected to the region. Returns
+// the weight of the edges cut.
+double grow(Graph const & g, std::vector<uint> const & verts, std::vector<char> const & in_set,
+            uint seed, double target, std::vector<char> & in_region)
+{
+    for (uint v: verts) in_region[v] = 0;
+
+    // gain: edges into the region minus edges to the rest of the set
+    std::vector<double> gain(g.size(), 0.0);
+    for (uint v: verts)
+    {
+        for (uint e = g.xadj[v]; e < g.xadj[v + 1]; ++e)
+            if (in_set[g.adj[e]]) gain[v] -= g.ewgt[e];
+    }
+
+    typedef std::pair<double, uint> Entry;
+    std::priority_queue<Entry> queue;
+    double weight = 0.0;
+    uint next_seed = 0;
+    queue.push(Entry(gain[seed], seed));
+    while (weight < target)
+    {
+        // start over elsewhere if the component of the seed is used up
+        while (queue.empty() && next_seed < verts.size())
+        {
+            uint v = verts[next_seed++];
+            if (!in_region[v]) queue.push(Entry(gain[v], v));
+        }
+        if (queue.empty()) break;
+
+        Entry top = queue.top();
+        queue.pop();
+        uint v = top.second;
+        if (in_region[v] || top.first != gain[v]) continue;
+
+        in_region[v] = 1;
+        weight += g.vwgt[v];
+        for (uint e = g.xadj[v]; e < g.xadj[v + 1]; ++e)
+        {
+            uint u = g.adj[e];
+            if (!in_set[u] || in_region[u]) continue;
+            gain[u] += 2.0 * g.ewgt[e];
+            queue.push(Entry(gain[u], u));
+        }
+    }
+
+    double cut = 0.0;
+    for (uint v: verts)
+    {
+        if (!in_region[v]) continue;
+        for (uint e = g.xadj[v]; e < g.xadj[v + 1]; ++e)
+            if (in_set[g.adj[e]] && !in_region[g.adj[e]]) cut += g.ewgt[e];
+    }
+    return cut;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Split verts into parts first_part .. first_part + nparts - 1 by
+// recursive bisection.
+void bisect(Graph const & g, std::vector<uint> const & verts, uint first_part, uint nparts,
+            std::vector<uint> & part, std::vector<char> & in_set)
+{
+    if (nparts == 1 || verts.empty())
+    {
+        for (uint v: verts) part[v] = first_part;
+        return;
+    }
+
+    uint nleft = nparts / 2;
+    double total = 0.0;
+    for (uint v: verts) total += g.vwgt[v];
+    double target = total * nleft / nparts;
+
+    for (uint v: verts) in_set[v] = 1;
+    std::vector<char> region(g.size(), 0);
+    std::vector<char> best(g.size(), 0);
+    double best_cut = std::numeric_limits<double>::infinity();
+    for (uint trial = 0; trial < BISECT_TRIALS && trial < verts.size(); ++trial)
+    {
+        uint seed = verts[(static_cast<uint64_t>(trial) * verts.size()) / BISECT_TRIALS];
+        double cut = grow(g, verts, in_set, seed, target, region);
+        if (cut < best_cut)
+        {
+            best_cut = cut;
+            for (uint v: verts) best[v] = region[v];
+        }
+    }
+    for (uint v: verts) in_set[v] = 0;
+
+    std::vector<uint> left, right;
+    for (uint v: verts) (best[v] ? left : right).push_back(v);
+    bisect(g, left, first_part, nleft, part, in_set);
+    bisect(g, right, first_part + nleft, nparts - nleft, part, in_set);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Move boundary vertices to the neighbouring part they are most connected
+// to while that cuts less and keeps the parts below max_pwgt, and move
+// vertices out of parts above max_pwgt regardless.
+void refine(Graph const & g, uint nparts, double max_pwgt, std::vector<uint> & part)
+{
+    uint n = g.size();
+    std::vector<double> pwgt(nparts, 0.0);
+    std::vector<uint> psize(nparts, 0);
+    for (uint v = 0; v < n; ++v)
+    {
+        pwgt[part[v]] += g.vwgt[v];
+        psize[part[v]]++;
+    }
+
+    std::vector<double> conn(nparts, 0.0);
+    std::vector<uint> touched;
+    for (uint pass = 0; pass < REFINE_PASSES; ++pass)
+    {
+        uint nmoved = 0;
+        for (uint v = 0; v < n; ++v)
+        {
+            uint from = part[v];
+            touched.clear();
+            for (uint e = g.xadj[v]; e < g.xadj[v + 1]; ++e)
+            {
+                uint p = part[g.adj[e]];
+                if (conn[p] == 0.0) touched.push_back(p);
+                conn[p] += g.ewgt[e] + std::numeric_limits<double>::min();
+            }
+            double internal = conn[from];
+            bool over = pwgt[from] > max_pwgt;
+
+            int to = -1;
+            for (uint p: touched)
+            {
+                if (p == from) continue;
+                bool fits = pwgt[p] + g.vwgt[v] <= max_pwgt;
+                if (!fits && !(over && pwgt[p] + g.vwgt[v] < pwgt[from])) continue;
+                if (to < 0 || conn[p] > conn[to] || (conn[p] == conn[to] && pwgt[p] < pwgt[to])) to = p;
+            }
+            double gain = (to < 0) ? 0.0 : conn[to] - internal;
+            for (uint p: touched) conn[p] = 0.0;
+            if (to < 0 || psize[from] == 1) continue;
+            if (!over && gain < 0.0) continue;
+            if (!over && gain == 0.0 && pwgt[to] + g.vwgt[v] >= pwgt[from]) continue;
+
+            part[v] = to;
+            pwgt[from] -= g.vwgt[v];
+            pwgt[to] += g.vwgt[v];
+            psize[from]--;
+            psize[to]++;
+            ++nmoved;
+        }
+        if (nmoved == 0) break;
+    }
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint> stetmesh::partitionTets(Tetmesh * mesh, uint nparts,
+                                          std::vector<double> const & tet_weights,
+                                          std::vector<double> const & tri_weights,
+                                          double max_imbalance)
+{
+    uint ntets = mesh->countTets();
+    uint ntris = mesh->countTris();
+    if (nparts == 0)
+    {
+        std::ostringstream os;
+        os << "Cannot partition a mesh into 0 parts.";
+        throw steps::ArgErr(os.str());
+    }
+    if (!tet_weights.empty() && tet_weights.size() != ntets)
+    {
+        std::ostringstream os;
+        os << "Expected " << ntets << " tetrahedron weights, got " << tet_weights.size() << ".";
+        throw steps::ArgErr(os.str());
+    }
+    if (!tri_weights.empty() && tri_weights.size() != ntris)
+    {
+        std::ostringstream os;
+        os << "Expected " << ntris << " triangle weights, got " << tri_weights.size() << ".";
+        throw steps::ArgErr(os.str());
+    }
+    if (max_imbalance < 1.0)
+    {
+        std::ostringstream os;
+        os << "Maximum imbalance " << max_imbalance << " is less than 1.";
+        throw steps::ArgErr(os.str());
+    }
+
+    // The tets on both sides of a patch tri become one vertex.
+    std::vector<uint> root(ntets);
+    std::iota(root.begin(), root.end(), 0);
+    auto find = [&root](uint t) {
+        while (root[t] != t)
+        {
+            root[t] = root[root[t]];
+            t = root[t];
+        }
+        return t;
+    };
+    for (uint tri = 0; tri < ntris; ++tri)
+    {
+        if (mesh->getTriPatch(tri) == 0) continue;
+        const int * tets = mesh->_getTriTetNeighb(tri);
+        if (tets[0] < 0 || tets[1] < 0) continue;
+        uint a = find(tets[0]);
+        uint b = find(tets[1]);
+        if (a != b) root[std::max(a, b)] = std::min(a, b);
+    }
+    std::vector<uint> vertex(ntets);
+    uint nverts = 0;
+    for (uint t = 0; t < ntets; ++t)
+        vertex[t] = (find(t) == t) ? nverts++ : vertex[find(t)];
+
+    // The tets of every vertex, in compressed rows.
+    std::vector<uint> first(nverts + 1, 0);
+    for (uint t = 0; t < ntets; ++t) first[vertex[t] + 1]++;
+    std::partial_sum(first.begin(), first.end(), first.begin());
+    std::vector<uint> members(ntets);
+    std::vector<uint> fill(first.begin(), first.end() - 1);
+    for (uint t = 0; t < ntets; ++t) members[fill[vertex[t]]++] = t;
+
+    // Dual graph, with the faces between two vertices as one edge.
+    std::vector<Graph> levels(1);
+    Graph & g = levels[0];
+    g.xadj.assign(1, 0);
+    g.vwgt.assign(nverts, 0.0);
+    std::vector<uint> slot(nverts, NO_VERTEX);
+    for (uint v = 0; v < nverts; ++v)
+    {
+        uint row = g.adj.size();
+        for (uint i = first[v]; i < first[v + 1]; ++i)
+        {
+            uint t = members[i];
+            g.vwgt[v] += tet_weights.empty() ? 1.0 : tet_weights[t];
+            const int * neighbs = mesh->_getTetTetNeighb(t);
+            const uint * tris = mesh->_getTetTriNeighb(t);
+            for (uint f = 0; f < 4; ++f)
+            {
+                if (neighbs[f] < 0) continue;
+                uint u = vertex[neighbs[f]];
+                if (u == v) continue;
+                double w = tri_weights.empty() ? 1.0 : tri_weights[tris[f]];
+                if (slot[u] == NO_VERTEX || slot[u] < row)
+                {
+                    slot[u] = g.adj.size();
+                    g.adj.push_back(u);
+                    g.ewgt.push_back(w);
+                }
+                else g.ewgt[slot[u]] += w;
+            }
+        }
+        g.xadj.push_back(g.adj.size());
+    }
+
+    double total = std::accumulate(g.vwgt.begin(), g.vwgt.end(), 0.0);
+    double max_pwgt = max_imbalance * total / nparts;
+
+    // Coarsen, keeping every vertex light enough for balanced parts.
+    uint coarsest = std::max(COARSEN_VERTICES_PER_PART * nparts, 1u);
+    double max_vwgt = 1.5 * total / coarsest;
+    std::vector<std::vector<uint> > cmaps;
+    while (levels.back().size() > coarsest)
+    {
+        Graph c;
+        std::vector<uint> cmap;
+        coarsen(levels.back(), max_vwgt, levels.size(), c, cmap);
+        if (c.size() > COARSEN_MIN_SHRINK * levels.back().size()) break;
+        levels.push_back(c);
+        cmaps.push_back(cmap);
+    }
+
+    // Split the coarsest graph and refine the parts on every level on the
+    // way back.
+    Graph const & cg = levels.back();
+    std::vector<uint> part(cg.size(), 0);
+    std::vector<uint> all(cg.size());
+    std::iota(all.begin(), all.end(), 0);
+    std::vector<char> in_set(cg.size(), 0);
+    bisect(cg, all, 0, nparts, part, in_set);
+    refine(cg, nparts, max_pwgt, part);
+    for (uint l = cmaps.size(); l-- > 0;)
+    {
+        std::vector<uint> fine(levels[l].size());
+        for (uint v = 0; v < fine.size(); ++v) fine[v] = part[cmaps[l][v]];
+        part.swap(fine);
+        refine(levels[l], nparts, max_pwgt, part);
+    }
+
+    std::vector<uint> tet_parts(ntets);
+    for (uint t = 0; t < ntets; ++t) tet_parts[t] = part[vertex[t]];
+    return tet_parts;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::map<uint, uint> stetmesh::partitionTris(Tetmesh * mesh, std::vector<uint> const & tet_parts)
+{
+    if (tet_parts.size() != mesh->countTets())
+    {
+        std::ostringstream os;
+        os << "Expected the part of " << mesh->countTets() << " tetrahedrons, got ";
+        os << tet_parts.size() << ".";
+        throw steps::ArgErr(os.str());
+    }
+
+    std::map<uint, uint> tri_parts;
+    uint ntris = mesh->countTris();
+    for (uint tri = 0; tri < ntris; ++tri)
+    {
+        if (mesh->getTriPatch(tri) == 0) continue;
+        const int * tets = mesh->_getTriTetNeighb(tri);
+        int tet = (tets[0] >= 0) ? tets[0] : tets[1];
+        if (tet >= 0) tri_parts[tri] = tet_parts[tet];
+    }
+    return tri_parts;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stetmesh::partitionWeights(Tetmesh * mesh, steps::model::Model * model,
+                                std::vector<double> & tet_weights, std::vector<double> & tri_weights,
+                                std::vector<double> const & tet_rates)
+{
+    uint ntets = mesh->countTets();
+    uint ntris = mesh->countTris();
+    if (!tet_rates.empty() && tet_rates.size() != ntets)
+    {
+        std::ostringstream os;
+        os << "Expected " << ntets << " tetrahedron rates, got " << tet_rates.size() << ".";
+        throw steps::ArgErr(os.str());
+    }
+
+    // Processes per tet of every compartment and per tri of every patch,
+    // and the summed diffusion constants of every compartment.
+    std::map<TmComp *, double> comp_kprocs;
+    std::map<TmComp *, double> comp_dcst;
+    for (auto c: mesh->getAllComps())
+    {
+        TmComp * comp = dynamic_cast<TmComp *>(c);
+        if (comp == 0) continue;
+        double & kprocs = comp_kprocs[comp];
+        double & dcst = comp_dcst[comp];
+        for (auto const & id: comp->getVolsys())
+        {
+            steps::model::Volsys * vsys = model->getVolsys(id);
+            kprocs += vsys->_countReacs() + vsys->_countDiffs();
+            for (auto const & diff: vsys->_getAllDiffs()) dcst += diff.second->getDcst();
+        }
+    }
+    std::map<TmPatch *, double> patch_kprocs;
+    for (auto p: mesh->getAllPatches())
+    {
+        TmPatch * patch = dynamic_cast<TmPatch *>(p);
+        if (patch == 0) continue;
+        double & kprocs = patch_kprocs[patch];
+        for (auto const & id: patch->getSurfsys())
+        {
+            steps::model::Surfsys * ssys = model->getSurfsys(id);
+            kprocs += ssys->_countSReacs() + ssys->_countDiffs() + ssys->_countVDepSReacs()
+                    + ssys->_countVDepTrans() + ssys->_countGHKcurrs();
+        }
+    }
+
+    tet_weights.assign(ntets, 0.0);
+    for (uint t = 0; t < ntets; ++t)
+    {
+        TmComp * comp = mesh->getTetComp(t);
+        if (comp != 0) tet_weights[t] = comp_kprocs[comp];
+    }
+    for (uint tri = 0; tri < ntris; ++tri)
+    {
+        TmPatch * patch = mesh->getTriPatch(tri);
+        if (patch == 0) continue;
+        const int * tets = mesh->_getTriTetNeighb(tri);
+        int tet = (tets[0] >= 0) ? tets[0] : tets[1];
+        if (tet >= 0) tet_weights[tet] += patch_kprocs[patch];
+    }
+
+    if (!tet_rates.empty())
+    {
+        double mean_kprocs = std::accumulate(tet_weights.begin(), tet_weights.end(), 0.0) / ntets;
+        double mean_rate = std::accumulate(tet_rates.begin(), tet_rates.end(), 0.0) / ntets;
+        if (mean_rate > 0.0)
+        {
+            for (uint t = 0; t < ntets; ++t)
+                tet_weights[t] += mean_kprocs * tet_rates[t] / mean_rate;
+        }
+    }
+
+    // Diffusion flux coefficients of the tris between two tets.
+    tri_weights.assign(ntris, 0.0);
+    double sum = 0.0;
+    uint nfaces = 0;
+    for (uint tri = 0; tri < ntris; ++tri)
+    {
+        const int * tets = mesh->_getTriTetNeighb(tri);
+        if (tets[0] < 0 || tets[1] < 0) continue;
+        TmComp * comp0 = mesh->getTetComp(tets[0]);
+        TmComp * comp1 = mesh->getTetComp(tets[1]);
+        if (comp0 == 0 || comp1 == 0) continue;
+
+        double dcst = std::min(comp_dcst[comp0], comp_dcst[comp1]);
+        double dist = steps::math::distance(mesh->_getTetBarycenter(tets[0]), mesh->_getTetBarycenter(tets[1]));
+        tri_weights[tri] = dcst * mesh->getTriArea(tri) / dist;
+        sum += tri_weights[tri];
+        ++nfaces;
+    }
+    if (sum > 0.0)
+    {
+        for (auto & w: tri_weights) w *= nfaces / sum;
+    }
+}
+
+// END
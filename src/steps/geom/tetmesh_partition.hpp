@@ -0,0 +1,106 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_TETMESH_TETMESH_PARTITION_HPP
+#define STEPS_TETMESH_TETMESH_PARTITION_HPP 1
+
+
+// STEPS headers.
+#include "steps/common.h"
+
+// STL headers
+#include <map>
+#include <vector>
+
+ namespace steps {
+ namespace model {
+    class Model;
+ }
+ namespace tetmesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Forward & auxiliary declarations.
+class Tetmesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Partition the tetrahedrons of a mesh into nparts parts, e.g. the
+/// tet_hosts of the parallel solver, by multilevel k-way partitioning of
+/// the dual graph of the mesh: the graph is coarsened by heavy edge
+/// matching, the coarsest graph is split by recursive greedy graph
+/// growing, and the parts are refined on every level on the way back.
+///
+/// Every part gets at most max_imbalance times the mean weight where
+/// possible, while the summed weight of the triangles between
+/// tetrahedrons of different parts is kept low. The tetrahedrons on
+/// both sides of a patch triangle always share a part.
+///
+/// \param mesh Mesh to partition.
+/// \param nparts Number of parts.
+/// \param tet_weights Weight of every tetrahedron, or empty for 1 each.
+/// \param tri_weights Weight of every triangle of the mesh, the cost of
+///        the tetrahedrons on its two sides being in different parts, or
+///        empty for 1 each.
+/// \param max_imbalance Largest part weight allowed, relative to the mean.
+/// \return Part of every tetrahedron.
+std::vector<uint> partitionTets(Tetmesh * mesh, uint nparts,
+                                std::vector<double> const & tet_weights = std::vector<double>(),
+                                std::vector<double> const & tri_weights = std::vector<double>(),
+                                double max_imbalance = 1.03);
+
+/// Part of every patch triangle of a mesh, e.g. the tri_hosts of the
+/// parallel solver, given the part of every tetrahedron: the part of the
+/// tetrahedrons next to it.
+std::map<uint, uint> partitionTris(Tetmesh * mesh, std::vector<uint> const & tet_parts);
+
+/// Weights for partitionTets() derived from a model.
+///
+/// Every tetrahedron weighs the number of kinetic processes a solver
+/// creates for it: the reactions and diffusion rules of its compartment
+/// and the surface processes of the patch triangles next to it. Every
+/// triangle between two tetrahedrons weighs the diffusion flux
+/// coefficient D * area / distance between their barycentres, summed
+/// over the diffusion rules of the compartment of either side, whichever
+/// is less, and relative to the mean over the mesh.
+///
+/// \param tet_rates Optional expected event rate of every tetrahedron,
+///        e.g. measured in an earlier run. The rate relative to the mean
+///        rate, times the mean number of processes, is then added to the
+///        weight of every tetrahedron.
+void partitionWeights(Tetmesh * mesh, steps::model::Model * model,
+                      std::vector<double> & tet_weights, std::vector<double> & tri_weights,
+                      std::vector<double> const & tet_rates = std::vector<double>());
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_TETMESH_TETMESH_PARTITION_HPP
+
+// END
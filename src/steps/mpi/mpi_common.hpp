@@ -36,8 +36,8 @@
  namespace steps {
  namespace mpi {
 
-enum MsgTag{OPSPLIT_MOLECULE_CHANGE = 10000, OPSPLIT_MOLECULE_CHANGE_COMPLETE = 10001, OPSPLIT_COUNT_SYNC_INFO = 10100,
-OPSPLIT_COUNT_SYNC_DATA = 10101, OPSPLIT_SYNC_COMPLETE = 10102, OPSPLIT_KPROC_UPD = 10200, OPSPLIT_UPD_COMPLETE = 10201};
+enum MsgTag{OPSPLIT_MOLECULE_CHANGE = 10000, OPSPLIT_MOLECULE_CHANGE_COMPLETE = 10001, OPSPLIT_MOLECULE_CHANGE_SIZE = 10002, OPSPLIT_MOLECULE_CHANGE_SLOTS = 10003,
+OPSPLIT_COUNT_SYNC_INFO = 10100, OPSPLIT_COUNT_SYNC_DATA = 10101, OPSPLIT_SYNC_COMPLETE = 10102, OPSPLIT_KPROC_UPD = 10200, OPSPLIT_UPD_COMPLETE = 10201};
 
 
 }
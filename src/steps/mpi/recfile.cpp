@@ -0,0 +1,292 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+// STL headers.
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/mpi/recfile.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace smpi = steps::mpi;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char REC_MAGIC[8] = {'\x89', 'S', 'T', 'E', 'P', 'S', 'R', 'C'};
+static const uint32_t REC_VERSION = 1;
+static const uint32_t REC_BYTE_ORDER = 0x01020304;
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void rec_append(std::vector<char> & buf, T const * data, uint64_t n)
+{
+    char const * p = reinterpret_cast<char const *>(data);
+    buf.insert(buf.end(), p, p + n * sizeof(T));
+}
+
+static void rec_pad(std::vector<char> & buf)
+{
+    buf.resize((buf.size() + 7) & ~static_cast<size_t>(7), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+smpi::RecWriter::RecWriter(MPI_Comm comm, std::string const & file_name,
+                           std::vector<RecSelection> const & selections,
+                           uint chunk_size, bool compress)
+: pComm(comm)
+, pRank(0)
+, pFile(MPI_FILE_NULL)
+, pOpen(false)
+, pFileName(file_name)
+, pChunkSize(chunk_size)
+, pCompress(compress)
+, pNColumns(0)
+, pPos(0)
+{
+    if (chunk_size == 0)
+    {
+        std::ostringstream os;
+        os << "Recording chunk size must be positive.";
+        throw steps::ArgErr(os.str());
+    }
+    MPI_Comm_rank(pComm, &pRank);
+
+    // The selection table, built on every rank for its size.
+    std::vector<char> table;
+    for (auto const & sel: selections)
+    {
+        RecSelectionInfo info;
+        info.kind = sel.kind;
+        info.nspecs = sel.specs.size();
+        info.nelems = sel.elems.size();
+        rec_append(table, &info, 1);
+        std::vector<uint32_t> elems(sel.elems.begin(), sel.elems.end());
+        rec_append(table, elems.data(), elems.size());
+        for (auto const & s: sel.specs) rec_append(table, s.c_str(), s.size() + 1);
+        rec_pad(table);
+        pNColumns += sel.countColumns();
+    }
+
+    RecHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, REC_MAGIC, sizeof(REC_MAGIC));
+    header.version = REC_VERSION;
+    header.byteOrder = REC_BYTE_ORDER;
+    header.flags = compress ? REC_FLAG_DELTA_VARINT : 0;
+    header.nselections = selections.size();
+    header.ncolumns = pNColumns;
+    header.dataOffset = sizeof(RecHeader) + table.size();
+    pPos = header.dataOffset;
+
+    int err = MPI_File_open(pComm, const_cast<char *>(file_name.c_str()),
+        MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &pFile);
+    if (err != MPI_SUCCESS)
+    {
+        std::ostringstream os;
+        os << "Cannot open recording file " << file_name << " for writing.";
+        throw steps::IOErr(os.str());
+    }
+    pOpen = true;
+    MPI_File_set_size(pFile, 0);
+
+    if (pRank == 0)
+    {
+        std::vector<char> head;
+        rec_append(head, &header, 1);
+        head.insert(head.end(), table.begin(), table.end());
+        MPI_File_write_at(pFile, 0, head.data(), head.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+smpi::RecWriter::~RecWriter(void)
+{
+    // Pending samples are lost unless close() was called; the file can
+    // only be closed while MPI is still running.
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (pOpen && finalized == 0) MPI_File_close(&pFile);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smpi::RecWriter::setColumns(std::vector<uint64_t> const & cols)
+{
+    flush();
+    for (uint i = 0; i < cols.size(); ++i)
+    {
+        if (cols[i] >= pNColumns || (i != 0 && cols[i] <= cols[i - 1]))
+        {
+            std::ostringstream os;
+            os << "Recording columns must be ascending and less than " << pNColumns << ".";
+            throw steps::ArgErr(os.str());
+        }
+    }
+    pCols = cols;
+    pValues.assign(pCols.size() * pChunkSize, 0.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smpi::RecWriter::sample(double t, double const * values)
+{
+    uint s = pTimes.size();
+    uint ncols = pCols.size();
+    for (uint i = 0; i < ncols; ++i) pValues[i * pChunkSize + s] = values[i];
+    pTimes.push_back(t);
+    if (pTimes.size() == pChunkSize) flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smpi::RecWriter::_encode(double const * values, uint nsamples)
+{
+    if (pCompress == false)
+    {
+        rec_append(pData, values, nsamples);
+        return;
+    }
+
+    int64_t last = 0;
+    for (uint s = 0; s < nsamples; ++s)
+    {
+        int64_t v = std::llround(values[s]);
+        int64_t d = v - last;
+        uint64_t z = (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+        while (z >= 0x80)
+        {
+            pData.push_back(static_cast<char>(z | 0x80));
+            z >>= 7;
+        }
+        pData.push_back(static_cast<char>(z));
+        last = v;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smpi::RecWriter::flush(void)
+{
+    // All ranks sample together, so they agree on whether to write.
+    uint nsamples = pTimes.size();
+    if (nsamples == 0 || pOpen == false) return;
+
+    uint ncols = pCols.size();
+    std::vector<RecColumnInfo> index(ncols);
+    pData.clear();
+    for (uint i = 0; i < ncols; ++i)
+    {
+        index[i].offset = pData.size();
+        _encode(&pValues[i * pChunkSize], nsamples);
+        index[i].size = pData.size() - index[i].offset;
+    }
+    rec_pad(pData);
+
+    // The data of the ranks follow each other in rank order.
+    uint64_t local = pData.size();
+    uint64_t base = 0;
+    uint64_t total = 0;
+    MPI_Exscan(&local, &base, 1, MPI_UINT64_T, MPI_SUM, pComm);
+    if (pRank == 0) base = 0;
+    MPI_Allreduce(&local, &total, 1, MPI_UINT64_T, MPI_SUM, pComm);
+    for (auto & ci: index) ci.offset += base;
+
+    uint64_t index_pos = pPos + sizeof(RecChunkHeader) + nsamples * sizeof(double);
+    uint64_t data_pos = index_pos + pNColumns * sizeof(RecColumnInfo);
+
+    // The parts of the chunk written by this rank, in file order: the
+    // chunk header and times on rank 0, the index entries of its columns,
+    // merged where consecutive, and its data.
+    std::vector<MPI_Aint> displs;
+    std::vector<int> lens;
+    pOut.clear();
+    if (pRank == 0)
+    {
+        RecChunkHeader ch;
+        ch.nsamples = nsamples;
+        ch.dataSize = total;
+        rec_append(pOut, &ch, 1);
+        rec_append(pOut, pTimes.data(), nsamples);
+        displs.push_back(pPos);
+        lens.push_back(pOut.size());
+    }
+    for (uint i = 0; i < ncols; ++i)
+    {
+        rec_append(pOut, &index[i], 1);
+        if (i != 0 && pCols[i] == pCols[i - 1] + 1)
+        {
+            lens.back() += sizeof(RecColumnInfo);
+            continue;
+        }
+        displs.push_back(index_pos + pCols[i] * sizeof(RecColumnInfo));
+        lens.push_back(sizeof(RecColumnInfo));
+    }
+    if (local != 0)
+    {
+        pOut.insert(pOut.end(), pData.begin(), pData.end());
+        displs.push_back(data_pos + base);
+        lens.push_back(local);
+    }
+
+    MPI_Datatype ftype;
+    MPI_Type_create_hindexed(lens.size(), lens.data(), displs.data(), MPI_BYTE, &ftype);
+    MPI_Type_commit(&ftype);
+    MPI_File_set_view(pFile, 0, MPI_BYTE, ftype, const_cast<char *>("native"), MPI_INFO_NULL);
+    int err = MPI_File_write_all(pFile, pOut.data(), pOut.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_Type_free(&ftype);
+    if (err != MPI_SUCCESS)
+    {
+        std::ostringstream os;
+        os << "Cannot write to recording file " << pFileName << ".";
+        throw steps::IOErr(os.str());
+    }
+
+    pPos = data_pos + total;
+    pTimes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smpi::RecWriter::close(void)
+{
+    if (pOpen == false) return;
+    flush();
+    MPI_File_close(&pFile);
+    pOpen = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
@@ -0,0 +1,197 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+#ifndef STEPS_MPI_RECFILE_HPP
+#define STEPS_MPI_RECFILE_HPP 1
+
+// STL headers.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+// STEPS headers.
+#include "steps/common.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace mpi {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Kinds of elements of a recording selection.
+enum RecElemKind
+{
+    REC_ELEM_TET = 0,
+    REC_ELEM_TRI = 1
+};
+
+/// Flags of a recording file.
+enum RecFlag
+{
+    // Columns hold their first count and then the differences between
+    // consecutive counts as zigzag varints, instead of doubles.
+    REC_FLAG_DELTA_VARINT = 0x01
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// File header of a recording.
+struct RecHeader
+{
+    char                                magic[8];
+    uint32_t                            version;
+    // REC_BYTE_ORDER as written by the producing machine.
+    uint32_t                            byteOrder;
+    uint32_t                            flags;
+    uint32_t                            nselections;
+    uint64_t                            ncolumns;
+    // Start of the first chunk, after the selection table.
+    uint64_t                            dataOffset;
+};
+
+/// Entry of the selection table following the header. Each entry is
+/// followed by the element indices as uint32_t and by the species names,
+/// each terminated by a NUL, padded to 8 bytes.
+struct RecSelectionInfo
+{
+    uint32_t                            kind;
+    uint32_t                            nspecs;
+    uint64_t                            nelems;
+};
+
+/// Header of a chunk of samples. It is followed by the sample times, the
+/// RecColumnInfo of every column and the column data, in that order; the
+/// next chunk starts right after the data.
+struct RecChunkHeader
+{
+    uint64_t                            nsamples;
+    uint64_t                            dataSize;
+};
+
+/// Entry of the column index of a chunk: the column data relative to
+/// the start of the data of the chunk.
+struct RecColumnInfo
+{
+    uint64_t                            offset;
+    uint64_t                            size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// The counts of some species in some tets or tris. Its columns are the
+/// species of the first element, then those of the second, and so on;
+/// the columns of a recording are those of its selections in order.
+struct RecSelection
+{
+    uint                                kind;
+    std::vector<uint>                   elems;
+    std::vector<std::string>            specs;
+
+    inline uint64_t countColumns(void) const
+    { return static_cast<uint64_t>(elems.size()) * specs.size(); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writer of a recording shared by the ranks of a communicator.
+///
+/// Every rank samples a part of the columns. Samples are kept in memory,
+/// column by column, until chunk_size of them are pending; the ranks then
+/// write their columns of the chunk straight into the file with one
+/// collective MPI-IO write, without gathering them anywhere. Each column
+/// must be sampled by exactly one rank.
+///
+class RecWriter
+{
+
+public:
+
+    /// Create the file and write the header (collective).
+    RecWriter(MPI_Comm comm, std::string const & file_name,
+              std::vector<RecSelection> const & selections,
+              uint chunk_size, bool compress);
+
+    /// Close the file if still open.
+    ~RecWriter(void);
+
+    /// Set the columns this rank samples from now on, in ascending order,
+    /// writing the pending samples first (collective).
+    void setColumns(std::vector<uint64_t> const & cols);
+
+    /// Add a sample taken at time t, given the values of the columns of
+    /// this rank in the order of setColumns(). Writes a chunk, and is then
+    /// collective, once chunk_size samples are pending.
+    void sample(double t, double const * values);
+
+    /// Write the pending samples as a chunk (collective).
+    void flush(void);
+
+    /// Flush and close the file (collective).
+    void close(void);
+
+    inline uint64_t countColumns(void) const
+    { return pNColumns; }
+
+private:
+
+    void _encode(double const * values, uint nsamples);
+
+    MPI_Comm                            pComm;
+    int                                 pRank;
+    MPI_File                            pFile;
+    bool                                pOpen;
+    std::string                         pFileName;
+    uint                                pChunkSize;
+    bool                                pCompress;
+    uint64_t                            pNColumns;
+
+    // Position of the next chunk.
+    uint64_t                            pPos;
+
+    std::vector<uint64_t>               pCols;
+    std::vector<double>                 pTimes;
+    // Pending values of column i of this rank from pValues[i * pChunkSize].
+    std::vector<double>                 pValues;
+
+    // Encoded columns and the parts of the file written by this rank.
+    std::vector<char>                   pData;
+    std::vector<char>                   pOut;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_MPI_RECFILE_HPP
+
+// END
@@ -256,6 +256,61 @@ void smtos::Diff::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::Diff::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+
+    cols.ints.push_back(directionalDcsts.size());
+    for (auto const & item: directionalDcsts)
+    {
+        cols.ints.push_back(item.first);
+        cols.reals.push_back(item.second);
+    }
+
+    cols.reals.push_back(pScaledDcst);
+    cols.reals.push_back(pDcst);
+    cols.reals.insert(cols.reals.end(), pNonCDFSelector, pNonCDFSelector + 4);
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndActive[i]);
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndDirection[i]);
+    cols.ints.insert(cols.ints.end(), pNeighbCompLidx, pNeighbCompLidx + 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::Diff::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+
+    directionalDcsts.clear();
+    uint n_direct_dcsts = cur.integer();
+    for (uint i = 0; i < n_direct_dcsts; ++i)
+    {
+        uint id = cur.integer();
+        directionalDcsts[id] = cur.real();
+    }
+
+    pScaledDcst = cur.real();
+    pDcst = cur.real();
+    cur.reals(pNonCDFSelector, 4);
+    for (uint i = 0; i < 4; ++i) pDiffBndActive[i] = cur.integer();
+    for (uint i = 0; i < 4; ++i) pDiffBndDirection[i] = cur.integer();
+    cur.ints(pNeighbCompLidx, 4);
+
+    // The open directions follow from the selector, as in setDcst().
+    pNdirections = 0;
+    pDirections.clear();
+    for (uint i = 0; i < 4; ++i)
+    {
+        if (pNonCDFSelector[i] > 0.0)
+        {
+            pDirections.push_back(i);
+            pNdirections += 1;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::Diff::setupDeps(void)
 {
     // We will check all KProcs of the following simulation elements:
@@ -923,6 +978,53 @@ int smtos::Diff::apply(steps::rng::RNG * rng, uint nmolcs)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double smtos::Diff::getDirectionChance(uint i) const
+{
+    assert(i < pNdirections);
+    if (i == pNdirections - 1) return 1.0;
+
+    double sump = 0.0;
+    for (uint j = 0; j < i; ++j) sump += pNonCDFSelector[pDirections[j]];
+
+    double chance = pNonCDFSelector[pDirections[i]] / (1.0 - sump);
+    return (chance >= 1.0) ? 1.0 : chance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int smtos::Diff::apply(uint const * molcs)
+{
+    bool clamped = pTet->clamped(lidxTet);
+    if (clamped == false && pTet->pools()[lidxTet] == 0) return -2;
+
+    uint nmolcs = 0;
+    uint ndirections = 0;
+    int direction = -1;
+    for (uint i = 0; i < pNdirections; ++i)
+    {
+        if (molcs[i] == 0) continue;
+        uint dir = pDirections[i];
+        smtos::Tet * nexttet = pTet->nextTet(dir);
+        assert (nexttet != 0);
+        assert(pNeighbCompLidx[dir] > -1);
+
+        if (nexttet->clamped(pNeighbCompLidx[dir]) == false)
+        {
+            nexttet->incCount(pNeighbCompLidx[dir], molcs[i]);
+        }
+        nmolcs += molcs[i];
+        ndirections++;
+        direction = dir;
+    }
+
+    if (clamped == false) {pTet->incCount(lidxTet, -static_cast<int>(nmolcs)); }
+
+    rExtent += nmolcs;
+    return (ndirections == 1) ? direction : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::vector<uint> const & smtos::Diff::getRemoteUpdVec(int direction)
 {
     if (direction == -1) return remoteAllUpdVec;
@@ -79,6 +79,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
@@ -101,6 +107,18 @@ public:
 
     int apply(steps::rng::RNG * rng);
     int apply(steps::rng::RNG * rng, uint nmolcs);
+
+    /// Number of directions molecules can diffuse in, and the chance of
+    /// taking the i-th of them given that none of the earlier ones is
+    /// taken, as sampled by apply(rng, nmolcs).
+    inline uint countDirections(void) const
+    { return pNdirections; }
+    double getDirectionChance(uint i) const;
+
+    /// Apply molcs[i] molecules diffusing in the i-th direction. Returns
+    /// the direction if all molecules took the same one, else -1, or -2
+    /// if there was nothing to diffuse.
+    int apply(uint const * molcs);
     
     std::vector<KProc*> const & getLocalUpdVec(int direction = -1);
     std::vector<uint> const & getRemoteUpdVec(int direction = -1);
@@ -0,0 +1,170 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_MPI_TETOPSPLIT_ELEMTABLE_HPP
+#define STEPS_MPI_TETOPSPLIT_ELEMTABLE_HPP 1
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace mpi {
+ namespace tetopsplit {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Tets or tris materialised on this rank, looked up by global index.
+///
+/// A dense table has a slot for every element of the mesh. A sparse
+/// table only has slots for a sorted list of global indices, usually the
+/// elements hosted on this rank and their neighbours, and maps global
+/// indices to slots by binary search. Looking up an element without a
+/// slot, or whose slot is empty, returns 0.
+///
+template <typename T>
+class ElemTable
+{
+
+public:
+
+    typedef typename std::vector<T *>::const_iterator const_iterator;
+
+    ElemTable(void)
+    : pNGlobal(0)
+    , pDense(true)
+    , pGlobal()
+    , pElems()
+    {}
+
+    /// Give every one of the nglobal elements a slot.
+    void assign(uint nglobal)
+    {
+        pNGlobal = nglobal;
+        pDense = true;
+        pGlobal.clear();
+        pElems.assign(nglobal, 0);
+    }
+
+    /// Only give slots to the elements with sorted global indices gidxs.
+    void assign(uint nglobal, std::vector<uint> const & gidxs)
+    {
+        assert(std::is_sorted(gidxs.begin(), gidxs.end()));
+        assert(gidxs.empty() || gidxs.back() < nglobal);
+        pNGlobal = nglobal;
+        pDense = false;
+        pGlobal = gidxs;
+        pElems.assign(gidxs.size(), 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Number of elements of the mesh.
+    inline uint size(void) const
+    { return pNGlobal; }
+
+    /// Number of slots on this rank.
+    inline uint countLocal(void) const
+    { return pElems.size(); }
+
+    inline bool dense(void) const
+    { return pDense; }
+
+    /// Slot of element gidx, or -1 if it has none.
+    inline int localIdx(uint gidx) const
+    {
+        assert(gidx < pNGlobal);
+        if (pDense) return gidx;
+        std::vector<uint>::const_iterator it =
+            std::lower_bound(pGlobal.begin(), pGlobal.end(), gidx);
+        if (it == pGlobal.end() || *it != gidx) return -1;
+        return it - pGlobal.begin();
+    }
+
+    /// Global index of the element in slot lidx.
+    inline uint globalIdx(uint lidx) const
+    {
+        assert(lidx < pElems.size());
+        return pDense ? lidx : pGlobal[lidx];
+    }
+
+    inline T * operator[](uint gidx) const
+    {
+        int lidx = localIdx(gidx);
+        return (lidx < 0) ? 0 : pElems[lidx];
+    }
+
+    inline T * local(uint lidx) const
+    {
+        assert(lidx < pElems.size());
+        return pElems[lidx];
+    }
+
+    inline void set(uint gidx, T * elem)
+    {
+        int lidx = localIdx(gidx);
+        assert(lidx >= 0);
+        pElems[lidx] = elem;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Iterate over the slots in order of global index.
+    inline const_iterator begin(void) const
+    { return pElems.begin(); }
+
+    inline const_iterator end(void) const
+    { return pElems.end(); }
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    uint                                pNGlobal;
+    bool                                pDense;
+
+    // Sorted global index of every slot; empty if the table is dense.
+    std::vector<uint>                   pGlobal;
+    std::vector<T *>                    pElems;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+}
+
+#endif
+// STEPS_MPI_TETOPSPLIT_ELEMTABLE_HPP
+
+// END
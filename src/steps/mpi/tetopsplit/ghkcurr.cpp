@@ -102,6 +102,22 @@ void smtos::GHKcurr::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::GHKcurr::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.ints.push_back(pEffFlux);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::GHKcurr::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+    pEffFlux = cur.integer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::GHKcurr::reset(void)
 {
 
@@ -296,7 +312,7 @@ double smtos::GHKcurr::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
     if (voconc < 0.0)  oconc = (pTri->oTet()->conc(gidxion))*1.0e3;
     else  oconc = voconc*1.0e3;
 
-    double v = solver->getTriV(pTri->idx());
+    double v = solver->_getLocalTriV(pTri->idx());
     double T = solver->getTemp();
 
     double flux = sm::GHKcurrent(pGHKcurrdef->perm(), v+pGHKcurrdef->vshift(), pGHKcurrdef->valence(),
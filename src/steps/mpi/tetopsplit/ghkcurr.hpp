@@ -78,6 +78,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
@@ -84,6 +84,28 @@ void smtos::KProc::resetExtent(void)
 {
     rExtent = 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::KProc::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    cols.counts.push_back(rExtent);
+    cols.flags.push_back(pFlags);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::KProc::restoreColumns(steps::solver::CPCursor & cur)
+{
+    rExtent = cur.count();
+    pFlags = cur.flag();
+
+    // The composition-rejection data is local to the rank and is rebuilt
+    // by the solver; the position of a diffusion in its list is kept.
+    crData.recorded = false;
+    crData.pow = 0;
+    crData.rate = 0.0;
+}
 ////////////////////////////////////////////////////////////////////////////////
 
 void smtos::KProc::resetCcst(void) const
@@ -47,6 +47,7 @@
 #include "steps/common.h"
 #include "steps/solver/types.hpp"
 #include "steps/rng/rng.hpp"
+#include "steps/solver/cpfile.hpp"
 //#include "tetopsplit.hpp"
 
 // TetOpSplitP CR header
@@ -103,6 +104,12 @@ public:
     /// restore data
     virtual void restore(std::fstream & cp_file) = 0;
 
+    /// checkpoint data into the columns of a binary checkpoint
+    virtual void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    virtual void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // DATA ACCESS
     ////////////////////////////////////////////////////////////////////////
@@ -126,6 +126,24 @@ void smtos::Reac::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::Reac::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.reals.push_back(pCcst);
+    cols.reals.push_back(pKcst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::Reac::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+    pCcst = cur.real();
+    pKcst = cur.real();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::Reac::reset(void)
 {
 
@@ -238,23 +256,46 @@ double smtos::Reac::rate(smtos::TetOpSplitP * solver)
 
     // Prefetch some variables.
     ssolver::Compdef * cdef = pTet->compdef();
-    uint nspecs = cdef->countSpecs();
-    uint * lhs_vec = cdef->reac_lhs_bgn(cdef->reacG2L(pReacdef->gidx()));
     uint * cnt_vec = pTet->pools();
 
     // Compute combinatorial part.
     double h_mu = 1.0;
-    for (uint pool = 0; pool < nspecs; ++pool)
+    for (auto const & e: cdef->reac_lhs_sparse(cdef->reacG2L(pReacdef->gidx())))
     {
-        uint lhs = lhs_vec[pool];
-        if (lhs == 0) continue;
-        uint cnt = cnt_vec[pool];
+        uint lhs = e.coef;
+        uint cnt = cnt_vec[e.idx];
         if (lhs > cnt) {
             h_mu = 0.0;
             break;
         }
-        assert(lhs >= 4);
-        h_mu *= (cnt - lhs + 1);
+        switch (lhs)
+        {
+            case 4:
+            {
+                h_mu *= static_cast<double>(cnt - 3);
+            }
+            // fall through
+            case 3:
+            {
+                h_mu *= static_cast<double>(cnt - 2);
+            }
+            // fall through
+            case 2:
+            {
+                h_mu *= static_cast<double>(cnt - 1);
+            }
+            // fall through
+            case 1:
+            {
+                h_mu *= static_cast<double>(cnt);
+                break;
+            }
+            default:
+            {
+                assert(0);
+                return 0.0;
+            }
+        }
     }
 #ifdef MPI_DEBUG
     //CLOG(DEBUG, "mpi_debug") << "new rate: " << h_mu * pCcst <<"\n";
@@ -270,15 +311,12 @@ void smtos::Reac::apply(steps::rng::RNG * rng, double dt, double simtime, double
     uint * local = pTet->pools();
     ssolver::Compdef * cdef = pTet->compdef();
     uint l_ridx = cdef->reacG2L(pReacdef->gidx());
-    int * upd_vec = cdef->reac_upd_bgn(l_ridx);
-    uint nspecs = cdef->countSpecs();
-    for (uint i = 0; i < nspecs; ++i)
+    for (auto const & e: cdef->reac_upd_sparse(l_ridx))
     {
-        if (pTet->clamped(i) == true) continue;
-        int j = upd_vec[i];
-        int nc = static_cast<int>(local[i]) + j;
+        if (pTet->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(local[e.idx]) + e.coef;
         assert(nc >= 0);
-        pTet->setCount(i, static_cast<uint>(nc), period);
+        pTet->setCount(e.idx, static_cast<uint>(nc), period);
     }
 
     rExtent++;
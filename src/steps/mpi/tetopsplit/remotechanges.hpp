@@ -0,0 +1,139 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+#ifndef STEPS_MPI_TETOPSPLIT_REMOTECHANGES_HPP
+#define STEPS_MPI_TETOPSPLIT_REMOTECHANGES_HPP 1
+
+// STL headers.
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace mpi {
+ namespace tetopsplit {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The molecule changes sent to a neighbouring rank every iteration are
+// either REMOTE_CHANGES_RAW followed by the change of every slot, or
+// REMOTE_CHANGES_SPARSE followed by the number of slots skipped and the
+// change of every changed slot as base-128 varints, whichever is shorter.
+// Changes are signed counts stored as uint, so a negative change takes
+// five bytes.
+enum RemoteChangesFormat { REMOTE_CHANGES_RAW = 0, REMOTE_CHANGES_SPARSE = 1 };
+
+/// Append v to buf as a base-128 varint, low group first.
+inline void putVarint(std::vector<unsigned char> & buf, uint v)
+{
+    while (v >= 0x80)
+    {
+        buf.push_back((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    buf.push_back(v);
+}
+
+/// Read a varint written by putVarint() and advance p past it.
+inline uint getVarint(unsigned char const *& p)
+{
+    uint v = 0;
+    for (uint shift = 0; ; shift += 7)
+    {
+        unsigned char b = *p++;
+        v |= uint(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) return v;
+    }
+}
+
+/// Encode the change of every slot into buf in the shorter format.
+inline void encodeRemoteChanges(std::vector<uint> const & changes, std::vector<unsigned char> & buf)
+{
+    uint nslots = changes.size();
+    uint raw_size = 1 + nslots * sizeof(uint);
+
+    buf.clear();
+    buf.push_back(REMOTE_CHANGES_SPARSE);
+    uint skip = 0;
+    for (uint s = 0; s < nslots && buf.size() < raw_size; ++s)
+    {
+        if (changes[s] == 0)
+        {
+            ++skip;
+            continue;
+        }
+        putVarint(buf, skip);
+        putVarint(buf, changes[s]);
+        skip = 0;
+    }
+    if (buf.size() < raw_size) return;
+
+    buf.resize(raw_size);
+    buf[0] = REMOTE_CHANGES_RAW;
+    if (nslots != 0) std::memcpy(&buf[1], &changes.front(), nslots * sizeof(uint));
+}
+
+/// Decode size bytes written by encodeRemoteChanges() for nslots slots,
+/// calling apply(slot, change) for every slot whose change is not zero.
+template <typename F>
+inline void decodeRemoteChanges(unsigned char const * p, uint size, uint nslots, F apply)
+{
+    unsigned char const * end = p + size;
+    if (*p++ == REMOTE_CHANGES_RAW)
+    {
+        assert(uint(end - p) == nslots * sizeof(uint));
+        for (uint s = 0; s < nslots; ++s, p += sizeof(uint))
+        {
+            uint value;
+            std::memcpy(&value, p, sizeof(uint));
+            if (value != 0) apply(s, value);
+        }
+    }
+    else
+    {
+        for (uint s = 0; p != end; ++s)
+        {
+            s += getVarint(p);
+            assert(s < nslots);
+            apply(s, getVarint(p));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+}
+
+#endif
+// STEPS_MPI_TETOPSPLIT_REMOTECHANGES_HPP
+
+// END
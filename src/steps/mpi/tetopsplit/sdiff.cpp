@@ -245,6 +245,61 @@ void smtos::SDiff::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::SDiff::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+
+    cols.ints.push_back(directionalDcsts.size());
+    for (auto const & item: directionalDcsts)
+    {
+        cols.ints.push_back(item.first);
+        cols.reals.push_back(item.second);
+    }
+
+    cols.reals.push_back(pScaledDcst);
+    cols.reals.push_back(pDcst);
+    cols.reals.insert(cols.reals.end(), pNonCDFSelector, pNonCDFSelector + 3);
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndActive[i]);
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndDirection[i]);
+    cols.ints.insert(cols.ints.end(), pNeighbPatchLidx, pNeighbPatchLidx + 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::SDiff::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+
+    directionalDcsts.clear();
+    uint n_direct_dcsts = cur.integer();
+    for (uint i = 0; i < n_direct_dcsts; ++i)
+    {
+        uint id = cur.integer();
+        directionalDcsts[id] = cur.real();
+    }
+
+    pScaledDcst = cur.real();
+    pDcst = cur.real();
+    cur.reals(pNonCDFSelector, 3);
+    for (uint i = 0; i < 3; ++i) pSDiffBndActive[i] = cur.integer();
+    for (uint i = 0; i < 3; ++i) pSDiffBndDirection[i] = cur.integer();
+    cur.ints(pNeighbPatchLidx, 3);
+
+    // The open directions follow from the selector, as in setDcst().
+    pNdirections = 0;
+    pDirections.clear();
+    for (uint i = 0; i < 3; ++i)
+    {
+        if (pNonCDFSelector[i] > 0.0)
+        {
+            pDirections.push_back(i);
+            pNdirections += 1;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::SDiff::setupDeps(void)
 {
     // We will check all KProcs of the following simulation elements:
@@ -840,6 +895,52 @@ int smtos::SDiff::apply(steps::rng::RNG * rng, uint nmolcs)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double smtos::SDiff::getDirectionChance(uint i) const
+{
+    assert(i < pNdirections);
+    if (i == pNdirections - 1) return 1.0;
+
+    double sump = 0.0;
+    for (uint j = 0; j < i; ++j) sump += pNonCDFSelector[pDirections[j]];
+
+    double chance = pNonCDFSelector[pDirections[i]] / (1.0 - sump);
+    return (chance >= 1.0) ? 1.0 : chance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int smtos::SDiff::apply(uint const * molcs)
+{
+    bool clamped = pTri->clamped(lidxTri);
+    if (clamped == false && pTri->pools()[lidxTri] == 0) return -2;
+
+    uint nmolcs = 0;
+    uint ndirections = 0;
+    int direction = -1;
+    for (uint i = 0; i < pNdirections; ++i)
+    {
+        if (molcs[i] == 0) continue;
+        uint dir = pDirections[i];
+        smtos::Tri * nexttri = pTri->nextTri(dir);
+        assert (nexttri != 0);
+
+        if (nexttri->clamped(lidxTri) == false)
+        {
+            nexttri->incCount(lidxTri, molcs[i]);
+        }
+        nmolcs += molcs[i];
+        ndirections++;
+        direction = dir;
+    }
+
+    if (clamped == false) {pTri->incCount(lidxTri, -static_cast<int>(nmolcs)); }
+
+    rExtent += nmolcs;
+    return (ndirections == 1) ? direction : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::vector<uint> const & smtos::SDiff::getRemoteUpdVec(int direction)
 {
     if (direction == -1) return remoteAllUpdVec;
@@ -169,6 +169,24 @@ void smtos::SReac::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::SReac::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.reals.push_back(pCcst);
+    cols.reals.push_back(pKcst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::SReac::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+    pCcst = cur.real();
+    pKcst = cur.real();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::SReac::reset(void)
 {
 
@@ -439,14 +457,11 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
 
         double h_mu = 1.0;
 
-        uint * lhs_s_vec = pdef->sreac_lhs_S_bgn(lidx);
         uint * cnt_s_vec = pTri->pools();
-        uint nspecs_s = pdef->countSpecs();
-        for (uint s = 0; s < nspecs_s; ++s)
+        for (auto const & e: pdef->sreac_lhs_S_sparse(lidx))
         {
-            uint lhs = lhs_s_vec[s];
-            if (lhs == 0) continue;
-            uint cnt = cnt_s_vec[s];
+            uint lhs = e.coef;
+            uint cnt = cnt_s_vec[e.idx];
             if (lhs > cnt)
             {
                 return 0.0;
@@ -457,14 +472,17 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -480,14 +498,11 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
 
         if (pSReacdef->inside())
         {
-            uint * lhs_i_vec = pdef->sreac_lhs_I_bgn(lidx);
             uint * cnt_i_vec = pTri->iTet()->pools();
-            uint nspecs_i = pdef->countSpecs_I();
-            for (uint s = 0; s < nspecs_i; ++s)
+            for (auto const & e: pdef->sreac_lhs_I_sparse(lidx))
             {
-                uint lhs = lhs_i_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_i_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_i_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -498,14 +513,17 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -521,14 +539,11 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
         }
         else if (pSReacdef->outside())
         {
-            uint * lhs_o_vec = pdef->sreac_lhs_O_bgn(lidx);
             uint * cnt_o_vec = pTri->oTet()->pools();
-            uint nspecs_o = pdef->countSpecs_O();
-            for (uint s = 0; s < nspecs_o; ++s)
+            for (auto const & e: pdef->sreac_lhs_O_sparse(lidx))
             {
-                uint lhs = lhs_o_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_o_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_o_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -539,14 +554,17 @@ double smtos::SReac::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -593,30 +611,25 @@ void smtos::SReac::apply(steps::rng::RNG * rng, double dt, double simtime, doubl
 		pTri->setOCchange(oc, cs_lidx, dt, simtime);
 	}
 
-    uint nspecs_s = pdef->countSpecs();
-    for (uint s = 0; s < nspecs_s; ++s)
+    for (auto const & e: pdef->sreac_upd_S_sparse(lidx))
     {
-        if (pTri->clamped(s) == true) continue;
-        int upd = upd_s_vec[s];
-        int nc = static_cast<int>(cnt_s_vec[s]) + upd;
+        if (pTri->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(cnt_s_vec[e.idx]) + e.coef;
         assert(nc >= 0);
-        pTri->setCount(s, static_cast<uint>(nc), period);
+        pTri->setCount(e.idx, static_cast<uint>(nc), period);
     }
 
     // Update inner tet pools.
     smtos::WmVol * itet = pTri->iTet();
     if (itet != 0)
     {
-        int * upd_i_vec = pdef->sreac_upd_I_bgn(lidx);
         uint * cnt_i_vec = itet->pools();
-        uint nspecs_i = pdef->countSpecs_I();
-        for (uint s = 0; s < nspecs_i; ++s)
+        for (auto const & e: pdef->sreac_upd_I_sparse(lidx))
         {
-            if (itet->clamped(s) == true) continue;
-            int upd = upd_i_vec[s];
-            int nc = static_cast<int>(cnt_i_vec[s]) + upd;
+            if (itet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_i_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            itet->setCount(s, static_cast<uint>(nc), period);
+            itet->setCount(e.idx, static_cast<uint>(nc), period);
         }
     }
 
@@ -624,16 +637,13 @@ void smtos::SReac::apply(steps::rng::RNG * rng, double dt, double simtime, doubl
     smtos::WmVol * otet = pTri->oTet();
     if (otet != 0)
     {
-        int * upd_o_vec = pdef->sreac_upd_O_bgn(lidx);
         uint * cnt_o_vec = otet->pools();
-        uint nspecs_o = pdef->countSpecs_O();
-        for (uint s = 0; s < nspecs_o; ++s)
+        for (auto const & e: pdef->sreac_upd_O_sparse(lidx))
         {
-            if (otet->clamped(s) == true) continue;
-            int upd = upd_o_vec[s];
-            int nc = static_cast<int>(cnt_o_vec[s]) + upd;
+            if (otet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_o_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            otet->setCount(s, static_cast<uint>(nc), period);
+            otet->setCount(e.idx, static_cast<uint>(nc), period);
         }
     }
 
@@ -136,6 +136,22 @@ void smtos::Tet::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::Tet::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndDirection[i]);
+    WmVol::checkpointColumns(cols);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::Tet::restoreColumns(steps::solver::CPCursor & cur)
+{
+    for (uint i = 0; i < 4; ++i) pDiffBndDirection[i] = cur.integer();
+    WmVol::restoreColumns(cur);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::Tet::setNextTet(uint i, smtos::Tet * t)
 {
     // Now adding all tets, even those from other compartments, due to the diffusion boundaries
@@ -394,7 +410,7 @@ void smtos::Tet::incCount(uint lidx, int inc, double period, bool local_change)
             throw steps::ProgErr(os.str());
         }
         
-        bufferLocations[lidx] = pSol->registerRemoteMoleculeChange(hostRank, bufferLocations[lidx], SUB_TET, pIdx, lidx, inc);
+        pSol->registerRemoteMoleculeChange(hostRank, bufferLocations[lidx], inc);
         // does not need to check sync
     }
     // local change
@@ -471,10 +487,11 @@ void smtos::Tet::repartition(smtos::TetOpSplitP * tex, int rank, int host_rank)
 }
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::Tet::setupBufferLocations(void)
+void smtos::Tet::setupBufferLocations(uint first)
 {
     uint nspecs = pCompdef->countSpecs();
-    bufferLocations.assign(nspecs, std::numeric_limits<uint>::max());
+    bufferLocations.resize(nspecs);
+    for (uint l = 0; l < nspecs; ++l) bufferLocations[l] = first + l;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -93,6 +93,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // SETUP
     ////////////////////////////////////////////////////////////////////////
@@ -188,7 +194,9 @@ public:
 
     ////////////////////////////////////////////////////////////
     void repartition(smtos::TetOpSplitP * tex, int rank, int host_rank);
-    void setupBufferLocations(void);
+    /// Collect the changes of species lidx by diffusion from this rank in
+    /// slot first + lidx of the change buffer sent to the host.
+    void setupBufferLocations(uint first);
 
 private:
 
@@ -27,6 +27,7 @@
 
 // Standard library headers.
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <map>
 #include <cassert>
@@ -40,6 +41,8 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <memory>
+#include <tuple>
 
 #include <mpi.h>
 
@@ -66,6 +69,7 @@
 #include "steps/mpi/tetopsplit/vdepsreac.hpp"
 #include "steps/mpi/tetopsplit/diffboundary.hpp"
 #include "steps/mpi/tetopsplit/sdiffboundary.hpp"
+#include "steps/mpi/tetopsplit/remotechanges.hpp"
 #include "steps/math/constants.hpp"
 #include "steps/math/point.hpp"
 #include "steps/error.hpp"
@@ -81,17 +85,22 @@
 #include "steps/solver/vdeptransdef.hpp"
 #include "steps/solver/vdepsreacdef.hpp"
 #include "steps/solver/types.hpp"
+#include "steps/solver/cpfile.hpp"
 #include "steps/solver/diffboundarydef.hpp"
 #include "steps/solver/sdiffboundarydef.hpp"
 #include "steps/geom/tetmesh.hpp"
 
 #include "steps/solver/efield/efield.hpp"
 #include "steps/solver/efield/dVsolver.hpp"
+#include "steps/solver/efield/dVsolver_pcg.hpp"
+#include "steps/solver/efield/dVsolver_condensed.hpp"
 #include "steps/solver/efield/dVsolver_slu.hpp"
+#include "steps/solver/efield/dVsolver_dist.hpp"
 #ifdef USE_PETSC
 #include "steps/solver/efield/dVsolver_petsc.hpp"
 #endif
 #include "steps/util/distribute.hpp"
+#include "steps/util/fnv_hash.hpp"
 
 #include "third_party/easylogging++.h"
 
@@ -105,6 +114,56 @@ using steps::math::point3d;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// Diffusions are sampled in batches of this many with molecules, so that
+// the inputs of a batch stay in the L1 cache.
+const uint DIFF_BATCH_SIZE = 256;
+
+// Most directions of a diffusion, those of a tet.
+const uint DIFF_MAX_DIRECTIONS = 4;
+
+inline steps::mpi::tetopsplit::Tet * diffElem(steps::mpi::tetopsplit::Diff * d)
+{
+    return d->getTet();
+}
+
+inline steps::mpi::tetopsplit::Tri * diffElem(steps::mpi::tetopsplit::SDiff * d)
+{
+    return d->getTri();
+}
+
+// Most update period levels, so that the slowest rules are applied at
+// least every 2^15 base periods.
+const uint MAX_UPD_LEVELS = 16;
+
+// Stable sort of kprocs[begin, end) by level[pos], the level of the kproc
+// at pos; seps[k] becomes the end of level k.
+template <typename KP>
+void sortByLevel(std::vector<KP *> & kprocs, uint begin, uint end,
+                 std::vector<uint> const & level, uint nlevels, std::vector<uint> & seps)
+{
+    std::vector<uint> next(nlevels, 0);
+    for (uint pos = begin; pos < end; ++pos) next[level[pos]]++;
+    seps.resize(nlevels);
+    uint first = begin;
+    for (uint k = 0; k < nlevels; ++k)
+    {
+        uint n = next[k];
+        next[k] = first;
+        first += n;
+        seps[k] = first;
+    }
+
+    std::vector<KP *> sorted(kprocs.begin() + begin, kprocs.begin() + end);
+    for (uint pos = begin; pos < end; ++pos)
+        kprocs[next[level[pos]]++] = sorted[pos - begin];
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::schedIDXSet_To_Vec(smtos::SchedIDXSet const & s, smtos::SchedIDXVec & v)
 {
     v.resize(s.size());
@@ -115,7 +174,7 @@ void smtos::schedIDXSet_To_Vec(smtos::SchedIDXSet const & s, smtos::SchedIDXVec
 
 smtos::TetOpSplitP::TetOpSplitP(steps::model::Model * m, steps::wm::Geom * g, steps::rng::RNG * r,
         int calcMembPot, std::vector<uint> const &tet_hosts, std::map<uint, uint> const &tri_hosts,
-        std::vector<uint> const &wm_hosts)
+        std::vector<uint> const &wm_hosts, bool distribute_elems)
 : API(m, g, r)
 , pMesh(0)
 , pKProcs()
@@ -124,13 +183,15 @@ smtos::TetOpSplitP::TetOpSplitP(steps::model::Model * m, steps::wm::Geom * g, st
 , pPatches()
 , pDiffBoundaries()
 , pSDiffBoundaries()
-, pTets()
-, pTris()
 , pWmVols()
+, pTris()
+, pTets()
+, pDistElems(distribute_elems)
 , pA0(0.0)
 , pEFoption(static_cast<EF_solver>(calcMembPot))
 , pTemp(0.0)
 , pEFDT(1.0e-5)
+, pEFVolRes(1.0)
 , pEFNVerts(0)
 , pEFNTris(0)
 , pEFTris_vec(0)
@@ -145,12 +206,23 @@ smtos::TetOpSplitP::TetOpSplitP(steps::model::Model * m, steps::wm::Geom * g, st
 , wmHosts(wm_hosts)
 , diffApplyThreshold(10)
 , diffSep(0)
+, diffBndSep(0)
 , sdiffSep(0)
+, sdiffBndSep(0)
 , updPeriod(0.0)
 , recomputeUpdPeriod(true)
+, pUpdLevels(1)
+, diffBndLevelSeps()
+, diffLevelSeps()
+, sdiffBndLevelSeps()
+, sdiffLevelSeps()
+, pUpdCycle(0)
+, pUpdLevelTime()
+, pMinBndLevel(0)
 , reacExtent(0.0)
 , diffExtent(0.0)
 , nIteration(0.0)
+, pRecvRequests(0)
 , rd()
 , gen(rd())
 , compTime(0.0)
@@ -159,6 +231,16 @@ smtos::TetOpSplitP::TetOpSplitP(steps::model::Model * m, steps::wm::Geom * g, st
 , efieldTime(0.0)
 , rdTime(0.0)
 , dataExchangeTime(0.0)
+, pProfile(0)
+, pRecSelections()
+, pRecWriter(0)
+, pRecColumns()
+, pRecValues()
+, pRebalancePeriods(0)
+, pRebalanceCount(0)
+, pRebalanceThreshold(1.1)
+, pNRebalanceChecks(0)
+, pRebalanceExtents()
 {
     if (rng() == 0)
     {
@@ -183,6 +265,9 @@ smtos::TetOpSplitP::TetOpSplitP(steps::model::Model * m, steps::wm::Geom * g, st
 
 smtos::TetOpSplitP::~TetOpSplitP(void)
 {
+    _freeDiffComm();
+    delete pProfile;
+    delete pRecWriter;
     for (auto c: pComps) delete c;
     for (auto p: pPatches) delete p;
     for (auto db: pDiffBoundaries) delete db;
@@ -209,261 +294,587 @@ smtos::TetOpSplitP::~TetOpSplitP(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP::checkpoint(std::string const & file_name)
+// Part file of a distributed checkpoint written by rank.
+static std::string cp_part_name(std::string const & file_name, uint rank)
 {
     std::ostringstream os;
-    os << "This function has not been implemented!";
-    throw steps::NotImplErr(os.str());
-
-    /*
-    
-    std::cout << "Checkpoint to " << file_name  << "...";
-    std::fstream cp_file;
-
-    cp_file.open(file_name.c_str(),
-                std::fstream::out | std::fstream::binary | std::fstream::trunc);
+    os << file_name << "." << rank;
+    return os.str();
+}
 
-    statedef()->checkpoint(cp_file);
+////////////////////////////////////////////////////////////////////////////////
 
-    CompPVecCI comp_e = pComps.end();
-    for (CompPVecCI c = pComps.begin(); c != comp_e; ++c) (*c)->checkpoint(cp_file);
+// Part files of a distributed checkpoint, opened on first use.
+struct CPParts
+{
+    std::string                                         fileName;
+    uint64_t                                            modelFP;
+    uint64_t                                            meshFP;
+    std::map<uint, std::unique_ptr<ssolver::CPReader> > readers;
 
-    PatchPVecCI patch_e = pPatches.end();
-    for (PatchPVecCI p = pPatches.begin(); p != patch_e; ++p) (*p)->checkpoint(cp_file);
+    CPParts(std::string const & file_name, uint64_t model_fp, uint64_t mesh_fp)
+    : fileName(file_name)
+    , modelFP(model_fp)
+    , meshFP(mesh_fp)
+    , readers()
+    {}
 
-    DiffBoundaryPVecCI db_e = pDiffBoundaries.end();
-    for (DiffBoundaryPVecCI db = pDiffBoundaries.begin(); db != db_e; ++db) {
-        (*db)->checkpoint(cp_file);
+    ssolver::CPReader & get(uint rank)
+    {
+        std::unique_ptr<ssolver::CPReader> & r = readers[rank];
+        if (!r)
+        {
+            r.reset(new ssolver::CPReader(cp_part_name(fileName, rank)));
+            r->checkFingerprints(modelFP, meshFP);
+            r->verify();
+        }
+        return *r;
     }
+};
 
-    SDiffBoundaryPVecCI sdb_e = pSDiffBoundaries.end();
-    for (SDiffBoundaryPVecCI sdb = pSDiffBoundaries.begin(); sdb != sdb_e; ++sdb) {
-        (*sdb)->checkpoint(cp_file);
-    }
+////////////////////////////////////////////////////////////////////////////////
 
-    WmVolPVecCI wmv_e = pWmVols.end();
-    for (WmVolPVecCI wmv = pWmVols.begin(); wmv != wmv_e; ++wmv)
+// Cursor over the state of element i of a section in the part file of
+// its owner.
+static ssolver::CPCursor & cp_seek(std::map<uint, ssolver::CPCursor> & cursors, CPParts & parts,
+                                   uint section, uint owner, uint i)
+{
+    auto c = cursors.find(owner);
+    if (c == cursors.end() && owner != ssolver::CP_NO_OWNER)
     {
-        if ((*wmv) != 0) {
-            (*wmv)->checkpoint(cp_file);
-        }
+        c = cursors.emplace(std::piecewise_construct, std::forward_as_tuple(owner),
+                            std::forward_as_tuple(parts.get(owner), section)).first;
+    }
+    if (c == cursors.end() || !c->second.seek(i))
+    {
+        std::ostringstream os;
+        os << "Element " << i << " of checkpoint section " << section;
+        os << " is missing from " << parts.fileName << ".";
+        throw steps::ArgErr(os.str());
     }
+    return c->second;
+}
 
+////////////////////////////////////////////////////////////////////////////////
 
-    TetPVecCI tet_e = pTets.end();
-    for (TetPVecCI t = pTets.begin(); t != tet_e; ++t)
+// Write the elements hosted on this rank, each followed by its kprocs, as
+// one section of a part file, together with the index of the section.
+template <typename C>
+static void cp_write_section(ssolver::CPWriter & cp, uint section, C const & elems)
+{
+    ssolver::CPColumns cols;
+    std::vector<ssolver::CPIndexEntry> index;
+    for (uint i = 0; i < elems.size(); ++i)
     {
-        if ((*t) != 0) {
-        (*t)->checkpoint(cp_file);
-        }
+        auto e = elems[i];
+        if (e == 0 || !e->getInHost()) continue;
+        index.push_back(cols.entry(i));
+        e->checkpointColumns(cols);
+        for (auto kp: e->kprocs()) kp->checkpointColumns(cols);
     }
+    index.push_back(cols.entry(std::numeric_limits<uint64_t>::max()));
+    cp.write(section, cols);
+    cp.write(section + ssolver::CP_COLUMN_INDEX, index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    TriPVecCI tri_e = pTris.end();
-    for (TriPVecCI t = pTris.begin(); t != tri_e; ++t)
+// Check, without changing any state, that the part files of a checkpoint
+// written by nranks ranks hold the state of every element hosted on this
+// rank, in the columns it would write itself.
+template <typename C>
+static void cp_check_section(ssolver::CPReader const & index, uint section,
+                             C const & elems, uint nranks, CPParts & parts)
+{
+    std::vector<uint> owners(elems.size());
+    index.read(section + ssolver::CP_COLUMN_OWNERS, owners);
+
+    std::map<uint, ssolver::CPCursor> cursors;
+    ssolver::CPColumns cols;
+    for (uint i = 0; i < elems.size(); ++i)
     {
-        if ((*t) != 0) {
-            (*t)->checkpoint(cp_file);
+        auto e = elems[i];
+        if (e == 0 || !e->getInHost()) continue;
+
+        uint owner = owners[i];
+        if (owner != ssolver::CP_NO_OWNER && owner >= nranks)
+        {
+            std::ostringstream os;
+            os << "Checkpoint file " << parts.fileName << " gives element " << i;
+            os << " of section " << section << " to rank " << owner;
+            os << " of " << nranks << ".";
+            throw steps::ArgErr(os.str());
         }
+
+        cols.clear();
+        e->checkpointColumns(cols);
+        for (auto kp: e->kprocs()) kp->checkpointColumns(cols);
+        cp_seek(cursors, parts, section, owner, i).checkColumns(cols);
     }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Restore the elements hosted on this rank, and their kprocs, from the
+// part files of the ranks that hosted them when the checkpoint was written.
+template <typename C>
+static void cp_restore_section(ssolver::CPReader const & index, uint section,
+                               C const & elems, CPParts & parts)
+{
+    std::vector<uint> owners(elems.size());
+    index.read(section + ssolver::CP_COLUMN_OWNERS, owners);
 
-    KProcPVecCI e = pKProcs.end();
-    for (KProcPVecCI i = pKProcs.begin(); i != e; ++i) (*i)->checkpoint(cp_file);
+    std::map<uint, ssolver::CPCursor> cursors;
+    for (uint i = 0; i < elems.size(); ++i)
+    {
+        auto e = elems[i];
+        if (e == 0 || !e->getInHost()) continue;
 
-    if (efflag()) {
-        cp_file.write((char*)&pTemp, sizeof(double));
-        cp_file.write((char*)&pEFDT, sizeof(double));
-        pEField->checkpoint(cp_file);
+        ssolver::CPCursor & cur = cp_seek(cursors, parts, section, owners[i], i);
+        e->restoreColumns(cur);
+        for (auto kp: e->kprocs()) kp->restoreColumns(cur);
+        cur.finish();
     }
+}
 
-    cp_file.write((char*)&nEntries, sizeof(uint));
+///////////////////////////////////////////////////////////////////////////////
 
-    // checkpoint CR SSA
+void smtos::TetOpSplitP::checkpoint(std::string const & file_name)
+{
+    uint64_t model_fp = statedef()->fingerprint();
+    uint64_t mesh_fp = _cpMeshFingerprint();
 
-    cp_file.write((char*)&pSum, sizeof(double));
-    cp_file.write((char*)&nSum, sizeof(double));
-    cp_file.write((char*)&pA0, sizeof(double));
+    // Every rank writes the elements it hosts, their kprocs and its
+    // generator to a part file of its own.
+    {
+        ssolver::CPWriter cp(cp_part_name(file_name, myRank), model_fp, mesh_fp);
 
-    uint n_ngroups = nGroups.size();
-    uint n_pgroups = pGroups.size();
+        rng()->checkpoint(cp.beginStream(ssolver::CP_BLOCK_RNG));
+        cp.endStream();
 
-    cp_file.write((char*)&n_ngroups, sizeof(uint));
-    cp_file.write((char*)&n_pgroups, sizeof(uint));
+        double reals[6] = {reacExtent, diffExtent, nIteration, pSum, nSum, pA0};
+        cp.write(ssolver::CP_BLOCK_SOLVER_REALS, reals, 6);
 
-    for (uint i = 0; i < n_ngroups; i++) {
-        CRGroup* group = nGroups[i];
-        cp_file.write((char*)&(group->capacity), sizeof(unsigned));
-        cp_file.write((char*)&(group->size), sizeof(unsigned));
-        cp_file.write((char*)&(group->max), sizeof(double));
-        cp_file.write((char*)&(group->sum), sizeof(double));
+        cp_write_section(cp, ssolver::CP_SECTION_WMVOL, pWmVols);
+        cp_write_section(cp, ssolver::CP_SECTION_TET, pTets);
+        cp_write_section(cp, ssolver::CP_SECTION_TRI, pTris);
+        _cpWriteCR(cp);
+        cp.close();
+    }
 
-        for (uint j = 0; j < group->size; j++) {
-            uint idx = group->indices[j]->schedIDX();
-            cp_file.write((char*)&idx, sizeof(uint));
+    // Extents summed over all ranks, for restoring onto a different
+    // number of ranks.
+    double extents[2] = {reacExtent, diffExtent};
+    MPI_Allreduce(MPI_IN_PLACE, extents, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    // Potential and specific capacitance of every EField vertex. A
+    // distributed EField gathers them from the owners of the vertices
+    // and is saved as these alone.
+    std::vector<double> verts_v, verts_capac;
+    if (efdist())
+    {
+        uint nverts = pEFVertIdcs.size();
+        verts_v.assign(nverts, 0.0);
+        verts_capac.assign(nverts, 0.0);
+        for (uint v = 0; v < nverts; ++v)
+        {
+            int vlidx = pEFVert_GtoL[pEFVertIdcs[v]];
+            if (vlidx == -1) continue;
+            if (pEFVertHosts[pEFVertIdcs[v]] == myRank) verts_v[v] = pEField->getVertV(vlidx);
+            verts_capac[v] = pEField->getVertCapac(vlidx);
+        }
+        MPI_Allreduce(MPI_IN_PLACE, verts_v.data(), nverts, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, verts_capac.data(), nverts, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    }
+    else if (efflag() && myRank == 0)
+    {
+        verts_v.resize(pEFNVerts);
+        verts_capac.resize(pEFNVerts);
+        for (uint vlidx = 0; vlidx < pEFNVerts; vlidx++)
+        {
+            verts_v[vlidx] = pEField->getVertV(vlidx);
+            verts_capac[vlidx] = pEField->getVertCapac(vlidx);
         }
     }
 
-    for (uint i = 0; i < n_pgroups; i++) {
-        CRGroup* group = pGroups[i];
-        cp_file.write((char*)&(group->capacity), sizeof(unsigned));
-        cp_file.write((char*)&(group->size), sizeof(unsigned));
-        cp_file.write((char*)&(group->max), sizeof(double));
-        cp_file.write((char*)&(group->sum), sizeof(double));
+    // Rank 0 writes the index file with the replicated state and the
+    // rank that wrote each element.
+    if (myRank == 0)
+    {
+        ssolver::CPWriter cp(file_name, model_fp, mesh_fp);
+
+        statedef()->checkpoint(cp.beginStream(ssolver::CP_BLOCK_STATEDEF));
+        cp.endStream();
 
-        for (uint j = 0; j < group->size; j++) {
-            uint idx = group->indices[j]->schedIDX();
-            cp_file.write((char*)&idx, sizeof(uint));
+        if (efflag())
+        {
+            if (efdist() == false)
+            {
+                pEField->checkpoint(cp.beginStream(ssolver::CP_BLOCK_EFIELD));
+                cp.endStream();
+            }
+            cp.write(ssolver::CP_BLOCK_EFIELD_V, verts_v);
+            cp.write(ssolver::CP_BLOCK_EFIELD_CAPAC, verts_capac);
+            cp.write(ssolver::CP_BLOCK_EFIELD_VOLRES, &pEFVolRes, 1);
         }
-    }
 
-    cp_file.close();
-    //std::cout << "complete.\n";
+        uint uints[1] = {static_cast<uint>(nHosts)};
+        cp.write(ssolver::CP_BLOCK_SOLVER_UINTS, uints, 1);
+        double reals[5] = {pTemp, pEFDT, extents[0], extents[1], nIteration};
+        cp.write(ssolver::CP_BLOCK_SOLVER_REALS, reals, 5);
+
+        for (auto section: {ssolver::CP_SECTION_WMVOL, ssolver::CP_SECTION_TET, ssolver::CP_SECTION_TRI})
+            cp.write(section + ssolver::CP_COLUMN_OWNERS, _cpOwners(section));
+        cp.close();
+    }
 
-    */
+    MPI_Barrier(MPI_COMM_WORLD);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void smtos::TetOpSplitP::restore(std::string const & file_name)
 {
-    std::ostringstream os;
-    os << "This function has not been implemented!";
-    throw steps::NotImplErr(os.str());
-    
-    /*
-    std::cout << "Restore from " << file_name << "...";
-    std::fstream cp_file;
-
-    cp_file.open(file_name.c_str(),
-                std::fstream::in | std::fstream::binary);
+    uint64_t model_fp = statedef()->fingerprint();
+    uint64_t mesh_fp = _cpMeshFingerprint();
+
+    // All ranks read the same index file, so they fail alike up to here.
+    ssolver::CPReader cp(file_name);
+    cp.checkFingerprints(model_fp, mesh_fp);
+    cp.verify();
+
+    std::vector<uint> uints(1);
+    cp.read(ssolver::CP_BLOCK_SOLVER_UINTS, uints);
+    std::vector<double> reals(5);
+    cp.read(ssolver::CP_BLOCK_SOLVER_REALS, reals);
+    uint nranks = uints[0];
+
+    // Whether every element is hosted by the rank that wrote it.
+    bool same_layout = (nranks == static_cast<uint>(nHosts));
+    for (auto section: {ssolver::CP_SECTION_WMVOL, ssolver::CP_SECTION_TET, ssolver::CP_SECTION_TRI})
+    {
+        if (same_layout == false) break;
+        uint64_t n = 0;
+        uint const * owners = cp.block<uint>(section + ssolver::CP_COLUMN_OWNERS, n);
+        std::vector<uint> hosts = _cpOwners(section);
+        same_layout = (n == hosts.size() && std::equal(hosts.begin(), hosts.end(), owners));
+    }
+
+    // A replicated EField restores its whole state where saved, and
+    // otherwise, like a distributed one, the capacitances alone.
+    bool whole = (efdist() == false && cp.has(ssolver::CP_BLOCK_EFIELD));
+    uint64_t nverts = 0;
+    double const * verts_v = 0;
+    uint64_t ncapac = 0;
+    double const * verts_capac = 0;
+    uint nefverts = efdist() ? pEFVertIdcs.size() : pEFNVerts;
+    if (efflag())
+    {
+        verts_v = cp.block<double>(ssolver::CP_BLOCK_EFIELD_V, nverts);
+        if (whole == false) verts_capac = cp.block<double>(ssolver::CP_BLOCK_EFIELD_CAPAC, ncapac);
+        if (nverts != nefverts || (whole == false && ncapac != nefverts))
+        {
+            std::ostringstream os;
+            os << "Checkpoint file " << file_name << " does not match the simulation.";
+            throw steps::ArgErr(os.str());
+        }
+    }
 
-    cp_file.seekg(0);
+    // Each rank checks the part files of the previous hosts of the
+    // elements it now hosts, and the ranks agree on the outcome before
+    // any state changes, so that a failed restore leaves the simulation
+    // as it was on every rank.
+    CPParts parts(file_name, model_fp, mesh_fp);
+    std::vector<double> local(6);
+    std::string err;
+    try
+    {
+        cp_check_section(cp, ssolver::CP_SECTION_WMVOL, pWmVols, nranks, parts);
+        cp_check_section(cp, ssolver::CP_SECTION_TET, pTets, nranks, parts);
+        cp_check_section(cp, ssolver::CP_SECTION_TRI, pTris, nranks, parts);
+        if (same_layout)
+        {
+            ssolver::CPReader & part = parts.get(myRank);
+            uint64_t nrng = 0;
+            part.block<char>(ssolver::CP_BLOCK_RNG, nrng);
+            part.read(ssolver::CP_BLOCK_SOLVER_REALS, local);
+            _cpCheckCR(part);
+        }
+    }
+    catch (steps::Err & e)
+    {
+        err = e.getMsg();
+    }
 
-    statedef()->restore(cp_file);
+    // Make every rank fail if one did, rather than leave the others
+    // waiting in the next collective call.
+    int failed = !err.empty();
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (failed)
+    {
+        if (err.empty()) err = "Restore failed on another rank.";
+        throw steps::ArgErr(err);
+    }
 
-    CompPVecCI comp_e = pComps.end();
-    for (CompPVecCI c = pComps.begin(); c != comp_e; ++c) (*c)->restore(cp_file);
+    statedef()->restore(cp.stream(ssolver::CP_BLOCK_STATEDEF));
 
-    PatchPVecCI patch_e = pPatches.end();
-    for (PatchPVecCI p = pPatches.begin(); p != patch_e; ++p) (*p)->restore(cp_file);
+    if (efflag())
+    {
+        pTemp = reals[0];
+        pEFDT = reals[1];
+        if (whole) pEField->restore(cp.stream(ssolver::CP_BLOCK_EFIELD));
+        if (cp.has(ssolver::CP_BLOCK_EFIELD_VOLRES))
+        {
+            std::vector<double> volres(1);
+            cp.read(ssolver::CP_BLOCK_EFIELD_VOLRES, volres);
+            pEFVolRes = volres[0];
+            if (whole == false) pEField->setMembVolRes(0, pEFVolRes);
+        }
 
-    DiffBoundaryPVecCI db_e = pDiffBoundaries.end();
-    for (DiffBoundaryPVecCI db = pDiffBoundaries.begin(); db != db_e; ++db) {
-        (*db)->restore(cp_file);
+        for (uint v = 0; v < nefverts; v++)
+        {
+            int vlidx = efdist() ? pEFVert_GtoL[pEFVertIdcs[v]] : static_cast<int>(v);
+            if (vlidx == -1) continue;
+            pEField->setVertV(vlidx, verts_v[v]);
+            if (whole == false) pEField->setVertCapac(vlidx, verts_capac[v]);
+        }
+        _refreshEFTrisV();
     }
 
-    SDiffBoundaryPVecCI sdb_e = pSDiffBoundaries.end();
-    for (SDiffBoundaryPVecCI sdb = pSDiffBoundaries.begin(); sdb != sdb_e; ++sdb) {
-        (*sdb)->restore(cp_file);
-    }
+    // Each rank pulls the elements it now hosts from the part files of
+    // their previous hosts, so the checkpoint can be restored onto any
+    // partition and number of ranks.
+    cp_restore_section(cp, ssolver::CP_SECTION_WMVOL, pWmVols, parts);
+    cp_restore_section(cp, ssolver::CP_SECTION_TET, pTets, parts);
+    cp_restore_section(cp, ssolver::CP_SECTION_TRI, pTris, parts);
 
-    WmVolPVecCI wmv_e = pWmVols.end();
-    for (WmVolPVecCI wmv = pWmVols.begin(); wmv != wmv_e; ++wmv)
+    // On the same partition the generators and the scheduler continue
+    // exactly where they were; otherwise the generators keep their
+    // current state and the scheduler is rebuilt below.
+    if (same_layout)
     {
-        if ((*wmv) != 0) {
-            (*wmv)->restore(cp_file);
-        }
+        ssolver::CPReader & part = parts.get(myRank);
+        rng()->restore(part.stream(ssolver::CP_BLOCK_RNG));
+
+        reacExtent = local[0];
+        diffExtent = local[1];
+        nIteration = local[2];
+        pSum = local[3];
+        nSum = local[4];
+        pA0 = local[5];
+
+        _cpRestoreCR(part);
+        MPI_Barrier(MPI_COMM_WORLD);
+        return;
     }
 
-    TetPVecCI tet_e = pTets.end();
-    for (TetPVecCI t = pTets.begin(); t != tet_e; ++t)
+    reacExtent = (myRank == 0) ? reals[2] : 0.0;
+    diffExtent = (myRank == 0) ? reals[3] : 0.0;
+    nIteration = reals[4];
+
+    // Rebuild the composition-rejection groups from the restored state.
+    for (auto g: nGroups)
     {
-        if ((*t) != 0) {
-            (*t)->restore(cp_file);
-        }
+        g->free_indices();
+        delete g;
     }
-    TriPVecCI tri_e = pTris.end();
-    for (TriPVecCI t = pTris.begin(); t != tri_e; ++t)
+    nGroups.clear();
+    for (auto g: pGroups)
     {
-        if ((*t) != 0) {
-            (*t)->restore(cp_file);
-        }
+        g->free_indices();
+        delete g;
     }
+    pGroups.clear();
 
-    KProcPVecCI e = pKProcs.end();
-    for (KProcPVecCI i = pKProcs.begin(); i != e; ++i) (*i)->restore(cp_file);
+    pSum = 0.0;
+    nSum = 0.0;
+    pA0 = 0.0;
+    _updateLocal();
 
+    recomputeUpdPeriod = true;
+    MPI_Barrier(MPI_COMM_WORLD);
+}
 
+///////////////////////////////////////////////////////////////////////////////
 
-    if (efflag()) {
-        cp_file.read((char*)&pTemp, sizeof(double));
-        cp_file.read((char*)&pEFDT, sizeof(double));
-        pEField->restore(cp_file);
+void smtos::TetOpSplitP::_cpWriteCR(ssolver::CPWriter & cp) const
+{
+    // Composition-rejection data of the kprocs hosted on this rank, in
+    // schedule order.
+    std::vector<uint> recorded;
+    std::vector<int> pows;
+    std::vector<uint> poss;
+    std::vector<double> rates;
+    for (auto kp: pKProcs)
+    {
+        if (kp == 0) continue;
+        recorded.push_back(kp->crData.recorded);
+        pows.push_back(kp->crData.pow);
+        poss.push_back(kp->crData.pos);
+        rates.push_back(kp->crData.rate);
+    }
+    cp.write(ssolver::CP_BLOCK_CR_RECORDED, recorded);
+    cp.write(ssolver::CP_BLOCK_CR_POW, pows);
+    cp.write(ssolver::CP_BLOCK_CR_POS, poss);
+    cp.write(ssolver::CP_BLOCK_CR_RATE, rates);
+
+    std::vector<uint> sizes;
+    std::vector<double> sums;
+    std::vector<uint> indices;
+    sizes.push_back(nGroups.size());
+    sizes.push_back(pGroups.size());
+    for (auto groups: {&nGroups, &pGroups})
+    {
+        for (auto group: *groups)
+        {
+            sizes.push_back(group->capacity);
+            sizes.push_back(group->size);
+            sums.push_back(group->max);
+            sums.push_back(group->sum);
+            for (uint i = 0; i < group->size; ++i)
+                indices.push_back(group->indices[i]->schedIDX());
+        }
     }
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_SIZES, sizes);
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_SUMS, sums);
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_INDICES, indices);
+
+    uint uints[2] = {nEntries, static_cast<uint>(recorded.size())};
+    cp.write(ssolver::CP_BLOCK_SOLVER_UINTS, uints, 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_cpCheckCR(ssolver::CPReader const & cp) const
+{
+    uint64_t nuints = 0, nrecorded = 0, npows = 0, nposs = 0, nrates = 0;
+    uint64_t nsizes = 0, nsums = 0, nindices = 0;
+    uint const * uints = cp.block<uint>(ssolver::CP_BLOCK_SOLVER_UINTS, nuints);
+    cp.block<uint>(ssolver::CP_BLOCK_CR_RECORDED, nrecorded);
+    cp.block<int>(ssolver::CP_BLOCK_CR_POW, npows);
+    cp.block<uint>(ssolver::CP_BLOCK_CR_POS, nposs);
+    cp.block<double>(ssolver::CP_BLOCK_CR_RATE, nrates);
+    uint const * sizes = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_SIZES, nsizes);
+    cp.block<double>(ssolver::CP_BLOCK_CR_GROUP_SUMS, nsums);
+    uint const * indices = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_INDICES, nindices);
 
-    uint stored_entries = 0;
-    cp_file.read((char*)&stored_entries, sizeof(uint));
+    uint nhosted = std::count_if(pKProcs.begin(), pKProcs.end(),
+                                 [](KProc * kp) { return kp != 0; });
+    uint n_ngroups = (nsizes >= 2) ? sizes[0] : 0;
+    uint n_pgroups = (nsizes >= 2) ? sizes[1] : 0;
+    uint ngroups = n_ngroups + n_pgroups;
+    bool valid = (nuints == 2 && uints[0] == nEntries && uints[1] == nhosted
+                  && nrecorded == nhosted && npows == nhosted && nposs == nhosted
+                  && nrates == nhosted
+                  && nsizes == 2 + 2 * static_cast<uint64_t>(ngroups)
+                  && nsums == 2 * static_cast<uint64_t>(ngroups));
 
-    if (stored_entries != nEntries) {
+    uint64_t total = 0;
+    for (uint i = 0; valid && i < ngroups; ++i)
+    {
+        valid = (sizes[3 + 2 * i] <= sizes[2 + 2 * i]);
+        total += sizes[3 + 2 * i];
+    }
+    for (uint64_t i = 0; valid && i < nindices; ++i)
+        valid = (indices[i] < nEntries && pKProcs[indices[i]] != 0);
+    if (valid == false || total != nindices)
+    {
         std::ostringstream os;
-        os << "Unknown Restore Error!";
+        os << "Checkpoint has inconsistent CR data for rank " << myRank << ".";
         throw steps::ArgErr(os.str());
     }
 
-    // restore CR SSA
-    cp_file.read((char*)&pSum, sizeof(double));
-    cp_file.read((char*)&nSum, sizeof(double));
-    cp_file.read((char*)&pA0, sizeof(double));
-
-    uint n_ngroups;
-    uint n_pgroups;
-
-    cp_file.read((char*)&n_ngroups, sizeof(uint));
-    cp_file.read((char*)&n_pgroups, sizeof(uint));
+}
 
-    nGroups.resize(n_ngroups);
-    pGroups.resize(n_pgroups);
+///////////////////////////////////////////////////////////////////////////////
 
-    for (uint i = 0; i < n_ngroups; i++) {
-        unsigned capacity;
-        unsigned size;
-        double max;
-        double sum;
+void smtos::TetOpSplitP::_cpRestoreCR(ssolver::CPReader const & cp)
+{
+    _cpCheckCR(cp);
 
-        cp_file.read((char*)&capacity, sizeof(unsigned));
-        cp_file.read((char*)&size, sizeof(unsigned));
-        cp_file.read((char*)&max, sizeof(double));
-        cp_file.read((char*)&sum, sizeof(double));
+    uint64_t nrecorded = 0, npows = 0, nposs = 0, nrates = 0;
+    uint64_t nsizes = 0, nsums = 0, nindices = 0;
+    uint const * recorded = cp.block<uint>(ssolver::CP_BLOCK_CR_RECORDED, nrecorded);
+    int const * pows = cp.block<int>(ssolver::CP_BLOCK_CR_POW, npows);
+    uint const * poss = cp.block<uint>(ssolver::CP_BLOCK_CR_POS, nposs);
+    double const * rates = cp.block<double>(ssolver::CP_BLOCK_CR_RATE, nrates);
+    uint const * sizes = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_SIZES, nsizes);
+    double const * sums = cp.block<double>(ssolver::CP_BLOCK_CR_GROUP_SUMS, nsums);
+    uint const * indices = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_INDICES, nindices);
+    uint n_ngroups = sizes[0];
+    uint n_pgroups = sizes[1];
+    uint ngroups = n_ngroups + n_pgroups;
 
-        nGroups[i] = new CRGroup(0, capacity);
-        nGroups[i]->size = size;
-        nGroups[i]->max = max;
-        nGroups[i]->sum = sum;
+    uint k = 0;
+    for (auto kp: pKProcs)
+    {
+        if (kp == 0) continue;
+        kp->crData.recorded = recorded[k];
+        kp->crData.pow = pows[k];
+        kp->crData.pos = poss[k];
+        kp->crData.rate = rates[k];
+        ++k;
+    }
 
-        for (uint j = 0; j < size; j++) {
-            uint idx;
-            cp_file.read((char*)&idx, sizeof(uint));
-            nGroups[i]->indices[j] = pKProcs[idx];
-        }
+    for (auto g: nGroups)
+    {
+        g->free_indices();
+        delete g;
+    }
+    for (auto g: pGroups)
+    {
+        g->free_indices();
+        delete g;
     }
+    nGroups.resize(n_ngroups);
+    pGroups.resize(n_pgroups);
 
-    for (uint i = 0; i < n_pgroups; i++) {
-        unsigned capacity;
-        unsigned size;
-        double max;
-        double sum;
+    uint64_t next_index = 0;
+    for (uint i = 0; i < ngroups; ++i)
+    {
+        CRGroup * group = new CRGroup(0, sizes[2 + 2 * i]);
+        group->size = sizes[3 + 2 * i];
+        group->max = sums[2 * i];
+        group->sum = sums[2 * i + 1];
+        for (uint j = 0; j < group->size; ++j)
+            group->indices[j] = pKProcs[indices[next_index++]];
 
-        cp_file.read((char*)&capacity, sizeof(unsigned));
-        cp_file.read((char*)&size, sizeof(unsigned));
-        cp_file.read((char*)&max, sizeof(double));
-        cp_file.read((char*)&sum, sizeof(double));
+        if (i < n_ngroups) nGroups[i] = group;
+        else pGroups[i - n_ngroups] = group;
+    }
+}
 
-        pGroups[i] = new CRGroup(0, capacity);
-        pGroups[i]->size = size;
-        pGroups[i]->max = max;
-        pGroups[i]->sum = sum;
+///////////////////////////////////////////////////////////////////////////////
 
-        for (uint j = 0; j < size; j++) {
-            uint idx;
-            cp_file.read((char*)&idx, sizeof(uint));
-            pGroups[i]->indices[j] = pKProcs[idx];
-        }
+std::vector<uint> smtos::TetOpSplitP::_cpOwners(uint section) const
+{
+    std::vector<uint> owners;
+    if (section == ssolver::CP_SECTION_WMVOL)
+    {
+        owners.assign(pWmVols.size(), ssolver::CP_NO_OWNER);
+        for (uint i = 0; i < pWmVols.size(); ++i)
+            if (pWmVols[i] != 0) owners[i] = pWmVols[i]->getHost();
     }
+    else if (section == ssolver::CP_SECTION_TET)
+    {
+        owners.assign(pTets.size(), ssolver::CP_NO_OWNER);
+        for (uint i = 0; i < pTets.size(); ++i)
+            if (pMesh->getTetComp(i) != 0) owners[i] = tetHosts[i];
+    }
+    else
+    {
+        owners.assign(pTris.size(), ssolver::CP_NO_OWNER);
+        for (auto const & th: triHosts)
+            if (pMesh->getTriPatch(th.first) != 0) owners[th.first] = th.second;
+    }
+    return owners;
+}
 
-    cp_file.close();
-
-    //std::cout << "complete.\n";
+///////////////////////////////////////////////////////////////////////////////
 
-    */
+steps::util::hash_type smtos::TetOpSplitP::_cpMeshFingerprint(void) const
+{
+    return steps::util::fnv1a_combine(mesh()->fingerprint(), efflag());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -511,8 +922,6 @@ void smtos::TetOpSplitP::_setup(void)
     uint ntris = mesh()->countTris();
     uint ncomps = mesh()->_countComps();
 
-    pTets.assign(ntets, NULL);
-    pTris.assign(ntris, NULL);
     pWmVols.assign(ncomps, NULL);
     diffSep = 0;
     sdiffSep = 0;
@@ -553,7 +962,37 @@ void smtos::TetOpSplitP::_setup(void)
 
     uint npatches = pPatches.size();
     assert (mesh()->_countPatches() == npatches);
-    int rk; MPI_Comm_rank(MPI_COMM_WORLD, &rk);
+
+    // Create a map between edges and adjacent tris.
+    // We need to go through all patches to record bar2tri mapping
+    // for all connected triangle neighbors even they are in different
+    // patches, because their information is needed for surface diffusion boundary
+    std::map<uint, std::vector<uint> > bar2tri;
+    for (uint bar_p = 0; bar_p < npatches; ++bar_p) {
+
+        steps::tetmesh::TmPatch *bar_patch = dynamic_cast<steps::tetmesh::TmPatch*>(pMesh->_getPatch(bar_p));
+        if (!bar_patch) continue;
+
+        for (uint tri: bar_patch->_getAllTriIndices())
+        {
+            const uint *bars = pMesh->_getTriBars(tri);
+            for (int i = 0; i < 3; ++i)
+                bar2tri[bars[i]].push_back(tri);
+        }
+    }
+
+    if (pDistElems)
+    {
+        std::vector<uint> local_tets, local_tris;
+        _localElems(bar2tri, local_tets, local_tris);
+        pTets.assign(ntets, local_tets);
+        pTris.assign(ntris, local_tris);
+    }
+    else
+    {
+        pTets.assign(ntets);
+        pTris.assign(ntris);
+    }
 
     for (uint p = 0; p < npatches; ++p)
     {
@@ -568,46 +1007,14 @@ void smtos::TetOpSplitP::_setup(void)
 
         steps::mpi::tetopsplit::Patch *localpatch = pPatches[p];
 
-        /*** Previous impl
-        // Create a map between edges and adjacent tris in this patch
-        std::map<uint, std::vector<uint> > bar2tri;
-        for (uint tri: tmpatch->_getAllTriIndices()) 
-        {
-            const uint *bars = pMesh->_getTriBars(tri);
-            for (int i = 0; i < 3; ++i)
-                bar2tri[bars[i]].push_back(tri);
-        }
-
-        for (uint tri: tmpatch->_getAllTriIndices()) 
-        ***/
-
-        // Create a map between edges and adjacent tris in this patch
-        std::map<uint, std::vector<uint> > bar2tri;
-
-        // We need to go through all patches to record bar2tri mapping
-        // for all connected triangle neighbors even they are in different
-        // patches, because their information is needed for surface diffusion boundary
-
-        for (uint bar_p = 0; bar_p < npatches; ++bar_p) {
-
-            steps::tetmesh::TmPatch *bar_patch = dynamic_cast<steps::tetmesh::TmPatch*>(pMesh->_getPatch(bar_p));
-
-            for (uint tri: bar_patch->_getAllTriIndices())
-            {
-                const uint *bars = pMesh->_getTriBars(tri);
-                for (int i = 0; i < 3; ++i)
-                    bar2tri[bars[i]].push_back(tri);
-            }
-        }
-
         auto tri_idxs = tmpatch->_getAllTriIndices();
 
 #pragma omp parallel for
         for (int i = 0; i< tri_idxs.size(); ++i) 
-        //*** end of new impl
         {
             auto tri = tri_idxs[i];
             assert (pMesh->getTriPatch(tri) == tmpatch);
+            if (pTris.localIdx(tri) < 0) continue;
 
             double area = pMesh->getTriArea(tri);
 
@@ -624,7 +1031,7 @@ void smtos::TetOpSplitP::_setup(void)
             std::vector<int> tris(3, -1);
             for (int j = 0; j < 3; ++j)
             {
-                std::vector<uint> neighb_tris = bar2tri[tri_bars[j]];
+                std::vector<uint> const & neighb_tris = bar2tri.at(tri_bars[j]);
                 for (int k = 0; k < neighb_tris.size(); ++k)
                 {
                     if (neighb_tris[k] == tri || pMesh->getTriPatch(neighb_tris[k])  == nullptr)
@@ -665,6 +1072,7 @@ void smtos::TetOpSplitP::_setup(void)
              for (uint tet: tmcomp->_getAllTetIndices())
              {
                  assert (pMesh->getTetComp(tet) == tmcomp);
+                 if (pTets.localIdx(tet) < 0) continue;
 
                  double vol = pMesh->getTetVol(tet);
 
@@ -715,6 +1123,7 @@ void smtos::TetOpSplitP::_setup(void)
 
                 for (uint tri: comp_opatch->_getAllTriIndices())
                 {
+                    if (pTris[tri] == 0) continue;
                     pTris[tri]->setInnerTet(pWmVols[c]);
                     // Add triangle to WmVols' table of neighbouring triangles.
                     pWmVols[c]->setNextTri(pTris[tri]);
@@ -734,6 +1143,7 @@ void smtos::TetOpSplitP::_setup(void)
 
                 for (uint tri: comp_ipatch->_getAllTriIndices())
                 {
+                    if (pTris[tri] == 0) continue;
                     pTris[tri]->setOuterTet(pWmVols[c]);
                     // Add triangle to WmVols' table of neighbouring triangles.
                     pWmVols[c]->setNextTri(pTris[tri]);
@@ -751,8 +1161,9 @@ void smtos::TetOpSplitP::_setup(void)
     assert (ntets == pTets.size());
     // pTets member size of all tets in geometry, but may not be filled with
     // local tets if they have not been added to a compartment
-    for (uint t = 0; t < ntets; ++t)
+    for (uint l = 0; l < pTets.countLocal(); ++l)
     {
+        uint t = pTets.globalIdx(l);
         if (pTets[t] == 0) continue;
 
         for (uint j = 0; j < 4; ++j) {
@@ -764,9 +1175,10 @@ void smtos::TetOpSplitP::_setup(void)
     }
     assert (ntris == pTris.size());
 
-    for (uint t = 0; t < ntris; ++t)
+    for (uint l = 0; l < pTris.countLocal(); ++l)
     {
         // Looping over all possible tris, but only some have been added to a patch
+        uint t = pTris.globalIdx(l);
         if (pTris[t] == 0) continue;
 
         for (uint j = 0; j < 3; ++j) {
@@ -888,23 +1300,18 @@ void smtos::TetOpSplitP::_setup(void)
             int tetBidx = tri_tets[1];
             assert(tetAidx >= 0 && tetBidx >= 0);
 
-            steps::mpi::tetopsplit::Tet * tetA = _tet(tetAidx);
-            steps::mpi::tetopsplit::Tet * tetB = _tet(tetBidx);
-            assert(tetA != 0 && tetB != 0);
-
-            steps::solver::Compdef *tetA_cdef = tetA->compdef();
-            steps::solver::Compdef *tetB_cdef = tetB->compdef();
+            steps::solver::Compdef *tetA_cdef = _tetCompdef(tetAidx);
             assert(tetA_cdef != 0);
-            assert(tetB_cdef != 0);
+            assert(_tetCompdef(tetBidx) != 0);
 
             if (tetA_cdef != compAdef)
             {
-                assert(tetB_cdef == compAdef);
+                assert(_tetCompdef(tetBidx) == compAdef);
                 assert(tetA_cdef == compBdef);
             }
             else
             {
-                assert(tetB_cdef == compBdef);
+                assert(_tetCompdef(tetBidx) == compBdef);
                 assert(tetA_cdef == compAdef);
             }
 
@@ -932,8 +1339,8 @@ void smtos::TetOpSplitP::_setup(void)
             assert (direction_idx_b != -1);
 
             // Set the tetrahedron and direction to the Diff Boundary object
-            localdiffb->setTetDirection(tetAidx, direction_idx_a);
-            localdiffb->setTetDirection(tetBidx, direction_idx_b);
+            if (pTets[tetAidx] != 0) localdiffb->setTetDirection(tetAidx, direction_idx_a);
+            if (pTets[tetBidx] != 0) localdiffb->setTetDirection(tetBidx, direction_idx_b);
         }
         localdiffb->setComps(_comp(compAidx), _comp(compBidx));
 
@@ -981,23 +1388,18 @@ void smtos::TetOpSplitP::_setup(void)
             int triBidx = bar_tris[1];
             assert(triAidx >= 0 && triBidx >= 0);
 
-            steps::mpi::tetopsplit::Tri * triA = _tri(triAidx);
-            steps::mpi::tetopsplit::Tri * triB = _tri(triBidx);
-            assert(triA != 0 && triB != 0);
-
-            steps::solver::Patchdef *triA_pdef = triA->patchdef();
-            steps::solver::Patchdef *triB_pdef = triB->patchdef();
+            steps::solver::Patchdef *triA_pdef = _triPatchdef(triAidx);
             assert(triA_pdef != 0);
-            assert(triB_pdef != 0);
+            assert(_triPatchdef(triBidx) != 0);
 
             if (triA_pdef != patchAdef)
             {
-                assert(triB_pdef == patchAdef);
+                assert(_triPatchdef(triBidx) == patchAdef);
                 assert(triA_pdef == patchBdef);
             }
             else
             {
-                assert(triB_pdef == patchBdef);
+                assert(_triPatchdef(triBidx) == patchBdef);
                 assert(triA_pdef == patchAdef);
             }
 
@@ -1025,8 +1427,8 @@ void smtos::TetOpSplitP::_setup(void)
             assert (direction_idx_b != -1);
 
             // Set the tetrahedron and direction to the Diff Boundary object
-            localsdiffb->setTriDirection(triAidx, direction_idx_a);
-            localsdiffb->setTriDirection(triBidx, direction_idx_b);
+            if (pTris[triAidx] != 0) localsdiffb->setTriDirection(triAidx, direction_idx_a);
+            if (pTris[triBidx] != 0) localsdiffb->setTriDirection(triBidx, direction_idx_b);
         }
         localsdiffb->setPatches(_patch(patchAidx), _patch(patchBidx));
 
@@ -1072,64 +1474,195 @@ void smtos::TetOpSplitP::_setup(void)
     // Create EField structures if EField is to be calculated
     if (efflag() == true) _setupEField();
 
-    for (auto tet : boundaryTets) {
-        tet->setupBufferLocations();
-    }
-    for (auto tri : boundaryTris) {
-        tri->setupBufferLocations();
-    }
     // just in case
     neighbHosts.erase(myRank);
     nNeighbHosts = neighbHosts.size();
     
-    // construct remote molecule change buffers
-    remoteChanges.clear();
-    for (auto neighbor : neighbHosts) {
-        remoteChanges[neighbor] = std::vector<uint> ();
-    }
-    
     nEntries = pKProcs.size();
     diffSep=pDiffs.size();
     sdiffSep=pSDiffs.size();
+    _setupDiffComm();
     _updateLocal();
     
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP::_setupEField(void)
+void smtos::TetOpSplitP::_localElems(std::map<uint, std::vector<uint> > const & bar2tri,
+                                     std::vector<uint> & tets, std::vector<uint> & tris) const
 {
-    using steps::math::point3d;
-    using namespace steps::solver::efield;
+    tets.clear();
+    tris.clear();
+    uint rank = static_cast<uint>(myRank);
 
-    //// Note to self: for now roughly following flow from original code in sim/controller.py.
-    //// code for setting up a mesh was in func_tetmesh constructor and called functions.
-
-    assert(efflag() == true);
+    uint ntets = mesh()->countTets();
+    for (uint t = 0; t < ntets; ++t)
+    {
+        if (pMesh->getTetComp(t) == 0 || tetHosts[t] != rank) continue;
+        tets.push_back(t);
 
-    switch (pEFoption) {
-    case EF_DEFAULT:
-    case EF_DV_BDSYS:
-        pEField = make_EField<dVSolverBanded>();
-        break;
-    case EF_DV_SLUSYS:
-        pEField = make_EField<dVSolverSLU>(MPI_COMM_WORLD);
-        break;
-#ifdef USE_PETSC 
-    case EF_DV_PETSC:
-        pEField = make_EField<dVSolverPETSC>();
-        break;
-#endif
-    default:
-        throw steps::ArgErr("Unsupported E-Field solver.");
+        const int * tet_tets = pMesh->_getTetTetNeighb(t);
+        for (uint j = 0; j < 4; ++j)
+        {
+            if (tet_tets[j] >= 0 && pMesh->getTetComp(tet_tets[j]) != 0)
+                tets.push_back(tet_tets[j]);
+        }
+        // Surface reactions need the tris of a tet on the same host, so
+        // create them here to keep the check in the kproc dependencies.
+        const uint * tet_tris = pMesh->_getTetTriNeighb(t);
+        for (uint j = 0; j < 4; ++j)
+        {
+            if (pMesh->getTriPatch(tet_tris[j]) != 0) tris.push_back(tet_tris[j]);
+        }
     }
 
-    // Give temperature a default value of 20c
-    pTemp = 293.15;
-
-    uint nmembs = mesh()->_countMembs();
-
-    if  (nmembs != 1)
+    for (auto const & th: triHosts)
+    {
+        uint t = th.first;
+        if (th.second != rank || pMesh->getTriPatch(t) == 0) continue;
+        tris.push_back(t);
+
+        const int * tri_tets = pMesh->_getTriTetNeighb(t);
+        for (uint j = 0; j < 2; ++j)
+        {
+            if (tri_tets[j] >= 0 && pMesh->getTetComp(tri_tets[j]) != 0)
+                tets.push_back(tri_tets[j]);
+        }
+        const uint * tri_bars = pMesh->_getTriBars(t);
+        for (uint j = 0; j < 3; ++j)
+        {
+            std::vector<uint> const & neighb_tris = bar2tri.at(tri_bars[j]);
+            tris.insert(tris.end(), neighb_tris.begin(), neighb_tris.end());
+        }
+    }
+
+    // Well-mixed volumes keep all their patch tris.
+    uint ncomps = mesh()->_countComps();
+    for (uint c = 0; c < ncomps; ++c)
+    {
+        steps::wm::Comp * wmcomp = mesh()->_getComp(c);
+        if (dynamic_cast<steps::tetmesh::TmComp*>(wmcomp) != 0 || wmHosts[c] != rank) continue;
+
+        std::vector<steps::wm::Patch *> wmpatches;
+        for (uint i = 0; i < wmcomp->_countOPatches(); ++i) wmpatches.push_back(wmcomp->_getOPatch(i));
+        for (uint i = 0; i < wmcomp->_countIPatches(); ++i) wmpatches.push_back(wmcomp->_getIPatch(i));
+        for (auto wmpatch: wmpatches)
+        {
+            steps::tetmesh::TmPatch * tmpatch = dynamic_cast<steps::tetmesh::TmPatch*>(wmpatch);
+            if (tmpatch == 0) continue;
+            std::vector<uint> const & ptris = tmpatch->_getAllTriIndices();
+            tris.insert(tris.end(), ptris.begin(), ptris.end());
+        }
+    }
+
+    std::sort(tets.begin(), tets.end());
+    tets.erase(std::unique(tets.begin(), tets.end()), tets.end());
+    std::sort(tris.begin(), tris.end());
+    tris.erase(std::unique(tris.begin(), tris.end()), tris.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::Compdef * smtos::TetOpSplitP::_tetCompdef(uint tidx) const
+{
+    steps::tetmesh::TmComp * comp = pMesh->getTetComp(tidx);
+    if (comp == 0) return 0;
+    return statedef()->compdef(statedef()->getCompIdx(comp));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::Patchdef * smtos::TetOpSplitP::_triPatchdef(uint tidx) const
+{
+    steps::tetmesh::TmPatch * patch = pMesh->getTriPatch(tidx);
+    if (patch == 0) return 0;
+    return statedef()->patchdef(statedef()->getPatchIdx(patch));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_compSubvols(uint cidx, std::vector<smtos::WmVol *> & svols,
+                                      std::vector<double> & weights) const
+{
+    svols.clear();
+    weights.clear();
+
+    steps::tetmesh::TmComp * tmcomp = dynamic_cast<steps::tetmesh::TmComp*>(mesh()->_getComp(cidx));
+    if (tmcomp == 0)
+    {
+        svols.push_back(pWmVols[cidx]);
+        weights.push_back(pWmVols[cidx]->vol());
+        return;
+    }
+
+    for (uint tet: tmcomp->_getAllTetIndices())
+    {
+        svols.push_back(pTets[tet]);
+        weights.push_back(pMesh->getTetVol(tet));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_patchSubvols(uint pidx, std::vector<smtos::Tri *> & tris,
+                                       std::vector<double> & weights) const
+{
+    tris.clear();
+    weights.clear();
+
+    steps::tetmesh::TmPatch * tmpatch = dynamic_cast<steps::tetmesh::TmPatch*>(mesh()->_getPatch(pidx));
+    assert(tmpatch != 0);
+    for (uint tri: tmpatch->_getAllTriIndices())
+    {
+        tris.push_back(pTris[tri]);
+        weights.push_back(pMesh->getTriArea(tri));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_setupEField(void)
+{
+    using steps::math::point3d;
+    using namespace steps::solver::efield;
+
+    //// Note to self: for now roughly following flow from original code in sim/controller.py.
+    //// code for setting up a mesh was in func_tetmesh constructor and called functions.
+
+    assert(efflag() == true);
+
+    switch (pEFoption) {
+    case EF_DEFAULT:
+    case EF_DV_BDSYS:
+        pEField = make_EField<dVSolverBanded>();
+        break;
+    case EF_DV_PCG:
+        pEField = make_EField<dVSolverPCG>();
+        break;
+    case EF_DV_CONDENSED:
+        pEField = make_EField<dVSolverCondensed>();
+        break;
+    case EF_DV_SLUSYS:
+        pEField = make_EField<dVSolverSLU>(MPI_COMM_WORLD);
+        break;
+#ifdef USE_PETSC 
+    case EF_DV_PETSC:
+        pEField = make_EField<dVSolverPETSC>();
+        break;
+#endif
+    case EF_DV_DIST:
+        // Set up with the parts of the mesh below
+        break;
+    default:
+        throw steps::ArgErr("Unsupported E-Field solver.");
+    }
+
+    // Give temperature a default value of 20c
+    pTemp = 293.15;
+
+    uint nmembs = mesh()->_countMembs();
+
+    if  (nmembs != 1)
     {
         std::ostringstream os;
         os << "Membrane potential solver currently supports only one ";
@@ -1142,6 +1675,12 @@ void smtos::TetOpSplitP::_setupEField(void)
 
     // TODO: Decide what checks are needed for the membrane and implement them here
 
+    if (efdist())
+    {
+        _setupDistEField(memb);
+        return;
+    }
+
     pEFNTets = memb->countVolTets();
     pEFNTris = memb->countTris();
     pEFNVerts = memb->countVerts();
@@ -1256,7 +1795,7 @@ void smtos::TetOpSplitP::_setupEField(void)
         smtos::Tri *tri_p = pTris[triidx];
         pEFTris_vec[eft] = tri_p;
 
-        int tri_host = tri_p->getHost();
+        int tri_host = triHosts[triidx];
         ++EFTrisI_count[tri_host];
         if (myRank == tri_host) local_eftri_indices.push_back(eft);
     }
@@ -1274,8 +1813,176 @@ void smtos::TetOpSplitP::_setupEField(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::TetOpSplitP::_setupDistEField(steps::tetmesh::Memb * memb)
+{
+    using steps::math::point3d;
+    using namespace steps::solver::efield;
+
+    uint nverts = mesh()->countVertices();
+    uint ntris = mesh()->countTris();
+    uint ntets = mesh()->countTets();
+
+    std::vector<uint> membverts = memb->_getAllVertIndices();
+    std::vector<uint> membtris = memb->_getAllTriIndices();
+    std::vector<uint> membtets = memb->_getAllVolTetIndices();
+    pEFVertIdcs = membverts;
+
+    // Hosts of all EField elements. Tetrahedrons of the conduction volume
+    // outside of the compartments have no host, and are held by rank 0.
+    pEFVertHosts.assign(nverts, -1);
+    pEFTriHosts.assign(ntris, -1);
+    pEFTetHosts.assign(ntets, -1);
+    auto hold_verts = [this](const uint * verts, uint n, int host) {
+        for (uint i = 0; i < n; ++i)
+        {
+            int & vhost = pEFVertHosts[verts[i]];
+            if (vhost == -1 || host < vhost) vhost = host;
+        }
+    };
+    for (uint tetidx: membtets)
+    {
+        int host = (pMesh->getTetComp(tetidx) != 0) ? static_cast<int>(tetHosts[tetidx]) : 0;
+        pEFTetHosts[tetidx] = host;
+        hold_verts(mesh()->_getTet(tetidx), 4, host);
+    }
+    for (uint triidx: membtris)
+    {
+        auto th = triHosts.find(triidx);
+        if (th == triHosts.end())
+        {
+            std::ostringstream os;
+            os << "Failed to create EField structures.";
+            throw steps::ProgErr(os.str());
+        }
+        pEFTriHosts[triidx] = th->second;
+        hold_verts(mesh()->_getTri(triidx), 3, th->second);
+    }
+
+    // The part of the mesh held by this rank: the vertices in the order
+    // of the whole EField, so that the ranks sharing vertices list them
+    // in the same order.
+    std::vector<char> held(nverts, false);
+    std::vector<uint> loc_tets, loc_tris;
+    for (uint tetidx: membtets)
+    {
+        if (pEFTetHosts[tetidx] != myRank) continue;
+        loc_tets.push_back(tetidx);
+        const uint* tettemp = mesh()->_getTet(tetidx);
+        for (uint i = 0; i < 4; ++i) held[tettemp[i]] = true;
+    }
+    for (uint triidx: membtris)
+    {
+        if (pEFTriHosts[triidx] != myRank) continue;
+        loc_tris.push_back(triidx);
+        const uint* tritemp = mesh()->_getTri(triidx);
+        for (uint i = 0; i < 3; ++i) held[tritemp[i]] = true;
+    }
+
+    pEFNTets = loc_tets.size();
+    pEFNTris = loc_tris.size();
+    pEFNVerts = std::count(held.begin(), held.end(), true);
+
+    pEFVert_GtoL = new int[nverts];
+    for (uint i=0; i < nverts; ++i) pEFVert_GtoL[i] = -1;
+    pEFTri_GtoL = new int[ntris];
+    for (uint i=0; i< ntris; ++i) pEFTri_GtoL[i] = -1;
+    pEFTet_GtoL = new int[ntets];
+    for (uint i=0; i < ntets; ++i) pEFTet_GtoL[i] = -1;
+
+    pEFTri_LtoG = new uint[neftris()];
+
+    std::vector<double> pEFVerts;
+    pEFVerts.reserve(pEFNVerts * 3);
+    for (uint vertidx: membverts)
+    {
+        if (held[vertidx] == false) continue;
+        point3d verttemp = mesh()->_getVertex(vertidx);
+
+        // CONVERTING TO MICRONS HERE. EFIELD OBJECT WILL NOT PERFORM THIS CONVERSION
+        verttemp *= 1.0e6;
+        pEFVert_GtoL[vertidx] = pEFVerts.size() / 3;
+        pEFVerts.push_back(verttemp[0]);
+        pEFVerts.push_back(verttemp[1]);
+        pEFVerts.push_back(verttemp[2]);
+    }
+
+    std::vector<uint> pEFTets;
+    pEFTets.reserve(pEFNTets * 4);
+    for (uint eft = 0; eft < pEFNTets; ++eft)
+    {
+        const uint* tettemp = mesh()->_getTet(loc_tets[eft]);
+        for (uint i = 0; i < 4; ++i) pEFTets.push_back(pEFVert_GtoL[tettemp[i]]);
+        pEFTet_GtoL[loc_tets[eft]] = eft;
+    }
+
+    std::vector<uint> pEFTris;
+    pEFTris.reserve(pEFNTris * 3);
+    pEFTris_vec.resize(pEFNTris);
+    EFTrisV.resize(pEFNTris);
+    for (uint eft = 0; eft < pEFNTris; ++eft)
+    {
+        uint triidx = loc_tris[eft];
+        const uint* tritemp = mesh()->_getTri(triidx);
+        for (uint i = 0; i < 3; ++i) pEFTris.push_back(pEFVert_GtoL[tritemp[i]]);
+        pEFTri_GtoL[triidx] = eft;
+        pEFTri_LtoG[eft] = triidx;
+        pEFTris_vec[eft] = pTris[triidx];
+    }
+
+    // The vertices shared with every other rank: those of its elements
+    // that this rank holds too.
+    std::map<int, std::vector<uint>> halo;
+    auto share_verts = [this, &halo](const uint * verts, uint n, int host) {
+        if (host == myRank) return;
+        for (uint i = 0; i < n; ++i)
+            if (pEFVert_GtoL[verts[i]] != -1) halo[host].push_back(pEFVert_GtoL[verts[i]]);
+    };
+    for (uint tetidx: membtets) share_verts(mesh()->_getTet(tetidx), 4, pEFTetHosts[tetidx]);
+    for (uint triidx: membtris) share_verts(mesh()->_getTri(triidx), 3, pEFTriHosts[triidx]);
+    for (auto & nbr: halo)
+    {
+        std::sort(nbr.second.begin(), nbr.second.end());
+        nbr.second.erase(std::unique(nbr.second.begin(), nbr.second.end()), nbr.second.end());
+    }
+
+    // Vertex ordering does not matter to the iterative solver, nor would
+    // a saved ordering of the whole mesh fit the part.
+    pEField = make_EField<dVSolverDist>(MPI_COMM_WORLD, halo);
+    pEField->initMesh(pEFNVerts, pEFVerts.data(), pEFNTris, pEFTris.data(), pEFNTets, pEFTets.data(), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::_isEFVert(uint vidx) const
+{
+    return efdist() ? pEFVertHosts[vidx] != -1 : pEFVert_GtoL[vidx] != -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::_isEFTri(uint tidx) const
+{
+    return efdist() ? pEFTriHosts[tidx] != -1 : pEFTri_GtoL[tidx] != -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::_isEFTet(uint tidx) const
+{
+    return efdist() ? pEFTetHosts[tidx] != -1 : pEFTet_GtoL[tidx] != -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::TetOpSplitP::saveMembOpt(std::string const & opt_file_name)
 {
+    if (efdist())
+    {
+        std::ostringstream os;
+        os << "saveMembOpt method not available with a distributed EField ";
+        throw steps::ArgErr(os.str());
+    }
+
     if (myRank != 0) return;
     
     if  (efflag() != true)
@@ -1353,7 +2060,7 @@ void smtos::TetOpSplitP::_addTet(uint tetidx,
     assert(localtet != 0);
     assert(tetidx < pTets.size());
     assert(pTets[tetidx] == 0);
-    pTets[tetidx] = localtet;
+    pTets.set(tetidx, localtet);
     comp->addTet(localtet);
 
     // MPISTEPS
@@ -1387,7 +2094,7 @@ void smtos::TetOpSplitP::_addTri(uint triidx, steps::mpi::tetopsplit::Patch * pa
     assert(tri != 0);
     assert (triidx < pTris.size());
     assert (pTris[triidx] == 0);
-    pTris[triidx] = tri;
+    pTris.set(triidx, tri);
     patch->addTri(tri);
 
     // MPISTEPS
@@ -1458,6 +2165,10 @@ void smtos::TetOpSplitP::reset(void)
     efieldTime = 0.0;
     rdTime = 0.0;
     dataExchangeTime = 0.0;
+
+    pRebalanceCount = 0;
+    pNRebalanceChecks = 0;
+    pRebalanceExtents.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1496,6 +2207,8 @@ void smtos::TetOpSplitP::_runWithoutEField(double sim_endtime)
     
     
     MPI_Request* requests = NULL;
+
+    _mirrorDiffRates();
     
     // here we assume that all molecule counts have been updated so the rates are accurate
     while (statedef()->time() < sim_endtime and not aligned) {
@@ -1518,6 +2231,24 @@ void smtos::TetOpSplitP::_runWithoutEField(double sim_endtime)
         CLOG(DEBUG, "mpi_debug") << "Global update period: " << update_period << "\n";
         #endif
 
+        // Levels of diffusion rules due at the end of this update period;
+        // all of them at the end of the run, so that no diffusion is left
+        // pending
+        uint due_level = pUpdLevels - 1;
+        if (!aligned && pre_ssa_time + update_period < sim_endtime) {
+            uint cycle = pUpdCycle + 1;
+            due_level = 0;
+            while (due_level + 1 < pUpdLevels && (cycle & (1u << due_level)) == 0) due_level++;
+        }
+        pUpdCycle = (due_level == pUpdLevels - 1) ? 0 : pUpdCycle + 1;
+        for (uint k = 0; k < pUpdLevels; ++k) pUpdLevelTime[k] += update_period;
+
+        // Only boundary diffusions send molecules to other ranks
+        bool exchange = (nNeighbHosts != 0 && due_level >= pMinBndLevel);
+
+        // Pre-post the receives of this iteration's remote molecule changes
+        if (exchange)
+            MPI_Startall(nNeighbHosts, static_cast<MPI_Request*>(pRecvRequests));
 
         // *********************** Operator Split: SSA *********************************
         
@@ -1565,23 +2296,25 @@ void smtos::TetOpSplitP::_runWithoutEField(double sim_endtime)
         starttime = MPI_Wtime();
         #endif
 
-        // wait until previous loop finishes sending diffusion data
-        if (requests != NULL) {
-            MPI_Waitall(nNeighbHosts, requests, MPI_STATUSES_IGNORE);
-            delete[] requests;
-        }
-        
-        // create new requests for this loop
-        requests = new MPI_Request[nNeighbHosts];
+        if (exchange) {
+            // wait until previous loop finishes sending diffusion data
+            if (requests != NULL) {
+                MPI_Waitall(nNeighbHosts, requests, MPI_STATUSES_IGNORE);
+                delete[] requests;
+            }
+
+            // create new requests for this loop
+            requests = new MPI_Request[nNeighbHosts];
 #ifdef MPI_DEBUG
-        for (uint i = 0; i < nNeighbHosts; i++) {
-            CLOG(DEBUG, "mpi_debug") << "request address" << &(requests[i]) << "\n";
-        }
-        
+            for (uint i = 0; i < nNeighbHosts; i++) {
+                CLOG(DEBUG, "mpi_debug") << "request address" << &(requests[i]) << "\n";
+            }
+
 #endif
-        
-        for (auto neighbor : neighbHosts) {
-            remoteChanges[neighbor].clear();
+
+            for (auto & changes : remoteChanges) {
+                std::fill(changes.second.begin(), changes.second.end(), 0);
+            }
         }
         
         #ifdef MPI_PROFILING
@@ -1601,135 +2334,142 @@ void smtos::TetOpSplitP::_runWithoutEField(double sim_endtime)
         CLOG(DEBUG, "mpi_debug") << "Diffusion for period: " << update_period << "\n";
         #endif
         
-        for (uint pos = 0; pos < diffSep; pos++)
-        {
-            Diff* d = pDiffs[pos];
-            double rate = d->crData.rate;
-            if (rate == 0) continue;
-            // rate is the rate (scaled_dcst * population)
-            double scaleddcst = d->getScaledDcst();
-
-            // The number of molecules available for diffusion for this diffusion rule
-            double population = rate/scaleddcst;
+        // Diffusions next to other ranks first, so that their molecule
+        // changes are in flight while the rest are applied
+        nsteps += _applyDiffLevels(true, due_level, update_period, applied_diffs, directions);
 
-            // t1, AKA 'X', is a fractional number between 0 and 1: the update period divided
-            // by the local mean single-molecule dwellperiod. This fraction gives the mean
-            // proportion of molecules to diffuse.
-            double t1 = update_period * scaleddcst;
-            
-            
-            if (t1>=1.0) {
-                t1=1.0;
-            }
-            
-            // Calculate the occupancy, that is the integrated molecules over the period (units s)
-            double occupancy = d->getTet()->getPoolOccupancy(d->getLigLidx()) + population* (update_period - d->getTet()->getLastUpdate(d->getLigLidx()) );
-            
-            // n is, correctly, a binomial, but the binomial function requires rounding to
-            // an integer.
-            
-            // occupancy/update_period gives the mean number of molecules during the period
-            double n_double = occupancy/update_period;
+        #ifdef MPI_PROFILING
+        endtime = MPI_Wtime();
+        compTime += (endtime - starttime);
+        #endif
 
-            // could be higher than those available - a source of error
-            if (n_double > population) n_double = population;
+        if (exchange) _sendRemoteChanges(requests);
 
-            double n_int = std::floor(n_double);
-            double n_frc = n_double - n_int;
-            uint mean_n = static_cast<uint>(n_int);
+        #ifdef MPI_PROFILING
+        starttime = MPI_Wtime();
+        #endif
 
-            // deal linearly with the fraction
-            if (n_frc > 0.0)
-            {
-                double rand01 = rng()->getUnfIE();
-                if (rand01 < n_frc) mean_n++;
-            }
-            
-            // Find the binomial n
-            uint nmolcs = rng()->getBinom(mean_n, t1);
-            
-            if (nmolcs == 0) continue;
-            
-            // we apply here
-            if (nmolcs > diffApplyThreshold)
-            {
-                int direction = d->apply(rng(), nmolcs);
-                if (applied_diffs.empty() or applied_diffs.back() != d or directions.back() != direction) {
-                    applied_diffs.push_back(d);
-                    directions.push_back(direction);
-                }
-            }
-            else
-            {
-                for (uint ai = 0; ai < nmolcs; ++ai)
-                {
-                    int direction = d->apply(rng());
-                    if (applied_diffs.empty() or applied_diffs.back() != d or directions.back() != direction) {
-                        applied_diffs.push_back(d);
-                        directions.push_back(direction);
-                    }
-                }
-                
-            }
-            nsteps += nmolcs;
-            diffExtent += nmolcs;
-        }
+        nsteps += _applyDiffLevels(false, due_level, update_period, applied_diffs, directions);
+        for (uint k = 0; k <= due_level; ++k) pUpdLevelTime[k] = 0.0;
+        
+        #ifdef MPI_PROFILING
+        endtime = MPI_Wtime();
+        compTime += (endtime - starttime);
+        #endif
+        
+        _remoteSyncAndUpdate(applied_diffs, directions, exchange);
         
-        // surface diffusion
+        // *********************** Operator Split: SSA *********************************
+        #ifdef MPI_PROFILING
+        starttime = MPI_Wtime();
+        #endif
         
-        for (uint pos = 0; pos < sdiffSep; pos++)
+        KProcPSetCI akp_end = applied_ssa_kprocs.end();
+        for (KProcPSetCI akp = applied_ssa_kprocs.begin(); akp != akp_end; ++akp)
         {
-            SDiff* d = pSDiffs[pos];
-            double rate = d->crData.rate;
-
-            if (rate == 0) continue;
-            // rate is the rate (scaled_dcst * population)
-            double scaleddcst = d->getScaledDcst();
-
-            // The number of molecules available for diffusion for this diffusion rule
-            double population = rate/scaleddcst;
-
-            // t1, AKA 'X', is a fractional number between 0 and 1: the update period divided
-            // by the local mean single-molecule dwellperiod. This fraction gives the mean
-            // proportion of molecules to diffuse.
-            double t1 = update_period * scaleddcst;
-            
-            if (t1>=1.0)
-            {
-                t1=1.0;
+            (*akp)->resetOccupancies();
+        }
+        
+        statedef()->setTime(pre_ssa_time + update_period);
+        if (nsteps > 0) statedef()->incNSteps(nsteps);
+        
+        #ifdef MPI_DEBUG
+        CLOG(DEBUG, "mpi_debug") << "OP Split: End of Iteration" << nIteration << "\n";
+        #endif
+        nIteration += 1;
+        
+        #ifdef MPI_PROFILING
+        endtime = MPI_Wtime();
+        compTime += (endtime - starttime);
+        #endif
+
+        // rebalance between cycles, when no diffusion is pending; the
+        // count can pass the period while waiting for the end of a cycle
+        if (pRebalancePeriods != 0 && ++pRebalanceCount >= pRebalancePeriods && pUpdCycle == 0) {
+            // the change buffers are rebuilt if elements move
+            if (requests != NULL) {
+                MPI_Waitall(nNeighbHosts, requests, MPI_STATUSES_IGNORE);
+                delete[] requests;
+                requests = NULL;
             }
+            pRebalanceCount = 0;
+            _rebalance();
+            if (recomputeUpdPeriod) {
+                _computeUpdPeriod();
+                _mirrorDiffRates();
+            }
+        }
+    }
+    if (requests != NULL) {
+        MPI_Waitall(nNeighbHosts, requests, MPI_STATUSES_IGNORE);
+        delete[] requests;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
 
-            double occupancy = d->getTri()->getPoolOccupancy(d->getLigLidx()) + population* (update_period-  d->getTri()->getLastUpdate(d->getLigLidx()) );
+}
 
-            // n is, correctly, a binomial, but the binomial function requires rounding to
-            // an integer.
-            
-            // occupancy/update_period gives the mean number of molecules during the period
-            double n_double = occupancy/update_period;
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KP>
+uint smtos::TetOpSplitP::_applyDiffBatches(std::vector<KP*> const & kprocs, std::vector<double> const & rates,
+                                           uint begin, uint end, double period, double substep,
+                                           std::vector<KProc*> & applied_diffs, std::vector<int> & directions)
+{
+    if (pBatchPos.size() < DIFF_BATCH_SIZE)
+    {
+        pBatchPos.resize(DIFF_BATCH_SIZE);
+        pBatchRate.resize(DIFF_BATCH_SIZE);
+        pBatchDcst.resize(DIFF_BATCH_SIZE);
+        pBatchOccupancy.resize(DIFF_BATCH_SIZE);
+        pBatchLastUpdate.resize(DIFF_BATCH_SIZE);
+        pBatchTrials.resize(DIFF_BATCH_SIZE);
+        pBatchChances.resize(DIFF_BATCH_SIZE);
+        pBatchMolcs.resize(DIFF_BATCH_SIZE);
+        pBatchSplit.resize(DIFF_BATCH_SIZE);
+        pBatchRemain.resize(DIFF_BATCH_SIZE);
+        pBatchDraws.resize(DIFF_BATCH_SIZE);
+        pBatchDirChances.resize(DIFF_BATCH_SIZE * DIFF_MAX_DIRECTIONS);
+        pBatchDirMolcs.resize(DIFF_BATCH_SIZE * DIFF_MAX_DIRECTIONS);
+    }
 
-            // could be higher than those available - a source of error
-            if (n_double > population) n_double = population;
+    uint nsteps = 0;
+    uint pos = begin;
+    while (pos < end)
+    {
+        // Gather the next batch of diffusions with molecules. Applying a
+        // diffusion changes neither the rates nor the occupancies, so the
+        // whole batch can be sampled before any of it is applied.
+        uint n = 0;
+        for (; pos < end && n < DIFF_BATCH_SIZE; pos++)
+        {
+            double rate = rates[pos];
+            if (rate == 0) continue;
+            KP* d = kprocs[pos];
+            uint lidx = d->getLigLidx();
+            pBatchPos[n] = pos;
+            pBatchRate[n] = rate;
+            pBatchDcst[n] = d->getScaledDcst();
+            pBatchOccupancy[n] = diffElem(d)->getPoolOccupancy(lidx);
+            pBatchLastUpdate[n] = diffElem(d)->getLastUpdate(lidx);
+            n++;
+        }
 
-            double n_int = std::floor(n_double);
-            double n_frc = n_double - n_int;
-            uint mean_n = static_cast<uint>(n_int);
+        _sampleDiffBatch(n, period, substep);
+        _splitDiffBatch(kprocs, n);
 
-            // deal linearly with the fraction
-            if (n_frc > 0.0)
-            {
-                double rand01 = rng()->getUnfIE();
-                if (rand01 < n_frc) mean_n++;
-            }
-            
-            // Find the binomial n
-            uint nmolcs = rng()->getBinom(mean_n, t1);
-            
+        // Apply the moves in order of the diffusions
+        for (uint i = 0; i < n; i++)
+        {
+            uint nmolcs = pBatchMolcs[i];
             if (nmolcs == 0) continue;
-            
+            KP* d = kprocs[pBatchPos[i]];
+
+            double start = (pProfile != 0) ? ssolver::KProcProfile::now() : 0.0;
+
             // we apply here
             if (nmolcs > diffApplyThreshold)
             {
-                int direction = d->apply(rng(), nmolcs);
+                int direction = d->apply(&pBatchDirMolcs[i * DIFF_MAX_DIRECTIONS]);
                 if (applied_diffs.empty() or applied_diffs.back() != d or directions.back() != direction) {
                     applied_diffs.push_back(d);
                     directions.push_back(direction);
@@ -1746,47 +2486,167 @@ void smtos::TetOpSplitP::_runWithoutEField(double sim_endtime)
                     }
                 }
             }
+            if (pProfile != 0)
+                pProfile->record(d->schedIDX(), nmolcs, 0, ssolver::KProcProfile::now() - start);
+
             nsteps += nmolcs;
             diffExtent += nmolcs;
         }
-        
-        #ifdef MPI_PROFILING
-        endtime = MPI_Wtime();
-        compTime += (endtime - starttime);
-        #endif
-        
-        _remoteSyncAndUpdate(requests, applied_diffs, directions);
-        
-        // *********************** Operator Split: SSA *********************************
-        #ifdef MPI_PROFILING
-        starttime = MPI_Wtime();
-        #endif
-        
-        KProcPSetCI akp_end = applied_ssa_kprocs.end();
-        for (KProcPSetCI akp = applied_ssa_kprocs.begin(); akp != akp_end; ++akp)
+    }
+    return nsteps;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_sampleDiffBatch(uint n, double period, double substep)
+{
+    double const * rate = &pBatchRate.front();
+    double const * dcst = &pBatchDcst.front();
+    double const * occupancy = &pBatchOccupancy.front();
+    double const * last_update = &pBatchLastUpdate.front();
+    double * t1 = &pBatchChances.front();
+    double * n_double = &pBatchOccupancy.front();
+
+    // No branches in here, so that the loop vectorises
+    for (uint i = 0; i < n; i++)
+    {
+        // rate is the rate (scaled_dcst * population): the number of
+        // molecules available for diffusion for this diffusion rule
+        double population = rate[i] / dcst[i];
+
+        // t1, AKA 'X', is a fractional number between 0 and 1: the update period divided
+        // by the local mean single-molecule dwellperiod. This fraction gives the mean
+        // proportion of molecules to diffuse.
+        t1[i] = std::min(period * dcst[i], 1.0);
+
+        // The occupancy is the integrated molecules over the SSA substep (units s);
+        // for rules with a longer period, it stands for the occupancy over the whole
+        // period. occupancy/substep gives the mean number of molecules during the
+        // period, which could be higher than those available - a source of error
+        double mean = (occupancy[i] + population * (substep - last_update[i])) / substep;
+        n_double[i] = std::min(mean, population);
+    }
+
+    // n is, correctly, a binomial, but the binomial function requires rounding to
+    // an integer; deal linearly with the fraction
+    for (uint i = 0; i < n; i++)
+    {
+        double n_int = std::floor(n_double[i]);
+        double n_frc = n_double[i] - n_int;
+        uint mean_n = static_cast<uint>(n_int);
+        if (n_frc > 0.0)
         {
-            (*akp)->resetOccupancies();
+            double rand01 = rng()->getUnfIE();
+            if (rand01 < n_frc) mean_n++;
         }
-        
-        statedef()->setTime(pre_ssa_time + update_period);
-        if (nsteps > 0) statedef()->incNSteps(nsteps);
-        
-        #ifdef MPI_DEBUG
-        CLOG(DEBUG, "mpi_debug") << "OP Split: End of Iteration" << nIteration << "\n";
-        #endif
-        nIteration += 1;
-        
-        #ifdef MPI_PROFILING
-        endtime = MPI_Wtime();
-        compTime += (endtime - starttime);
-        #endif
+        pBatchTrials[i] = mean_n;
     }
-    if (requests != NULL) {
-        MPI_Waitall(nNeighbHosts, requests, MPI_STATUSES_IGNORE);
-        delete[] requests;
+
+    // Find the binomial n
+    if (n != 0) rng()->getBinoms(n, &pBatchTrials.front(), t1, &pBatchMolcs.front());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KP>
+void smtos::TetOpSplitP::_splitDiffBatch(std::vector<KP*> const & kprocs, uint n)
+{
+    // The chance of every direction but the last, which takes the rest;
+    // 0 for the last and any further directions. Rules with molecules
+    // always have a direction, as their rate would be 0 otherwise.
+    uint nsplit = 0;
+    for (uint i = 0; i < n; i++)
+    {
+        if (pBatchMolcs[i] <= diffApplyThreshold) continue;
+        KP* d = kprocs[pBatchPos[i]];
+        uint ndirections = d->countDirections();
+        double * chances = &pBatchDirChances[nsplit * DIFF_MAX_DIRECTIONS];
+        for (uint dir = 0; dir < DIFF_MAX_DIRECTIONS; dir++)
+            chances[dir] = (dir + 1 < ndirections) ? d->getDirectionChance(dir) : 0.0;
+        std::fill_n(&pBatchDirMolcs[i * DIFF_MAX_DIRECTIONS], DIFF_MAX_DIRECTIONS, 0);
+        pBatchSplit[nsplit] = i;
+        pBatchRemain[nsplit] = pBatchMolcs[i];
+        nsplit++;
     }
-    MPI_Barrier(MPI_COMM_WORLD);
 
+    // A multinomial as a binomial per direction, drawn for the whole
+    // batch at once
+    for (uint dir = 0; dir + 1 < DIFF_MAX_DIRECTIONS; dir++)
+    {
+        uint ndraws = 0;
+        for (uint j = 0; j < nsplit; j++)
+        {
+            double chance = pBatchDirChances[j * DIFF_MAX_DIRECTIONS + dir];
+            if (pBatchRemain[j] == 0 || chance == 0.0) continue;
+            pBatchTrials[ndraws] = pBatchRemain[j];
+            pBatchChances[ndraws] = chance;
+            ndraws++;
+        }
+        if (ndraws == 0) break;
+        rng()->getBinoms(ndraws, &pBatchTrials.front(), &pBatchChances.front(), &pBatchDraws.front());
+
+        uint draw = 0;
+        for (uint j = 0; j < nsplit; j++)
+        {
+            double chance = pBatchDirChances[j * DIFF_MAX_DIRECTIONS + dir];
+            if (pBatchRemain[j] == 0 || chance == 0.0) continue;
+            pBatchDirMolcs[pBatchSplit[j] * DIFF_MAX_DIRECTIONS + dir] = pBatchDraws[draw];
+            pBatchRemain[j] -= pBatchDraws[draw];
+            draw++;
+        }
+    }
+    for (uint j = 0; j < nsplit; j++)
+    {
+        uint last = kprocs[pBatchPos[pBatchSplit[j]]]->countDirections() - 1;
+        pBatchDirMolcs[pBatchSplit[j] * DIFF_MAX_DIRECTIONS + last] += pBatchRemain[j];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::_applyDiffs(uint begin, uint end, double period, double substep,
+                                     std::vector<KProc*> & applied_diffs, std::vector<int> & directions)
+{
+    return _applyDiffBatches(pDiffs, pDiffRates, begin, end, period, substep, applied_diffs, directions);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::_applySDiffs(uint begin, uint end, double period, double substep,
+                                      std::vector<KProc*> & applied_diffs, std::vector<int> & directions)
+{
+    return _applyDiffBatches(pSDiffs, pSDiffRates, begin, end, period, substep, applied_diffs, directions);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_mirrorDiffRates(void)
+{
+    pDiffRates.resize(pDiffs.size());
+    for (uint pos = 0; pos < pDiffs.size(); pos++) pDiffRates[pos] = pDiffs[pos]->crData.rate;
+    pSDiffRates.resize(pSDiffs.size());
+    for (uint pos = 0; pos < pSDiffs.size(); pos++) pSDiffRates[pos] = pSDiffs[pos]->crData.rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::_applyDiffLevels(bool boundary, uint due, double substep,
+                                          std::vector<KProc*> & applied_diffs, std::vector<int> & directions)
+{
+    std::vector<uint> const & diff_seps = boundary ? diffBndLevelSeps : diffLevelSeps;
+    std::vector<uint> const & sdiff_seps = boundary ? sdiffBndLevelSeps : sdiffLevelSeps;
+    uint diff_begin = boundary ? 0 : diffBndSep;
+    uint sdiff_begin = boundary ? 0 : sdiffBndSep;
+
+    uint nsteps = 0;
+    for (uint k = 0; k <= due; ++k)
+    {
+        nsteps += _applyDiffs(diff_begin, diff_seps[k], pUpdLevelTime[k], substep, applied_diffs, directions);
+        nsteps += _applySDiffs(sdiff_begin, sdiff_seps[k], pUpdLevelTime[k], substep, applied_diffs, directions);
+        diff_begin = diff_seps[k];
+        sdiff_begin = sdiff_seps[k];
+    }
+    return nsteps;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1822,7 +2682,10 @@ void smtos::TetOpSplitP::_runWithEField(double endtime)
         #endif
 
         double t0 = statedef()->time();
-        _runWithoutEField( std::min(t0+pEFDT, endtime));
+        // An adaptive EField step is chosen before the interval and taken
+        // whole, so nothing run over it has to be undone.
+        double ef_dt = pEField->getAdaptive() ? pEField->getNextDT() : pEFDT;
+        _runWithoutEField( std::min(t0+ef_dt, endtime));
 
         #ifdef MPI_PROFILING
         timing_end = MPI_Wtime();
@@ -1832,38 +2695,42 @@ void smtos::TetOpSplitP::_runWithEField(double endtime)
         #ifdef MPI_PROFILING
         timing_start = MPI_Wtime();
         #endif
-        // update host-local currents
-        int i_begin = EFTrisI_offset[myRank];
-        int i_end = i_begin + EFTrisI_count[myRank];
-
         double sttime = statedef()->time();
-        for (int i = i_begin; i < i_end; ++i) {
-            int tlidx = EFTrisI_idx[i];
-            EFTrisI_permuted[i] = pEFTris_vec[tlidx]->computeI(EFTrisV[tlidx], sttime-t0, sttime);
+        if (efdist())
+        {
+            // Every rank holds the triangles it hosts
+            for (uint tlidx = 0; tlidx < pEFNTris; ++tlidx)
+                pEField->setTriI(tlidx, pEFTris_vec[tlidx]->computeI(EFTrisV[tlidx], sttime-t0, sttime));
         }
+        else
+        {
+            // update host-local currents
+            int i_begin = EFTrisI_offset[myRank];
+            int i_end = i_begin + EFTrisI_count[myRank];
 
-        #ifdef MPI_PROFILING
-        timing_end = MPI_Wtime();
-        efieldTime += (timing_end - timing_start);
-        #endif
+            for (int i = i_begin; i < i_end; ++i) {
+                int tlidx = EFTrisI_idx[i];
+                EFTrisI_permuted[i] = pEFTris_vec[tlidx]->computeI(EFTrisV[tlidx], sttime-t0, sttime);
+            }
 
-        #ifdef MPI_PROFILING
-        timing_start = MPI_Wtime();
-        #endif
-        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
-                &EFTrisI_permuted[0], &EFTrisI_count[0], &EFTrisI_offset[0], MPI_DOUBLE, MPI_COMM_WORLD);
+            #ifdef MPI_PROFILING
+            timing_end = MPI_Wtime();
+            efieldTime += (timing_end - timing_start);
+            timing_start = MPI_Wtime();
+            #endif
 
-        #ifdef MPI_PROFILING
-        timing_end = MPI_Wtime();
-        dataExchangeTime += (timing_end - timing_start);
-        #endif
+            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                    &EFTrisI_permuted[0], &EFTrisI_count[0], &EFTrisI_offset[0], MPI_DOUBLE, MPI_COMM_WORLD);
 
-        #ifdef MPI_PROFILING
-        timing_start = MPI_Wtime();
-        #endif
+            #ifdef MPI_PROFILING
+            timing_end = MPI_Wtime();
+            dataExchangeTime += (timing_end - timing_start);
+            timing_start = MPI_Wtime();
+            #endif
 
-        for (uint i = 0; i < pEFNTris; i++)
-                pEField->setTriI(EFTrisI_idx[i], EFTrisI_permuted[i]);
+            for (uint i = 0; i < pEFNTris; i++)
+                    pEField->setTriI(EFTrisI_idx[i], EFTrisI_permuted[i]);
+        }
 
         pEField->advance(sttime-t0);
         _refreshEFTrisV();
@@ -1984,15 +2851,16 @@ double smtos::TetOpSplitP::_getCompCount(uint cidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    uint total_count = 0;
+    uint local_count = 0;
     WmVolPVecCI t_end = comp->endTet();
     for (WmVolPVecCI t = comp->bgnTet(); t != t_end; ++t)
     {
-        uint svol_count = (*t)->pools()[slidx];
-        MPI_Bcast(&svol_count, 1, MPI_UNSIGNED, (*t)->getHost(), MPI_COMM_WORLD);
-        total_count += svol_count;
+        if (!(*t)->getInHost()) continue;
+        local_count += (*t)->pools()[slidx];
     }
 
+    uint total_count = 0;
+    MPI_Allreduce(&local_count, &total_count, 1, MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
     return total_count;
 }
 
@@ -2023,29 +2891,23 @@ void smtos::TetOpSplitP::_setCompCount(uint cidx, uint sidx, double n)
     }
 
     // only do the distribution in rank 0
-    // then bcast to other ranks
-    
-    if (myRank == 0) {
-        // functions for distribution:
-        auto set_count = [slidx](WmVol *tet, uint c) { tet->setCount(slidx, c); };
-        auto inc_count = [slidx](WmVol *tet, int c) { tet->incCount(slidx, c, 0.0, true); };
-        auto weight = [](WmVol *tet) { return tet->vol(); };
-
-        steps::util::distribute_quantity(n, comp->bgnTet(), comp->endTet(), weight, set_count, inc_count, *rng(), comp->def()->vol());
+    // then bcast to other ranks, which may not have all the tets
+    std::vector<smtos::WmVol *> svols;
+    std::vector<double> vols;
+    _compSubvols(cidx, svols, vols);
 
-    }
-    
-    uint ncomptets = comp->countTets();
+    uint ncomptets = svols.size();
     std::vector<uint> counts(ncomptets);
-    
-    WmVolPVecCI t_end = comp->endTet();
+
     if (myRank == 0) {
-        uint curr_pos = 0;
-        for (WmVolPVecCI t = comp->bgnTet(); t != t_end; ++t)
-        {
-            counts[curr_pos] =(*t)->pools()[slidx];
-            curr_pos++;
-        }
+        // functions for distribution:
+        std::vector<uint> order(ncomptets);
+        std::iota(order.begin(), order.end(), 0);
+        auto set_count = [&counts](uint i, uint c) { counts[i] = c; };
+        auto inc_count = [&counts](uint i, int c) { counts[i] += c; };
+        auto weight = [&vols](uint i) { return vols[i]; };
+
+        steps::util::distribute_quantity(n, order.begin(), order.end(), weight, set_count, inc_count, *rng(), comp->def()->vol());
     }
 
     MPI_Bcast(&(counts.front()), ncomptets, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
@@ -2054,14 +2916,11 @@ void smtos::TetOpSplitP::_setCompCount(uint cidx, uint sidx, double n)
     CLOG(DEBUG, "mpi_debug") << "distribute comp counts" << counts << "\n";
     #endif
 
-    uint curr_pos = 0;
-    for (WmVolPVecCI t = comp->bgnTet(); t != t_end; ++t)
+    for (uint i = 0; i < ncomptets; ++i)
     {
-        if (myRank != 0) {
-            (*t)->setCount(slidx, counts[curr_pos]);
-        }
-        _updateSpec((*t), sidx);
-        curr_pos++;
+        if (svols[i] == 0) continue;
+        svols[i]->setCount(slidx, counts[i]);
+        _updateSpec(svols[i], sidx);
     }
     _updateSum();
     MPI_Barrier(MPI_COMM_WORLD);
@@ -2463,15 +3322,16 @@ double smtos::TetOpSplitP::_getPatchCount(uint pidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    uint total_count = 0;
+    uint local_count = 0;
     TriPVecCI t_end = patch->endTri();
     for (TriPVecCI t = patch->bgnTri(); t != t_end; ++t)
     {
-        uint svol_count = (*t)->pools()[slidx];
-        MPI_Bcast(&svol_count, 1, MPI_UNSIGNED, (*t)->getHost(), MPI_COMM_WORLD);
-        total_count += svol_count;
+        if (!(*t)->getInHost()) continue;
+        local_count += (*t)->pools()[slidx];
     }
-    
+
+    uint total_count = 0;
+    MPI_Allreduce(&local_count, &total_count, 1, MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
     return total_count;
 }
 
@@ -2503,45 +3363,37 @@ void smtos::TetOpSplitP::_setPatchCount(uint pidx, uint sidx, double n)
 	}
 
     // only do the distribution in rank 0
-    // then bcast to other ranks
-    
-    if (myRank == 0) {
-        // functions for distribution:
-        auto set_count = [slidx](Tri *tri, uint c) { tri->setCount(slidx, c); };
-        auto inc_count = [slidx](Tri *tri, int c) { tri->incCount(slidx, c, 0.0, true); };
-        auto weight = [](Tri *tri) { return tri->area(); };
+    // then bcast to other ranks, which may not have all the tris
+    std::vector<smtos::Tri *> tris;
+    std::vector<double> areas;
+    _patchSubvols(pidx, tris, areas);
 
-        steps::util::distribute_quantity(n, patch->bgnTri(), patch->endTri(), weight, set_count, inc_count, *rng(), patch->def()->area());
-    }
-    uint npatchtris = patch->countTris();
+    uint npatchtris = tris.size();
     std::vector<uint> counts(npatchtris);
-    TriPVecCI t_end = patch->endTri();
-    if (myRank == 0) {
-        uint curr_pos = 0;
 
-        for (TriPVecCI t = patch->bgnTri(); t != t_end; ++t)
-        {
-            counts[curr_pos] =(*t)->pools()[slidx];
-            curr_pos++;
-        }
+    if (myRank == 0) {
+        // functions for distribution:
+        std::vector<uint> order(npatchtris);
+        std::iota(order.begin(), order.end(), 0);
+        auto set_count = [&counts](uint i, uint c) { counts[i] = c; };
+        auto inc_count = [&counts](uint i, int c) { counts[i] += c; };
+        auto weight = [&areas](uint i) { return areas[i]; };
 
+        steps::util::distribute_quantity(n, order.begin(), order.end(), weight, set_count, inc_count, *rng(), patch->def()->area());
     }
-    
+
     MPI_Bcast(&(counts.front()), npatchtris, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     
     #ifdef MPI_DEBUG
     CLOG(DEBUG, "mpi_debug") << "distribute patch counts " << counts << "\n";
     #endif
     
-    uint curr_pos = 0;
-    for (TriPVecCI t = patch->bgnTri(); t != t_end; ++t)
+    for (uint i = 0; i < npatchtris; ++i)
     {
-        if (myRank != 0) {
-            // set count only don't need sync
-            (*t)->setCount(slidx, counts[curr_pos]);
-        }
-        _updateSpec((*t), sidx);
-        curr_pos++;
+        if (tris[i] == 0) continue;
+        // set count only don't need sync
+        tris[i]->setCount(slidx, counts[i]);
+        _updateSpec(tris[i], sidx);
     }
     _updateSum();
     MPI_Barrier(MPI_COMM_WORLD);
@@ -2754,7 +3606,7 @@ void smtos::TetOpSplitP::_setDiffBoundaryDiffusionActive(uint dbidx, uint sidx,
     for (uint bdt = 0; bdt != ntets; ++bdt)
     {
         smtos::Tet * tet = _tet(bdtets[bdt]);
-        if (!tet->getInHost()) continue;
+        if (tet == 0 || !tet->getInHost()) continue;
         uint direction = bdtetsdir[bdt];
         assert(direction >= 0 and direction < 4);
 
@@ -2807,7 +3659,7 @@ bool smtos::TetOpSplitP::_getDiffBoundaryDiffusionActive(uint dbidx, uint sidx)
     for (uint bdt = 0; bdt != ntets; ++bdt)
     {
         smtos::Tet * tet = _tet(bdtets[bdt]);
-        if (!tet->getInHost()) continue;
+        if (tet == 0 || !tet->getInHost()) continue;
         uint direction = bdtetsdir[bdt];
         assert(direction >= 0 and direction < 4);
 
@@ -2867,7 +3719,7 @@ void smtos::TetOpSplitP::_setDiffBoundaryDcst(uint dbidx, uint sidx, double dcst
     for (uint bdt = 0; bdt != ntets; ++bdt)
     {
         smtos::Tet * tet = _tet(bdtets[bdt]);
-        if (!tet->getInHost()) continue;
+        if (tet == 0 || !tet->getInHost()) continue;
         // if tet compdef equals to dirc_compdef,
         //it is the desination tet so diff should not be changed
         // NULL (bidirection) and source tet are both different
@@ -3028,7 +3880,7 @@ void smtos::TetOpSplitP::_setSDiffBoundaryDiffusionActive(uint sdbidx, uint sidx
     for (uint sbdt = 0; sbdt != ntris; ++sbdt)
     {
     	smtos::Tri * tri = _tri(sbdtris[sbdt]);
-        if (!tri->getInHost()) continue;
+        if (tri == 0 || !tri->getInHost()) continue;
         uint direction = sbdtrisdir[sbdt];
         assert(direction >= 0 and direction < 3);
 
@@ -3078,7 +3930,7 @@ bool smtos::TetOpSplitP::_getSDiffBoundaryDiffusionActive(uint sdbidx, uint sidx
     for (uint sbdt = 0; sbdt != ntris; ++sbdt)
     {
     	smtos::Tri * tri = _tri(sbdtris[sbdt]);
-        if (!tri->getInHost()) continue;
+        if (tri == 0 || !tri->getInHost()) continue;
         uint direction = sbdtrisdir[sbdt];
         assert(direction >= 0 and direction < 3);
 
@@ -3137,7 +3989,7 @@ void smtos::TetOpSplitP::_setSDiffBoundaryDcst(uint sdbidx, uint sidx, double dc
     {
     	smtos::Tri * tri = _tri(sbdtris[sbdt]);
 
-        if (!tri->getInHost()) continue;
+        if (tri == 0 || !tri->getInHost()) continue;
 
         if (dirp_patchdef == tri->patchdef()) {
             continue;
@@ -3313,6 +4165,8 @@ steps::mpi::tetopsplit::KProc * smtos::TetOpSplitP::_getNext(void) const
 
 void smtos::TetOpSplitP::_executeStep(steps::mpi::tetopsplit::KProc * kp, double dt, double period)
 {
+    double start = (pProfile != 0) ? ssolver::KProcProfile::now() : 0.0;
+
     kp->apply(rng(), dt, statedef()->time(), period);
     statedef()->incTime(dt);
     
@@ -3320,6 +4174,9 @@ void smtos::TetOpSplitP::_executeStep(steps::mpi::tetopsplit::KProc * kp, double
     // KProcs, it may change if VDepSurface reaction is added in the future
     std::vector<smtos::KProc*> upd = kp->getLocalUpdVec();
     _updateLocal(upd);
+
+    if (pProfile != 0)
+        pProfile->record(kp->schedIDX(), 1, upd.size(), ssolver::KProcProfile::now() - start);
     statedef()->incNSteps(1);
 
 }
@@ -3413,7 +4270,6 @@ double smtos::TetOpSplitP::_getCompReacH(uint cidx, uint ridx) const
 
     WmVolPVecCI t_bgn = lcomp->bgnTet();
     WmVolPVecCI t_end = lcomp->endTet();
-    if (t_bgn == t_end) return 0.0;
 
     double local_h = 0.0;
     for (WmVolPVecCI t = t_bgn; t != t_end; ++t)
@@ -3449,7 +4305,6 @@ double smtos::TetOpSplitP::_getCompReacC(uint cidx, uint ridx) const
 
     WmVolPVecCI t_bgn = lcomp->bgnTet();
     WmVolPVecCI t_end = lcomp->endTet();
-    if (t_bgn == t_end) return 0.0;
     double local_c = 0.0;
     double local_v = 0.0;
     for (WmVolPVecCI t = t_bgn; t != t_end; ++t)
@@ -3489,7 +4344,6 @@ double smtos::TetOpSplitP::_getCompReacA(uint cidx, uint ridx) const
 
     WmVolPVecCI t_bgn = lcomp->bgnTet();
     WmVolPVecCI t_end = lcomp->endTet();
-    if (t_bgn == t_end) return 0.0;
 
     double local_a = 0.0;
     for (WmVolPVecCI t = t_bgn; t != t_end; ++t)
@@ -3525,7 +4379,6 @@ uint smtos::TetOpSplitP::_getCompReacExtent(uint cidx, uint ridx) const
 
     WmVolPVecCI t_bgn = lcomp->bgnTet();
     WmVolPVecCI t_end = lcomp->endTet();
-    if (t_bgn == t_end) return 0.0;
 
     uint local_x = 0.0;
     for (WmVolPVecCI t = t_bgn; t != t_end; ++t)
@@ -3593,7 +4446,6 @@ double smtos::TetOpSplitP::_getPatchSReacH(uint pidx, uint ridx) const
 
     TriPVecCI t_bgn = lpatch->bgnTri();
     TriPVecCI t_end = lpatch->endTri();
-    if (t_bgn == t_end) return 0.0;
 
     double local_h = 0.0;
     for (TriPVecCI t = t_bgn; t != t_end; ++t)
@@ -3629,7 +4481,6 @@ double smtos::TetOpSplitP::_getPatchSReacC(uint pidx, uint ridx) const
 
     TriPVecCI t_bgn = lpatch->bgnTri();
     TriPVecCI t_end = lpatch->endTri();
-    if (t_bgn == t_end) return 0.0;
 
     double local_c = 0.0;
     double local_a = 0.0;
@@ -3669,7 +4520,6 @@ double smtos::TetOpSplitP::_getPatchSReacA(uint pidx, uint ridx) const
 
     TriPVecCI t_bgn = lpatch->bgnTri();
     TriPVecCI t_end = lpatch->endTri();
-    if (t_bgn == t_end) return 0.0;
 
     double local_a = 0.0;
     for (TriPVecCI t = t_bgn; t != t_end; ++t)
@@ -3704,7 +4554,6 @@ uint smtos::TetOpSplitP::_getPatchSReacExtent(uint pidx, uint ridx) const
 
     TriPVecCI t_bgn = lpatch->bgnTri();
     TriPVecCI t_end = lpatch->endTri();
-    if (t_bgn == t_end) return 0;
 
     double local_x = 0.0;
     for (TriPVecCI t = t_bgn; t != t_end; ++t)
@@ -3754,13 +4603,13 @@ void smtos::TetOpSplitP::_resetPatchSReacExtent(uint pidx, uint ridx)
 double smtos::TetOpSplitP::_getTetVol(uint tidx) const
 {
     assert (tidx < pTets.size());
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.";
         throw steps::ArgErr(os.str());
     }
-    return pTets[tidx]->vol();
+    return pMesh->getTetVol(tidx);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3779,10 +4628,9 @@ bool smtos::TetOpSplitP::_getTetSpecDefined(uint tidx, uint sidx) const
     assert (tidx < pTets.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTets[tidx] == 0) return false;
+    if (_tetCompdef(tidx) == 0) return false;
 
-    smtos::Tet * tet = pTets[tidx];
-    uint lsidx = tet->compdef()->specG2L(sidx);
+    uint lsidx = _tetCompdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED) return false;
     else return true;
 }
@@ -3798,7 +4646,7 @@ double smtos::TetOpSplitP::_getTetCount(uint tidx, uint sidx) const
     assert (tidx < pTets.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -3806,7 +4654,7 @@ double smtos::TetOpSplitP::_getTetCount(uint tidx, uint sidx) const
     }
 
     smtos::Tet * tet = pTets[tidx];
-    uint lsidx = tet->compdef()->specG2L(sidx);
+    uint lsidx = _tetCompdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -3814,7 +4662,8 @@ double smtos::TetOpSplitP::_getTetCount(uint tidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    uint count = tet->pools()[lsidx];
+    uint count = 0;
+    if (tet != 0 && tet->getInHost()) count = tet->pools()[lsidx];
     MPI_Bcast(&count, 1, MPI_UNSIGNED, tetHosts[tidx], MPI_COMM_WORLD);
     #ifdef MPI_DEBUG
     //CLOG(DEBUG, "mpi_debug") << "count: " << count << "\n";
@@ -3835,7 +4684,7 @@ void smtos::TetOpSplitP::_setTetCount(uint tidx, uint sidx, double n)
     assert (tidx < pTets.size());
     assert (sidx < statedef()->countSpecs());
     assert (n >= 0.0);
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -3851,7 +4700,7 @@ void smtos::TetOpSplitP::_setTetCount(uint tidx, uint sidx, double n)
     
     smtos::Tet * tet = pTets[tidx];
     
-    uint lsidx = tet->compdef()->specG2L(sidx);
+    uint lsidx = _tetCompdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -3877,8 +4726,11 @@ void smtos::TetOpSplitP::_setTetCount(uint tidx, uint sidx, double n)
     MPI_Bcast(&count, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     
     // don't need sync
-    tet->setCount(lsidx, count);
-    _updateSpec(tet, sidx);
+    if (tet != 0)
+    {
+        tet->setCount(lsidx, count);
+        _updateSpec(tet, sidx);
+    }
     _updateSum();
     MPI_Barrier(MPI_COMM_WORLD);
 }
@@ -3908,8 +4760,7 @@ double smtos::TetOpSplitP::_getTetConc(uint tidx, uint sidx) const
 {
     // following method does all necessary argument checking
     double count = _getTetCount(tidx, sidx);
-    smtos::Tet * tet = pTets[tidx];
-    double vol = tet->vol();
+    double vol = _getTetVol(tidx);
     return (count/(1.0e3 * vol * steps::math::AVOGADRO));
 }
 
@@ -3920,15 +4771,14 @@ void smtos::TetOpSplitP::_setTetConc(uint tidx, uint sidx, double c)
     assert (c >= 0.0);
     assert (tidx < pTets.size());
 
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.";
         throw steps::ArgErr(os.str());
     }
 
-    smtos::Tet * tet = pTets[tidx];
-    double count = c * (1.0e3 * tet->vol() * steps::math::AVOGADRO);
+    double count = c * (1.0e3 * _getTetVol(tidx) * steps::math::AVOGADRO);
     // the following method does all the necessary argument checking
     _setTetCount(tidx, sidx, count);
 }
@@ -3940,7 +4790,7 @@ bool smtos::TetOpSplitP::_getTetClamped(uint tidx, uint sidx) const
     assert (tidx < pTets.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -3949,7 +4799,7 @@ bool smtos::TetOpSplitP::_getTetClamped(uint tidx, uint sidx) const
 
     smtos::Tet * tet = pTets[tidx];
 
-    uint lsidx = tet->compdef()->specG2L(sidx);
+    uint lsidx = _tetCompdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -3957,7 +4807,10 @@ bool smtos::TetOpSplitP::_getTetClamped(uint tidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    return tet->clamped(lsidx);
+    bool clamped = false;
+    if (tet != 0 && tet->getInHost()) clamped = tet->clamped(lsidx);
+    MPI_Bcast(&clamped, 1, MPI_C_BOOL, tetHosts[tidx], MPI_COMM_WORLD);
+    return clamped;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3967,7 +4820,7 @@ void smtos::TetOpSplitP::_setTetClamped(uint tidx, uint sidx, bool buf)
     assert (tidx < pTets.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTets[tidx] == 0)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -3976,7 +4829,7 @@ void smtos::TetOpSplitP::_setTetClamped(uint tidx, uint sidx, bool buf)
 
     smtos::Tet * tet = pTets[tidx];
 
-    uint lsidx = tet->compdef()->specG2L(sidx);
+    uint lsidx = _tetCompdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -3984,7 +4837,7 @@ void smtos::TetOpSplitP::_setTetClamped(uint tidx, uint sidx, bool buf)
         throw steps::ArgErr(os.str());
     }
 
-    tet->setClamped(lsidx, buf);
+    if (tet != 0) tet->setClamped(lsidx, buf);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3994,7 +4847,7 @@ double smtos::TetOpSplitP::_getTetReacK(uint tidx, uint ridx) const
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4005,7 +4858,7 @@ double smtos::TetOpSplitP::_getTetReacK(uint tidx, uint ridx) const
     
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4013,7 +4866,7 @@ double smtos::TetOpSplitP::_getTetReacK(uint tidx, uint ridx) const
         throw steps::ArgErr(os.str());
     }
     double kcst = 0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         kcst = tet->reac(lridx)->kcst();
     }
     MPI_Bcast(&kcst, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4028,7 +4881,7 @@ void smtos::TetOpSplitP::_setTetReacK(uint tidx, uint ridx, double kf)
     assert (ridx < statedef()->countReacs());
     assert (kf >= 0.0);
 
-    if (pTets[tidx] == 0  && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4037,7 +4890,7 @@ void smtos::TetOpSplitP::_setTetReacK(uint tidx, uint ridx, double kf)
     
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4045,7 +4898,7 @@ void smtos::TetOpSplitP::_setTetReacK(uint tidx, uint ridx, double kf)
         throw steps::ArgErr(os.str());
     }
 
-    if (!tet->getInHost()) return;
+    if (tet == 0 || !tet->getInHost()) return;
     tet->reac(lridx)->setKcst(kf);
     _updateElement(tet->reac(lridx));
     _updateSum();
@@ -4058,7 +4911,7 @@ bool smtos::TetOpSplitP::_getTetReacActive(uint tidx, uint ridx) const
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4067,7 +4920,7 @@ bool smtos::TetOpSplitP::_getTetReacActive(uint tidx, uint ridx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4076,7 +4929,7 @@ bool smtos::TetOpSplitP::_getTetReacActive(uint tidx, uint ridx) const
     }
     
     bool active = false;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         if (tet->reac(lridx)->inactive() == true) active = false;
         else active = true;
     }
@@ -4091,7 +4944,7 @@ void smtos::TetOpSplitP::_setTetReacActive(uint tidx, uint ridx, bool act)
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4100,14 +4953,14 @@ void smtos::TetOpSplitP::_setTetReacActive(uint tidx, uint ridx, bool act)
 
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
         os << "Reaction undefined in tetrahedron.\n";
         throw steps::ArgErr(os.str());
     }
-    if (!tet->getInHost()) return;
+    if (tet == 0 || !tet->getInHost()) return;
     tet->reac(lridx)->setActive(act);
     _updateElement(tet->reac(lridx));
     _updateSum();
@@ -4120,7 +4973,7 @@ double smtos::TetOpSplitP::_getTetDiffD(uint tidx, uint didx, uint direction_tet
     assert (tidx < pTets.size());
     assert (didx < statedef()->countDiffs());
     
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4129,7 +4982,7 @@ double smtos::TetOpSplitP::_getTetDiffD(uint tidx, uint didx, uint direction_tet
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
     
-    uint ldidx = tet->compdef()->diffG2L(didx);
+    uint ldidx = _tetCompdef(tidx)->diffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4137,7 +4990,7 @@ double smtos::TetOpSplitP::_getTetDiffD(uint tidx, uint didx, uint direction_tet
         throw steps::ArgErr(os.str());
     }
     double dcst = 0.0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         if (direction_tet == std::numeric_limits<uint>::max()) {
             dcst = tet->diff(ldidx)->dcst();
         }
@@ -4169,7 +5022,7 @@ void smtos::TetOpSplitP::_setTetDiffD(uint tidx, uint didx, double dk, uint dire
     assert (tidx < pTets.size());
     assert (didx < statedef()->countDiffs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4178,7 +5031,7 @@ void smtos::TetOpSplitP::_setTetDiffD(uint tidx, uint didx, double dk, uint dire
     recomputeUpdPeriod = true;
     smtos::Tet * tet = pTets[tidx];
 
-    uint ldidx = tet->compdef()->diffG2L(didx);
+    uint ldidx = _tetCompdef(tidx)->diffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4186,7 +5039,7 @@ void smtos::TetOpSplitP::_setTetDiffD(uint tidx, uint didx, double dk, uint dire
         throw steps::ArgErr(os.str());
     }
     
-    if (!tet->getInHost()) return;
+    if (tet == 0 || !tet->getInHost()) return;
     
     if (direction_tet == std::numeric_limits<uint>::max()) {
         tet->diff(ldidx)->setDcst(dk);
@@ -4217,7 +5070,7 @@ bool smtos::TetOpSplitP::_getTetDiffActive(uint tidx, uint didx) const
     assert (tidx < pTets.size());
     assert (didx < statedef()->countDiffs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4226,7 +5079,7 @@ bool smtos::TetOpSplitP::_getTetDiffActive(uint tidx, uint didx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint ldidx = tet->compdef()->diffG2L(didx);
+    uint ldidx = _tetCompdef(tidx)->diffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4234,7 +5087,7 @@ bool smtos::TetOpSplitP::_getTetDiffActive(uint tidx, uint didx) const
         throw steps::ArgErr(os.str());
     }
     bool active = false;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         if (tet->diff(ldidx)->inactive() == true) active = false;
         else active = true;
     }
@@ -4249,7 +5102,7 @@ void smtos::TetOpSplitP::_setTetDiffActive(uint tidx, uint didx, bool act)
     assert (tidx < pTets.size());
     assert (didx < statedef()->countDiffs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4258,14 +5111,14 @@ void smtos::TetOpSplitP::_setTetDiffActive(uint tidx, uint didx, bool act)
 
     smtos::Tet * tet = pTets[tidx];
 
-    uint ldidx = tet->compdef()->diffG2L(didx);
+    uint ldidx = _tetCompdef(tidx)->diffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
         os << "Diffusion rule undefined in tetrahedron.\n";
         throw steps::ArgErr(os.str());
     }
-    if (!tet->getInHost()) return;
+    if (tet == 0 || !tet->getInHost()) return;
     tet->diff(ldidx)->setActive(act);
 
     recomputeUpdPeriod = true;
@@ -4281,7 +5134,7 @@ double smtos::TetOpSplitP::_getTetReacH(uint tidx, uint ridx) const
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4290,7 +5143,7 @@ double smtos::TetOpSplitP::_getTetReacH(uint tidx, uint ridx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4298,7 +5151,7 @@ double smtos::TetOpSplitP::_getTetReacH(uint tidx, uint ridx) const
         throw steps::ArgErr(os.str());
     }
     double h = 0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         h = tet->reac(lridx)->h();
     }
     MPI_Bcast(&h, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4312,7 +5165,7 @@ double smtos::TetOpSplitP::_getTetReacC(uint tidx, uint ridx) const
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4321,7 +5174,7 @@ double smtos::TetOpSplitP::_getTetReacC(uint tidx, uint ridx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4330,7 +5183,7 @@ double smtos::TetOpSplitP::_getTetReacC(uint tidx, uint ridx) const
     }
 
     double c = 0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         c = tet->reac(lridx)->c();
     }
     MPI_Bcast(&c, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4344,7 +5197,7 @@ double smtos::TetOpSplitP::_getTetReacA(uint tidx, uint ridx) const
     assert (tidx < pTets.size());
     assert (ridx < statedef()->countReacs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4353,7 +5206,7 @@ double smtos::TetOpSplitP::_getTetReacA(uint tidx, uint ridx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint lridx = tet->compdef()->reacG2L(ridx);
+    uint lridx = _tetCompdef(tidx)->reacG2L(ridx);
     if (lridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4361,7 +5214,7 @@ double smtos::TetOpSplitP::_getTetReacA(uint tidx, uint ridx) const
         throw steps::ArgErr(os.str());
     }
     double a = 0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         a = tet->reac(lridx)->rate();
     }
     MPI_Bcast(&a, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4375,7 +5228,7 @@ double smtos::TetOpSplitP::_getTetDiffA(uint tidx, uint didx) const
     assert (tidx < pTets.size());
     assert (didx < statedef()->countDiffs());
 
-    if (pTets[tidx] == 0 && tetHosts[tidx] == -1)
+    if (_tetCompdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
@@ -4384,7 +5237,7 @@ double smtos::TetOpSplitP::_getTetDiffA(uint tidx, uint didx) const
     int host = tetHosts[tidx];
     smtos::Tet * tet = pTets[tidx];
 
-    uint ldidx = tet->compdef()->diffG2L(didx);
+    uint ldidx = _tetCompdef(tidx)->diffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4392,7 +5245,7 @@ double smtos::TetOpSplitP::_getTetDiffA(uint tidx, uint didx) const
         throw steps::ArgErr(os.str());
     }
     double a = 0;
-    if (tet->getInHost()) {
+    if (tet != 0 && tet->getInHost()) {
         a = tet->diff(ldidx)->rate();
     }
     MPI_Bcast(&a, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4405,14 +5258,14 @@ double smtos::TetOpSplitP::_getTriArea(uint tidx) const
 {
     assert (tidx < pTris.size());
 
-    if (pTris[tidx] == 0)
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.";
         throw steps::ArgErr(os.str());
     }
 
-    return pTris[tidx]->area();
+    return pMesh->getTriArea(tidx);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4429,10 +5282,9 @@ bool smtos::TetOpSplitP::_getTriSpecDefined(uint tidx, uint sidx) const
     assert (tidx < pTris.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTris[tidx] == 0) return false;
+    if (_triPatchdef(tidx) == 0) return false;
 
-    smtos::Tri * tri = pTris[tidx];
-    uint lsidx = tri->patchdef()->specG2L(sidx);
+    uint lsidx = _triPatchdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED) return false;
     else return true;
 }
@@ -4446,7 +5298,7 @@ double smtos::TetOpSplitP::_getTriCount(uint tidx, uint sidx) const
     assert (tidx < pTris.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTris[tidx] <= 0)
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4454,7 +5306,7 @@ double smtos::TetOpSplitP::_getTriCount(uint tidx, uint sidx) const
     }
 
     smtos::Tri * tri = pTris[tidx];
-    uint lsidx = tri->patchdef()->specG2L(sidx);
+    uint lsidx = _triPatchdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4462,7 +5314,8 @@ double smtos::TetOpSplitP::_getTriCount(uint tidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    uint count = tri->pools()[lsidx];
+    uint count = 0;
+    if (tri != 0 && tri->getInHost()) count = tri->pools()[lsidx];
     std::map<uint,uint>::const_iterator it = triHosts.find(tidx);
     if (it == triHosts.end()) {
         std::ostringstream os;
@@ -4487,7 +5340,7 @@ void smtos::TetOpSplitP::_setTriCount(uint tidx, uint sidx, double n)
     assert (sidx < statedef()->countSpecs());
     assert (n >= 0.0);
 
-    if (pTris[tidx] == 0)
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4502,7 +5355,7 @@ void smtos::TetOpSplitP::_setTriCount(uint tidx, uint sidx, double n)
     }
 
     smtos::Tri * tri = pTris[tidx];
-    uint lsidx = tri->patchdef()->specG2L(sidx);
+    uint lsidx = _triPatchdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4525,8 +5378,11 @@ void smtos::TetOpSplitP::_setTriCount(uint tidx, uint sidx, double n)
 
     MPI_Bcast(&count, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     
-    tri->setCount(lsidx, count);
-    _updateSpec(tri, sidx);
+    if (tri != 0)
+    {
+        tri->setCount(lsidx, count);
+        _updateSpec(tri, sidx);
+    }
     _updateSum();
     MPI_Barrier(MPI_COMM_WORLD);
 }
@@ -4559,7 +5415,7 @@ bool smtos::TetOpSplitP::_getTriClamped(uint tidx, uint sidx) const
     assert (tidx < pTris.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTris[tidx] == 0)
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4568,7 +5424,7 @@ bool smtos::TetOpSplitP::_getTriClamped(uint tidx, uint sidx) const
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsidx = tri->patchdef()->specG2L(sidx);
+    uint lsidx = _triPatchdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4576,7 +5432,10 @@ bool smtos::TetOpSplitP::_getTriClamped(uint tidx, uint sidx) const
         throw steps::ArgErr(os.str());
     }
 
-    return tri->clamped(lsidx);
+    bool clamped = false;
+    if (tri != 0 && tri->getInHost()) clamped = tri->clamped(lsidx);
+    MPI_Bcast(&clamped, 1, MPI_C_BOOL, triHosts.at(tidx), MPI_COMM_WORLD);
+    return clamped;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4586,7 +5445,7 @@ void smtos::TetOpSplitP::_setTriClamped(uint tidx, uint sidx, bool buf)
     assert (tidx < pTris.size());
     assert (sidx < statedef()->countSpecs());
 
-    if (pTris[tidx] == 0)
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4595,7 +5454,7 @@ void smtos::TetOpSplitP::_setTriClamped(uint tidx, uint sidx, bool buf)
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsidx = tri->patchdef()->specG2L(sidx);
+    uint lsidx = _triPatchdef(tidx)->specG2L(sidx);
     if (lsidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4603,26 +5462,33 @@ void smtos::TetOpSplitP::_setTriClamped(uint tidx, uint sidx, bool buf)
         throw steps::ArgErr(os.str());
     }
 
-    tri->setClamped(lsidx, buf);
+    if (tri != 0) tri->setClamped(lsidx, buf);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::_getTriSReacK(uint tidx, uint ridx)
+double smtos::TetOpSplitP::_getTriSReacK(uint tidx, uint ridx) const
 {
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
         throw steps::ArgErr(os.str());
     }
-    uint host = triHosts[tidx];
+    std::map<uint,uint>::const_iterator host_it = triHosts.find(tidx);
+    if (host_it == triHosts.end())
+    {
+        std::ostringstream os;
+        os << "Triangle " << tidx << " has not been assigned to a host.\n";
+        throw steps::ArgErr(os.str());
+    }
+    uint host = host_it->second;
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4630,7 +5496,7 @@ double smtos::TetOpSplitP::_getTriSReacK(uint tidx, uint ridx)
         throw steps::ArgErr(os.str());
     }
     double kcst = 0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         kcst = tri->sreac(lsridx)->kcst();
     }
     MPI_Bcast(&kcst, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
@@ -4644,7 +5510,7 @@ void smtos::TetOpSplitP::_setTriSReacK(uint tidx, uint ridx, double kf)
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4652,14 +5518,14 @@ void smtos::TetOpSplitP::_setTriSReacK(uint tidx, uint ridx, double kf)
     }
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
         os << "Surface reaction undefined in triangle.\n";
         throw steps::ArgErr(os.str());
     }
-    if (!tri->getInHost()) return;
+    if (tri == 0 || !tri->getInHost()) return;
     
     tri->sreac(lsridx)->setKcst(kf);
     _updateElement(tri->sreac(lsridx));
@@ -4669,21 +5535,28 @@ void smtos::TetOpSplitP::_setTriSReacK(uint tidx, uint ridx, double kf)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool smtos::TetOpSplitP::_getTriSReacActive(uint tidx, uint ridx)
+bool smtos::TetOpSplitP::_getTriSReacActive(uint tidx, uint ridx) const
 {
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
         throw steps::ArgErr(os.str());
     }
-    uint host = triHosts[tidx];
+    std::map<uint,uint>::const_iterator host_it = triHosts.find(tidx);
+    if (host_it == triHosts.end())
+    {
+        std::ostringstream os;
+        os << "Triangle " << tidx << " has not been assigned to a host.\n";
+        throw steps::ArgErr(os.str());
+    }
+    uint host = host_it->second;
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4691,7 +5564,7 @@ bool smtos::TetOpSplitP::_getTriSReacActive(uint tidx, uint ridx)
         throw steps::ArgErr(os.str());
     }
     bool active = false;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         if (tri->sreac(lsridx)->inactive() == true)  active = false;
         else  active = true;
     }
@@ -4715,14 +5588,14 @@ void smtos::TetOpSplitP::_setTriSReacActive(uint tidx, uint ridx, bool act)
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
         os << "Surface reaction undefined in triangle.\n";
         throw steps::ArgErr(os.str());
     }
-    if (!tri->getInHost()) return;
+    if (tri == 0 || !tri->getInHost()) return;
     tri->sreac(lsridx)->setActive(act);
     _updateElement(tri->sreac(lsridx));
     _updateSum();
@@ -4735,7 +5608,7 @@ double smtos::TetOpSplitP::_getTriSDiffD(uint tidx, uint didx, uint direction_tr
     assert (tidx < pTris.size());
     assert (didx < statedef()->countSurfDiffs());
     
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4744,7 +5617,7 @@ double smtos::TetOpSplitP::_getTriSDiffD(uint tidx, uint didx, uint direction_tr
     uint host = triHosts[tidx];
     smtos::Tri * tri = pTris[tidx];
     
-    uint ldidx = tri->patchdef()->surfdiffG2L(didx);
+    uint ldidx = _triPatchdef(tidx)->surfdiffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4752,7 +5625,7 @@ double smtos::TetOpSplitP::_getTriSDiffD(uint tidx, uint didx, uint direction_tr
         throw steps::ArgErr(os.str());
     }
     double dcst = 0.0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         if (direction_tri == std::numeric_limits<uint>::max()) {
             dcst = tri->sdiff(ldidx)->dcst();
             
@@ -4785,7 +5658,7 @@ void smtos::TetOpSplitP::_setTriSDiffD(uint tidx, uint didx, double dk, uint dir
     assert (tidx < pTris.size());
     assert (didx < statedef()->countSurfDiffs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4794,7 +5667,7 @@ void smtos::TetOpSplitP::_setTriSDiffD(uint tidx, uint didx, double dk, uint dir
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint ldidx = tri->patchdef()->surfdiffG2L(didx);
+    uint ldidx = _triPatchdef(tidx)->surfdiffG2L(didx);
     if (ldidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4802,7 +5675,7 @@ void smtos::TetOpSplitP::_setTriSDiffD(uint tidx, uint didx, double dk, uint dir
         throw steps::ArgErr(os.str());
     }
     recomputeUpdPeriod = true;
-    if (!tri->getInHost()) return;
+    if (tri == 0 || !tri->getInHost()) return;
     
     if (direction_tri == std::numeric_limits<uint>::max()) {
         tri->sdiff(ldidx)->setDcst(dk);
@@ -4833,7 +5706,7 @@ bool smtos::TetOpSplitP::_getTriVDepSReacActive(uint tidx, uint vsridx)
     assert (tidx < pTris.size());
     assert (vsridx < statedef()->countVDepSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4842,7 +5715,7 @@ bool smtos::TetOpSplitP::_getTriVDepSReacActive(uint tidx, uint vsridx)
     uint host = triHosts[tidx];
     smtos::Tri * tri = pTris[tidx];
 
-    uint lvsridx = tri->patchdef()->vdepsreacG2L(vsridx);
+    uint lvsridx = _triPatchdef(tidx)->vdepsreacG2L(vsridx);
     if (lvsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4850,7 +5723,7 @@ bool smtos::TetOpSplitP::_getTriVDepSReacActive(uint tidx, uint vsridx)
         throw steps::ArgErr(os.str());
     }
     bool active = false;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         if (tri->vdepsreac(lvsridx)->inactive() == true)  active = false;
         else  active = true;
     }
@@ -4865,7 +5738,7 @@ void smtos::TetOpSplitP::_setTriVDepSReacActive(uint tidx, uint vsridx, bool act
     assert (tidx < pTris.size());
     assert (vsridx < statedef()->countVDepSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
@@ -4874,14 +5747,14 @@ void smtos::TetOpSplitP::_setTriVDepSReacActive(uint tidx, uint vsridx, bool act
     uint host = triHosts[tidx];
     smtos::Tri * tri = pTris[tidx];
 
-    uint lvsridx = tri->patchdef()->vdepsreacG2L(vsridx);
+    uint lvsridx = _triPatchdef(tidx)->vdepsreacG2L(vsridx);
     if (lvsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
         os << "Voltage-dependent surface reaction undefined in triangle.\n";
         throw steps::ArgErr(os.str());
     }
-    if (!tri->getInHost()) return;
+    if (tri == 0 || !tri->getInHost()) return;
     tri->vdepsreac(lvsridx)->setActive(act);
     _updateElement(tri->vdepsreac(lvsridx));
     _updateSum();
@@ -4889,21 +5762,28 @@ void smtos::TetOpSplitP::_setTriVDepSReacActive(uint tidx, uint vsridx, bool act
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::_getTriSReacH(uint tidx, uint ridx)
+double smtos::TetOpSplitP::_getTriSReacH(uint tidx, uint ridx) const
 {
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
         throw steps::ArgErr(os.str());
     }
-    uint host = triHosts[tidx];
+    std::map<uint,uint>::const_iterator host_it = triHosts.find(tidx);
+    if (host_it == triHosts.end())
+    {
+        std::ostringstream os;
+        os << "Triangle " << tidx << " has not been assigned to a host.\n";
+        throw steps::ArgErr(os.str());
+    }
+    uint host = host_it->second;
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4911,28 +5791,35 @@ double smtos::TetOpSplitP::_getTriSReacH(uint tidx, uint ridx)
         throw steps::ArgErr(os.str());
     }
     double h = 0;
-    if (tri->getInHost()) h = tri->sreac(lsridx)->h();
+    if (tri != 0 && tri->getInHost()) h = tri->sreac(lsridx)->h();
     MPI_Bcast(&h, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
     return h;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::_getTriSReacC(uint tidx, uint ridx)
+double smtos::TetOpSplitP::_getTriSReacC(uint tidx, uint ridx) const
 {
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
         throw steps::ArgErr(os.str());
     }
-    uint host = triHosts[tidx];
+    std::map<uint,uint>::const_iterator host_it = triHosts.find(tidx);
+    if (host_it == triHosts.end())
+    {
+        std::ostringstream os;
+        os << "Triangle " << tidx << " has not been assigned to a host.\n";
+        throw steps::ArgErr(os.str());
+    }
+    uint host = host_it->second;
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4941,28 +5828,35 @@ double smtos::TetOpSplitP::_getTriSReacC(uint tidx, uint ridx)
     }
 
     double c = 0;
-    if (tri->getInHost()) c = tri->sreac(lsridx)->c();
+    if (tri != 0 && tri->getInHost()) c = tri->sreac(lsridx)->c();
     MPI_Bcast(&c, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
     return c;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::_getTriSReacA(uint tidx, uint ridx)
+double smtos::TetOpSplitP::_getTriSReacA(uint tidx, uint ridx) const
 {
     assert (tidx < pTris.size());
     assert (ridx < statedef()->countSReacs());
 
-    if (pTris[tidx] == 0 && triHosts.find(tidx) == triHosts.end())
+    if (_triPatchdef(tidx) == 0)
     {
         std::ostringstream os;
         os << "Triangle " << tidx << " has not been assigned to a patch.\n";
         throw steps::ArgErr(os.str());
     }
-    uint host = triHosts[tidx];
+    std::map<uint,uint>::const_iterator host_it = triHosts.find(tidx);
+    if (host_it == triHosts.end())
+    {
+        std::ostringstream os;
+        os << "Triangle " << tidx << " has not been assigned to a host.\n";
+        throw steps::ArgErr(os.str());
+    }
+    uint host = host_it->second;
     smtos::Tri * tri = pTris[tidx];
 
-    uint lsridx = tri->patchdef()->sreacG2L(ridx);
+    uint lsridx = _triPatchdef(tidx)->sreacG2L(ridx);
     if (lsridx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -4971,7 +5865,7 @@ double smtos::TetOpSplitP::_getTriSReacA(uint tidx, uint ridx)
     }
 
     double a = 0;
-    if (tri->getInHost()) a =  tri->sreac(lsridx)->rate();
+    if (tri != 0 && tri->getInHost()) a =  tri->sreac(lsridx)->rate();
     MPI_Bcast(&a, 1, MPI_DOUBLE, host, MPI_COMM_WORLD);
     return a;
 }
@@ -4997,7 +5891,7 @@ void smtos::TetOpSplitP::setEfieldDT(double efdt)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::_getTetV(uint tidx) const
+void smtos::TetOpSplitP::setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol)
 {
     if (efflag() != true)
     {
@@ -5005,22 +5899,25 @@ double smtos::TetOpSplitP::_getTetV(uint tidx) const
         os << "Method not available: EField calculation not included in simulation.";
         throw steps::ArgErr(os.str());
     }
-    int loctidx = pEFTet_GtoL[tidx];
-    if (loctidx == -1)
+    pEField->setAdaptive(adaptive, dtmin, dtmax, errtol);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::getEfieldAdaptive(void) const
+{
+    if (efflag() != true)
     {
         std::ostringstream os;
-        os << "Tetrahedron index " << tidx << " not assigned to a conduction volume.";
+        os << "Method not available: EField calculation not included in simulation.";
         throw steps::ArgErr(os.str());
     }
-
-    // EField object should convert value to base s.i. units
-    return pEField->getTetV(loctidx);
-
+    return pEField->getAdaptive();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP::_setTetV(uint tidx, double v)
+ulong smtos::TetOpSplitP::getEfieldNStepsWithinTolerance(void) const
 {
     if (efflag() != true)
     {
@@ -5028,14 +5925,77 @@ void smtos::TetOpSplitP::_setTetV(uint tidx, double v)
         os << "Method not available: EField calculation not included in simulation.";
         throw steps::ArgErr(os.str());
     }
-    int loctidx = pEFTet_GtoL[tidx];
-    if (loctidx == -1)
-    {
-        std::ostringstream os;
+    return pEField->getNStepsWithinTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong smtos::TetOpSplitP::getEfieldNStepsOverTolerance(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getNStepsOverTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double smtos::TetOpSplitP::_getTetV(uint tidx) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    int loctidx = pEFTet_GtoL[tidx];
+    if (_isEFTet(tidx) == false)
+    {
+        std::ostringstream os;
+        os << "Tetrahedron index " << tidx << " not assigned to a conduction volume.";
+        throw steps::ArgErr(os.str());
+    }
+
+    if (efdist())
+    {
+        double v = 0.0;
+        if (pEFTetHosts[tidx] == myRank) v = pEField->getTetV(loctidx);
+        MPI_Bcast(&v, 1, MPI_DOUBLE, pEFTetHosts[tidx], MPI_COMM_WORLD);
+        return v;
+    }
+
+    // EField object should convert value to base s.i. units
+    return pEField->getTetV(loctidx);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_setTetV(uint tidx, double v)
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    int loctidx = pEFTet_GtoL[tidx];
+    if (_isEFTet(tidx) == false)
+    {
+        std::ostringstream os;
         os << "Tetrahedron index " << tidx << " not assigned to a conduction volume.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        _forLocalEFVerts(mesh()->_getTet(tidx), 4, [&](int locvidx) { pEField->setVertV(locvidx, v); });
+        return;
+    }
+
     // EField object should convert to millivolts
     pEField->setTetV(loctidx, v);
 }
@@ -5051,13 +6011,21 @@ bool smtos::TetOpSplitP::_getTetVClamped(uint tidx) const
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTet_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTet(tidx) == false)
     {
         std::ostringstream os;
         os << "Tetrahedron index " << tidx << " not assigned to a conduction volume.";
         throw steps::ArgErr(os.str());
     }
-    
+
+    if (efdist())
+    {
+        bool clamped = false;
+        if (pEFTetHosts[tidx] == myRank) clamped = pEField->getTetVClamped(loctidx);
+        MPI_Bcast(&clamped, 1, MPI_C_BOOL, pEFTetHosts[tidx], MPI_COMM_WORLD);
+        return clamped;
+    }
+
     return pEField->getTetVClamped(loctidx);
 }
 
@@ -5072,13 +6040,19 @@ void smtos::TetOpSplitP::_setTetVClamped(uint tidx, bool cl)
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTet_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTet(tidx) == false)
     {
         std::ostringstream os;
         os << "Tetrahedron index " << tidx << " not assigned to a conduction volume.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        _forLocalEFVerts(mesh()->_getTet(tidx), 4, [&](int locvidx) { pEField->setVertVClamped(locvidx, cl); });
+        return;
+    }
+
     pEField->setTetVClamped(loctidx, cl);
 }
 
@@ -5093,12 +6067,20 @@ double smtos::TetOpSplitP::_getTriV(uint tidx) const
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
+    if (efdist())
+    {
+        double v = 0.0;
+        if (pEFTriHosts[tidx] == myRank) v = EFTrisV[loctidx];
+        MPI_Bcast(&v, 1, MPI_DOUBLE, pEFTriHosts[tidx], MPI_COMM_WORLD);
+        return v;
+    }
+
     // EField object should convert value to base s.i. units
     return EFTrisV[loctidx];
 }
@@ -5114,13 +6096,20 @@ void smtos::TetOpSplitP::_setTriV(uint tidx, double v)
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        if (loctidx != -1) EFTrisV[loctidx] = v;
+        _forLocalEFVerts(mesh()->_getTri(tidx), 3, [&](int locvidx) { pEField->setVertV(locvidx, v); });
+        return;
+    }
+
     // EField object should convert to millivolts
     EFTrisV[loctidx] = v;
     pEField->setTriV(loctidx, v);
@@ -5137,13 +6126,21 @@ bool smtos::TetOpSplitP::_getTriVClamped(uint tidx) const
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        bool clamped = false;
+        if (pEFTriHosts[tidx] == myRank) clamped = pEField->getTriVClamped(loctidx);
+        MPI_Bcast(&clamped, 1, MPI_C_BOOL, pEFTriHosts[tidx], MPI_COMM_WORLD);
+        return clamped;
+    }
+
     return pEField->getTriVClamped(loctidx);
 }
 
@@ -5158,13 +6155,19 @@ void smtos::TetOpSplitP::_setTriVClamped(uint tidx, bool cl)
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        _forLocalEFVerts(mesh()->_getTri(tidx), 3, [&](int locvidx) { pEField->setVertVClamped(locvidx, cl); });
+        return;
+    }
+
     pEField->setTriVClamped(loctidx, cl);
 }
 
@@ -5182,7 +6185,7 @@ double smtos::TetOpSplitP::_getTriOhmicI(uint tidx)
     smtos::Tri * tri = pTris[tidx];
 
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
@@ -5190,7 +6193,7 @@ double smtos::TetOpSplitP::_getTriOhmicI(uint tidx)
     }
     int tri_host = triHosts[tidx];
     double cur = 0.0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         cur = tri->getOhmicI(EFTrisV[loctidx], efdt());
     }
     MPI_Bcast(&cur, 1, MPI_DOUBLE, tri_host, MPI_COMM_WORLD);
@@ -5205,7 +6208,7 @@ double smtos::TetOpSplitP::_getTriOhmicI(uint tidx, uint ocidx)
     assert (ocidx < statedef()->countOhmicCurrs());
 
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
@@ -5214,7 +6217,7 @@ double smtos::TetOpSplitP::_getTriOhmicI(uint tidx, uint ocidx)
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint locidx = tri->patchdef()->ohmiccurrG2L(ocidx);
+    uint locidx = _triPatchdef(tidx)->ohmiccurrG2L(ocidx);
     if (locidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -5223,7 +6226,7 @@ double smtos::TetOpSplitP::_getTriOhmicI(uint tidx, uint ocidx)
     }
     int tri_host = triHosts[tidx];
     double cur = 0.0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         cur = tri->getOhmicI(locidx, EFTrisV[loctidx], efdt());
     }
     MPI_Bcast(&cur, 1, MPI_DOUBLE, tri_host, MPI_COMM_WORLD);
@@ -5245,7 +6248,7 @@ double smtos::TetOpSplitP::_getTriGHKI(uint tidx)
     
     int tri_host = triHosts[tidx];
     double cur = 0.0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         cur = tri->getGHKI(efdt());
     }
     MPI_Bcast(&cur, 1, MPI_DOUBLE, tri_host, MPI_COMM_WORLD);
@@ -5265,7 +6268,7 @@ double smtos::TetOpSplitP::_getTriGHKI(uint tidx, uint ghkidx)
 
     smtos::Tri * tri = pTris[tidx];
 
-    uint locidx = tri->patchdef()->ghkcurrG2L(ghkidx);
+    uint locidx = _triPatchdef(tidx)->ghkcurrG2L(ghkidx);
     if (locidx == ssolver::LIDX_UNDEFINED)
     {
         std::ostringstream os;
@@ -5275,7 +6278,7 @@ double smtos::TetOpSplitP::_getTriGHKI(uint tidx, uint ghkidx)
 
     int tri_host = triHosts[tidx];
     double cur = 0.0;
-    if (tri->getInHost()) {
+    if (tri != 0 && tri->getInHost()) {
         cur = tri->getGHKI(locidx, efdt());
     }
     MPI_Bcast(&cur, 1, MPI_DOUBLE, tri_host, MPI_COMM_WORLD);
@@ -5294,13 +6297,21 @@ double smtos::TetOpSplitP::_getTriI(uint tidx) const
     }
 
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        double v = 0.0;
+        if (pEFTriHosts[tidx] == myRank) v = pEField->getTriI(loctidx);
+        MPI_Bcast(&v, 1, MPI_DOUBLE, pEFTriHosts[tidx], MPI_COMM_WORLD);
+        return v;
+    }
+
     // EField object should convert to required units
     return pEField->getTriI(loctidx);
 }
@@ -5316,13 +6327,16 @@ void smtos::TetOpSplitP::_setVertIClamp(uint vidx, double cur)
         throw steps::ArgErr(os.str());
     }
     int locvidx = pEFVert_GtoL[vidx];
-    if (locvidx == -1)
+    if (_isEFVert(vidx) == false)
     {
         std::ostringstream os;
         os << "Vertex index " << vidx << " not assigned to a conduction volume or membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    // A distributed EField sums the clamps of all ranks holding the vertex
+    if (efdist() && pEFVertHosts[vidx] != myRank) return;
+
     // EField object should convert to required units
     pEField->setVertIClamp(locvidx, cur);
 }
@@ -5339,13 +6353,15 @@ void smtos::TetOpSplitP::_setTriIClamp(uint tidx, double cur)
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist() && pEFTriHosts[tidx] != myRank) return;
+
     // EField object should convert to required units
     pEField->setTriIClamp(loctidx, cur);
 }
@@ -5361,13 +6377,19 @@ void smtos::TetOpSplitP::_setTriCapac(uint tidx, double cap)
         throw steps::ArgErr(os.str());
     }
     int loctidx = pEFTri_GtoL[tidx];
-    if (loctidx == -1)
+    if (_isEFTri(tidx) == false)
     {
         std::ostringstream os;
         os << "Triangle index " << tidx << " not assigned to a membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        _forLocalEFVerts(mesh()->_getTri(tidx), 3, [&](int locvidx) { pEField->setVertCapac(locvidx, cap); });
+        return;
+    }
+
     // EField object should convert to required units
     pEField->setTriCapac(loctidx, cap);
 }
@@ -5383,12 +6405,20 @@ double smtos::TetOpSplitP::_getVertV(uint vidx) const
         throw steps::ArgErr(os.str());
     }
     int locvidx = pEFVert_GtoL[vidx];
-    if (locvidx == -1)
+    if (_isEFVert(vidx) == false)
     {
         std::ostringstream os;
         os << "Vertex index " << vidx << " not assigned to a conduction volume or membrane.";
         throw steps::ArgErr(os.str());
     }
+    if (efdist())
+    {
+        double v = 0.0;
+        if (pEFVertHosts[vidx] == myRank) v = pEField->getVertV(locvidx);
+        MPI_Bcast(&v, 1, MPI_DOUBLE, pEFVertHosts[vidx], MPI_COMM_WORLD);
+        return v;
+    }
+
     return pEField->getVertV(locvidx);
 }
 
@@ -5403,12 +6433,14 @@ void smtos::TetOpSplitP::_setVertV(uint vidx, double v)
         throw steps::ArgErr(os.str());
     }
     int locvidx = pEFVert_GtoL[vidx];
-    if (locvidx == -1)
+    if (_isEFVert(vidx) == false)
     {
         std::ostringstream os;
         os << "Vertex index " << vidx << " not assigned to a conduction volume or membrane.";
         throw steps::ArgErr(os.str());
     }
+    if (locvidx == -1) return;
+
     // EField object should convert to millivolts
     pEField->setVertV(locvidx, v);
 }
@@ -5424,13 +6456,21 @@ bool smtos::TetOpSplitP::_getVertVClamped(uint vidx) const
         throw steps::ArgErr(os.str());
     }
     int locvidx = pEFVert_GtoL[vidx];
-    if (locvidx == -1)
+    if (_isEFVert(vidx) == false)
     {
         std::ostringstream os;
         os << "Vertex index " << vidx << " not assigned to a conduction volume or membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (efdist())
+    {
+        bool clamped = false;
+        if (pEFVertHosts[vidx] == myRank) clamped = pEField->getVertVClamped(locvidx);
+        MPI_Bcast(&clamped, 1, MPI_C_BOOL, pEFVertHosts[vidx], MPI_COMM_WORLD);
+        return clamped;
+    }
+
     return pEField->getVertVClamped(locvidx);
 }
 
@@ -5445,13 +6485,15 @@ void smtos::TetOpSplitP::_setVertVClamped(uint vidx, bool cl)
         throw steps::ArgErr(os.str());
     }
     int locvidx = pEFVert_GtoL[vidx];
-    if (locvidx == -1)
+    if (_isEFVert(vidx) == false)
     {
         std::ostringstream os;
         os << "Vertex index " << vidx << " not assigned to a conduction volume or membrane.";
         throw steps::ArgErr(os.str());
     }
 
+    if (locvidx == -1) return;
+
     // EField object should convert to millivolts
     pEField->setVertVClamped(locvidx, cl);
 }
@@ -5534,6 +6576,7 @@ void smtos::TetOpSplitP::_setMembVolRes(uint midx, double ro)
     // EField object should convert to required units
     assert (midx == 0);
     pEField->setMembVolRes(midx, ro);
+    pEFVolRes = ro;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -5568,11 +6611,73 @@ void smtos::TetOpSplitP::_computeUpdPeriod(void)
         throw steps::ArgErr(os.str());
     }
     updPeriod = 1.0 / global_max_rate;
+
+    // Level of every rule: the most doublings of the base period that stay
+    // within its mean dwell period, so that no more than all molecules of
+    // a rule can diffuse in one of its periods.
+    auto level = [this](double scaleddcst) {
+        uint k = 0;
+        while (k + 1 < pUpdLevels && updPeriod * double(2u << k) * scaleddcst <= 1.0) ++k;
+        return k;
+    };
+    std::vector<uint> diff_levels(pDiffs.size());
+    for (uint pos = 0; pos < pDiffs.size(); ++pos)
+    {
+        Diff* d = pDiffs[pos];
+        diff_levels[pos] = level(d->active() ? d->getScaledDcst() : 0.0);
+    }
+    std::vector<uint> sdiff_levels(pSDiffs.size());
+    for (uint pos = 0; pos < pSDiffs.size(); ++pos)
+    {
+        SDiff* d = pSDiffs[pos];
+        sdiff_levels[pos] = level(d->active() ? d->getScaledDcst() : 0.0);
+    }
+    sortByLevel(pDiffs, 0, diffBndSep, diff_levels, pUpdLevels, diffBndLevelSeps);
+    sortByLevel(pDiffs, diffBndSep, diffSep, diff_levels, pUpdLevels, diffLevelSeps);
+    sortByLevel(pSDiffs, 0, sdiffBndSep, sdiff_levels, pUpdLevels, sdiffBndLevelSeps);
+    sortByLevel(pSDiffs, sdiffBndSep, sdiffSep, sdiff_levels, pUpdLevels, sdiffLevelSeps);
+    for (uint pos = 0; pos < pDiffs.size(); ++pos) pDiffs[pos]->crData.pos = pos;
+    for (uint pos = 0; pos < pSDiffs.size(); ++pos) pSDiffs[pos]->crData.pos = pos;
+
+    uint local_min_level = pUpdLevels - 1;
+    for (uint k = 0; k < pUpdLevels; ++k)
+    {
+        if (diffBndLevelSeps[k] != 0 || sdiffBndLevelSeps[k] != 0)
+        {
+            local_min_level = k;
+            break;
+        }
+    }
+    MPI_Allreduce(&local_min_level, &pMinBndLevel, 1, MPI_UNSIGNED, MPI_MIN, MPI_COMM_WORLD);
+
+    pUpdCycle = 0;
+    pUpdLevelTime.assign(pUpdLevels, 0.0);
     recomputeUpdPeriod = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::TetOpSplitP::setUpdPeriodLevels(uint nlevels)
+{
+    if (nlevels == 0 || nlevels > MAX_UPD_LEVELS)
+    {
+        std::ostringstream os;
+        os << "Number of update period levels must be between 1 and " << MAX_UPD_LEVELS << ".";
+        throw steps::ArgErr(os.str());
+    }
+    pUpdLevels = nlevels;
+    recomputeUpdPeriod = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::getUpdPeriodLevels(void) const
+{
+    return pUpdLevels;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::TetOpSplitP::_updateLocal(std::set<KProc*> const & upd_entries) {
     for (auto kp : upd_entries) {
         assert(kp != NULL);
@@ -5694,7 +6799,10 @@ void smtos::TetOpSplitP::_updateElement(KProc* kp)
 {
     
     if (kp->getType() == KP_DIFF || kp->getType() == KP_SDIFF) {
-        kp->crData.rate = kp->rate(this);;
+        double rate = kp->rate(this);
+        kp->crData.rate = rate;
+        std::vector<double> & rates = (kp->getType() == KP_DIFF) ? pDiffRates : pSDiffRates;
+        if (kp->crData.pos < rates.size()) rates[kp->crData.pos] = rate;
         return;
     }
   
@@ -5875,7 +6983,7 @@ std::vector<double> smtos::TetOpSplitP::getBatchTetCounts(std::vector<uint> cons
             throw steps::ArgErr(os.str());
         }
 
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -5883,14 +6991,14 @@ std::vector<double> smtos::TetOpSplitP::getBatchTetCounts(std::vector<uint> cons
         }
 
         smtos::Tet * tet = pTets[tidx];
-        uint slidx = tet->compdef()->specG2L(sgidx);
+        uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
             has_spec_warning = true;
             continue;
         }
-        if (tet->getInHost()) {
+        if (tet != 0 && tet->getInHost()) {
             local_counts[t] = tet->pools()[slidx];
         }
         
@@ -5933,7 +7041,7 @@ std::vector<double> smtos::TetOpSplitP::getBatchTriCounts(std::vector<uint> cons
             throw steps::ArgErr(os.str());
         }
 
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -5941,14 +7049,14 @@ std::vector<double> smtos::TetOpSplitP::getBatchTriCounts(std::vector<uint> cons
         }
 
         smtos::Tri * tri = pTris[tidx];
-        uint slidx = tri->patchdef()->specG2L(sgidx);
+        uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
             has_spec_warning = true;
             continue;
         }
-        if (tri->getInHost()) {
+        if (tri != 0 && tri->getInHost()) {
             local_counts[t] = tri->pools()[slidx];
         }
         
@@ -5997,7 +7105,7 @@ void smtos::TetOpSplitP::getBatchTetCountsNP(unsigned int* indices, int input_si
             throw steps::ArgErr(os.str());
         }
 
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -6005,7 +7113,7 @@ void smtos::TetOpSplitP::getBatchTetCountsNP(unsigned int* indices, int input_si
         }
 
         smtos::Tet * tet = pTets[tidx];
-        uint slidx = tet->compdef()->specG2L(sgidx);
+        uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
@@ -6013,7 +7121,7 @@ void smtos::TetOpSplitP::getBatchTetCountsNP(unsigned int* indices, int input_si
             continue;
         }
         
-        if (tet->getInHost()) {
+        if (tet != 0 && tet->getInHost()) {
             local_counts[t] = tet->pools()[slidx];
         }
         
@@ -6060,7 +7168,7 @@ void smtos::TetOpSplitP::getBatchTriCountsNP(unsigned int* indices, int input_si
             throw steps::ArgErr(os.str());
         }
 
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -6068,14 +7176,14 @@ void smtos::TetOpSplitP::getBatchTriCountsNP(unsigned int* indices, int input_si
         }
 
         smtos::Tri * tri = pTris[tidx];
-        uint slidx = tri->patchdef()->specG2L(sgidx);
+        uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
             has_spec_warning = true;
             continue;
         }
-        if (tri->getInHost()) {
+        if (tri != 0 && tri->getInHost()) {
             local_counts[t] = tri->pools()[slidx];
         }
         
@@ -6090,6 +7198,7 @@ void smtos::TetOpSplitP::getBatchTriCountsNP(unsigned int* indices, int input_si
         std::cerr << "Warning: Species " << s << " has not been defined in the following triangles, fill in zeros at target positions:\n";
         std::cerr << spec_undefined.str() << "\n";
     }
+    MPI_Allreduce(&local_counts.front(), counts, input_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -6113,7 +7222,7 @@ double smtos::TetOpSplitP::sumBatchTetCountsNP(unsigned int* indices, int input_
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -6121,7 +7230,7 @@ double smtos::TetOpSplitP::sumBatchTetCountsNP(unsigned int* indices, int input_
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint slidx = tet->compdef()->specG2L(sgidx);
+        uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
@@ -6129,7 +7238,7 @@ double smtos::TetOpSplitP::sumBatchTetCountsNP(unsigned int* indices, int input_
             continue;
         }
         
-        if (tet->getInHost()) {
+        if (tet != 0 && tet->getInHost()) {
             partial_sum += tet->pools()[slidx];
         }
     }
@@ -6170,7 +7279,7 @@ double smtos::TetOpSplitP::sumBatchTriCountsNP(unsigned int* indices, int input_
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -6178,14 +7287,14 @@ double smtos::TetOpSplitP::sumBatchTriCountsNP(unsigned int* indices, int input_
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint slidx = tri->patchdef()->specG2L(sgidx);
+        uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
             has_spec_warning = true;
             continue;
         }
-        if (tri->getInHost()) {
+        if (tri != 0 && tri->getInHost()) {
             partial_sum += tri->pools()[slidx];
         }
     }
@@ -6233,7 +7342,7 @@ double smtos::TetOpSplitP::sumBatchTriGHKIsNP(unsigned int* indices, int input_s
         
         smtos::Tri * tri = pTris[tidx];
         
-        uint locidx = tri->patchdef()->ghkcurrG2L(ghkidx);
+        uint locidx = _triPatchdef(tidx)->ghkcurrG2L(ghkidx);
         if (locidx == ssolver::LIDX_UNDEFINED)
         {
             std::ostringstream os;
@@ -6241,7 +7350,7 @@ double smtos::TetOpSplitP::sumBatchTriGHKIsNP(unsigned int* indices, int input_s
             throw steps::ArgErr(os.str());
         }
         
-        if (tri->getInHost()) {
+        if (tri != 0 && tri->getInHost()) {
             partial_sum += tri->getGHKI(locidx, efdt());
         }
     }
@@ -6279,7 +7388,7 @@ double smtos::TetOpSplitP::sumBatchTriOhmicIsNP(unsigned int* indices, int input
         
         smtos::Tri * tri = pTris[tidx];
         
-        uint locidx = tri->patchdef()->ohmiccurrG2L(ocidx);
+        uint locidx = _triPatchdef(tidx)->ohmiccurrG2L(ocidx);
         if (locidx == ssolver::LIDX_UNDEFINED)
         {
             std::ostringstream os;
@@ -6287,7 +7396,7 @@ double smtos::TetOpSplitP::sumBatchTriOhmicIsNP(unsigned int* indices, int input
             throw steps::ArgErr(os.str());
         }
         
-        if (tri->getInHost()) {
+        if (tri != 0 && tri->getInHost()) {
             partial_sum += tri->getOhmicI(locidx, EFTrisV[loctidx], efdt());
         }
     }
@@ -6298,114 +7407,442 @@ double smtos::TetOpSplitP::sumBatchTriOhmicIsNP(unsigned int* indices, int input
 
 ////////////////////////////////////////////////////////////////////////////////
 
-////////////////////////////////////////////////////////////////////////
-// ROI Data Access
-////////////////////////////////////////////////////////////////////////
+static void check_batch_sizes(int input_size, int values_size)
+{
+    if (input_size != values_size)
+    {
+        std::ostringstream os;
+        os << "Error: values array size should be the same as input array (indices) size.\n";
+        throw steps::ArgErr(os.str());
+    }
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<double> smtos::TetOpSplitP::getROITetCounts(std::string ROI_id, std::string const & s) const
+std::vector<uint> smtos::TetOpSplitP::_batchTetLidcs(unsigned int* indices, int input_size, bool spec, uint gidx) const
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int inputsize = mesh()->getROIDataSize(ROI_id);
-    std::vector<double> data(inputsize);
-    
-    getBatchTetCountsNP(indices, inputsize, s, const_cast<double*>(&data.front()), data.size());
-    return data;
+    std::vector<uint> lidcs(input_size);
+    for (int t = 0; t < input_size; t++)
+    {
+        uint tidx = indices[t];
+        if (tidx >= pTets.size())
+        {
+            std::ostringstream os;
+            os << "Error (Index Overbound): There is no tetrahedron with index " << tidx << ".\n";
+            throw steps::ArgErr(os.str());
+        }
+        ssolver::Compdef * comp = _tetCompdef(tidx);
+        if (comp == 0)
+        {
+            std::ostringstream os;
+            os << "Tetrahedron " << tidx << " has not been assigned to a compartment.\n";
+            throw steps::ArgErr(os.str());
+        }
+        lidcs[t] = spec ? comp->specG2L(gidx) : comp->reacG2L(gidx);
+        if (lidcs[t] == ssolver::LIDX_UNDEFINED)
+        {
+            std::ostringstream os;
+            os << (spec ? "Species" : "Reaction") << " undefined in tetrahedron " << tidx << ".\n";
+            throw steps::ArgErr(os.str());
+        }
+    }
+    return lidcs;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<double> smtos::TetOpSplitP::getROITriCounts(std::string ROI_id, std::string const & s) const
+std::vector<uint> smtos::TetOpSplitP::_batchTriLidcs(unsigned int* indices, int input_size, bool spec, uint gidx) const
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int inputsize = mesh()->getROIDataSize(ROI_id);
-    std::vector<double> data(inputsize);
-    
-    getBatchTriCountsNP(indices, inputsize, s, const_cast<double*>(&data.front()), data.size());
-    return data;
+    std::vector<uint> lidcs(input_size);
+    for (int t = 0; t < input_size; t++)
+    {
+        uint tidx = indices[t];
+        if (tidx >= pTris.size())
+        {
+            std::ostringstream os;
+            os << "Error (Index Overbound): There is no triangle with index " << tidx << ".\n";
+            throw steps::ArgErr(os.str());
+        }
+        ssolver::Patchdef * patch = _triPatchdef(tidx);
+        if (patch == 0)
+        {
+            std::ostringstream os;
+            os << "Triangle " << tidx << " has not been assigned to a patch.\n";
+            throw steps::ArgErr(os.str());
+        }
+        lidcs[t] = spec ? patch->specG2L(gidx) : patch->sreacG2L(gidx);
+        if (lidcs[t] == ssolver::LIDX_UNDEFINED)
+        {
+            std::ostringstream os;
+            os << (spec ? "Species" : "Surface reaction") << " undefined in triangle " << tidx << ".\n";
+            throw steps::ArgErr(os.str());
+        }
+    }
+    return lidcs;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP::getROITetCountsNP(std::string ROI_id, std::string const & s, double* counts, int output_size) const
+std::vector<uint> smtos::TetOpSplitP::_batchRoundCounts(double* counts, int input_size)
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int inputsize = mesh()->getROIDataSize(ROI_id);
-    
-    getBatchTetCountsNP(indices, inputsize, s, counts, output_size);
+    // Rank 0 rounds, as for single elements, and sends all counts at once.
+    std::vector<uint> rounded(input_size, 0);
+    for (int t = 0; t < input_size; t++)
+    {
+        if (counts[t] < 0.0 || counts[t] > std::numeric_limits<unsigned int>::max())
+        {
+            std::ostringstream os;
+            os << "Can't set count less than zero or greater than maximum unsigned integer (";
+            os << std::numeric_limits<unsigned int>::max( ) << ").\n";
+            throw steps::ArgErr(os.str());
+        }
+        if (myRank != 0) continue;
+
+        double n_int = std::floor(counts[t]);
+        double n_frc = counts[t] - n_int;
+        rounded[t] = static_cast<uint>(n_int);
+        if (n_frc > 0.0)
+        {
+            double rand01 = rng()->getUnfIE();
+            if (rand01 < n_frc) rounded[t]++;
+        }
+    }
+    if (input_size != 0) MPI_Bcast(&rounded.front(), input_size, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    return rounded;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP::getROITriCountsNP(std::string ROI_id, std::string const & s, double* counts, int output_size) const
+void smtos::TetOpSplitP::setBatchTetCountsNP(unsigned int* indices, int input_size, std::string const & s, double* counts, int count_size)
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int inputsize = mesh()->getROIDataSize(ROI_id);
-    
-    getBatchTriCountsNP(indices, inputsize, s, counts, output_size);
+    check_batch_sizes(input_size, count_size);
+    uint sgidx = statedef()->getSpecIdx(s);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, true, sgidx);
+    std::vector<uint> rounded = _batchRoundCounts(counts, input_size);
+
+    // Every copy of a tet is set, as by setTetCount()
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet == 0) continue;
+        tet->setCount(lidcs[t], rounded[t]);
+        _updateSpec(tet, sgidx);
+    }
+    _updateSum();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::getROIVol(std::string ROI_id) const
+void smtos::TetOpSplitP::setBatchTriCountsNP(unsigned int* indices, int input_size, std::string const & s, double* counts, int count_size)
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int datasize = mesh()->getROIDataSize(ROI_id);
-    
-    double sum = 0.0;
-    for (uint t = 0; t < datasize; t++) {
-        sum += pTets[indices[t]]->vol();
+    check_batch_sizes(input_size, count_size);
+    uint sgidx = statedef()->getSpecIdx(s);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, true, sgidx);
+    std::vector<uint> rounded = _batchRoundCounts(counts, input_size);
+
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri == 0) continue;
+        tri->setCount(lidcs[t], rounded[t]);
+        _updateSpec(tri, sgidx);
     }
-    return sum;
+    _updateSum();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::getROIArea(std::string ROI_id) const
+void smtos::TetOpSplitP::getBatchTetReacKNP(unsigned int* indices, int input_size, std::string const & r, double* ks, int output_size) const
 {
-    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int datasize = mesh()->getROIDataSize(ROI_id);
-    
-    double sum = 0.0;
-    for (uint t = 0; t < datasize; t++) {
-        sum += pTris[indices[t]]->area();
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, false, statedef()->getReacIdx(r));
+
+    std::vector<double> local(input_size, 0.0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet != 0 && tet->getInHost()) local[t] = tet->reac(lidcs[t])->kcst();
     }
-    return sum;
+    MPI_Allreduce(local.data(), ks, input_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s) const
+void smtos::TetOpSplitP::setBatchTetReacKNP(unsigned int* indices, int input_size, std::string const & r, double* ks, int k_size)
 {
-    steps::tetmesh::ElementType type = mesh()->getROIType(ROI_id);
-    
-    uint *indices = mesh()->_getROIData(ROI_id);
-    int datasize = mesh()->getROIDataSize(ROI_id);
-    double local_sum = 0.0;
-    double global_sum = 0.0;
-    
-    if (type == steps::tetmesh::ELEM_TRI) {
-        bool has_tri_warning = false;
-        bool has_spec_warning = false;
-        std::ostringstream tri_not_assign;
-        std::ostringstream spec_undefined;
-        
-        uint sgidx = statedef()->getSpecIdx(s);
-        
-        for (uint t = 0; t < datasize; t++) {
+    check_batch_sizes(input_size, k_size);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, false, statedef()->getReacIdx(r));
+    for (int t = 0; t < input_size; t++)
+    {
+        if (ks[t] < 0.0)
+        {
+            std::ostringstream os;
+            os << "Negative reaction constant.\n";
+            throw steps::ArgErr(os.str());
+        }
+    }
+
+    // Only the hosts hold kprocs to update
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet == 0 || !tet->getInHost()) continue;
+        tet->reac(lidcs[t])->setKcst(ks[t]);
+        _updateElement(tet->reac(lidcs[t]));
+    }
+    _updateSum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getBatchTetReacActiveNP(unsigned int* indices, int input_size, std::string const & r, unsigned char* actives, int output_size) const
+{
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, false, statedef()->getReacIdx(r));
+
+    std::vector<unsigned char> local(input_size, 0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet != 0 && tet->getInHost()) local[t] = !tet->reac(lidcs[t])->inactive();
+    }
+    MPI_Allreduce(local.data(), actives, input_size, MPI_UNSIGNED_CHAR, MPI_MAX, MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::setBatchTetReacActiveNP(unsigned int* indices, int input_size, std::string const & r, unsigned char* actives, int active_size)
+{
+    check_batch_sizes(input_size, active_size);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, false, statedef()->getReacIdx(r));
+
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet == 0 || !tet->getInHost()) continue;
+        tet->reac(lidcs[t])->setActive(actives[t] != 0);
+        _updateElement(tet->reac(lidcs[t]));
+    }
+    _updateSum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getBatchTetReacANP(unsigned int* indices, int input_size, std::string const & r, double* as, int output_size) const
+{
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTetLidcs(indices, input_size, false, statedef()->getReacIdx(r));
+
+    std::vector<double> local(input_size, 0.0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tet * tet = pTets[indices[t]];
+        if (tet != 0 && tet->getInHost()) local[t] = tet->reac(lidcs[t])->rate();
+    }
+    MPI_Allreduce(local.data(), as, input_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getBatchTriSReacKNP(unsigned int* indices, int input_size, std::string const & sr, double* ks, int output_size) const
+{
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, false, statedef()->getSReacIdx(sr));
+
+    std::vector<double> local(input_size, 0.0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri != 0 && tri->getInHost()) local[t] = tri->sreac(lidcs[t])->kcst();
+    }
+    MPI_Allreduce(local.data(), ks, input_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::setBatchTriSReacKNP(unsigned int* indices, int input_size, std::string const & sr, double* ks, int k_size)
+{
+    check_batch_sizes(input_size, k_size);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, false, statedef()->getSReacIdx(sr));
+    for (int t = 0; t < input_size; t++)
+    {
+        if (ks[t] < 0.0)
+        {
+            std::ostringstream os;
+            os << "Negative reaction constant.\n";
+            throw steps::ArgErr(os.str());
+        }
+    }
+
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri == 0 || !tri->getInHost()) continue;
+        tri->sreac(lidcs[t])->setKcst(ks[t]);
+        _updateElement(tri->sreac(lidcs[t]));
+    }
+    _updateSum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getBatchTriSReacActiveNP(unsigned int* indices, int input_size, std::string const & sr, unsigned char* actives, int output_size) const
+{
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, false, statedef()->getSReacIdx(sr));
+
+    std::vector<unsigned char> local(input_size, 0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri != 0 && tri->getInHost()) local[t] = !tri->sreac(lidcs[t])->inactive();
+    }
+    MPI_Allreduce(local.data(), actives, input_size, MPI_UNSIGNED_CHAR, MPI_MAX, MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::setBatchTriSReacActiveNP(unsigned int* indices, int input_size, std::string const & sr, unsigned char* actives, int active_size)
+{
+    check_batch_sizes(input_size, active_size);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, false, statedef()->getSReacIdx(sr));
+
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri == 0 || !tri->getInHost()) continue;
+        tri->sreac(lidcs[t])->setActive(actives[t] != 0);
+        _updateElement(tri->sreac(lidcs[t]));
+    }
+    _updateSum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getBatchTriSReacANP(unsigned int* indices, int input_size, std::string const & sr, double* as, int output_size) const
+{
+    check_batch_sizes(input_size, output_size);
+    std::vector<uint> lidcs = _batchTriLidcs(indices, input_size, false, statedef()->getSReacIdx(sr));
+
+    std::vector<double> local(input_size, 0.0);
+    for (int t = 0; t < input_size; t++)
+    {
+        smtos::Tri * tri = pTris[indices[t]];
+        if (tri != 0 && tri->getInHost()) local[t] = tri->sreac(lidcs[t])->rate();
+    }
+    MPI_Allreduce(local.data(), as, input_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+// ROI Data Access
+////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<double> smtos::TetOpSplitP::getROITetCounts(std::string ROI_id, std::string const & s) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int inputsize = mesh()->getROIDataSize(ROI_id);
+    std::vector<double> data(inputsize);
+    
+    getBatchTetCountsNP(indices, inputsize, s, const_cast<double*>(&data.front()), data.size());
+    return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<double> smtos::TetOpSplitP::getROITriCounts(std::string ROI_id, std::string const & s) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int inputsize = mesh()->getROIDataSize(ROI_id);
+    std::vector<double> data(inputsize);
+    
+    getBatchTriCountsNP(indices, inputsize, s, const_cast<double*>(&data.front()), data.size());
+    return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getROITetCountsNP(std::string ROI_id, std::string const & s, double* counts, int output_size) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int inputsize = mesh()->getROIDataSize(ROI_id);
+    
+    getBatchTetCountsNP(indices, inputsize, s, counts, output_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getROITriCountsNP(std::string ROI_id, std::string const & s, double* counts, int output_size) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int inputsize = mesh()->getROIDataSize(ROI_id);
+    
+    getBatchTriCountsNP(indices, inputsize, s, counts, output_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double smtos::TetOpSplitP::getROIVol(std::string ROI_id) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TET)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int datasize = mesh()->getROIDataSize(ROI_id);
+    
+    double sum = 0.0;
+    for (uint t = 0; t < datasize; t++) {
+        sum += pMesh->getTetVol(indices[t]);
+    }
+    return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double smtos::TetOpSplitP::getROIArea(std::string ROI_id) const
+{
+    if (!mesh()->checkROI(ROI_id, steps::tetmesh::ELEM_TRI)) throw steps::ArgErr();
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int datasize = mesh()->getROIDataSize(ROI_id);
+    
+    double sum = 0.0;
+    for (uint t = 0; t < datasize; t++) {
+        sum += pMesh->getTriArea(indices[t]);
+    }
+    return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s) const
+{
+    steps::tetmesh::ElementType type = mesh()->getROIType(ROI_id);
+    
+    uint *indices = mesh()->_getROIData(ROI_id);
+    int datasize = mesh()->getROIDataSize(ROI_id);
+    double local_sum = 0.0;
+    double global_sum = 0.0;
+    
+    if (type == steps::tetmesh::ELEM_TRI) {
+        bool has_tri_warning = false;
+        bool has_spec_warning = false;
+        std::ostringstream tri_not_assign;
+        std::ostringstream spec_undefined;
+        
+        uint sgidx = statedef()->getSpecIdx(s);
+        
+        for (uint t = 0; t < datasize; t++) {
             uint tidx = indices[t];
             
             if (tidx >= pTris.size())
@@ -6415,7 +7852,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTris[tidx] == 0)
+            if (_triPatchdef(tidx) == 0)
             {
                 tri_not_assign << tidx << " ";
                 has_tri_warning = true;
@@ -6423,7 +7860,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
             }
             
             smtos::Tri * tri = pTris[tidx];
-            uint slidx = tri->patchdef()->specG2L(sgidx);
+            uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
@@ -6432,7 +7869,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
             }
             
             // compute local sum for each process
-            if (tri->getInHost()) local_sum += tri->pools()[slidx];
+            if (tri != 0 && tri->getInHost()) local_sum += tri->pools()[slidx];
         }
         
         // gather global sum
@@ -6467,7 +7904,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTets[tidx] == 0)
+            if (_tetCompdef(tidx) == 0)
             {
                 tet_not_assign << tidx << " ";
                 has_tet_warning = true;
@@ -6475,7 +7912,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
             }
             
             smtos::Tet * tet = pTets[tidx];
-            uint slidx = tet->compdef()->specG2L(sgidx);
+            uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
@@ -6484,7 +7921,7 @@ double smtos::TetOpSplitP::getROICount(std::string ROI_id, std::string const & s
             }
             
             // compute local sum for each process
-            if (tet->getInHost()) local_sum += tet->pools()[slidx];
+            if (tet != 0 && tet->getInHost()) local_sum += tet->pools()[slidx];
         }
         
         // gather global sum
@@ -6550,15 +7987,14 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTris[tidx] == 0)
+            if (_triPatchdef(tidx) == 0)
             {
                 tri_not_assign << tidx << " ";
                 has_tri_warning = true;
                 continue;
             }
             
-            smtos::Tri * tri = pTris[tidx];
-            uint slidx = tri->patchdef()->specG2L(sgidx);
+            uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
@@ -6567,7 +8003,7 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
             }
             
             apply_indices.push_back(tidx);
-            totalarea += tri->area();
+            totalarea += pMesh->getTriArea(tidx);
         }
         
         if (has_tri_warning) {
@@ -6592,11 +8028,10 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
             for (uint t = 0; t < ind_size; t++)
             {
                 uint tidx = apply_indices[t];
-                smtos::Tri * tri = pTris[tidx];
                 
                 if ((count == 0.0) || (nremoved == c)) break;
                 
-                double fract = static_cast<double>(c) * (tri->area() / totalarea);
+                double fract = static_cast<double>(c) * (pMesh->getTriArea(tidx) / totalarea);
                 uint n3 = static_cast<uint>(std::floor(fract));
                 
                 double n3_frac = fract - static_cast<double>(n3);
@@ -6625,8 +8060,7 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
                 for (uint t = 0; t < ind_size; t++)
                 {
                     uint tidx = apply_indices[t];
-                    smtos::Tri * tri = pTris[tidx];
-                    accum += tri->area();
+                    accum += pMesh->getTriArea(tidx);
                     if (selector < accum) {
                         apply_count[t] += 1.0;
                         break;
@@ -6643,8 +8077,9 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
         {
             uint tidx = apply_indices[t];
             smtos::Tri * tri = pTris[tidx];
+            if (tri == 0) continue;
             
-            uint slidx = tri->patchdef()->specG2L(sgidx);
+            uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
             tri->setCount(slidx, apply_count[t]);
             _updateSpec(tri, slidx);
         }
@@ -6669,15 +8104,14 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTets[tidx] == 0)
+            if (_tetCompdef(tidx) == 0)
             {
                 tet_not_assign << tidx << " ";
                 has_tet_warning = true;
                 continue;
             }
             
-            smtos::Tet * tet = pTets[tidx];
-            uint slidx = tet->compdef()->specG2L(sgidx);
+            uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
@@ -6686,7 +8120,7 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
             }
             
             apply_indices.push_back(tidx);
-            totalvol += tet->vol();
+            totalvol += pMesh->getTetVol(tidx);
         }
         
         if (has_tet_warning) {
@@ -6711,11 +8145,10 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
             for (uint t = 0; t < ind_size; t++)
             {
                 uint tidx = apply_indices[t];
-                smtos::Tet * tet = pTets[tidx];
                 
                 if ((count == 0.0) || (nremoved == c)) break;
                 
-                double fract = static_cast<double>(c) * (tet->vol() / totalvol);
+                double fract = static_cast<double>(c) * (pMesh->getTetVol(tidx) / totalvol);
                 uint n3 = static_cast<uint>(std::floor(fract));
                 
                 double n3_frac = fract - static_cast<double>(n3);
@@ -6744,8 +8177,7 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
                 for (uint t = 0; t < ind_size; t++)
                 {
                     uint tidx = apply_indices[t];
-                    smtos::Tet * tet = pTets[tidx];
-                    accum += tet->vol();
+                    accum += pMesh->getTetVol(tidx);
                     if (selector < accum) {
                         apply_count[t] += 1.0;
                         break;
@@ -6762,7 +8194,8 @@ void smtos::TetOpSplitP::setROICount(std::string ROI_id, std::string const & s,
         {
             uint tidx = apply_indices[t];
             smtos::Tet * tet = pTets[tidx];
-            uint slidx = tet->compdef()->specG2L(sgidx);
+            if (tet == 0) continue;
+            uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
             tet->setCount(slidx, apply_count[t]);
             _updateSpec(tet, slidx);
         }
@@ -6821,15 +8254,14 @@ void smtos::TetOpSplitP::setROIConc(std::string ROI_id, std::string const & s, d
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
             continue;
         }
         
-        smtos::Tet * tet = pTets[tidx];
-        uint slidx = tet->compdef()->specG2L(sgidx);
+        uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
         if (slidx == ssolver::LIDX_UNDEFINED)
         {
             spec_undefined << tidx << " ";
@@ -6838,7 +8270,7 @@ void smtos::TetOpSplitP::setROIConc(std::string ROI_id, std::string const & s, d
         }
         
         apply_indices.push_back(tidx);
-        totalvol += tet->vol();
+        totalvol += pMesh->getTetVol(tidx);
     }
     
     if (has_tet_warning) {
@@ -6893,7 +8325,7 @@ void smtos::TetOpSplitP::setROIClamped(std::string ROI_id, std::string const & s
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTris[tidx] == 0)
+            if (_triPatchdef(tidx) == 0)
             {
                 tri_not_assign << tidx << " ";
                 has_tri_warning = true;
@@ -6901,14 +8333,14 @@ void smtos::TetOpSplitP::setROIClamped(std::string ROI_id, std::string const & s
             }
             
             smtos::Tri * tri = pTris[tidx];
-            uint slidx = tri->patchdef()->specG2L(sgidx);
+            uint slidx = _triPatchdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
                 has_spec_warning = true;
                 continue;
             }
-            if (tri->getInHost()) tri->setClamped(slidx, b);
+            if (tri != 0 && tri->getInHost()) tri->setClamped(slidx, b);
         }
         
         if (has_tri_warning) {
@@ -6939,7 +8371,7 @@ void smtos::TetOpSplitP::setROIClamped(std::string ROI_id, std::string const & s
                 throw steps::ArgErr(os.str());
             }
             
-            if (pTets[tidx] == 0)
+            if (_tetCompdef(tidx) == 0)
             {
                 tet_not_assign << tidx << " ";
                 has_tet_warning = true;
@@ -6947,7 +8379,7 @@ void smtos::TetOpSplitP::setROIClamped(std::string ROI_id, std::string const & s
             }
             
             smtos::Tet * tet = pTets[tidx];
-            uint slidx = tet->compdef()->specG2L(sgidx);
+            uint slidx = _tetCompdef(tidx)->specG2L(sgidx);
             if (slidx == ssolver::LIDX_UNDEFINED)
             {
                 spec_undefined << tidx << " ";
@@ -6955,7 +8387,7 @@ void smtos::TetOpSplitP::setROIClamped(std::string ROI_id, std::string const & s
                 continue;
             }
             
-            if (tet->getInHost()) tet->setClamped(slidx, b);
+            if (tet != 0 && tet->getInHost()) tet->setClamped(slidx, b);
         }
         
         if (has_tet_warning) {
@@ -7001,7 +8433,7 @@ void smtos::TetOpSplitP::setROIReacK(std::string ROI_id, std::string const & r,
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7009,7 +8441,7 @@ void smtos::TetOpSplitP::setROIReacK(std::string ROI_id, std::string const & r,
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint rlidx = tet->compdef()->reacG2L(rgidx);
+        uint rlidx = _tetCompdef(tidx)->reacG2L(rgidx);
         if (rlidx == ssolver::LIDX_UNDEFINED)
         {
             reac_undefined << tidx << " ";
@@ -7017,7 +8449,7 @@ void smtos::TetOpSplitP::setROIReacK(std::string ROI_id, std::string const & r,
             continue;
         }
         
-        if (tet->getInHost()) tet->reac(rlidx)->setKcst(kf);
+        if (tet != 0 && tet->getInHost()) tet->reac(rlidx)->setKcst(kf);
     }
     
     if (has_tet_warning) {
@@ -7059,7 +8491,7 @@ void smtos::TetOpSplitP::setROISReacK(std::string ROI_id, std::string const & sr
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -7067,7 +8499,7 @@ void smtos::TetOpSplitP::setROISReacK(std::string ROI_id, std::string const & sr
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint srlidx = tri->patchdef()->sreacG2L(srgidx);
+        uint srlidx = _triPatchdef(tidx)->sreacG2L(srgidx);
         if (srlidx == ssolver::LIDX_UNDEFINED)
         {
             sreac_undefined << tidx << " ";
@@ -7075,7 +8507,7 @@ void smtos::TetOpSplitP::setROISReacK(std::string ROI_id, std::string const & sr
             continue;
         }
         
-        if (tri->getInHost()) tri->sreac(srlidx)->setKcst(kf);
+        if (tri != 0 && tri->getInHost()) tri->sreac(srlidx)->setKcst(kf);
     }
     
     if (has_tri_warning) {
@@ -7117,7 +8549,7 @@ void smtos::TetOpSplitP::setROIDiffD(std::string ROI_id, std::string const & d,
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7125,7 +8557,7 @@ void smtos::TetOpSplitP::setROIDiffD(std::string ROI_id, std::string const & d,
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint dlidx = tet->compdef()->diffG2L(dgidx);
+        uint dlidx = _tetCompdef(tidx)->diffG2L(dgidx);
         if (dlidx == ssolver::LIDX_UNDEFINED)
         {
             diff_undefined << tidx << " ";
@@ -7133,7 +8565,7 @@ void smtos::TetOpSplitP::setROIDiffD(std::string ROI_id, std::string const & d,
             continue;
         }
         
-        if (tet->getInHost()) tet->diff(dlidx)->setDcst(dk);
+        if (tet != 0 && tet->getInHost()) tet->diff(dlidx)->setDcst(dk);
     }
     
     if (has_tet_warning) {
@@ -7177,7 +8609,7 @@ void smtos::TetOpSplitP::setROIReacActive(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7185,7 +8617,7 @@ void smtos::TetOpSplitP::setROIReacActive(std::string ROI_id, std::string const
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint rlidx = tet->compdef()->reacG2L(rgidx);
+        uint rlidx = _tetCompdef(tidx)->reacG2L(rgidx);
         if (rlidx == ssolver::LIDX_UNDEFINED)
         {
             reac_undefined << tidx << " ";
@@ -7193,7 +8625,7 @@ void smtos::TetOpSplitP::setROIReacActive(std::string ROI_id, std::string const
             continue;
         }
         
-        if (tet->getInHost()) tet->reac(rlidx)->setActive(a);
+        if (tet != 0 && tet->getInHost()) tet->reac(rlidx)->setActive(a);
     }
     
     if (has_tet_warning) {
@@ -7235,7 +8667,7 @@ void smtos::TetOpSplitP::setROISReacActive(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -7243,7 +8675,7 @@ void smtos::TetOpSplitP::setROISReacActive(std::string ROI_id, std::string const
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint srlidx = tri->patchdef()->sreacG2L(srgidx);
+        uint srlidx = _triPatchdef(tidx)->sreacG2L(srgidx);
         if (srlidx == ssolver::LIDX_UNDEFINED)
         {
             sreac_undefined << tidx << " ";
@@ -7251,7 +8683,7 @@ void smtos::TetOpSplitP::setROISReacActive(std::string ROI_id, std::string const
             continue;
         }
         
-        if (tri->getInHost()) tri->sreac(srlidx)->setActive(a);
+        if (tri != 0 && tri->getInHost()) tri->sreac(srlidx)->setActive(a);
     }
     
     if (has_tri_warning) {
@@ -7293,7 +8725,7 @@ void smtos::TetOpSplitP::setROIDiffActive(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7301,7 +8733,7 @@ void smtos::TetOpSplitP::setROIDiffActive(std::string ROI_id, std::string const
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint dlidx = tet->compdef()->diffG2L(dgidx);
+        uint dlidx = _tetCompdef(tidx)->diffG2L(dgidx);
         if (dlidx == ssolver::LIDX_UNDEFINED)
         {
             diff_undefined << tidx << " ";
@@ -7309,7 +8741,7 @@ void smtos::TetOpSplitP::setROIDiffActive(std::string ROI_id, std::string const
             continue;
         }
         
-        if (tet->getInHost()) tet->diff(dlidx)->setActive(a);
+        if (tet != 0 && tet->getInHost()) tet->diff(dlidx)->setActive(a);
     }
     
     if (has_tet_warning) {
@@ -7353,7 +8785,7 @@ void smtos::TetOpSplitP::setROIVDepSReacActive(std::string ROI_id, std::string c
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -7361,7 +8793,7 @@ void smtos::TetOpSplitP::setROIVDepSReacActive(std::string ROI_id, std::string c
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint vsrlidx = tri->patchdef()->vdepsreacG2L(vsrgidx);
+        uint vsrlidx = _triPatchdef(tidx)->vdepsreacG2L(vsrgidx);
         if (vsrlidx == ssolver::LIDX_UNDEFINED)
         {
             vsreac_undefined << tidx << " ";
@@ -7369,7 +8801,7 @@ void smtos::TetOpSplitP::setROIVDepSReacActive(std::string ROI_id, std::string c
             continue;
         }
         
-        if (tri->getInHost()) tri->vdepsreac(vsrlidx)->setActive(a);
+        if (tri != 0 && tri->getInHost()) tri->vdepsreac(vsrlidx)->setActive(a);
     }
     
     if (has_tri_warning) {
@@ -7416,7 +8848,7 @@ uint smtos::TetOpSplitP::getROIReacExtent(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7424,7 +8856,7 @@ uint smtos::TetOpSplitP::getROIReacExtent(std::string ROI_id, std::string const
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint rlidx = tet->compdef()->reacG2L(rgidx);
+        uint rlidx = _tetCompdef(tidx)->reacG2L(rgidx);
         if (rlidx == ssolver::LIDX_UNDEFINED)
         {
             reac_undefined << tidx << " ";
@@ -7478,7 +8910,7 @@ void smtos::TetOpSplitP::resetROIReacExtent(std::string ROI_id, std::string cons
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7486,7 +8918,7 @@ void smtos::TetOpSplitP::resetROIReacExtent(std::string ROI_id, std::string cons
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint rlidx = tet->compdef()->reacG2L(rgidx);
+        uint rlidx = _tetCompdef(tidx)->reacG2L(rgidx);
         if (rlidx == ssolver::LIDX_UNDEFINED)
         {
             reac_undefined << tidx << " ";
@@ -7540,7 +8972,7 @@ uint smtos::TetOpSplitP::getROISReacExtent(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -7548,7 +8980,7 @@ uint smtos::TetOpSplitP::getROISReacExtent(std::string ROI_id, std::string const
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint srlidx = tri->patchdef()->sreacG2L(srgidx);
+        uint srlidx = _triPatchdef(tidx)->sreacG2L(srgidx);
         if (srlidx == ssolver::LIDX_UNDEFINED)
         {
             sreac_undefined << tidx << " ";
@@ -7602,7 +9034,7 @@ void smtos::TetOpSplitP::resetROISReacExtent(std::string ROI_id, std::string con
             throw steps::ArgErr(os.str());
         }
         
-        if (pTris[tidx] == 0)
+        if (_triPatchdef(tidx) == 0)
         {
             tri_not_assign << tidx << " ";
             has_tri_warning = true;
@@ -7610,7 +9042,7 @@ void smtos::TetOpSplitP::resetROISReacExtent(std::string ROI_id, std::string con
         }
         
         smtos::Tri * tri = pTris[tidx];
-        uint srlidx = tri->patchdef()->sreacG2L(srgidx);
+        uint srlidx = _triPatchdef(tidx)->sreacG2L(srgidx);
         if (srlidx == ssolver::LIDX_UNDEFINED)
         {
             sreac_undefined << tidx << " ";
@@ -7664,7 +9096,7 @@ uint smtos::TetOpSplitP::getROIDiffExtent(std::string ROI_id, std::string const
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7672,7 +9104,7 @@ uint smtos::TetOpSplitP::getROIDiffExtent(std::string ROI_id, std::string const
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint dlidx = tet->compdef()->diffG2L(dgidx);
+        uint dlidx = _tetCompdef(tidx)->diffG2L(dgidx);
         if (dlidx == ssolver::LIDX_UNDEFINED)
         {
             diff_undefined << tidx << " ";
@@ -7726,7 +9158,7 @@ void smtos::TetOpSplitP::resetROIDiffExtent(std::string ROI_id, std::string cons
             throw steps::ArgErr(os.str());
         }
         
-        if (pTets[tidx] == 0)
+        if (_tetCompdef(tidx) == 0)
         {
             tet_not_assign << tidx << " ";
             has_tet_warning = true;
@@ -7734,7 +9166,7 @@ void smtos::TetOpSplitP::resetROIDiffExtent(std::string ROI_id, std::string cons
         }
         
         smtos::Tet * tet = pTets[tidx];
-        uint dlidx = tet->compdef()->diffG2L(dgidx);
+        uint dlidx = _tetCompdef(tidx)->diffG2L(dgidx);
         if (dlidx == ssolver::LIDX_UNDEFINED)
         {
             diff_undefined << tidx << " ";
@@ -7779,6 +9211,31 @@ uint smtos::TetOpSplitP::getWMVolHostRank(uint idx)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool smtos::TetOpSplitP::getDistributedElems(void) const
+{
+    return pDistElems;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::countLocalTets(void) const
+{
+    uint n = 0;
+    for (auto t: pTets) if (t != 0) ++n;
+    return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::countLocalTris(void) const
+{
+    uint n = 0;
+    for (auto t: pTris) if (t != 0) ++n;
+    return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::TetOpSplitP::_updateLocal(uint* upd_entries, uint buffer_size) {
     for (uint i = 0; i < buffer_size; i++) {
         if (pKProcs[upd_entries[i]] != NULL)
@@ -7847,33 +9304,10 @@ void smtos::TetOpSplitP::registerBoundaryTri(smtos::Tri* tri)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-uint smtos::TetOpSplitP::registerRemoteMoleculeChange(int svol_host, uint loc, SubVolType svol_type, uint idx, uint slidx, uint change)
+void smtos::TetOpSplitP::registerRemoteMoleculeChange(int svol_host, uint loc, uint change)
 {
-    uint new_loc = remoteChanges[svol_host].size();
-
-    if (new_loc == 0 || new_loc - 4 < loc) {
-        remoteChanges[svol_host].push_back(svol_type);
-        remoteChanges[svol_host].push_back(idx);
-        remoteChanges[svol_host].push_back(slidx);
-        remoteChanges[svol_host].push_back(change);
-    }
-    else {
-        uint stored_type = remoteChanges[svol_host][loc];
-        uint stored_idx = remoteChanges[svol_host][loc + 1];
-        uint stored_slidx = remoteChanges[svol_host][loc + 2];
-
-        if (stored_type == svol_type && stored_idx ==idx && stored_slidx == slidx) {
-            remoteChanges[svol_host][loc + 3] += change;
-            new_loc = loc;
-        }
-        else {
-            remoteChanges[svol_host].push_back(svol_type);
-            remoteChanges[svol_host].push_back(idx);
-            remoteChanges[svol_host].push_back(slidx);
-            remoteChanges[svol_host].push_back(change);
-        }
-    }
-    return new_loc;
+    assert(loc < remoteChanges[svol_host].size());
+    remoteChanges[svol_host][loc] += change;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -7910,102 +9344,273 @@ void smtos::TetOpSplitP::registerSyncTri(smtos::Tri * tri)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::TetOpSplitP:: _remoteSyncAndUpdate(void* requests, std::vector<KProc*> & applied_diffs, std::vector<int> & directions)
+void smtos::TetOpSplitP::_setupDiffComm(void)
 {
-    #ifdef MPI_DEBUG
-    CLOG(DEBUG, "mpi_debug") << "Start applying molecule changes.\n";
-    #endif
-    
-    #ifdef MPI_PROFILING
-    double starttime = MPI_Wtime();
-    #endif
-    
-    #ifdef MPI_DEBUG
-    CLOG(DEBUG, "mpi_debug") << "change buffer:" << remoteChanges;
-    #endif
-    
-    MPI_Request* requestsPtr = static_cast<MPI_Request*>(requests);
-    
-    uint request_count = 0;
-    for (auto dest : neighbHosts) {
-#ifdef MPI_DEBUG
-        CLOG(DEBUG, "mpi_debug") << "request pointer:" << &(requestsPtr[request_count]);
-#endif
-        MPI_Isend(&remoteChanges[dest].front(), remoteChanges[dest].size(), MPI_UNSIGNED, dest, OPSPLIT_MOLECULE_CHANGE, MPI_COMM_WORLD, &(requestsPtr[request_count]));
-        request_count ++;
+    _freeDiffComm();
+
+    // Diffusions of tets and tris with a neighbour on another rank first,
+    // keeping the order within both groups
+    auto bnd_tet = [this](Diff * d) {
+        for (uint i = 0; i < 4; ++i)
+        {
+            smtos::Tet * next = d->getTet()->nextTet(i);
+            if (next != 0 && next->getHost() != myRank) return true;
+        }
+        return false;
+    };
+    auto bnd_tri = [this](SDiff * d) {
+        for (uint i = 0; i < 3; ++i)
+        {
+            smtos::Tri * next = d->getTri()->nextTri(i);
+            if (next != 0 && next->getHost() != myRank) return true;
+        }
+        return false;
+    };
+    diffBndSep = std::stable_partition(pDiffs.begin(), pDiffs.end(), bnd_tet) - pDiffs.begin();
+    sdiffBndSep = std::stable_partition(pSDiffs.begin(), pSDiffs.end(), bnd_tri) - pSDiffs.begin();
+    for (uint pos = 0; pos < pDiffs.size(); ++pos) pDiffs[pos]->crData.pos = pos;
+    for (uint pos = 0; pos < pSDiffs.size(); ++pos) pSDiffs[pos]->crData.pos = pos;
+
+    // the update period levels are sorted again within both groups
+    recomputeUpdPeriod = true;
+
+    remoteChanges.clear();
+    if (nNeighbHosts == 0) return;
+
+    // Every element next to one hosted here but hosted on another rank
+    // gets slots in the change buffer for that rank.
+    std::map<int, std::set<uint> > send_tets;
+    std::map<int, std::set<uint> > send_tris;
+    for (auto t: pTets)
+    {
+        if (t == 0 || !t->getInHost()) continue;
+        for (uint i = 0; i < 4; ++i)
+        {
+            smtos::Tet * next = t->nextTet(i);
+            if (next != 0 && next->getHost() != myRank) send_tets[next->getHost()].insert(next->idx());
+        }
     }
+    for (auto t: pTris)
+    {
+        if (t == 0 || !t->getInHost()) continue;
+        for (uint i = 0; i < 3; ++i)
+        {
+            smtos::Tri * next = t->nextTri(i);
+            if (next != 0 && next->getHost() != myRank) send_tris[next->getHost()].insert(next->idx());
+        }
+    }
+
+    // Tell each neighbour which of its elements the slots belong to as
+    // [ntets, tets..., ntris, tris...]
+    std::vector<std::vector<uint> > send_elems(nNeighbHosts);
+    std::vector<std::vector<uint> > recv_elems(nNeighbHosts);
+    std::vector<uint> send_size(nNeighbHosts, 0);
+    std::vector<uint> recv_size(nNeighbHosts, 0);
+    std::vector<MPI_Request> requests(2 * nNeighbHosts);
+    uint n = 0;
+    for (auto neighbor : neighbHosts)
+    {
+        std::vector<uint> & elems = send_elems[n];
+        uint nslots = 0;
+        elems.push_back(send_tets[neighbor].size());
+        for (auto t: send_tets[neighbor])
+        {
+            elems.push_back(t);
+            pTets[t]->setupBufferLocations(nslots);
+            nslots += pTets[t]->compdef()->countSpecs();
+        }
+        elems.push_back(send_tris[neighbor].size());
+        for (auto t: send_tris[neighbor])
+        {
+            elems.push_back(t);
+            pTris[t]->setupBufferLocations(nslots);
+            nslots += pTris[t]->patchdef()->countSpecs();
+        }
+        remoteChanges[neighbor].assign(nslots, 0);
+        send_size[n] = elems.size();
+
+        MPI_Irecv(&recv_size[n], 1, MPI_UNSIGNED, neighbor, OPSPLIT_MOLECULE_CHANGE_SIZE, MPI_COMM_WORLD, &requests[n]);
+        MPI_Isend(&send_size[n], 1, MPI_UNSIGNED, neighbor, OPSPLIT_MOLECULE_CHANGE_SIZE, MPI_COMM_WORLD, &requests[nNeighbHosts + n]);
+        ++n;
+    }
+    MPI_Waitall(2 * nNeighbHosts, &requests.front(), MPI_STATUSES_IGNORE);
+
+    n = 0;
+    for (auto neighbor : neighbHosts)
+    {
+        recv_elems[n].resize(recv_size[n]);
+        MPI_Irecv(&recv_elems[n].front(), recv_size[n], MPI_UNSIGNED, neighbor, OPSPLIT_MOLECULE_CHANGE_SLOTS, MPI_COMM_WORLD, &requests[n]);
+        MPI_Isend(&send_elems[n].front(), send_size[n], MPI_UNSIGNED, neighbor, OPSPLIT_MOLECULE_CHANGE_SLOTS, MPI_COMM_WORLD, &requests[nNeighbHosts + n]);
+        ++n;
+    }
+    MPI_Waitall(2 * nNeighbHosts, &requests.front(), MPI_STATUSES_IGNORE);
+
+    sendChanges.resize(nNeighbHosts);
+    recvSlots.resize(nNeighbHosts);
+    recvChanges.resize(nNeighbHosts);
+    MPI_Request * recv_requests = new MPI_Request[nNeighbHosts];
+    n = 0;
+    for (auto neighbor : neighbHosts)
+    {
+        std::vector<uint> const & elems = recv_elems[n];
+        std::vector<RemoteSlot> & slots = recvSlots[n];
+        uint e = 0;
+        for (uint ntets = elems[e++]; ntets != 0; --ntets)
+        {
+            smtos::Tet * tet = pTets[elems[e++]];
+            assert(tet != 0 && tet->getInHost());
+            for (uint l = 0; l < tet->compdef()->countSpecs(); ++l)
+            {
+                RemoteSlot slot = {tet, 0, l};
+                slots.push_back(slot);
+            }
+        }
+        for (uint ntris = elems[e++]; ntris != 0; --ntris)
+        {
+            smtos::Tri * tri = pTris[elems[e++]];
+            assert(tri != 0 && tri->getInHost());
+            for (uint l = 0; l < tri->patchdef()->countSpecs(); ++l)
+            {
+                RemoteSlot slot = {0, tri, l};
+                slots.push_back(slot);
+            }
+        }
+
+        // the raw encoding is the longest one sent
+        uint max_size = 1 + slots.size() * sizeof(uint);
+        recvChanges[n].resize(max_size);
+        MPI_Recv_init(&recvChanges[n].front(), max_size, MPI_UNSIGNED_CHAR, neighbor,
+                      OPSPLIT_MOLECULE_CHANGE, MPI_COMM_WORLD, &recv_requests[n]);
+        ++n;
+    }
+    pRecvRequests = recv_requests;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_freeDiffComm(void)
+{
+    MPI_Request * recv_requests = static_cast<MPI_Request*>(pRecvRequests);
+    if (recv_requests == 0) return;
+    // the solver may outlive MPI, e.g. when destroyed at interpreter exit
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    for (uint n = 0; !finalized && n < recvChanges.size(); ++n) MPI_Request_free(&recv_requests[n]);
+    delete[] recv_requests;
+    pRecvRequests = 0;
+    sendChanges.clear();
+    recvSlots.clear();
+    recvChanges.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_sendRemoteChanges(void* requests)
+{
+    #ifdef MPI_PROFILING
+    double starttime = MPI_Wtime();
+    #endif
+    
+    #ifdef MPI_DEBUG
+    CLOG(DEBUG, "mpi_debug") << "change buffer:" << remoteChanges;
+    #endif
     
-    uint remain_comfirm = nNeighbHosts;
-    MPI_Status status;
-    std::set<KProc*> upd_kprocs;
-    
-    std::set<int> await_neighbors(neighbHosts);
+    MPI_Request* requestsPtr = static_cast<MPI_Request*>(requests);
     
+    uint request_count = 0;
+    for (auto dest : neighbHosts) {
+#ifdef MPI_DEBUG
+        CLOG(DEBUG, "mpi_debug") << "request pointer:" << &(requestsPtr[request_count]);
+#endif
+        std::vector<unsigned char> & buf = sendChanges[request_count];
+        encodeRemoteChanges(remoteChanges[dest], buf);
+        MPI_Isend(&buf.front(), buf.size(), MPI_UNSIGNED_CHAR, dest, OPSPLIT_MOLECULE_CHANGE, MPI_COMM_WORLD, &(requestsPtr[request_count]));
+        request_count ++;
+    }
+
     #ifdef MPI_PROFILING
     double endtime = MPI_Wtime();
     syncTime += (endtime - starttime);
     #endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP:: _remoteSyncAndUpdate(std::vector<KProc*> & applied_diffs, std::vector<int> & directions,
+                                                bool exchanged)
+{
+    #ifdef MPI_DEBUG
+    CLOG(DEBUG, "mpi_debug") << "Start applying molecule changes.\n";
+    #endif
+    
+    #ifdef MPI_PROFILING
+    double starttime = MPI_Wtime();
+    #endif
     
-    while (!await_neighbors.empty()) {
+    // Update the kprocs affected by local diffusion while the changes of
+    // the neighbouring ranks are still on their way
+    uint napply = applied_diffs.size();
+    for (uint i = 0; i < napply; i++) {
+        KProc* kp = applied_diffs[i];
+        int direction = directions[i];
+
+        double start = (pProfile != 0) ? ssolver::KProcProfile::now() : 0.0;
+
+        std::vector<smtos::KProc*> const & local_upd = kp->getLocalUpdVec(direction);
+
+        for (auto & upd_kp : local_upd) {
+            _updateElement(upd_kp);
+        }
+
+        if (pProfile != 0)
+            pProfile->recordUpdates(kp->schedIDX(), local_upd.size(), ssolver::KProcProfile::now() - start);
+    }
+    
+    #ifdef MPI_PROFILING
+    double endtime = MPI_Wtime();
+    compTime += (endtime - starttime);
+    #endif
+    
+    MPI_Request * recv_requests = static_cast<MPI_Request*>(pRecvRequests);
+    MPI_Status status;
+    std::set<KProc*> upd_kprocs;
+    
+    for (uint remain = exchanged ? nNeighbHosts : 0; remain != 0; --remain) {
         #ifdef MPI_PROFILING
         starttime = MPI_Wtime();
         #endif
-        int flag = 0;
-        int data_source = 0;
-        for (auto neighbor : await_neighbors) {
-            MPI_Iprobe(neighbor, OPSPLIT_MOLECULE_CHANGE, MPI_COMM_WORLD, &flag, &status);
-            if (flag) {
-                data_source = neighbor;
-                break;
-            }
-        }
+        int n = MPI_UNDEFINED;
+        MPI_Waitany(nNeighbHosts, recv_requests, &n, &status);
         #ifdef MPI_PROFILING
         endtime = MPI_Wtime();
         idleTime += (endtime - starttime);
-        #endif
-        if (!flag) continue;
-
-        #ifdef MPI_PROFILING
         starttime = MPI_Wtime();
         #endif
-        // receive data
+
         int change_size = 0;
-        MPI_Get_count(&status, MPI_UNSIGNED, &change_size);
-        std::vector<uint> changes(change_size);
-        MPI_Recv(&changes.front(), change_size, MPI_UNSIGNED, status.MPI_SOURCE, OPSPLIT_MOLECULE_CHANGE, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Get_count(&status, MPI_UNSIGNED_CHAR, &change_size);
+        std::vector<RemoteSlot> const & slots = recvSlots[n];
 
         #ifdef MPI_DEBUG
-        CLOG(DEBUG, "mpi_debug") << "Recving change "<< changes << " from " << status.MPI_SOURCE << ".\n";
+        CLOG(DEBUG, "mpi_debug") << "Recving " << change_size << " bytes of changes from " << status.MPI_SOURCE << ".\n";
         #endif
         
         // apply changes
-        uint nchanges = change_size / 4;
-        for (uint c = 0; c < nchanges; c++) {
-            uint type = changes[c * 4];
-            uint idx = changes[c * 4 + 1];
-            uint slidx = changes[c * 4 + 2];
-            uint value = changes[c * 4 + 3];
-            
-            #ifdef MPI_DEBUG
-            CLOG(DEBUG, "mpi_debug") << "unpack: idx "<< idx << " slidx " << slidx << " value " << value << ".\n";
-            #endif
-            
-            if (type == SUB_WM) {
-                pWmVols[idx]->incCount(slidx, value);
-            }
-            if (type == SUB_TET) {
-                pTets[idx]->incCount(slidx, value);
-                std::vector<smtos::KProc*> const & remote_upd = pTets[idx]->getSpecUpdKProcs(slidx);
+        auto apply = [&upd_kprocs, &slots](uint s, uint value) {
+            RemoteSlot const & slot = slots[s];
+            if (slot.tet != 0) {
+                slot.tet->incCount(slot.slidx, value);
+                std::vector<smtos::KProc*> const & remote_upd = slot.tet->getSpecUpdKProcs(slot.slidx);
                 upd_kprocs.insert(remote_upd.begin(), remote_upd.end());
             }
-            if (type == SUB_TRI) {
-                pTris[idx]->incCount(slidx, value);
-                std::vector<smtos::KProc*> const & remote_upd = pTris[idx]->getSpecUpdKProcs(slidx);
+            else {
+                slot.tri->incCount(slot.slidx, value);
+                std::vector<smtos::KProc*> const & remote_upd = slot.tri->getSpecUpdKProcs(slot.slidx);
                 upd_kprocs.insert(remote_upd.begin(), remote_upd.end());
             }
-        }
+        };
+        smtos::decodeRemoteChanges(&recvChanges[n].front(), change_size, slots.size(), apply);
         
-        await_neighbors.erase(data_source);
         #ifdef MPI_PROFILING
         endtime = MPI_Wtime();
         syncTime += (endtime - starttime);
@@ -8020,18 +9625,6 @@ void smtos::TetOpSplitP:: _remoteSyncAndUpdate(void* requests, std::vector<KProc
     CLOG(DEBUG, "mpi_debug") << "Molecule changes have been applied.\n";
     #endif
     
-    uint napply = applied_diffs.size();
-    for (uint i = 0; i < napply; i++) {
-        KProc* kp = applied_diffs[i];
-        int direction = directions[i];
-
-        std::vector<smtos::KProc*> const & local_upd = kp->getLocalUpdVec(direction);
-
-        for (auto & upd_kp : local_upd) {
-            _updateElement(upd_kp);
-        }
-    }
-    
     // update kprocs caused by remote molecule changes
     for (auto & upd_kp : upd_kprocs) {
         _updateElement(upd_kp);
@@ -8053,6 +9646,30 @@ void smtos::TetOpSplitP:: _remoteSyncAndUpdate(void* requests, std::vector<KProc
 void smtos::TetOpSplitP::repartitionAndReset(std::vector<uint> const &tet_hosts,
                  std::map<uint, uint> const &tri_hosts,
                  std::vector<uint> const &wm_hosts)
+{
+    if (pDistElems)
+    {
+        std::ostringstream os;
+        os << "Repartitioning is not supported when elements are distributed.";
+        throw steps::NotImplErr(os.str());
+    }
+
+    if (efflag() == true) {
+        std::ostringstream os;
+        os << "Repartition of EField is not implemented:\n";
+        throw steps::ArgErr(os.str());
+    }
+
+    _repartition(tet_hosts, tri_hosts, wm_hosts);
+    reset();
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_repartition(std::vector<uint> const &tet_hosts,
+                                      std::map<uint, uint> const &tri_hosts,
+                                      std::vector<uint> const &wm_hosts)
 {
     pKProcs.clear();
     pDiffs.clear();
@@ -8109,34 +9726,349 @@ void smtos::TetOpSplitP::repartitionAndReset(std::vector<uint> const &tet_hosts,
     // only patch triangles are filled
     for (auto t: pTris)
     if (t && t->getInHost()) t->setupDeps();
-
-    for (auto tet : boundaryTets) {
-        tet->setupBufferLocations();
-    }
-    for (auto tri : boundaryTris) {
-        tri->setupBufferLocations();
-    }
-    
-    if (efflag() == true) {
-        std::ostringstream os;
-        os << "Repartition of EField is not implemented:\n";
-        throw steps::ArgErr(os.str());
-    }
     
     neighbHosts.erase(myRank);
     nNeighbHosts = neighbHosts.size();
     
-    // construct remote molecule change buffers
-    remoteChanges.clear();
-    for (auto neighbor : neighbHosts) {
-        remoteChanges[neighbor] = std::vector<uint> ();
-    }
-    
     nEntries = pKProcs.size();
     diffSep=pDiffs.size();
     sdiffSep=pSDiffs.size();
-    reset();
+    _setupDiffComm();
+    if (pProfile != 0) _setupProfile();
+    // The new hosts sample the recording from now on
+    _setupRecColumns();
+
+    // the diffusion rules have been rebuilt
+    recomputeUpdPeriod = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Most passes over the units of the mesh in one rebalance.
+static const uint REBALANCE_MAX_SWEEPS = 16;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Root of element i in a union-find forest.
+static uint uf_find(std::vector<uint> & parent, uint i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Exchange one column of the state of the elements that change host,
+// send[r] going to rank r and recv[r] coming from it.
+template <typename T>
+static void rebalance_exchange(std::vector<ssolver::CPColumns> const & send,
+                               std::vector<ssolver::CPColumns> & recv,
+                               std::vector<T> ssolver::CPColumns::* column, MPI_Datatype type)
+{
+    int nhosts = send.size();
+    std::vector<int> send_counts(nhosts), send_displs(nhosts);
+    std::vector<int> recv_counts(nhosts), recv_displs(nhosts);
+    std::vector<T> send_buf;
+    for (int h = 0; h < nhosts; ++h)
+    {
+        std::vector<T> const & part = send[h].*column;
+        send_counts[h] = part.size();
+        send_displs[h] = send_buf.size();
+        send_buf.insert(send_buf.end(), part.begin(), part.end());
+    }
+    MPI_Alltoall(&send_counts.front(), 1, MPI_INT, &recv_counts.front(), 1, MPI_INT, MPI_COMM_WORLD);
+
+    int nrecv = 0;
+    for (int h = 0; h < nhosts; ++h)
+    {
+        recv_displs[h] = nrecv;
+        nrecv += recv_counts[h];
+    }
+    // never empty, so that the buffers have an address
+    send_buf.resize(std::max<size_t>(send_buf.size(), 1));
+    std::vector<T> recv_buf(std::max(nrecv, 1));
+    MPI_Alltoallv(&send_buf.front(), &send_counts.front(), &send_displs.front(), type,
+                  &recv_buf.front(), &recv_counts.front(), &recv_displs.front(), type, MPI_COMM_WORLD);
+
+    for (int h = 0; h < nhosts; ++h)
+    {
+        typename std::vector<T>::const_iterator b = recv_buf.begin() + recv_displs[h];
+        (recv[h].*column).assign(b, b + recv_counts[h]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::setRebalancePeriods(uint nperiods)
+{
+    if (nperiods != 0) _checkRebalance();
+    pRebalancePeriods = nperiods;
+    pRebalanceCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::getRebalancePeriods(void) const
+{
+    return pRebalancePeriods;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::setRebalanceThreshold(double max_imbalance)
+{
+    if (max_imbalance < 1.0)
+    {
+        std::ostringstream os;
+        os << "Rebalance threshold " << max_imbalance << " is less than 1.";
+        throw steps::ArgErr(os.str());
+    }
+    pRebalanceThreshold = max_imbalance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double smtos::TetOpSplitP::getRebalanceThreshold(void) const
+{
+    return pRebalanceThreshold;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::rebalance(void)
+{
+    _checkRebalance();
+    bool moved = _rebalance();
     MPI_Barrier(MPI_COMM_WORLD);
+    return moved;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong smtos::TetOpSplitP::getNRebalanceChecks(void) const
+{
+    return pNRebalanceChecks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_checkRebalance(void) const
+{
+    if (pDistElems)
+    {
+        std::ostringstream os;
+        os << "Rebalancing is not supported when elements are distributed.";
+        throw steps::NotImplErr(os.str());
+    }
+    if (efflag())
+    {
+        std::ostringstream os;
+        os << "Rebalancing is not supported with EField.";
+        throw steps::NotImplErr(os.str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::_rebalance(void)
+{
+    ++pNRebalanceChecks;
+
+    uint ntets = pMesh->countTets();
+    uint ntris = pMesh->countTris();
+
+    // Kproc events of every element since the last rebalance, from the
+    // extents of the kprocs on their hosts.
+    std::vector<double> events(ntets + ntris, 0.0);
+    auto extent = [](std::vector<smtos::KProc *> const & kprocs) {
+        double e = 0.0;
+        for (auto kp: kprocs) e += kp->getExtent();
+        return e;
+    };
+    for (auto t: pTets)
+        if (t != 0 && t->getInHost()) events[t->idx()] = extent(t->kprocs());
+    for (auto t: pTris)
+        if (t != 0 && t->getInHost()) events[ntets + t->idx()] = extent(t->kprocs());
+    MPI_Allreduce(MPI_IN_PLACE, &events.front(), ntets + ntris, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    pRebalanceExtents.resize(ntets + ntris, 0.0);
+    for (uint i = 0; i < ntets + ntris; ++i)
+    {
+        double e = events[i];
+        // extents restart from 0 after a reset or restore
+        if (e >= pRebalanceExtents[i]) events[i] -= pRebalanceExtents[i];
+        pRebalanceExtents[i] = e;
+    }
+
+    // Patch tris and the tets on both sides of them have to share a host,
+    // so tets joined by patch tris move together as one unit, named by
+    // its lowest tet.
+    std::vector<uint> unit(ntets);
+    std::iota(unit.begin(), unit.end(), 0);
+    for (auto t: pTris)
+    {
+        if (t == 0) continue;
+        const int * tets = pMesh->_getTriTetNeighb(t->idx());
+        if (tets[0] < 0 || tets[1] < 0) continue;
+        uint a = uf_find(unit, tets[0]);
+        uint b = uf_find(unit, tets[1]);
+        if (a < b) unit[b] = a;
+        else unit[a] = b;
+    }
+    for (uint t = 0; t < ntets; ++t) unit[t] = uf_find(unit, t);
+
+    // Load of every unit and of every rank: the events of its elements
+    // plus one per tet for the fixed cost of an element. Tris hosted
+    // apart from their tets stay where they are.
+    std::vector<double> weight(ntets, 0.0);
+    std::vector<double> load(nHosts, 0.0);
+    for (auto t: pTets)
+    {
+        if (t == 0) continue;
+        weight[unit[t->idx()]] += 1.0 + events[t->idx()];
+    }
+    for (auto t: pTris)
+    {
+        if (t == 0) continue;
+        double w = events[ntets + t->idx()];
+        int tet = pMesh->_getTriTetNeighb(t->idx())[0];
+        if (tet < 0) tet = pMesh->_getTriTetNeighb(t->idx())[1];
+        if (tet >= 0 && triHosts[t->idx()] == tetHosts[tet]) weight[unit[tet]] += w;
+        else load[triHosts[t->idx()]] += w;
+    }
+    for (uint u = 0; u < ntets; ++u)
+        if (unit[u] == u) load[tetHosts[u]] += weight[u];
+
+    double mean = std::accumulate(load.begin(), load.end(), 0.0) / nHosts;
+    double max_load = *std::max_element(load.begin(), load.end());
+    if (mean == 0.0 || max_load <= pRebalanceThreshold * mean) return false;
+
+    // The tets of every unit, grouped by unit.
+    std::vector<uint> unit_first(ntets + 1, 0);
+    for (uint t = 0; t < ntets; ++t) unit_first[unit[t] + 1]++;
+    std::partial_sum(unit_first.begin(), unit_first.end(), unit_first.begin());
+    std::vector<uint> unit_tets(ntets);
+    std::vector<uint> fill(unit_first.begin(), unit_first.end() - 1);
+    for (uint t = 0; t < ntets; ++t) unit_tets[fill[unit[t]]++] = t;
+
+    // Diffusive refinement of the current partition: units of ranks above
+    // the mean load move to their least loaded neighbouring rank while
+    // that lowers the larger load of the two, until the imbalance is half
+    // way down to the threshold. All ranks compute the same partition.
+    std::vector<uint> unit_host(tetHosts);
+    double target = (1.0 + pRebalanceThreshold) / 2.0 * mean;
+    bool moved = false;
+    for (uint sweep = 0; sweep < REBALANCE_MAX_SWEEPS && max_load > target; ++sweep)
+    {
+        bool moved_sweep = false;
+        for (uint u = 0; u < ntets; ++u)
+        {
+            if (unit[u] != u || weight[u] == 0.0) continue;
+            uint from = unit_host[u];
+            if (load[from] <= mean) continue;
+
+            int to = -1;
+            for (uint i = unit_first[u]; i < unit_first[u + 1]; ++i)
+            {
+                const int * neighbs = pMesh->_getTetTetNeighb(unit_tets[i]);
+                for (uint n = 0; n < 4; ++n)
+                {
+                    if (neighbs[n] < 0) continue;
+                    uint h = unit_host[unit[neighbs[n]]];
+                    if (h != from && (to < 0 || load[h] < load[to])) to = h;
+                }
+            }
+            if (to < 0 || load[to] + weight[u] >= load[from]) continue;
+
+            unit_host[u] = to;
+            load[from] -= weight[u];
+            load[to] += weight[u];
+            moved_sweep = true;
+        }
+        if (!moved_sweep) break;
+        moved = true;
+        max_load = *std::max_element(load.begin(), load.end());
+    }
+    if (!moved) return false;
+
+    std::vector<uint> tet_hosts(ntets);
+    for (uint t = 0; t < ntets; ++t) tet_hosts[t] = unit_host[unit[t]];
+    std::map<uint, uint> tri_hosts(triHosts);
+    for (auto & th: tri_hosts)
+    {
+        const int * tets = pMesh->_getTriTetNeighb(th.first);
+        int tet = (tets[0] >= 0) ? tets[0] : tets[1];
+        if (tet >= 0 && th.second == tetHosts[tet]) th.second = tet_hosts[tet];
+    }
+    std::vector<uint> wm_hosts(wmHosts);
+
+    // The hosts send the state of their elements and kprocs to the new
+    // hosts, in order of index, before the kprocs are rebuilt.
+    std::vector<ssolver::CPColumns> send(nHosts);
+    auto pack = [](ssolver::CPColumns & cols, smtos::WmVol const * e, std::vector<smtos::KProc *> const & kprocs) {
+        e->checkpointColumns(cols);
+        for (auto kp: kprocs) kp->checkpointColumns(cols);
+    };
+    for (uint wm = 0; wm < pWmVols.size(); ++wm)
+        if (pWmVols[wm] != 0 && pWmVols[wm]->getInHost()) pack(send[wm_hosts[wm]], pWmVols[wm], pWmVols[wm]->kprocs());
+    for (auto t: pTets)
+        if (t != 0 && t->getInHost()) pack(send[tet_hosts[t->idx()]], t, t->kprocs());
+    for (auto t: pTris)
+    {
+        if (t == 0 || !t->getInHost()) continue;
+        ssolver::CPColumns & cols = send[tri_hosts[t->idx()]];
+        t->checkpointColumns(cols);
+        for (auto kp: t->kprocs()) kp->checkpointColumns(cols);
+    }
+
+    std::vector<ssolver::CPColumns> recv(nHosts);
+    rebalance_exchange(send, recv, &ssolver::CPColumns::counts, MPI_UNSIGNED);
+    rebalance_exchange(send, recv, &ssolver::CPColumns::flags, MPI_UNSIGNED);
+    rebalance_exchange(send, recv, &ssolver::CPColumns::ints, MPI_INT);
+    rebalance_exchange(send, recv, &ssolver::CPColumns::reals, MPI_DOUBLE);
+    send.clear();
+
+    std::vector<uint> old_tet_hosts(tetHosts);
+    std::map<uint, uint> old_tri_hosts(triHosts);
+    _repartition(tet_hosts, tri_hosts, wm_hosts);
+
+    std::vector<ssolver::CPCursor> cursors;
+    cursors.reserve(nHosts);
+    for (int h = 0; h < nHosts; ++h) cursors.emplace_back(recv[h]);
+    for (uint wm = 0; wm < pWmVols.size(); ++wm)
+    {
+        smtos::WmVol * e = pWmVols[wm];
+        if (e == 0 || !e->getInHost()) continue;
+        ssolver::CPCursor & cur = cursors[wm_hosts[wm]];
+        e->restoreColumns(cur);
+        for (auto kp: e->kprocs()) kp->restoreColumns(cur);
+    }
+    for (auto t: pTets)
+    {
+        if (t == 0 || !t->getInHost()) continue;
+        ssolver::CPCursor & cur = cursors[old_tet_hosts[t->idx()]];
+        t->restoreColumns(cur);
+        for (auto kp: t->kprocs()) kp->restoreColumns(cur);
+    }
+    for (auto t: pTris)
+    {
+        if (t == 0 || !t->getInHost()) continue;
+        ssolver::CPCursor & cur = cursors[old_tri_hosts[t->idx()]];
+        t->restoreColumns(cur);
+        for (auto kp: t->kprocs()) kp->restoreColumns(cur);
+    }
+    for (auto const & cur: cursors) cur.finish();
+
+    // Rebuild the composition-rejection groups from the moved state.
+    pSum = 0.0;
+    nSum = 0.0;
+    pA0 = 0.0;
+    _updateLocal();
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -8260,6 +10192,291 @@ double smtos::TetOpSplitP::getNIteration(void)
 ////////////////////////////////////////////////////////////////////////////////
 
 
+void smtos::TetOpSplitP::setProfiling(bool enabled)
+{
+    delete pProfile;
+    pProfile = 0;
+    if (enabled == false) return;
+
+    pProfile = new ssolver::KProcProfile(statedef());
+    _setupProfile();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_setupProfile(void)
+{
+    for (auto wmv: pWmVols)
+    {
+        if (wmv == 0 || !wmv->getInHost()) continue;
+        uint cidx = wmv->compdef()->gidx();
+        uint j = 0;
+        for (auto kp: wmv->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->compRow(cidx, j++));
+    }
+    for (auto tet: pTets)
+    {
+        if (tet == 0 || !tet->getInHost()) continue;
+        uint cidx = tet->compdef()->gidx();
+        uint j = 0;
+        for (auto kp: tet->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->compRow(cidx, j++));
+    }
+    for (auto tri: pTris)
+    {
+        if (tri == 0 || !tri->getInHost()) continue;
+        uint pidx = tri->patchdef()->gidx();
+        uint j = 0;
+        for (auto kp: tri->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->patchRow(pidx, j++));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::getProfiling(void) const
+{
+    return (pProfile != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::resetProfile(void)
+{
+    if (pProfile != 0) pProfile->clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<ssolver::KProcProfileRow> smtos::TetOpSplitP::getProfile(bool local)
+{
+    if (pProfile == 0)
+    {
+        std::ostringstream os;
+        os << "Profiling is not enabled.";
+        throw steps::ArgErr(os.str());
+    }
+
+    std::vector<ssolver::KProcProfileRow> rows = pProfile->rows();
+    if (local) return rows;
+
+    // Every rank holds the same row layout, so the columns can be summed
+    // element-wise.
+    uint nrows = rows.size();
+    std::vector<ulong> counts(nrows * 3);
+    std::vector<double> times(nrows);
+    for (uint r = 0; r < nrows; ++r)
+    {
+        counts[r * 3] = rows[r].nevents;
+        counts[r * 3 + 1] = rows[r].napplies;
+        counts[r * 3 + 2] = rows[r].nupdates;
+        times[r] = rows[r].time;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, counts.data(), nrows * 3, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, times.data(), nrows, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    for (uint r = 0; r < nrows; ++r)
+    {
+        rows[r].nevents = counts[r * 3];
+        rows[r].napplies = counts[r * 3 + 1];
+        rows[r].nupdates = counts[r * 3 + 2];
+        rows[r].time = times[r];
+    }
+    return rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::countProfileRows(void) const
+{
+    return (pProfile == 0) ? 0 : pProfile->countRows();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::getProfileNP(double * table, int table_size, bool local)
+{
+    std::vector<ssolver::KProcProfileRow> rows = getProfile(local);
+
+    // Lay the rows out through a profile of the same state definition.
+    ssolver::KProcProfile profile(statedef());
+    profile.rows() = rows;
+    profile.fillTable(table, table_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::addTetRecording(std::vector<uint> const & tets, std::vector<std::string> const & specs)
+{
+    return _addRecording(steps::mpi::REC_ELEM_TET, tets, specs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::addTriRecording(std::vector<uint> const & tris, std::vector<std::string> const & specs)
+{
+    return _addRecording(steps::mpi::REC_ELEM_TRI, tris, specs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::addROIRecording(std::string const & ROI_id, std::vector<std::string> const & specs)
+{
+    steps::tetmesh::ElementType type = mesh()->getROIType(ROI_id);
+    if (type != steps::tetmesh::ELEM_TET && type != steps::tetmesh::ELEM_TRI)
+    {
+        std::ostringstream os;
+        os << "ROI " << ROI_id << " is neither a tetrahedron nor a triangle ROI.";
+        throw steps::ArgErr(os.str());
+    }
+    uint kind = (type == steps::tetmesh::ELEM_TET) ? steps::mpi::REC_ELEM_TET : steps::mpi::REC_ELEM_TRI;
+    return _addRecording(kind, mesh()->getROIData(ROI_id), specs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint smtos::TetOpSplitP::_addRecording(uint kind, std::vector<uint> const & elems, std::vector<std::string> const & specs)
+{
+    if (pRecWriter != 0)
+    {
+        std::ostringstream os;
+        os << "Cannot add recordings while recording.";
+        throw steps::ArgErr(os.str());
+    }
+
+    uint nelems = (kind == steps::mpi::REC_ELEM_TET) ? mesh()->countTets() : mesh()->countTris();
+    for (uint e: elems)
+    {
+        if (e >= nelems)
+        {
+            std::ostringstream os;
+            os << "Error (Index Overbound): There is no " << ((kind == steps::mpi::REC_ELEM_TET) ? "tetrahedron" : "triangle");
+            os << " with index " << e << ".\n";
+            throw steps::ArgErr(os.str());
+        }
+    }
+    // Throws for unknown species
+    for (auto const & spec: specs) statedef()->getSpecIdx(spec);
+
+    steps::mpi::RecSelection sel;
+    sel.kind = kind;
+    sel.elems = elems;
+    sel.specs = specs;
+    pRecSelections.push_back(sel);
+    return pRecSelections.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::startRecording(std::string const & file_name, uint chunk_size, bool compress)
+{
+    if (pRecWriter != 0)
+    {
+        std::ostringstream os;
+        os << "Already recording.";
+        throw steps::ArgErr(os.str());
+    }
+    pRecWriter = new steps::mpi::RecWriter(MPI_COMM_WORLD, file_name, pRecSelections, chunk_size, compress);
+    _setupRecColumns();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::_setupRecColumns(void)
+{
+    if (pRecWriter == 0) return;
+
+    // Every column is sampled by the host of its element; rank 0 fills in
+    // the zeros of elements outside of any compartment or patch.
+    std::vector<uint64_t> cols;
+    pRecColumns.clear();
+    uint64_t col = 0;
+    for (auto const & sel: pRecSelections)
+    {
+        bool tri = (sel.kind == steps::mpi::REC_ELEM_TRI);
+        std::vector<uint> sgidcs;
+        for (auto const & spec: sel.specs) sgidcs.push_back(statedef()->getSpecIdx(spec));
+
+        for (uint e: sel.elems)
+        {
+            int host = 0;
+            bool defined = false;
+            if (tri)
+            {
+                auto th = triHosts.find(e);
+                if (th != triHosts.end()) host = th->second;
+                defined = (th != triHosts.end() && _triPatchdef(e) != 0);
+            }
+            else if (_tetCompdef(e) != 0)
+            {
+                host = tetHosts[e];
+                defined = true;
+            }
+
+            if (host != myRank)
+            {
+                col += sgidcs.size();
+                continue;
+            }
+            for (uint sgidx: sgidcs)
+            {
+                RecColumn rc;
+                rc.tri = tri;
+                rc.idx = e;
+                rc.slidx = ssolver::LIDX_UNDEFINED;
+                if (defined)
+                    rc.slidx = tri ? _triPatchdef(e)->specG2L(sgidx) : _tetCompdef(e)->specG2L(sgidx);
+                pRecColumns.push_back(rc);
+                cols.push_back(col++);
+            }
+        }
+    }
+    pRecValues.assign(pRecColumns.size(), 0.0);
+    pRecWriter->setColumns(cols);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::record(void)
+{
+    if (pRecWriter == 0)
+    {
+        std::ostringstream os;
+        os << "Not recording.";
+        throw steps::ArgErr(os.str());
+    }
+
+    uint ncols = pRecColumns.size();
+    for (uint i = 0; i < ncols; ++i)
+    {
+        RecColumn const & rc = pRecColumns[i];
+        if (rc.slidx == ssolver::LIDX_UNDEFINED) pRecValues[i] = 0.0;
+        else if (rc.tri) pRecValues[i] = pTris[rc.idx]->pools()[rc.slidx];
+        else pRecValues[i] = pTets[rc.idx]->pools()[rc.slidx];
+    }
+    pRecWriter->sample(statedef()->time(), pRecValues.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::TetOpSplitP::stopRecording(void)
+{
+    if (pRecWriter == 0) return;
+    pRecWriter->close();
+    delete pRecWriter;
+    pRecWriter = 0;
+    pRecColumns.clear();
+    pRecValues.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool smtos::TetOpSplitP::getRecording(void) const
+{
+    return pRecWriter != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double smtos::TetOpSplitP::getCompTime(void)
 {
     return compTime;
@@ -42,8 +42,12 @@
 // STEPS headers.
 #include "steps/common.h"
 #include "steps/solver/api.hpp"
+#include "steps/solver/cpfile.hpp"
+#include "steps/solver/kprocprofile.hpp"
 #include "steps/solver/statedef.hpp"
+#include "steps/util/fnv_hash.hpp"
 #include "steps/geom/tetmesh.hpp"
+#include "steps/mpi/recfile.hpp"
 #include "steps/mpi/tetopsplit/tri.hpp"
 #include "steps/mpi/tetopsplit/tet.hpp"
 #include "steps/mpi/tetopsplit/wmvol.hpp"
@@ -53,6 +57,7 @@
 #include "steps/mpi/tetopsplit/diffboundary.hpp"
 #include "steps/mpi/tetopsplit/sdiffboundary.hpp"
 #include "steps/mpi/tetopsplit/crstruct.hpp"
+#include "steps/mpi/tetopsplit/elemtable.hpp"
 
 
 #include "steps/solver/efield/efield.hpp"
@@ -94,10 +99,21 @@ class TetOpSplitP: public steps::solver::API
 {
 public:
 
+    /// If distribute_elems is true, every rank only creates the tets and
+    /// tris it hosts and their direct neighbours, instead of an object for
+    /// every element of the mesh. This bounds the solver objects of a rank,
+    /// with their pools, kprocs and update lists, by its share of the mesh.
+    /// Everything else is still replicated: the Tetmesh, the host of every
+    /// tet and tri, and with an EField the per-vertex arrays, so the memory
+    /// of a rank still grows with the whole mesh. Checkpoints can only be
+    /// restored with the same setting, and repartitioning and rebalancing
+    /// are not supported.
+    ///
     TetOpSplitP(steps::model::Model *m, steps::wm::Geom *g, steps::rng::RNG *r,
             int calcMembPot = EF_NONE, std::vector<uint> const &tet_hosts = std::vector<uint>(),
             std::map<uint, uint> const &tri_hosts = std::map<uint, uint>(),
-            std::vector<uint> const &wm_hosts = std::vector<uint>());
+            std::vector<uint> const &wm_hosts = std::vector<uint>(),
+            bool distribute_elems = false);
     ~TetOpSplitP(void);
 
 
@@ -119,7 +135,18 @@ public:
     void advance(double adv);
     void step(void);
 
+    /// Write a distributed checkpoint (collective). Every rank writes
+    /// the elements it hosts, their kprocs and its random number generator
+    /// to the part file file_name.<rank>; rank 0 writes the index file
+    /// file_name with the state definition, the EField state and the
+    /// host of every element.
     void checkpoint(std::string const & file_name);
+
+    /// Restore a distributed checkpoint (collective). Each rank reads the
+    /// elements it hosts from the part files of their previous hosts, so
+    /// the partition and the number of ranks may differ from those of the
+    /// checkpoint. The generators are restored only if the number of ranks
+    /// is the same.
     void restore(std::string const & file_name);
     ////////////////////////// ADDED FOR EFIELD ////////////////////////////
 
@@ -128,6 +155,21 @@ public:
     inline double efdt(void) const
     { return pEFDT; }
 
+    /// Switch adaptive EField stepping on or off. When on, the EField step
+    /// varies between dtmin and dtmax (seconds) to keep its estimated local
+    /// error in the membrane potential within errtol (volts), and takes the
+    /// place of the EField dt.
+    void setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol);
+
+    bool getEfieldAdaptive(void) const;
+
+    /// Return the numbers of adaptive EField steps within the error
+    /// tolerance, and over it, since adaptive stepping was switched on.
+    /// Adaptive stepping only controls the step length: steps over the
+    /// tolerance are kept and the steps after them shortened.
+    ulong getEfieldNStepsWithinTolerance(void) const;
+    ulong getEfieldNStepsOverTolerance(void) const;
+
     void setTemp(double t);
 
     inline double getTemp(void) const
@@ -316,10 +358,10 @@ public:
     bool _getTriClamped(uint tidx, uint sidx) const;
     void _setTriClamped(uint tidx, uint sidx, bool buf);
 
-    double _getTriSReacK(uint tidx, uint ridx) ;
+    double _getTriSReacK(uint tidx, uint ridx) const;
     void _setTriSReacK(uint tidx, uint ridx, double kf);
 
-    bool _getTriSReacActive(uint tidx, uint ridx) ;
+    bool _getTriSReacActive(uint tidx, uint ridx) const;
     void _setTriSReacActive(uint tidx, uint ridx, bool act);
     
     double _getTriSDiffD(uint tidx, uint didx, uint direction_tri = std::numeric_limits<uint>::max()) ;
@@ -329,14 +371,20 @@ public:
 
     ////////////////////////////////////////////////////////////////////////
 
-    double _getTriSReacH(uint tidx, uint ridx) ;
-    double _getTriSReacC(uint tidx, uint ridx) ;
-    double _getTriSReacA(uint tidx, uint ridx) ;
+    double _getTriSReacH(uint tidx, uint ridx) const;
+    double _getTriSReacC(uint tidx, uint ridx) const;
+    double _getTriSReacA(uint tidx, uint ridx) const;
 
     ////////////////////////// ADDED FOR EFIELD ////////////////////////////
 
     double _getTriV(uint tidx) const;
     void _setTriV(uint tidx, double v);
+
+    /// Potential of a membrane triangle hosted by this rank, for its
+    /// kinetic processes; unlike _getTriV(), never collective.
+    inline double _getLocalTriV(uint tidx) const
+    { return EFTrisV[pEFTri_GtoL[tidx]]; }
+
     bool _getTriVClamped(uint tidx) const;
     void _setTriVClamped(uint tidx, bool cl);
 
@@ -427,6 +475,12 @@ public:
     inline steps::mpi::tetopsplit::Tri * _tri(uint tidx) const
     { return pTris[tidx]; }
 
+    // Compartment of a tet and patch of a tri, or 0 if they have none,
+    // taken from the mesh so that every rank can check its arguments
+    // whether or not it has an object for the element.
+    steps::solver::Compdef * _tetCompdef(uint tidx) const;
+    steps::solver::Patchdef * _triPatchdef(uint tidx) const;
+
     inline double a0(void) const
     { return pA0; }
 
@@ -459,6 +513,21 @@ public:
     // by constructor
     void _setup(void);
 
+    // Global indices of the tets and tris this rank creates objects for
+    // when elements are distributed: those it hosts, their face neighbours,
+    // the tets on either side of its tris and the patch tris next to them.
+    // bar2tri lists the patch tris on each bar.
+    void _localElems(std::map<uint, std::vector<uint> > const & bar2tri,
+                     std::vector<uint> & tets, std::vector<uint> & tris) const;
+
+    // Subvolumes of a compartment or patch in the order in which counts
+    // are distributed over them, with their volumes or areas. The object
+    // of a subvolume is 0 if it is only created on other ranks.
+    void _compSubvols(uint cidx, std::vector<steps::mpi::tetopsplit::WmVol *> & svols,
+                      std::vector<double> & weights) const;
+    void _patchSubvols(uint pidx, std::vector<steps::mpi::tetopsplit::Tri *> & tris,
+                       std::vector<double> & weights) const;
+
     void _runWithoutEField(double endtime);
     void _runWithEField(double endtime);
     //void _build(void);
@@ -492,6 +561,30 @@ public:
 
     void _setupEField(void);
 
+    /// Whether the EField is distributed over the ranks, with EF_DV_DIST
+    inline bool efdist(void) const
+    { return pEFoption == EF_DV_DIST; }
+
+    /// Set up the part of the EField mesh of this rank, with EF_DV_DIST
+    void _setupDistEField(steps::tetmesh::Memb * memb);
+
+    /// Whether a vertex, triangle or tetrahedron is part of the EField
+    bool _isEFVert(uint vidx) const;
+    bool _isEFTri(uint tidx) const;
+    bool _isEFTet(uint tidx) const;
+
+    /// Distributed EField: apply f(local index) to those of the given
+    /// vertices held by this rank.
+    template <typename F>
+    void _forLocalEFVerts(uint const * verts, uint nverts, F f)
+    {
+        for (uint i = 0; i < nverts; ++i)
+        {
+            int locvidx = pEFVert_GtoL[verts[i]];
+            if (locvidx != -1) f(locvidx);
+        }
+    }
+
     inline uint neftets(void) const
     { return pEFNTets; }
 
@@ -521,6 +614,32 @@ public:
     
     double sumBatchTriOhmicIsNP(unsigned int* indices, int input_size, std::string const & oc);
     
+    void setBatchTetCountsNP(unsigned int* indices, int input_size, std::string const & s, double* counts, int count_size);
+
+    void setBatchTriCountsNP(unsigned int* indices, int input_size, std::string const & s, double* counts, int count_size);
+
+    // Vectorised reaction accessors: each rank handles the elements it
+    // hosts and the results are combined with a single collective call.
+    void getBatchTetReacKNP(unsigned int* indices, int input_size, std::string const & r, double* ks, int output_size) const;
+
+    void setBatchTetReacKNP(unsigned int* indices, int input_size, std::string const & r, double* ks, int k_size);
+
+    void getBatchTetReacActiveNP(unsigned int* indices, int input_size, std::string const & r, unsigned char* actives, int output_size) const;
+
+    void setBatchTetReacActiveNP(unsigned int* indices, int input_size, std::string const & r, unsigned char* actives, int active_size);
+
+    void getBatchTetReacANP(unsigned int* indices, int input_size, std::string const & r, double* as, int output_size) const;
+
+    void getBatchTriSReacKNP(unsigned int* indices, int input_size, std::string const & sr, double* ks, int output_size) const;
+
+    void setBatchTriSReacKNP(unsigned int* indices, int input_size, std::string const & sr, double* ks, int k_size);
+
+    void getBatchTriSReacActiveNP(unsigned int* indices, int input_size, std::string const & sr, unsigned char* actives, int output_size) const;
+
+    void setBatchTriSReacActiveNP(unsigned int* indices, int input_size, std::string const & sr, unsigned char* actives, int active_size);
+
+    void getBatchTriSReacANP(unsigned int* indices, int input_size, std::string const & sr, double* as, int output_size) const;
+
     ////////////////////////////////////////////////////////////////////////
     // ROI Data Access
     ////////////////////////////////////////////////////////////////////////
@@ -576,23 +695,59 @@ public:
     uint getTetHostRank(uint tidx);
     uint getTriHostRank(uint tidx);
     uint getWMVolHostRank(uint idx);
+
+    /// Whether every rank only creates the tets and tris it hosts and
+    /// their neighbours.
+    bool getDistributedElems(void) const;
+    /// Number of tets and tris with an object on this rank.
+    uint countLocalTets(void) const;
+    uint countLocalTris(void) const;
 	//void registerSyncWmVol(steps::mpi::tetopsplit::WmVol * wmvol);
     //void registerSyncTet(steps::mpi::tetopsplit::Tet * tet);
     //void registerSyncTri(steps::mpi::tetopsplit::Tri * tri);
     void addNeighHost(int host);
     void registerBoundaryTet(steps::mpi::tetopsplit::Tet *tet);
     void registerBoundaryTri(steps::mpi::tetopsplit::Tri *tri);
-    uint registerRemoteMoleculeChange(int svol_host, uint loc, SubVolType svol_type, uint idx, uint slidx, uint change);
+    // Add change molecules to slot loc of the change buffer for svol_host,
+    // see Tet::setupBufferLocations() and Tri::setupBufferLocations().
+    void registerRemoteMoleculeChange(int svol_host, uint loc, uint change);
     
     double getReacExtent(bool local = false);
     double getDiffExtent(bool local = false);
     double getNIteration(void);
     
     double getUpdPeriod(void) {return updPeriod;}
+
+    /// Give every diffusion rule its own update period: the longest of
+    /// the base period getUpdPeriod() times 1, 2, 4, ... 2^(nlevels-1) that
+    /// does not exceed the mean dwell period of a molecule of the rule.
+    /// Slow rules are then only applied, and their molecule changes only
+    /// exchanged, every few base periods. 1, the default, applies every
+    /// rule every base period.
+    void setUpdPeriodLevels(uint nlevels);
+    uint getUpdPeriodLevels(void) const;
     
     void repartitionAndReset(std::vector<uint> const &tet_hosts,
                      std::map<uint, uint> const &tri_hosts  = std::map<uint, uint>(),
                      std::vector<uint> const &wm_hosts = std::vector<uint>());
+
+    /// Rebalance the tets and tris among the ranks every nperiods update
+    /// periods of run(), keeping the state of the simulation; 0, the
+    /// default, turns rebalancing off. Elements only move once the busiest
+    /// rank has had more than max_imbalance times the mean number of kproc
+    /// events since the last rebalance.
+    void setRebalancePeriods(uint nperiods);
+    uint getRebalancePeriods(void) const;
+    void setRebalanceThreshold(double max_imbalance);
+    double getRebalanceThreshold(void) const;
+
+    /// Rebalance now if the threshold is exceeded (collective). Returns
+    /// whether any element moved.
+    bool rebalance(void);
+
+    /// Return the number of times the load was checked for rebalancing,
+    /// by run() or rebalance(), since the last reset.
+    ulong getNRebalanceChecks(void) const;
     
     double getCompTime(void);
     double getSyncTime(void);
@@ -600,6 +755,41 @@ public:
     double getEFieldTime(void);
     double getRDTime(void);
     double getDataExchangeTime(void);
+
+    /// Count the events, kproc updates and time spent per rule and
+    /// compartment/patch from now on. Off by default; switching it off
+    /// discards the profile.
+    void setProfiling(bool enabled);
+    bool getProfiling(void) const;
+    void resetProfile(void);
+
+    /// Profile of this rank if local is true, otherwise summed over all
+    /// ranks (collective). Times are then total CPU seconds.
+    std::vector<steps::solver::KProcProfileRow> getProfile(bool local = false);
+    uint countProfileRows(void) const;
+    void getProfileNP(double * table, int table_size, bool local = false);
+
+    /// Record the counts of species in tets, tris or the elements of an
+    /// ROI to a file at every call of record(). Selections are added before
+    /// startRecording(); each returns its index in the file.
+    uint addTetRecording(std::vector<uint> const & tets, std::vector<std::string> const & specs);
+    uint addTriRecording(std::vector<uint> const & tris, std::vector<std::string> const & specs);
+    uint addROIRecording(std::string const & ROI_id, std::vector<std::string> const & specs);
+
+    /// Create the recording file (collective). Every rank keeps the counts
+    /// of the elements it hosts for chunk_size samples and then writes them
+    /// into the file directly; compress stores the counts as varint
+    /// differences. The file is read by steps.utilities.recording.
+    void startRecording(std::string const & file_name, uint chunk_size = 64, bool compress = false);
+
+    /// Take a sample of all selections at the current time. Collective
+    /// only when a chunk is written.
+    void record(void);
+
+    /// Write the pending samples and close the file (collective). The
+    /// selections are kept for the next startRecording().
+    void stopRecording(void);
+    bool getRecording(void) const;
     
 private:
 
@@ -624,10 +814,11 @@ private:
     // being treated as a well-mixed volume.
     std::vector<steps::mpi::tetopsplit::WmVol *>      pWmVols;
 
-    std::vector<steps::mpi::tetopsplit::Tri *>        pTris;
-
-    // Now stored as base pointer
-    std::vector<steps::mpi::tetopsplit::Tet *>        pTets;
+    // Tets and tris by global index; only those hosted on this rank and
+    // their neighbours have an object if elements are distributed.
+    ElemTable<steps::mpi::tetopsplit::Tri>            pTris;
+    ElemTable<steps::mpi::tetopsplit::Tet>            pTets;
+    bool                                              pDistElems;
 
     ////////////////////////////////////////////////////////////////////////
     // Diffusion Data and Methods
@@ -638,6 +829,11 @@ private:
 
     // separator for non-zero and zero propensity diffusions
     uint                                        diffSep;
+
+    // Diffusions of tets next to a tet on another rank come first in
+    // pDiffs, up to this separator, so that their molecule changes can be
+    // sent before the other diffusions are applied.
+    uint                                        diffBndSep;
     
     ////////////////////////////////////////////////////////////////////////
     // Surface Diffusion Data and Methods
@@ -649,6 +845,89 @@ private:
     // separator for non-zero and zero propensity diffusions
     uint                                        sdiffSep;
 
+    // Same as diffBndSep for surface diffusions of tris.
+    uint                                        sdiffBndSep;
+
+    // Apply the diffusions in [begin, end) of pDiffs or pSDiffs for their
+    // update period, the last substep of which was the SSA period,
+    // recording what was applied for the rate updates. Returns the number
+    // of molecules moved.
+    uint _applyDiffs(uint begin, uint end, double period, double substep,
+                     std::vector<KProc*> & applied_diffs, std::vector<int> & directions);
+    uint _applySDiffs(uint begin, uint end, double period, double substep,
+                      std::vector<KProc*> & applied_diffs, std::vector<int> & directions);
+
+    // Shared by _applyDiffs() and _applySDiffs(): gather the diffusions
+    // with molecules in batches, sample them and apply them in order.
+    template <typename KP>
+    uint _applyDiffBatches(std::vector<KP*> const & kprocs, std::vector<double> const & rates,
+                           uint begin, uint end, double period, double substep,
+                           std::vector<KProc*> & applied_diffs, std::vector<int> & directions);
+
+    // Draw the molecules to diffuse of the first n diffusions of the batch.
+    void _sampleDiffBatch(uint n, double period, double substep);
+
+    // Rates of pDiffs and pSDiffs by position, mirrored from their
+    // crData.rate while running, so that the diffusions with molecules are
+    // found without visiting every kproc; set again at the start of every
+    // run and whenever the diffusions are reordered.
+    std::vector<double>                         pDiffRates;
+    std::vector<double>                         pSDiffRates;
+    void _mirrorDiffRates(void);
+
+    // Split the molecules of the diffusions of the batch above
+    // diffApplyThreshold among their directions into pBatchDirMolcs.
+    template <typename KP>
+    void _splitDiffBatch(std::vector<KP*> const & kprocs, uint n);
+
+    // Inputs and outputs of a batch of diffusions, stored by field so that
+    // the mean number of molecules to diffuse is found in one loop, and the
+    // binomial trials and chances of every draw of the batch.
+    std::vector<uint>                           pBatchPos;
+    std::vector<double>                         pBatchRate;
+    std::vector<double>                         pBatchDcst;
+    std::vector<double>                         pBatchOccupancy;
+    std::vector<double>                         pBatchLastUpdate;
+    std::vector<uint>                           pBatchTrials;
+    std::vector<double>                         pBatchChances;
+    std::vector<uint>                           pBatchMolcs;
+
+    // Diffusions of the batch split among directions, the molecules of
+    // every one still to split, its direction chances, the binomials drawn
+    // for one direction, and the molecules in every direction.
+    std::vector<uint>                           pBatchSplit;
+    std::vector<uint>                           pBatchRemain;
+    std::vector<double>                         pBatchDirChances;
+    std::vector<uint>                           pBatchDraws;
+    std::vector<uint>                           pBatchDirMolcs;
+
+    // Apply the boundary or the other diffusions and surface diffusions
+    // of update period levels 0 to due.
+    uint _applyDiffLevels(bool boundary, uint due, double substep,
+                          std::vector<KProc*> & applied_diffs, std::vector<int> & directions);
+
+    ////////////////////////////////////////////////////////////////////////
+    // Multi-rate diffusion update periods
+    ////////////////////////////////////////////////////////////////////////
+
+    // Rules of level k are applied every 2^k base periods. Within the
+    // boundary and the other diffusions of pDiffs and pSDiffs, rules are
+    // sorted by level, and the Seps vectors hold the end of every level.
+    uint                                        pUpdLevels;
+    std::vector<uint>                           diffBndLevelSeps;
+    std::vector<uint>                           diffLevelSeps;
+    std::vector<uint>                           sdiffBndLevelSeps;
+    std::vector<uint>                           sdiffLevelSeps;
+
+    // Base periods into the current cycle of 2^(pUpdLevels-1) base periods,
+    // and the time since the rules of every level were last applied.
+    uint                                        pUpdCycle;
+    std::vector<double>                         pUpdLevelTime;
+
+    // Lowest level of the boundary diffusions of any rank; molecule changes
+    // are only exchanged in base periods in which that level is due.
+    uint                                        pMinBndLevel;
+
     ////////////////////////////////////////////////////////////////////////
     // CR SSA Kernel Data and Methods
     ////////////////////////////////////////////////////////////////////////
@@ -675,6 +954,13 @@ private:
     void _extendGroup(CRGroup* group, uint size = 1024);
     void _updateSum(void);
     void _updateElement(KProc* kp);
+
+    // Checks every index of a batch call and returns the local species
+    // (spec) or reaction indices of gidx in the elements.
+    std::vector<uint> _batchTetLidcs(unsigned int* indices, int input_size, bool spec, uint gidx) const;
+    std::vector<uint> _batchTriLidcs(unsigned int* indices, int input_size, bool spec, uint gidx) const;
+    // Rounds fractional counts on rank 0 and broadcasts them.
+    std::vector<uint> _batchRoundCounts(double* counts, int input_size);
     ////////////////////////////////////////////////////////////////////////
 
     // Keeps track of whether _build() has been called
@@ -697,6 +983,9 @@ private:
     // The Efield time-step
     double                                      pEFDT;
 
+    // The volume resistivity of the conduction volume, for checkpoints
+    double                                      pEFVolRes;
+
     // The number of vertices
     uint                                        pEFNVerts;
 
@@ -740,6 +1029,18 @@ private:
     // True if our copy of tri voltages from EField solver is out of date.
     bool                                        pEFTrisVStale;
 
+    // Distributed EField only: the rank holding every vertex, triangle
+    // and tetrahedron of the mesh in the EField, or -1 for those outside
+    // it. Tetrahedrons and triangles are held by their hosts, a vertex
+    // by the lowest rank holding one of them with the vertex; the counts
+    // and tables above cover only those held by this rank.
+    std::vector<int>                            pEFVertHosts;
+    std::vector<int>                            pEFTriHosts;
+    std::vector<int>                            pEFTetHosts;
+    // Mesh index of every vertex of the whole EField, in EField vertex
+    // order, for checkpoints.
+    std::vector<uint>                           pEFVertIdcs;
+
     
     ////////////////////////// MPI STUFFS ////////////////////////////
     
@@ -763,9 +1064,46 @@ private:
     std::set<steps::mpi::tetopsplit::Tet *>     boundaryTets;
     std::set<steps::mpi::tetopsplit::Tri *>     boundaryTris;
     
+    // Molecules added by diffusion in every slot of the elements of each
+    // neighbouring rank during one iteration. The slots of a neighbour
+    // are its tets and then its tris next to this rank in order of
+    // index, each with one slot per species, so the ranks agree on them
+    // without sending indices.
     std::map<int, std::vector<uint> >           remoteChanges;
-    
-    void _remoteSyncAndUpdate(void* requests, std::vector<KProc*> & applied_diffs, std::vector<int> & directions);
+
+    // remoteChanges of every neighbouring rank encoded for sending, in
+    // the order of neighbHosts; kept until the sends complete.
+    std::vector<std::vector<unsigned char> >    sendChanges;
+
+    // Where the changes in a slot received from a neighbour go.
+    struct RemoteSlot
+    {
+        steps::mpi::tetopsplit::Tet           * tet;
+        steps::mpi::tetopsplit::Tri           * tri;
+        uint                                    slidx;
+    };
+
+    // Slots of every neighbouring rank, receive buffers sized for the
+    // longest encoding of them, and the persistent receive requests
+    // (MPI_Request[]) into those, in the order of neighbHosts.
+    std::vector<std::vector<RemoteSlot> >       recvSlots;
+    std::vector<std::vector<unsigned char> >    recvChanges;
+    void                                      * pRecvRequests;
+
+    // Order the diffusions, agree on the slots with the neighbouring
+    // ranks and set up the persistent receives once the neighbouring
+    // ranks are known; free the receives again.
+    void _setupDiffComm(void);
+    void _freeDiffComm(void);
+
+    // Encode remoteChanges and post the sends to all neighbouring ranks
+    // into requests (MPI_Request[nNeighbHosts]).
+    void _sendRemoteChanges(void* requests);
+
+    // Update the kprocs affected by the applied diffusions and, if changes
+    // were exchanged this iteration, by those of the neighbouring ranks.
+    void _remoteSyncAndUpdate(std::vector<KProc*> & applied_diffs, std::vector<int> & directions,
+                              bool exchanged = true);
     
     //void _applyRemoteMoleculeChanges(std::vector<MPI_Request> & requests);
     //void _syncPoolCounts(void);
@@ -783,6 +1121,68 @@ private:
     double                                      efieldTime;
     double                                      rdTime;
     double                                      dataExchangeTime;
+
+    // Event profile, or 0 if profiling is off.
+    steps::solver::KProcProfile               * pProfile;
+
+    // Map the kprocs hosted on this rank to their profile rows.
+    void _setupProfile(void);
+
+    // Recording selections and the writer, or 0 if not recording.
+    std::vector<steps::mpi::RecSelection>       pRecSelections;
+    steps::mpi::RecWriter                     * pRecWriter;
+
+    // Column of the recording sampled by this rank: a pool of a tet or
+    // tri, or none if the species is not defined there.
+    struct RecColumn
+    {
+        bool                                    tri;
+        uint                                    idx;
+        uint                                    slidx;
+    };
+    std::vector<RecColumn>                      pRecColumns;
+    std::vector<double>                         pRecValues;
+
+    uint _addRecording(uint kind, std::vector<uint> const & elems, std::vector<std::string> const & specs);
+
+    // Set up the columns sampled by this rank from the current hosts,
+    // writing the samples taken with the previous ones first.
+    void _setupRecColumns(void);
+
+    // Rebalance every pRebalancePeriods iterations, or never if 0, and
+    // the iterations since the last rebalance.
+    uint                                        pRebalancePeriods;
+    uint                                        pRebalanceCount;
+    double                                      pRebalanceThreshold;
+    ulong                                       pNRebalanceChecks;
+
+    // Summed kproc extents of every tet and then every tri of the mesh at
+    // the last rebalance.
+    std::vector<double>                         pRebalanceExtents;
+
+    // Throw unless the elements can be moved between ranks.
+    void _checkRebalance(void) const;
+    bool _rebalance(void);
+
+    // Rebuild the kprocs and the communication of this rank for a new
+    // partition, leaving the state of the elements as it is.
+    void _repartition(std::vector<uint> const & tet_hosts,
+                      std::map<uint, uint> const & tri_hosts,
+                      std::vector<uint> const & wm_hosts);
+
+    // Fingerprint of the mesh and EField setup, stored in checkpoints.
+    steps::util::hash_type _cpMeshFingerprint(void) const;
+
+    // Host of every element of a checkpoint section, or CP_NO_OWNER.
+    std::vector<uint> _cpOwners(uint section) const;
+
+    // Write and restore the composition-rejection data of the kprocs
+    // hosted on this rank, for restoring onto the same partition.
+    void _cpWriteCR(steps::solver::CPWriter & cp) const;
+    void _cpRestoreCR(steps::solver::CPReader const & cp);
+    // Throw unless the CR data of the checkpoint fit the kprocs of this
+    // rank, without changing them.
+    void _cpCheckCR(steps::solver::CPReader const & cp) const;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -196,6 +196,44 @@ void smtos::Tri::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::Tri::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    uint nspecs = patchdef()->countSpecs();
+    cols.counts.insert(cols.counts.end(), pPoolCount, pPoolCount + nspecs);
+    cols.flags.insert(cols.flags.end(), pPoolFlags, pPoolFlags + nspecs);
+
+    uint nghkcurrs = pPatchdef->countGHKcurrs();
+    cols.ints.insert(cols.ints.end(), pECharge, pECharge + nghkcurrs);
+    cols.ints.insert(cols.ints.end(), pECharge_last, pECharge_last + nghkcurrs);
+
+    uint nohmcurrs = pPatchdef->countOhmicCurrs();
+    cols.reals.insert(cols.reals.end(), pOCchan_timeintg, pOCchan_timeintg + nohmcurrs);
+    cols.reals.insert(cols.reals.end(), pOCtime_upd, pOCtime_upd + nohmcurrs);
+
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndDirection[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::Tri::restoreColumns(steps::solver::CPCursor & cur)
+{
+    uint nspecs = patchdef()->countSpecs();
+    cur.counts(pPoolCount, nspecs);
+    cur.flags(pPoolFlags, nspecs);
+
+    uint nghkcurrs = pPatchdef->countGHKcurrs();
+    cur.ints(pECharge, nghkcurrs);
+    cur.ints(pECharge_last, nghkcurrs);
+
+    uint nohmcurrs = pPatchdef->countOhmicCurrs();
+    cur.reals(pOCchan_timeintg, nohmcurrs);
+    cur.reals(pOCtime_upd, nohmcurrs);
+
+    for (uint i = 0; i < 3; ++i) pSDiffBndDirection[i] = cur.integer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::Tri::setInnerTet(smtos::WmVol * t)
 {
     pInnerTet = t;
@@ -604,7 +642,7 @@ void smtos::Tri::incCount(uint lidx, int inc, double period, bool local_change)
             os << "Fail because molecule change of receiving end should always be non-negative.\n";
             throw steps::ProgErr(os.str());
         }
-        bufferLocations[lidx] = pSol->registerRemoteMoleculeChange(hostRank, bufferLocations[lidx], SUB_TRI, pIdx, lidx, inc);
+        pSol->registerRemoteMoleculeChange(hostRank, bufferLocations[lidx], inc);
     }
     // local change by reac or diff
     else {
@@ -893,10 +931,11 @@ void smtos::Tri::repartition(smtos::TetOpSplitP * tex, int rank, int host_rank)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void smtos::Tri::setupBufferLocations(void)
+void smtos::Tri::setupBufferLocations(uint first)
 {
     uint nspecs = pPatchdef->countSpecs();
-    bufferLocations.assign(nspecs, std::numeric_limits<uint>::max());
+    bufferLocations.resize(nspecs);
+    for (uint l = 0; l < nspecs; ++l) bufferLocations[l] = first + l;
 }
 
 
@@ -36,6 +36,7 @@
 #include "steps/common.h"
 #include "steps/solver/patchdef.hpp"
 #include "steps/mpi/tetopsplit/kproc.hpp"
+#include "steps/solver/cpfile.hpp"
 #include "steps/solver/types.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,6 +96,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // SETUP
     ////////////////////////////////////////////////////////////////////////
@@ -274,7 +281,9 @@ public:
     std::vector<smtos::KProc*> const & getSpecUpdKProcs(uint slidx);
     
     void repartition(smtos::TetOpSplitP * tex, int rank, int host_rank);
-    void setupBufferLocations(void);
+    /// Collect the changes of species lidx by diffusion from this rank in
+    /// slot first + lidx of the change buffer sent to the host.
+    void setupBufferLocations(uint first);
 private:
 
     ////////////////////////////////////////////////////////////////////////
@@ -151,7 +151,7 @@ double smtos::VDepTrans::rate(steps::mpi::tetopsplit::TetOpSplitP * solver)
     uint srclidx = pdef->vdeptrans_srcchanstate(vdtlidx);
 
     double n = static_cast<double>(pTri->pools()[srclidx]);
-    double v = solver->getTriV(pTri->idx());
+    double v = solver->_getLocalTriV(pTri->idx());
     double ra = pVDepTransdef->getVDepRate(v);
 
     return ra*n;
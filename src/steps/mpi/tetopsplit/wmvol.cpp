@@ -117,6 +117,24 @@ void smtos::WmVol::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void smtos::WmVol::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    uint nspecs = compdef()->countSpecs();
+    cols.counts.insert(cols.counts.end(), pPoolCount, pPoolCount + nspecs);
+    cols.flags.insert(cols.flags.end(), pPoolFlags, pPoolFlags + nspecs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void smtos::WmVol::restoreColumns(steps::solver::CPCursor & cur)
+{
+    uint nspecs = compdef()->countSpecs();
+    cur.counts(pPoolCount, nspecs);
+    cur.flags(pPoolFlags, nspecs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void smtos::WmVol::setNextTri(smtos::Tri * t)
 {
     uint index = pNextTris.size();
@@ -109,6 +109,22 @@ void MT19937::concreteFillBuffer(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void MT19937::concreteCheckpoint(std::fstream & cp_file)
+{
+    cp_file.write((char*)pState, sizeof(unsigned long) * MT_N);
+    cp_file.write((char*)&pStateInit, sizeof(int));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MT19937::concreteRestore(std::fstream & cp_file)
+{
+    cp_file.read((char*)pState, sizeof(unsigned long) * MT_N);
+    cp_file.read((char*)&pStateInit, sizeof(int));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MT19937::MT19937(uint bufsize)
 : RNG(bufsize)
 {
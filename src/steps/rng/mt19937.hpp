@@ -118,6 +118,9 @@ protected:
     ///
     virtual void concreteFillBuffer(void);
 
+    virtual void concreteCheckpoint(std::fstream & cp_file);
+    virtual void concreteRestore(std::fstream & cp_file);
+
 private:
 
     unsigned long               pState[MT_N];
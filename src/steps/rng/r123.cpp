@@ -90,4 +90,20 @@ void R123::concreteFillBuffer(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void R123::concreteCheckpoint(std::fstream & cp_file)
+{
+    cp_file.write((char*)&key, sizeof(key));
+    cp_file.write((char*)&ctr, sizeof(ctr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void R123::concreteRestore(std::fstream & cp_file)
+{
+    cp_file.read((char*)&key, sizeof(key));
+    cp_file.read((char*)&ctr, sizeof(ctr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // END
@@ -105,6 +105,9 @@ protected:
     ///
     virtual void concreteFillBuffer(void);
 
+    virtual void concreteCheckpoint(std::fstream & cp_file);
+    virtual void concreteRestore(std::fstream & cp_file);
+
 private:
 
     r123_type::key_type key;
@@ -30,10 +30,12 @@
 #include <cmath>
 #include <string>
 #include <iostream>
+#include <sstream>
 #include <random>
 
 // STEPS headers.
 #include "steps/common.h"
+#include "steps/error.hpp"
 #include "steps/math/tools.hpp"
 #include "steps/rng/rng.hpp"
 #include "steps/rng/small_binomial.hpp"
@@ -79,16 +81,64 @@ void RNG::initialize(ulong const & seed)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RNG::checkpoint(std::fstream & cp_file)
+{
+    uint next = rNext - rBuffer;
+    cp_file.write((char*)&rSize, sizeof(uint));
+    cp_file.write((char*)&next, sizeof(uint));
+    cp_file.write((char*)rBuffer, sizeof(uint) * rSize);
+    cp_file.write((char*)&pInitialized, sizeof(bool));
+    concreteCheckpoint(cp_file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RNG::restore(std::fstream & cp_file)
+{
+    uint size = 0;
+    uint next = 0;
+    cp_file.read((char*)&size, sizeof(uint));
+    cp_file.read((char*)&next, sizeof(uint));
+    if (!cp_file || size != rSize || next > rSize)
+    {
+        std::ostringstream os;
+        os << "Random number generator state does not match the generator.";
+        throw steps::ArgErr(os.str());
+    }
+    cp_file.read((char*)rBuffer, sizeof(uint) * rSize);
+    cp_file.read((char*)&pInitialized, sizeof(bool));
+    rNext = rBuffer + next;
+    concreteRestore(cp_file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RNG::concreteCheckpoint(std::fstream &)
+{
+    throw steps::NotImplErr("Checkpointing is not supported by this random number generator.");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RNG::concreteRestore(std::fstream &)
+{
+    throw steps::NotImplErr("Checkpointing is not supported by this random number generator.");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 float RNG::getStdExp(void)
 {
-    static float q[8] =
+    // Only the table is static, so that independent generators can be
+    // used from different threads.
+    static const float q[8] =
     {
         0.6931472, 0.9333737, 0.9888778, 0.9984959,
         0.9998293, 0.9999833, 0.9999986, 0.9999999
     };
-    static long i;
-    static float sexpo, a, u, ustar, umin;
-    static float *q1 = q;
+    long i;
+    float sexpo, a, u, ustar, umin;
+    const float *q1 = q;
     a = 0.0;
     u = getUnfEE();
     goto S30;
@@ -474,4 +524,63 @@ uint RNG::getBinom(uint t, double p)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void RNG::getBinoms(uint n, uint const * t, double const * p, uint * k)
+{
+    // Largest mean of the less likely outcome sampled by inversion, which
+    // takes about as many steps; then the probability of no successes is
+    // at least exp(-2 * 16), well within double precision.
+    const double inv_max_mean = 16.0;
+
+    // The uniform numbers first, in one pass over the buffer; k holds
+    // them as raw draws until they are replaced by the results.
+    for (uint i = 0; i < n; ++i) k[i] = get();
+
+    for (uint i = 0; i < n; ++i)
+    {
+        uint ti = t[i];
+        double pi = p[i];
+        if (ti == 0 || pi <= 0.0)
+        {
+            k[i] = 0;
+            continue;
+        }
+        if (pi >= 1.0)
+        {
+            k[i] = ti;
+            continue;
+        }
+
+        bool flip = (pi > 0.5);
+        double ps = flip ? 1.0 - pi : pi;
+        if (ti * ps > inv_max_mean)
+        {
+            k[i] = getBinom(ti, pi);
+            continue;
+        }
+
+        // Walk up the cumulative distribution from P(0) = q^t, found by
+        // squaring rather than std::pow, which costs more than the walk.
+        double q = 1.0 - ps;
+        double r = ps / q;
+        double f = 1.0;
+        double b = q;
+        for (uint e = ti; e != 0; e >>= 1)
+        {
+            if (e & 1) f *= b;
+            b *= b;
+        }
+        double u = k[i] * (1.0/4294967296.0);
+        uint x = 0;
+        while (u >= f && x < ti)
+        {
+            u -= f;
+            f *= r * (ti - x) / (x + 1);
+            ++x;
+        }
+        k[i] = flip ? ti - x : x;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // END
@@ -30,6 +30,7 @@
 
 
 // STL headers.
+#include <fstream>
 #include <string>
 
 // STEPS headers.
@@ -61,6 +62,16 @@ public:
     /// \param seed Seed for the generator.
     void initialize(ulong const & seed);
 
+    /// Write the state of the generator, including the numbers left in
+    /// its buffer, to a checkpoint file.
+    ///
+    void checkpoint(std::fstream & cp_file);
+
+    /// Restore the state written by checkpoint(). The generator must be
+    /// of the same type and have the same buffer size.
+    ///
+    void restore(std::fstream & cp_file);
+
     /// Minimax inclusive range for the C++11 compatibility
     static constexpr uint min() { return 0; }
     static constexpr uint max() { return 0xffffffffu; }
@@ -127,6 +138,13 @@ public:
     ///
     uint getBinom(uint t, double p);
 
+    /// Get n binomially distributed numbers k[i] with parameters t[i] and
+    /// p[i]. Where the mean is small, every number is found by inversion
+    /// from a single uniform number drawn up front for the whole batch;
+    /// otherwise as by getBinom().
+    ///
+    void getBinoms(uint n, uint const * t, double const * p, uint * k);
+
 protected:
 
     uint                      * rBuffer;
@@ -141,6 +159,12 @@ protected:
     ///
     virtual void concreteFillBuffer(void) = 0;
 
+    /// Write and read the state of the concrete generator. Generators
+    /// without checkpointing support throw a NotImplErr.
+    ///
+    virtual void concreteCheckpoint(std::fstream & cp_file);
+    virtual void concreteRestore(std::fstream & cp_file);
+
 private:
 
     bool                        pInitialized;
@@ -71,6 +71,9 @@ public:
         EF_DV_BDSYS,
         EF_DV_SLUSYS,
         EF_DV_PETSC,
+        EF_DV_DIST,
+        EF_DV_PCG,
+        EF_DV_CONDENSED,
     };
 
     /// Constructor
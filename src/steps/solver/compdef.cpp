@@ -69,6 +69,8 @@ ssolver::Compdef::Compdef(Statedef * sd, uint idx, steps::wm::Comp * c)
 , pReac_DEP_Spec(0)
 , pReac_LHS_Spec(0)
 , pReac_UPD_Spec(0)
+, pReac_LHS_Sparse()
+, pReac_UPD_Sparse()
 , pDiffsN(0)
 , pDiff_G2L(0)
 , pDiff_L2G(0)
@@ -290,6 +292,8 @@ void ssolver::Compdef::setup_indices(void)
                 pReac_UPD_Spec[aridx] = rdef->upd(si);
             }
         }
+        pReac_LHS_Sparse.build(pReac_LHS_Spec, pReacsN, pSpecsN);
+        pReac_UPD_Sparse.build(pReac_UPD_Spec, pReacsN, pSpecsN);
     }
 
     if (pDiffsN != 0)
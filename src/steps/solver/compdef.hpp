@@ -37,6 +37,7 @@
 #include "steps/common.h"
 #include "steps/solver/statedef.hpp"
 #include "steps/solver/api.hpp"
+#include "steps/solver/sparsestoich.hpp"
 #include "steps/geom/comp.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -227,6 +228,20 @@ public:
     /// \param rlidx Local index of the reaction.
     int * reac_upd_end(uint rlidx) const;
 
+    /// Return the non-zero entries of the lhs array of reaction specified
+    /// by local index argument.
+    ///
+    /// \param rlidx Local index of the reaction.
+    inline SparseStoich<uint>::Range reac_lhs_sparse(uint rlidx) const
+    { return pReac_LHS_Sparse[rlidx]; }
+
+    /// Return the non-zero entries of the update array of reaction
+    /// specified by local index argument.
+    ///
+    /// \param rlidx Local index of the reaction.
+    inline SparseStoich<int>::Range reac_upd_sparse(uint rlidx) const
+    { return pReac_UPD_Sparse[rlidx]; }
+
     /// Return the local index of species of reaction specified by
     /// local index argument.
     ///
@@ -391,6 +406,10 @@ private:
     uint                              * pReac_LHS_Spec;
     int                               * pReac_UPD_Spec;
 
+    // Non-zero entries of pReac_LHS_Spec and pReac_UPD_Spec.
+    SparseStoich<uint>                  pReac_LHS_Sparse;
+    SparseStoich<int>                   pReac_UPD_Sparse;
+
     ////////////////////////////////////////////////////////////////////////
     // DATA: DIFFUSION RULES
     ////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,616 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+// STL headers.
+#include <cassert>
+#include <cstring>
+#include <sstream>
+
+// POSIX headers.
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/solver/cpfile.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace ssolver = steps::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char CP_MAGIC[8] = {'\x89', 'S', 'T', 'E', 'P', 'S', 'C', 'P'};
+static const uint32_t CP_VERSION = 1;
+static const uint32_t CP_BYTE_ORDER = 0x01020304;
+
+// Size of the write buffer.
+static const uint CP_BUFSIZE = 1 << 22;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// FNV-1a over 8-byte words, followed by the remaining bytes.
+static uint64_t cp_checksum(void const * data, uint64_t nbytes)
+{
+    unsigned char const * p = static_cast<unsigned char const *>(data);
+    uint64_t h = 0xcbf29ce484222325ull;
+    uint64_t nwords = nbytes / 8;
+    for (uint64_t i = 0; i < nwords; ++i)
+    {
+        uint64_t w;
+        std::memcpy(&w, p + 8 * i, 8);
+        h ^= w;
+        h *= 0x100000001b3ull;
+    }
+    for (uint64_t i = 8 * nwords; i < nbytes; ++i)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPColumns::clear(void)
+{
+    counts.clear();
+    flags.clear();
+    ints.clear();
+    reals.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPIndexEntry ssolver::CPColumns::entry(uint64_t idx) const
+{
+    CPIndexEntry e;
+    e.idx = idx;
+    e.offsets[CP_COLUMN_COUNTS] = counts.size();
+    e.offsets[CP_COLUMN_FLAGS] = flags.size();
+    e.offsets[CP_COLUMN_INTS] = ints.size();
+    e.offsets[CP_COLUMN_REALS] = reals.size();
+    return e;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPWriter::CPWriter(std::string const & file_name,
+                            uint64_t model_fp, uint64_t mesh_fp)
+: pFile()
+, pBuffer(CP_BUFSIZE)
+, pBlocks()
+, pHeader()
+, pPos(0)
+, pInStream(false)
+{
+    pFile.rdbuf()->pubsetbuf(pBuffer.data(), pBuffer.size());
+    pFile.open(file_name.c_str(), std::fstream::in | std::fstream::out |
+        std::fstream::binary | std::fstream::trunc);
+    if (pFile.is_open() == false)
+    {
+        std::ostringstream os;
+        os << "Cannot open checkpoint file " << file_name << " for writing.";
+        throw steps::ArgErr(os.str());
+    }
+
+    std::memset(&pHeader, 0, sizeof(CPHeader));
+    std::memcpy(pHeader.magic, CP_MAGIC, sizeof(CP_MAGIC));
+    pHeader.version = CP_VERSION;
+    pHeader.byteOrder = CP_BYTE_ORDER;
+    pHeader.modelFingerprint = model_fp;
+    pHeader.meshFingerprint = mesh_fp;
+
+    // The table offset stays 0 until close(), marking the file as
+    // incomplete.
+    pFile.write(reinterpret_cast<char const *>(&pHeader), sizeof(CPHeader));
+    pPos = sizeof(CPHeader);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPWriter::~CPWriter(void)
+{
+    if (pFile.is_open()) pFile.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPWriter::write(uint section, CPColumns const & cols)
+{
+    write(section + CP_COLUMN_COUNTS, cols.counts);
+    write(section + CP_COLUMN_FLAGS, cols.flags);
+    write(section + CP_COLUMN_INTS, cols.ints);
+    write(section + CP_COLUMN_REALS, cols.reals);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::fstream & ssolver::CPWriter::beginStream(uint id)
+{
+    assert(pInStream == false);
+    _align();
+
+    CPBlockInfo info;
+    info.id = id;
+    info.elemSize = 1;
+    info.offset = pPos;
+    info.count = 0;
+    info.checksum = 0;
+    pBlocks.push_back(info);
+
+    pInStream = true;
+    return pFile;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPWriter::endStream(void)
+{
+    assert(pInStream == true);
+    pInStream = false;
+
+    CPBlockInfo & info = pBlocks.back();
+    uint64_t end = pFile.tellp();
+    info.count = end - info.offset;
+
+    // Read the block back for its checksum; the stream layout blocks are
+    // small compared to the columns.
+    std::vector<char> data(info.count);
+    pFile.seekg(info.offset);
+    pFile.read(data.data(), info.count);
+    pFile.seekp(end);
+    info.checksum = cp_checksum(data.data(), info.count);
+    pPos = end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPWriter::close(void)
+{
+    assert(pInStream == false);
+    _align();
+
+    pHeader.tableOffset = pPos;
+    pHeader.nblocks = pBlocks.size();
+    pFile.write(reinterpret_cast<char const *>(pBlocks.data()),
+                sizeof(CPBlockInfo) * pBlocks.size());
+    pPos += sizeof(CPBlockInfo) * pBlocks.size();
+    pHeader.fileSize = pPos;
+
+    pFile.seekp(0);
+    pFile.write(reinterpret_cast<char const *>(&pHeader), sizeof(CPHeader));
+    pFile.close();
+
+    if (pFile.fail())
+    {
+        std::ostringstream os;
+        os << "Error while writing checkpoint file.";
+        throw steps::ArgErr(os.str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPWriter::_write(uint id, uint elem_size, void const * data, uint64_t n)
+{
+    assert(pInStream == false);
+    _align();
+
+    uint64_t nbytes = n * elem_size;
+    CPBlockInfo info;
+    info.id = id;
+    info.elemSize = elem_size;
+    info.offset = pPos;
+    info.count = n;
+    info.checksum = cp_checksum(data, nbytes);
+    pBlocks.push_back(info);
+
+    pFile.write(static_cast<char const *>(data), nbytes);
+    pPos += nbytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPWriter::_align(void)
+{
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint pad = (8 - pPos % 8) % 8;
+    if (pad == 0) return;
+    pFile.write(zeros, pad);
+    pPos += pad;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPReader::CPReader(std::string const & file_name)
+: pFileName(file_name)
+, pData(0)
+, pSize(0)
+, pHeader(0)
+, pTable(0)
+, pVerified()
+, pStream()
+{
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::ostringstream os;
+        os << "Cannot open checkpoint file " << file_name << ".";
+        throw steps::ArgErr(os.str());
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CPHeader)))
+    {
+        ::close(fd);
+        std::ostringstream os;
+        os << "Checkpoint file " << file_name << " is truncated.";
+        throw steps::ArgErr(os.str());
+    }
+    pSize = st.st_size;
+    void * addr = mmap(0, pSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        std::ostringstream os;
+        os << "Cannot map checkpoint file " << file_name << ".";
+        throw steps::ArgErr(os.str());
+    }
+    pData = static_cast<char const *>(addr);
+    pHeader = reinterpret_cast<CPHeader const *>(pData);
+
+    std::ostringstream os;
+    if (std::memcmp(pHeader->magic, CP_MAGIC, sizeof(CP_MAGIC)) != 0)
+        os << "File " << file_name << " is not a binary checkpoint.";
+    else if (pHeader->byteOrder != CP_BYTE_ORDER)
+        os << "Checkpoint file " << file_name << " was written on a machine with a different byte order.";
+    else if (pHeader->version > CP_VERSION)
+        os << "Checkpoint file " << file_name << " was written by a newer version (format " << pHeader->version << ").";
+    else if (pHeader->tableOffset == 0)
+        os << "Checkpoint file " << file_name << " is incomplete.";
+    else if (pHeader->fileSize != pSize || pHeader->tableOffset % 8 != 0
+             || pHeader->tableOffset + pHeader->nblocks * sizeof(CPBlockInfo) > pSize)
+        os << "Checkpoint file " << file_name << " is truncated.";
+    else
+    {
+        pTable = reinterpret_cast<CPBlockInfo const *>(pData + pHeader->tableOffset);
+        for (uint64_t b = 0; b < pHeader->nblocks; ++b)
+        {
+            CPBlockInfo const & info = pTable[b];
+            if (info.elemSize == 0 || info.offset % 8 != 0
+                || info.offset + info.count * info.elemSize > pHeader->tableOffset)
+            {
+                os << "Checkpoint file " << file_name << " has a corrupt block table.";
+                break;
+            }
+        }
+    }
+    if (os.str().empty() == false)
+    {
+        munmap(const_cast<char *>(pData), pSize);
+        throw steps::ArgErr(os.str());
+    }
+
+    pVerified.assign(pHeader->nblocks, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPReader::~CPReader(void)
+{
+    if (pStream.is_open()) pStream.close();
+    munmap(const_cast<char *>(pData), pSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ssolver::CPReader::isCPFile(std::string const & file_name)
+{
+    std::ifstream file(file_name.c_str(), std::ifstream::binary);
+    char magic[sizeof(CP_MAGIC)];
+    file.read(magic, sizeof(CP_MAGIC));
+    return file.good() && std::memcmp(magic, CP_MAGIC, sizeof(CP_MAGIC)) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPReader::checkFingerprints(uint64_t model_fp, uint64_t mesh_fp) const
+{
+    if (pHeader->modelFingerprint != model_fp)
+    {
+        std::ostringstream os;
+        os << "Checkpoint file " << pFileName << " was written for a different model.";
+        throw steps::ArgErr(os.str());
+    }
+    if (pHeader->meshFingerprint != mesh_fp)
+    {
+        std::ostringstream os;
+        os << "Checkpoint file " << pFileName << " was written for a different mesh.";
+        throw steps::ArgErr(os.str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPReader::verify(void) const
+{
+    for (uint64_t b = 0; b < pHeader->nblocks; ++b) _verify(b);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPReader::checkColumns(uint section, CPColumns const & cols) const
+{
+    uint64_t sizes[CP_NCOLUMNS] = {cols.counts.size(), cols.flags.size(),
+                                   cols.ints.size(), cols.reals.size()};
+    for (uint c = 0; c < CP_NCOLUMNS; ++c)
+        if (_info(section + c).count != sizes[c]) _mismatch(section + c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ssolver::CPReader::has(uint id) const
+{
+    for (uint64_t b = 0; b < pHeader->nblocks; ++b)
+        if (pTable[b].id == id) return true;
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::fstream & ssolver::CPReader::stream(uint id)
+{
+    uint64_t n = 0;
+    _block(id, 1, n);
+
+    if (pStream.is_open() == false)
+        pStream.open(pFileName.c_str(), std::fstream::in | std::fstream::binary);
+    pStream.clear();
+    pStream.seekg(_info(id).offset);
+    return pStream;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void const * ssolver::CPReader::_block(uint id, uint elem_size, uint64_t & n) const
+{
+    CPBlockInfo const & info = _info(id);
+    if (info.elemSize != elem_size) _mismatch(id);
+
+    _verify(&info - pTable);
+
+    n = info.count;
+    return pData + info.offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPReader::_verify(uint64_t b) const
+{
+    if (pVerified[b]) return;
+
+    CPBlockInfo const & info = pTable[b];
+    if (cp_checksum(pData + info.offset, info.count * info.elemSize) != info.checksum)
+    {
+        std::ostringstream os;
+        os << "Checkpoint file " << pFileName << " is corrupt (block " << info.id << ").";
+        throw steps::ArgErr(os.str());
+    }
+    pVerified[b] = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPBlockInfo const & ssolver::CPReader::_info(uint id) const
+{
+    for (uint64_t b = 0; b < pHeader->nblocks; ++b)
+        if (pTable[b].id == id) return pTable[b];
+
+    std::ostringstream os;
+    os << "Checkpoint file " << pFileName << " has no block " << id << ".";
+    throw steps::ArgErr(os.str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPReader::_mismatch(uint id) const
+{
+    std::ostringstream os;
+    os << "Block " << id << " of checkpoint file " << pFileName;
+    os << " does not match the simulation.";
+    throw steps::ArgErr(os.str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPCursor::CPCursor(CPReader const & reader, uint section)
+: pReader(&reader)
+, pSection(section)
+, pCounts()
+, pFlags()
+, pInts()
+, pReals()
+, pIndex(0)
+, pIndexSize(0)
+{
+    pCounts.begin = reader.block<uint>(section + CP_COLUMN_COUNTS, pCounts.size);
+    pFlags.begin = reader.block<uint>(section + CP_COLUMN_FLAGS, pFlags.size);
+    pInts.begin = reader.block<int>(section + CP_COLUMN_INTS, pInts.size);
+    pReals.begin = reader.block<double>(section + CP_COLUMN_REALS, pReals.size);
+    _range(pCounts, 0, pCounts.size);
+    _range(pFlags, 0, pFlags.size);
+    _range(pInts, 0, pInts.size);
+    _range(pReals, 0, pReals.size);
+
+    if (reader.has(section + CP_COLUMN_INDEX))
+    {
+        pIndex = reader.block<CPIndexEntry>(section + CP_COLUMN_INDEX, pIndexSize);
+        if (pIndexSize == 0) reader._mismatch(section + CP_COLUMN_INDEX);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::CPCursor::CPCursor(CPColumns const & cols)
+: pReader(0)
+, pSection(0)
+, pCounts()
+, pFlags()
+, pInts()
+, pReals()
+, pIndex(0)
+, pIndexSize(0)
+{
+    pCounts.begin = cols.counts.data();
+    pCounts.size = cols.counts.size();
+    pFlags.begin = cols.flags.data();
+    pFlags.size = cols.flags.size();
+    pInts.begin = cols.ints.data();
+    pInts.size = cols.ints.size();
+    pReals.begin = cols.reals.data();
+    pReals.size = cols.reals.size();
+    _range(pCounts, 0, pCounts.size);
+    _range(pFlags, 0, pFlags.size);
+    _range(pInts, 0, pInts.size);
+    _range(pReals, 0, pReals.size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::counts(uint * dst, uint n)
+{
+    uint const * src = _next(pCounts, n, CP_COLUMN_COUNTS);
+    std::copy(src, src + n, dst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::flags(uint * dst, uint n)
+{
+    uint const * src = _next(pFlags, n, CP_COLUMN_FLAGS);
+    std::copy(src, src + n, dst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::ints(int * dst, uint n)
+{
+    int const * src = _next(pInts, n, CP_COLUMN_INTS);
+    std::copy(src, src + n, dst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::reals(double * dst, uint n)
+{
+    double const * src = _next(pReals, n, CP_COLUMN_REALS);
+    std::copy(src, src + n, dst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ssolver::CPCursor::seek(uint64_t idx)
+{
+    if (pIndex == 0)
+    {
+        std::ostringstream os;
+        os << "Checkpoint section " << pSection << " has no object index.";
+        throw steps::ArgErr(os.str());
+    }
+
+    // The last entry only closes the table.
+    CPIndexEntry const * last = pIndex + pIndexSize - 1;
+    CPIndexEntry const * e = std::lower_bound(pIndex, last, idx,
+        [](CPIndexEntry const & a, uint64_t b) { return a.idx < b; });
+    if (e == last || e->idx != idx) return false;
+
+    CPIndexEntry const * next = e + 1;
+    _range(pCounts, e->offsets[CP_COLUMN_COUNTS], next->offsets[CP_COLUMN_COUNTS]);
+    _range(pFlags, e->offsets[CP_COLUMN_FLAGS], next->offsets[CP_COLUMN_FLAGS]);
+    _range(pInts, e->offsets[CP_COLUMN_INTS], next->offsets[CP_COLUMN_INTS]);
+    _range(pReals, e->offsets[CP_COLUMN_REALS], next->offsets[CP_COLUMN_REALS]);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::finish(void) const
+{
+    if (pCounts.cur != pCounts.end || pFlags.cur != pFlags.end
+        || pInts.cur != pInts.end || pReals.cur != pReals.end)
+    {
+        _mismatch(pSection);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::checkColumns(CPColumns const & cols) const
+{
+    if (static_cast<uint64_t>(pCounts.end - pCounts.cur) != cols.counts.size()
+        || static_cast<uint64_t>(pFlags.end - pFlags.cur) != cols.flags.size()
+        || static_cast<uint64_t>(pInts.end - pInts.cur) != cols.ints.size()
+        || static_cast<uint64_t>(pReals.end - pReals.cur) != cols.reals.size())
+    {
+        _mismatch(pSection);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void ssolver::CPCursor::_range(Column<T> & col, uint64_t first, uint64_t last) const
+{
+    if (first > last || last > col.size) _mismatch(pSection + CP_COLUMN_INDEX);
+    col.cur = col.begin + first;
+    col.end = col.begin + last;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::_truncated(uint column) const
+{
+    _mismatch(pSection + column);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::CPCursor::_mismatch(uint id) const
+{
+    if (pReader != 0) pReader->_mismatch(id);
+
+    std::ostringstream os;
+    os << "Column " << id << " of the state in memory does not match the simulation.";
+    throw steps::ProgErr(os.str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
@@ -0,0 +1,387 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+#ifndef STEPS_SOLVER_CPFILE_HPP
+#define STEPS_SOLVER_CPFILE_HPP 1
+
+// STL headers.
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace solver {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Sections of a binary checkpoint holding per-object columns. The block
+/// of column c of section s has identifier s + c.
+enum CPSection
+{
+    CP_SECTION_WMVOL = 0x10,
+    CP_SECTION_TET = 0x20,
+    CP_SECTION_TRI = 0x30,
+    CP_SECTION_KPROC = 0x40
+};
+
+/// Columns of a section: pool counts (or kproc extents), pool flags (or
+/// kproc flags), and any further integer and real valued state.
+enum CPColumn
+{
+    CP_COLUMN_COUNTS = 0,
+    CP_COLUMN_FLAGS,
+    CP_COLUMN_INTS,
+    CP_COLUMN_REALS,
+    CP_NCOLUMNS,
+    // Distributed checkpoints only: the CPIndexEntry table of a section in
+    // each part file, and the rank that wrote each object in the index
+    // file, or CP_NO_OWNER.
+    CP_COLUMN_INDEX = CP_NCOLUMNS,
+    CP_COLUMN_OWNERS
+};
+
+/// Owner of an object that is not part of a distributed checkpoint.
+const uint CP_NO_OWNER = 0xffffffff;
+
+/// Other blocks of a binary checkpoint.
+enum CPBlock
+{
+    // State definition and EField, in the stream layout of their
+    // checkpoint() methods.
+    CP_BLOCK_STATEDEF = 0x01,
+    CP_BLOCK_EFIELD = 0x02,
+    // Scalars of the solver.
+    CP_BLOCK_SOLVER_UINTS = 0x03,
+    CP_BLOCK_SOLVER_REALS = 0x04,
+    // Random number generator, in the stream layout of RNG::checkpoint().
+    CP_BLOCK_RNG = 0x05,
+    // Potential of every EField vertex, by local vertex index.
+    CP_BLOCK_EFIELD_V = 0x06,
+    // Specific membrane capacitance of every EField vertex, by local
+    // vertex index; with CP_BLOCK_EFIELD_V the whole state of a
+    // distributed EField, which has no CP_BLOCK_EFIELD.
+    CP_BLOCK_EFIELD_CAPAC = 0x07,
+    // Volume resistivity of the EField conduction volume.
+    CP_BLOCK_EFIELD_VOLRES = 0x08,
+    // Composition-rejection data, by schedule index.
+    CP_BLOCK_CR_RECORDED = 0x50,
+    CP_BLOCK_CR_POW,
+    CP_BLOCK_CR_POS,
+    CP_BLOCK_CR_RATE,
+    // Composition-rejection groups: (capacity, size) and (max, sum) of
+    // each group, negative groups first, and their concatenated indices.
+    // The sum trees over the groups are rebuilt from the group sums.
+    CP_BLOCK_CR_GROUP_SIZES,
+    CP_BLOCK_CR_GROUP_SUMS,
+    CP_BLOCK_CR_GROUP_INDICES
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// File header of a binary checkpoint.
+struct CPHeader
+{
+    char                                magic[8];
+    uint32_t                            version;
+    // CP_BYTE_ORDER as written by the producing machine.
+    uint32_t                            byteOrder;
+    uint64_t                            modelFingerprint;
+    uint64_t                            meshFingerprint;
+    uint64_t                            tableOffset;
+    uint64_t                            nblocks;
+    uint64_t                            fileSize;
+    uint64_t                            reserved;
+};
+
+/// Entry of the block table at the end of a binary checkpoint.
+struct CPBlockInfo
+{
+    uint32_t                            id;
+    // Size of one element, or 1 for blocks in stream layout.
+    uint32_t                            elemSize;
+    uint64_t                            offset;
+    uint64_t                            count;
+    uint64_t                            checksum;
+};
+
+/// Entry of the object index of a section in a distributed checkpoint:
+/// the global index of an object and the start of its state in each
+/// column. Entries are sorted by index and closed by an entry holding
+/// the column sizes.
+struct CPIndexEntry
+{
+    uint64_t                            idx;
+    uint64_t                            offsets[CP_NCOLUMNS];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Per-object state of one section, appended object by object in a fixed
+/// order by the checkpoint methods of the solver objects.
+struct CPColumns
+{
+    std::vector<uint>                   counts;
+    std::vector<uint>                   flags;
+    std::vector<int>                    ints;
+    std::vector<double>                 reals;
+
+    void clear(void);
+
+    /// Index entry of object idx if its state is appended next.
+    CPIndexEntry entry(uint64_t idx) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writer of binary checkpoints.
+///
+/// The file starts with a CPHeader, followed by the blocks, each aligned
+/// to 8 bytes, and ends with the table of CPBlockInfo entries. Blocks are
+/// written in one pass through a large buffer; the header is completed
+/// by close().
+///
+class CPWriter
+{
+
+public:
+
+    CPWriter(std::string const & file_name, uint64_t model_fp, uint64_t mesh_fp);
+    ~CPWriter(void);
+
+    /// Write n elements of data as block id.
+    template <typename T>
+    void write(uint id, T const * data, uint64_t n)
+    { _write(id, sizeof(T), data, n); }
+
+    template <typename T>
+    void write(uint id, std::vector<T> const & data)
+    { _write(id, sizeof(T), data.data(), data.size()); }
+
+    /// Write the columns of a section as one block each.
+    void write(uint section, CPColumns const & cols);
+
+    /// Start a block in stream layout and return the stream to write it
+    /// to; endStream() completes it.
+    std::fstream & beginStream(uint id);
+    void endStream(void);
+
+    /// Write the block table and the header, and close the file.
+    void close(void);
+
+private:
+
+    void _write(uint id, uint elem_size, void const * data, uint64_t n);
+    void _align(void);
+
+    std::fstream                        pFile;
+    std::vector<char>                   pBuffer;
+    std::vector<CPBlockInfo>            pBlocks;
+    CPHeader                            pHeader;
+    uint64_t                            pPos;
+    bool                                pInStream;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Reader of binary checkpoints.
+///
+/// The file is mapped into memory; blocks are accessed in place and
+/// their checksums verified on first access. Blocks in stream layout are
+/// read through a separate stream.
+///
+class CPReader
+{
+
+public:
+
+    /// Map the file, checking the header and the block table.
+    CPReader(std::string const & file_name);
+    ~CPReader(void);
+
+    /// Whether the file starts like a binary checkpoint; older
+    /// checkpoints are plain streams without a header.
+    static bool isCPFile(std::string const & file_name);
+
+    /// Throw an ArgErr if the file was written for a different model or
+    /// mesh.
+    void checkFingerprints(uint64_t model_fp, uint64_t mesh_fp) const;
+
+    /// Verify the checksums of all blocks, so that a restore can fail
+    /// before it changes any state.
+    void verify(void) const;
+
+    /// Throw an ArgErr unless the columns of section hold as many
+    /// elements as cols, e.g. the columns the simulation would write.
+    void checkColumns(uint section, CPColumns const & cols) const;
+
+    inline CPHeader const & header(void) const
+    { return *pHeader; }
+
+    bool has(uint id) const;
+
+    /// Elements of block id, checking the element size; n is set to
+    /// their number.
+    template <typename T>
+    T const * block(uint id, uint64_t & n) const
+    { return static_cast<T const *>(_block(id, sizeof(T), n)); }
+
+    /// Block id read into a vector, which must already have the size of
+    /// the block.
+    template <typename T>
+    void read(uint id, std::vector<T> & data) const
+    {
+        uint64_t n = 0;
+        T const * src = block<T>(id, n);
+        if (n != data.size()) _mismatch(id);
+        std::copy(src, src + n, data.begin());
+    }
+
+    /// Stream positioned at the start of block id, which must have been
+    /// written in stream layout.
+    std::fstream & stream(uint id);
+
+private:
+
+    friend class CPCursor;
+
+    void const * _block(uint id, uint elem_size, uint64_t & n) const;
+    CPBlockInfo const & _info(uint id) const;
+    void _verify(uint64_t b) const;
+    void _mismatch(uint id) const;
+
+    std::string                         pFileName;
+    char const                        * pData;
+    uint64_t                            pSize;
+    CPHeader const                    * pHeader;
+    CPBlockInfo const                 * pTable;
+    mutable std::vector<bool>           pVerified;
+    std::fstream                        pStream;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Sequential reader of the columns of one section, for the restore
+/// methods of the solver objects.
+class CPCursor
+{
+
+public:
+
+    CPCursor(CPReader const & reader, uint section);
+
+    /// Cursor over columns in memory, e.g. the state of elements moved
+    /// between ranks. The columns must outlive the cursor.
+    explicit CPCursor(CPColumns const & cols);
+
+    inline uint count(void)
+    { return *_next(pCounts, 1, CP_COLUMN_COUNTS); }
+
+    inline uint flag(void)
+    { return *_next(pFlags, 1, CP_COLUMN_FLAGS); }
+
+    inline int integer(void)
+    { return *_next(pInts, 1, CP_COLUMN_INTS); }
+
+    inline double real(void)
+    { return *_next(pReals, 1, CP_COLUMN_REALS); }
+
+    void counts(uint * dst, uint n);
+    void flags(uint * dst, uint n);
+    void ints(int * dst, uint n);
+    void reals(double * dst, uint n);
+
+    /// Restrict the cursor to the state of object idx, looked up in the
+    /// index of the section. Returns false if the object is not in the
+    /// file.
+    bool seek(uint64_t idx);
+
+    /// Throw an ArgErr unless all columns have been read completely.
+    void finish(void) const;
+
+    /// Throw an ArgErr unless the columns left to read hold as many
+    /// elements as cols, e.g. the columns of the object sought.
+    void checkColumns(CPColumns const & cols) const;
+
+private:
+
+    template <typename T>
+    struct Column
+    {
+        T const                       * begin;
+        T const                       * cur;
+        T const                       * end;
+        uint64_t                        size;
+    };
+
+    template <typename T>
+    inline T const * _next(Column<T> & col, uint n, uint column)
+    {
+        if (static_cast<uint64_t>(col.end - col.cur) < n) _truncated(column);
+        T const * p = col.cur;
+        col.cur += n;
+        return p;
+    }
+
+    template <typename T>
+    void _range(Column<T> & col, uint64_t first, uint64_t last) const;
+
+    void _truncated(uint column) const;
+    void _mismatch(uint id) const;
+
+    // Reader of the section, or 0 for columns in memory.
+    CPReader const                    * pReader;
+    uint                                pSection;
+    Column<uint>                        pCounts;
+    Column<uint>                        pFlags;
+    Column<int>                         pInts;
+    Column<double>                      pReals;
+
+    // Index of the section, or 0 if the file has none.
+    CPIndexEntry const                * pIndex;
+    uint64_t                            pIndexSize;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_SOLVER_CPFILE_HPP
+
+// END
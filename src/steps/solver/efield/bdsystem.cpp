@@ -125,12 +125,23 @@ void BDSystem::solve()
         lk += h;
     }
 
+    resolve();
+}
+
+void BDSystem::resolve()
+{
+    int n = (int)pN;
+    int h = (int)pHalfBW;
+    int w = 2*h+1;
+    double *a = pA.data(); // holds U from LU decomposition
+    double *l = h>0?&pL[0]:0;
+
     // 2. Forward substitution, b into x.
     std::copy(pb.begin(),pb.end(),px.begin());
     double *x = &px[0];
     double *xk = x;
-    lk = l;
-    ak = a;
+    double *lk = l;
+    double *ak = a;
     for (int k = 0; k < n; ++k)
     {
         int i = pp[k];
@@ -101,6 +101,9 @@ public:
 
     void solve(); // destructive: overwrites pA
 
+    // solve for new b with the LU-decomposition of the last solve()
+    void resolve();
+
 private:
     size_t pN,pHalfBW;
 
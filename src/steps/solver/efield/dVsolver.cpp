@@ -52,10 +52,13 @@ void dVSolverBase::initMesh(TetMesh *mesh) {
 
     pTriCur.assign(pNTris, 0.0);
     pTriCurClamp.assign(pNTris, 0.0);
+
+    pMatrixValid = false;
 }
 
 void dVSolverBase::setSurfaceConductance(double g_surface, double v_rev) {
     pVExt = v_rev;
+    pMatrixValid = false;
     if (!pMesh) return;
 
     for (int i = 0; i < pNVerts; ++i) {
@@ -31,6 +31,7 @@
 // STL headers.
 #include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 // STEPS headers.
@@ -45,9 +46,45 @@ namespace steps {
 namespace solver {
 namespace efield {
 
+/// Linear systems factorised for the last few time steps, the most
+/// recently used first, so that adaptive stepping between a few step
+/// lengths does not factorise again at every change.
+template <typename LinSys>
+class DTSystemCache {
+public:
+    explicit DTSystemCache(uint size = 4): pSize(size) {}
+
+    /// Return the system for dt, and whether it already holds the
+    /// factorised matrix for dt. Otherwise it is a new one from make(),
+    /// or the least recently used one once the cache is full.
+    template <typename Make>
+    LinSys * get(double dt, bool & factorised, Make make) {
+        auto e = std::find_if(pSystems.begin(), pSystems.end(),
+                              [dt](Entry const & x) { return x.first == dt; });
+        factorised = (e != pSystems.end());
+        if (!factorised) {
+            if (pSystems.size() < pSize)
+                pSystems.push_back(Entry(dt, std::unique_ptr<LinSys>(make())));
+            e = pSystems.end() - 1;
+            e->first = dt;
+        }
+        std::rotate(pSystems.begin(), e, e + 1);
+        return pSystems.front().second.get();
+    }
+
+    /// Discard every factorisation.
+    void clear(void) { pSystems.clear(); }
+
+private:
+    typedef std::pair<double, std::unique_ptr<LinSys>> Entry;
+
+    uint                        pSize;
+    std::vector<Entry>          pSystems;
+};
+
 class dVSolverBase: public EFieldSolver {
 public:
-    dVSolverBase(): pMesh(0), pNVerts(0), pNTris(0) {}
+    dVSolverBase(): pMesh(0), pNVerts(0), pNTris(0), pMatrixValid(false), pMatrixDT(0.0), pNFactorisations(0) {}
 
     /** Initialize state with given mesh */
     void initMesh(TetMesh *mesh) override;
@@ -70,7 +107,10 @@ public:
     bool getClamped(int i) const override { return pVertexClamp[i]; }
 
     /** Set voltage clamped status for vertex i */
-    void setClamped(int i, bool clamped) override { pVertexClamp[i] = clamped; }
+    void setClamped(int i, bool clamped) override {
+        if (static_cast<bool>(pVertexClamp[i]) != clamped) pMatrixValid = false;
+        pVertexClamp[i] = clamped;
+    }
 
     /** Get current through triangle i */
     double getTriI(int i) const override { return -pTriCur[i]; }
@@ -84,8 +124,19 @@ public:
     /** Set additional current injection for area associated with vertex i to c (pA) */
     void setVertIClamp(int i, double c) override { pVertCurClamp[i] = -c; }
 
+    /** Force a new assembly and factorisation at the next step */
+    void invalidateMatrix() override { pMatrixValid = false; }
+
+    /** Number of times the matrix was assembled and factorised */
+    ulong countFactorisations(void) const { return pNFactorisations; }
+
 protected:
-    /// Generic populate and solve
+    /// Generic populate and solve.
+    ///
+    /// The matrix depends only on dt, the capacitances, leak conductances,
+    /// coupling constants and clamp flags; while these are unchanged only
+    /// the right hand side is assembled and the factorisation of the last
+    /// solve() is reused through resolve().
     template <typename LinSysImpl>
     void _advance(LinSysImpl *L, double dt) {
         // Add up current clamp contributions
@@ -104,14 +155,16 @@ protected:
 
         double oodt = 1.0/dt;
 
-        A.zero();
+        bool refactor = !pMatrixValid || dt != pMatrixDT;
+
+        if (refactor) A.zero();
         for (uint i = 0; i < pNVerts; ++i) {
             VertexElement * ve = pMesh->getVertex(i);
             int ind = ve->getIDX();
 
             if (pVertexClamp[ind]) {
                 b.set(ind,0);
-                A.set(ind,ind,1.0);
+                if (refactor) A.set(ind,ind,1.0);
             }
             else {
                 double rhs = pVertCur[ind] + pGExt[ind] * (pVExt - pV[ind]);
@@ -123,14 +176,20 @@ protected:
 
                     rhs += cc * (pV[k] - pV[ind]);
                     Aii += cc;
-                    A.set(ind,k,-cc);
+                    if (refactor) A.set(ind,k,-cc);
                 }
                 b.set(ind,rhs);
-                A.set(ind,ind,Aii);
+                if (refactor) A.set(ind,ind,Aii);
             }
         }
-        
-        L->solve();
+
+        if (refactor) {
+            L->solve();
+            pMatrixValid = true;
+            pMatrixDT = dt;
+            ++pNFactorisations;
+        }
+        else L->resolve();
 
         const typename LinSysImpl::vector_type DV=L->x();
         for (uint i = 0; i < pNVerts; ++i)
@@ -175,21 +234,40 @@ protected:
 
     /// Current clamp through each vertex (adds to any triangle clamps.)
     std::vector<double>         pVertCurClamp;
+
+    /// Whether the linear system holds the factorised matrix for pMatrixDT.
+    bool                        pMatrixValid;
+
+    /// Time step of the factorised matrix.
+    double                      pMatrixDT;
+
+    /// Number of assemblies and factorisations.
+    ulong                       pNFactorisations;
 };
     
 class dVSolverBanded: public dVSolverBase {
 public:
+    dVSolverBanded(): pHalfBW(0) {}
+
     void initMesh(TetMesh *mesh) override {
         dVSolverBase::initMesh(mesh);
-        pBDSys.reset(new BDSystem(pNVerts, meshHalfBW(mesh)));
+        pHalfBW = meshHalfBW(mesh);
+        pBDSys.clear();
     }
 
     void advance(double dt) override {
-        _advance(pBDSys.get(), dt);
+        // Any change to the matrix but dt invalidates every factorisation.
+        if (!pMatrixValid) pBDSys.clear();
+        bool factorised;
+        BDSystem * sys = pBDSys.get(dt, factorised, [this]() { return new BDSystem(pNVerts, pHalfBW); });
+        pMatrixValid = factorised;
+        pMatrixDT = dt;
+        _advance(sys, dt);
     }
 
 private:
-    std::unique_ptr<BDSystem>  pBDSys;
+    int                         pHalfBW;
+    DTSystemCache<BDSystem>     pBDSys;
 };
 
 
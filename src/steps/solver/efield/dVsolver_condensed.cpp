@@ -0,0 +1,337 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/solver/efield/dVsolver_condensed.hpp"
+#include "steps/solver/efield/tetmesh.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+namespace {
+
+// Size, relative to the conductances of the two vertices, below which
+// couplings of the Schur complement are dropped.
+const double SCHUR_DROP_TOL = 1.0e-6;
+
+}
+
+void dVSolverCondensed::initMesh(TetMesh *mesh) {
+    dVSolverBase::initMesh(mesh);
+    pInterior.assign(pNVerts, 0);
+    pLocal.assign(pNVerts, 0);
+    pMembVerts.clear();
+    pInteriorVerts.clear();
+    pNMemb = 0;
+    pNInterior = 0;
+    pInteriorSys.reset();
+    pSchurSystems.clear();
+    pSchurSys = 0;
+    pCorr.clear();
+    pCorrDiag.clear();
+    pHalfBWSchur = 0;
+    pCondensedCC.clear();
+    pNCondensations = 0;
+    pInteriorStale = false;
+}
+
+void dVSolverCondensed::setPotential(double v) {
+    dVSolverBase::setPotential(v);
+    std::fill(pVInterior.begin(), pVInterior.end(), v);
+    pInteriorStale = false;
+}
+
+double dVSolverCondensed::getV(int i) const {
+    if (!pInterior[i]) return pV[i];
+    if (pInteriorStale) _reconstructInterior();
+    return pVInterior[pLocal[i]];
+}
+
+void dVSolverCondensed::setV(int i, double v) {
+    pV[i] = v;
+    if (pInterior[i]) pVInterior[pLocal[i]] = v;
+}
+
+bool dVSolverCondensed::_condensed(void) const {
+    if (pCondensedCC.empty()) return false;
+    uint n = 0;
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        uint ind = ve->getIDX();
+        bool interior = (ve->getSurfaceArea() == 0.0 && !pVertexClamp[ind]);
+        if (interior != static_cast<bool>(pInterior[ind])) return false;
+        for (uint j = 0; j < ve->getNCon(); ++j)
+            if (ve->getCC(j) != pCondensedCC[n++]) return false;
+    }
+    return true;
+}
+
+void dVSolverCondensed::_condense(void) {
+    // Potentials under the old split, to carry over.
+    std::vector<double> vold(pNVerts);
+    for (uint i = 0; i < pNVerts; ++i) vold[i] = getV(i);
+    pV.swap(vold);
+
+    // Vertices without membrane area and not clamped are interior.
+    pCondensedCC.clear();
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        uint ind = ve->getIDX();
+        pInterior[ind] = (ve->getSurfaceArea() == 0.0 && !pVertexClamp[ind]);
+        for (uint j = 0; j < ve->getNCon(); ++j) pCondensedCC.push_back(ve->getCC(j));
+    }
+    pMembVerts.clear();
+    pInteriorVerts.clear();
+    for (uint ind = 0; ind < pNVerts; ++ind) {
+        std::vector<uint> & verts = pInterior[ind] ? pInteriorVerts : pMembVerts;
+        pLocal[ind] = verts.size();
+        verts.push_back(ind);
+    }
+    pNMemb = pMembVerts.size();
+    pNInterior = pInteriorVerts.size();
+
+    pVInterior.resize(pNInterior);
+    for (uint p = 0; p < pNInterior; ++p) pVInterior[p] = pV[pInteriorVerts[p]];
+    pInteriorStale = false;
+    pInteriorCur.assign(pNInterior, 0.0);
+
+    // Bandwidths of K_II and of K_SS, and the conductance of every
+    // membrane vertex.
+    int halfbw_i = 0;
+    pHalfBWSchur = 0;
+    std::vector<double> gmemb(pNMemb, 0.0);
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        uint ind = ve->getIDX();
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint k = ve->nbrIdx(j);
+            if (!pInterior[ind]) gmemb[pLocal[ind]] += ve->getCC(j);
+            if (pInterior[ind] != pInterior[k]) continue;
+            int d = std::abs((int)pLocal[ind] - (int)pLocal[k]);
+            if (pInterior[ind]) halfbw_i = std::max(halfbw_i, d);
+            else pHalfBWSchur = std::max(pHalfBWSchur, d);
+        }
+    }
+
+    // K_II, factorised once.
+    pInteriorSys.reset(new BDSystem(pNInterior, halfbw_i));
+    BDMatrix & ki = pInteriorSys->A();
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        uint ind = ve->getIDX();
+        if (!pInterior[ind]) continue;
+        double kii = 0.0;
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint k = ve->nbrIdx(j);
+            kii += ve->getCC(j);
+            if (pInterior[k]) ki.set(pLocal[ind], pLocal[k], -ve->getCC(j));
+        }
+        ki.set(pLocal[ind], pLocal[ind], kii);
+    }
+    if (pNInterior != 0) {
+        pInteriorSys->b().zero();
+        pInteriorSys->solve();
+    }
+
+    // The columns of M_SI K_II^-1 M_IS. Through a connected interior every
+    // membrane vertex couples to every other, but the coupling decays with
+    // distance: those below SCHUR_DROP_TOL of the conductances of their two
+    // vertices are moved onto the diagonal, which keeps the rows summing
+    // to zero, so that currents are conserved, and the band of the Schur
+    // complement is what remains.
+    pCorr.assign(pNMemb, std::vector<std::pair<uint, double>>());
+    pCorrDiag.assign(pNMemb, 0.0);
+    std::vector<double> column(pNMemb, 0.0);
+    std::vector<uint> touched;
+    VVector & bi = pInteriorSys->b();
+    VVector const & yi = pInteriorSys->x();
+    for (uint col = 0; col < pNMemb; ++col) {
+        VertexElement * ve = pMesh->getVertex(pMembVerts[col]);
+        bi.zero();
+        bool coupled = false;
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint p = ve->nbrIdx(j);
+            if (!pInterior[p]) continue;
+            bi.set(pLocal[p], -ve->getCC(j));
+            coupled = true;
+        }
+        if (!coupled) continue;
+        pInteriorSys->resolve();
+
+        touched.clear();
+        for (uint p = 0; p < pNInterior; ++p) {
+            double y = yi[p];
+            if (y == 0.0) continue;
+            VertexElement * vp = pMesh->getVertex(pInteriorVerts[p]);
+            for (uint j = 0; j < vp->getNCon(); ++j) {
+                uint row = vp->nbrIdx(j);
+                if (pInterior[row]) continue;
+                uint lr = pLocal[row];
+                if (column[lr] == 0.0) touched.push_back(lr);
+                column[lr] += vp->getCC(j) * y;
+            }
+        }
+        for (uint lr: touched) {
+            if (lr == col || std::fabs(column[lr]) > SCHUR_DROP_TOL * std::sqrt(gmemb[lr] * gmemb[col])) {
+                pCorr[col].push_back(std::make_pair(lr, column[lr]));
+                pHalfBWSchur = std::max(pHalfBWSchur, std::abs((int)lr - (int)col));
+            }
+            else pCorrDiag[lr] += column[lr];
+            column[lr] = 0.0;
+        }
+    }
+    ++pNCondensations;
+}
+
+void dVSolverCondensed::_assembleSchur(BDSystem & sys, double dt) {
+    double oodt = 1.0/dt;
+
+    // M_SS, the matrix of the step restricted to the membrane vertices,
+    // less the correction.
+    BDMatrix & s = sys.A();
+    s.zero();
+    for (uint i = 0; i < pNMemb; ++i) {
+        uint ind = pMembVerts[i];
+        VertexElement * ve = pMesh->getVertex(ind);
+        if (pVertexClamp[ind]) {
+            s.set(i, i, 1.0);
+            continue;
+        }
+        double sii = ve->getCapacitance()*oodt + pGExt[ind] + pCorrDiag[i];
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint k = ve->nbrIdx(j);
+            sii += ve->getCC(j);
+            if (!pInterior[k]) s.set(i, pLocal[k], -ve->getCC(j));
+        }
+        s.set(i, i, sii);
+    }
+    for (uint col = 0; col < pNMemb; ++col)
+        for (auto const & e: pCorr[col])
+            if (!pVertexClamp[pMembVerts[e.first]]) s[e.first][col] += e.second;
+
+    sys.b().zero();
+    sys.solve();
+    ++pNFactorisations;
+}
+
+void dVSolverCondensed::_reconstructInterior(void) const {
+    // K_II V_I = I_I - K_IS V_S
+    VVector & bi = pInteriorSys->b();
+    for (uint p = 0; p < pNInterior; ++p) {
+        VertexElement * vp = pMesh->getVertex(pInteriorVerts[p]);
+        double rhs = pInteriorCur[p];
+        for (uint j = 0; j < vp->getNCon(); ++j) {
+            uint k = vp->nbrIdx(j);
+            if (!pInterior[k]) rhs += vp->getCC(j) * pV[k];
+        }
+        bi.set(p, rhs);
+    }
+    pInteriorSys->resolve();
+    for (uint p = 0; p < pNInterior; ++p) pVInterior[p] = pInteriorSys->x()[p];
+    pInteriorStale = false;
+}
+
+void dVSolverCondensed::advance(double dt) {
+    // Add up current clamp contributions
+    std::copy(pVertCurClamp.begin(), pVertCurClamp.end(), pVertCur.begin());
+    for (uint i = 0; i < pNTris; ++i) {
+        double c = (pTriCur[i] + pTriCurClamp[i]) / 3.0;
+
+        uint *triv = pMesh->getTriangle(i);
+        pVertCur[triv[0]] += c;
+        pVertCur[triv[1]] += c;
+        pVertCur[triv[2]] += c;
+    }
+
+    // Only the conductances and the split enter the condensation;
+    // capacitances, surface conductances and dt only the Schur systems.
+    if (!pMatrixValid) {
+        if (!_condensed()) _condense();
+        pSchurSystems.clear();
+        pMatrixValid = true;
+    }
+    bool factorised;
+    pSchurSys = pSchurSystems.get(dt, factorised, [this]() { return new BDSystem(pNMemb, pHalfBWSchur); });
+    if (!factorised) _assembleSchur(*pSchurSys, dt);
+    pMatrixDT = dt;
+
+    // The step for V rather than dV: the potentials of the interior
+    // before the step drop out.
+    double oodt = 1.0/dt;
+    VVector & bs = pSchurSys->b();
+    for (uint i = 0; i < pNMemb; ++i) {
+        uint ind = pMembVerts[i];
+        if (pVertexClamp[ind]) bs.set(i, pV[ind]);
+        else {
+            VertexElement * ve = pMesh->getVertex(ind);
+            bs.set(i, ve->getCapacitance()*oodt*pV[ind] + pVertCur[ind] + pGExt[ind]*pVExt);
+        }
+    }
+
+    // Less M_SI K_II^-1 I_I for currents injected in the interior.
+    bool interior_cur = false;
+    for (uint p = 0; p < pNInterior; ++p) {
+        pInteriorCur[p] = pVertCur[pInteriorVerts[p]];
+        interior_cur = interior_cur || pInteriorCur[p] != 0.0;
+    }
+    if (interior_cur) {
+        VVector & bi = pInteriorSys->b();
+        for (uint p = 0; p < pNInterior; ++p) bi.set(p, pInteriorCur[p]);
+        pInteriorSys->resolve();
+        VVector const & yi = pInteriorSys->x();
+        for (uint p = 0; p < pNInterior; ++p) {
+            VertexElement * vp = pMesh->getVertex(pInteriorVerts[p]);
+            for (uint j = 0; j < vp->getNCon(); ++j) {
+                uint k = vp->nbrIdx(j);
+                if (pInterior[k] || pVertexClamp[k]) continue;
+                bs[pLocal[k]] += vp->getCC(j) * yi[p];
+            }
+        }
+    }
+
+    pSchurSys->resolve();
+    VVector const & vs = pSchurSys->x();
+    for (uint i = 0; i < pNMemb; ++i)
+        if (pVertexClamp[pMembVerts[i]] == false) pV[pMembVerts[i]] = vs[i];
+    pInteriorStale = (pNInterior != 0);
+
+    // reset pTriCur for caller contributions
+    std::fill(pTriCur.begin(), pTriCur.end(), 0.0);
+}
+
+}}} // namespace steps::solver::efield
+
+// END
@@ -0,0 +1,142 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+#ifndef STEPS_SOLVER_EFIELD_DVSOLVER_CONDENSED_HPP
+#define STEPS_SOLVER_EFIELD_DVSOLVER_CONDENSED_HPP 1
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/solver/efield/bdsystem.hpp"
+#include "steps/solver/efield/dVsolver.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+/// dV solver on the membrane vertices only.
+///
+/// Capacitance and membrane currents act only on vertices with membrane
+/// area; the other, interior, vertices carry pure resistive coupling, and
+/// after every step their potentials solve K_II V_I = I_I - K_IS V_S for
+/// those of the membrane (and clamped) vertices V_S, whatever they were
+/// before. The interior is therefore eliminated when the matrix is set
+/// up: the Schur complement onto the membrane vertices is computed with a
+/// banded LU factorisation of K_II and factorised in turn. Its couplings
+/// decay with the distance through the interior; those below a small
+/// fraction of the conductances of their vertices are lumped onto the
+/// diagonal, which keeps the band narrow on elongated meshes such as
+/// dendrites.
+/// A step then solves only the membrane system, and interior potentials
+/// are reconstructed when first asked for after a step.
+///
+/// The condensation depends only on the conductances and on which
+/// vertices are clamped; a new capacitance or surface conductance only
+/// reassembles and factorises the membrane system, which is kept for the
+/// last few dt. Setting up costs
+/// one interior solve per membrane vertex next to the interior, so suits
+/// meshes where most vertices are interior and the conductances change
+/// rarely.
+class dVSolverCondensed: public dVSolverBase {
+public:
+    dVSolverCondensed()
+    : pNMemb(0), pNInterior(0), pSchurSys(0), pHalfBWSchur(0), pNCondensations(0), pInteriorStale(false) {}
+
+    void initMesh(TetMesh *mesh) override;
+
+    void setPotential(double v) override;
+
+    /** Retrieve potential at vertex i, reconstructing the interior if needed */
+    double getV(int i) const override;
+
+    /** Set potential at vertex i; interior potentials follow from the
+     * membrane ones at the next step */
+    void setV(int i, double v) override;
+
+    void advance(double dt) override;
+
+    /// Number of membrane (and clamped) vertices of the condensed system.
+    uint countCondensed(void) const { return pNMemb; }
+
+    /// Number of times the interior was eliminated.
+    uint countCondensations(void) const { return pNCondensations; }
+
+private:
+    /// Whether the split and the conductances are those of the last
+    /// condensation.
+    bool _condensed(void) const;
+
+    /// Split the vertices, factorise K_II and compute the Schur
+    /// complement correction.
+    void _condense(void);
+
+    /// Assemble and factorise the membrane system for dt.
+    void _assembleSchur(BDSystem & sys, double dt);
+
+    /// Solve K_II V_I = I_I - K_IS V_S.
+    void _reconstructInterior(void) const;
+
+    /// Local index of every vertex in the membrane or interior system,
+    /// and whether it belongs to the interior.
+    std::vector<uint>                   pLocal;
+    std::vector<char>                   pInterior;
+    std::vector<uint>                   pMembVerts;
+    std::vector<uint>                   pInteriorVerts;
+    uint                                pNMemb;
+    uint                                pNInterior;
+
+    /// Factorised interior system, and Schur systems for the last few
+    /// dt, that of the last step first.
+    std::unique_ptr<BDSystem>           pInteriorSys;
+    DTSystemCache<BDSystem>             pSchurSystems;
+    BDSystem *                          pSchurSys;
+
+    /// Kept columns of the Schur complement correction, the dropped ones
+    /// summed by row, and the half bandwidth of the membrane system.
+    std::vector<std::vector<std::pair<uint, double>>> pCorr;
+    std::vector<double>                 pCorrDiag;
+    int                                 pHalfBWSchur;
+
+    /// Conductances of the last condensation, vertex by vertex.
+    std::vector<double>                 pCondensedCC;
+    uint                                pNCondensations;
+
+    /// Interior currents of the last step, and the interior potentials.
+    std::vector<double>                 pInteriorCur;
+    mutable std::vector<double>         pVInterior;
+    mutable bool                        pInteriorStale;
+};
+
+}}} // namespace steps::efield::solver
+
+#endif // ndef STEPS_SOLVER_EFIELD_DVSOLVER_CONDENSED_HPP
+
+// END
@@ -0,0 +1,273 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/solver/efield/dVsolver_dist.hpp"
+#include "steps/solver/efield/tetmesh.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+namespace {
+
+// Residual, relative to the right hand side, at which a solve stops.
+const double DIST_SOLVER_RTOL = 1.0e-10;
+
+// Iterations after which a solve is given up.
+const uint DIST_SOLVER_MAX_ITER = 10000;
+
+}
+
+dVSolverDist::dVSolverDist(MPI_Comm comm, std::map<int, std::vector<uint>> const & halo)
+: pComm(comm)
+, pRank(0)
+, pHalo(halo)
+, pNIterations(0)
+{
+    MPI_Comm_rank(pComm, &pRank);
+}
+
+void dVSolverDist::initMesh(TetMesh *mesh) {
+    dVSolverBase::initMesh(mesh);
+
+    // The shared vertices by solver index; the order of the halo lists
+    // is kept, as it is how the neighbours pack their values.
+    std::vector<uint> perm = mesh->getVertexPermutation();
+    pOwned.assign(pNVerts, true);
+    std::vector<char> shared(pNVerts, false);
+    for (auto const & nbr: pHalo) {
+        if (nbr.first == pRank) continue;
+        pNbrRanks.push_back(nbr.first);
+        pNbrVerts.emplace_back();
+        for (uint v: nbr.second) {
+            if (v >= pNVerts) throw steps::ProgErr("Shared vertex out of range.");
+            uint idx = perm[v];
+            pNbrVerts.back().push_back(idx);
+            shared[idx] = true;
+            if (nbr.first < pRank) pOwned[idx] = false;
+        }
+        pSendBufs.emplace_back(nbr.second.size());
+        pRecvBufs.emplace_back(nbr.second.size());
+    }
+    pRequests.resize(2 * pNbrRanks.size());
+    pHalo.clear();
+
+    for (uint i = 0; i < pNVerts; ++i)
+        (shared[i] ? pBndRows : pIntRows).push_back(i);
+
+    pRowBegin.assign(pNVerts + 1, 0);
+    for (uint i = 0; i < pNVerts; ++i)
+        pRowBegin[i + 1] = pRowBegin[i] + pMesh->getVertex(i)->getNCon();
+    pCols.resize(pRowBegin[pNVerts]);
+    pCC.resize(pRowBegin[pNVerts]);
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement *ve = pMesh->getVertex(i);
+        for (uint j = 0; j < ve->getNCon(); ++j)
+            pCols[pRowBegin[i] + j] = ve->nbrIdx(j);
+    }
+
+    pDiag.assign(pNVerts, 0.0);
+    pPrecond.assign(pNVerts, 1.0);
+    pB.assign(pNVerts, 0.0);
+    pX.assign(pNVerts, 0.0);
+    pR.assign(pNVerts, 0.0);
+    pZ.assign(pNVerts, 0.0);
+    pP.assign(pNVerts, 0.0);
+    pQ.assign(pNVerts, 0.0);
+    pPartial.assign(pNVerts, 0.0);
+    pAdded.assign(pNVerts, false);
+}
+
+void dVSolverDist::_beginSharedSum(std::vector<double> & v) {
+    uint nnbrs = pNbrRanks.size();
+    for (uint n = 0; n < nnbrs; ++n) {
+        std::vector<double> & buf = pSendBufs[n];
+        std::vector<uint> const & verts = pNbrVerts[n];
+        for (uint k = 0; k < verts.size(); ++k) buf[k] = v[verts[k]];
+        MPI_Irecv(pRecvBufs[n].data(), pRecvBufs[n].size(), MPI_DOUBLE, pNbrRanks[n], 0, pComm, &pRequests[n]);
+        MPI_Isend(buf.data(), buf.size(), MPI_DOUBLE, pNbrRanks[n], 0, pComm, &pRequests[nnbrs + n]);
+    }
+}
+
+void dVSolverDist::_endSharedSum(std::vector<double> & v) {
+    MPI_Waitall(pRequests.size(), pRequests.data(), MPI_STATUSES_IGNORE);
+
+    // Every rank adds the partial values of a vertex in rank order, so
+    // that the sums are the same on all of them to the last bit.
+    for (uint i: pBndRows) {
+        pPartial[i] = v[i];
+        pAdded[i] = false;
+        v[i] = 0.0;
+    }
+    for (uint n = 0; n < pNbrRanks.size(); ++n) {
+        std::vector<uint> const & verts = pNbrVerts[n];
+        std::vector<double> const & buf = pRecvBufs[n];
+        for (uint k = 0; k < verts.size(); ++k) {
+            uint i = verts[k];
+            if (pNbrRanks[n] > pRank && pAdded[i] == false) {
+                v[i] += pPartial[i];
+                pAdded[i] = true;
+            }
+            v[i] += buf[k];
+        }
+    }
+    for (uint i: pBndRows)
+        if (pAdded[i] == false) v[i] += pPartial[i];
+}
+
+void dVSolverDist::_multiply(std::vector<double> const & x, std::vector<double> & y) {
+    // The shared rows first, so that their summation overlaps with the
+    // interior rows.
+    for (uint i: pBndRows) y[i] = _row(i, x);
+    _beginSharedSum(y);
+    for (uint i: pIntRows) y[i] = _row(i, x);
+    _endSharedSum(y);
+
+    for (uint i = 0; i < pNVerts; ++i)
+        if (pVertexClamp[i]) y[i] = x[i];
+}
+
+void dVSolverDist::_dots(std::vector<double> const & a, std::vector<double> const & b,
+                         std::vector<double> const & c, std::vector<double> const & d,
+                         double & ab, double & cd) {
+    double sums[2] = {0.0, 0.0};
+    for (uint i = 0; i < pNVerts; ++i) {
+        if (pOwned[i] == false) continue;
+        sums[0] += a[i] * b[i];
+        sums[1] += c[i] * d[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, sums, 2, MPI_DOUBLE, MPI_SUM, pComm);
+    ab = sums[0];
+    cd = sums[1];
+}
+
+double dVSolverDist::globalMax(double v) const {
+    MPI_Allreduce(MPI_IN_PLACE, &v, 1, MPI_DOUBLE, MPI_MAX, pComm);
+    return v;
+}
+
+void dVSolverDist::advance(double dt) {
+    // Add up current clamp contributions
+    std::copy(pVertCurClamp.begin(), pVertCurClamp.end(), pVertCur.begin());
+    for (uint i = 0; i < pNTris; ++i) {
+        double c = (pTriCur[i] + pTriCurClamp[i]) / 3.0;
+
+        uint *triv = pMesh->getTriangle(i);
+        pVertCur[triv[0]] += c;
+        pVertCur[triv[1]] += c;
+        pVertCur[triv[2]] += c;
+    }
+
+    double oodt = 1.0/dt;
+
+    // Partial rows of the local part of the mesh
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        double rhs = pVertCur[i] + pGExt[i] * (pVExt - pV[i]);
+        double Aii = ve->getCapacitance()*oodt + pGExt[i];
+
+        for (uint k = pRowBegin[i]; k < pRowBegin[i + 1]; ++k) {
+            double cc = ve->getCC(k - pRowBegin[i]);
+            rhs += cc * (pV[pCols[k]] - pV[i]);
+            Aii += cc;
+            pCC[k] = cc;
+        }
+        pB[i] = rhs;
+        pDiag[i] = Aii;
+    }
+
+    std::copy(pDiag.begin(), pDiag.end(), pPrecond.begin());
+    _beginSharedSum(pPrecond);
+    _endSharedSum(pPrecond);
+    _beginSharedSum(pB);
+    _endSharedSum(pB);
+    for (uint i = 0; i < pNVerts; ++i) {
+        if (pVertexClamp[i]) {
+            pB[i] = 0.0;
+            pX[i] = 0.0;
+            pPrecond[i] = 1.0;
+        }
+    }
+
+    // Preconditioned conjugate gradients from the last dV, unless there
+    // is nothing to solve for.
+    double bb, rz, rr, pq;
+    _dots(pB, pB, pB, pB, bb, bb);
+    if (bb == 0.0) std::fill(pX.begin(), pX.end(), 0.0);
+    _multiply(pX, pQ);
+    for (uint i = 0; i < pNVerts; ++i) {
+        pR[i] = pB[i] - pQ[i];
+        pZ[i] = pR[i] / pPrecond[i];
+        pP[i] = pZ[i];
+    }
+    double tol2 = DIST_SOLVER_RTOL * DIST_SOLVER_RTOL * bb;
+    _dots(pR, pZ, pR, pR, rz, rr);
+
+    pNIterations = 0;
+    while (rr > tol2) {
+        if (pNIterations == DIST_SOLVER_MAX_ITER) {
+            std::ostringstream os;
+            os << "Distributed EField solver did not converge in " << DIST_SOLVER_MAX_ITER << " iterations.";
+            throw steps::ProgErr(os.str());
+        }
+        ++pNIterations;
+
+        _multiply(pP, pQ);
+        _dots(pP, pQ, pP, pQ, pq, pq);
+        double alpha = rz / pq;
+        for (uint i = 0; i < pNVerts; ++i) {
+            pX[i] += alpha * pP[i];
+            pR[i] -= alpha * pQ[i];
+            pZ[i] = pR[i] / pPrecond[i];
+        }
+
+        double rz_old = rz;
+        _dots(pR, pZ, pR, pR, rz, rr);
+        double beta = rz / rz_old;
+        for (uint i = 0; i < pNVerts; ++i)
+            pP[i] = pZ[i] + beta * pP[i];
+    }
+
+    for (uint i = 0; i < pNVerts; ++i)
+        if (pVertexClamp[i] == false) pV[i] += pX[i];
+
+    // reset pTriCur for caller contributions
+    std::fill(pTriCur.begin(), pTriCur.end(), 0.0);
+}
+
+}}} // namespace steps::solver::efield
+
+// END
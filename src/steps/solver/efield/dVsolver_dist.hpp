@@ -0,0 +1,152 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+#ifndef STEPS_SOLVER_EFIELD_DVSOLVER_DIST_HPP
+#define STEPS_SOLVER_EFIELD_DVSOLVER_DIST_HPP 1
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <mpi.h>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/solver/efield/dVsolver.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+/// dV solver for a mesh distributed over the ranks of a communicator.
+///
+/// Every rank holds only a part of the mesh: the tetrahedrons and membrane
+/// triangles it hosts, and their vertices. The coupling constants,
+/// capacitances, leak conductances and current clamps of a vertex on the
+/// boundary between parts are then partial, and the rows of the system
+/// assembled from them sum over the ranks sharing the vertex to those of
+/// the whole mesh. The system is solved by conjugate gradients with a
+/// Jacobi preconditioner; each matrix-vector product sums the partial rows
+/// of the shared vertices with the neighbouring ranks only, in rank order,
+/// so all ranks sharing a vertex keep the same potential for it.
+class dVSolverDist: public dVSolverBase {
+public:
+    /// \param comm Communicator of the ranks holding parts of the mesh.
+    /// \param halo The vertices shared with every other rank, as indices
+    ///        into the vertex array given to EField::initMesh(), in the
+    ///        same order on both ranks.
+    dVSolverDist(MPI_Comm comm, std::map<int, std::vector<uint>> const & halo);
+
+    /// Initialize mesh and the exchange of the shared vertices
+    void initMesh(TetMesh *mesh) override;
+
+    /// Assemble and solve the distributed system. Collective.
+    void advance(double dt) override;
+
+    /// Largest of v over the ranks of the communicator. Collective.
+    double globalMax(double v) const override;
+
+    /// Number of conjugate gradient iterations of the last advance().
+    uint getNIterations(void) const { return pNIterations; }
+
+    /// Number of local vertices counted by this rank in global sums: all
+    /// but those shared with a rank of lower rank.
+    uint countOwnedVerts(void) const
+    { return std::count(pOwned.begin(), pOwned.end(), true); }
+
+private:
+    /// Start the summation of the partial values of the shared vertices
+    /// in v with the neighbouring ranks.
+    void _beginSharedSum(std::vector<double> & v);
+
+    /// Complete the summation started by _beginSharedSum().
+    void _endSharedSum(std::vector<double> & v);
+
+    /// y = A x, where A is zero but for the diagonal in clamped rows.
+    void _multiply(std::vector<double> const & x, std::vector<double> & y);
+
+    /// Partial row i of A x.
+    inline double _row(uint i, std::vector<double> const & x) const {
+        double y = pDiag[i] * x[i];
+        for (uint k = pRowBegin[i]; k < pRowBegin[i + 1]; ++k)
+            y -= pCC[k] * x[pCols[k]];
+        return y;
+    }
+
+    /// Sums of a.b and c.d over the vertices owned by all ranks.
+    void _dots(std::vector<double> const & a, std::vector<double> const & b,
+               std::vector<double> const & c, std::vector<double> const & d,
+               double & ab, double & cd);
+
+    MPI_Comm                            pComm;
+    int                                 pRank;
+
+    /// Neighbouring ranks in ascending order, and the solver indices of
+    /// the vertices shared with each of them.
+    std::vector<int>                    pNbrRanks;
+    std::vector<std::vector<uint>>      pNbrVerts;
+    std::vector<std::vector<double>>    pSendBufs;
+    std::vector<std::vector<double>>    pRecvBufs;
+    std::vector<MPI_Request>            pRequests;
+
+    /// Halo given to the constructor, by index in the vertex array.
+    std::map<int, std::vector<uint>>    pHalo;
+
+    /// Rows of the shared vertices, and of all others.
+    std::vector<uint>                   pBndRows;
+    std::vector<uint>                   pIntRows;
+
+    /// Whether a vertex is counted by this rank in global sums: owned
+    /// unless a rank of lower rank shares it.
+    std::vector<char>                   pOwned;
+
+    /// The local couplings in compressed rows, and the partial diagonal.
+    std::vector<uint>                   pRowBegin;
+    std::vector<uint>                   pCols;
+    std::vector<double>                 pCC;
+    std::vector<double>                 pDiag;
+
+    /// Summed diagonal, the inverse of the Jacobi preconditioner.
+    std::vector<double>                 pPrecond;
+
+    /// Work vectors: rhs, solution (the last dV, as initial guess),
+    /// residual, preconditioned residual, search direction and product.
+    std::vector<double>                 pB, pX, pR, pZ, pP, pQ;
+
+    /// Own partial values of the shared vertices during a summation.
+    std::vector<double>                 pPartial;
+    std::vector<char>                   pAdded;
+
+    uint                                pNIterations;
+};
+
+}}} // namespace steps::efield::solver
+
+#endif // ndef STEPS_SOLVER_EFIELD_DVSOLVER_DIST_HPP
+
+// END
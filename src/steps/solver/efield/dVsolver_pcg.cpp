@@ -0,0 +1,277 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/solver/efield/dVsolver_pcg.hpp"
+#include "steps/solver/efield/tetmesh.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+namespace {
+
+// Residual, relative to the right hand side, at which a solve stops.
+const double PCG_SOLVER_RTOL = 1.0e-10;
+
+// Iterations after which a solve is given up.
+const uint PCG_SOLVER_MAX_ITER = 10000;
+
+double dot(std::vector<double> const & a, std::vector<double> const & b) {
+    double s = 0.0;
+    int n = a.size();
+    #pragma omp parallel for reduction(+:s)
+    for (int i = 0; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+}
+
+dVSolverPCG::dVSolverPCG(Preconditioner precond)
+: pPrecond(precond)
+, pUseIC0(false)
+, pNIterations(0)
+{}
+
+void dVSolverPCG::initMesh(TetMesh *mesh) {
+    dVSolverBase::initMesh(mesh);
+
+    // Sorted columns of every row, the diagonal included.
+    std::vector<std::vector<uint>> rows(pNVerts);
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement *ve = pMesh->getVertex(i);
+        std::vector<uint> & row = rows[ve->getIDX()];
+        row.push_back(ve->getIDX());
+        for (uint j = 0; j < ve->getNCon(); ++j) row.push_back(ve->nbrIdx(j));
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+
+    pRowBegin.assign(pNVerts + 1, 0);
+    for (uint i = 0; i < pNVerts; ++i)
+        pRowBegin[i + 1] = pRowBegin[i] + rows[i].size();
+    pCols.resize(pRowBegin[pNVerts]);
+    pVals.assign(pRowBegin[pNVerts], 0.0);
+    pDiagPos.resize(pNVerts);
+    for (uint i = 0; i < pNVerts; ++i) {
+        std::copy(rows[i].begin(), rows[i].end(), pCols.begin() + pRowBegin[i]);
+        pDiagPos[i] = pRowBegin[i] + (std::lower_bound(rows[i].begin(), rows[i].end(), i) - rows[i].begin());
+    }
+
+    pConBegin.assign(pNVerts + 1, 0);
+    for (uint i = 0; i < pNVerts; ++i)
+        pConBegin[i + 1] = pConBegin[i] + pMesh->getVertex(i)->getNCon();
+    pConPos.resize(pConBegin[pNVerts]);
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement *ve = pMesh->getVertex(i);
+        uint r = ve->getIDX();
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint const * b = &pCols[pRowBegin[r]];
+            pConPos[pConBegin[i] + j] = pRowBegin[r] + (std::lower_bound(b, b + rows[r].size(), ve->nbrIdx(j)) - b);
+        }
+    }
+
+    // The lower triangle of the pattern, diagonal last.
+    pLRowBegin.assign(pNVerts + 1, 0);
+    for (uint i = 0; i < pNVerts; ++i)
+        pLRowBegin[i + 1] = pLRowBegin[i] + (pDiagPos[i] - pRowBegin[i]) + 1;
+    pLCols.resize(pLRowBegin[pNVerts]);
+    pLVals.assign(pLRowBegin[pNVerts], 0.0);
+    for (uint i = 0; i < pNVerts; ++i)
+        std::copy(pCols.begin() + pRowBegin[i], pCols.begin() + pDiagPos[i] + 1, pLCols.begin() + pLRowBegin[i]);
+    pInvDiag.assign(pNVerts, 0.0);
+
+    pB.assign(pNVerts, 0.0);
+    pX.assign(pNVerts, 0.0);
+    pR.assign(pNVerts, 0.0);
+    pZ.assign(pNVerts, 0.0);
+    pP.assign(pNVerts, 0.0);
+    pQ.assign(pNVerts, 0.0);
+}
+
+void dVSolverPCG::_factor(void) {
+    for (uint i = 0; i < pNVerts; ++i) pInvDiag[i] = 1.0 / pVals[pDiagPos[i]];
+
+    pUseIC0 = (pPrecond == PRECOND_IC0);
+    for (uint i = 0; i < pNVerts && pUseIC0; ++i) {
+        uint ib = pLRowBegin[i];
+        uint ie = pLRowBegin[i + 1] - 1;
+        for (uint k = ib; k <= ie; ++k) {
+            uint j = pLCols[k];
+            // Dot of rows i and j of L over the columns before j.
+            double s = pVals[pRowBegin[i] + (k - ib)];
+            uint a = ib, b = pLRowBegin[j];
+            uint be = pLRowBegin[j + 1] - 1;
+            while (a < k && b < be) {
+                if (pLCols[a] < pLCols[b]) ++a;
+                else if (pLCols[b] < pLCols[a]) ++b;
+                else s -= pLVals[a++] * pLVals[b++];
+            }
+            if (k < ie) pLVals[k] = s / pLVals[be];
+            else if (s > 0.0) pLVals[k] = std::sqrt(s);
+            else pUseIC0 = false;
+        }
+    }
+}
+
+void dVSolverPCG::_precondition(std::vector<double> const & r, std::vector<double> & z) {
+    if (!pUseIC0) {
+        #pragma omp parallel for
+        for (int i = 0; i < (int)pNVerts; ++i) z[i] = r[i] * pInvDiag[i];
+        return;
+    }
+
+    // L y = r, then L^T z = y, both in z.
+    for (uint i = 0; i < pNVerts; ++i) {
+        double s = r[i];
+        uint ie = pLRowBegin[i + 1] - 1;
+        for (uint k = pLRowBegin[i]; k < ie; ++k) s -= pLVals[k] * z[pLCols[k]];
+        z[i] = s / pLVals[ie];
+    }
+    for (uint i = pNVerts; i-- > 0; ) {
+        uint ie = pLRowBegin[i + 1] - 1;
+        z[i] /= pLVals[ie];
+        for (uint k = pLRowBegin[i]; k < ie; ++k) z[pLCols[k]] -= pLVals[k] * z[i];
+    }
+}
+
+void dVSolverPCG::_multiply(std::vector<double> const & x, std::vector<double> & y) const {
+    #pragma omp parallel for
+    for (int i = 0; i < (int)pNVerts; ++i) {
+        double s = 0.0;
+        for (uint k = pRowBegin[i]; k < pRowBegin[i + 1]; ++k) s += pVals[k] * x[pCols[k]];
+        y[i] = s;
+    }
+}
+
+void dVSolverPCG::advance(double dt) {
+    // Add up current clamp contributions
+    std::copy(pVertCurClamp.begin(), pVertCurClamp.end(), pVertCur.begin());
+    for (uint i = 0; i < pNTris; ++i) {
+        double c = (pTriCur[i] + pTriCurClamp[i]) / 3.0;
+
+        uint *triv = pMesh->getTriangle(i);
+        pVertCur[triv[0]] += c;
+        pVertCur[triv[1]] += c;
+        pVertCur[triv[2]] += c;
+    }
+
+    double oodt = 1.0/dt;
+    bool refactor = !pMatrixValid || dt != pMatrixDT;
+
+    for (uint i = 0; i < pNVerts; ++i) {
+        VertexElement * ve = pMesh->getVertex(i);
+        uint ind = ve->getIDX();
+
+        if (pVertexClamp[ind]) {
+            pB[ind] = 0.0;
+            pX[ind] = 0.0;
+            if (refactor) {
+                std::fill(pVals.begin() + pRowBegin[ind], pVals.begin() + pRowBegin[ind + 1], 0.0);
+                pVals[pDiagPos[ind]] = 1.0;
+            }
+            continue;
+        }
+
+        double rhs = pVertCur[ind] + pGExt[ind] * (pVExt - pV[ind]);
+        double Aii = ve->getCapacitance()*oodt + pGExt[ind];
+        for (uint j = 0; j < ve->getNCon(); ++j) {
+            uint k = ve->nbrIdx(j);
+            double cc = ve->getCC(j);
+
+            rhs += cc * (pV[k] - pV[ind]);
+            Aii += cc;
+            // dV of a clamped vertex is zero: drop its column.
+            if (refactor) pVals[pConPos[pConBegin[i] + j]] = pVertexClamp[k] ? 0.0 : -cc;
+        }
+        pB[ind] = rhs;
+        if (refactor) pVals[pDiagPos[ind]] = Aii;
+    }
+
+    if (refactor) {
+        _factor();
+        pMatrixValid = true;
+        pMatrixDT = dt;
+    }
+
+    // Preconditioned conjugate gradients from the last dV, unless there
+    // is nothing to solve for.
+    double bb = dot(pB, pB);
+    if (bb == 0.0) std::fill(pX.begin(), pX.end(), 0.0);
+    _multiply(pX, pQ);
+    for (uint i = 0; i < pNVerts; ++i) pR[i] = pB[i] - pQ[i];
+    _precondition(pR, pZ);
+    pP = pZ;
+    double tol2 = PCG_SOLVER_RTOL * PCG_SOLVER_RTOL * bb;
+    double rz = dot(pR, pZ);
+    double rr = dot(pR, pR);
+
+    pNIterations = 0;
+    while (rr > tol2) {
+        if (pNIterations == PCG_SOLVER_MAX_ITER) {
+            std::ostringstream os;
+            os << "PCG EField solver did not converge in " << PCG_SOLVER_MAX_ITER << " iterations.";
+            throw steps::ProgErr(os.str());
+        }
+        ++pNIterations;
+
+        _multiply(pP, pQ);
+        double alpha = rz / dot(pP, pQ);
+        #pragma omp parallel for
+        for (int i = 0; i < (int)pNVerts; ++i) {
+            pX[i] += alpha * pP[i];
+            pR[i] -= alpha * pQ[i];
+        }
+        _precondition(pR, pZ);
+
+        double rz_old = rz;
+        rz = dot(pR, pZ);
+        rr = dot(pR, pR);
+        double beta = rz / rz_old;
+        #pragma omp parallel for
+        for (int i = 0; i < (int)pNVerts; ++i)
+            pP[i] = pZ[i] + beta * pP[i];
+    }
+
+    for (uint i = 0; i < pNVerts; ++i)
+        if (pVertexClamp[i] == false) pV[i] += pX[i];
+
+    // reset pTriCur for caller contributions
+    std::fill(pTriCur.begin(), pTriCur.end(), 0.0);
+}
+
+}}} // namespace steps::solver::efield
+
+// END
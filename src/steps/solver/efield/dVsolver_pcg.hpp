@@ -0,0 +1,119 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+
+#ifndef STEPS_SOLVER_EFIELD_DVSOLVER_PCG_HPP
+#define STEPS_SOLVER_EFIELD_DVSOLVER_PCG_HPP 1
+
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/solver/efield/dVsolver.hpp"
+
+namespace steps {
+namespace solver {
+namespace efield {
+
+/// dV solver by preconditioned conjugate gradients on a sparse matrix.
+///
+/// The matrix is assembled in compressed rows straight from the vertex
+/// connections, so memory grows with the number of connections rather
+/// than with n times the bandwidth. Rows and columns of clamped vertices
+/// are replaced by those of the identity, keeping the matrix symmetric
+/// positive definite. Each solve starts from the dV of the last step.
+/// Matrix-vector products and vector updates are shared out over OpenMP
+/// threads; the triangular solves of the preconditioner are serial.
+class dVSolverPCG: public dVSolverBase {
+public:
+    enum Preconditioner {
+        /// Diagonal scaling.
+        PRECOND_JACOBI,
+        /// Incomplete Cholesky factorisation without fill-in, falling
+        /// back to Jacobi if a pivot is not positive.
+        PRECOND_IC0
+    };
+
+    explicit dVSolverPCG(Preconditioner precond = PRECOND_IC0);
+
+    /// Initialize mesh and the sparsity pattern of the matrix
+    void initMesh(TetMesh *mesh) override;
+
+    /// Assemble and solve the sparse system.
+    void advance(double dt) override;
+
+    /// Number of conjugate gradient iterations of the last advance().
+    uint getNIterations(void) const { return pNIterations; }
+
+    /// Whether the incomplete Cholesky factorisation is in use.
+    bool usesIC0(void) const { return pUseIC0; }
+
+private:
+    /// Compute the preconditioner from the assembled matrix.
+    void _factor(void);
+
+    /// z = M^-1 r.
+    void _precondition(std::vector<double> const & r, std::vector<double> & z);
+
+    /// y = A x.
+    void _multiply(std::vector<double> const & x, std::vector<double> & y) const;
+
+    Preconditioner                      pPrecond;
+    bool                                pUseIC0;
+
+    /// The matrix in compressed rows with sorted columns, diagonal
+    /// included, and the position of the diagonal in every row.
+    std::vector<uint>                   pRowBegin;
+    std::vector<uint>                   pCols;
+    std::vector<double>                 pVals;
+    std::vector<uint>                   pDiagPos;
+
+    /// Position in pVals of every vertex connection, in the order of the
+    /// mesh vertices and their neighbours.
+    std::vector<uint>                   pConBegin;
+    std::vector<uint>                   pConPos;
+
+    /// Lower triangle of the incomplete Cholesky factor in compressed
+    /// rows, the diagonal last in each row; or the inverse diagonal for
+    /// Jacobi.
+    std::vector<uint>                   pLRowBegin;
+    std::vector<uint>                   pLCols;
+    std::vector<double>                 pLVals;
+    std::vector<double>                 pInvDiag;
+
+    /// Work vectors: rhs, solution (the last dV, as initial guess),
+    /// residual, preconditioned residual, search direction and product.
+    std::vector<double>                 pB, pX, pR, pZ, pP, pQ;
+
+    uint                                pNIterations;
+};
+
+}}} // namespace steps::efield::solver
+
+#endif // ndef STEPS_SOLVER_EFIELD_DVSOLVER_PCG_HPP
+
+// END
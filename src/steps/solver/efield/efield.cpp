@@ -26,6 +26,8 @@
 
 
 // STL headers.
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <cassert>
 #include <sstream>
@@ -60,7 +62,9 @@ sefield::EField::EField(std::unique_ptr<EFieldSolver> impl):
     pVProp(std::move(impl)),
     pMesh(0),
     pNVerts(0), pNTris(0), pNTets(0),
-    pCPerm()
+    pCPerm(),
+    pAdaptive(false), pDTMax(0.0), pMaxLevel(0), pLevel(0), pVTol(0.0),
+    pNWithinTol(0), pNOverTol(0), pLastDT(0.0)
 {}
     
 void sefield::EField::initMesh(uint nverts, double * verts,
@@ -160,6 +164,9 @@ void sefield::EField::restore(std::fstream & cp_file)
     cp_file.read((char*)&pCPerm.front(), sizeof(uint) * nCPerm);
 
     pMesh->restore(cp_file);
+    pVProp->invalidateMatrix();
+    pLastDT = 0.0;
+    pLevel = pMaxLevel;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -174,6 +181,7 @@ void sefield::EField::setMembCapac(uint midx, double cm)
     // specific capacitance in pF/um2.
     // Argument is in F/m^2: 1 F/m^2 = 1 pF / um^2 so no conversion needed!
     pMesh->applySurfaceCapacitance(cm);
+    pVProp->invalidateMatrix();
 }
 
 void sefield::EField::setTriCapac(uint tidx, double cm)
@@ -188,6 +196,7 @@ void sefield::EField::setTriCapac(uint tidx, double cm)
     // Argument is in F/m^2: 1 F/m^2 = 1 pF / um^2 so no conversion needed!
 
     pMesh->applyTriCapacitance(tidx, cm);
+    pVProp->invalidateMatrix();
 
 }
 
@@ -200,6 +209,8 @@ void sefield::EField::setMembPotential(uint midx, double v)
 
     // We require mV
     pVProp->setPotential(v*1.0e3);
+    pLastDT = 0.0;
+    pLevel = pMaxLevel;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -208,6 +219,7 @@ void sefield::EField::setMembVolRes(uint midx, double ro)
 {
     assert(ro >= 0.0);
     pMesh->applyConductance(1.0/(ro*1.0e-3));
+    pVProp->invalidateMatrix();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -225,6 +237,31 @@ void sefield::EField::setSurfaceResistivity(uint midx,double rspec, double vrev)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void sefield::EField::setVertCapac(uint vidx, double cm)
+{
+    // vidx argument converted to local index in Tetexact.
+    assert(vidx < pNVerts);
+    assert (cm >= 0.0);
+
+    // Units as in setMembCapac
+    pMesh->getVertex(pCPerm[vidx])->applySurfaceCapacitance(cm);
+    pVProp->invalidateMatrix();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double sefield::EField::getVertCapac(uint vidx)
+{
+    // vidx argument converted to local index in Tetexact.
+    assert(vidx < pNVerts);
+
+    VertexElement * ve = pMesh->getVertex(pCPerm[vidx]);
+    if (ve->getSurfaceArea() == 0.0) return 0.0;
+    return ve->getCapacitance() / ve->getSurfaceArea();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void sefield::EField::setVertIClamp(uint vidx, double cur)
 {
     // vidx argument converted to local index in Tetexact.
@@ -246,7 +283,95 @@ void sefield::EField::advance(double dt)
     assert(dt >= 0.0);
 
     //Convert to ms
-    pVProp->advance(dt*1.0e3);
+    if (pAdaptive) _advanceAdaptive(dt*1.0e3);
+    else pVProp->advance(dt*1.0e3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void sefield::EField::_advanceAdaptive(double dt)
+{
+    // The solver clears the currents after every step: keep them for all
+    // steps of the interval.
+    pTriI.resize(pNTris);
+    for (uint i = 0; i < pNTris; ++i) pTriI[i] = pVProp->getTriI(i);
+    pVOld.resize(pNVerts);
+    pRate.resize(pNVerts);
+
+    double left = dt;
+    while (left > 0.0)
+    {
+        double h = std::min(std::ldexp(pDTMax, -(int)pLevel), left);
+        for (uint v = 0; v < pNVerts; ++v) pVOld[v] = pVProp->getV(v);
+        for (uint i = 0; i < pNTris; ++i) pVProp->setTriI(i, pTriI[i]);
+        pVProp->advance(h);
+
+        // The rates of change over this step and the last differ by about
+        // V'' (h + h_last)/2, so the local error of the backward Euler step,
+        // h^2 V''/2, is about h^2 dr/(h + h_last).
+        double err = 0.0;
+        if (pLastDT != 0.0)
+        {
+            double dr = 0.0;
+            for (uint v = 0; v < pNVerts; ++v)
+                dr = std::max(dr, std::fabs((pVProp->getV(v) - pVOld[v])/h - pRate[v]));
+            err = pVProp->globalMax(dr * h * h / (h + pLastDT));
+        }
+
+        for (uint v = 0; v < pNVerts; ++v) pRate[v] = (pVProp->getV(v) - pVOld[v])/h;
+        pLastDT = h;
+        left = (h == left) ? 0.0 : left - h;
+
+        // The reactions and diffusion coupled to the potential have been
+        // run over the step already, so a step over the tolerance is kept;
+        // the following ones are shortened until they would be within it,
+        // halving the step about quartering the error.
+        if (err > pVTol)
+        {
+            ++pNOverTol;
+            for (double e = err; e > pVTol && pLevel < pMaxLevel; e *= 0.25) ++pLevel;
+            continue;
+        }
+        ++pNWithinTol;
+
+        // Doubling the step about quadruples the error.
+        if (err < 0.2 * pVTol && pLevel > 0) --pLevel;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void sefield::EField::setAdaptive(bool adaptive, double dtmin, double dtmax, double vtol)
+{
+    if (adaptive && (dtmin <= 0.0 || dtmax < dtmin || vtol <= 0.0))
+    {
+        std::ostringstream os;
+        os << "Adaptive EField stepping requires 0 < dtmin <= dtmax and a positive tolerance.";
+        throw steps::ArgErr(os.str());
+    }
+
+    pAdaptive = adaptive;
+    if (!adaptive) return;
+
+    // Convert to ms and mV
+    pDTMax = dtmax*1.0e3;
+    pMaxLevel = 0;
+    while (std::ldexp(dtmax, -(int)pMaxLevel - 1) >= dtmin) ++pMaxLevel;
+    pVTol = vtol*1.0e3;
+    pNWithinTol = 0;
+    pNOverTol = 0;
+    // The first step has no last one to be checked against: make it the
+    // shortest.
+    pLastDT = 0.0;
+    pLevel = pMaxLevel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double sefield::EField::getNextDT(void) const
+{
+    // Convert to s
+    return std::ldexp(pDTMax, -(int)pLevel)*1.0e-3;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
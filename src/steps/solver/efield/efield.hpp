@@ -33,6 +33,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 // STEPS headers.
 #include "steps/common.h"
@@ -153,6 +154,17 @@ public:
     /// \param cl Clamped (true) or unclamped (false)
     void    setVertVClamped(uint vidx, bool cl);
 
+    /// Set the specific capacitance of the membrane area of a vertex.
+    /// \param vidx Index of the vertex
+    /// \param cm Specific membrane capacitance (farad / m^2)
+    void    setVertCapac(uint vidx, double cm);
+
+    /// Return the specific capacitance of the membrane area of a vertex.
+    /// \param vidx Index of the vertex
+    /// \return Specific membrane capacitance (farad / m^2), or 0 for a
+    ///         vertex without membrane area
+    double  getVertCapac(uint vidx);
+
     /// Set the current clamp for a vertex  eleemnt.
     /// \param vidx Index of the vertex
     /// \param cur Current clamp for the vertex
@@ -233,9 +245,50 @@ public:
     ////////////////////////////////////////////////////////////////////////
 
     /// Advance the EField simulation.
+    ///
+    /// With adaptive stepping the interval is covered, under the currents
+    /// set for it, by steps of the length chosen before it; the solvers
+    /// end their intervals there, so that this is a single step.
     /// \param sec The time to advance the EField simulation (seconds)
     void    advance(double sec);
 
+    /// Switch adaptive stepping on or off.
+    ///
+    /// Each backward Euler step is checked against the step extrapolated
+    /// from the rate of change of the last one; the difference estimates
+    /// its local error. The error only sets the length of the following
+    /// steps, which grows after an error well within the tolerance and
+    /// shrinks after one over it: the reactions and diffusion coupled to
+    /// the potential have been run over a step by the time it is checked,
+    /// so a step is never undone. Step lengths are dtmax halved any number
+    /// of times down to dtmin, and the banded solvers keep the
+    /// factorisation for the last few of them.
+    /// Switching on resets the step counts.
+    /// \param adaptive Adaptive (true) or fixed (false) stepping
+    /// \param dtmin Shortest step (seconds)
+    /// \param dtmax Longest step (seconds)
+    /// \param vtol Tolerance of the local error (volts)
+    void    setAdaptive(bool adaptive, double dtmin, double dtmax, double vtol);
+
+    /// Return whether stepping is adaptive.
+    bool    getAdaptive(void) const
+    { return pAdaptive; }
+
+    /// Return the step length chosen for the next step (seconds); the
+    /// interval given to the next advance() need be no longer.
+    double  getNextDT(void) const;
+
+    /// Return the number of adaptive steps with a local error within the
+    /// tolerance.
+    ulong   getNStepsWithinTolerance(void) const
+    { return pNWithinTol; }
+
+    /// Return the number of adaptive steps with a local error over the
+    /// tolerance. Adaptive stepping only controls the step length: these
+    /// steps are kept, not rejected, and the steps after them shortened.
+    ulong   getNStepsOverTolerance(void) const
+    { return pNOverTol; }
+
     ////////////////////////////////////////////////////////////////////////
 
 private:
@@ -249,6 +302,24 @@ private:
     uint                          pNTets;
 
     std::vector<uint>             pTritoVert;
+
+    // Adaptive stepping: step lengths are pDTMax / 2^pLevel (ms), at
+    // most pMaxLevel; tolerance in mV.
+    bool                          pAdaptive;
+    double                        pDTMax;
+    uint                          pMaxLevel;
+    uint                          pLevel;
+    double                        pVTol;
+    ulong                         pNWithinTol;
+    ulong                         pNOverTol;
+    // Rate of change of every vertex potential over the last step
+    // (mV/ms), and its length; a length of zero before any.
+    std::vector<double>           pRate;
+    double                        pLastDT;
+    std::vector<double>           pVOld;
+    std::vector<double>           pTriI;
+
+    void _advanceAdaptive(double dt);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
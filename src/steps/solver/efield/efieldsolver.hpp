@@ -73,6 +73,13 @@ struct EFieldSolver {
 
     /** Solve for voltage with given dt */
     virtual void advance(double dt) =0;
+
+    /** Mesh capacitances or conductances have changed: discard anything
+     * computed from them */
+    virtual void invalidateMatrix() {}
+
+    /** Largest of v over all processes solving parts of the mesh */
+    virtual double globalMax(double v) const { return v; }
 };
 
 }}} // namespace steps::efield::solver
@@ -137,4 +137,28 @@ void SLUSystem::solve() {
     slu->factored = true;
 }
 
+void SLUSystem::resolve() {
+    if (!slu->factored) {
+        solve();
+        return;
+    }
+
+    SLU_NCMatrix Abis(pA);
+
+    supermatrix_nc_view slu_A(Abis);
+    std::copy(pb.begin(),pb.end(),px.begin());
+
+    slu->options.Fact = FACTORED;
+
+    int info;
+
+    pdgssvx_ABglobal(&slu->options, &slu_A.M, &slu->perm, &px[0], pN, 1,
+        &slu->grid, &slu->lu, &pBerr, &slu->stat, &info);
+
+    if (info>0) {
+        if (info<=pN) throw std::domain_error("Singular U in LU decomposition");
+        else throw std::runtime_error("SuperLU memory allocation failure");
+    }
+}
+
 }}} // namespace steps::solver::efield
@@ -179,6 +179,9 @@ public:
     const vector_type &x() const { return px_view; }
 
     void solve();
+
+    // solve for new b with the factorisation of the last solve()
+    void resolve();
     
     // query solver stats, error
     double berr() const { return pBerr; }
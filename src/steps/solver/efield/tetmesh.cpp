@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 #include <iostream>
 #include <map>
 #include <string>
@@ -129,15 +130,14 @@ sefield::TetMesh::TetMesh
         pElements[i] = velt;
     }
 
-    // Copy triangles.
-    assert(pNTri > 0);
+    // Copy triangles. The part of a mesh held by one rank of a distributed
+    // solver may have no triangles or tetrahedrons.
     pTriangles = new uint[pNTri * 3];
-    memcpy(pTriangles, trivi, 3 * pNTri * sizeof(uint));
+    if (pNTri != 0) memcpy(pTriangles, trivi, 3 * pNTri * sizeof(uint));
 
     // Copy tetrahedrons.
-    assert(pNTet > 0);
     pTetrahedrons = new uint[pNTet * 4];
-    memcpy(pTetrahedrons, tetvi, 4 * pNTet * sizeof(uint));
+    if (pNTet != 0) memcpy(pTetrahedrons, tetvi, 4 * pNTet * sizeof(uint));
 
     // Make a look up table for checking if a tetrahedron exists.
     for (uint i = 0; i < pNTet; ++i)
@@ -481,6 +481,191 @@ std::vector<double> sefield::TetMesh::centerOfMass(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// Vertices of a part below the size of which nested dissection stops and
+// orders by reverse Cuthill-McKee.
+const uint ND_LEAF_SIZE = 64;
+
+// Part of the vertices that have been ordered.
+const uint PART_DONE = std::numeric_limits<uint>::max();
+
+// Orderings of the vertex graph, given as the neighbours of every vertex
+// in compressed rows. Both work on parts of the graph: searches only
+// follow the connections between vertices of the same part.
+class VertexOrdering
+{
+public:
+    VertexOrdering(std::vector<uint> const & begin, std::vector<uint> const & adj)
+    : pBegin(begin), pAdj(adj)
+    , pPart(begin.size() - 1, 0), pMark(begin.size() - 1, 0), pLevel(begin.size() - 1, 0)
+    , pStamp(0), pNParts(1)
+    {}
+
+    // Append the reverse Cuthill-McKee order of verts to order.
+    void rcm(std::vector<uint> const & verts, std::vector<uint> & order)
+    {
+        uint q = pNParts++;
+        for (uint v: verts) pPart[v] = q;
+
+        size_t first = order.size();
+        std::vector<uint> visited, nbrs;
+        for (uint v: verts)
+        {
+            if (pPart[v] != q) continue;
+
+            // Cuthill-McKee from a pseudo-peripheral vertex of the
+            // component, neighbours by increasing degree.
+            uint r = _peripheral(v, visited);
+            size_t head = order.size();
+            order.push_back(r);
+            pPart[r] = PART_DONE;
+            while (head < order.size())
+            {
+                uint u = order[head++];
+                nbrs.clear();
+                for (uint k = pBegin[u]; k < pBegin[u + 1]; ++k)
+                {
+                    uint w = pAdj[k];
+                    if (pPart[w] != q) continue;
+                    pPart[w] = PART_DONE;
+                    nbrs.push_back(w);
+                }
+                std::sort(nbrs.begin(), nbrs.end(),
+                          [this](uint a, uint b) { return _degree(a) < _degree(b); });
+                order.insert(order.end(), nbrs.begin(), nbrs.end());
+            }
+        }
+        std::reverse(order.begin() + first, order.end());
+    }
+
+    // Append the nested dissection order of verts to order: the halves
+    // either side of a level set separator of a breadth first search,
+    // each ordered recursively, then the separator.
+    void nestedDissection(std::vector<uint> const & verts, std::vector<uint> & order)
+    {
+        if (verts.size() <= ND_LEAF_SIZE)
+        {
+            rcm(verts, order);
+            return;
+        }
+
+        uint q = pNParts++;
+        for (uint v: verts) pPart[v] = q;
+
+        std::vector<uint> visited;
+        _peripheral(verts[0], visited);
+        if (visited.size() < verts.size())
+        {
+            // No separator is needed between components.
+            std::vector<uint> rest;
+            for (uint v: verts)
+                if (pMark[v] != pStamp) rest.push_back(v);
+            nestedDissection(visited, order);
+            nestedDissection(rest, order);
+            return;
+        }
+
+        uint nlevels = pLevel[visited.back()] + 1;
+        if (nlevels < 3)
+        {
+            rcm(verts, order);
+            return;
+        }
+        uint m = std::min(std::max(pLevel[visited[visited.size() / 2]], 1u), nlevels - 2);
+
+        // Vertices of the middle level without neighbours in the next one
+        // need not separate.
+        std::vector<uint> a, b, sep;
+        for (uint v: visited)
+        {
+            if (pLevel[v] < m) a.push_back(v);
+            else if (pLevel[v] > m) b.push_back(v);
+            else
+            {
+                bool separates = false;
+                for (uint k = pBegin[v]; k < pBegin[v + 1] && !separates; ++k)
+                    separates = (pPart[pAdj[k]] == q && pLevel[pAdj[k]] == m + 1);
+                (separates ? sep : a).push_back(v);
+            }
+        }
+
+        nestedDissection(a, order);
+        nestedDissection(b, order);
+        rcm(sep, order);
+    }
+
+private:
+    uint _degree(uint v) const
+    { return pBegin[v + 1] - pBegin[v]; }
+
+    // Breadth first search from root within its part, recording the
+    // vertices visited in order and their levels. Returns the number of
+    // levels.
+    uint _bfs(uint root, std::vector<uint> & visited)
+    {
+        uint p = pPart[root];
+        ++pStamp;
+        visited.clear();
+        visited.push_back(root);
+        pMark[root] = pStamp;
+        pLevel[root] = 0;
+        for (size_t head = 0; head < visited.size(); ++head)
+        {
+            uint u = visited[head];
+            for (uint k = pBegin[u]; k < pBegin[u + 1]; ++k)
+            {
+                uint w = pAdj[k];
+                if (pPart[w] != p || pMark[w] == pStamp) continue;
+                pMark[w] = pStamp;
+                pLevel[w] = pLevel[u] + 1;
+                visited.push_back(w);
+            }
+        }
+        return pLevel[visited.back()] + 1;
+    }
+
+    // Pseudo-peripheral vertex of the component of start, by the method
+    // of Gibbs, Poole and Stockmeyer as refined by George and Liu. On
+    // return visited and the levels are those of the search from it.
+    uint _peripheral(uint start, std::vector<uint> & visited)
+    {
+        uint r = start;
+        uint nlevels = _bfs(r, visited);
+        std::vector<uint> from_x;
+        for (;;)
+        {
+            // Vertex of least degree in the last level.
+            uint last = pLevel[visited.back()];
+            uint x = visited.back();
+            for (auto it = visited.rbegin(); it != visited.rend() && pLevel[*it] == last; ++it)
+                if (_degree(*it) < _degree(x)) x = *it;
+
+            uint nx = _bfs(x, from_x);
+            if (nx <= nlevels)
+            {
+                _bfs(r, visited);
+                return r;
+            }
+            r = x;
+            nlevels = nx;
+            visited.swap(from_x);
+        }
+    }
+
+    std::vector<uint> const &   pBegin;
+    std::vector<uint> const &   pAdj;
+    std::vector<uint>           pPart;
+    std::vector<uint>           pMark;
+    std::vector<uint>           pLevel;
+    uint                        pStamp;
+    uint                        pNParts;
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void sefield::TetMesh::axisOrderElements(uint opt_method, std::string const & opt_file_name, double search_percent)
 {
 
@@ -525,6 +710,51 @@ void sefield::TetMesh::axisOrderElements(uint opt_method, std::string const & op
 
     }
 
+    if (opt_method == 0)
+    {
+        // Keep the order, and the identity permutation set up by
+        // extractConnections().
+        return;
+    }
+
+    if (opt_method == 3 || opt_method == 4)
+    {
+        // Reverse Cuthill-McKee, or nested dissection for the sparse
+        // solvers, on the graph of the vertex connections.
+        uint nverts = pElements.size();
+        std::vector<uint> begin(nverts + 1, 0);
+        std::vector<uint> adj;
+        for (uint v = 0; v < nverts; ++v)
+        {
+            VertexElement * ve = pElements[v];
+            for (uint i = 0; i < ve->getNCon(); ++i) adj.push_back(ve->nbrIdx(i));
+            begin[v + 1] = adj.size();
+        }
+
+        std::vector<uint> verts(nverts);
+        for (uint v = 0; v < nverts; ++v) verts[v] = v;
+        std::vector<uint> order;
+        order.reserve(nverts);
+        VertexOrdering ordering(begin, adj);
+        if (opt_method == 3) ordering.rcm(verts, order);
+        else ordering.nestedDissection(verts, order);
+
+        std::vector<VertexElement*> orig_indices = pElements;
+        for (uint ielt = 0; ielt < nverts; ++ielt)
+        {
+            pElements[ielt] = orig_indices[order[ielt]];
+            pVertexPerm[order[ielt]] = ielt;
+        }
+        reindexElements();
+        reordered();
+
+        stringstream ss;
+        ss << "\n-- " << (opt_method == 3 ? "Reverse Cuthill-McKee" : "Nested dissection");
+        ss << " vertex ordering: half bandwidth " << halfBandwidth();
+        ss << ", profile " << profile() << " --" << std::endl;
+        cout << ss.str() << endl;
+        return;
+    }
 
     if (opt_method == 2)
     {
@@ -938,6 +1168,38 @@ sefield::VertexConnection * sefield::TetMesh::newConnection
 
 ////////////////////////////////////////////////////////////////////////////////
 
+uint sefield::TetMesh::halfBandwidth(void)
+{
+    uint halfbw = 0;
+    for (VertexElement * ve: pElements)
+    {
+        for (uint i = 0; i < ve->getNCon(); ++i)
+        {
+            uint nbr = ve->nbrIdx(i);
+            uint d = nbr > ve->getIDX() ? nbr - ve->getIDX() : ve->getIDX() - nbr;
+            halfbw = std::max(halfbw, d);
+        }
+    }
+    return halfbw;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong sefield::TetMesh::profile(void)
+{
+    ulong prof = 0;
+    for (VertexElement * ve: pElements)
+    {
+        uint first = ve->getIDX();
+        for (uint i = 0; i < ve->getNCon(); ++i)
+            first = std::min(first, ve->nbrIdx(i));
+        prof += ve->getIDX() - first;
+    }
+    return prof;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::vector<uint> sefield::TetMesh::getVertexPermutation(void)
 {
     uint nverts = countVertices();
@@ -303,6 +303,13 @@ public:
     /// Originally from Mesh.
     /// Iain: big changes here
     ///
+    /// opt_method 0 keeps the vertices in the order they were given in,
+    /// for solvers that do not depend on the bandwidth. 1 sorts them along
+    /// the principal axis, 2 samples breadth first searches for the least
+    /// bandwidth. 3 is the reverse Cuthill-McKee order from
+    /// pseudo-peripheral vertices, and 4 a nested dissection order for the
+    /// sparse solvers; both take O(E log V) time.
+    ///
     void axisOrderElements(uint opt_method, std::string const & opt_file_name ="", double search_percent=100.0);
 
     void saveOptimal(std::string const & opt_file_name);
@@ -330,6 +337,15 @@ public:
 
     std::vector<uint> getVertexPermutation(void);
 
+    /// Half bandwidth of the connection matrix in the current order.
+    ///
+    uint halfBandwidth(void);
+
+    /// Profile of the connection matrix in the current order: the sum
+    /// over the rows of the distance from the first column to the diagonal.
+    ///
+    ulong profile(void);
+
     ////////////////////////////////////////////////////////////////////////
     // FROM TETMESH
     ////////////////////////////////////////////////////////////////////////
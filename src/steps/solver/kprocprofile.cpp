@@ -0,0 +1,155 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#    
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#    
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#    
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################   
+
+ */
+
+
+// STL headers.
+#include <cassert>
+#include <sstream>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/solver/compdef.hpp"
+#include "steps/solver/diffdef.hpp"
+#include "steps/solver/ghkcurrdef.hpp"
+#include "steps/solver/kprocprofile.hpp"
+#include "steps/solver/patchdef.hpp"
+#include "steps/solver/reacdef.hpp"
+#include "steps/solver/sreacdef.hpp"
+#include "steps/solver/statedef.hpp"
+#include "steps/solver/vdepsreacdef.hpp"
+#include "steps/solver/vdeptransdef.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace ssolver = steps::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+ssolver::KProcProfile::KProcProfile(Statedef * sd)
+: pRows()
+, pCompRows()
+, pPatchRows()
+, pKProcRows()
+{
+    assert(sd != 0);
+
+    uint ncomps = sd->countComps();
+    for (uint c = 0; c < ncomps; ++c)
+    {
+        Compdef * cdef = sd->compdef(c);
+        pCompRows.push_back(pRows.size());
+
+        uint nreacs = cdef->countReacs();
+        for (uint i = 0; i < nreacs; ++i)
+            _addRow(PROFILE_REAC, cdef->reacdef(i)->gidx(), c);
+        uint ndiffs = cdef->countDiffs();
+        for (uint i = 0; i < ndiffs; ++i)
+            _addRow(PROFILE_DIFF, cdef->diffdef(i)->gidx(), c);
+    }
+    pCompRows.push_back(pRows.size());
+
+    uint npatches = sd->countPatches();
+    for (uint p = 0; p < npatches; ++p)
+    {
+        Patchdef * pdef = sd->patchdef(p);
+        pPatchRows.push_back(pRows.size());
+
+        uint nsreacs = pdef->countSReacs();
+        for (uint i = 0; i < nsreacs; ++i)
+            _addRow(PROFILE_SREAC, pdef->sreacdef(i)->gidx(), p);
+        uint nsdiffs = pdef->countSurfDiffs();
+        for (uint i = 0; i < nsdiffs; ++i)
+            _addRow(PROFILE_SDIFF, pdef->surfdiffdef(i)->gidx(), p);
+        uint nvdtrans = pdef->countVDepTrans();
+        for (uint i = 0; i < nvdtrans; ++i)
+            _addRow(PROFILE_VDEPTRANS, pdef->vdeptransdef(i)->gidx(), p);
+        uint nvdsreacs = pdef->countVDepSReacs();
+        for (uint i = 0; i < nvdsreacs; ++i)
+            _addRow(PROFILE_VDEPSREAC, pdef->vdepsreacdef(i)->gidx(), p);
+        uint nghkcurrs = pdef->countGHKcurrs();
+        for (uint i = 0; i < nghkcurrs; ++i)
+            _addRow(PROFILE_GHKCURR, pdef->ghkcurrdef(i)->gidx(), p);
+    }
+    pPatchRows.push_back(pRows.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::KProcProfile::_addRow(uint type, uint rule, uint container)
+{
+    KProcProfileRow r;
+    r.type = type;
+    r.rule = rule;
+    r.container = container;
+    r.nevents = 0;
+    r.napplies = 0;
+    r.nupdates = 0;
+    r.time = 0.0;
+    pRows.push_back(r);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::KProcProfile::clear(void)
+{
+    for (auto & r: pRows)
+    {
+        r.nevents = 0;
+        r.napplies = 0;
+        r.nupdates = 0;
+        r.time = 0.0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ssolver::KProcProfile::fillTable(double * table, uint size) const
+{
+    if (size != pRows.size() * NCOLS)
+    {
+        std::ostringstream os;
+        os << "Length of profile table should be " << pRows.size() * NCOLS;
+        os << " (" << pRows.size() << " rows of " << NCOLS << " columns).";
+        throw steps::ArgErr(os.str());
+    }
+
+    for (auto const & r: pRows)
+    {
+        table[0] = r.type;
+        table[1] = r.rule;
+        table[2] = r.container;
+        table[3] = r.nevents;
+        table[4] = r.napplies;
+        table[5] = r.nupdates;
+        table[6] = r.time;
+        table += NCOLS;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
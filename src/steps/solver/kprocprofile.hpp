@@ -0,0 +1,206 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_SOLVER_KPROCPROFILE_HPP
+#define STEPS_SOLVER_KPROCPROFILE_HPP 1
+
+// STL headers.
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace solver {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Forward declarations.
+class Statedef;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Kind of rule a profile row refers to.
+enum KProcProfileType
+{
+    PROFILE_REAC = 0,
+    PROFILE_DIFF,
+    PROFILE_SREAC,
+    PROFILE_SDIFF,
+    PROFILE_VDEPTRANS,
+    PROFILE_VDEPSREAC,
+    PROFILE_GHKCURR
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Accumulated cost of all kprocs of one rule in one compartment or patch.
+struct KProcProfileRow
+{
+    // KProcProfileType of the rule.
+    uint                                type;
+    // Global index of the rule within its type, e.g. of the reaction.
+    uint                                rule;
+    // Global index of the compartment, or of the patch for surface rules.
+    uint                                container;
+
+    // Number of reactions fired or molecules moved.
+    ulong                               nevents;
+    // Number of times the kprocs fired; a single diffusion step of the
+    // operator splitting solvers can move several molecules.
+    ulong                               napplies;
+    // Number of kproc rate updates that followed these firings.
+    ulong                               nupdates;
+    // Wall-clock time in seconds spent in apply() and the updates.
+    double                              time;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Per rule, per compartment/patch event profile of a spatial solver.
+///
+/// The rows are laid out from the state definition alone: for every
+/// compartment its reactions followed by its diffusions, then for every
+/// patch its surface reactions, surface diffusions, voltage-dependent
+/// transitions, voltage-dependent surface reactions and GHK currents. This
+/// is the order in which tets and tris create their kprocs, so the row of
+/// the j-th kproc of an element is the first row of its compartment or
+/// patch plus j, and every MPI rank holds the same table.
+///
+class KProcProfile
+{
+
+public:
+
+    /// Number of columns of the table written by fillTable().
+    static const uint NCOLS = 7;
+
+    KProcProfile(Statedef * sd);
+
+    ////////////////////////////////////////////////////////////////////////
+
+    inline uint countRows(void) const
+    { return pRows.size(); }
+
+    inline std::vector<KProcProfileRow> const & rows(void) const
+    { return pRows; }
+
+    inline std::vector<KProcProfileRow> & rows(void)
+    { return pRows; }
+
+    /// Row of the j-th kproc of a tet or well-mixed volume in compartment cidx.
+    inline uint compRow(uint cidx, uint j) const
+    {
+        assert(cidx + 1 < pCompRows.size());
+        assert(pCompRows[cidx] + j < pCompRows[cidx + 1]);
+        return pCompRows[cidx] + j;
+    }
+
+    /// Row of the j-th kproc of a triangle in patch pidx.
+    inline uint patchRow(uint pidx, uint j) const
+    {
+        assert(pidx + 1 < pPatchRows.size());
+        assert(pPatchRows[pidx] + j < pPatchRows[pidx + 1]);
+        return pPatchRows[pidx] + j;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Row of each kproc by schedule index; the solver fills this in once
+    /// its kprocs exist.
+    inline void setKProcRow(uint sidx, uint row)
+    {
+        if (sidx >= pKProcRows.size()) pKProcRows.resize(sidx + 1, 0);
+        pKProcRows[sidx] = row;
+    }
+
+    inline void record(uint sidx, ulong nevents, ulong nupdates, double time)
+    {
+        assert(sidx < pKProcRows.size());
+        KProcProfileRow & r = pRows[pKProcRows[sidx]];
+        r.nevents += nevents;
+        r.napplies++;
+        r.nupdates += nupdates;
+        r.time += time;
+    }
+
+    /// Add kproc updates and their cost to a kproc without counting a call.
+    inline void recordUpdates(uint sidx, ulong nupdates, double time)
+    {
+        assert(sidx < pKProcRows.size());
+        KProcProfileRow & r = pRows[pKProcRows[sidx]];
+        r.nupdates += nupdates;
+        r.time += time;
+    }
+
+    /// Zero all counters, keeping the layout.
+    void clear(void);
+
+    /// Write the table row by row as (type, rule, container, nevents,
+    /// napplies, nupdates, time) into a buffer of countRows() * NCOLS
+    /// doubles.
+    void fillTable(double * table, uint size) const;
+
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Wall-clock time in seconds, for timing apply() and updates.
+    static inline double now(void)
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    ////////////////////////////////////////////////////////////////////////
+
+    void _addRow(uint type, uint rule, uint container);
+
+    std::vector<KProcProfileRow>        pRows;
+
+    // First row of each compartment and patch, with a closing entry.
+    std::vector<uint>                   pCompRows;
+    std::vector<uint>                   pPatchRows;
+
+    std::vector<uint>                   pKProcRows;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_SOLVER_KPROCPROFILE_HPP
+
+// END
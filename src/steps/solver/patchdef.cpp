@@ -738,6 +738,13 @@ void ssolver::Patchdef::setup_indices(void)
                 }
             }
         }
+
+        pSReac_LHS_I_Sparse.build(pSReac_LHS_I_Spec, pSReacsN, pSpecsN_I);
+        pSReac_LHS_S_Sparse.build(pSReac_LHS_S_Spec, pSReacsN, pSpecsN_S);
+        pSReac_LHS_O_Sparse.build(pSReac_LHS_O_Spec, pSReacsN, pSpecsN_O);
+        pSReac_UPD_I_Sparse.build(pSReac_UPD_I_Spec, pSReacsN, pSpecsN_I);
+        pSReac_UPD_S_Sparse.build(pSReac_UPD_S_Spec, pSReacsN, pSpecsN_S);
+        pSReac_UPD_O_Sparse.build(pSReac_UPD_O_Spec, pSReacsN, pSpecsN_O);
     }
 
     // 3.5 -- DEAL WITH PATCH SURFACE-DIFFUSION
@@ -879,6 +886,13 @@ void ssolver::Patchdef::setup_indices(void)
                 }
             }
         }
+
+        pVDepSReac_LHS_I_Sparse.build(pVDepSReac_LHS_I_Spec, pVDepSReacsN, pSpecsN_I);
+        pVDepSReac_LHS_S_Sparse.build(pVDepSReac_LHS_S_Spec, pVDepSReacsN, pSpecsN_S);
+        pVDepSReac_LHS_O_Sparse.build(pVDepSReac_LHS_O_Spec, pVDepSReacsN, pSpecsN_O);
+        pVDepSReac_UPD_I_Sparse.build(pVDepSReac_UPD_I_Spec, pVDepSReacsN, pSpecsN_I);
+        pVDepSReac_UPD_S_Sparse.build(pVDepSReac_UPD_S_Spec, pVDepSReacsN, pSpecsN_S);
+        pVDepSReac_UPD_O_Sparse.build(pVDepSReac_UPD_O_Spec, pVDepSReacsN, pSpecsN_O);
     }
     // 5 -- DEAL WITH OHMIC CURRENTS
     if (pOhmicCurrsN != 0)
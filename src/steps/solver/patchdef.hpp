@@ -43,6 +43,7 @@
 #include "steps/common.h"
 #include "steps/solver/statedef.hpp"
 #include "steps/solver/api.hpp"
+#include "steps/solver/sparsestoich.hpp"
 #include "steps/geom/patch.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -275,6 +276,21 @@ public:
     int * sreac_upd_O_bgn(uint lidx) const;
     int * sreac_upd_O_end(uint lidx) const;
 
+    // Return the non-zero entries of the lhs and update arrays of surface reaction
+    // specified by local index argument.
+    inline SparseStoich<uint>::Range sreac_lhs_I_sparse(uint lidx) const
+    { return pSReac_LHS_I_Sparse[lidx]; }
+    inline SparseStoich<uint>::Range sreac_lhs_S_sparse(uint lidx) const
+    { return pSReac_LHS_S_Sparse[lidx]; }
+    inline SparseStoich<uint>::Range sreac_lhs_O_sparse(uint lidx) const
+    { return pSReac_LHS_O_Sparse[lidx]; }
+    inline SparseStoich<int>::Range sreac_upd_I_sparse(uint lidx) const
+    { return pSReac_UPD_I_Sparse[lidx]; }
+    inline SparseStoich<int>::Range sreac_upd_S_sparse(uint lidx) const
+    { return pSReac_UPD_S_Sparse[lidx]; }
+    inline SparseStoich<int>::Range sreac_upd_O_sparse(uint lidx) const
+    { return pSReac_UPD_O_Sparse[lidx]; }
+
     /// Return pointer to flags on surface reactions for this patch.
     inline uint * srflags(void) const
     { return pSReacFlags; }
@@ -467,6 +483,21 @@ public:
     int * vdepsreac_upd_O_bgn(uint lidx) const;
     int * vdepsreac_upd_O_end(uint lidx) const;
 
+    // Return the non-zero entries of the lhs and update arrays of voltage-dependent surface reaction
+    // specified by local index argument.
+    inline SparseStoich<uint>::Range vdepsreac_lhs_I_sparse(uint lidx) const
+    { return pVDepSReac_LHS_I_Sparse[lidx]; }
+    inline SparseStoich<uint>::Range vdepsreac_lhs_S_sparse(uint lidx) const
+    { return pVDepSReac_LHS_S_Sparse[lidx]; }
+    inline SparseStoich<uint>::Range vdepsreac_lhs_O_sparse(uint lidx) const
+    { return pVDepSReac_LHS_O_Sparse[lidx]; }
+    inline SparseStoich<int>::Range vdepsreac_upd_I_sparse(uint lidx) const
+    { return pVDepSReac_UPD_I_Sparse[lidx]; }
+    inline SparseStoich<int>::Range vdepsreac_upd_S_sparse(uint lidx) const
+    { return pVDepSReac_UPD_S_Sparse[lidx]; }
+    inline SparseStoich<int>::Range vdepsreac_upd_O_sparse(uint lidx) const
+    { return pVDepSReac_UPD_O_Sparse[lidx]; }
+
 
     ////////////////////////////////////////////////////////////////////////
     // SOLVER METHODS: SURFACE REACTIONS
@@ -588,6 +619,14 @@ private:
     int                               * pSReac_UPD_S_Spec;
     int                               * pSReac_UPD_O_Spec;
 
+    // Non-zero entries of the _LHS and _UPD arrays above.
+    SparseStoich<uint>                  pSReac_LHS_I_Sparse;
+    SparseStoich<uint>                  pSReac_LHS_S_Sparse;
+    SparseStoich<uint>                  pSReac_LHS_O_Sparse;
+    SparseStoich<int>                   pSReac_UPD_I_Sparse;
+    SparseStoich<int>                   pSReac_UPD_S_Sparse;
+    SparseStoich<int>                   pSReac_UPD_O_Sparse;
+
     ////////////////////////////////////////////////////////////////////////
     // DATA: SURFACE DIFFUSION RULES
     ////////////////////////////////////////////////////////////////////////
@@ -646,6 +685,14 @@ private:
     int                               * pVDepSReac_UPD_S_Spec;
     int                               * pVDepSReac_UPD_O_Spec;
 
+    // Non-zero entries of the _LHS and _UPD arrays above.
+    SparseStoich<uint>                  pVDepSReac_LHS_I_Sparse;
+    SparseStoich<uint>                  pVDepSReac_LHS_S_Sparse;
+    SparseStoich<uint>                  pVDepSReac_LHS_O_Sparse;
+    SparseStoich<int>                   pVDepSReac_UPD_I_Sparse;
+    SparseStoich<int>                   pVDepSReac_UPD_S_Sparse;
+    SparseStoich<int>                   pVDepSReac_UPD_O_Sparse;
+
     ////////////////////////////////////////////////////////////////////////
     // DATA: OHMIC CURRENTS
     ////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,148 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_SOLVER_SPARSESTOICH_HPP
+#define STEPS_SOLVER_SPARSESTOICH_HPP 1
+
+// STL headers.
+#include <cassert>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace solver {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Non-zero entry of a stoichiometry table: local species index and
+/// coefficient.
+template <typename T>
+struct SpecCoef
+{
+    uint                                idx;
+    T                                   coef;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Sparse (species index, coefficient) lists of a set of rules, compiled
+/// from a dense table with one row of countSpecs() entries per rule.
+///
+/// Kinetic processes iterate over these lists instead of the dense rows,
+/// so the cost of computing a propensity or applying an update depends on
+/// the number of species taking part in the rule rather than on the number
+/// of species defined in the compartment or patch.
+///
+template <typename T>
+class SparseStoich
+{
+
+public:
+
+    typedef SpecCoef<T> const *         const_iterator;
+
+    /// Entries of a single rule, usable in range-based for loops.
+    struct Range
+    {
+        const_iterator                  first;
+        const_iterator                  last;
+
+        inline const_iterator begin(void) const
+        { return first; }
+
+        inline const_iterator end(void) const
+        { return last; }
+
+        inline bool empty(void) const
+        { return first == last; }
+    };
+
+    ////////////////////////////////////////////////////////////////////////
+
+    SparseStoich(void)
+    : pOffsets(1, 0)
+    , pEntries()
+    {
+    }
+
+    /// (Re)build from a dense table of nrules x nspecs entries. A null
+    /// table, as used for a missing outer compartment, yields empty lists.
+    void build(T const * dense, uint nrules, uint nspecs)
+    {
+        pOffsets.assign(1, 0);
+        pEntries.clear();
+        for (uint r = 0; r < nrules; ++r)
+        {
+            if (dense != 0)
+            {
+                T const * row = dense + r * nspecs;
+                for (uint s = 0; s < nspecs; ++s)
+                {
+                    if (row[s] == 0) continue;
+                    SpecCoef<T> e;
+                    e.idx = s;
+                    e.coef = row[s];
+                    pEntries.push_back(e);
+                }
+            }
+            pOffsets.push_back(pEntries.size());
+        }
+    }
+
+    inline uint countRules(void) const
+    { return pOffsets.size() - 1; }
+
+    inline Range operator[](uint rule) const
+    {
+        assert(rule + 1 < pOffsets.size());
+        Range r;
+        r.first = pEntries.data() + pOffsets[rule];
+        r.last = pEntries.data() + pOffsets[rule + 1];
+        return r;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    std::vector<uint>                   pOffsets;
+    std::vector<SpecCoef<T> >           pEntries;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_SOLVER_SPARSESTOICH_HPP
+
+// END
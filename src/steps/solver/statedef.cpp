@@ -464,6 +464,52 @@ void ssolver::Statedef::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static steps::util::hash_type hash_name(steps::util::hash_type h, std::string const & name)
+{
+    h = steps::util::fnv1a_combine(h, static_cast<uint>(name.size()));
+    for (auto c: name) h = steps::util::fnv1a_combine(h, c);
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+steps::util::hash_type ssolver::Statedef::fingerprint(void) const
+{
+    steps::util::hash_type h = steps::util::fnv1a(countSpecs(), countComps(),
+        countPatches(), countReacs(), countSReacs(), countDiffs(),
+        countSurfDiffs(), countVDepTrans(), countVDepSReacs(),
+        countOhmicCurrs(), countGHKcurrs(), countDiffBoundaries(),
+        countSDiffBoundaries(), static_cast<uint>(pChandefs.size()));
+
+    for (auto s: pSpecdefs) h = hash_name(h, s->name());
+    for (auto ch: pChandefs) h = hash_name(h, ch->name());
+    for (auto c: pCompdefs)
+    {
+        h = hash_name(h, c->name());
+        h = steps::util::fnv1a_combine(h, c->countSpecs(), c->countReacs(), c->countDiffs());
+    }
+    for (auto p: pPatchdefs)
+    {
+        h = hash_name(h, p->name());
+        h = steps::util::fnv1a_combine(h, p->countSpecs(), p->countSReacs(),
+            p->countSurfDiffs(), p->countVDepTrans(), p->countVDepSReacs(),
+            p->countOhmicCurrs(), p->countGHKcurrs());
+    }
+    for (auto r: pReacdefs) h = hash_name(h, r->name());
+    for (auto sr: pSReacdefs) h = hash_name(h, sr->name());
+    for (auto d: pDiffdefs) h = hash_name(h, d->name());
+    for (auto sd: pSurfDiffdefs) h = hash_name(h, sd->name());
+    for (auto vdt: pVDepTransdefs) h = hash_name(h, vdt->name());
+    for (auto vdsr: pVDepSReacdefs) h = hash_name(h, vdsr->name());
+    for (auto oc: pOhmicCurrdefs) h = hash_name(h, oc->name());
+    for (auto ghk: pGHKcurrdefs) h = hash_name(h, ghk->name());
+    for (auto db: pDiffBoundarydefs) h = hash_name(h, db->name());
+    for (auto sdb: pSDiffBoundarydefs) h = hash_name(h, sdb->name());
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 ssolver::Compdef * ssolver::Statedef::compdef(uint gidx) const
 {
     assert(gidx < pCompdefs.size());
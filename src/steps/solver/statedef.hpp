@@ -43,6 +43,7 @@
 // STEPS headers.
 #include "steps/common.h"
 #include "steps/geom/geom.hpp"
+#include "steps/util/fnv_hash.hpp"
 #include "steps/model/model.hpp"
 #include "steps/rng/rng.hpp"
 #include "steps/solver/api.hpp"
@@ -185,6 +186,10 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// Hash of the names and sizes of all objects of the state definition,
+    /// identifying the layout of the solver state in checkpoints.
+    steps::util::hash_type fingerprint(void) const;
+
     ////////////////////////////////////////////////////////////////////////
     // DATA ACCESS: COMPARTMENTS
     ////////////////////////////////////////////////////////////////////////
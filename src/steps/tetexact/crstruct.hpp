@@ -28,15 +28,17 @@
 #define STEPS_TETEXACT_CRSTRUCT_HPP 1
 
 #include <iostream>
+#include <fstream>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
+#include "steps/common.h"
 #include "steps/error.hpp"
-#include "steps/tetexact/kproc.hpp"
 ////////////////////////////////////////////////////////////////////////////////
 
  namespace steps {
  namespace tetexact {
-class KProc;
 
 struct CRGroup {
     CRGroup(int power, uint init_size = 1024) {
@@ -44,7 +46,7 @@ struct CRGroup {
         sum = 0.0;
         capacity = init_size;
         size = 0;
-        indices = (KProc**)malloc(sizeof(KProc*) * init_size);
+        indices = (uint*)malloc(sizeof(uint) * init_size);
         if (indices == NULL)
             throw steps::SysErr("DirectCR: unable to allocate memory for SSA group.");
 
@@ -66,21 +68,170 @@ struct CRGroup {
     unsigned                                size;
     double                                  max;
     double                                  sum;
-    KProc**                                 indices;
+    // schedule indices of the member kprocs
+    uint*                                   indices;
 };
 
-struct CRKProcData {
-    CRKProcData() {
-        recorded = false;
-        pow = 0;
-        pos = 0;
-        rate = 0.0;
+/// CR scheduling data of all kprocs, stored as one contiguous array per
+/// field and indexed by the kproc schedule index.
+///
+/// Keeping the rates in a single array means the rejection loop in a group
+/// only touches this table, not the kproc objects themselves.
+///
+struct CRKProcTable {
+    inline uint size(void) const
+    { return rate.size(); }
+
+    /// Append an entry for a new kproc of the given kind.
+    inline void push_back(uint k) {
+        kind.push_back(k);
+        recorded.push_back(0);
+        pow.push_back(0);
+        pos.push_back(0);
+        rate.push_back(0.0);
     }
 
-    bool                                    recorded;
-    int                                     pow;
-    unsigned                                pos;
-    double                                  rate;
+    inline void reset(void) {
+        std::fill(recorded.begin(), recorded.end(), 0);
+        std::fill(pow.begin(), pow.end(), 0);
+        std::fill(pos.begin(), pos.end(), 0);
+        std::fill(rate.begin(), rate.end(), 0.0);
+    }
+
+    /// Write the data of entry idx, in the layout formerly written by
+    /// each kproc at the end of its own checkpoint data.
+    inline void checkpoint(uint idx, std::fstream & cp_file) const {
+        bool rec = recorded[idx];
+        cp_file.write((char*)&rec, sizeof(bool));
+        cp_file.write((char*)&(pow[idx]), sizeof(int));
+        cp_file.write((char*)&(pos[idx]), sizeof(unsigned));
+        cp_file.write((char*)&(rate[idx]), sizeof(double));
+    }
+
+    inline void restore(uint idx, std::fstream & cp_file) {
+        bool rec;
+        cp_file.read((char*)&rec, sizeof(bool));
+        recorded[idx] = rec;
+        cp_file.read((char*)&(pow[idx]), sizeof(int));
+        cp_file.read((char*)&(pos[idx]), sizeof(unsigned));
+        cp_file.read((char*)&(rate[idx]), sizeof(double));
+    }
+
+    // KProcKind of each kproc; not reset
+    std::vector<unsigned char>              kind;
+    std::vector<unsigned char>              recorded;
+    std::vector<int>                        pow;
+    std::vector<unsigned>                   pos;
+    std::vector<double>                     rate;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Binary indexed (Fenwick) tree over the sums of a vector of CRGroups.
+///
+/// Leaf i mirrors the sum of group i, so that the total propensity and the
+/// group holding a given partial sum are both found in O(log G) instead of
+/// walking every group.
+///
+/// Trees over groups are kept with refresh(), which recomputes the nodes on
+/// the path of a changed leaf from the group sums in O(log^2 G). Every node
+/// is then the same function of the current group sums, whatever the order
+/// of the updates that led there, and equal bit for bit to the nodes built
+/// by rebuild(). add() accumulates deltas instead, and the rounding of its
+/// nodes depends on the update history.
+///
+struct CRSumTree {
+    CRSumTree() : nodes(1, 0.0) {}
+
+    inline uint size(void) const
+    { return nodes.size() - 1; }
+
+    /// Clear all leaves.
+    inline void clear(void)
+    { nodes.assign(1, 0.0); }
+
+    /// Append empty leaves up to new_size.
+    inline void extend(uint new_size) {
+        for (uint i = size() + 1; i <= new_size; i++) {
+            // node i covers the leaves (i - lowbit(i), i]
+            double sum = 0.0;
+            uint lower = i - (i & -i);
+            for (uint j = i - 1; j > lower; j -= (j & -j)) sum += nodes[j];
+            nodes.push_back(sum);
+        }
+    }
+
+    /// Recompute the nodes covering leaf idx after the sum of group idx
+    /// has changed.
+    inline void refresh(uint idx, std::vector<CRGroup*> const & groups) {
+        uint n = size();
+        for (uint i = idx + 1; i <= n; i += (i & -i)) nodes[i] = _node(i, groups);
+    }
+
+    /// Add delta to leaf idx.
+    inline void add(uint idx, double delta) {
+        uint n = size();
+        for (uint i = idx + 1; i <= n; i += (i & -i)) nodes[i] += delta;
+    }
+
+    /// Sum of all leaves.
+    inline double total(void) const {
+        double sum = 0.0;
+        for (uint i = size(); i > 0; i -= (i & -i)) sum += nodes[i];
+        return sum;
+    }
+
+    /// Find the first leaf whose prefix sum is not smaller than selector,
+    /// i.e. the group a linear scan would stop at.
+    /// On return selector holds the remainder within that leaf.
+    /// Returns size() if selector exceeds the total.
+    inline uint search(double & selector) const {
+        uint n = size();
+        uint step = 1;
+        while ((step << 1) <= n) step <<= 1;
+
+        uint pos = 0;
+        for (; step != 0; step >>= 1) {
+            uint next = pos + step;
+            if (next <= n && nodes[next] < selector) {
+                pos = next;
+                selector -= nodes[next];
+            }
+        }
+        return pos;
+    }
+
+    /// Rebuild all nodes from the group sums in O(G log G).
+    inline void rebuild(std::vector<CRGroup*> const & groups) {
+        uint n = groups.size();
+        nodes.assign(n + 1, 0.0);
+        for (uint i = 1; i <= n; i++) nodes[i] = _node(i, groups);
+    }
+
+    /// Rebuild all nodes from exact leaf values, for trees whose leaves
+    /// are individual propensities rather than group sums.
+    inline void rebuild(std::vector<double> const & leaves) {
+        uint n = leaves.size();
+        nodes.assign(n + 1, 0.0);
+        for (uint i = 1; i <= n; i++) {
+            nodes[i] += leaves[i - 1];
+            uint parent = i + (i & -i);
+            if (parent <= n) nodes[parent] += nodes[i];
+        }
+    }
+
+    // 1-based node storage, nodes[0] is unused
+    std::vector<double>                     nodes;
+
+private:
+    // Node i from leaf i - 1 and the child nodes below it, always summed
+    // in the same order. The children must be up to date.
+    inline double _node(uint i, std::vector<CRGroup*> const & groups) const {
+        double sum = groups[i - 1]->sum;
+        uint lower = i - (i & -i);
+        for (uint j = i - 1; j > lower; j -= (j & -j)) sum += nodes[j];
+        return sum;
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,173 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+// Standard library & STL headers.
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/tetexact/depgraph.hpp"
+#include "steps/tetexact/kproc.hpp"
+#include "steps/util/fnv_hash.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace stex = steps::tetexact;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Number of kprocs whose dependency rows are held in memory at the same
+// time while building the graph.
+static const uint DEPGRAPH_CHUNK = 16384;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline steps::util::hash_type hash_row(stex::SchedIDXVec const & row)
+{
+    steps::util::hash_type h = steps::util::fnv1a(row.size());
+    for (auto idx: row) h = steps::util::fnv1a_combine(h, idx);
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::KProcDepGraph::KProcDepGraph(void)
+: pKProcRows()
+, pRows()
+, pOffsets()
+, pIndices()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::KProcDepGraph::~KProcDepGraph(void)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::KProcDepGraph::clear(void)
+{
+    pKProcRows.clear();
+    pRows.clear();
+    pOffsets.clear();
+    pIndices.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::KProcDepGraph::build(std::vector<stex::KProc *> const & kprocs)
+{
+    if (kprocs.size() >= std::numeric_limits<index_type>::max())
+        throw steps::SysErr("Too many kinetic processes for the dependency graph.");
+
+    clear();
+    pKProcRows.reserve(kprocs.size() + 1);
+    pKProcRows.push_back(0);
+    pOffsets.push_back(0);
+
+    // Stored rows by content hash, for sharing of identical rows.
+    std::unordered_multimap<steps::util::hash_type, index_type> stored;
+
+    uint nkprocs = kprocs.size();
+    std::vector<std::vector<SchedIDXVec> > chunk_rows;
+
+    for (uint cbgn = 0; cbgn < nkprocs; cbgn += DEPGRAPH_CHUNK)
+    {
+        int csize = std::min(DEPGRAPH_CHUNK, nkprocs - cbgn);
+        chunk_rows.resize(csize);
+
+        // Collect and normalise the rows of this chunk.
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int i = 0; i < csize; ++i)
+        {
+            std::vector<SchedIDXVec> & rows = chunk_rows[i];
+            kprocs[cbgn + i]->setupDeps(rows);
+            for (auto & row: rows)
+            {
+                std::sort(row.begin(), row.end());
+                row.erase(std::unique(row.begin(), row.end()), row.end());
+            }
+        }
+
+        // Merge into the flat arrays.
+        for (int i = 0; i < csize; ++i)
+        {
+            for (auto const & row: chunk_rows[i])
+            {
+                if (pRows.size() >= std::numeric_limits<index_type>::max())
+                    throw steps::SysErr("Too many kinetic process outcomes for the dependency graph.");
+
+                steps::util::hash_type h = hash_row(row);
+                auto range = stored.equal_range(h);
+                auto s = range.first;
+                for (; s != range.second; ++s)
+                {
+                    index_type r = s->second;
+                    if (pOffsets[r + 1] - pOffsets[r] == row.size()
+                        && std::equal(row.begin(), row.end(),
+                                      pIndices.begin() + pOffsets[r]))
+                        break;
+                }
+
+                if (s != range.second)
+                {
+                    pRows.push_back(s->second);
+                    continue;
+                }
+
+                if (row.size() >= std::numeric_limits<index_type>::max() - pIndices.size())
+                    throw steps::SysErr("Too many dependencies for the dependency graph.");
+
+                index_type r = pOffsets.size() - 1;
+                pIndices.insert(pIndices.end(), row.begin(), row.end());
+                pOffsets.push_back(pIndices.size());
+                stored.insert(std::make_pair(h, r));
+                pRows.push_back(r);
+            }
+            pKProcRows.push_back(pRows.size());
+            chunk_rows[i].clear();
+        }
+    }
+
+    pRows.shrink_to_fit();
+    pOffsets.shrink_to_fit();
+    pIndices.shrink_to_fit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
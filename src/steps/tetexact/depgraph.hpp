@@ -0,0 +1,149 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_TETEXACT_DEPGRAPH_HPP
+#define STEPS_TETEXACT_DEPGRAPH_HPP 1
+
+// STL headers.
+#include <cassert>
+#include <cinttypes>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/tetexact/kproc.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace tetexact {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Flat (compressed sparse row) dependency graph of the Tetexact kprocs.
+///
+/// Every kproc owns one or more consecutive rows, one per outcome of
+/// KProc::apply(). A row lists the schedule indices of the kprocs whose
+/// rate has to be recomputed after that outcome, sorted and without
+/// duplicates. Rows with identical contents, e.g. those of reactions in
+/// the same tetrahedron that change the same species, are stored only once.
+/// Rows hold absolute schedule indices, so rows of the same kproc type in
+/// elements with the same local topology are still stored apart.
+///
+/// Rows, offsets and indices are 32 bit; build() throws a SysErr if the
+/// graph does not fit.
+///
+class KProcDepGraph
+{
+
+public:
+
+    typedef uint32_t                    index_type;
+    typedef index_type const *          const_iterator;
+
+    ////////////////////////////////////////////////////////////////////////
+    // OBJECT CONSTRUCTION & DESTRUCTION
+    ////////////////////////////////////////////////////////////////////////
+
+    KProcDepGraph(void);
+    ~KProcDepGraph(void);
+
+    ////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTION OF THE GRAPH
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Collect the dependencies of all kprocs, indexed by schedule index.
+    ///
+    /// KProc::setupDeps() is evaluated in parallel over chunks of
+    /// kprocs if OpenMP is available; the merge into the flat arrays is
+    /// sequential, so the result does not depend on the thread count.
+    ///
+    void build(std::vector<KProc *> const & kprocs);
+
+    void clear(void);
+
+    ////////////////////////////////////////////////////////////////////////
+    // ACCESS
+    ////////////////////////////////////////////////////////////////////////
+
+    inline uint countKProcs(void) const
+    { return pKProcRows.empty() ? 0 : pKProcRows.size() - 1; }
+
+    /// Number of rows over all kprocs, before sharing of identical rows.
+    inline uint countRows(void) const
+    { return pRows.size(); }
+
+    /// Number of distinct rows actually stored.
+    inline uint countUniqueRows(void) const
+    { return pOffsets.empty() ? 0 : pOffsets.size() - 1; }
+
+    /// Total number of stored dependency entries.
+    inline uint countEntries(void) const
+    { return pIndices.size(); }
+
+    inline const_iterator begin(uint kp_idx, uint row) const
+    { return pIndices.data() + pOffsets[_row(kp_idx, row)]; }
+
+    inline const_iterator end(uint kp_idx, uint row) const
+    { return pIndices.data() + pOffsets[_row(kp_idx, row) + 1]; }
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    inline index_type _row(uint kp_idx, uint row) const
+    {
+        assert(kp_idx + 1 < pKProcRows.size());
+        assert(pKProcRows[kp_idx] + row < pKProcRows[kp_idx + 1]);
+        return pRows[pKProcRows[kp_idx] + row];
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+
+    // First row of each kproc in pRows; kproc i owns the rows
+    // [pKProcRows[i], pKProcRows[i + 1]).
+    std::vector<index_type>             pKProcRows;
+
+    // Stored (possibly shared) row for each kproc row.
+    std::vector<index_type>             pRows;
+
+    // Start of each stored row in pIndices, plus the end of the last one.
+    std::vector<index_type>             pOffsets;
+
+    // Schedule indices of the dependent kprocs of all stored rows.
+    std::vector<index_type>             pIndices;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_TETEXACT_DEPGRAPH_HPP
+
+// END
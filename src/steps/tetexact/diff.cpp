@@ -54,11 +54,11 @@ stex::Diff::Diff(ssolver::Diffdef * ddef, stex::Tet * tet)
 : KProc()
 , pDiffdef(ddef)
 , pTet(tet)
-, pUpdVec()
 , pScaledDcst(0.0)
 , pDcst(0.0)
 , pCDFSelector()
 , pNeighbCompLidx()
+, pRemoteDirection()
 {
     assert(pDiffdef != 0);
     assert(pTet != 0);
@@ -170,11 +170,6 @@ void stex::Diff::checkpoint(std::fstream & cp_file)
     cp_file.write((char*)pDiffBndActive, sizeof(bool) * 4);
     cp_file.write((char*)pDiffBndDirection, sizeof(bool) * 4);
     cp_file.write((char*)pNeighbCompLidx, sizeof(int) * 4);
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -204,16 +199,54 @@ void stex::Diff::restore(std::fstream & cp_file)
     cp_file.read((char*)pDiffBndActive, sizeof(bool) * 4);
     cp_file.read((char*)pDiffBndDirection, sizeof(bool) * 4);
     cp_file.read((char*)pNeighbCompLidx, sizeof(int) * 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Diff::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+    cols.ints.push_back(directionalDcsts.size());
+    for (auto const & item: directionalDcsts)
+    {
+        cols.ints.push_back(item.first);
+        cols.reals.push_back(item.second);
+    }
+
+    cols.reals.push_back(pScaledDcst);
+    cols.reals.push_back(pDcst);
+    cols.reals.insert(cols.reals.end(), pCDFSelector, pCDFSelector + 3);
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndActive[i]);
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndDirection[i]);
+    cols.ints.insert(cols.ints.end(), pNeighbCompLidx, pNeighbCompLidx + 4);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Diff::setupDeps(void)
+void stex::Diff::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
+
+    directionalDcsts.clear();
+    uint n_direct_dcsts = cur.integer();
+    for (uint i = 0; i < n_direct_dcsts; ++i)
+    {
+        uint id = cur.integer();
+        directionalDcsts[id] = cur.real();
+    }
+
+    pScaledDcst = cur.real();
+    pDcst = cur.real();
+    cur.reals(pCDFSelector, 3);
+    for (uint i = 0; i < 4; ++i) pDiffBndActive[i] = cur.integer();
+    for (uint i = 0; i < 4; ++i) pDiffBndDirection[i] = cur.integer();
+    cur.ints(pNeighbCompLidx, 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Diff::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
     // We will check all KProcs of the following simulation elements:
     //   * the 'source' tetrahedron
@@ -229,15 +262,17 @@ void stex::Diff::setupDeps(void)
     // a triangle, there is no need to filter out duplicate dependent
     // kprocs.
 
+    upd_rows.assign(4, SchedIDXVec());
+
     // Search for dependencies in the 'source' tetrahedron.
-    std::set<stex::KProc*> local;
+    SchedIDXVec local;
 
     KProcPVecCI kprocend = pTet->kprocEnd();
     for (KProcPVecCI k = pTet->kprocBegin(); k != kprocend; ++k)
     {
         // Check locally.
         if ((*k)->depSpecTet(ligGIdx, pTet) == true) {
-            local.insert(*k);
+            local.push_back((*k)->schedIDX());
         }
     }
     // Check the neighbouring triangles.
@@ -249,7 +284,7 @@ void stex::Diff::setupDeps(void)
         for (KProcPVecCI k = next->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTet(ligGIdx, pTet) == true) {
-                local.insert(*k);
+                local.push_back((*k)->schedIDX());
             }
         }
     }
@@ -265,14 +300,15 @@ void stex::Diff::setupDeps(void)
             continue;
 
         // Copy local dependencies.
-        std::set<stex::KProc*> local2(local.begin(), local.end());
+        SchedIDXVec & local2 = upd_rows[i];
+        local2 = local;
 
         // Find the ones 'locally' in the next tet.
         kprocend = next->kprocEnd();
         for (KProcPVecCI k = next->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTet(ligGIdx, next) == true) {
-                local2.insert(*k);
+                local2.push_back((*k)->schedIDX());
             }
         }
 
@@ -290,13 +326,10 @@ void stex::Diff::setupDeps(void)
             for (KProcPVecCI k = next2->kprocBegin(); k != kprocend; ++k)
             {
                 if ((*k)->depSpecTet(ligGIdx, next) == true) {
-                    local2.insert(*k);
+                    local2.push_back((*k)->schedIDX());
                 }
             }
         }
-
-        // Copy the set to the update vector.
-        pUpdVec[i].assign(local2.begin(), local2.end());
     }
 }
 
@@ -336,11 +369,6 @@ void stex::Diff::reset(void)
 
     setActive(true);
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
-
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -545,7 +573,7 @@ double stex::Diff::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::Diff::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::Diff::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     //uint lidxTet = this->lidxTet;
     // Pre-fetch some general info.
@@ -575,7 +603,8 @@ std::vector<stex::KProc*> const & stex::Diff::apply(steps::rng::RNG * rng, doubl
     assert (nexttet != 0);
     assert(pNeighbCompLidx[iSel] > -1);
 
-    if (nexttet->clamped(pNeighbCompLidx[iSel]) == false)
+    if (pRemoteDirection[iSel] == false
+        && nexttet->clamped(pNeighbCompLidx[iSel]) == false)
         nexttet->incCount(pNeighbCompLidx[iSel],1);
 
     if (clamped == false)
@@ -583,20 +612,108 @@ std::vector<stex::KProc*> const & stex::Diff::apply(steps::rng::RNG * rng, doubl
 
     rExtent++;
 
-    return pUpdVec[iSel];
+    return iSel;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-uint stex::Diff::updVecSize(void) const
+void stex::Diff::leapStoich(std::vector<stex::PoolStoich> & stoich)
 {
-    uint maxsize = pUpdVec[0].size();
-    for (uint i=1; i <= 3; ++i)
+    if (pTet->clamped(lidxTet) == false)
     {
-        if (pUpdVec[i].size() > maxsize)
-            maxsize = pUpdVec[i].size();
+        stex::PoolStoich ps;
+        ps.pool = pTet->pools() + lidxTet;
+        ps.lhs = 1;
+        ps.order = 1;
+        ps.mean = -1.0;
+        ps.meansq = 1.0;
+        stoich.push_back(ps);
     }
-    return maxsize;
+
+    // Each event adds a molecule to neighbour i with probability p_i.
+    double cdf = 0.0;
+    for (uint i = 0; i < 4; ++i)
+    {
+        double p = ((i < 3) ? pCDFSelector[i] : 1.0) - cdf;
+        if (i < 3) cdf = pCDFSelector[i];
+        if (p <= 0.0 || pScaledDcst == 0.0) continue;
+
+        stex::Tet * nexttet = pTet->nextTet(i);
+        if (nexttet == 0 || pRemoteDirection[i] == true) continue;
+        if (nexttet->clamped(pNeighbCompLidx[i]) == true) continue;
+
+        stex::PoolStoich ps;
+        ps.pool = nexttet->pools() + pNeighbCompLidx[i];
+        ps.lhs = 0;
+        ps.order = 1;
+        ps.mean = p;
+        ps.meansq = p;
+        stoich.push_back(ps);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::Diff::leap(steps::rng::RNG * rng, uint n, std::vector<stex::PoolChange> & changes)
+{
+    if (pTet->clamped(lidxTet) == false)
+    {
+        stex::PoolChange pc;
+        pc.pool = pTet->pools() + lidxTet;
+        pc.change = -static_cast<long>(n);
+        changes.push_back(pc);
+    }
+
+    // The last direction that molecules can move to takes all the
+    // molecules left. The probability of direction 3 is 1 minus the sum
+    // of the others, which rounding can leave above zero even if there is
+    // no neighbour in that direction.
+    int last = 3;
+    for (; last > 0; --last)
+    {
+        double p = ((last < 3) ? pCDFSelector[last] : 1.0) - pCDFSelector[last - 1];
+        if (p > 0.0 && pTet->nextTet(last) != 0 && pNeighbCompLidx[last] > -1) break;
+    }
+
+    // Split the molecules over the directions with a sequence of
+    // conditional binomials.
+    uint rows = 0;
+    uint remaining = n;
+    double cdf = 0.0;
+    for (int i = 0; i <= last && remaining > 0; ++i)
+    {
+        double p = ((i < 3) ? pCDFSelector[i] : 1.0) - cdf;
+        double rest = 1.0 - cdf;
+        if (i < 3) cdf = pCDFSelector[i];
+        if (p <= 0.0 && i != last) continue;
+
+        uint ni = (p >= rest || i == last) ? remaining : rng->getBinom(remaining, p / rest);
+        if (ni == 0) continue;
+        remaining -= ni;
+        rows |= (1u << i);
+
+        stex::Tet * nexttet = pTet->nextTet(i);
+        assert(nexttet != 0);
+        assert(pNeighbCompLidx[i] > -1);
+        if (pRemoteDirection[i] == true) continue;
+        if (nexttet->clamped(pNeighbCompLidx[i]) == true) continue;
+
+        stex::PoolChange pc;
+        pc.pool = nexttet->pools() + pNeighbCompLidx[i];
+        pc.change = ni;
+        changes.push_back(pc);
+    }
+    assert(remaining == 0);
+
+    return rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Diff::setRemoteDirection(uint i, bool remote)
+{
+    assert(i < 4);
+    pRemoteDirection[i] = remote;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +69,8 @@ public:
     Diff(steps::solver::Diffdef * ddef, steps::tetexact::Tet * tet);
     ~Diff(void);
 
+    static const KProcKind KIND = KP_DIFF;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -78,6 +80,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
@@ -89,14 +97,15 @@ public:
     void setDcst(double d);
     void setDirectionDcst(int direction, double dcst);
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
     void reset(void);
     double rate(steps::tetexact::Tetexact * solver = 0);
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime);
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
-    uint updVecSize(void) const;
+    void leapStoich(std::vector<PoolStoich> & stoich);
+    uint leap(steps::rng::RNG * rng, uint n, std::vector<PoolChange> & changes);
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -106,6 +115,18 @@ public:
 
     ////////////////////////////////////////////////////////////////////////
 
+    /// Local index of the diffusing species in the neighbouring tet in
+    /// direction i, or -1 if there is no neighbour.
+    inline int neighbLidx(uint i) const
+    { return pNeighbCompLidx[i]; }
+
+    /// Mark direction i as leading into another domain of a domain
+    /// decomposed run. apply() then only removes the molecule from this
+    /// tet and leaves its arrival in the neighbour to the caller.
+    void setRemoteDirection(uint i, bool remote);
+
+    ////////////////////////////////////////////////////////////////////////
+
     //inline steps::solver::Reacdef * defr(void) const
     //{ return pReacdef; }
 
@@ -119,7 +140,6 @@ private:
     uint                                lidxTet;
     steps::solver::Diffdef            * pDiffdef;
     steps::tetexact::Tet              * pTet;
-    std::vector<KProc*>                 pUpdVec[4];
     std::map<uint, double>              directionalDcsts;
 
     // Storing the species local index for each neighbouring tet: Needed
@@ -140,6 +160,9 @@ private:
     // Flags to store if a direction is a diffusion boundary direction
     bool                                 pDiffBndDirection[4];
 
+    // Flags to store if a direction leads into another domain
+    bool                                 pRemoteDirection[4];
+
     ////////////////////////////////////////////////////////////////////////
 
 };
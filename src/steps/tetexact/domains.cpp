@@ -0,0 +1,763 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+// Standard library & STL headers.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/rng/create.hpp"
+#include "steps/tetexact/diff.hpp"
+#include "steps/tetexact/domains.hpp"
+#include "steps/tetexact/sdiff.hpp"
+#include "steps/tetexact/tet.hpp"
+#include "steps/tetexact/tetexact.hpp"
+#include "steps/tetexact/tri.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace stex = steps::tetexact;
+namespace stetmesh = steps::tetmesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Buffer size of the random number generator of each domain.
+static const uint DOMAIN_RNG_BUFSIZE = 512;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Recursive coordinate bisection of tets[bgn, end) into ndomains domains,
+// numbered from first.
+static void bisect(stetmesh::Tetmesh * mesh, std::vector<uint> & tets,
+                   uint bgn, uint end, uint first, uint ndomains,
+                   std::vector<uint> & tet_domains)
+{
+    if (ndomains == 1 || end - bgn < 2)
+    {
+        for (uint i = bgn; i < end; ++i) tet_domains[tets[i]] = first;
+        return;
+    }
+
+    // Split along the longest extent of the barycentres.
+    double lo[3], hi[3];
+    for (uint k = 0; k < 3; ++k)
+    {
+        lo[k] = std::numeric_limits<double>::max();
+        hi[k] = -std::numeric_limits<double>::max();
+    }
+    for (uint i = bgn; i < end; ++i)
+    {
+        auto const & b = mesh->_getTetBarycenter(tets[i]);
+        for (uint k = 0; k < 3; ++k)
+        {
+            lo[k] = std::min(lo[k], b[k]);
+            hi[k] = std::max(hi[k], b[k]);
+        }
+    }
+    uint axis = 0;
+    for (uint k = 1; k < 3; ++k)
+        if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+
+    uint nleft = ndomains / 2;
+    uint mid = bgn + static_cast<uint>(
+        static_cast<double>(end - bgn) * nleft / ndomains);
+    std::nth_element(tets.begin() + bgn, tets.begin() + mid, tets.begin() + end,
+        [mesh, axis](uint a, uint b)
+        {
+            double ca = mesh->_getTetBarycenter(a)[axis];
+            double cb = mesh->_getTetBarycenter(b)[axis];
+            return ca < cb || (ca == cb && a < b);
+        });
+
+    bisect(mesh, tets, bgn, mid, first, nleft, tet_domains);
+    bisect(mesh, tets, mid, end, first + nleft, ndomains - nleft, tet_domains);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint> stex::DomainSet::partition(stetmesh::Tetmesh * mesh,
+                                             std::vector<bool> const & included,
+                                             uint ndomains)
+{
+    assert(ndomains > 0);
+    std::vector<uint> tet_domains(included.size(), 0);
+    std::vector<uint> tets;
+    for (uint t = 0; t < included.size(); ++t)
+        if (included[t]) tets.push_back(t);
+
+    bisect(mesh, tets, 0, tets.size(), 0, ndomains, tet_domains);
+    return tet_domains;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::Domain::Domain(void)
+: tets()
+, tris()
+, kprocs()
+, rates()
+, tree()
+, boundary()
+, rng(0)
+, seed(0)
+, inbox()
+, outbox()
+, epoch(0)
+, leafEpochs()
+, savedLeaves()
+, savedRates()
+, savedExtents()
+, savedElems()
+, savedPools()
+, nodeEpochs()
+, savedNodes()
+, savedNodeValues()
+, nTreeUpdates(0)
+, dirty(false)
+, active(false)
+, nEvents(0)
+{
+    rng = steps::rng::create("mt19937", DOMAIN_RNG_BUFSIZE);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::Domain::~Domain(void)
+{
+    delete rng;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::DomainSet::DomainSet(stex::Tetexact * solver,
+                           stex::KProcDepGraph const & deps,
+                           std::vector<uint> const & tet_domains)
+: pSolver(solver)
+, pDeps(deps)
+, pTetDomains(tet_domains)
+, pDomains()
+, pOwner(solver->countKProcs(), 0)
+, pLeaf(solver->countKProcs(), 0)
+, pRemoteRef(solver->countKProcs(), -1)
+, pRemotes()
+, pWriteOffsets(1, 0)
+, pWrites()
+, pElemEpochs()
+, pNTets(0)
+, pWindowMsgs(4.0)
+, pNWindows(0)
+, pNReruns(0)
+{
+    uint ntets = solver->mesh()->countTets();
+    uint ntris = solver->mesh()->countTris();
+    pNTets = ntets;
+    pElemEpochs.assign(ntets + ntris, 0);
+    if (pTetDomains.size() != ntets)
+    {
+        std::ostringstream os;
+        os << "Length of domain list (" << pTetDomains.size();
+        os << ") is not equal to the number of tetrahedrons in the mesh (";
+        os << ntets << ").";
+        throw steps::ArgErr(os.str());
+    }
+
+    // Keep the inner and outer tet of every patch triangle together.
+    std::vector<uint> root(ntets);
+    std::iota(root.begin(), root.end(), 0);
+    auto find = [&root](uint t)
+    {
+        while (root[t] != t) t = root[t] = root[root[t]];
+        return t;
+    };
+    for (uint t = 0; t < ntris; ++t)
+    {
+        stex::Tri * tri = solver->_tri(t);
+        if (tri == 0 || tri->iTet() == 0 || tri->oTet() == 0) continue;
+        uint a = find(tri->iTet()->idx());
+        uint b = find(tri->oTet()->idx());
+        if (a != b) root[std::max(a, b)] = std::min(a, b);
+    }
+
+    uint ndomains = 0;
+    for (uint t = 0; t < ntets; ++t)
+    {
+        if (solver->_tet(t) == 0) continue;
+        pTetDomains[t] = tet_domains[find(t)];
+        ndomains = std::max(ndomains, pTetDomains[t] + 1);
+    }
+
+    for (uint d = 0; d < ndomains; ++d)
+    {
+        pDomains.push_back(new stex::Domain());
+        pDomains.back()->outbox.resize(ndomains);
+    }
+
+    auto tri_domain = [this](stex::Tri * tri)
+    {
+        stex::WmVol * tet = (tri->iTet() != 0) ? tri->iTet() : tri->oTet();
+        return pTetDomains[tet->idx()];
+    };
+
+    auto add_kprocs = [this](uint d, std::vector<stex::KProc *> & kprocs)
+    {
+        stex::Domain * dom = pDomains[d];
+        for (auto kp: kprocs)
+        {
+            pOwner[kp->schedIDX()] = d;
+            pLeaf[kp->schedIDX()] = dom->kprocs.size();
+            dom->kprocs.push_back(kp);
+        }
+    };
+
+    for (uint t = 0; t < ntets; ++t)
+    {
+        stex::Tet * tet = solver->_tet(t);
+        if (tet == 0) continue;
+        pDomains[pTetDomains[t]]->tets.push_back(tet);
+        add_kprocs(pTetDomains[t], tet->kprocs());
+    }
+
+    for (uint t = 0; t < ntris; ++t)
+    {
+        stex::Tri * tri = solver->_tri(t);
+        if (tri == 0) continue;
+        pDomains[tri_domain(tri)]->tris.push_back(tri);
+        add_kprocs(tri_domain(tri), tri->kprocs());
+    }
+
+    // Collect the elements each kproc writes to within its domain: its
+    // own element, the tets of a patch triangle and, for diffusion, the
+    // neighbours in the same domain.
+    std::vector<std::vector<uint> > writes(solver->countKProcs());
+    for (uint t = 0; t < ntets; ++t)
+    {
+        stex::Tet * tet = solver->_tet(t);
+        if (tet == 0) continue;
+        for (auto kp: tet->kprocs()) writes[kp->schedIDX()].push_back(t);
+        uint ndiffs = tet->compdef()->countDiffs();
+        for (uint l = 0; l < ndiffs; ++l)
+        {
+            std::vector<uint> & w = writes[tet->diff(l)->schedIDX()];
+            for (uint i = 0; i < 4; ++i)
+            {
+                stex::Tet * next = tet->nextTet(i);
+                if (next != 0 && pTetDomains[next->idx()] == pTetDomains[t])
+                    w.push_back(next->idx());
+            }
+        }
+    }
+    for (uint t = 0; t < ntris; ++t)
+    {
+        stex::Tri * tri = solver->_tri(t);
+        if (tri == 0) continue;
+        for (auto kp: tri->kprocs())
+        {
+            std::vector<uint> & w = writes[kp->schedIDX()];
+            w.push_back(ntets + t);
+            if (tri->iTet() != 0) w.push_back(tri->iTet()->idx());
+            if (tri->oTet() != 0) w.push_back(tri->oTet()->idx());
+        }
+        uint nsdiffs = tri->patchdef()->countSurfDiffs();
+        for (uint l = 0; l < nsdiffs; ++l)
+        {
+            std::vector<uint> & w = writes[tri->sdiff(l)->schedIDX()];
+            for (uint i = 0; i < 3; ++i)
+            {
+                stex::Tri * next = tri->nextTri(i);
+                if (next != 0 && tri_domain(next) == tri_domain(tri))
+                    w.push_back(ntets + next->idx());
+            }
+        }
+    }
+    for (auto const & w: writes)
+    {
+        pWrites.insert(pWrites.end(), w.begin(), w.end());
+        pWriteOffsets.push_back(pWrites.size());
+    }
+
+    // Record the diffusion directions that leave their domain.
+    for (uint d = 0; d < ndomains; ++d)
+    {
+        stex::Domain * dom = pDomains[d];
+
+        for (auto tet: dom->tets)
+        {
+            uint ndiffs = tet->compdef()->countDiffs();
+            for (uint l = 0; l < ndiffs; ++l)
+            {
+                stex::Diff * diff = tet->diff(l);
+                int ref = pRemotes.size();
+                bool leaves = false;
+                for (uint i = 0; i < 4; ++i)
+                {
+                    stex::Tet * next = tet->nextTet(i);
+                    stex::DomainRemote r = {d, 0, 0, false};
+                    if (next != 0 && diff->neighbLidx(i) >= 0
+                        && pTetDomains[next->idx()] != d)
+                    {
+                        r.domain = pTetDomains[next->idx()];
+                        r.elem = next->idx();
+                        r.lidx = diff->neighbLidx(i);
+                        leaves = true;
+                    }
+                    pRemotes.push_back(r);
+                }
+                if (leaves == false)
+                {
+                    pRemotes.resize(ref);
+                    continue;
+                }
+                pRemoteRef[diff->schedIDX()] = ref;
+                dom->boundary.push_back(pLeaf[diff->schedIDX()]);
+            }
+        }
+
+        for (auto tri: dom->tris)
+        {
+            uint nsdiffs = tri->patchdef()->countSurfDiffs();
+            for (uint l = 0; l < nsdiffs; ++l)
+            {
+                stex::SDiff * sdiff = tri->sdiff(l);
+                int ref = pRemotes.size();
+                bool leaves = false;
+                for (uint i = 0; i < 4; ++i)
+                {
+                    stex::Tri * next = (i < 3) ? tri->nextTri(i) : 0;
+                    stex::DomainRemote r = {d, 0, 0, true};
+                    if (next != 0 && tri_domain(next) != d)
+                    {
+                        r.domain = tri_domain(next);
+                        r.elem = next->idx();
+                        r.lidx = sdiff->neighbLidx(i);
+                        leaves = true;
+                    }
+                    pRemotes.push_back(r);
+                }
+                if (leaves == false)
+                {
+                    pRemotes.resize(ref);
+                    continue;
+                }
+                pRemoteRef[sdiff->schedIDX()] = ref;
+                dom->boundary.push_back(pLeaf[sdiff->schedIDX()]);
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::DomainSet::~DomainSet(void)
+{
+    for (auto dom: pDomains) delete dom;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_setRemote(bool remote)
+{
+    for (uint d = 0; d < pDomains.size(); ++d)
+    {
+        stex::Domain * dom = pDomains[d];
+        for (auto tet: dom->tets)
+        {
+            uint ndiffs = tet->compdef()->countDiffs();
+            for (uint l = 0; l < ndiffs; ++l)
+            {
+                stex::Diff * diff = tet->diff(l);
+                int ref = pRemoteRef[diff->schedIDX()];
+                if (ref < 0) continue;
+                for (uint i = 0; i < 4; ++i)
+                    diff->setRemoteDirection(i,
+                        remote && pRemotes[ref + i].domain != d);
+            }
+        }
+        for (auto tri: dom->tris)
+        {
+            uint nsdiffs = tri->patchdef()->countSurfDiffs();
+            for (uint l = 0; l < nsdiffs; ++l)
+            {
+                stex::SDiff * sdiff = tri->sdiff(l);
+                int ref = pRemoteRef[sdiff->schedIDX()];
+                if (ref < 0) continue;
+                for (uint i = 0; i < 3; ++i)
+                    sdiff->setRemoteDirection(i,
+                        remote && pRemotes[ref + i].domain != d);
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_init(uint d)
+{
+    stex::Domain * dom = pDomains[d];
+    uint nkprocs = dom->kprocs.size();
+    dom->rates.resize(nkprocs);
+    for (uint i = 0; i < nkprocs; ++i)
+    {
+        stex::KProc * kp = dom->kprocs[i];
+        dom->rates[i] = stex::kprocRate(kp, pSolver->kprocKind(kp->schedIDX()), pSolver);
+    }
+    dom->tree.rebuild(dom->rates);
+    dom->nTreeUpdates = 0;
+    dom->leafEpochs.resize(nkprocs);
+    dom->nodeEpochs.resize(nkprocs + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint * stex::DomainSet::_pools(uint elem, uint & nspecs) const
+{
+    if (elem < pNTets)
+    {
+        stex::Tet * tet = pSolver->_tet(elem);
+        nspecs = tet->compdef()->countSpecs();
+        return tet->pools();
+    }
+    stex::Tri * tri = pSolver->_tri(elem - pNTets);
+    nspecs = tri->patchdef()->countSpecs();
+    return tri->pools();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_saveElem(stex::Domain * dom, uint elem)
+{
+    if (pElemEpochs[elem] == dom->epoch) return;
+    pElemEpochs[elem] = dom->epoch;
+
+    uint nspecs = 0;
+    uint * pools = _pools(elem, nspecs);
+    dom->savedElems.push_back(elem);
+    dom->savedPools.insert(dom->savedPools.end(), pools, pools + nspecs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_saveLeaf(stex::Domain * dom, uint leaf)
+{
+    if (dom->leafEpochs[leaf] == dom->epoch) return;
+    dom->leafEpochs[leaf] = dom->epoch;
+
+    dom->savedLeaves.push_back(leaf);
+    dom->savedRates.push_back(dom->rates[leaf]);
+    dom->savedExtents.push_back(dom->kprocs[leaf]->getExtent());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_clearLog(uint d)
+{
+    stex::Domain * dom = pDomains[d];
+
+    dom->savedLeaves.clear();
+    dom->savedRates.clear();
+    dom->savedExtents.clear();
+    dom->savedElems.clear();
+    dom->savedPools.clear();
+    dom->savedNodes.clear();
+    dom->savedNodeValues.clear();
+
+    if (++dom->epoch == 0)
+    {
+        // Wrapped around; forget all earlier epochs.
+        std::fill(dom->leafEpochs.begin(), dom->leafEpochs.end(), 0);
+        std::fill(dom->nodeEpochs.begin(), dom->nodeEpochs.end(), 0);
+        for (auto tet: dom->tets) pElemEpochs[tet->idx()] = 0;
+        for (auto tri: dom->tris) pElemEpochs[pNTets + tri->idx()] = 0;
+        dom->epoch = 1;
+    }
+
+    dom->dirty = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_commit(uint d)
+{
+    stex::Domain * dom = pDomains[d];
+
+    // Limit the drift of the sum tree. This is only done between windows,
+    // so that all runs of a window start from the same tree.
+    if (dom->nTreeUpdates > dom->rates.size())
+    {
+        dom->tree.rebuild(dom->rates);
+        dom->nTreeUpdates = 0;
+    }
+
+    _clearLog(d);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_rollback(uint d)
+{
+    stex::Domain * dom = pDomains[d];
+
+    uint const * saved = dom->savedPools.data();
+    for (auto elem: dom->savedElems)
+    {
+        uint nspecs = 0;
+        uint * pools = _pools(elem, nspecs);
+        std::copy(saved, saved + nspecs, pools);
+        saved += nspecs;
+    }
+
+    uint nleaves = dom->savedLeaves.size();
+    for (uint i = 0; i < nleaves; ++i)
+    {
+        uint leaf = dom->savedLeaves[i];
+        dom->rates[leaf] = dom->savedRates[i];
+        dom->kprocs[leaf]->setExtent(dom->savedExtents[i]);
+    }
+
+    uint nnodes = dom->savedNodes.size();
+    for (uint i = 0; i < nnodes; ++i)
+        dom->tree.nodes[dom->savedNodes[i]] = dom->savedNodeValues[i];
+
+    _clearLog(d);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double stex::DomainSet::_boundaryRate(uint d) const
+{
+    stex::Domain * dom = pDomains[d];
+    double rate = 0.0;
+    for (auto leaf: dom->boundary) rate += dom->rates[leaf];
+    return rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_receive(uint d, stex::DomainMsg const & msg)
+{
+    stex::Domain * dom = pDomains[d];
+
+    if (msg.tri == true)
+    {
+        stex::Tri * tri = pSolver->_tri(msg.elem);
+        _saveElem(dom, pNTets + msg.elem);
+        if (tri->clamped(msg.lidx) == false) tri->incCount(msg.lidx, 1);
+        for (auto kp: tri->kprocs())
+        {
+            assert(pOwner[kp->schedIDX()] == d);
+            _updateRate(dom, pLeaf[kp->schedIDX()]);
+        }
+        return;
+    }
+
+    stex::Tet * tet = pSolver->_tet(msg.elem);
+    _saveElem(dom, msg.elem);
+    if (tet->clamped(msg.lidx) == false) tet->incCount(msg.lidx, 1);
+    for (auto kp: tet->kprocs())
+    {
+        assert(pOwner[kp->schedIDX()] == d);
+        _updateRate(dom, pLeaf[kp->schedIDX()]);
+    }
+    for (auto tri: tet->nexttris())
+    {
+        if (tri == 0) continue;
+        for (auto kp: tri->kprocs())
+        {
+            assert(pOwner[kp->schedIDX()] == d);
+            _updateRate(dom, pLeaf[kp->schedIDX()]);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::DomainSet::_runWindow(uint d, double t0, double t1)
+{
+    stex::Domain * dom = pDomains[d];
+    if (dom->dirty == true) _rollback(d);
+    dom->dirty = true;
+
+    dom->rng->initialize(dom->seed);
+    for (auto & out: dom->outbox) out.clear();
+    dom->nEvents = 0;
+
+    std::vector<stex::DomainMsg>::const_iterator msg = dom->inbox.begin();
+    std::vector<stex::DomainMsg>::const_iterator msg_end = dom->inbox.end();
+
+    double t = t0;
+    while (true)
+    {
+        double a0 = dom->tree.total();
+        double t_msg = (msg != msg_end) ? msg->time : t1;
+        double t_next = t_msg;
+        if (a0 > 0.0) t_next = t + dom->rng->getExp(a0);
+
+        // Nothing happens in this domain before the next message arrives
+        // or the window ends; the waiting time is simply drawn again
+        // afterwards.
+        if (t_next >= t_msg)
+        {
+            if (msg == msg_end) break;
+            _receive(d, *msg);
+            t = msg->time;
+            ++msg;
+            continue;
+        }
+
+        double selector = a0 * dom->rng->getUnfEE();
+        uint leaf = dom->tree.search(selector);
+        if (leaf >= dom->rates.size() || dom->rates[leaf] <= 0.0)
+        {
+            // Rounding errors in the inner nodes; rebuild and draw again.
+            for (uint i = 1; i <= dom->tree.size(); ++i) _saveNode(dom, i);
+            dom->tree.rebuild(dom->rates);
+            continue;
+        }
+
+        stex::KProc * kp = dom->kprocs[leaf];
+        uint idx = kp->schedIDX();
+        for (uint w = pWriteOffsets[idx]; w < pWriteOffsets[idx + 1]; ++w)
+            _saveElem(dom, pWrites[w]);
+        _saveLeaf(dom, leaf);
+        uint row = stex::kprocApply(kp, pSolver->kprocKind(idx), dom->rng, t_next - t, t_next);
+        dom->nEvents++;
+
+        KProcDepGraph::const_iterator dep_end = pDeps.end(idx, row);
+        for (auto dep = pDeps.begin(idx, row); dep != dep_end; ++dep)
+            if (pOwner[*dep] == d) _updateRate(dom, pLeaf[*dep]);
+
+        int ref = pRemoteRef[idx];
+        if (ref >= 0)
+        {
+            stex::DomainRemote const & r = pRemotes[ref + row];
+            if (r.domain != d)
+            {
+                stex::DomainMsg out = {t_next, r.elem, r.lidx, r.tri};
+                dom->outbox[r.domain].push_back(out);
+            }
+        }
+
+        t = t_next;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stex::DomainSet::run(double starttime, double endtime,
+                           steps::rng::RNG * rng)
+{
+    int ndomains = pDomains.size();
+    ulong nevents = 0;
+
+    _setRemote(true);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int d = 0; d < ndomains; ++d) _init(d);
+
+    double t = starttime;
+    while (t < endtime)
+    {
+        // Size the window by the busiest border, so that only a few
+        // messages need to be reconciled per window.
+        double bmax = 0.0;
+        for (int d = 0; d < ndomains; ++d)
+            bmax = std::max(bmax, _boundaryRate(d));
+        double t_end = endtime;
+        if (bmax > 0.0)
+        {
+            t_end = std::min(endtime, t + pWindowMsgs / bmax);
+            if (t_end <= t) t_end = std::nextafter(t, endtime);
+        }
+
+        for (int d = 0; d < ndomains; ++d)
+        {
+            stex::Domain * dom = pDomains[d];
+            dom->seed = rng->get();
+            dom->inbox.clear();
+            dom->active = true;
+        }
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int d = 0; d < ndomains; ++d) _commit(d);
+
+        bool first = true;
+        int nactive = ndomains;
+        while (nactive > 0)
+        {
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int d = 0; d < ndomains; ++d)
+                if (pDomains[d]->active) _runWindow(d, t, t_end);
+
+            if (first == false) pNReruns += nactive;
+            first = false;
+
+            // Collect the incoming messages; domains whose messages
+            // changed run the window again.
+            nactive = 0;
+            #pragma omp parallel for schedule(dynamic, 1) reduction(+:nactive)
+            for (int d = 0; d < ndomains; ++d)
+            {
+                std::vector<stex::DomainMsg> inbox;
+                for (int s = 0; s < ndomains; ++s)
+                {
+                    std::vector<stex::DomainMsg> const & out = pDomains[s]->outbox[d];
+                    inbox.insert(inbox.end(), out.begin(), out.end());
+                }
+                std::sort(inbox.begin(), inbox.end());
+
+                stex::Domain * dom = pDomains[d];
+                dom->active = (inbox != dom->inbox);
+                if (dom->active)
+                {
+                    dom->inbox.swap(inbox);
+                    nactive += 1;
+                }
+            }
+        }
+
+        for (int d = 0; d < ndomains; ++d) nevents += pDomains[d]->nEvents;
+        ++pNWindows;
+        t = t_end;
+    }
+
+    _setRemote(false);
+
+    return nevents;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
@@ -0,0 +1,332 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_TETEXACT_DOMAINS_HPP
+#define STEPS_TETEXACT_DOMAINS_HPP 1
+
+// STL headers.
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/geom/tetmesh.hpp"
+#include "steps/rng/rng.hpp"
+#include "steps/tetexact/crstruct.hpp"
+#include "steps/tetexact/depgraph.hpp"
+#include "steps/tetexact/kproc.hpp"
+#include "steps/tetexact/kprocstore.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace tetexact {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Forward declarations.
+class Tetexact;
+class Tet;
+class Tri;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// A molecule arriving in a tet or tri of one domain, sent by a diffusion
+/// event in a neighbouring domain.
+struct DomainMsg
+{
+    double                              time;
+    uint                                elem;
+    uint                                lidx;
+    bool                                tri;
+
+    inline bool operator==(DomainMsg const & m) const
+    { return time == m.time && elem == m.elem && lidx == m.lidx && tri == m.tri; }
+
+    inline bool operator<(DomainMsg const & m) const
+    {
+        if (time != m.time) return time < m.time;
+        if (tri != m.tri) return tri < m.tri;
+        if (elem != m.elem) return elem < m.elem;
+        return lidx < m.lidx;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Destination of a diffusion direction that leaves its domain.
+struct DomainRemote
+{
+    uint                                domain;
+    uint                                elem;
+    uint                                lidx;
+    bool                                tri;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// State of a single spatial domain.
+///
+/// Each domain schedules its own kprocs with the direct method, using a
+/// sum tree over the individual propensities, and draws from its own
+/// random number generator.
+///
+struct Domain
+{
+    Domain(void);
+    ~Domain(void);
+
+    // Elements owned by the domain.
+    std::vector<Tet *>                  tets;
+    std::vector<Tri *>                  tris;
+
+    // Kprocs of the owned elements, rates and sum tree indexed alike.
+    std::vector<KProc *>                kprocs;
+    std::vector<double>                 rates;
+    CRSumTree                           tree;
+
+    // Kprocs with at least one direction into another domain.
+    std::vector<uint>                   boundary;
+
+    steps::rng::RNG                   * rng;
+    ulong                               seed;
+
+    // Incoming molecules of the current window, sorted by time, and
+    // outgoing molecules per destination domain.
+    std::vector<DomainMsg>              inbox;
+    std::vector<std::vector<DomainMsg> > outbox;
+
+    // Undo log of the current window: the state at the start of the
+    // window of every element and kproc changed since.
+    uint                                epoch;
+    std::vector<uint>                   leafEpochs;
+    std::vector<uint>                   savedLeaves;
+    std::vector<double>                 savedRates;
+    std::vector<uint>                   savedExtents;
+    std::vector<uint>                   savedElems;
+    std::vector<uint>                   savedPools;
+    std::vector<uint>                   nodeEpochs;
+    std::vector<uint>                   savedNodes;
+    std::vector<double>                 savedNodeValues;
+
+    // Sum tree updates since its last exact rebuild.
+    uint                                nTreeUpdates;
+
+    // Whether the state has moved on from the start of the window.
+    bool                                dirty;
+    // Whether the domain has to (re)run the current window.
+    bool                                active;
+
+    ulong                               nEvents;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Domain decomposed execution of the Tetexact SSA on a thread team.
+///
+/// The tets are split into spatial domains, each owning the kprocs of
+/// its tets and of the patch triangles on them. Molecules diffusing across
+/// a domain border are passed on as time-stamped messages; every other
+/// event only touches the state of its own domain.
+///
+/// As the SSA has no lookahead, the domains are synchronised in windows
+/// of simulated time: all domains run the window optimistically, then
+/// the messages are exchanged, and domains whose incoming messages
+/// changed roll back to the start of the window and run it again with
+/// the same random stream. This is repeated until no incoming messages
+/// change. The result is an exact SSA trajectory in which each domain
+/// draws from its own stream; it does not depend on the number of threads.
+///
+class DomainSet
+{
+
+public:
+
+    ////////////////////////////////////////////////////////////////////////
+    // OBJECT CONSTRUCTION & DESTRUCTION
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Set up the domains given the domain of every tet of the mesh.
+    /// The outer tet of every patch triangle is moved to the domain of
+    /// the inner tet, so that surface reactions stay within one domain.
+    ///
+    DomainSet(Tetexact * solver, KProcDepGraph const & deps,
+              std::vector<uint> const & tet_domains);
+    ~DomainSet(void);
+
+    /// Split the tets for which included is true into ndomains spatial
+    /// domains of similar size by recursive coordinate bisection of their
+    /// barycentres. Other tets are assigned to domain 0.
+    ///
+    static std::vector<uint> partition(steps::tetmesh::Tetmesh * mesh,
+                                       std::vector<bool> const & included,
+                                       uint ndomains);
+
+    ////////////////////////////////////////////////////////////////////////
+    // DATA ACCESS
+    ////////////////////////////////////////////////////////////////////////
+
+    inline uint countDomains(void) const
+    { return pDomains.size(); }
+
+    inline std::vector<uint> const & tetDomains(void) const
+    { return pTetDomains; }
+
+    /// Number of windows run so far.
+    inline ulong countWindows(void) const
+    { return pNWindows; }
+
+    /// Number of times a domain had to run a window again.
+    inline ulong countReruns(void) const
+    { return pNReruns; }
+
+    /// Expected number of messages sent by the busiest domain per window.
+    inline void setWindowMessages(double n)
+    { pWindowMsgs = n; }
+
+    inline double getWindowMessages(void) const
+    { return pWindowMsgs; }
+
+    ////////////////////////////////////////////////////////////////////////
+    // EXECUTION
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Run from starttime to endtime, seeding the domain generators from
+    /// rng. Returns the number of events executed.
+    ///
+    ulong run(double starttime, double endtime, steps::rng::RNG * rng);
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    ////////////////////////////////////////////////////////////////////////
+
+    // Switch the diffusion directions that leave their domain between
+    // sending messages and the normal serial behaviour.
+    void _setRemote(bool remote);
+
+    // Compute the rates of all kprocs of domain d.
+    void _init(uint d);
+
+    // Start a new window in domain d, keeping its current state.
+    void _commit(uint d);
+
+    // Clear the undo log and start a new epoch of saves.
+    void _clearLog(uint d);
+
+    // Return domain d to its state at the start of the window.
+    void _rollback(uint d);
+
+    // Record the state of an element or kproc before its first change
+    // in the current window.
+    void _saveElem(Domain * dom, uint elem);
+    void _saveLeaf(Domain * dom, uint leaf);
+
+    // Pools of a tet, or of tri elem - ntets.
+    uint * _pools(uint elem, uint & nspecs) const;
+
+    // Run domain d from t0 to t1 with its current inbox.
+    void _runWindow(uint d, double t0, double t1);
+
+    // Apply an incoming molecule to domain d.
+    void _receive(uint d, DomainMsg const & msg);
+
+    inline void _updateRate(Domain * dom, uint leaf)
+    {
+        KProc * kp = dom->kprocs[leaf];
+        double r = kprocRate(kp, pSolver->kprocKind(kp->schedIDX()), pSolver);
+        double delta = r - dom->rates[leaf];
+        if (delta == 0.0) return;
+        _saveLeaf(dom, leaf);
+        dom->rates[leaf] = r;
+        _treeAdd(dom, leaf, delta);
+    }
+
+    // Add delta to a leaf of the sum tree, saving the nodes on its path
+    // first so that a rollback restores the tree bit for bit. Otherwise
+    // a domain running a window again could diverge from its previous
+    // run before the first changed message.
+    inline void _treeAdd(Domain * dom, uint leaf, double delta)
+    {
+        uint n = dom->tree.size();
+        for (uint i = leaf + 1; i <= n; i += (i & -i)) _saveNode(dom, i);
+        dom->tree.add(leaf, delta);
+        dom->nTreeUpdates++;
+    }
+
+    inline void _saveNode(Domain * dom, uint node)
+    {
+        if (dom->nodeEpochs[node] == dom->epoch) return;
+        dom->nodeEpochs[node] = dom->epoch;
+        dom->savedNodes.push_back(node);
+        dom->savedNodeValues.push_back(dom->tree.nodes[node]);
+    }
+
+    // Total rate of the kprocs of domain d that can send messages.
+    double _boundaryRate(uint d) const;
+
+    ////////////////////////////////////////////////////////////////////////
+
+    Tetexact                          * pSolver;
+    KProcDepGraph const               & pDeps;
+
+    std::vector<uint>                   pTetDomains;
+    std::vector<Domain *>               pDomains;
+
+    // Owning domain and position within it, by schedule index.
+    std::vector<uint>                   pOwner;
+    std::vector<uint>                   pLeaf;
+
+    // First of the four entries in pRemotes of each kproc, by schedule
+    // index, or -1 if no direction of the kproc leaves its domain.
+    std::vector<int>                    pRemoteRef;
+    std::vector<DomainRemote>           pRemotes;
+
+    // Elements written by each kproc, by schedule index: tets by index,
+    // tris by index plus the number of tets.
+    std::vector<uint>                   pWriteOffsets;
+    std::vector<uint>                   pWrites;
+
+    // Window in which each element was last saved, by element.
+    std::vector<uint>                   pElemEpochs;
+    uint                                pNTets;
+
+    double                              pWindowMsgs;
+
+    ulong                               pNWindows;
+    ulong                               pNReruns;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_TETEXACT_DOMAINS_HPP
+
+// END
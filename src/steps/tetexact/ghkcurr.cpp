@@ -56,7 +56,6 @@ stex::GHKcurr::GHKcurr(ssolver::GHKcurrdef * ghkdef, stex::Tri * tri)
 : KProc()
 , pGHKcurrdef(ghkdef)
 , pTri(tri)
-, pUpdVec()
 , pEffFlux(true)
 {
     assert (pGHKcurrdef != 0);
@@ -76,11 +75,6 @@ void stex::GHKcurr::checkpoint(std::fstream & cp_file)
     cp_file.write((char*)&rExtent, sizeof(uint));
     cp_file.write((char*)&pFlags, sizeof(uint));
     cp_file.write((char*)&pEffFlux, sizeof(bool));
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -90,31 +84,38 @@ void stex::GHKcurr::restore(std::fstream & cp_file)
     cp_file.read((char*)&rExtent, sizeof(uint));
     cp_file.read((char*)&pFlags, sizeof(uint));
     cp_file.read((char*)&pEffFlux, sizeof(bool));
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+void stex::GHKcurr::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.ints.push_back(pEffFlux);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::GHKcurr::reset(void)
+void stex::GHKcurr::restoreColumns(steps::solver::CPCursor & cur)
 {
+    KProc::restoreColumns(cur);
+    pEffFlux = cur.integer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
+void stex::GHKcurr::reset(void)
+{
     setActive(true);
     pEffFlux = true;    //TODO: come back to this and check if rate needs to be recalculated here
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::GHKcurr::setupDeps(void)
+void stex::GHKcurr::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
-    std::set<stex::KProc*> updset;
+    upd_rows.assign(1, SchedIDXVec());
+    SchedIDXVec & updset = upd_rows[0];
 
     // The only concentration changes for a GHK current event are in the outer
     // and inner volume. The flux can involve movement of ion from either
@@ -131,7 +132,7 @@ void stex::GHKcurr::setupDeps(void)
     for (KProcPVecCI k = itet->kprocBegin(); k != kprocend; ++k)
     {
         if ((*k)->depSpecTet(gidxion, itet) == true)
-            updset.insert(*k);
+            updset.push_back((*k)->schedIDX());
     }
 
     std::vector<stex::Tri *>::const_iterator tri_end = itet->nexttriEnd();
@@ -144,7 +145,7 @@ void stex::GHKcurr::setupDeps(void)
         for (KProcPVecCI k = (*tri)->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTet(gidxion, itet) == true)
-                updset.insert(*k);
+                updset.push_back((*k)->schedIDX());
         }
     }
 
@@ -155,7 +156,7 @@ void stex::GHKcurr::setupDeps(void)
         for (KProcPVecCI k = otet->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTet(gidxion, otet) == true)
-                updset.insert(*k);
+                updset.push_back((*k)->schedIDX());
         }
 
         tri_end = otet->nexttriEnd();
@@ -168,12 +169,10 @@ void stex::GHKcurr::setupDeps(void)
             for (KProcPVecCI k = (*tri)->kprocBegin(); k != kprocend; ++k)
             {
                 if ((*k)->depSpecTet(gidxion, otet) == true)
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
             }
         }
     }
-
-    pUpdVec.assign(updset.begin(), updset.end());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -257,7 +256,7 @@ double stex::GHKcurr::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::GHKcurr::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::GHKcurr::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     stex::WmVol * itet = pTri->iTet();
     stex::WmVol * otet = pTri->oTet();
@@ -312,7 +311,7 @@ std::vector<stex::KProc*> const & stex::GHKcurr::apply(steps::rng::RNG * rng, do
 
     rExtent++;
 
-    return pUpdVec;
+    return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
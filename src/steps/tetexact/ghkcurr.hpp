@@ -68,6 +68,8 @@ public:
     GHKcurr(steps::solver::GHKcurrdef * ghkdef, steps::tetexact::Tri * tri);
     ~GHKcurr(void);
 
+    static const KProcKind KIND = KP_GHKCURR;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -77,11 +79,17 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
     void reset(void);
@@ -90,7 +98,7 @@ public:
     double rate(steps::tetexact::Tetexact * solver);
 
     // double rate(double v, double T);
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime);
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
     inline bool efflux(void) const
     { return pEffFlux; }
@@ -98,8 +106,6 @@ public:
     void setEffFlux(bool efx)
     { pEffFlux = efx; }
 
-    uint updVecSize(void) const
-    { return pUpdVec.size(); }
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -109,7 +115,6 @@ private:
 
     steps::solver::GHKcurrdef         * pGHKcurrdef;
     steps::tetexact::Tri              * pTri;
-    std::vector<KProc*>                 pUpdVec;
 
     // Flag if flux is outward, positive flux (true) or inward, negative flux (false)
     bool                                pEffFlux;
@@ -31,6 +31,7 @@
 
 // STEPS headers.
 #include "steps/common.h"
+#include "steps/error.hpp"
 #include "steps/tetexact/kproc.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,7 +44,6 @@ stex::KProc::KProc(void)
 : rExtent(0)
 , pFlags(0)
 , pSchedIDX(0)
-, crData()
 {
 }
 
@@ -74,6 +74,29 @@ void stex::KProc::resetExtent(void)
 {
     rExtent = 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::KProc::setExtent(uint extent)
+{
+    rExtent = extent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::KProc::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    cols.counts.push_back(rExtent);
+    cols.flags.push_back(pFlags);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::KProc::restoreColumns(steps::solver::CPCursor & cur)
+{
+    rExtent = cur.count();
+    pFlags = cur.flag();
+}
 ////////////////////////////////////////////////////////////////////////////////
 
 void stex::KProc::resetCcst(void) const
@@ -100,4 +123,18 @@ double stex::KProc::h(void)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::KProc::leapStoich(std::vector<stex::PoolStoich> & stoich)
+{
+    throw steps::NotImplErr("Tau-leaping is not available for this kinetic process.");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::KProc::leap(steps::rng::RNG * rng, uint n, std::vector<stex::PoolChange> & changes)
+{
+    throw steps::NotImplErr("Tau-leaping is not available for this kinetic process.");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // END
@@ -37,7 +37,9 @@
 
 // STEPS headers.
 #include "steps/common.h"
+#include "steps/solver/cpfile.hpp"
 #include "steps/solver/types.hpp"
+#include "steps/solver/sparsestoich.hpp"
 #include "steps/rng/rng.hpp"
 //#include "tetexact.hpp"
 
@@ -60,6 +62,51 @@ class Tetexact;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// A molecule pool read or changed by the events of a kproc, as seen by
+/// tau-leaping.
+struct PoolStoich
+{
+    uint                              * pool;
+    // Molecules of the pool taking part in one event as reactants, and
+    // the order of the kproc.
+    uint                                lhs;
+    uint                                order;
+    // Mean and mean square of the change of the pool per event.
+    double                              mean;
+    double                              meansq;
+};
+
+/// Change of a molecule pool by a batch of events of a kproc.
+struct PoolChange
+{
+    uint                              * pool;
+    long                                change;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef uint                            SchedIDX;
+typedef std::vector<SchedIDX>           SchedIDXVec;
+typedef SchedIDXVec::iterator           SchedIDXVecI;
+typedef SchedIDXVec::const_iterator     SchedIDXVecCI;
+
+/// Kind of a kproc. The solver keeps the kind of every kproc next to its
+/// CR data and calls rate() and apply() through it rather than through
+/// the virtual table; kprocs of one kind are also stored together.
+enum KProcKind
+{
+    KP_REAC = 0,
+    KP_DIFF,
+    KP_SREAC,
+    KP_SDIFF,
+    KP_VDEPTRANS,
+    KP_VDEPSREAC,
+    KP_GHKCURR,
+    KP_NKINDS
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 typedef KProc *                         KProcP;
 typedef std::vector<KProcP>             KProcPVec;
 typedef KProcPVec::iterator             KProcPVecI;
@@ -88,6 +135,12 @@ public:
     /// restore data
     virtual void restore(std::fstream & cp_file) = 0;
 
+    /// checkpoint data into the columns of a binary checkpoint
+    virtual void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    virtual void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // DATA ACCESS
     ////////////////////////////////////////////////////////////////////////
@@ -117,9 +170,14 @@ public:
     ////////////////////////////////////////////////////////////////////////
 
     /// This function is called when all kproc objects have been created,
-    /// allowing the kproc to pre-compute its SchedIDXVec.
+    /// allowing the kproc to collect the schedule indices of the kprocs
+    /// that depend on it. One row is filled for each possible outcome of
+    /// apply(); rows may contain duplicates and need not be sorted.
     ///
-    virtual void setupDeps(void) = 0;
+    /// The result is compiled into the solver's dependency graph, and this
+    /// may be called concurrently for different kprocs.
+    ///
+    virtual void setupDeps(std::vector<SchedIDXVec> & upd_rows) = 0;
 
     virtual bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet) = 0;
     virtual bool depSpecTri(uint gidx, steps::tetexact::Tri * tri) = 0;
@@ -144,20 +202,33 @@ public:
     virtual double h(void);
 
     /// Apply a single discrete instance of the kinetic process, returning
-    /// a vector of kproc schedule indices that need to be updated as a
-    /// result.
+    /// the index of the row set up by setupDeps() that lists the kprocs
+    /// that need to be updated as a result.
     ///
     // NOTE: Random number generator available to this function for use
     // by Diff
-    virtual std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime) = 0;
+    virtual uint apply(steps::rng::RNG * rng, double dt, double simtime) = 0;
+
+    /// Append the pools read or changed by an event of this kproc, leaving
+    /// out clamped pools. Used by tau-leaping to classify the kproc and
+    /// to select the leap size.
+    ///
+    virtual void leapStoich(std::vector<PoolStoich> & stoich);
 
-    virtual uint updVecSize(void) const = 0;
+    /// Sample the pool changes of n events of this kproc and append them
+    /// to changes, without applying them. Returns a bit mask of the rows
+    /// set up by setupDeps() that list the kprocs to update afterwards.
+    ///
+    virtual uint leap(steps::rng::RNG * rng, uint n, std::vector<PoolChange> & changes);
 
     ////////////////////////////////////////////////////////////////////////
 
     uint getExtent(void) const;
     void resetExtent(void);
 
+    /// Set the extent, e.g. when rolling back to an earlier state.
+    void setExtent(uint extent);
+
     ////////////////////////////////////////////////////////////////////////
     /*
     // Return a pointer to the corresponding Reacdef Diffdef or SReacdef
@@ -168,11 +239,6 @@ public:
     virtual steps::solver::SReacdef * defsr(void) const;
     */// compileerror; // check this
 
-    ////////////////////////////////////////////////////////////////////////
-
-    // data for CR SSA
-    CRKProcData                         crData;
-
 protected:
 
     uint                                rExtent;
@@ -188,6 +254,65 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Append the pools of elem taking part in a reaction with the given
+/// sparse reactant and update lists to stoich, skipping clamped pools.
+template <typename Elem>
+void addReacLeapStoich(Elem * elem,
+                       steps::solver::SparseStoich<uint>::Range lhs,
+                       steps::solver::SparseStoich<int>::Range upd,
+                       uint order, std::vector<PoolStoich> & stoich)
+{
+    uint * pools = elem->pools();
+    uint first = stoich.size();
+    for (auto const & e: lhs)
+    {
+        if (elem->clamped(e.idx) == true) continue;
+        PoolStoich ps;
+        ps.pool = pools + e.idx;
+        ps.lhs = e.coef;
+        ps.order = order;
+        ps.mean = 0.0;
+        ps.meansq = 0.0;
+        stoich.push_back(ps);
+    }
+    for (auto const & e: upd)
+    {
+        if (elem->clamped(e.idx) == true) continue;
+        uint i = first;
+        for (; i < stoich.size(); ++i)
+            if (stoich[i].pool == pools + e.idx) break;
+        if (i == stoich.size())
+        {
+            PoolStoich ps;
+            ps.pool = pools + e.idx;
+            ps.lhs = 0;
+            ps.order = order;
+            stoich.push_back(ps);
+        }
+        stoich[i].mean = e.coef;
+        stoich[i].meansq = e.coef * e.coef;
+    }
+}
+
+/// Append the changes of n events of a reaction to the pools of elem.
+template <typename Elem>
+void addReacLeapChanges(Elem * elem,
+                        steps::solver::SparseStoich<int>::Range upd,
+                        uint n, std::vector<PoolChange> & changes)
+{
+    uint * pools = elem->pools();
+    for (auto const & e: upd)
+    {
+        if (elem->clamped(e.idx) == true) continue;
+        PoolChange pc;
+        pc.pool = pools + e.idx;
+        pc.change = static_cast<long>(n) * e.coef;
+        changes.push_back(pc);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 }
 }
 
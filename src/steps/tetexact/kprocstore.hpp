@@ -0,0 +1,210 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+#ifndef STEPS_TETEXACT_KPROCSTORE_HPP
+#define STEPS_TETEXACT_KPROCSTORE_HPP 1
+
+// STL headers.
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/rng/rng.hpp"
+#include "steps/tetexact/kproc.hpp"
+#include "steps/tetexact/reac.hpp"
+#include "steps/tetexact/diff.hpp"
+#include "steps/tetexact/sreac.hpp"
+#include "steps/tetexact/sdiff.hpp"
+#include "steps/tetexact/vdeptrans.hpp"
+#include "steps/tetexact/vdepsreac.hpp"
+#include "steps/tetexact/ghkcurr.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace steps {
+namespace tetexact {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Contiguous storage for the kprocs of one kind.
+///
+/// Kprocs are constructed in place in chunks of KPROC_CHUNK objects, so
+/// that those created one after the other, such as the reactions of
+/// neighbouring tets, lie next to each other in memory. Chunks are never
+/// moved, so pointers to the kprocs stay valid. The table owns its kprocs.
+///
+template <typename KP>
+class KProcTable
+{
+public:
+
+    static const uint KPROC_CHUNK = 4096;
+
+    KProcTable(void)
+    : pChunks()
+    , pSize(0)
+    {}
+
+    ~KProcTable(void)
+    {
+        for (uint i = 0; i < pSize; ++i) at(i)->~KP();
+        for (auto c: pChunks) ::operator delete(c);
+    }
+
+    template <typename... Args>
+    KP * create(Args &&... args)
+    {
+        if (pSize == pChunks.size() * KPROC_CHUNK)
+            pChunks.push_back(static_cast<KP*>(::operator new(sizeof(KP) * KPROC_CHUNK)));
+        KP * kp = new (pChunks.back() + pSize % KPROC_CHUNK) KP(std::forward<Args>(args)...);
+        ++pSize;
+        return kp;
+    }
+
+    inline uint size(void) const
+    { return pSize; }
+
+    inline KP * at(uint i) const
+    { return pChunks[i / KPROC_CHUNK] + i % KPROC_CHUNK; }
+
+    /// Bytes allocated for the table.
+    inline std::size_t memory(void) const
+    { return pChunks.size() * KPROC_CHUNK * sizeof(KP); }
+
+private:
+
+    KProcTable(KProcTable const &);
+    KProcTable & operator=(KProcTable const &);
+
+    std::vector<KP*>                    pChunks;
+    uint                                pSize;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// The kprocs of a Tetexact solver, in one KProcTable per kind. The tables
+/// are ordered by KProcKind.
+///
+class KProcStore
+{
+public:
+
+    template <typename KP, typename... Args>
+    KP * create(Args &&... args)
+    { return std::get<KP::KIND>(pTables).create(std::forward<Args>(args)...); }
+
+    /// Bytes allocated for all kprocs.
+    std::size_t memory(void) const
+    {
+        return std::get<KP_REAC>(pTables).memory()
+            + std::get<KP_DIFF>(pTables).memory()
+            + std::get<KP_SREAC>(pTables).memory()
+            + std::get<KP_SDIFF>(pTables).memory()
+            + std::get<KP_VDEPTRANS>(pTables).memory()
+            + std::get<KP_VDEPSREAC>(pTables).memory()
+            + std::get<KP_GHKCURR>(pTables).memory();
+    }
+
+private:
+
+    std::tuple<KProcTable<Reac>,
+               KProcTable<Diff>,
+               KProcTable<SReac>,
+               KProcTable<SDiff>,
+               KProcTable<VDepTrans>,
+               KProcTable<VDepSReac>,
+               KProcTable<GHKcurr>>     pTables;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Rate of a kproc of the given kind, without a virtual call.
+inline double kprocRate(KProc * kp, uint kind, Tetexact * solver)
+{
+    switch (kind)
+    {
+        case KP_REAC:
+            return static_cast<Reac*>(kp)->Reac::rate(solver);
+        case KP_DIFF:
+            return static_cast<Diff*>(kp)->Diff::rate(solver);
+        case KP_SREAC:
+            return static_cast<SReac*>(kp)->SReac::rate(solver);
+        case KP_SDIFF:
+            return static_cast<SDiff*>(kp)->SDiff::rate(solver);
+        case KP_VDEPTRANS:
+            return static_cast<VDepTrans*>(kp)->VDepTrans::rate(solver);
+        case KP_VDEPSREAC:
+            return static_cast<VDepSReac*>(kp)->VDepSReac::rate(solver);
+        case KP_GHKCURR:
+            return static_cast<GHKcurr*>(kp)->GHKcurr::rate(solver);
+        default:
+            assert(false);
+            return kp->rate(solver);
+    }
+}
+
+/// Apply an event of a kproc of the given kind, without a virtual call.
+inline uint kprocApply(KProc * kp, uint kind, steps::rng::RNG * rng,
+                       double dt, double simtime)
+{
+    switch (kind)
+    {
+        case KP_REAC:
+            return static_cast<Reac*>(kp)->Reac::apply(rng, dt, simtime);
+        case KP_DIFF:
+            return static_cast<Diff*>(kp)->Diff::apply(rng, dt, simtime);
+        case KP_SREAC:
+            return static_cast<SReac*>(kp)->SReac::apply(rng, dt, simtime);
+        case KP_SDIFF:
+            return static_cast<SDiff*>(kp)->SDiff::apply(rng, dt, simtime);
+        case KP_VDEPTRANS:
+            return static_cast<VDepTrans*>(kp)->VDepTrans::apply(rng, dt, simtime);
+        case KP_VDEPSREAC:
+            return static_cast<VDepSReac*>(kp)->VDepSReac::apply(rng, dt, simtime);
+        case KP_GHKCURR:
+            return static_cast<GHKcurr*>(kp)->GHKcurr::apply(rng, dt, simtime);
+        default:
+            assert(false);
+            return kp->apply(rng, dt, simtime);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_TETEXACT_KPROCSTORE_HPP
+
+// END
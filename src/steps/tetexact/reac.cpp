@@ -67,7 +67,6 @@ stex::Reac::Reac(ssolver::Reacdef * rdef, stex::WmVol * tet)
 : KProc()
 , pReacdef(rdef)
 , pTet(tet)
-, pUpdVec()
 , pCcst(0.0)
 , pKcst(0.0)
 {
@@ -96,11 +95,6 @@ void stex::Reac::checkpoint(std::fstream & cp_file)
 
     cp_file.write((char*)&pCcst, sizeof(double));
     cp_file.write((char*)&pKcst, sizeof(double));
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -112,22 +106,30 @@ void stex::Reac::restore(std::fstream & cp_file)
 
     cp_file.read((char*)&pCcst, sizeof(double));
     cp_file.read((char*)&pKcst, sizeof(double));
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+void stex::Reac::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.reals.push_back(pCcst);
+    cols.reals.push_back(pKcst);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Reac::reset(void)
+void stex::Reac::restoreColumns(steps::solver::CPCursor & cur)
 {
+    KProc::restoreColumns(cur);
+    pCcst = cur.real();
+    pKcst = cur.real();
+}
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Reac::reset(void)
+{
     resetExtent();
     resetCcst();
     setActive(true);
@@ -157,9 +159,10 @@ void stex::Reac::setKcst(double k)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Reac::setupDeps(void)
+void stex::Reac::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
-    std::set<stex::KProc*> updset;
+    upd_rows.assign(1, SchedIDXVec());
+    SchedIDXVec & updset = upd_rows[0];
     ssolver::gidxTVecCI sbgn = pReacdef->bgnUpdColl();
     ssolver::gidxTVecCI send = pReacdef->endUpdColl();
 
@@ -171,7 +174,7 @@ void stex::Reac::setupDeps(void)
         {
             if ((*k)->depSpecTet(*s, pTet) == true) {
                 //updset.insert((*k)->getSSARef());
-                updset.insert(*k);
+                updset.push_back((*k)->schedIDX());
             }
         }
     }
@@ -189,14 +192,11 @@ void stex::Reac::setupDeps(void)
             {
                 if ((*k)->depSpecTet(*s, pTet) == true) {
                     //updset.insert((*k)->getSSARef());
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
                 }
             }
         }
     }
-
-    pUpdVec.assign(updset.begin(), updset.end());
-    //pUpdObjVec.assign(updset_obj.begin(), updset_obj.end());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -222,17 +222,14 @@ double stex::Reac::rate(steps::tetexact::Tetexact * solver)
 
     // Prefetch some variables.
     ssolver::Compdef * cdef = pTet->compdef();
-    uint nspecs = cdef->countSpecs();
-    uint * lhs_vec = cdef->reac_lhs_bgn(cdef->reacG2L(pReacdef->gidx()));
     uint * cnt_vec = pTet->pools();
 
     // Compute combinatorial part.
     double h_mu = 1.0;
-    for (uint pool = 0; pool < nspecs; ++pool)
+    for (auto const & e: cdef->reac_lhs_sparse(cdef->reacG2L(pReacdef->gidx())))
     {
-        uint lhs = lhs_vec[pool];
-        if (lhs == 0) continue;
-        uint cnt = cnt_vec[pool];
+        uint lhs = e.coef;
+        uint cnt = cnt_vec[e.idx];
         if (lhs > cnt)
         {
             h_mu = 0.0;
@@ -244,14 +241,17 @@ double stex::Reac::rate(steps::tetexact::Tetexact * solver)
             {
                 h_mu *= static_cast<double>(cnt - 3);
             }
+            // fall through
             case 3:
             {
                 h_mu *= static_cast<double>(cnt - 2);
             }
+            // fall through
             case 2:
             {
                 h_mu *= static_cast<double>(cnt - 1);
             }
+            // fall through
             case 1:
             {
                 h_mu *= static_cast<double>(cnt);
@@ -271,23 +271,39 @@ double stex::Reac::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::Reac::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::Reac::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     uint * local = pTet->pools();
     ssolver::Compdef * cdef = pTet->compdef();
     uint l_ridx = cdef->reacG2L(pReacdef->gidx());
-    int * upd_vec = cdef->reac_upd_bgn(l_ridx);
-    uint nspecs = cdef->countSpecs();
-    for (uint i = 0; i < nspecs; ++i)
+    for (auto const & e: cdef->reac_upd_sparse(l_ridx))
     {
-        if (pTet->clamped(i) == true) continue;
-        int j = upd_vec[i];
-        if (j == 0) continue;
-        int nc = static_cast<int>(local[i]) + j;
-        pTet->setCount(i, static_cast<uint>(nc));
+        if (pTet->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(local[e.idx]) + e.coef;
+        pTet->setCount(e.idx, static_cast<uint>(nc));
     }
     rExtent++;
-    return pUpdVec;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Reac::leapStoich(std::vector<stex::PoolStoich> & stoich)
+{
+    ssolver::Compdef * cdef = pTet->compdef();
+    uint l_ridx = cdef->reacG2L(pReacdef->gidx());
+    stex::addReacLeapStoich(pTet, cdef->reac_lhs_sparse(l_ridx),
+        cdef->reac_upd_sparse(l_ridx), pReacdef->order(), stoich);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::Reac::leap(steps::rng::RNG * rng, uint n, std::vector<stex::PoolChange> & changes)
+{
+    ssolver::Compdef * cdef = pTet->compdef();
+    uint l_ridx = cdef->reacG2L(pReacdef->gidx());
+    stex::addReacLeapChanges(pTet, cdef->reac_upd_sparse(l_ridx), n, changes);
+    return 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
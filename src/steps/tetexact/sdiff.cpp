@@ -56,12 +56,12 @@ stex::SDiff::SDiff(ssolver::Diffdef * sdef, stex::Tri * tri)
 : KProc()
 , pSDiffdef(sdef)
 , pTri(tri)
-, pUpdVec()
 , pScaledDcst(0.0)
 , pDcst(0.0)
 , pCDFSelector()
 , pSDiffBndActive()
 , pSDiffBndDirection()
+, pRemoteDirection()
 {
     assert(pSDiffdef != 0);
     assert(pTri != 0);
@@ -169,11 +169,6 @@ void stex::SDiff::checkpoint(std::fstream & cp_file)
     cp_file.write((char*)pSDiffBndActive, sizeof(bool) * 3);
     cp_file.write((char*)pSDiffBndDirection, sizeof(bool) * 3);
     cp_file.write((char*)pNeighbPatchLidx, sizeof(int) * 3);
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,16 +198,54 @@ void stex::SDiff::restore(std::fstream & cp_file)
     cp_file.read((char*)pSDiffBndActive, sizeof(bool) * 3);
     cp_file.read((char*)pSDiffBndDirection, sizeof(bool) * 3);
     cp_file.read((char*)pNeighbPatchLidx, sizeof(int) * 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::SDiff::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+
+    cols.ints.push_back(directionalDcsts.size());
+    for (auto const & item: directionalDcsts)
+    {
+        cols.ints.push_back(item.first);
+        cols.reals.push_back(item.second);
+    }
+
+    cols.reals.push_back(pScaledDcst);
+    cols.reals.push_back(pDcst);
+    cols.reals.insert(cols.reals.end(), pCDFSelector, pCDFSelector + 2);
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndActive[i]);
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndDirection[i]);
+    cols.ints.insert(cols.ints.end(), pNeighbPatchLidx, pNeighbPatchLidx + 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::SDiff::restoreColumns(steps::solver::CPCursor & cur)
+{
+    KProc::restoreColumns(cur);
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+    directionalDcsts.clear();
+    uint n_direct_dcsts = cur.integer();
+    for (uint i = 0; i < n_direct_dcsts; ++i)
+    {
+        uint id = cur.integer();
+        directionalDcsts[id] = cur.real();
+    }
+
+    pScaledDcst = cur.real();
+    pDcst = cur.real();
+    cur.reals(pCDFSelector, 2);
+    for (uint i = 0; i < 3; ++i) pSDiffBndActive[i] = cur.integer();
+    for (uint i = 0; i < 3; ++i) pSDiffBndDirection[i] = cur.integer();
+    cur.ints(pNeighbPatchLidx, 3);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::SDiff::setupDeps(void)
+void stex::SDiff::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
     // We will check all KProcs of the following simulation elements:
     //   * the 'source' triangle
@@ -226,15 +259,17 @@ void stex::SDiff::setupDeps(void)
     //
 
 
+    upd_rows.assign(3, SchedIDXVec());
+
     // Search for dependencies in the 'source' triangle.
-    std::set<stex::KProc*> local;
+    SchedIDXVec local;
 
     KProcPVecCI kprocend = pTri->kprocEnd();
     for (KProcPVecCI k = pTri->kprocBegin(); k != kprocend; ++k)
     {
         // Check locally.
         if ((*k)->depSpecTri(ligGIdx, pTri) == true) {
-            local.insert(*k);
+            local.push_back((*k)->schedIDX());
         }
     }
 
@@ -248,7 +283,7 @@ void stex::SDiff::setupDeps(void)
         for (KProcPVecCI k = itet[i]->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTri(ligGIdx, pTri) == true) {
-                local.insert(*k);
+                local.push_back((*k)->schedIDX());
             }
         }
     }
@@ -261,14 +296,15 @@ void stex::SDiff::setupDeps(void)
         if (next == 0) continue;
 
         // Copy local dependencies.
-        std::set<stex::KProc*> local2(local.begin(), local.end());
+        SchedIDXVec & local2 = upd_rows[i];
+        local2 = local;
 
         // Find the ones 'locally' in the next tri.
         kprocend = next->kprocEnd();
         for (KProcPVecCI k = next->kprocBegin(); k != kprocend; ++k)
         {
             if ((*k)->depSpecTri(ligGIdx, next) == true) {
-                local2.insert(*k);
+                local2.push_back((*k)->schedIDX());
             }
         }
 
@@ -284,13 +320,10 @@ void stex::SDiff::setupDeps(void)
             for (KProcPVecCI k = itet[j]->kprocBegin(); k != kprocend; ++k)
             {
                 if ((*k)->depSpecTri(ligGIdx, next) == true) {
-                    local2.insert(*k);
+                    local2.push_back((*k)->schedIDX());
                 }
             }
         }
-
-        // Copy the set to the update vector.
-        pUpdVec[i].assign(local2.begin(), local2.end());
     }
 
 }
@@ -328,11 +361,6 @@ void stex::SDiff::reset(void)
 
     setActive(true);
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
-
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -555,7 +583,7 @@ double stex::SDiff::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::SDiff::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::SDiff::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     //uint lidxTet = this->lidxTet;
     // Pre-fetch some general info.
@@ -584,7 +612,8 @@ std::vector<stex::KProc*> const & stex::SDiff::apply(steps::rng::RNG * rng, doub
     // So we can assert that nextet 0 does indeed exist
     assert (nexttri != 0);
 
-    if (nexttri->clamped(lidxTri) == false)
+    if (pRemoteDirection[iSel] == false
+        && nexttri->clamped(lidxTri) == false)
         nexttri->incCount(lidxTri,1);
 
     if (clamped == false)
@@ -592,23 +621,11 @@ std::vector<stex::KProc*> const & stex::SDiff::apply(steps::rng::RNG * rng, doub
 
     rExtent++;
 
-    return pUpdVec[iSel];
+    return iSel;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-uint stex::SDiff::updVecSize(void) const
-{
-    uint maxsize = pUpdVec[0].size();
-    for (uint i=1; i <= 2; ++i)
-    {
-        if (pUpdVec[i].size() > maxsize)
-            maxsize = pUpdVec[i].size();
-    }
-    return maxsize;
-}
-
-////////////////////////////////////////////////////////////////////////////////
 
 
 void stex::SDiff::setSDiffBndActive(uint i, bool active)
@@ -640,4 +657,93 @@ bool stex::SDiff::getSDiffBndActive(uint i) const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::SDiff::leapStoich(std::vector<stex::PoolStoich> & stoich)
+{
+    if (pTri->clamped(lidxTri) == false)
+    {
+        stex::PoolStoich ps;
+        ps.pool = pTri->pools() + lidxTri;
+        ps.lhs = 1;
+        ps.order = 1;
+        ps.mean = -1.0;
+        ps.meansq = 1.0;
+        stoich.push_back(ps);
+    }
+
+    // Each event adds a molecule to neighbour i with probability p_i.
+    double cdf = 0.0;
+    for (uint i = 0; i < 3; ++i)
+    {
+        double p = ((i < 2) ? pCDFSelector[i] : 1.0) - cdf;
+        if (i < 2) cdf = pCDFSelector[i];
+        if (p <= 0.0 || pScaledDcst == 0.0) continue;
+
+        stex::Tri * nexttri = pTri->nextTri(i);
+        if (nexttri == 0 || pRemoteDirection[i] == true) continue;
+        if (nexttri->clamped(lidxTri) == true) continue;
+
+        stex::PoolStoich ps;
+        ps.pool = nexttri->pools() + lidxTri;
+        ps.lhs = 0;
+        ps.order = 1;
+        ps.mean = p;
+        ps.meansq = p;
+        stoich.push_back(ps);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::SDiff::leap(steps::rng::RNG * rng, uint n, std::vector<stex::PoolChange> & changes)
+{
+    if (pTri->clamped(lidxTri) == false)
+    {
+        stex::PoolChange pc;
+        pc.pool = pTri->pools() + lidxTri;
+        pc.change = -static_cast<long>(n);
+        changes.push_back(pc);
+    }
+
+    // Split the molecules over the directions with a sequence of
+    // conditional binomials.
+    uint rows = 0;
+    uint remaining = n;
+    double cdf = 0.0;
+    for (uint i = 0; i < 3 && remaining > 0; ++i)
+    {
+        double p = ((i < 2) ? pCDFSelector[i] : 1.0) - cdf;
+        double rest = 1.0 - cdf;
+        if (i < 2) cdf = pCDFSelector[i];
+        if (p <= 0.0) continue;
+
+        uint ni = (p >= rest) ? remaining : rng->getBinom(remaining, p / rest);
+        if (ni == 0) continue;
+        remaining -= ni;
+        rows |= (1u << i);
+
+        stex::Tri * nexttri = pTri->nextTri(i);
+        assert(nexttri != 0);
+        if (pRemoteDirection[i] == true) continue;
+        if (nexttri->clamped(lidxTri) == true) continue;
+
+        stex::PoolChange pc;
+        pc.pool = nexttri->pools() + lidxTri;
+        pc.change = ni;
+        changes.push_back(pc);
+    }
+    assert(remaining == 0);
+
+    return rows;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::SDiff::setRemoteDirection(uint i, bool remote)
+{
+    assert(i < 3);
+    pRemoteDirection[i] = remote;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // END
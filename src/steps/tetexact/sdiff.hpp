@@ -67,6 +67,8 @@ public:
     SDiff(steps::solver::Diffdef * sdef, steps::tetexact::Tri * tri);
     ~SDiff(void);
 
+    static const KProcKind KIND = KP_SDIFF;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -76,6 +78,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
@@ -87,7 +95,7 @@ public:
     void setDcst(double d);
     void setDirectionDcst(int direction, double dcst);
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
 
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
@@ -95,9 +103,10 @@ public:
     void reset(void);
     double rate(steps::tetexact::Tetexact * solver = 0);
 
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime);
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
-    uint updVecSize(void) const;
+    void leapStoich(std::vector<PoolStoich> & stoich);
+    uint leap(steps::rng::RNG * rng, uint n, std::vector<PoolChange> & changes);
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -107,6 +116,18 @@ public:
 
     ////////////////////////////////////////////////////////////////////////
 
+    /// Local index of the diffusing species in the neighbouring tri in
+    /// direction i, as used by apply().
+    inline int neighbLidx(uint i) const
+    { return lidxTri; }
+
+    /// Mark direction i as leading into another domain of a domain
+    /// decomposed run. apply() then only removes the molecule from this
+    /// tri and leaves its arrival in the neighbour to the caller.
+    void setRemoteDirection(uint i, bool remote);
+
+    ////////////////////////////////////////////////////////////////////////
+
 private:
 
     ////////////////////////////////////////////////////////////////////////
@@ -115,7 +136,6 @@ private:
     uint                                lidxTri;
     steps::solver::Diffdef              * pSDiffdef;
     steps::tetexact::Tri                * pTri;
-    std::vector<KProc*>                 pUpdVec[3];
 
     // Storing the species local index for each neighbouring tri: Needed
     // because neighbours may belong to different patches if we ever
@@ -138,6 +158,9 @@ private:
     // Flags to store if a direction is a diffusion boundary direction
     bool                                pSDiffBndDirection[3];
 
+    // Flags to store if a direction leads into another domain
+    bool                                pRemoteDirection[3];
+
     ////////////////////////////////////////////////////////////////////////
 
 };
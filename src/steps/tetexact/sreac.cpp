@@ -85,7 +85,6 @@ stex::SReac::SReac(ssolver::SReacdef * srdef, stex::Tri * tri)
 : KProc()
 , pSReacdef(srdef)
 , pTri(tri)
-, pUpdVec()
 , pCcst(0.0)
 , pKcst(0.0)
 {
@@ -138,11 +137,6 @@ void stex::SReac::checkpoint(std::fstream & cp_file)
     cp_file.write((char*)&pCcst, sizeof(double));
     cp_file.write((char*)&pKcst, sizeof(double));
 
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
-
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -154,22 +148,30 @@ void stex::SReac::restore(std::fstream & cp_file)
 
     cp_file.read((char*)&pCcst, sizeof(double));
     cp_file.read((char*)&pKcst, sizeof(double));
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+void stex::SReac::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.reals.push_back(pCcst);
+    cols.reals.push_back(pKcst);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::SReac::reset(void)
+void stex::SReac::restoreColumns(steps::solver::CPCursor & cur)
 {
+    KProc::restoreColumns(cur);
+    pCcst = cur.real();
+    pKcst = cur.real();
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
+void stex::SReac::reset(void)
+{
     resetExtent();
     resetCcst();
     setActive(true);
@@ -244,7 +246,7 @@ void stex::SReac::setKcst(double k)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::SReac::setupDeps(void)
+void stex::SReac::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
     // For all non-zero entries gidx in SReacDef's UPD_S:
     //   Perform depSpecTri(gidx,tri()) for:
@@ -261,9 +263,8 @@ void stex::SReac::setupDeps(void)
     // If outer tetrahedron exists:
     //   Similar to inner tet.
     //
-    // All dependencies are first collected into a std::set, to sort them
-    // and to eliminate duplicates. At the end of the routine, they are
-    // copied into the vector that will be returned during execution.
+    // All dependencies are collected into a single row; sorting and
+    // removal of duplicates is left to the solver's dependency graph.
 
     WmVol * itet = pTri->iTet();
     WmVol * otet = pTri->oTet();
@@ -275,7 +276,8 @@ void stex::SReac::setupDeps(void)
     ssolver::gidxTVecCI o_beg = pSReacdef->beginUpdColl_O();
     ssolver::gidxTVecCI o_end = pSReacdef->endUpdColl_O();
 
-    std::set<stex::KProc*> updset;
+    upd_rows.assign(1, SchedIDXVec());
+    SchedIDXVec & updset = upd_rows[0];
     KProcPVecCI kprocend = pTri->kprocEnd();
     for (KProcPVecCI k = pTri->kprocBegin(); k != kprocend; ++k)
     {
@@ -283,7 +285,7 @@ void stex::SReac::setupDeps(void)
         {
             if ((*k)->depSpecTri(*spec, pTri) == true) {
                 //updset.insert((*k)->getSSARef());
-                updset.insert(*k);
+                updset.push_back((*k)->schedIDX());
             }
         }
     }
@@ -297,7 +299,7 @@ void stex::SReac::setupDeps(void)
             {
                 if ((*k)->depSpecTet(*spec, itet) == true) {
                     //updset.insert((*k)->getSSARef());
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
                 }
             }
         }
@@ -316,7 +318,7 @@ void stex::SReac::setupDeps(void)
                 {
                     if ((*k)->depSpecTet(*spec, itet) == true) {
                         //updset.insert((*k)->getSSARef());
-                        updset.insert(*k);
+                        updset.push_back((*k)->schedIDX());
                     }
                 }
             }
@@ -332,7 +334,7 @@ void stex::SReac::setupDeps(void)
             {
                 if ((*k)->depSpecTet(*spec, otet) == true) {
                     //updset.insert((*k)->getSSARef());
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
                 }
             }
         }
@@ -352,15 +354,12 @@ void stex::SReac::setupDeps(void)
                 {
                     if ((*k)->depSpecTet(*spec, otet) == true) {
                         //updset.insert((*k)->getSSARef());
-                        updset.insert(*k);
+                        updset.push_back((*k)->schedIDX());
                     }
                 }
             }
         }
     }
-
-    pUpdVec.assign(updset.begin(), updset.end());
-    //pUpdObjVec.assign(updset_obj.begin(), updset_obj.end());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -410,14 +409,11 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
 
         double h_mu = 1.0;
 
-        uint * lhs_s_vec = pdef->sreac_lhs_S_bgn(lidx);
         uint * cnt_s_vec = pTri->pools();
-        uint nspecs_s = pdef->countSpecs();
-        for (uint s = 0; s < nspecs_s; ++s)
+        for (auto const & e: pdef->sreac_lhs_S_sparse(lidx))
         {
-            uint lhs = lhs_s_vec[s];
-            if (lhs == 0) continue;
-            uint cnt = cnt_s_vec[s];
+            uint lhs = e.coef;
+            uint cnt = cnt_s_vec[e.idx];
             if (lhs > cnt)
             {
                 return 0.0;
@@ -428,14 +424,17 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -451,14 +450,11 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
 
         if (pSReacdef->inside())
         {
-            uint * lhs_i_vec = pdef->sreac_lhs_I_bgn(lidx);
             uint * cnt_i_vec = pTri->iTet()->pools();
-            uint nspecs_i = pdef->countSpecs_I();
-            for (uint s = 0; s < nspecs_i; ++s)
+            for (auto const & e: pdef->sreac_lhs_I_sparse(lidx))
             {
-                uint lhs = lhs_i_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_i_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_i_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -469,14 +465,17 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -492,14 +491,11 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
         }
         else if (pSReacdef->outside())
         {
-            uint * lhs_o_vec = pdef->sreac_lhs_O_bgn(lidx);
             uint * cnt_o_vec = pTri->oTet()->pools();
-            uint nspecs_o = pdef->countSpecs_O();
-            for (uint s = 0; s < nspecs_o; ++s)
+            for (auto const & e: pdef->sreac_lhs_O_sparse(lidx))
             {
-                uint lhs = lhs_o_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_o_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_o_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -510,14 +506,17 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -537,7 +536,7 @@ double stex::SReac::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::SReac::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::SReac::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     ssolver::Patchdef * pdef = pTri->patchdef();
     uint lidx = pdef->sreacG2L(pSReacdef->gidx());
@@ -564,32 +563,25 @@ std::vector<stex::KProc*> const & stex::SReac::apply(steps::rng::RNG * rng, doub
         pTri->setOCchange(oc, cs_lidx, dt, simtime);
     }
 
-    uint nspecs_s = pdef->countSpecs();
-    for (uint s = 0; s < nspecs_s; ++s)
+    for (auto const & e: pdef->sreac_upd_S_sparse(lidx))
     {
-        if (pTri->clamped(s) == true) continue;
-        int upd = upd_s_vec[s];
-        if (upd == 0) continue;
-        int nc = static_cast<int>(cnt_s_vec[s]) + upd;
+        if (pTri->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(cnt_s_vec[e.idx]) + e.coef;
         assert(nc >= 0);
-        pTri->setCount(s, static_cast<uint>(nc));
+        pTri->setCount(e.idx, static_cast<uint>(nc));
     }
 
     // Update inner tet pools.
     stex::WmVol * itet = pTri->iTet();
     if (itet != 0)
     {
-        int * upd_i_vec = pdef->sreac_upd_I_bgn(lidx);
         uint * cnt_i_vec = itet->pools();
-        uint nspecs_i = pdef->countSpecs_I();
-        for (uint s = 0; s < nspecs_i; ++s)
+        for (auto const & e: pdef->sreac_upd_I_sparse(lidx))
         {
-            if (itet->clamped(s) == true) continue;
-            int upd = upd_i_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_i_vec[s]) + upd;
+            if (itet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_i_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            itet->setCount(s, static_cast<uint>(nc));
+            itet->setCount(e.idx, static_cast<uint>(nc));
         }
     }
 
@@ -597,23 +589,71 @@ std::vector<stex::KProc*> const & stex::SReac::apply(steps::rng::RNG * rng, doub
     stex::WmVol * otet = pTri->oTet();
     if (otet != 0)
     {
-        int * upd_o_vec = pdef->sreac_upd_O_bgn(lidx);
         uint * cnt_o_vec = otet->pools();
-        uint nspecs_o = pdef->countSpecs_O();
-        for (uint s = 0; s < nspecs_o; ++s)
+        for (auto const & e: pdef->sreac_upd_O_sparse(lidx))
         {
-            if (otet->clamped(s) == true) continue;
-            int upd = upd_o_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_o_vec[s]) + upd;
+            if (otet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_o_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            otet->setCount(s, static_cast<uint>(nc));
+            otet->setCount(e.idx, static_cast<uint>(nc));
         }
     }
 
     rExtent++;
 
-    return pUpdVec;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::SReac::leapStoich(std::vector<stex::PoolStoich> & stoich)
+{
+    ssolver::Patchdef * pdef = pTri->patchdef();
+    uint lidx = pdef->sreacG2L(pSReacdef->gidx());
+    uint order = pSReacdef->order();
+
+    // Volume reactants are only taken from the side the reaction is
+    // defined on; the other side can only receive products.
+    ssolver::SparseStoich<uint>::Range none = {0, 0};
+
+    stex::addReacLeapStoich(pTri, pdef->sreac_lhs_S_sparse(lidx),
+        pdef->sreac_upd_S_sparse(lidx), order, stoich);
+
+    stex::WmVol * itet = pTri->iTet();
+    if (itet != 0)
+    {
+        stex::addReacLeapStoich(itet,
+            pSReacdef->inside() ? pdef->sreac_lhs_I_sparse(lidx) : none,
+            pdef->sreac_upd_I_sparse(lidx), order, stoich);
+    }
+
+    stex::WmVol * otet = pTri->oTet();
+    if (otet != 0)
+    {
+        stex::addReacLeapStoich(otet,
+            pSReacdef->outside() ? pdef->sreac_lhs_O_sparse(lidx) : none,
+            pdef->sreac_upd_O_sparse(lidx), order, stoich);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::SReac::leap(steps::rng::RNG * rng, uint n, std::vector<stex::PoolChange> & changes)
+{
+    ssolver::Patchdef * pdef = pTri->patchdef();
+    uint lidx = pdef->sreacG2L(pSReacdef->gidx());
+
+    stex::addReacLeapChanges(pTri, pdef->sreac_upd_S_sparse(lidx), n, changes);
+
+    stex::WmVol * itet = pTri->iTet();
+    if (itet != 0)
+        stex::addReacLeapChanges(itet, pdef->sreac_upd_I_sparse(lidx), n, changes);
+
+    stex::WmVol * otet = pTri->oTet();
+    if (otet != 0)
+        stex::addReacLeapChanges(otet, pdef->sreac_upd_O_sparse(lidx), n, changes);
+
+    return 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -71,6 +71,8 @@ public:
     SReac(steps::solver::SReacdef * srdef, steps::tetexact::Tri * tri);
     ~SReac(void);
 
+    static const KProcKind KIND = KP_SREAC;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -80,6 +82,12 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // DATA ACCESS
     ////////////////////////////////////////////////////////////////////////
@@ -99,15 +107,15 @@ public:
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
     void reset(void);
     double rate(steps::tetexact::Tetexact * solver = 0);
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime);
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
-    uint updVecSize(void) const
-    { return pUpdVec.size(); }
+    void leapStoich(std::vector<PoolStoich> & stoich);
+    uint leap(steps::rng::RNG * rng, uint n, std::vector<PoolChange> & changes);
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -122,7 +130,6 @@ private:
 
     steps::solver::SReacdef           * pSReacdef;
     steps::tetexact::Tri              * pTri;
-    std::vector<KProc*>                 pUpdVec;
     /// Properly scaled reaction constant.
     double                              pCcst;
     // Store the kcst for convenience
@@ -0,0 +1,423 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+// Standard library & STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/error.hpp"
+#include "steps/tetexact/tauleap.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace stex = steps::tetexact;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Leaps shorter than this many mean SSA steps are replaced by SSA steps.
+static const double TAULEAP_MIN_SSA_STEPS = 10.0;
+
+////////////////////////////////////////////////////////////////////////////////
+
+stex::TauLeap::TauLeap(std::vector<stex::KProc *> const & kprocs,
+                       stex::KProcDepGraph const & deps)
+: pKProcs(kprocs)
+, pDeps(deps)
+, pEpsilon(0.03)
+, pNCritical(10)
+, pPools()
+, pPoolIdx()
+, pReactant()
+, pStoichOffsets()
+, pStoich()
+, pStoichPools()
+, pPoolReacOffsets()
+, pPoolReacs()
+, pCritical()
+, pLeapRate()
+, pCritList()
+, pCritPos()
+, pMu()
+, pSigma2()
+, pTauTree()
+, pDirtyPools()
+, pPoolDirty()
+, pDelta()
+, pTouched()
+, pChanges()
+, pFired()
+, pFiredN()
+, pFiredRows()
+, pMarks()
+, pMark(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::TauLeap::setEpsilon(double eps)
+{
+    if (eps <= 0.0 || eps >= 1.0)
+    {
+        std::ostringstream os;
+        os << "Tau-leaping epsilon must be between 0 and 1.";
+        throw steps::ArgErr(os.str());
+    }
+    pEpsilon = eps;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::TauLeap::setCriticalCount(uint n)
+{
+    pNCritical = n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::TauLeap::setup(std::vector<double> const & rates)
+{
+    uint nkprocs = pKProcs.size();
+    assert(rates.size() == nkprocs);
+
+    pPools.clear();
+    pPoolIdx.clear();
+    pReactant.clear();
+    pStoich.clear();
+    pStoichPools.clear();
+    pStoichOffsets.assign(1, 0);
+
+    for (uint k = 0; k < nkprocs; ++k)
+    {
+        assert(pKProcs[k]->schedIDX() == k);
+        pKProcs[k]->leapStoich(pStoich);
+        pStoichOffsets.push_back(pStoich.size());
+    }
+
+    pStoichPools.resize(pStoich.size());
+    for (uint i = 0; i < pStoich.size(); ++i)
+    {
+        PoolStoich const & s = pStoich[i];
+        auto ins = pPoolIdx.insert(std::make_pair(s.pool, pPools.size()));
+        if (ins.second == true)
+        {
+            pPools.push_back(s.pool);
+            pReactant.push_back(false);
+        }
+        uint p = ins.first->second;
+        pStoichPools[i] = p;
+        if (s.lhs > 0) pReactant[p] = true;
+    }
+
+    uint npools = pPools.size();
+
+    pPoolReacOffsets.assign(npools + 1, 0);
+    for (uint i = 0; i < pStoich.size(); ++i)
+        if (pStoich[i].lhs > 0) pPoolReacOffsets[pStoichPools[i] + 1]++;
+    for (uint p = 0; p < npools; ++p)
+        pPoolReacOffsets[p + 1] += pPoolReacOffsets[p];
+    pPoolReacs.resize(pPoolReacOffsets[npools]);
+    std::vector<uint> fill(pPoolReacOffsets.begin(), pPoolReacOffsets.end() - 1);
+    for (uint i = 0; i < pStoich.size(); ++i)
+        if (pStoich[i].lhs > 0) pPoolReacs[fill[pStoichPools[i]]++] = i;
+
+    pMu.assign(npools, 0.0);
+    pSigma2.assign(npools, 0.0);
+    pDelta.assign(npools, 0);
+    pTauTree.assign(2 * npools, std::numeric_limits<double>::infinity());
+    pDirtyPools.clear();
+    pPoolDirty.assign(npools, 0);
+
+    pCritical.assign(nkprocs, 0);
+    pLeapRate.assign(nkprocs, 0.0);
+    pCritList.clear();
+    pCritPos.assign(nkprocs, 0);
+    pMarks.assign(nkprocs, 0);
+    pMark = 0;
+
+    for (uint k = 0; k < nkprocs; ++k) _refreshKProc(k, rates[k]);
+    for (uint p = 0; p < npools; ++p)
+    {
+        if (pPoolDirty[p] != 0) continue;
+        pPoolDirty[p] = 1;
+        pDirtyPools.push_back(p);
+    }
+    _refreshPools();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double stex::TauLeap::step(steps::rng::RNG * rng,
+                           std::vector<double> const & rates, double a0,
+                           double maxdt, std::vector<SchedIDX> & updates,
+                           ulong & nevents)
+{
+    uint nkprocs = pKProcs.size();
+    assert(rates.size() == nkprocs);
+    assert(pStoichOffsets.size() == nkprocs + 1);
+
+    updates.clear();
+    nevents = 0;
+    if (a0 <= 0.0 || maxdt <= 0.0) return 0.0;
+
+    // Largest leap that keeps the expected relative change of every
+    // propensity below epsilon.
+    double taup = pTauTree.empty() ? std::numeric_limits<double>::infinity()
+                                   : pTauTree[1];
+    double tau_min = TAULEAP_MIN_SSA_STEPS / a0;
+    if (taup < tau_min) return 0.0;
+
+    double a0c = 0.0;
+    for (auto k: pCritList) a0c += rates[k];
+
+    // Nothing to leap but single critical events: the SSA is cheaper.
+    if (std::isinf(taup) && a0c > 0.0) return 0.0;
+
+    while (true)
+    {
+        double taupp = (a0c > 0.0) ? rng->getExp(a0c)
+                                   : std::numeric_limits<double>::infinity();
+        double tau = std::min(taup, taupp);
+        bool fire_critical = (taupp <= taup);
+        if (tau >= maxdt)
+        {
+            tau = maxdt;
+            fire_critical = false;
+        }
+
+        pChanges.clear();
+        pFired.clear();
+        pFiredN.clear();
+        pFiredRows.clear();
+
+        for (uint k = 0; k < nkprocs; ++k)
+        {
+            if (pLeapRate[k] <= 0.0) continue;
+            // RNG::getPsn() takes the inverse of the mean, like getExp().
+            long n = rng->getPsn(1.0 / (rates[k] * tau));
+            if (n <= 0) continue;
+            pFired.push_back(k);
+            pFiredN.push_back(n);
+            pFiredRows.push_back(pKProcs[k]->leap(rng, n, pChanges));
+        }
+
+        if (fire_critical == true)
+        {
+            double sel = rng->getUnfEE() * a0c;
+            uint chosen = nkprocs;
+            for (auto k: pCritList)
+            {
+                chosen = k;
+                sel -= rates[k];
+                if (sel < 0.0) break;
+            }
+            assert(chosen < nkprocs);
+            pFired.push_back(chosen);
+            pFiredN.push_back(1);
+            pFiredRows.push_back(pKProcs[chosen]->leap(rng, 1, pChanges));
+        }
+
+        // Net change of each pool, rejecting the leap if any would become
+        // negative.
+        pTouched.clear();
+        for (auto const & c: pChanges)
+        {
+            auto it = pPoolIdx.find(c.pool);
+            assert(it != pPoolIdx.end());
+            uint p = it->second;
+            if (pDelta[p] == 0) pTouched.push_back(p);
+            pDelta[p] += c.change;
+        }
+        bool valid = true;
+        for (auto p: pTouched)
+        {
+            if (static_cast<long>(*pPools[p]) + pDelta[p] < 0)
+            {
+                valid = false;
+                break;
+            }
+        }
+        if (valid == false)
+        {
+            for (auto p: pTouched) pDelta[p] = 0;
+            taup *= 0.5;
+            // Halving has made the leap too short to be worth it.
+            if (taup < tau_min) return 0.0;
+            continue;
+        }
+
+        for (auto p: pTouched)
+        {
+            *pPools[p] = static_cast<long>(*pPools[p]) + pDelta[p];
+            pDelta[p] = 0;
+        }
+
+        if (++pMark == 0)
+        {
+            std::fill(pMarks.begin(), pMarks.end(), 0);
+            pMark = 1;
+        }
+        for (uint f = 0; f < pFired.size(); ++f)
+        {
+            KProc * kp = pKProcs[pFired[f]];
+            kp->setExtent(kp->getExtent() + pFiredN[f]);
+            nevents += pFiredN[f];
+            _addUpdates(pFired[f], pFiredRows[f], updates);
+        }
+
+        return tau;
+    }
+}
+
+////////////////
+
+void stex::TauLeap::_addUpdates(SchedIDX sidx, uint rowmask,
+                                std::vector<SchedIDX> & updates)
+{
+    for (uint row = 0; rowmask != 0; ++row, rowmask >>= 1)
+    {
+        if ((rowmask & 1) == 0) continue;
+        for (auto it = pDeps.begin(sidx, row); it != pDeps.end(sidx, row); ++it)
+        {
+            if (pMarks[*it] == pMark) continue;
+            pMarks[*it] = pMark;
+            updates.push_back(*it);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::TauLeap::_refreshKProc(SchedIDX k, double rate)
+{
+    // A kproc is critical if it can fire fewer than pNCritical times
+    // before one of its reactant pools runs out.
+    unsigned char crit = 0;
+    if (rate > 0.0)
+    {
+        for (uint i = pStoichOffsets[k]; i < pStoichOffsets[k + 1]; ++i)
+        {
+            PoolStoich const & s = pStoich[i];
+            if (s.mean >= 0.0) continue;
+            if (std::floor(*s.pool / -s.mean) < pNCritical)
+            {
+                crit = 1;
+                break;
+            }
+        }
+    }
+
+    if (crit != pCritical[k])
+    {
+        if (crit)
+        {
+            pCritPos[k] = pCritList.size();
+            pCritList.push_back(k);
+        }
+        else
+        {
+            SchedIDX last = pCritList.back();
+            pCritList[pCritPos[k]] = last;
+            pCritPos[last] = pCritPos[k];
+            pCritList.pop_back();
+        }
+        pCritical[k] = crit;
+    }
+
+    double leap_rate = crit ? 0.0 : rate;
+    double delta = leap_rate - pLeapRate[k];
+    pLeapRate[k] = leap_rate;
+
+    // Every pool is marked, since its count may have changed even if the
+    // rate has not.
+    for (uint i = pStoichOffsets[k]; i < pStoichOffsets[k + 1]; ++i)
+    {
+        uint p = pStoichPools[i];
+        if (delta != 0.0)
+        {
+            pMu[p] += pStoich[i].mean * delta;
+            pSigma2[p] += pStoich[i].meansq * delta;
+        }
+        if (pPoolDirty[p] == 0)
+        {
+            pPoolDirty[p] = 1;
+            pDirtyPools.push_back(p);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::TauLeap::_refreshPools(void)
+{
+    uint npools = pPools.size();
+    for (auto p: pDirtyPools)
+    {
+        pPoolDirty[p] = 0;
+        uint node = npools + p;
+        pTauTree[node] = _poolTau(p);
+        for (node >>= 1; node > 0; node >>= 1)
+            pTauTree[node] = std::min(pTauTree[2 * node], pTauTree[2 * node + 1]);
+    }
+    pDirtyPools.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double stex::TauLeap::_poolTau(uint p) const
+{
+    if (pReactant[p] == false) return std::numeric_limits<double>::infinity();
+
+    // Highest order of reaction of the pool, g_i in the paper.
+    double x = *pPools[p];
+    double hor = 0.0;
+    for (uint r = pPoolReacOffsets[p]; r < pPoolReacOffsets[p + 1]; ++r)
+    {
+        PoolStoich const & s = pStoich[pPoolReacs[r]];
+        double g = s.lhs;
+        for (uint j = 1; j < s.lhs; ++j)
+            if (x > j) g += j / (x - j);
+        g *= static_cast<double>(s.order) / s.lhs;
+        if (g > hor) hor = g;
+    }
+
+    double tau = std::numeric_limits<double>::infinity();
+    double bound = std::max(pEpsilon * x / hor, 1.0);
+    if (pMu[p] != 0.0) tau = std::min(tau, bound / std::abs(pMu[p]));
+    if (pSigma2[p] > 0.0) tau = std::min(tau, bound * bound / pSigma2[p]);
+    return tau;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// END
@@ -0,0 +1,214 @@
+/*
+ #################################################################################
+#
+#    STEPS - STochastic Engine for Pathway Simulation
+#    Copyright (C) 2007-2017 Okinawa Institute of Science and Technology, Japan.
+#    Copyright (C) 2003-2006 University of Antwerp, Belgium.
+#
+#    See the file AUTHORS for details.
+#    This file is part of STEPS.
+#
+#    STEPS is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License version 2,
+#    as published by the Free Software Foundation.
+#
+#    STEPS is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+#################################################################################
+
+ */
+
+
+#ifndef STEPS_TETEXACT_TAULEAP_HPP
+#define STEPS_TETEXACT_TAULEAP_HPP 1
+
+// STL headers.
+#include <unordered_map>
+#include <vector>
+
+// STEPS headers.
+#include "steps/common.h"
+#include "steps/rng/rng.hpp"
+#include "steps/tetexact/depgraph.hpp"
+#include "steps/tetexact/kproc.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ namespace steps {
+ namespace tetexact {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Leap selection and execution for the hybrid tau-leaping mode of
+/// Tetexact.
+///
+/// This follows the adaptive scheme of Cao, Gillespie and Petzold (2006).
+/// A kproc is critical if it could exhaust one of its reactant pools within
+/// a few events. The leap size is chosen so that the expected relative
+/// change of the propensities due to the non-critical kprocs stays below
+/// epsilon. Non-critical kprocs then fire a Poisson distributed number of
+/// times, and at most one critical kproc fires once during the leap. Leaps
+/// that would make a pool negative are rejected and retried with half the
+/// size. When the leap would cover only a few SSA steps, initially or after
+/// rejections, the solver is asked to take an exact SSA step instead.
+///
+/// The classification of the kprocs, the propensity moments of each pool
+/// and the leap bound of each pool are kept between steps. After setup()
+/// they only have to be refreshed with update() for the kprocs whose rates
+/// the solver recomputed, i.e. those on the dependency rows of the kprocs
+/// that fired. The largest leap is then read from a min tree over the
+/// pools, so deciding whether to leap costs O(1).
+///
+class TauLeap
+{
+
+public:
+
+    ////////////////////////////////////////////////////////////////////////
+    // OBJECT CONSTRUCTION & DESTRUCTION
+    ////////////////////////////////////////////////////////////////////////
+
+    TauLeap(std::vector<KProc *> const & kprocs, KProcDepGraph const & deps);
+
+    ////////////////////////////////////////////////////////////////////////
+    // PARAMETERS
+    ////////////////////////////////////////////////////////////////////////
+
+    inline double getEpsilon(void) const
+    { return pEpsilon; }
+
+    void setEpsilon(double eps);
+
+    inline uint getCriticalCount(void) const
+    { return pNCritical; }
+
+    void setCriticalCount(uint n);
+
+    ////////////////////////////////////////////////////////////////////////
+    // EXECUTION
+    ////////////////////////////////////////////////////////////////////////
+
+    /// Collect the pool stoichiometry of all kprocs and classify them
+    /// given their current rates by schedule index. Has to be called again
+    /// whenever pools are clamped or released, or pools or rates have been
+    /// changed other than through step() and the solver's SSA steps.
+    ///
+    void setup(std::vector<double> const & rates);
+
+    /// Refresh the kprocs in [b, e) after their rates have been recomputed,
+    /// together with the pools they take part in.
+    ///
+    template <typename SchedIDXIter>
+    void update(SchedIDXIter b, SchedIDXIter e, std::vector<double> const & rates)
+    {
+        while (b != e)
+        {
+            SchedIDX k = *b++;
+            _refreshKProc(k, rates[k]);
+        }
+        _refreshPools();
+    }
+
+    /// Try to leap by at most maxdt, given the current rate of every kproc
+    /// by schedule index and their sum a0.
+    ///
+    /// On success the pools and extents are updated, the kprocs whose rates
+    /// have to be recomputed are stored in updates, the number of events
+    /// in nevents, and the length of the leap is returned. Returns 0.0
+    /// without changing anything if exact SSA steps should be taken instead.
+    ///
+    double step(steps::rng::RNG * rng, std::vector<double> const & rates,
+                double a0, double maxdt, std::vector<SchedIDX> & updates,
+                ulong & nevents);
+
+    ////////////////////////////////////////////////////////////////////////
+
+private:
+
+    ////////////////////////////////////////////////////////////////////////
+
+    // Mark the kprocs on the dependency rows in rowmask of kproc sidx.
+    void _addUpdates(SchedIDX sidx, uint rowmask, std::vector<SchedIDX> & updates);
+
+    // Reclassify kproc k and move its contribution to the moments of its
+    // pools to rate, marking the pools for _refreshPools().
+    void _refreshKProc(SchedIDX k, double rate);
+
+    // Recompute the leap bound of the marked pools.
+    void _refreshPools(void);
+
+    // Leap bound of pool p from its count and moments.
+    double _poolTau(uint p) const;
+
+    ////////////////////////////////////////////////////////////////////////
+
+    std::vector<KProc *> const        & pKProcs;
+    KProcDepGraph const               & pDeps;
+
+    double                              pEpsilon;
+    uint                                pNCritical;
+
+    // Pools taking part in any kproc, and the dense index of each.
+    std::vector<uint *>                 pPools;
+    std::unordered_map<uint *, uint>    pPoolIdx;
+    // Whether the pool is a reactant of any kproc.
+    std::vector<bool>                   pReactant;
+
+    // Stoichiometry of kproc sidx is pStoich[pStoichOffsets[sidx],
+    // pStoichOffsets[sidx + 1]), with the pools of the entries in pStoichPools.
+    std::vector<uint>                   pStoichOffsets;
+    std::vector<PoolStoich>             pStoich;
+    std::vector<uint>                   pStoichPools;
+
+    // Stoichiometry entries with the pool as a reactant, for the highest
+    // order of reaction: pPoolReacs[pPoolReacOffsets[p], pPoolReacOffsets[p + 1]).
+    std::vector<uint>                   pPoolReacOffsets;
+    std::vector<uint>                   pPoolReacs;
+
+    // Classification of each kproc, the rate it contributes to the pool
+    // moments (0 unless it is non-critical), and the critical kprocs with
+    // the position of each kproc in that list.
+    std::vector<unsigned char>          pCritical;
+    std::vector<double>                 pLeapRate;
+    std::vector<SchedIDX>               pCritList;
+    std::vector<uint>                   pCritPos;
+
+    // Mean and variance of the change of each pool per unit time due to
+    // the non-critical kprocs.
+    std::vector<double>                 pMu;
+    std::vector<double>                 pSigma2;
+
+    // Min tree of the pool leap bounds; leaf p is node npools + p.
+    std::vector<double>                 pTauTree;
+
+    // Pools marked for _refreshPools().
+    std::vector<uint>                   pDirtyPools;
+    std::vector<unsigned char>          pPoolDirty;
+
+    // Per step work space.
+    std::vector<long>                   pDelta;
+    std::vector<uint>                   pTouched;
+    std::vector<PoolChange>             pChanges;
+    std::vector<uint>                   pFired;
+    std::vector<uint>                   pFiredN;
+    std::vector<uint>                   pFiredRows;
+    std::vector<uint>                   pMarks;
+    uint                                pMark;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+}
+
+#endif
+// STEPS_TETEXACT_TAULEAP_HPP
+
+// END
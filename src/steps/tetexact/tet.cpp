@@ -42,6 +42,7 @@
 #include "steps/tetexact/tet.hpp"
 #include "steps/tetexact/tri.hpp"
 #include "steps/tetexact/kproc.hpp"
+#include "steps/tetexact/kprocstore.hpp"
 #include "steps/tetexact/tetexact.hpp"
 #include "steps/tetexact/wmvol.hpp"
 
@@ -123,6 +124,22 @@ void stex::Tet::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::Tet::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    for (uint i = 0; i < 4; ++i) cols.ints.push_back(pDiffBndDirection[i]);
+    WmVol::checkpointColumns(cols);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tet::restoreColumns(steps::solver::CPCursor & cur)
+{
+    for (uint i = 0; i < 4; ++i) pDiffBndDirection[i] = cur.integer();
+    WmVol::restoreColumns(cur);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void stex::Tet::setNextTet(uint i, stex::Tet * t)
 {
 
@@ -172,9 +189,9 @@ void stex::Tet::setupKProcs(stex::Tetexact * tex)
     for (uint i = 0; i < nreacs; ++i)
     {
         ssolver::Reacdef * rdef = compdef()->reacdef(i);
-        stex::Reac * r = new stex::Reac(rdef, this);
+        stex::Reac * r = tex->kprocStore().create<stex::Reac>(rdef, this);
         kprocs()[j++] = r;
-        tex->addKProc(r);
+        tex->addKProc(r, stex::Reac::KIND);
     }
 
     // Create diffusion kproc's.
@@ -185,9 +202,9 @@ void stex::Tet::setupKProcs(stex::Tetexact * tex)
     for (uint i = 0; i < ndiffs; ++i)
     {
         ssolver::Diffdef * ddef = compdef()->diffdef(i);
-        stex::Diff * d = new stex::Diff(ddef, this);
+        stex::Diff * d = tex->kprocStore().create<stex::Diff>(ddef, this);
         kprocs()[j++] = d;
-        tex->addKProc(d);
+        tex->addKProc(d, stex::Diff::KIND);
     }
 }
 
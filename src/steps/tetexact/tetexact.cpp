@@ -57,11 +57,15 @@
 #include "steps/tetexact/vdepsreac.hpp"
 #include "steps/tetexact/diffboundary.hpp"
 #include "steps/tetexact/sdiffboundary.hpp"
+#include "steps/tetexact/domains.hpp"
+#include "steps/tetexact/kprocstore.hpp"
+#include "steps/tetexact/tauleap.hpp"
 #include "steps/math/constants.hpp"
 #include "steps/math/point.hpp"
 #include "steps/error.hpp"
 #include "steps/solver/statedef.hpp"
 #include "steps/solver/compdef.hpp"
+#include "steps/solver/cpfile.hpp"
 #include "steps/solver/patchdef.hpp"
 #include "steps/solver/reacdef.hpp"
 #include "steps/solver/sreacdef.hpp"
@@ -79,6 +83,8 @@
 
 #include "steps/solver/efield/efield.hpp"
 #include "steps/solver/efield/dVsolver.hpp"
+#include "steps/solver/efield/dVsolver_pcg.hpp"
+#include "steps/solver/efield/dVsolver_condensed.hpp"
 
 #include "third_party/easylogging++.h"
 
@@ -104,7 +110,6 @@ stex::Tetexact::Tetexact(steps::model::Model * m, steps::wm::Geom * g, steps::rn
                          int calcMembPot)
 : API(m, g, r)
 , pMesh(0)
-, pKProcs()
 , pComps()
 , pCompMap()
 , pPatches()
@@ -114,6 +119,13 @@ stex::Tetexact::Tetexact(steps::model::Model * m, steps::wm::Geom * g, steps::rn
 , pTris()
 , pWmVols()
 , pA0(0.0)
+, pKProcStore(0)
+, pKProcs()
+, pCRData()
+, nTree()
+, pTree()
+, pCRRecompute(0)
+, pCRUpdates(0)
 //, pBuilt(false)
 , pEFoption(static_cast<EF_solver>(calcMembPot))
 , pTemp(0.0)
@@ -129,6 +141,17 @@ stex::Tetexact::Tetexact(steps::model::Model * m, steps::wm::Geom * g, steps::rn
 , pEFTri_GtoL()
 , pEFTet_GtoL()
 , pEFTri_LtoG()
+, pEFTri_VDepOffsets()
+, pEFTri_VDepKProcs()
+, pEFTri_VRefresh()
+, pEFVTol(0.0)
+, pEFFullUpdate(true)
+, pDomainSet(0)
+, pProfile(0)
+, pTauLeap(0)
+, pTauLeaping(false)
+, pNLeapedEvents(0)
+, pNExactEvents(0)
 {
     if (rng() == 0)
     {
@@ -137,21 +160,29 @@ stex::Tetexact::Tetexact(steps::model::Model * m, steps::wm::Geom * g, steps::rn
         throw steps::ArgErr(os.str());
     }
     
+    pKProcStore = new stex::KProcStore();
+
     // All initialization code now in _setup() to allow EField solver to be
     // derived and create EField local objects within the constructor
     _setup();
+
+    pTauLeap = new stex::TauLeap(pKProcs, pDepGraph);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 stex::Tetexact::~Tetexact(void)
 {
+    delete pDomainSet;
+    delete pProfile;
+    delete pTauLeap;
     for (auto c: pComps) delete c;
     for (auto p: pPatches) delete p;
     for (auto db: pDiffBoundaries) delete db;
     for (auto wvol: pWmVols) delete wvol;
     for (auto t: pTets) delete t;
     for (auto t: pTris) delete t;
+    delete pKProcStore;
     for (auto g: nGroups) {
         g->free_indices();
         delete g;
@@ -175,7 +206,7 @@ stex::Tetexact::~Tetexact(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void stex::Tetexact::checkpoint(std::string const & file_name)
+void stex::Tetexact::checkpointLegacy(std::string const & file_name)
 {
     std::cout << "Checkpoint to " << file_name  << "...";
     std::fstream cp_file;
@@ -225,8 +256,10 @@ void stex::Tetexact::checkpoint(std::string const & file_name)
         }
     }
 
-    KProcPVecCI e = pKProcs.end();
-    for (KProcPVecCI i = pKProcs.begin(); i != e; ++i) (*i)->checkpoint(cp_file);
+    for (auto kp: pKProcs) {
+        kp->checkpoint(cp_file);
+        pCRData.checkpoint(kp->schedIDX(), cp_file);
+    }
 
     if (efflag()) {
         cp_file.write((char*)&pTemp, sizeof(double));
@@ -255,10 +288,7 @@ void stex::Tetexact::checkpoint(std::string const & file_name)
         cp_file.write((char*)&(group->max), sizeof(double));
         cp_file.write((char*)&(group->sum), sizeof(double));
 
-        for (uint j = 0; j < group->size; j++) {
-            uint idx = group->indices[j]->schedIDX();
-            cp_file.write((char*)&idx, sizeof(uint));
-        }
+        cp_file.write((char*)group->indices, sizeof(uint) * group->size);
     }
 
     for (uint i = 0; i < n_pgroups; i++) {
@@ -268,19 +298,262 @@ void stex::Tetexact::checkpoint(std::string const & file_name)
         cp_file.write((char*)&(group->max), sizeof(double));
         cp_file.write((char*)&(group->sum), sizeof(double));
 
-        for (uint j = 0; j < group->size; j++) {
-            uint idx = group->indices[j]->schedIDX();
-            cp_file.write((char*)&idx, sizeof(uint));
-        }
+        cp_file.write((char*)group->indices, sizeof(uint) * group->size);
     }
 
+    // updates since the group sums were last recomputed, so that a
+    // restored run recomputes them at the same step
+    cp_file.write((char*)&pCRUpdates, sizeof(uint));
+
     cp_file.close();
     std::cout << "complete.\n";
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void stex::Tetexact::checkpoint(std::string const & file_name)
+{
+    std::cout << "Checkpoint to " << file_name  << "...";
+
+    ssolver::CPWriter cp(file_name, statedef()->fingerprint(), _cpMeshFingerprint());
+
+    statedef()->checkpoint(cp.beginStream(ssolver::CP_BLOCK_STATEDEF));
+    cp.endStream();
+
+    // Compartments, patches and diffusion boundaries have no state of
+    // their own.
+
+    ssolver::CPColumns cols;
+    for (auto wmv: pWmVols)
+        if (wmv != 0) wmv->checkpointColumns(cols);
+    cp.write(ssolver::CP_SECTION_WMVOL, cols);
+
+    cols.clear();
+    for (auto t: pTets)
+        if (t != 0) t->checkpointColumns(cols);
+    cp.write(ssolver::CP_SECTION_TET, cols);
+
+    cols.clear();
+    for (auto t: pTris)
+        if (t != 0) t->checkpointColumns(cols);
+    cp.write(ssolver::CP_SECTION_TRI, cols);
+
+    cols.clear();
+    for (auto kp: pKProcs) kp->checkpointColumns(cols);
+    cp.write(ssolver::CP_SECTION_KPROC, cols);
+
+    cp.write(ssolver::CP_BLOCK_CR_RECORDED, pCRData.recorded);
+    cp.write(ssolver::CP_BLOCK_CR_POW, pCRData.pow);
+    cp.write(ssolver::CP_BLOCK_CR_POS, pCRData.pos);
+    cp.write(ssolver::CP_BLOCK_CR_RATE, pCRData.rate);
+
+    std::vector<uint> sizes;
+    std::vector<double> sums;
+    std::vector<uint> indices;
+    sizes.push_back(nGroups.size());
+    sizes.push_back(pGroups.size());
+    for (auto groups: {&nGroups, &pGroups})
+    {
+        for (auto group: *groups)
+        {
+            sizes.push_back(group->capacity);
+            sizes.push_back(group->size);
+            sums.push_back(group->max);
+            sums.push_back(group->sum);
+            indices.insert(indices.end(), group->indices, group->indices + group->size);
+        }
+    }
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_SIZES, sizes);
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_SUMS, sums);
+    cp.write(ssolver::CP_BLOCK_CR_GROUP_INDICES, indices);
+
+    uint solver_uints[2] = {nEntries, pCRUpdates};
+    double solver_reals[5] = {pSum, nSum, pA0, pTemp, pEFDT};
+    cp.write(ssolver::CP_BLOCK_SOLVER_UINTS, solver_uints, 2);
+    cp.write(ssolver::CP_BLOCK_SOLVER_REALS, solver_reals, 5);
+
+    if (efflag()) {
+        pEField->checkpoint(cp.beginStream(ssolver::CP_BLOCK_EFIELD));
+        cp.endStream();
+
+        std::vector<double> verts_v(pEFNVerts);
+        for (uint vlidx = 0; vlidx < pEFNVerts; vlidx++)
+            verts_v[vlidx] = pEField->getVertV(vlidx);
+        cp.write(ssolver::CP_BLOCK_EFIELD_V, verts_v);
+    }
+
+    cp.close();
+    std::cout << "complete.\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void stex::Tetexact::restore(std::string const & file_name)
+{
+    if (ssolver::CPReader::isCPFile(file_name) == false)
+    {
+        _restoreLegacy(file_name);
+        return;
+    }
+
+    ssolver::CPReader cp(file_name);
+    cp.checkFingerprints(statedef()->fingerprint(), _cpMeshFingerprint());
+
+    // Validate the whole file before any state changes, so that a failed
+    // restore leaves the simulation as it was.
+    cp.verify();
+
+    ssolver::CPColumns cols;
+    for (auto wmv: pWmVols)
+        if (wmv != 0) wmv->checkpointColumns(cols);
+    cp.checkColumns(ssolver::CP_SECTION_WMVOL, cols);
+
+    cols.clear();
+    for (auto t: pTets)
+        if (t != 0) t->checkpointColumns(cols);
+    cp.checkColumns(ssolver::CP_SECTION_TET, cols);
+
+    cols.clear();
+    for (auto t: pTris)
+        if (t != 0) t->checkpointColumns(cols);
+    cp.checkColumns(ssolver::CP_SECTION_TRI, cols);
+
+    cols.clear();
+    for (auto kp: pKProcs) kp->checkpointColumns(cols);
+    cp.checkColumns(ssolver::CP_SECTION_KPROC, cols);
+    cols.clear();
+
+    uint64_t nrecorded = 0, npow = 0, npos = 0, nrate = 0;
+    cp.block<unsigned char>(ssolver::CP_BLOCK_CR_RECORDED, nrecorded);
+    cp.block<int>(ssolver::CP_BLOCK_CR_POW, npow);
+    cp.block<unsigned>(ssolver::CP_BLOCK_CR_POS, npos);
+    cp.block<double>(ssolver::CP_BLOCK_CR_RATE, nrate);
+
+    uint64_t nsizes = 0, nsums = 0, nindices = 0;
+    uint const * sizes = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_SIZES, nsizes);
+    double const * sums = cp.block<double>(ssolver::CP_BLOCK_CR_GROUP_SUMS, nsums);
+    uint const * indices = cp.block<uint>(ssolver::CP_BLOCK_CR_GROUP_INDICES, nindices);
+
+    uint n_ngroups = (nsizes >= 2) ? sizes[0] : 0;
+    uint n_pgroups = (nsizes >= 2) ? sizes[1] : 0;
+    uint ngroups = n_ngroups + n_pgroups;
+    bool groups_ok = (nsizes == 2 + 2 * static_cast<uint64_t>(ngroups)
+                      && nsums == 2 * static_cast<uint64_t>(ngroups));
+    uint64_t total_size = 0;
+    for (uint i = 0; groups_ok && i < ngroups; ++i)
+    {
+        uint capacity = sizes[2 + 2 * i];
+        uint size = sizes[3 + 2 * i];
+        groups_ok = (size <= capacity);
+        total_size += size;
+    }
+    for (uint i = 0; groups_ok && i < nindices; ++i)
+        groups_ok = (indices[i] < nEntries);
+    if (groups_ok == false || total_size != nindices)
+    {
+        std::ostringstream os;
+        os << "Checkpoint file " << file_name << " has inconsistent CR groups.";
+        throw steps::ArgErr(os.str());
+    }
+
+    uint64_t nuints = 0, nreals = 0, nverts = 0;
+    uint const * solver_uints = cp.block<uint>(ssolver::CP_BLOCK_SOLVER_UINTS, nuints);
+    double const * solver_reals = cp.block<double>(ssolver::CP_BLOCK_SOLVER_REALS, nreals);
+    double const * verts_v = 0;
+    if (efflag())
+        verts_v = cp.block<double>(ssolver::CP_BLOCK_EFIELD_V, nverts);
+    if (nuints != 2 || nreals != 5 || solver_uints[0] != nEntries
+        || nrecorded != pCRData.recorded.size() || npow != pCRData.pow.size()
+        || npos != pCRData.pos.size() || nrate != pCRData.rate.size()
+        || (efflag() && nverts != pEFNVerts))
+    {
+        std::ostringstream os;
+        os << "Checkpoint file " << file_name << " does not match the simulation.";
+        throw steps::ArgErr(os.str());
+    }
+
+    statedef()->restore(cp.stream(ssolver::CP_BLOCK_STATEDEF));
+
+    ssolver::CPCursor wmvols(cp, ssolver::CP_SECTION_WMVOL);
+    for (auto wmv: pWmVols)
+        if (wmv != 0) wmv->restoreColumns(wmvols);
+    wmvols.finish();
+
+    ssolver::CPCursor tets(cp, ssolver::CP_SECTION_TET);
+    for (auto t: pTets)
+        if (t != 0) t->restoreColumns(tets);
+    tets.finish();
+
+    ssolver::CPCursor tris(cp, ssolver::CP_SECTION_TRI);
+    for (auto t: pTris)
+        if (t != 0) t->restoreColumns(tris);
+    tris.finish();
+
+    ssolver::CPCursor kprocs(cp, ssolver::CP_SECTION_KPROC);
+    for (auto kp: pKProcs) kp->restoreColumns(kprocs);
+    kprocs.finish();
+
+    cp.read(ssolver::CP_BLOCK_CR_RECORDED, pCRData.recorded);
+    cp.read(ssolver::CP_BLOCK_CR_POW, pCRData.pow);
+    cp.read(ssolver::CP_BLOCK_CR_POS, pCRData.pos);
+    cp.read(ssolver::CP_BLOCK_CR_RATE, pCRData.rate);
+
+    // Replace the groups only once the new ones are known to be
+    // consistent; the old ones would otherwise be left dangling.
+    for (auto g: nGroups) { g->free_indices(); delete g; }
+    for (auto g: pGroups) { g->free_indices(); delete g; }
+    nGroups.resize(n_ngroups);
+    pGroups.resize(n_pgroups);
+
+    uint64_t next_index = 0;
+    for (uint i = 0; i < ngroups; ++i)
+    {
+        uint capacity = sizes[2 + 2 * i];
+        uint size = sizes[3 + 2 * i];
+        CRGroup * group = new CRGroup(0, capacity);
+        group->size = size;
+        group->max = sums[2 * i];
+        group->sum = sums[2 * i + 1];
+        std::copy(indices + next_index, indices + next_index + size, group->indices);
+        next_index += size;
+
+        if (i < n_ngroups) nGroups[i] = group;
+        else pGroups[i - n_ngroups] = group;
+    }
+
+    // Every node of the sum trees is computed from the group sums in the
+    // same order whether it is refreshed or rebuilt, so the rebuilt trees
+    // are those of the checkpointed run, to the last bit.
+    nTree.rebuild(nGroups);
+    pTree.rebuild(pGroups);
+
+    pCRUpdates = solver_uints[1];
+    pSum = solver_reals[0];
+    nSum = solver_reals[1];
+    pA0 = solver_reals[2];
+
+    if (efflag()) {
+        pTemp = solver_reals[3];
+        pEFDT = solver_reals[4];
+        pEField->restore(cp.stream(ssolver::CP_BLOCK_EFIELD));
+        for (uint vlidx = 0; vlidx < pEFNVerts; vlidx++)
+            pEField->setVertV(vlidx, verts_v[vlidx]);
+        _invalidateEFieldVDep();
+        pEFFullUpdate = true;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+steps::util::hash_type stex::Tetexact::_cpMeshFingerprint(void) const
+{
+    return steps::util::fnv1a_combine(mesh()->fingerprint(),
+        static_cast<uint>(pKProcs.size()), efflag());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_restoreLegacy(std::string const & file_name)
 {
     std::fstream cp_file;
 
@@ -330,8 +603,10 @@ void stex::Tetexact::restore(std::string const & file_name)
         }
     }
 
-    KProcPVecCI e = pKProcs.end();
-    for (KProcPVecCI i = pKProcs.begin(); i != e; ++i) (*i)->restore(cp_file);
+    for (auto kp: pKProcs) {
+        kp->restore(cp_file);
+        pCRData.restore(kp->schedIDX(), cp_file);
+    }
 
 
 
@@ -339,6 +614,8 @@ void stex::Tetexact::restore(std::string const & file_name)
         cp_file.read((char*)&pTemp, sizeof(double));
         cp_file.read((char*)&pEFDT, sizeof(double));
         pEField->restore(cp_file);
+        _invalidateEFieldVDep();
+        pEFFullUpdate = true;
     }
 
     uint stored_entries = 0;
@@ -380,11 +657,7 @@ void stex::Tetexact::restore(std::string const & file_name)
         nGroups[i]->max = max;
         nGroups[i]->sum = sum;
 
-        for (uint j = 0; j < size; j++) {
-            uint idx;
-            cp_file.read((char*)&idx, sizeof(uint));
-            nGroups[i]->indices[j] = pKProcs[idx];
-        }
+        cp_file.read((char*)nGroups[i]->indices, sizeof(uint) * size);
     }
 
     for (uint i = 0; i < n_pgroups; i++) {
@@ -403,13 +676,17 @@ void stex::Tetexact::restore(std::string const & file_name)
         pGroups[i]->max = max;
         pGroups[i]->sum = sum;
 
-        for (uint j = 0; j < size; j++) {
-            uint idx;
-            cp_file.read((char*)&idx, sizeof(uint));
-            pGroups[i]->indices[j] = pKProcs[idx];
-        }
+        cp_file.read((char*)pGroups[i]->indices, sizeof(uint) * size);
     }
 
+    nTree.rebuild(nGroups);
+    pTree.rebuild(pGroups);
+
+    // updates since the last recomputation, missing in checkpoints of
+    // older versions
+    cp_file.read((char*)&pCRUpdates, sizeof(uint));
+    if (cp_file.good() == false) pCRUpdates = 0;
+
     cp_file.close();
 
 }
@@ -990,26 +1267,7 @@ void stex::Tetexact::_setup(void)
         if (t) t->setupKProcs(this, efflag());
 
     // Resolve all dependencies
-    for (auto t: pTets) {
-        // DEBUG: vector holds all possible tetrahedrons,
-        // but they have not necessarily been added to a compartment.
-        if (!t) continue;
-        for (auto k: t->kprocs()) k->setupDeps();
-    }
-
-    for (auto wmv: pWmVols) {
-        // Vector allows for all compartments to be well-mixed, so
-        // hold null-pointer for mesh compartments
-        if (!wmv) continue;
-        for (auto k: wmv->kprocs()) k->setupDeps();
-    }
-
-    for (auto t: pTris) {
-        // DEBUG: vector holds all possible triangles, but
-        // only patch triangles are filled
-        if (!t) continue;
-        for (auto k: t->kprocs()) k->setupDeps();
-    }
+    pDepGraph.build(pKProcs);
 
     // Create EField structures if EField is to be calculated
     if (efflag() == true) _setupEField();
@@ -1036,6 +1294,12 @@ void stex::Tetexact::_setupEField(void)
     case EF_DV_BDSYS:
         pEField = make_EField<dVSolverBanded>();
         break;
+    case EF_DV_PCG:
+        pEField = make_EField<dVSolverPCG>();
+        break;
+    case EF_DV_CONDENSED:
+        pEField = make_EField<dVSolverCondensed>();
+        break;
     default:
         throw steps::ArgErr("Unsupported E-Field solver.");
     }
@@ -1167,6 +1431,23 @@ void stex::Tetexact::_setupEField(void)
         pEFTris_vec[eft] = pTris[triidx];
     }
 
+    // Register the voltage-dependent kprocs by EField triangle, so that
+    // only these are refreshed after an EField step.
+    pEFTri_VDepOffsets.assign(1, 0);
+    pEFTri_VDepKProcs.clear();
+    for (auto tri: pEFTris_vec)
+    {
+        ssolver::Patchdef * pdef = tri->patchdef();
+        for (uint i = 0; i < pdef->countVDepTrans(); ++i)
+            pEFTri_VDepKProcs.push_back(tri->vdeptrans(i)->schedIDX());
+        for (uint i = 0; i < pdef->countVDepSReacs(); ++i)
+            pEFTri_VDepKProcs.push_back(tri->vdepsreac(i)->schedIDX());
+        for (uint i = 0; i < pdef->countGHKcurrs(); ++i)
+            pEFTri_VDepKProcs.push_back(tri->ghkcurr(i)->schedIDX());
+        pEFTri_VDepOffsets.push_back(pEFTri_VDepKProcs.size());
+    }
+    pEFTri_VRefresh.assign(neftris(), std::numeric_limits<double>::quiet_NaN());
+
     std::cout << "Initting mesh with:" << std::endl;
     std::cout << "Number of EF verts:" << nefverts() << std::endl
               << "Number of EF tris:" << neftris() << std::endl
@@ -1409,12 +1690,22 @@ void stex::Tetexact::reset(void)
     }
     pGroups.clear();
 
+    pCRData.reset();
+    nTree.clear();
+    pTree.clear();
+    pCRUpdates = 0;
+
     pSum = 0.0;
     nSum = 0.0;
     pA0 = 0.0;
 
     statedef()->resetTime();
     statedef()->resetNSteps();
+    pNLeapedEvents = 0;
+    pNExactEvents = 0;
+
+    _invalidateEFieldVDep();
+    pEFFullUpdate = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1429,6 +1720,20 @@ void stex::Tetexact::run(double endtime)
             os << "Endtime is before current simulation time";
             throw steps::ArgErr(os.str());
         }
+        if (pDomainSet != 0)
+        {
+            ulong nevents = pDomainSet->run(statedef()->time(), endtime, rng());
+            statedef()->setTime(endtime);
+            statedef()->incNSteps(nevents);
+            // Bring the serial schedule up to date with the new state.
+            _update();
+            return;
+        }
+        if (pTauLeaping == true)
+        {
+            _runTauLeap(endtime);
+            return;
+        }
         while (statedef()->time() < endtime)
         {
             stex::KProc * kp = _getNext();
@@ -1446,12 +1751,17 @@ void stex::Tetexact::run(double endtime)
         // Run the simulation, including the EField calculation.
         // This loop will assume that the SSA dt is sufficiently small so
         // that a number of SSA events execute between every EField calculation.
-        // A warning message will be printed if the SSA dt is larger than the EField dt.
-        // The EField dt is actually a MAXIMUM dt- the actual time for the EField
-        // calculation will be exact with respect to the last event time in the
-        // SSA before reaching the EField dt.
+        // Every EField step is exactly the EField dt: the SSA runs up to the
+        // end of the step, and as the waiting time to the next event is
+        // memoryless it is drawn anew from there. A fixed step lets the
+        // EField solver reuse its factorisation from one step to the next.
+        // With adaptive EField stepping the step is the one chosen by the
+        // EField error control before the interval, which the EField takes
+        // whole, so that the SSA never has to be undone.
         while (statedef()->time() < endtime)
         {
+            double ef_dt = pEField->getAdaptive() ? pEField->getNextDT() : pEFDT;
+
             // The zero propensity
             double a0 = getA0();
             // We need a bool to check if the SSA contains no possible events. In
@@ -1460,39 +1770,23 @@ void stex::Tetexact::run(double endtime)
             double ssa_dt = 0.0;
             if (a0 != 0.0) ssa_dt = rng()->getExp(a0);
             else (ssa_on = false);
-            // Set the actual efield dt. This value will take a maximum pEFDT.
-            double ef_dt = 0.0;
+            // The time run by the SSA in this step.
+            double ssa_time = 0.0;
 
-            while (ssa_on && (ef_dt + ssa_dt) < pEFDT )
+            while (ssa_on && (ssa_time + ssa_dt) < ef_dt )
             {
                 stex::KProc * kp = _getNext();
                 if (kp == 0) break;
                 _executeStep(kp, ssa_dt);
-                ef_dt += ssa_dt;
+                ssa_time += ssa_dt;
 
                 a0 = getA0();
                 if (a0 != 0.0) ssa_dt = rng()->getExp(a0);
                 else (ssa_on = false);
 
             }
-            assert(ef_dt < pEFDT);
-
-            // It's possible that ef_dt is zero here: ssa_dt is large, or has become large.
-            // In that case print a warning but continue, running the EField simulation for EFDT
-            if (ssa_on == false || ef_dt == 0.0)
-            {
-                std::ostringstream os;
-                //os << "\nWARNING: SSA tau is larger than EField dt.";
-                //std::cout << os << std::endl;
-            }
-
-            if (ef_dt == 0.0)
-            {
-                // This means that tau is larger than EField dt. We have no choice but to
-                // increase the state time by pEFDT.
-                ef_dt = pEFDT;
-                statedef()->incTime(pEFDT);
-            }
+            assert(ssa_time < ef_dt);
+            statedef()->incTime(ef_dt - ssa_time);
 
             // Now to perform the EField calculation. This means finding ohmic and GHK
             // currents from triangles during the ef_dt and applying these to the EField
@@ -1530,8 +1824,7 @@ void stex::Tetexact::run(double endtime)
             }
             CLOG(DEBUG, "steps_debug") << "computed voltages: " << EFTrisV;
             #endif
-            // TODO: Replace this with something that only resets voltage-dependent things
-            _update();
+            _updateEFieldVDep();
         }
     }
 
@@ -1613,6 +1906,8 @@ void stex::Tetexact::setTemp(double t)
     }
     assert(t >= 0.0);
     pTemp = t;
+    // GHK rates depend on the temperature as well as the voltage.
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2321,13 +2616,15 @@ void stex::Tetexact::_setPatchVDepSReacActive(uint pidx, uint vsridx, bool a)
 }
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Tetexact::addKProc(steps::tetexact::KProc * kp)
+void stex::Tetexact::addKProc(steps::tetexact::KProc * kp, uint kind)
 {
     assert (kp != 0);
+    assert (kind < KP_NKINDS);
 
     SchedIDX nidx = pKProcs.size();
     pKProcs.push_back(kp);
     kp->setSchedIDX(nidx);
+    pCRData.push_back(kind);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2350,60 +2647,27 @@ steps::tetexact::KProc * stex::Tetexact::_getNext(void) const
 
     double selector = pA0 * rng()->getUnfII();
 
-    double partial_sum = 0.0;
-
     uint n_neg_groups = nGroups.size();
     uint n_pos_groups = pGroups.size();
 
-    for (uint i = 0; i < n_neg_groups; i++) {
-        CRGroup* group = nGroups[i];
-        if (group->size == 0) continue;
-
-        if (selector > partial_sum + group->sum) {
-            partial_sum += group->sum;
-
-            continue;
-        }
-
-        double g_max = group->max;
-        double random_rate = g_max * rng()->getUnfII();;
-        uint group_size = group->size;
-        uint random_pos = rng()->get() % group_size;
-        KProc* random_kp = group->indices[random_pos];
-
-        while (random_kp->crData.rate <= random_rate) {
-            random_rate = g_max * rng()->getUnfII();
-            random_pos = rng()->get() % group_size;
-            random_kp = group->indices[random_pos];
-        }
-
-        return random_kp;
+    // Groups are searched in the same order as a linear scan, first the
+    // negative groups then the positive groups, but through the sum trees.
+    double neg_sum = nTree.total();
+    double partial_sum = selector;
+    uint pos;
+    if (selector <= neg_sum) {
+        pos = nTree.search(partial_sum);
+    }
+    else {
+        partial_sum -= neg_sum;
+        pos = n_neg_groups + pTree.search(partial_sum);
     }
 
-
-    for (uint i = 0; i < n_pos_groups; i++) {
-        CRGroup* group = pGroups[i];
-        if (group->size == 0) continue;
-
-        if (selector > partial_sum + group->sum) {
-            partial_sum += group->sum;
-            continue;
-        }
-
-        double g_max = group->max;
-        double random_rate = g_max * rng()->getUnfII();;
-        uint group_size = group->size;
-        uint random_pos = rng()->get() % group_size;
-        KProc* random_kp = group->indices[random_pos];
-
-
-        while (random_kp->crData.rate <= random_rate) {
-            random_rate = g_max * rng()->getUnfII();
-            random_pos = rng()->get() % group_size;
-            random_kp = group->indices[random_pos];
-        }
-
-        return random_kp;
+    // Skip groups that are empty but sit on the selected boundary due
+    // to rounding.
+    for (; pos < n_neg_groups + n_pos_groups; pos++) {
+        CRGroup* group = (pos < n_neg_groups) ? nGroups[pos] : pGroups[pos - n_neg_groups];
+        if (group->size != 0) return _selectInGroup(group);
     }
 
     // Precision rounding error force clean up
@@ -2411,44 +2675,13 @@ steps::tetexact::KProc * stex::Tetexact::_getNext(void) const
     for (int i = n_pos_groups - 1; i >= 0; i--) {
         CRGroup* group = pGroups[i];
         if (group->size == 0) continue;
-
-        double g_max = group->max;
-        double random_rate = g_max * rng()->getUnfII();;
-        uint group_size = group->size;
-        uint random_pos = rng()->get() % group_size;
-        KProc* random_kp = group->indices[random_pos];
-
-
-        while (random_kp->crData.rate <= random_rate) {
-            random_rate = g_max * rng()->getUnfII();
-            random_pos = rng()->get() % group_size;
-            random_kp = group->indices[random_pos];
-
-        }
-
-        return random_kp;
+        return _selectInGroup(group);
     }
 
     for (int i = n_neg_groups - 1; i >= 0; i--) {
         CRGroup* group = nGroups[i];
         if (group->size == 0) continue;
-
-        double g_max = group->max;
-        double random_rate = g_max * rng()->getUnfII();;
-        uint group_size = group->size;
-        uint random_pos = rng()->get() % group_size;
-        KProc* random_kp = group->indices[random_pos];
-
-
-
-        while (random_kp->crData.rate <= random_rate) {
-            random_rate = g_max * rng()->getUnfII();
-            random_pos = rng()->get() % group_size;
-            random_kp = group->indices[random_pos];
-
-        }
-
-        return random_kp;
+        return _selectInGroup(group);
     }
 
     // Precision rounding error force clean up - Complete
@@ -2456,7 +2689,7 @@ steps::tetexact::KProc * stex::Tetexact::_getNext(void) const
     std::cerr << "Cannot find any suitable entry.\n";
     std::cerr << "A0: " << std::setprecision (15) << pA0 << "\n";
     std::cerr << "Selector: " << std::setprecision (15) << selector << "\n";
-    std::cerr << "Current Partial Sum: " << std::setprecision (15) << partial_sum << "\n";
+    std::cerr << "Remainder in Group: " << std::setprecision (15) << partial_sum << "\n";
 
     std::cerr << "Distribution of group sums\n";
     std::cerr << "Negative groups\n";
@@ -2472,6 +2705,92 @@ steps::tetexact::KProc * stex::Tetexact::_getNext(void) const
     throw;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+steps::tetexact::KProc * stex::Tetexact::_selectInGroup(CRGroup * group) const
+{
+    double g_max = group->max;
+    double random_rate = g_max * rng()->getUnfII();
+    uint group_size = group->size;
+    uint random_pos = rng()->get() % group_size;
+    uint random_idx = group->indices[random_pos];
+
+    while (pCRData.rate[random_idx] <= random_rate) {
+        random_rate = g_max * rng()->getUnfII();
+        random_pos = rng()->get() % group_size;
+        random_idx = group->indices[random_pos];
+    }
+
+    return pKProcs[random_idx];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_recomputeSum(void)
+{
+    for (auto g: nGroups) _sumGroup(g);
+    for (auto g: pGroups) _sumGroup(g);
+    nTree.rebuild(nGroups);
+    pTree.rebuild(pGroups);
+    pCRUpdates = 0;
+
+    pA0 = nTree.total() + pTree.total();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_sumGroup(CRGroup * group)
+{
+    double sum = 0.0;
+    for (uint i = 0; i < group->size; i++) sum += pCRData.rate[group->indices[i]];
+    group->sum = sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setA0RecomputeInterval(uint nupdates)
+{
+    pCRRecompute = nupdates;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_updateEFieldVDep(void)
+{
+    if (pEFFullUpdate)
+    {
+        // The first step after setup, reset or restore updates all kprocs,
+        // as every step used to. This also schedules the kprocs that can
+        // fire without any molecules present, such as zero-order reactions.
+        pEFFullUpdate = false;
+        for (uint tlidx = 0; tlidx < neftris(); ++tlidx)
+            pEFTri_VRefresh[tlidx] = pEField->getTriV(tlidx);
+        _update();
+        return;
+    }
+
+    for (uint tlidx = 0; tlidx < neftris(); ++tlidx)
+    {
+        double v = pEField->getTriV(tlidx);
+        // A NaN reference always fails the comparison.
+        if (std::fabs(v - pEFTri_VRefresh[tlidx]) <= pEFVTol) continue;
+        pEFTri_VRefresh[tlidx] = v;
+
+        uint kend = pEFTri_VDepOffsets[tlidx + 1];
+        for (uint k = pEFTri_VDepOffsets[tlidx]; k < kend; ++k)
+            _updateElement(pEFTri_VDepKProcs[k]);
+    }
+    _updateSum();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_invalidateEFieldVDep(void)
+{
+    std::fill(pEFTri_VRefresh.begin(), pEFTri_VRefresh.end(),
+              std::numeric_limits<double>::quiet_NaN());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /*
 void stex::Tetexact::_reset(void)
@@ -2481,12 +2800,62 @@ void stex::Tetexact::_reset(void)
 */
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Tetexact::_executeStep(steps::tetexact::KProc * kp, double dt)
+uint stex::Tetexact::_executeStep(steps::tetexact::KProc * kp, double dt)
 {
-    std::vector<KProc*> const & upd = kp->apply(rng(), dt, statedef()->time());
-    _update(upd.begin(), upd.end());
+    double start = (pProfile != 0) ? ssolver::KProcProfile::now() : 0.0;
+
+    SchedIDX sidx = kp->schedIDX();
+    uint row = kprocApply(kp, pCRData.kind[sidx], rng(), dt, statedef()->time());
+    _update(pDepGraph.begin(sidx, row), pDepGraph.end(sidx, row));
+
+    if (pProfile != 0)
+    {
+        ulong nupdates = pDepGraph.end(sidx, row) - pDepGraph.begin(sidx, row);
+        pProfile->record(sidx, 1, nupdates, ssolver::KProcProfile::now() - start);
+    }
     statedef()->incTime(dt);
     statedef()->incNSteps(1);
+    return row;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::_runTauLeap(double endtime)
+{
+    // Clamping, pools or rates may have changed since the last run.
+    pTauLeap->setup(pCRData.rate);
+
+    std::vector<SchedIDX> updates;
+    while (statedef()->time() < endtime)
+    {
+        double a0 = getA0();
+        if (a0 == 0.0) break;
+
+        ulong nevents = 0;
+        double tau = pTauLeap->step(rng(), pCRData.rate, a0,
+            endtime - statedef()->time(), updates, nevents);
+        if (tau > 0.0)
+        {
+            _update(updates.begin(), updates.end());
+            pTauLeap->update(updates.begin(), updates.end(), pCRData.rate);
+            statedef()->incTime(tau);
+            if (nevents != 0) statedef()->incNSteps(nevents);
+            pNLeapedEvents += nevents;
+            continue;
+        }
+
+        // The leap would cover only a few events: take an exact SSA step.
+        // The leap bound is kept up to date, so trying again is cheap.
+        stex::KProc * kp = _getNext();
+        if (kp == 0) break;
+        double dt = rng()->getExp(a0);
+        if ((statedef()->time() + dt) > endtime) break;
+        SchedIDX sidx = kp->schedIDX();
+        uint row = _executeStep(kp, dt);
+        pTauLeap->update(pDepGraph.begin(sidx, row), pDepGraph.end(sidx, row), pCRData.rate);
+        pNExactEvents++;
+    }
+    statedef()->setTime(endtime);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3783,6 +4152,296 @@ void stex::Tetexact::setEfieldDT(double efdt)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::Tetexact::setEfieldVTolerance(double tol)
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    if (tol < 0.0)
+    {
+        std::ostringstream os;
+        os << "EField voltage tolerance cannot be negative.";
+        throw steps::ArgErr(os.str());
+    }
+    pEFVTol = tol;
+    _invalidateEFieldVDep();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol)
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    pEField->setAdaptive(adaptive, dtmin, dtmax, errtol);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool stex::Tetexact::getEfieldAdaptive(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getAdaptive();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stex::Tetexact::getEfieldNStepsWithinTolerance(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getNStepsWithinTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stex::Tetexact::getEfieldNStepsOverTolerance(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getNStepsOverTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setNumDomains(uint ndomains)
+{
+    if (ndomains == 0)
+    {
+        std::ostringstream os;
+        os << "Number of domains must be positive.";
+        throw steps::ArgErr(os.str());
+    }
+    if (ndomains == 1)
+    {
+        delete pDomainSet;
+        pDomainSet = 0;
+        return;
+    }
+
+    uint ntets = mesh()->countTets();
+    std::vector<bool> included(ntets, false);
+    for (uint t = 0; t < ntets; ++t) included[t] = (pTets[t] != 0);
+    setTetDomains(stex::DomainSet::partition(mesh(), included, ndomains));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setTetDomains(std::vector<uint> const & domains)
+{
+    if (efflag() == true)
+    {
+        std::ostringstream os;
+        os << "Method not available with EField calculation.";
+        throw steps::ArgErr(os.str());
+    }
+    if (pTauLeaping == true)
+    {
+        std::ostringstream os;
+        os << "Spatial domains are not available with tau-leaping.";
+        throw steps::ArgErr(os.str());
+    }
+    for (auto wvol: pWmVols)
+    {
+        if (wvol == 0) continue;
+        std::ostringstream os;
+        os << "Domain decomposition is not available with well-mixed ";
+        os << "compartments.";
+        throw steps::ArgErr(os.str());
+    }
+
+    stex::DomainSet * dset = new stex::DomainSet(this, pDepGraph, domains);
+    delete pDomainSet;
+    pDomainSet = dset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::Tetexact::getNumDomains(void) const
+{
+    return (pDomainSet == 0) ? 1 : pDomainSet->countDomains();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint> stex::Tetexact::getTetDomains(void) const
+{
+    if (pDomainSet == 0) return std::vector<uint>(mesh()->countTets(), 0);
+    return pDomainSet->tetDomains();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setProfiling(bool enabled)
+{
+    delete pProfile;
+    pProfile = 0;
+    if (enabled == false) return;
+
+    pProfile = new ssolver::KProcProfile(statedef());
+    for (auto wmv: pWmVols)
+    {
+        if (wmv == 0) continue;
+        uint cidx = wmv->compdef()->gidx();
+        uint j = 0;
+        for (auto kp: wmv->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->compRow(cidx, j++));
+    }
+    for (auto tet: pTets)
+    {
+        if (tet == 0) continue;
+        uint cidx = tet->compdef()->gidx();
+        uint j = 0;
+        for (auto kp: tet->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->compRow(cidx, j++));
+    }
+    for (auto tri: pTris)
+    {
+        if (tri == 0) continue;
+        uint pidx = tri->patchdef()->gidx();
+        uint j = 0;
+        for (auto kp: tri->kprocs())
+            pProfile->setKProcRow(kp->schedIDX(), pProfile->patchRow(pidx, j++));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool stex::Tetexact::getProfiling(void) const
+{
+    return (pProfile != 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::resetProfile(void)
+{
+    if (pProfile != 0) pProfile->clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<ssolver::KProcProfileRow> stex::Tetexact::getProfile(void) const
+{
+    if (pProfile == 0)
+    {
+        std::ostringstream os;
+        os << "Profiling is not enabled.";
+        throw steps::ArgErr(os.str());
+    }
+    return pProfile->rows();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::Tetexact::countProfileRows(void) const
+{
+    return (pProfile == 0) ? 0 : pProfile->countRows();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::getProfileNP(double * table, int table_size) const
+{
+    if (pProfile == 0)
+    {
+        std::ostringstream os;
+        os << "Profiling is not enabled.";
+        throw steps::ArgErr(os.str());
+    }
+    pProfile->fillTable(table, table_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setTauLeaping(bool enabled)
+{
+    if (enabled == true && efflag() == true)
+    {
+        std::ostringstream os;
+        os << "Tau-leaping is not available with EField calculation.";
+        throw steps::ArgErr(os.str());
+    }
+    if (enabled == true && pDomainSet != 0)
+    {
+        std::ostringstream os;
+        os << "Tau-leaping is not available with spatial domains.";
+        throw steps::ArgErr(os.str());
+    }
+    pTauLeaping = enabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool stex::Tetexact::getTauLeaping(void) const
+{
+    return pTauLeaping;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setTauLeapEpsilon(double eps)
+{
+    pTauLeap->setEpsilon(eps);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double stex::Tetexact::getTauLeapEpsilon(void) const
+{
+    return pTauLeap->getEpsilon();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tetexact::setTauLeapCriticalCount(uint n)
+{
+    pTauLeap->setCriticalCount(n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint stex::Tetexact::getTauLeapCriticalCount(void) const
+{
+    return pTauLeap->getCriticalCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stex::Tetexact::getNLeapedEvents(void) const
+{
+    return pNLeapedEvents;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stex::Tetexact::getNExactEvents(void) const
+{
+    return pNExactEvents;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double stex::Tetexact::_getTetV(uint tidx) const
 {
     if (efflag() != true)
@@ -3824,6 +4483,7 @@ void stex::Tetexact::_setTetV(uint tidx, double v)
 
     // EField object should convert to millivolts
     pEField->setTetV(loctidx, v);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3866,6 +4526,7 @@ void stex::Tetexact::_setTetVClamped(uint tidx, bool cl)
     }
 
     pEField->setTetVClamped(loctidx, cl);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3909,6 +4570,7 @@ void stex::Tetexact::_setTriV(uint tidx, double v)
 
     // EField object should convert to millivolts
     pEField->setTriV(loctidx, v);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3951,6 +4613,7 @@ void stex::Tetexact::_setTriVClamped(uint tidx, bool cl)
     }
 
     pEField->setTriVClamped(loctidx, cl);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4088,6 +4751,7 @@ void stex::Tetexact::_setVertIClamp(uint vidx, double cur)
 
     // EField object should convert to required units
     pEField->setVertIClamp(locvidx, cur);
+    _invalidateEFieldVDep();
 }
 
 
@@ -4111,6 +4775,7 @@ void stex::Tetexact::_setTriIClamp(uint tidx, double cur)
 
     // EField object should convert to required units
     pEField->setTriIClamp(loctidx, cur);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4153,6 +4818,7 @@ void stex::Tetexact::_setVertV(uint vidx, double v)
     }
     // EField object should convert to millivolts
     pEField->setVertV(locvidx, v);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4195,6 +4861,7 @@ void stex::Tetexact::_setVertVClamped(uint vidx, bool cl)
     }
     // EField object should convert to millivolts
     pEField->setVertVClamped(locvidx, cl);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4216,6 +4883,7 @@ void stex::Tetexact::_setMembRes(uint midx, double ro, double vrev)
     // EField object should convert to required units
     assert (midx == 0);
     pEField->setSurfaceResistivity(midx, ro, vrev);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4231,6 +4899,7 @@ void stex::Tetexact::_setMembPotential(uint midx, double v)
     // EField object should convert to millivolts
     assert (midx == 0);
     pEField->setMembPotential(midx, v);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4254,6 +4923,7 @@ void stex::Tetexact::_setMembCapac(uint midx, double cm)
     // EField object should convert to required units
     assert (midx == 0);
     pEField->setMembCapac(midx, cm);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4275,19 +4945,22 @@ void stex::Tetexact::_setMembVolRes(uint midx, double ro)
     // EField object should convert to required units
     assert (midx == 0);
     pEField->setMembVolRes(midx, ro);
+    _invalidateEFieldVDep();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::Tetexact::_updateElement(KProc* kp)
+void stex::Tetexact::_updateElement(SchedIDX idx)
 {
 
-    double new_rate = kp->rate(this);
+    double new_rate = kprocRate(pKProcs[idx], pCRData.kind[idx], this);
 
-    CRKProcData & data = kp->crData;
-    double old_rate = data.rate;
+    double old_rate = pCRData.rate[idx];
+    int & data_pow = pCRData.pow[idx];
+    uint & data_pos = pCRData.pos[idx];
+    unsigned char & data_recorded = pCRData.recorded[idx];
 
-    data.rate = new_rate;
+    pCRData.rate[idx] = new_rate;
 
     if (old_rate == new_rate)  return;
 
@@ -4296,34 +4969,34 @@ void stex::Tetexact::_updateElement(KProc* kp)
     if (new_rate >= 0.5) {
 
         // pow is the same
-        int old_pow = data.pow;
+        int old_pow = data_pow;
         int new_pow;
         double temp = frexp(new_rate, &new_pow);
 
-        if (old_pow == new_pow && data.recorded) {
+        if (old_pow == new_pow && data_recorded) {
 
             CRGroup* old_group = _getGroup(old_pow);
 
-            old_group->sum += (new_rate - old_rate);
+            _incGroupSum(old_pow, old_group, new_rate - old_rate);
         }
         // pow is not the same
         else {
-            data.pow = new_pow;
+            data_pow = new_pow;
 
 
-            if (data.recorded) {
+            if (data_recorded) {
 
                 // remove old
                 CRGroup* old_group = _getGroup(old_pow);
                 (old_group->size) --;
 
-                if (old_group->size == 0) old_group->sum = 0.0;
+                if (old_group->size == 0) _clearGroupSum(old_pow, old_group);
                 else {
-                    old_group->sum -= old_rate;
+                    _incGroupSum(old_pow, old_group, -old_rate);
 
-                    KProc* last = old_group->indices[old_group->size];
-                    old_group->indices[data.pos] = last;
-                    last->crData.pos = data.pos;
+                    uint last = old_group->indices[old_group->size];
+                    old_group->indices[data_pos] = last;
+                    pCRData.pos[last] = data_pos;
                 }
             }
 
@@ -4335,42 +5008,42 @@ void stex::Tetexact::_updateElement(KProc* kp)
             assert(new_group != NULL);
             if (new_group->size == new_group->capacity) _extendGroup(new_group);
             uint pos = new_group->size;
-            new_group->indices[pos] = kp;
+            new_group->indices[pos] = idx;
             new_group->size++;
-            new_group->sum += new_rate;
-            data.pos = pos;
+            _incGroupSum(new_pow, new_group, new_rate);
+            data_pos = pos;
 
         }
-        data.recorded = true;
+        data_recorded = 1;
 
     }
     // new rate in negative group
     else if (new_rate < 0.5 && new_rate > 1e-20) {
-        int old_pow = data.pow;
+        int old_pow = data_pow;
         int new_pow;
         double temp = frexp(new_rate, &new_pow);
 
-        if (old_pow == new_pow && data.recorded) {
+        if (old_pow == new_pow && data_recorded) {
 
             CRGroup* old_group = _getGroup(old_pow);
 
-            old_group->sum += (new_rate - old_rate);
+            _incGroupSum(old_pow, old_group, new_rate - old_rate);
         }
         // pow is not the same
         else {
-            data.pow = new_pow;
+            data_pow = new_pow;
 
-            if (data.recorded) {
+            if (data_recorded) {
                 CRGroup* old_group = _getGroup(old_pow);
                 (old_group->size) --;
 
-                if (old_group->size == 0) old_group->sum = 0.0;
+                if (old_group->size == 0) _clearGroupSum(old_pow, old_group);
                 else {
-                    old_group->sum -= old_rate;
+                    _incGroupSum(old_pow, old_group, -old_rate);
 
-                    KProc* last = old_group->indices[old_group->size];
-                    old_group->indices[data.pos] = last;
-                    last->crData.pos = data.pos;
+                    uint last = old_group->indices[old_group->size];
+                    old_group->indices[data_pos] = last;
+                    pCRData.pos[last] = data_pos;
                 }
             }
 
@@ -4382,34 +5055,34 @@ void stex::Tetexact::_updateElement(KProc* kp)
 
             if (new_group->size == new_group->capacity) _extendGroup(new_group);
             uint pos = new_group->size;
-            new_group->indices[pos] = kp;
+            new_group->indices[pos] = idx;
             new_group->size++;
-            new_group->sum += new_rate;
-            data.pos = pos;
+            _incGroupSum(new_pow, new_group, new_rate);
+            data_pos = pos;
 
         }
-        data.recorded = true;
+        data_recorded = 1;
     }
 
     else {
 
-        if (data.recorded) {
+        if (data_recorded) {
 
-            CRGroup* old_group = _getGroup(data.pow);
+            CRGroup* old_group = _getGroup(data_pow);
 
             // remove old
             old_group->size --;
 
-            if (old_group->size == 0) old_group->sum = 0.0;
+            if (old_group->size == 0) _clearGroupSum(data_pow, old_group);
             else {
-                old_group->sum -= old_rate;
+                _incGroupSum(data_pow, old_group, -old_rate);
 
-                KProc* last = old_group->indices[old_group->size];
-                old_group->indices[data.pos] = last;
-                last->crData.pos = data.pos;
+                uint last = old_group->indices[old_group->size];
+                old_group->indices[data_pos] = last;
+                pCRData.pos[last] = data_pos;
             }
         }
-        data.recorded = false;
+        data_recorded = 0;
     }
 
 }
@@ -39,6 +39,7 @@
 // STEPS headers.
 #include "steps/common.h"
 #include "steps/solver/api.hpp"
+#include "steps/solver/kprocprofile.hpp"
 #include "steps/solver/statedef.hpp"
 #include "steps/geom/tetmesh.hpp"
 #include "steps/tetexact/tri.hpp"
@@ -50,6 +51,7 @@
 #include "steps/tetexact/diffboundary.hpp"
 #include "steps/tetexact/sdiffboundary.hpp"
 #include "steps/tetexact/crstruct.hpp"
+#include "steps/tetexact/depgraph.hpp"
 #include "steps/solver/efield/efield.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,16 +62,14 @@ namespace tetexact {
 ////////////////////////////////////////////////////////////////////////////////
 
 // Forward declarations.
-
+class DomainSet;
+class KProcStore;
+class TauLeap;
 
 // Auxiliary declarations.
-typedef uint                            SchedIDX;
 typedef std::set<SchedIDX>              SchedIDXSet;
 typedef SchedIDXSet::iterator           SchedIDXSetI;
 typedef SchedIDXSet::const_iterator     SchedIDXSetCI;
-typedef std::vector<SchedIDX>           SchedIDXVec;
-typedef SchedIDXVec::iterator           SchedIDXVecI;
-typedef SchedIDXVec::const_iterator     SchedIDXVecCI;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -109,7 +109,15 @@ public:
     //void advanceSteps(uint nsteps);
     void step(void);
 
+    /// Write a binary checkpoint: a header identifying the model and mesh,
+    /// followed by column blocks of the pool counts, flags, kproc state
+    /// and composition-rejection data.
     void checkpoint(std::string const & file_name);
+
+    /// Write a checkpoint in the stream format of earlier versions.
+    void checkpointLegacy(std::string const & file_name);
+
+    /// Restore a binary checkpoint, or one in the earlier stream format.
     void restore(std::string const & file_name);
     ////////////////////////// ADDED FOR EFIELD ////////////////////////////
 
@@ -118,6 +126,30 @@ public:
     inline double efdt(void) const
     { return pEFDT; }
 
+    /// Set the voltage change (in volts) a membrane triangle has to exceed,
+    /// relative to the last refresh, before the rates of its
+    /// voltage-dependent kprocs are recomputed after an EField step.
+    /// 0 (the default) refreshes them on any change.
+    void setEfieldVTolerance(double tol);
+
+    inline double getEfieldVTolerance(void) const
+    { return pEFVTol; }
+
+    /// Switch adaptive EField stepping on or off. When on, the EField step
+    /// varies between dtmin and dtmax (seconds) to keep its estimated local
+    /// error in the membrane potential within errtol (volts), and takes the
+    /// place of the EField dt.
+    void setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol);
+
+    bool getEfieldAdaptive(void) const;
+
+    /// Return the numbers of adaptive EField steps within the error
+    /// tolerance, and over it, since adaptive stepping was switched on.
+    /// Adaptive stepping only controls the step length: steps over the
+    /// tolerance are kept and the steps after them shortened.
+    ulong getEfieldNStepsWithinTolerance(void) const;
+    ulong getEfieldNStepsOverTolerance(void) const;
+
     void setTemp(double t);
 
     inline double getTemp(void) const
@@ -126,6 +158,70 @@ public:
     // save the optimal vertex indexing
     void saveMembOpt(std::string const & opt_file_name);
 
+    ////////////////////////// DOMAIN DECOMPOSITION ////////////////////////
+
+    /// Run the SSA in ndomains spatial domains of similar size, in
+    /// parallel on the OpenMP threads. 1 (the default) runs serially.
+    void setNumDomains(uint ndomains);
+
+    /// Run the SSA in the spatial domains given for every tet of the mesh.
+    void setTetDomains(std::vector<uint> const & domains);
+
+    uint getNumDomains(void) const;
+
+    /// Domain of every tet, with the outer tet of each patch triangle
+    /// moved to the domain of its inner tet.
+    std::vector<uint> getTetDomains(void) const;
+
+    ////////////////////////////// PROFILING ///////////////////////////////
+
+    /// Count the events, kproc updates and time spent per rule and
+    /// compartment/patch from now on. Off by default; switching it off
+    /// discards the profile. Events executed in spatial domains are not
+    /// counted.
+    void setProfiling(bool enabled);
+
+    bool getProfiling(void) const;
+
+    /// Zero the counters of the profile.
+    void resetProfile(void);
+
+    std::vector<steps::solver::KProcProfileRow> getProfile(void) const;
+
+    uint countProfileRows(void) const;
+
+    /// Write the profile into a buffer of countProfileRows() rows of
+    /// (type, rule, container, nevents, napplies, nupdates, time).
+    void getProfileNP(double * table, int table_size) const;
+
+    ///////////////////////////// TAU-LEAPING //////////////////////////////
+
+    /// Advance the state with adaptive tau-leaps wherever the propensities
+    /// allow it, falling back to exact SSA steps where they do not. Off by
+    /// default. Not available with the EField calculation or spatial
+    /// domains. Leaped events are not counted in the profile.
+    void setTauLeaping(bool enabled);
+
+    bool getTauLeaping(void) const;
+
+    /// Bound on the expected relative change of any propensity during a
+    /// leap (default 0.03).
+    void setTauLeapEpsilon(double eps);
+
+    double getTauLeapEpsilon(void) const;
+
+    /// Number of events a kproc must be able to fire before exhausting
+    /// a reactant pool to be leaped rather than treated as critical
+    /// (default 10).
+    void setTauLeapCriticalCount(uint n);
+
+    uint getTauLeapCriticalCount(void) const;
+
+    /// Events executed in leaps and in exact SSA steps while tau-leaping.
+    ulong getNLeapedEvents(void) const;
+
+    ulong getNExactEvents(void) const;
+
     ////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////
@@ -138,6 +234,21 @@ public:
     inline double getA0(void) const
     { return pA0; }
 
+    /// Set the number of CR scheduler updates between exact recomputations
+    /// of the group sums from the rates of their kprocs, which bounds the
+    /// drift of the incrementally maintained sums. 0, the default, disables
+    /// the recomputation.
+    ///
+    /// Trajectories with a given seed are reproducible for any interval,
+    /// including across checkpoints, but they are not those of the linear
+    /// group scan of versions before the sum trees: A0 and the group
+    /// partial sums are added in a different order, so a selector close to
+    /// a group boundary can pick the neighbouring group.
+    void setA0RecomputeInterval(uint nupdates);
+
+    inline uint getA0RecomputeInterval(void) const
+    { return pCRRecompute; }
+
     uint getNSteps(void) const;
 
     ////////////////////////////////////////////////////////////////////////
@@ -367,7 +478,14 @@ public:
     ////////////////////////////////////////////////////////////////////////
 
     // Called from local Comp or Patch objects. Add KProc to this object
-    void addKProc(steps::tetexact::KProc * kp);
+    void addKProc(steps::tetexact::KProc * kp, uint kind);
+
+    // Storage for the kprocs, in which local objects create them.
+    inline KProcStore & kprocStore(void)
+    { return *pKProcStore; }
+
+    inline uint kprocKind(SchedIDX idx) const
+    { return pCRData.kind[idx]; }
 
     inline uint countKProcs(void) const
     { return pKProcs.size(); }
@@ -470,7 +588,18 @@ public:
 
     //void _reset(void);
 
-    void _executeStep(steps::tetexact::KProc * kp, double dt);
+    // Apply an event of kp, update the kprocs that depend on it, and return
+    // the dependency row that was updated.
+    uint _executeStep(steps::tetexact::KProc * kp, double dt);
+
+    // Run to endtime in the tau-leaping mode.
+    void _runTauLeap(double endtime);
+
+    // Restore a checkpoint in the stream format of earlier versions.
+    void _restoreLegacy(std::string const & file_name);
+
+    // Fingerprint of the mesh and kproc layout, stored in checkpoints.
+    steps::util::hash_type _cpMeshFingerprint(void) const;
 
     // TODO: Change the following so that only the kprocs depending on
     // the species are updated. These functions are called from interface
@@ -499,6 +628,15 @@ public:
 
     void _setupEField(void);
 
+    // Recompute the rates of the voltage-dependent kprocs of all
+    // EField triangles whose voltage moved beyond pEFVTol.
+    void _updateEFieldVDep(void);
+
+    // Force the next EField step to recompute the rates of the
+    // voltage-dependent kprocs of every triangle, after a change that
+    // pEFVTol would otherwise hide.
+    void _invalidateEFieldVDep(void);
+
     inline uint neftets(void) const
     { return pEFNTets; }
 
@@ -603,11 +741,29 @@ private:
     double                                      nSum;
     double                                      pA0;
 
+    // Storage of the kprocs, one table per kind
+    KProcStore                                * pKProcStore;
+
     std::vector<KProc*>                         pKProcs;
 
+    // CR data of pKProcs, indexed by schedule index
+    CRKProcTable                                pCRData;
+
+    // Kprocs to update after each outcome of each kproc
+    KProcDepGraph                               pDepGraph;
+
     std::vector<CRGroup*>                       nGroups;
     std::vector<CRGroup*>                       pGroups;
 
+    // Sum trees mirroring nGroups and pGroups
+    CRSumTree                                   nTree;
+    CRSumTree                                   pTree;
+
+    // Updates between exact recomputations of the group sums, and the
+    // number of updates since the last one
+    uint                                        pCRRecompute;
+    uint                                        pCRUpdates;
+
     ////////////////////////////////////////////////////////////////////////////////
 
     template <typename KProcPIter>
@@ -661,6 +817,7 @@ private:
             pGroups.push_back(new CRGroup(curr_size));
             curr_size ++;
         }
+        pTree.extend(new_size);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -680,6 +837,7 @@ private:
             nGroups.push_back(new CRGroup(-curr_size));
             curr_size ++;
         }
+        nTree.extend(new_size);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -691,8 +849,8 @@ private:
         #endif
 
         group->capacity += size;
-        group->indices = (KProc**)realloc(group->indices,
-                                          sizeof(KProc*) * group->capacity);
+        group->indices = (uint*)realloc(group->indices,
+                                        sizeof(uint) * group->capacity);
         if (group->indices == NULL) {
             std::cerr << "DirectCR: unable to allocate memory for SSA group.\n";
             throw;
@@ -705,24 +863,50 @@ private:
 
     ////////////////////////////////////////////////////////////////////////////////
 
-    void _updateElement(KProc* kp);
+    // Change the sum of the group with power pow by delta, keeping the
+    // corresponding sum tree in step.
+    inline void _incGroupSum(int pow, CRGroup* group, double delta) {
+        group->sum += delta;
+        if (pow >= 0) pTree.refresh(pow, pGroups);
+        else nTree.refresh(-pow, nGroups);
+    }
+
+    // Reset the sum of an emptied group to exactly zero.
+    inline void _clearGroupSum(int pow, CRGroup* group) {
+        group->sum = 0.0;
+        if (pow >= 0) pTree.refresh(pow, pGroups);
+        else nTree.refresh(-pow, nGroups);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Update the CR data of a kproc. Dependency rows hold schedule
+    // indices, so the kproc object is only touched to compute its rate.
+    void _updateElement(SchedIDX idx);
+
+    inline void _updateElement(KProc* kp) {
+        _updateElement(kp->schedIDX());
+    }
+
+    // Recompute the group sums from the kproc rates, rebuild the sum
+    // trees and A0.
+    void _recomputeSum(void);
+
+    // Set the sum of a group to the sum of its member rates.
+    void _sumGroup(CRGroup * group);
 
     inline void _updateSum(void) {
         #ifdef SSA_DEBUG
         std::cout << "update A0 from " << pA0 << " to ";
         #endif
 
-        pA0 = 0.0;
-
-        uint n_neg_groups = nGroups.size();
-        uint n_pos_groups = pGroups.size();
-
-        for (uint i = 0; i < n_neg_groups; i++) {
-            pA0 += nGroups[i]->sum;
+        pCRUpdates++;
+        if (pCRRecompute != 0 && pCRUpdates >= pCRRecompute) {
+            _recomputeSum();
         }
-
-        for (uint i = 0; i < n_pos_groups; i++) {
-            pA0 += pGroups[i]->sum;
+        else {
+            pA0 = nTree.total() + pTree.total();
+            if (pA0 < 0.0) _recomputeSum();
         }
 
         #ifdef SSA_DEBUG
@@ -730,6 +914,8 @@ private:
         #endif
     }
 
+    // Draw a kproc from a non-empty group by rejection.
+    KProc * _selectInGroup(CRGroup * group) const;
 
     ////////////////////////// ADDED FOR EFIELD ////////////////////////////
 
@@ -777,6 +963,37 @@ private:
     // Table of EField local triangle index to global triangle index.
     uint                                      * pEFTri_LtoG;
 
+    // Schedule indices of the voltage-dependent kprocs of each EField
+    // triangle; those of local triangle i are stored in
+    // [pEFTri_VDepOffsets[i], pEFTri_VDepOffsets[i+1]).
+    std::vector<uint>                           pEFTri_VDepOffsets;
+    std::vector<SchedIDX>                       pEFTri_VDepKProcs;
+
+    // Voltage of each EField triangle when the rates of its
+    // voltage-dependent kprocs were last recomputed (NaN if never).
+    std::vector<double>                         pEFTri_VRefresh;
+
+    // Tolerance for the refresh of voltage-dependent kprocs.
+    double                                      pEFVTol;
+
+    // Whether the next EField step updates all kprocs rather than only
+    // the voltage-dependent ones.
+    bool                                        pEFFullUpdate;
+
+    ////////////////////////////////////////////////////////////////////////
+
+    // Spatial domains of a parallel run, or 0 if running serially.
+    DomainSet                                 * pDomainSet;
+
+    // Event profile, or 0 if profiling is off.
+    steps::solver::KProcProfile               * pProfile;
+
+    // Leap selection of the tau-leaping mode and whether it is used.
+    TauLeap                                   * pTauLeap;
+    bool                                        pTauLeaping;
+    ulong                                       pNLeapedEvents;
+    ulong                                       pNExactEvents;
+
 
 };
 
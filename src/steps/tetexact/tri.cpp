@@ -45,6 +45,7 @@
 #include "steps/tetexact/tet.hpp"
 #include "steps/tetexact/tri.hpp"
 #include "steps/tetexact/kproc.hpp"
+#include "steps/tetexact/kprocstore.hpp"
 #include "steps/tetexact/tetexact.hpp"
 #include "steps/math/constants.hpp"
 
@@ -134,9 +135,7 @@ stex::Tri::~Tri(void)
     delete[] pOCchan_timeintg;
     delete[] pOCtime_upd;
 
-    KProcPVecCI e = pKProcs.end();
-    for (std::vector<stex::KProc *>::const_iterator i = pKProcs.begin();
-         i != e; ++i) delete *i;
+    // The kprocs belong to the solver's kproc store.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -181,6 +180,44 @@ void stex::Tri::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::Tri::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    uint nspecs = patchdef()->countSpecs();
+    cols.counts.insert(cols.counts.end(), pPoolCount, pPoolCount + nspecs);
+    cols.flags.insert(cols.flags.end(), pPoolFlags, pPoolFlags + nspecs);
+
+    uint nghkcurrs = pPatchdef->countGHKcurrs();
+    cols.ints.insert(cols.ints.end(), pECharge, pECharge + nghkcurrs);
+    cols.ints.insert(cols.ints.end(), pECharge_last, pECharge_last + nghkcurrs);
+
+    uint nohmcurrs = pPatchdef->countOhmicCurrs();
+    cols.reals.insert(cols.reals.end(), pOCchan_timeintg, pOCchan_timeintg + nohmcurrs);
+    cols.reals.insert(cols.reals.end(), pOCtime_upd, pOCtime_upd + nohmcurrs);
+
+    for (uint i = 0; i < 3; ++i) cols.ints.push_back(pSDiffBndDirection[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::Tri::restoreColumns(steps::solver::CPCursor & cur)
+{
+    uint nspecs = patchdef()->countSpecs();
+    cur.counts(pPoolCount, nspecs);
+    cur.flags(pPoolFlags, nspecs);
+
+    uint nghkcurrs = pPatchdef->countGHKcurrs();
+    cur.ints(pECharge, nghkcurrs);
+    cur.ints(pECharge_last, nghkcurrs);
+
+    uint nohmcurrs = pPatchdef->countOhmicCurrs();
+    cur.reals(pOCchan_timeintg, nohmcurrs);
+    cur.reals(pOCtime_upd, nohmcurrs);
+
+    for (uint i = 0; i < 3; ++i) pSDiffBndDirection[i] = cur.integer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void stex::Tri::setInnerTet(stex::WmVol * t)
 {
     pInnerTet = t;
@@ -226,20 +263,20 @@ void stex::Tri::setupKProcs(stex::Tetexact * tex, bool efield)
     for (uint i=0; i < nsreacs; ++i)
     {
         ssolver::SReacdef * srdef = patchdef()->sreacdef(i);
-        stex::SReac * sr = new SReac(srdef, this);
+        stex::SReac * sr = tex->kprocStore().create<stex::SReac>(srdef, this);
         assert(sr != 0);
         pKProcs[j++] = sr;
-        tex->addKProc(sr);
+        tex->addKProc(sr, stex::SReac::KIND);
     }
 
     uint nsdiffs = patchdef()->countSurfDiffs();
     for (uint i=0; i < nsdiffs; ++i)
     {
         ssolver::Diffdef * sddef = patchdef()->surfdiffdef(i);
-        stex::SDiff * sd = new SDiff(sddef, this);
+        stex::SDiff * sd = tex->kprocStore().create<stex::SDiff>(sddef, this);
         assert(sd != 0);
         pKProcs[j++] = sd;
-        tex->addKProc(sd);
+        tex->addKProc(sd, stex::SDiff::KIND);
     }
 
 
@@ -249,30 +286,30 @@ void stex::Tri::setupKProcs(stex::Tetexact * tex, bool efield)
         for (uint i=0; i < nvdtrans; ++i)
         {
             ssolver::VDepTransdef * vdtdef = patchdef()->vdeptransdef(i);
-            stex::VDepTrans * vdt = new VDepTrans(vdtdef, this);
+            stex::VDepTrans * vdt = tex->kprocStore().create<stex::VDepTrans>(vdtdef, this);
             assert(vdt != 0);
             pKProcs[j++] = vdt;
-            tex->addKProc(vdt);
+            tex->addKProc(vdt, stex::VDepTrans::KIND);
         }
 
         uint nvdsreacs = patchdef()->countVDepSReacs();
         for (uint i=0; i < nvdsreacs; ++i)
         {
             ssolver::VDepSReacdef * vdsrdef = patchdef()->vdepsreacdef(i);
-            stex::VDepSReac * vdsr = new VDepSReac(vdsrdef, this);
+            stex::VDepSReac * vdsr = tex->kprocStore().create<stex::VDepSReac>(vdsrdef, this);
             assert(vdsr != 0);
             pKProcs[j++] = vdsr;
-            tex->addKProc(vdsr);
+            tex->addKProc(vdsr, stex::VDepSReac::KIND);
         }
 
         uint nghkcurrs = patchdef()->countGHKcurrs();
         for (uint i=0; i < nghkcurrs; ++i)
         {
             ssolver::GHKcurrdef * ghkdef = patchdef()->ghkcurrdef(i);
-            stex::GHKcurr * ghk = new GHKcurr(ghkdef, this);
+            stex::GHKcurr * ghk = tex->kprocStore().create<stex::GHKcurr>(ghkdef, this);
             assert(ghk != 0);
             pKProcs[j++] = ghk;
-            tex->addKProc(ghk);
+            tex->addKProc(ghk, stex::GHKcurr::KIND);
         }
     }
 }
@@ -49,7 +49,6 @@ stex::VDepSReac::VDepSReac(ssolver::VDepSReacdef * vdsrdef, stex::Tri * tri)
 : KProc()
 , pVDepSReacdef(vdsrdef)
 , pTri(tri)
-, pUpdVec()
 , pScaleFactor(0.0)
 {
     assert (pVDepSReacdef != 0);
@@ -101,11 +100,6 @@ void stex::VDepSReac::checkpoint(std::fstream & cp_file)
     cp_file.write((char*)&pFlags, sizeof(uint));
 
     cp_file.write((char*)&pScaleFactor, sizeof(double));
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -116,29 +110,35 @@ void stex::VDepSReac::restore(std::fstream & cp_file)
     cp_file.read((char*)&pFlags, sizeof(uint));
 
     cp_file.read((char*)&pScaleFactor, sizeof(double));
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
+void stex::VDepSReac::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    KProc::checkpointColumns(cols);
+    cols.reals.push_back(pScaleFactor);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::VDepSReac::reset(void)
+void stex::VDepSReac::restoreColumns(steps::solver::CPCursor & cur)
 {
+    KProc::restoreColumns(cur);
+    pScaleFactor = cur.real();
+}
 
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::VDepSReac::reset(void)
+{
     resetExtent();
     setActive(true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::VDepSReac::setupDeps(void)
+void stex::VDepSReac::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
     // For all non-zero entries gidx in SReacDef's UPD_S:
     //   Perform depSpecTri(gidx,tri()) for:
@@ -155,9 +155,8 @@ void stex::VDepSReac::setupDeps(void)
     // If outer tetrahedron exists:
     //   Similar to inner tet.
     //
-    // All dependencies are first collected into a std::set, to sort them
-    // and to eliminate duplicates. At the end of the routine, they are
-    // copied into the vector that will be returned during execution.
+    // All dependencies are collected into a single row; sorting and
+    // removal of duplicates is left to the solver's dependency graph.
 
     WmVol * itet = pTri->iTet();
     WmVol * otet = pTri->oTet();
@@ -169,7 +168,8 @@ void stex::VDepSReac::setupDeps(void)
     ssolver::gidxTVecCI o_beg = pVDepSReacdef->beginUpdColl_O();
     ssolver::gidxTVecCI o_end = pVDepSReacdef->endUpdColl_O();
 
-    std::set<stex::KProc*> updset;
+    upd_rows.assign(1, SchedIDXVec());
+    SchedIDXVec & updset = upd_rows[0];
 
     KProcPVecCI kprocend = pTri->kprocEnd();
     for (KProcPVecCI k = pTri->kprocBegin(); k != kprocend; ++k)
@@ -177,7 +177,7 @@ void stex::VDepSReac::setupDeps(void)
         for (ssolver::gidxTVecCI spec = s_beg; spec != s_end; ++spec)
         {
             if ((*k)->depSpecTri(*spec, pTri) == true)
-                updset.insert(*k);
+                updset.push_back((*k)->schedIDX());
         }
     }
 
@@ -189,7 +189,7 @@ void stex::VDepSReac::setupDeps(void)
             for (ssolver::gidxTVecCI spec = i_beg; spec != i_end; ++spec)
             {
                 if ((*k)->depSpecTet(*spec, itet) == true)
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
             }
         }
 
@@ -206,7 +206,7 @@ void stex::VDepSReac::setupDeps(void)
                 for (ssolver::gidxTVecCI spec = i_beg; spec != i_end; ++spec)
                 {
                     if ((*k)->depSpecTet(*spec, itet) == true)
-                        updset.insert(*k);
+                        updset.push_back((*k)->schedIDX());
                 }
             }
         }
@@ -220,7 +220,7 @@ void stex::VDepSReac::setupDeps(void)
             for (ssolver::gidxTVecCI spec = o_beg; spec != o_end; ++spec)
             {
                 if ((*k)->depSpecTet(*spec, otet) == true)
-                    updset.insert(*k);
+                    updset.push_back((*k)->schedIDX());
             }
         }
 
@@ -238,13 +238,11 @@ void stex::VDepSReac::setupDeps(void)
                 for (ssolver::gidxTVecCI spec = o_beg; spec != o_end; ++spec)
                 {
                     if ((*k)->depSpecTet(*spec, otet) == true)
-                        updset.insert(*k);
+                        updset.push_back((*k)->schedIDX());
                 }
             }
         }
     }
-
-    pUpdVec.assign(updset.begin(), updset.end());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -294,14 +292,11 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
 
         double h_mu = 1.0;
 
-        uint * lhs_s_vec = pdef->vdepsreac_lhs_S_bgn(lidx);
         uint * cnt_s_vec = pTri->pools();
-        uint nspecs_s = pdef->countSpecs();
-        for (uint s = 0; s < nspecs_s; ++s)
+        for (auto const & e: pdef->vdepsreac_lhs_S_sparse(lidx))
         {
-            uint lhs = lhs_s_vec[s];
-            if (lhs == 0) continue;
-            uint cnt = cnt_s_vec[s];
+            uint lhs = e.coef;
+            uint cnt = cnt_s_vec[e.idx];
             if (lhs > cnt)
             {
                 return 0.0;
@@ -312,14 +307,17 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -335,14 +333,11 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
 
         if (pVDepSReacdef->inside())
         {
-            uint * lhs_i_vec = pdef->vdepsreac_lhs_I_bgn(lidx);
             uint * cnt_i_vec = pTri->iTet()->pools();
-            uint nspecs_i = pdef->countSpecs_I();
-            for (uint s = 0; s < nspecs_i; ++s)
+            for (auto const & e: pdef->vdepsreac_lhs_I_sparse(lidx))
             {
-                uint lhs = lhs_i_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_i_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_i_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -353,14 +348,17 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -376,14 +374,11 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
         }
         else if (pVDepSReacdef->outside())
         {
-            uint * lhs_o_vec = pdef->vdepsreac_lhs_O_bgn(lidx);
             uint * cnt_o_vec = pTri->oTet()->pools();
-            uint nspecs_o = pdef->countSpecs_O();
-            for (uint s = 0; s < nspecs_o; ++s)
+            for (auto const & e: pdef->vdepsreac_lhs_O_sparse(lidx))
             {
-                uint lhs = lhs_o_vec[s];
-                if (lhs == 0) continue;
-                uint cnt = cnt_o_vec[s];
+                uint lhs = e.coef;
+                uint cnt = cnt_o_vec[e.idx];
                 if (lhs > cnt)
                 {
                     return 0.0;
@@ -394,14 +389,17 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
                     {
                         h_mu *= static_cast<double>(cnt - 3);
                     }
+                    // fall through
                     case 3:
                     {
                         h_mu *= static_cast<double>(cnt - 2);
                     }
+                    // fall through
                     case 2:
                     {
                         h_mu *= static_cast<double>(cnt - 1);
                     }
+                    // fall through
                     case 1:
                     {
                         h_mu *= static_cast<double>(cnt);
@@ -425,7 +423,7 @@ double stex::VDepSReac::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::VDepSReac::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::VDepSReac::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     // NOTE: simtime is BEFORE the update has taken place
 
@@ -454,32 +452,25 @@ std::vector<stex::KProc*> const & stex::VDepSReac::apply(steps::rng::RNG * rng,
     }
 
     // Update triangle pools.
-    uint nspecs_s = pdef->countSpecs();
-    for (uint s = 0; s < nspecs_s; ++s)
+    for (auto const & e: pdef->vdepsreac_upd_S_sparse(lidx))
     {
-        if (pTri->clamped(s) == true) continue;
-        int upd = upd_s_vec[s];
-        if (upd == 0) continue;
-        int nc = static_cast<int>(cnt_s_vec[s]) + upd;
+        if (pTri->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(cnt_s_vec[e.idx]) + e.coef;
         assert(nc >= 0);
-        pTri->setCount(s, static_cast<uint>(nc));
+        pTri->setCount(e.idx, static_cast<uint>(nc));
     }
 
     // Update inner tet pools.
     stex::WmVol * itet = pTri->iTet();
     if (itet != 0)
     {
-        int * upd_i_vec = pdef->vdepsreac_upd_I_bgn(lidx);
         uint * cnt_i_vec = itet->pools();
-        uint nspecs_i = pdef->countSpecs_I();
-        for (uint s = 0; s < nspecs_i; ++s)
+        for (auto const & e: pdef->vdepsreac_upd_I_sparse(lidx))
         {
-            if (itet->clamped(s) == true) continue;
-            int upd = upd_i_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_i_vec[s]) + upd;
+            if (itet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_i_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            itet->setCount(s, static_cast<uint>(nc));
+            itet->setCount(e.idx, static_cast<uint>(nc));
         }
     }
 
@@ -487,23 +478,19 @@ std::vector<stex::KProc*> const & stex::VDepSReac::apply(steps::rng::RNG * rng,
     stex::WmVol * otet = pTri->oTet();
     if (otet != 0)
     {
-        int * upd_o_vec = pdef->vdepsreac_upd_O_bgn(lidx);
         uint * cnt_o_vec = otet->pools();
-        uint nspecs_o = pdef->countSpecs_O();
-        for (uint s = 0; s < nspecs_o; ++s)
+        for (auto const & e: pdef->vdepsreac_upd_O_sparse(lidx))
         {
-            if (otet->clamped(s) == true) continue;
-            int upd = upd_o_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_o_vec[s]) + upd;
+            if (otet->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_o_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            otet->setCount(s, static_cast<uint>(nc));
+            otet->setCount(e.idx, static_cast<uint>(nc));
         }
     }
 
     rExtent++;
 
-    return pUpdVec;
+    return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +68,8 @@ public:
     VDepSReac(steps::solver::VDepSReacdef * vdsrdef, steps::tetexact::Tri * tri);
     ~VDepSReac(void);
 
+    static const KProcKind KIND = KP_VDEPSREAC;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -77,20 +79,23 @@ public:
     /// restore data
     void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
     void reset(void);
 
     double rate(steps::tetexact::Tetexact * solver = 0);
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt, double simtime);
-
-    uint updVecSize(void) const
-    { return pUpdVec.size(); }
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -100,7 +105,6 @@ private:
 
     steps::solver::VDepSReacdef       * pVDepSReacdef;
     steps::tetexact::Tri              * pTri;
-    std::vector<KProc*>                   pUpdVec;
 
     // The information about the size of the comaprtment or patch, and the
     // dimensions. Important for scaling the constant.
@@ -48,7 +48,6 @@ stex::VDepTrans::VDepTrans(ssolver::VDepTransdef * vdtdef, stex::Tri * tri)
 : KProc()
 , pVDepTransdef(vdtdef)
 , pTri(tri)
-, pUpdVec()
 {
     assert (pVDepTransdef != 0);
     assert (pTri != 0);
@@ -66,11 +65,6 @@ void stex::VDepTrans::checkpoint(std::fstream & cp_file)
 {
     cp_file.write((char*)&rExtent, sizeof(uint));
     cp_file.write((char*)&pFlags, sizeof(uint));
-
-    cp_file.write((char*)&(crData.recorded), sizeof(bool));
-    cp_file.write((char*)&(crData.pow), sizeof(int));
-    cp_file.write((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.write((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -79,42 +73,31 @@ void stex::VDepTrans::restore(std::fstream & cp_file)
 {
     cp_file.read((char*)&rExtent, sizeof(uint));
     cp_file.read((char*)&pFlags, sizeof(uint));
-
-    cp_file.read((char*)&(crData.recorded), sizeof(bool));
-    cp_file.read((char*)&(crData.pow), sizeof(int));
-    cp_file.read((char*)&(crData.pos), sizeof(unsigned));
-    cp_file.read((char*)&(crData.rate), sizeof(double));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void stex::VDepTrans::reset(void)
 {
-
-    crData.recorded = false;
-    crData.pow = 0;
-    crData.pos = 0;
-    crData.rate = 0.0;
     setActive(true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void stex::VDepTrans::setupDeps(void)
+void stex::VDepTrans::setupDeps(std::vector<SchedIDXVec> & upd_rows)
 {
-    std::set<stex::KProc*> updset;
+    upd_rows.assign(1, SchedIDXVec());
+    SchedIDXVec & updset = upd_rows[0];
 
     KProcPVecCI kprocend = pTri->kprocEnd();
     for (KProcPVecCI k = pTri->kprocBegin(); k != kprocend; ++k)
     {
         if ((*k)->depSpecTri(pVDepTransdef->srcchanstate(), pTri) == true)
-            updset.insert(*k);
+            updset.push_back((*k)->schedIDX());
         if ((*k)->depSpecTri(pVDepTransdef->dstchanstate(), pTri) == true)
-            updset.insert(*k);
+            updset.push_back((*k)->schedIDX());
     }
 
-    pUpdVec.assign(updset.begin(), updset.end());
-
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -150,7 +133,7 @@ double stex::VDepTrans::rate(steps::tetexact::Tetexact * solver)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-std::vector<stex::KProc*> const & stex::VDepTrans::apply(steps::rng::RNG * rng, double dt, double simtime)
+uint stex::VDepTrans::apply(steps::rng::RNG * rng, double dt, double simtime)
 {
     ssolver::Patchdef * pdef = pTri->patchdef();
     uint lidx = pdef->vdeptransG2L(pVDepTransdef->gidx());
@@ -190,7 +173,7 @@ std::vector<stex::KProc*> const & stex::VDepTrans::apply(steps::rng::RNG * rng,
 
     rExtent++;
 
-    return pUpdVec;
+    return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +68,8 @@ public:
     VDepTrans(steps::solver::VDepTransdef * vdtdef, steps::tetexact::Tri * tri);
     ~VDepTrans(void);
 
+    static const KProcKind KIND = KP_VDEPTRANS;
+
     ////////////////////////////////////////////////////////////////////////
     // CHECKPOINTING
     ////////////////////////////////////////////////////////////////////////
@@ -81,17 +83,14 @@ public:
     // VIRTUAL INTERFACE METHODS
     ////////////////////////////////////////////////////////////////////////
 
-    void setupDeps(void);
+    void setupDeps(std::vector<SchedIDXVec> & upd_rows);
     bool depSpecTet(uint gidx, steps::tetexact::WmVol * tet);
     bool depSpecTri(uint gidx, steps::tetexact::Tri * tri);
     void reset(void);
 
     double rate(steps::tetexact::Tetexact * solver);
 
-    std::vector<KProc*> const & apply(steps::rng::RNG * rng, double dt,double simtime);
-
-    uint updVecSize(void) const
-    { return pUpdVec.size(); }
+    uint apply(steps::rng::RNG * rng, double dt, double simtime);
 
     ////////////////////////////////////////////////////////////////////////
 
@@ -101,7 +100,6 @@ private:
 
     steps::solver::VDepTransdef       * pVDepTransdef;
     steps::tetexact::Tri              * pTri;
-    std::vector<KProc*>                 pUpdVec;
 
     ////////////////////////////////////////////////////////////////////////
 
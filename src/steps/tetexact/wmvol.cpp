@@ -43,6 +43,7 @@
 #include "steps/tetexact/tet.hpp"
 #include "steps/tetexact/tri.hpp"
 #include "steps/tetexact/kproc.hpp"
+#include "steps/tetexact/kprocstore.hpp"
 #include "steps/tetexact/tetexact.hpp"
 #include "steps/tetexact/wmvol.hpp"
 
@@ -86,9 +87,7 @@ stex::WmVol::~WmVol(void)
     delete[] pPoolCount;
     delete[] pPoolFlags;
 
-    // Delete reaction rules.
-    KProcPVecCI e = pKProcs.end();
-    for (KProcPVecCI i = pKProcs.begin(); i != e; ++i) delete *i;
+    // The reaction rules belong to the solver's kproc store.
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -111,6 +110,24 @@ void stex::WmVol::restore(std::fstream & cp_file)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stex::WmVol::checkpointColumns(steps::solver::CPColumns & cols) const
+{
+    uint nspecs = compdef()->countSpecs();
+    cols.counts.insert(cols.counts.end(), pPoolCount, pPoolCount + nspecs);
+    cols.flags.insert(cols.flags.end(), pPoolFlags, pPoolFlags + nspecs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stex::WmVol::restoreColumns(steps::solver::CPCursor & cur)
+{
+    uint nspecs = compdef()->countSpecs();
+    cur.counts(pPoolCount, nspecs);
+    cur.flags(pPoolFlags, nspecs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void stex::WmVol::setNextTri(stex::Tri * t)
 {
     pNextTris.push_back(t);
@@ -130,9 +147,9 @@ void stex::WmVol::setupKProcs(stex::Tetexact * tex)
     for (uint i = 0; i < nreacs; ++i)
     {
         ssolver::Reacdef * rdef = compdef()->reacdef(i);
-        stex::Reac * r = new stex::Reac(rdef, this);
+        stex::Reac * r = tex->kprocStore().create<stex::Reac>(rdef, this);
         pKProcs[j++] = r;
-        tex->addKProc(r);
+        tex->addKProc(r, stex::Reac::KIND);
     }
 
 }
@@ -36,6 +36,7 @@
 // STEPS headers.
 #include "steps/common.h"
 #include "steps/solver/compdef.hpp"
+#include "steps/solver/cpfile.hpp"
 #include "steps/tetexact/kproc.hpp"
 #include "steps/solver/types.hpp"
 
@@ -94,6 +95,12 @@ public:
     /// restore data
     virtual void restore(std::fstream & cp_file);
 
+    /// checkpoint data into the columns of a binary checkpoint
+    virtual void checkpointColumns(steps::solver::CPColumns & cols) const;
+
+    /// restore data from the columns of a binary checkpoint
+    virtual void restoreColumns(steps::solver::CPCursor & cur);
+
     ////////////////////////////////////////////////////////////////////////
     // SETUP
     ////////////////////////////////////////////////////////////////////////
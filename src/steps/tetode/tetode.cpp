@@ -25,6 +25,7 @@
  */
 
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <cmath>
@@ -60,6 +61,8 @@
 
 #include "steps/solver/efield/efield.hpp"
 #include "steps/solver/efield/dVsolver.hpp"
+#include "steps/solver/efield/dVsolver_pcg.hpp"
+#include "steps/solver/efield/dVsolver_condensed.hpp"
 
 // CVODE definitions
 #define Ith(v,i)    NV_Ith_S(v,i)
@@ -1466,6 +1469,12 @@ void stode::TetODE::_setupEField(void)
     case EF_DV_BDSYS:
         pEField = make_EField<dVSolverBanded>();
         break;
+    case EF_DV_PCG:
+        pEField = make_EField<dVSolverPCG>();
+        break;
+    case EF_DV_CONDENSED:
+        pEField = make_EField<dVSolverCondensed>();
+        break;
     default:
         throw steps::ArgErr("Unsupported E-Field solver.");
     }
@@ -1715,6 +1724,18 @@ void stode::TetODE::run(double endtime)
 
     if (endtime == 0.0) return;
 
+    if (efflag() == true && pEField->getAdaptive() == true)
+    {
+        while (statedef()->time() < endtime)
+            _run(std::min(statedef()->time() + pEField->getNextDT(), endtime));
+    }
+    else _run(endtime);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void stode::TetODE::_run(double endtime)
+{
     int flag = 0;
 
     if (not pInitialised)
@@ -1967,6 +1988,58 @@ void stode::TetODE::run(double endtime)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void stode::TetODE::setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol)
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    pEField->setAdaptive(adaptive, dtmin, dtmax, errtol);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool stode::TetODE::getEfieldAdaptive(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getAdaptive();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stode::TetODE::getEfieldNStepsWithinTolerance(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getNStepsWithinTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ulong stode::TetODE::getEfieldNStepsOverTolerance(void) const
+{
+    if (efflag() != true)
+    {
+        std::ostringstream os;
+        os << "Method not available: EField calculation not included in simulation.";
+        throw steps::ArgErr(os.str());
+    }
+    return pEField->getNStepsOverTolerance();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double stode::TetODE::_getCompVol(uint cidx) const
 {
     assert(cidx < statedef()->countComps());
@@ -389,6 +389,9 @@ public:
 
     void _setupEField(void);
 
+    /// Advance CVODE, then the EField, to endtime.
+    void _run(double endtime);
+
     inline uint neftets(void) const
     { return pEFNTets; }
 
@@ -398,6 +401,22 @@ public:
     inline uint nefverts(void) const
     { return pEFNVerts; }
 
+    /// Switch adaptive EField stepping on or off. When on, the EField step
+    /// varies between dtmin and dtmax (seconds) to keep its estimated local
+    /// error in the membrane potential within errtol (volts), and run()
+    /// advances CVODE and the EField in turn over each step rather than
+    /// over the whole interval.
+    void setEfieldAdaptive(bool adaptive, double dtmin, double dtmax, double errtol);
+
+    bool getEfieldAdaptive(void) const;
+
+    /// Return the numbers of adaptive EField steps within the error
+    /// tolerance, and over it, since adaptive stepping was switched on.
+    /// Adaptive stepping only controls the step length: steps over the
+    /// tolerance are kept and the steps after them shortened.
+    ulong getEfieldNStepsWithinTolerance(void) const;
+    ulong getEfieldNStepsOverTolerance(void) const;
+
 
 private:
 
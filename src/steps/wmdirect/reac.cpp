@@ -193,17 +193,14 @@ double swmd::Reac::rate(void) const
 
     // Prefetch some variables.
     ssolver::Compdef * cdef = pComp->def();
-    uint nspecs = cdef->countSpecs();
-    uint * lhs_vec = cdef->reac_lhs_bgn(cdef->reacG2L(defr()->gidx()));
     double * cnt_vec = cdef->pools();
 
     // Compute combinatorial part.
         double h_mu = 1.0;
-        for (uint pool = 0; pool < nspecs; ++pool)
+        for (auto const & e: cdef->reac_lhs_sparse(cdef->reacG2L(defr()->gidx())))
         {
-            uint lhs = lhs_vec[pool];
-            if (lhs == 0) continue;
-            uint cnt = static_cast<uint>(cnt_vec[pool]);
+            uint lhs = e.coef;
+            uint cnt = static_cast<uint>(cnt_vec[e.idx]);
             if (lhs > cnt)
             {
                 h_mu = 0.0;
@@ -215,14 +212,17 @@ double swmd::Reac::rate(void) const
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -248,15 +248,11 @@ std::vector<uint> const & swmd::Reac::apply(void)
     ssolver::Compdef * cdef = pComp->def();
     double * local = cdef->pools();
     uint l_ridx = cdef->reacG2L(defr()->gidx());
-    int * upd_vec = cdef->reac_upd_bgn(l_ridx);
-    uint nspecs = cdef->countSpecs();
-    for (uint i=0; i < nspecs; ++i)
+    for (auto const & e: cdef->reac_upd_sparse(l_ridx))
     {
-        if (cdef->clamped(i) == true) continue;
-        int j = upd_vec[i];
-        if (j == 0) continue;
-        int nc = static_cast<int>(local[i]) + j;
-        cdef->setCount(i, static_cast<double>(nc));
+        if (cdef->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(local[e.idx]) + e.coef;
+        cdef->setCount(e.idx, static_cast<double>(nc));
     }
     rExtent++;
     return pUpdVec;
@@ -331,14 +331,11 @@ double swmd::SReac::rate(void) const
 
     double h_mu = 1.0;
 
-    uint * lhs_s_vec = pdef->sreac_lhs_S_bgn(lidx);
     double * cnt_s_vec = pdef->pools();
-    uint nspecs_s = pdef->countSpecs();
-    for (uint s = 0; s < nspecs_s; ++s)
+    for (auto const & e: pdef->sreac_lhs_S_sparse(lidx))
     {
-        uint lhs = lhs_s_vec[s];
-        if (lhs == 0) continue;
-        uint cnt = static_cast<uint>(cnt_s_vec[s]);
+        uint lhs = e.coef;
+        uint cnt = static_cast<uint>(cnt_s_vec[e.idx]);
         if (lhs > cnt)
         {
             return 0.0;
@@ -349,14 +346,17 @@ double swmd::SReac::rate(void) const
             {
                 h_mu *= static_cast<double>(cnt - 3);
             }
+            // fall through
             case 3:
             {
                 h_mu *= static_cast<double>(cnt - 2);
             }
+            // fall through
             case 2:
             {
                 h_mu *= static_cast<double>(cnt - 1);
             }
+            // fall through
             case 1:
             {
                 h_mu *= static_cast<double>(cnt);
@@ -372,14 +372,11 @@ double swmd::SReac::rate(void) const
 
     if (defsr()->inside())
     {
-        uint * lhs_i_vec = pdef->sreac_lhs_I_bgn(lidx);
         double * cnt_i_vec = pPatch->iComp()->def()->pools();
-        uint nspecs_i = pdef->countSpecs_I();
-        for (uint s = 0; s < nspecs_i; ++s)
+        for (auto const & e: pdef->sreac_lhs_I_sparse(lidx))
         {
-            uint lhs = lhs_i_vec[s];
-            if (lhs == 0) continue;
-            uint cnt = static_cast<double>(cnt_i_vec[s]);
+            uint lhs = e.coef;
+            uint cnt = static_cast<double>(cnt_i_vec[e.idx]);
             if (lhs > cnt)
             {
                 return 0.0;
@@ -390,14 +387,17 @@ double swmd::SReac::rate(void) const
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -413,14 +413,11 @@ double swmd::SReac::rate(void) const
     }
     else if (defsr()->outside())
     {
-        uint * lhs_o_vec = pdef->sreac_lhs_O_bgn(lidx);
         double * cnt_o_vec = pPatch->oComp()->def()->pools();
-        uint nspecs_o = pdef->countSpecs_O();
-        for (uint s = 0; s < nspecs_o; ++s)
+        for (auto const & e: pdef->sreac_lhs_O_sparse(lidx))
         {
-            uint lhs = lhs_o_vec[s];
-            if (lhs == 0) continue;
-            uint cnt = static_cast<double>(cnt_o_vec[s]);
+            uint lhs = e.coef;
+            uint cnt = static_cast<double>(cnt_o_vec[e.idx]);
             if (lhs > cnt)
             {
                 return 0.0;
@@ -431,14 +428,17 @@ double swmd::SReac::rate(void) const
                 {
                     h_mu *= static_cast<double>(cnt - 3);
                 }
+                // fall through
                 case 3:
                 {
                     h_mu *= static_cast<double>(cnt - 2);
                 }
+                // fall through
                 case 2:
                 {
                     h_mu *= static_cast<double>(cnt - 1);
                 }
+                // fall through
                 case 1:
                 {
                     h_mu *= static_cast<double>(cnt);
@@ -464,35 +464,26 @@ std::vector<uint> const & swmd::SReac::apply(void)
     uint lidx = pdef->sreacG2L(defsr()->gidx());
 
     // Update patch pools.
-    int * upd_s_vec = pdef->sreac_upd_S_bgn(lidx);
     double * cnt_s_vec = pdef->pools();
-    uint nspecs_s = pdef->countSpecs();
-
-    for (uint s = 0; s < nspecs_s; ++s)
+    for (auto const & e: pdef->sreac_upd_S_sparse(lidx))
     {
-        if (pdef->clamped(s) == true) continue;
-        int upd = upd_s_vec[s];
-        if (upd == 0) continue;
-        int nc = static_cast<int>(cnt_s_vec[s]) + upd;
+        if (pdef->clamped(e.idx) == true) continue;
+        int nc = static_cast<int>(cnt_s_vec[e.idx]) + e.coef;
         assert(nc >= 0);
-        pdef->setCount(s, static_cast<double>(nc));
+        pdef->setCount(e.idx, static_cast<double>(nc));
     }
 
     // Update inner comp pools.
     Comp * icomp = pPatch->iComp();
     if (icomp != 0)
     {
-        int * upd_i_vec = pdef->sreac_upd_I_bgn(lidx);
         double * cnt_i_vec = icomp->def()->pools();
-        uint nspecs_i = pdef->countSpecs_I();
-        for (uint s = 0; s < nspecs_i; ++s)
+        for (auto const & e: pdef->sreac_upd_I_sparse(lidx))
         {
-            if (icomp->def()->clamped(s) == true) continue;
-            int upd = upd_i_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_i_vec[s]) + upd;
+            if (icomp->def()->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_i_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            icomp->def()->setCount(s, static_cast<double>(nc));
+            icomp->def()->setCount(e.idx, static_cast<double>(nc));
         }
     }
 
@@ -500,17 +491,13 @@ std::vector<uint> const & swmd::SReac::apply(void)
     Comp * ocomp = pPatch->oComp();
     if (ocomp != 0)
     {
-        int * upd_o_vec = pdef->sreac_upd_O_bgn(lidx);
         double * cnt_o_vec = ocomp->def()->pools();
-        uint nspecs_o = pdef->countSpecs_O();
-        for (uint s = 0; s < nspecs_o; ++s)
+        for (auto const & e: pdef->sreac_upd_O_sparse(lidx))
         {
-            if (ocomp->def()->clamped(s) == true) continue;
-            int upd = upd_o_vec[s];
-            if (upd == 0) continue;
-            int nc = static_cast<int>(cnt_o_vec[s]) + upd;
+            if (ocomp->def()->clamped(e.idx) == true) continue;
+            int nc = static_cast<int>(cnt_o_vec[e.idx]) + e.coef;
             assert(nc >= 0);
-            ocomp->def()->setCount(s, static_cast<double>(nc));
+            ocomp->def()->setCount(e.idx, static_cast<double>(nc));
         }
     }
 
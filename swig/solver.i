@@ -57,6 +57,9 @@ fwd_api_enum(EF_DEFAULT)
 fwd_api_enum(EF_DV_BDSYS)
 fwd_api_enum(EF_DV_SLUSYS)
 fwd_api_enum(EF_DV_PETSC)
+fwd_api_enum(EF_DV_DIST)
+fwd_api_enum(EF_DV_PCG)
+fwd_api_enum(EF_DV_CONDENSED)
 
 namespace steps
 {
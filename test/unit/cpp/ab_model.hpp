@@ -0,0 +1,77 @@
+#ifndef TEST_AB_MODEL_HPP
+#define TEST_AB_MODEL_HPP
+
+#include <memory>
+#include <vector>
+
+#include "steps/init.hpp"
+#include "steps/geom/tetmesh.hpp"
+#include "steps/geom/tmcomp.hpp"
+#include "steps/model/diff.hpp"
+#include "steps/model/model.hpp"
+#include "steps/model/reac.hpp"
+#include "steps/model/spec.hpp"
+#include "steps/model/volsys.hpp"
+#include "steps/rng/create.hpp"
+
+#define COORDS v_coords
+#define TETINDICES t_indices
+#include "./sample_meshdata.h"
+#undef COORDS
+#undef TETINDICES
+
+#include "./cube_mesh.hpp"
+
+// The model shared by the Tetexact tests: A and B interconverting with
+// fwd 10 and rev 5, and A diffusing with diffA, in one compartment over
+// the whole sample mesh, or a cube mesh, with an mt19937 generator seeded
+// with 23.
+// Species, reactions and patches may be added before a solver is built.
+struct ABModel {
+    std::unique_ptr<steps::model::Model> mdl;
+    std::unique_ptr<steps::tetmesh::Tetmesh> mesh;
+    std::unique_ptr<steps::rng::RNG> r;
+    steps::model::Spec *A;
+    steps::model::Spec *B;
+    steps::model::Volsys *vsys;
+    steps::tetmesh::TmComp *comp;
+
+    ABModel() {
+        const double *vs = &v_coords[0][0];
+        size_t vsN = sizeof(v_coords)/sizeof(*vs);
+        const unsigned int *ts = &t_indices[0][0];
+        size_t tN = sizeof(t_indices)/sizeof(*ts);
+        init(std::vector<double>(vs, vs + vsN), std::vector<unsigned int>(ts, ts + tN));
+    }
+
+    // The same model over a cube mesh instead of the sample mesh.
+    explicit ABModel(CubeMesh const & cube) {
+        init(cube.verts, cube.tets);
+    }
+
+private:
+    void init(std::vector<double> const & verts, std::vector<unsigned int> const & tets) {
+        using namespace steps;
+        steps::init();
+
+        mdl.reset(new model::Model());
+        A = new model::Spec("A", mdl.get());
+        B = new model::Spec("B", mdl.get());
+        vsys = new model::Volsys("vsys", mdl.get());
+        new model::Reac("fwd", vsys, {A}, {B}, 10.0);
+        new model::Reac("rev", vsys, {B}, {A}, 5.0);
+        new model::Diff("diffA", vsys, A, 1.0);
+
+        mesh.reset(new tetmesh::Tetmesh(verts, tets));
+
+        std::vector<uint> comp_tets(mesh->countTets());
+        for (uint t = 0; t < comp_tets.size(); ++t) comp_tets[t] = t;
+        comp = new tetmesh::TmComp("comp", mesh.get(), comp_tets);
+        comp->addVolsys("vsys");
+
+        r.reset(rng::create("mt19937", 512));
+        r->initialize(23);
+    }
+};
+
+#endif // ndef TEST_AB_MODEL_HPP
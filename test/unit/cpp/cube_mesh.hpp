@@ -0,0 +1,69 @@
+#ifndef TEST_CUBE_MESH_HPP
+#define TEST_CUBE_MESH_HPP
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "steps/common.h"
+
+// A cube of n^3 cells of six tetrahedrons each, split around the diagonal
+// from the lowest to the highest corner of each cell. Vertex (i, j, k)
+// lies at (i, j, k) * h. The tets of cell (i, j, k) are 6 * ((i * n + j) * n
+// + k) onwards. With scramble the vertices are numbered at random,
+// otherwise in order of i, j and k.
+struct CubeMesh {
+    explicit CubeMesh(int n, double h = 1.0, bool scramble = false)
+    : n(n)
+    , ids((n + 1) * (n + 1) * (n + 1))
+    , verts()
+    , tets()
+    {
+        for (uint v = 0; v < ids.size(); ++v) ids[v] = v;
+        if (scramble) {
+            std::mt19937 rng(17);
+            std::shuffle(ids.begin(), ids.end(), rng);
+        }
+
+        verts.resize(3 * ids.size());
+        for (int i = 0; i <= n; ++i)
+            for (int j = 0; j <= n; ++j)
+                for (int k = 0; k <= n; ++k) {
+                    uint v = vert(i, j, k);
+                    verts[3 * v] = i * h;
+                    verts[3 * v + 1] = j * h;
+                    verts[3 * v + 2] = k * h;
+                }
+
+        static const int split[6][4] = {
+            {0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6}, {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                for (int k = 0; k < n; ++k) {
+                    uint c[8] = {vert(i, j, k), vert(i + 1, j, k), vert(i + 1, j + 1, k), vert(i, j + 1, k),
+                                 vert(i, j, k + 1), vert(i + 1, j, k + 1), vert(i + 1, j + 1, k + 1), vert(i, j + 1, k + 1)};
+                    for (auto const & t: split)
+                        for (int m = 0; m < 4; ++m) tets.push_back(c[t[m]]);
+                }
+    }
+
+    inline uint vert(int i, int j, int k) const
+    { return ids[(i * (n + 1) + j) * (n + 1) + k]; }
+
+    // The i coordinate of the cell of tet t.
+    inline int tetCellI(uint t) const
+    { return t / (6 * n * n); }
+
+    inline uint countVerts(void) const
+    { return ids.size(); }
+
+    inline uint countTets(void) const
+    { return tets.size() / 4; }
+
+    int n;
+    std::vector<uint> ids;
+    std::vector<double> verts;
+    std::vector<uint> tets;
+};
+
+#endif // ndef TEST_CUBE_MESH_HPP
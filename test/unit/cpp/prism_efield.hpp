@@ -0,0 +1,33 @@
+#ifndef TEST_PRISM_EFIELD_HPP
+#define TEST_PRISM_EFIELD_HPP
+
+#include <vector>
+
+#include "steps/solver/efield/efield.hpp"
+
+#define COORDS prism_coords
+#define TETINDICES prism_tets
+#include "./sample_meshdata.h"
+#undef COORDS
+#undef TETINDICES
+
+// The bottom and top faces of the sample prism as membrane.
+static uint prism_tris[][3] = {
+    {0, 1, 2},
+    {3, 4, 5},
+};
+
+static const uint PRISM_NVERTS = 6;
+
+// Set up the EField on the three tets of the sample prism, ordering the
+// vertices with opt_method.
+static void init_prism(steps::solver::efield::EField & ef, uint opt_method = 1) {
+    // EField takes coordinates in microns.
+    std::vector<double> verts;
+    for (auto const & v: prism_coords)
+        for (double x: v) verts.push_back(x * 10.0);
+
+    ef.initMesh(PRISM_NVERTS, verts.data(), 2, &prism_tris[0][0], 3, &prism_tets[0][0], opt_method);
+}
+
+#endif // ndef TEST_PRISM_EFIELD_HPP
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/sreac.hpp"
+#include "steps/model/surfsys.hpp"
+#include "steps/mpi/tetopsplit/tetopsplit.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// The A/B model with A binding to C on the boundary of a cube of 162
+// tets, under TetOpSplitP with tets dealt round-robin over the ranks and
+// every boundary tri hosted with its tet.
+struct BatchSim: public ABModel {
+    std::vector<uint> tets;
+    std::vector<uint> tris;
+    std::unique_ptr<mpi::tetopsplit::TetOpSplitP> sim;
+
+    BatchSim()
+    : ABModel(CubeMesh(3, 0.1))
+    {
+        model::Spec *C = new model::Spec("C", mdl.get());
+        model::Surfsys *ssys = new model::Surfsys("ssys", mdl.get());
+        new model::SReac("bind", ssys, {}, {A}, {}, {}, {C}, {}, 100.0);
+
+        for (auto t: mesh->getSurfTris()) tris.push_back(t);
+        tetmesh::TmPatch *patch = new tetmesh::TmPatch("patch", mesh.get(), tris, comp);
+        patch->addSurfsys("ssys");
+
+        std::vector<uint> tet_hosts(mesh->countTets());
+        for (uint t = 0; t < tet_hosts.size(); ++t) tet_hosts[t] = t % mpi_size();
+        std::map<uint, uint> tri_hosts;
+        for (uint t: tris) tri_hosts[t] = tet_hosts[mesh->getTriTetNeighb(t)[0]];
+
+        sim.reset(new mpi::tetopsplit::TetOpSplitP(mdl.get(), mesh.get(), r.get(),
+                                                   solver::API::EF_NONE, tet_hosts, tri_hosts));
+
+        // every element, in an order unrelated to the hosts
+        for (uint t = 0; t < mesh->countTets(); ++t) tets.push_back((t * 7) % mesh->countTets());
+        std::reverse(tris.begin(), tris.end());
+
+        sim->setCompCount("comp", "A", 5000);
+        sim->run(1.0e-4);
+    }
+};
+
+TEST(BatchMPI, tetCounts) {
+    BatchSim s;
+    std::vector<double> counts(s.tets.size());
+    s.sim->getBatchTetCountsNP(&s.tets.front(), s.tets.size(), "A", &counts.front(), counts.size());
+    for (uint i = 0; i < s.tets.size(); ++i)
+        ASSERT_EQ(counts[i], s.sim->getTetCount(s.tets[i], "A"));
+
+    for (uint i = 0; i < s.tets.size(); ++i) counts[i] = i % 5;
+    s.sim->setBatchTetCountsNP(&s.tets.front(), s.tets.size(), "B", &counts.front(), counts.size());
+    for (uint i = 0; i < s.tets.size(); ++i)
+        ASSERT_EQ(s.sim->getTetCount(s.tets[i], "B"), counts[i]);
+}
+
+TEST(BatchMPI, triCounts) {
+    BatchSim s;
+    std::vector<double> counts(s.tris.size());
+    s.sim->getBatchTriCountsNP(&s.tris.front(), s.tris.size(), "C", &counts.front(), counts.size());
+    double sum = 0.0;
+    for (uint i = 0; i < s.tris.size(); ++i) {
+        ASSERT_EQ(counts[i], s.sim->getTriCount(s.tris[i], "C"));
+        sum += counts[i];
+    }
+    ASSERT_GT(sum, 0.0);
+}
+
+TEST(BatchMPI, tetReac) {
+    BatchSim s;
+    uint n = s.tets.size();
+
+    // batch setters, single getters
+    std::vector<double> ks(n);
+    std::vector<unsigned char> actives(n);
+    for (uint i = 0; i < n; ++i) {
+        ks[i] = 1.0 + i;
+        actives[i] = i % 3 != 0;
+    }
+    s.sim->setBatchTetReacKNP(&s.tets.front(), n, "fwd", &ks.front(), n);
+    s.sim->setBatchTetReacActiveNP(&s.tets.front(), n, "fwd", &actives.front(), n);
+    for (uint i = 0; i < n; ++i) {
+        ASSERT_DOUBLE_EQ(s.sim->getTetReacK(s.tets[i], "fwd"), ks[i]);
+        ASSERT_EQ(s.sim->getTetReacActive(s.tets[i], "fwd"), actives[i] != 0);
+    }
+
+    // single setters, batch getters
+    for (uint i = 0; i < n; ++i) {
+        s.sim->setTetReacK(s.tets[i], "rev", 2.0 * i);
+        s.sim->setTetReacActive(s.tets[i], "rev", i % 2 == 0);
+    }
+    std::vector<double> got_ks(n);
+    std::vector<unsigned char> got_actives(n);
+    std::vector<double> got_as(n);
+    s.sim->getBatchTetReacKNP(&s.tets.front(), n, "rev", &got_ks.front(), n);
+    s.sim->getBatchTetReacActiveNP(&s.tets.front(), n, "rev", &got_actives.front(), n);
+    for (uint i = 0; i < n; ++i) {
+        ASSERT_DOUBLE_EQ(got_ks[i], s.sim->getTetReacK(s.tets[i], "rev"));
+        ASSERT_EQ(got_actives[i] != 0, s.sim->getTetReacActive(s.tets[i], "rev"));
+    }
+
+    for (std::string const & reac: {"fwd", "rev"}) {
+        s.sim->getBatchTetReacANP(&s.tets.front(), n, reac, &got_as.front(), n);
+        for (uint i = 0; i < n; ++i)
+            ASSERT_DOUBLE_EQ(got_as[i], s.sim->getTetReacA(s.tets[i], reac));
+    }
+}
+
+TEST(BatchMPI, triSReac) {
+    BatchSim s;
+    uint n = s.tris.size();
+
+    std::vector<double> ks(n);
+    std::vector<unsigned char> actives(n);
+    for (uint i = 0; i < n; ++i) {
+        ks[i] = 100.0 * (1 + i % 4);
+        actives[i] = i % 4 != 1;
+    }
+    s.sim->setBatchTriSReacKNP(&s.tris.front(), n, "bind", &ks.front(), n);
+    s.sim->setBatchTriSReacActiveNP(&s.tris.front(), n, "bind", &actives.front(), n);
+    for (uint i = 0; i < n; ++i) {
+        ASSERT_DOUBLE_EQ(s.sim->getTriSReacK(s.tris[i], "bind"), ks[i]);
+        ASSERT_EQ(s.sim->getTriSReacActive(s.tris[i], "bind"), actives[i] != 0);
+    }
+
+    for (uint i = 0; i < n; i += 2) {
+        s.sim->setTriSReacK(s.tris[i], "bind", 300.0);
+        s.sim->setTriSReacActive(s.tris[i], "bind", true);
+    }
+    std::vector<double> got_ks(n);
+    std::vector<unsigned char> got_actives(n);
+    std::vector<double> got_as(n);
+    s.sim->getBatchTriSReacKNP(&s.tris.front(), n, "bind", &got_ks.front(), n);
+    s.sim->getBatchTriSReacActiveNP(&s.tris.front(), n, "bind", &got_actives.front(), n);
+    s.sim->getBatchTriSReacANP(&s.tris.front(), n, "bind", &got_as.front(), n);
+    for (uint i = 0; i < n; ++i) {
+        ASSERT_DOUBLE_EQ(got_ks[i], s.sim->getTriSReacK(s.tris[i], "bind"));
+        ASSERT_EQ(got_actives[i] != 0, s.sim->getTriSReacActive(s.tris[i], "bind"));
+        ASSERT_DOUBLE_EQ(got_as[i], s.sim->getTriSReacA(s.tris[i], "bind"));
+    }
+}
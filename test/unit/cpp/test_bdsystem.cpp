@@ -161,3 +161,45 @@ TYPED_TEST(LinSystemImplTest,Bw7) {
         EXPECT_NEAR(x0[i],x.get(i),std::abs(x[i])*relerr);
     }
 }
+
+TYPED_TEST(LinSystemImplTest,Resolve) {
+    typedef TypeParam Impl;
+    typedef typename Impl::matrix_type matrix_type;
+    typedef typename Impl::vector_type vector_type;
+
+    constexpr size_t n=6;
+    constexpr int h=1;
+    double diag[n]={4,5,6,5,4,3};
+
+    Impl B(n,h);
+
+    matrix_type &A=B.A();
+    for (int i=0;i<n;++i) {
+        A.set(i,i,diag[i]);
+        if (i>0) A.set(i,i-1,-1.0);
+        if (i+1<n) A.set(i,i+1,-1.0);
+    }
+
+    // two right hand sides, the second solved with the factorisation
+    // of the first
+    for (int pass=0;pass<2;++pass) {
+        double x0[n];
+        for (int i=0;i<n;++i) x0[i]=pass==0?i+1.0:(i%2?-2.0:0.5*i);
+
+        vector_type &b=B.b();
+        for (int i=0;i<n;++i) {
+            double y=diag[i]*x0[i];
+            if (i>0) y-=x0[i-1];
+            if (i+1<n) y-=x0[i+1];
+            b.set(i,y);
+        }
+
+        if (pass==0) B.solve();
+        else B.resolve();
+
+        const vector_type &x=B.x();
+        for (int i=0;i<n;++i) {
+            EXPECT_NEAR(x0[i],x.get(i),1.0e-12);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "steps/error.hpp"
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/sreac.hpp"
+#include "steps/model/surfsys.hpp"
+#include "steps/solver/cpfile.hpp"
+#include "steps/tetexact/tetexact.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+static const char *CP_FILE = "test_checkpoint.cp";
+
+// The A/B model with surface kinetics on the boundary of the mesh.
+struct CheckpointSim: public ABModel {
+    std::unique_ptr<tetexact::Tetexact> sim;
+
+    CheckpointSim(bool extra_spec = false) {
+        model::Spec *C = new model::Spec("C", mdl.get());
+        if (extra_spec) new model::Spec("D", mdl.get());
+        model::Surfsys *ssys = new model::Surfsys("ssys", mdl.get());
+        new model::SReac("bind", ssys, {}, {A}, {}, {}, {C}, {}, 2.0);
+
+        std::vector<uint> tris;
+        for (auto t: mesh->getSurfTris()) tris.push_back(t);
+        tetmesh::TmPatch *patch = new tetmesh::TmPatch("patch", mesh.get(), tris, comp);
+        patch->addSurfsys("ssys");
+
+        sim.reset(new tetexact::Tetexact(mdl.get(), mesh.get(), r.get(), 0));
+    }
+};
+
+static void expect_same_state(tetexact::Tetexact &a, tetexact::Tetexact &b, tetmesh::Tetmesh &mesh) {
+    ASSERT_EQ(a.getTime(), b.getTime());
+    ASSERT_EQ(a.getNSteps(), b.getNSteps());
+    ASSERT_EQ(a.getA0(), b.getA0());
+    for (uint t = 0; t < mesh.countTets(); ++t) {
+        ASSERT_EQ(a.getTetCount(t, "A"), b.getTetCount(t, "A"));
+        ASSERT_EQ(a.getTetCount(t, "B"), b.getTetCount(t, "B"));
+    }
+    for (auto t: mesh.getSurfTris())
+        ASSERT_EQ(a.getTriCount(t, "C"), b.getTriCount(t, "C"));
+    ASSERT_EQ(a.getCompReacExtent("comp", "fwd"), b.getCompReacExtent("comp", "fwd"));
+    ASSERT_EQ(a.getPatchSReacExtent("patch", "bind"), b.getPatchSReacExtent("patch", "bind"));
+    ASSERT_EQ(a.getCompReacK("comp", "rev"), b.getCompReacK("comp", "rev"));
+    ASSERT_EQ(a.getCompClamped("comp", "B"), b.getCompClamped("comp", "B"));
+}
+
+struct CheckpointTest: public ::testing::Test {
+    std::unique_ptr<CheckpointSim> src;
+
+    virtual void SetUp() {
+        src.reset(new CheckpointSim());
+        src->sim->setCompCount("comp", "A", 1000);
+        src->sim->run(0.01);
+        src->sim->setCompReacK("comp", "rev", 7.5);
+        src->sim->setTetClamped(0, "B", true);
+    }
+
+    virtual void TearDown() {
+        std::remove(CP_FILE);
+    }
+};
+
+TEST_F(CheckpointTest, roundtrip) {
+    src->sim->checkpoint(CP_FILE);
+    ASSERT_TRUE(solver::CPReader::isCPFile(CP_FILE));
+
+    CheckpointSim dst;
+    dst.sim->restore(CP_FILE);
+    expect_same_state(*src->sim, *dst.sim, *dst.mesh);
+
+    // Both continue from the same state.
+    src->r->initialize(7);
+    dst.r->initialize(7);
+    src->sim->run(0.02);
+    dst.sim->run(0.02);
+    expect_same_state(*src->sim, *dst.sim, *dst.mesh);
+}
+
+TEST_F(CheckpointTest, legacy) {
+    src->sim->checkpointLegacy(CP_FILE);
+    ASSERT_FALSE(solver::CPReader::isCPFile(CP_FILE));
+
+    CheckpointSim dst;
+    dst.sim->restore(CP_FILE);
+    expect_same_state(*src->sim, *dst.sim, *dst.mesh);
+}
+
+TEST_F(CheckpointTest, mismatch) {
+    src->sim->checkpoint(CP_FILE);
+
+    CheckpointSim other(true);
+    ASSERT_THROW(other.sim->restore(CP_FILE), steps::ArgErr);
+}
+
+TEST_F(CheckpointTest, corrupt) {
+    src->sim->checkpoint(CP_FILE);
+
+    std::vector<char> data;
+    {
+        std::ifstream in(CP_FILE, std::ifstream::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    ASSERT_GT(data.size(), sizeof(solver::CPHeader) + 64);
+
+    // Flip a byte inside the blocks.
+    std::vector<char> flipped(data);
+    flipped[sizeof(solver::CPHeader) + 40] ^= 0x1;
+    {
+        std::ofstream out(CP_FILE, std::ofstream::binary | std::ofstream::trunc);
+        out.write(flipped.data(), flipped.size());
+    }
+    CheckpointSim dst;
+    ASSERT_THROW(dst.sim->restore(CP_FILE), steps::ArgErr);
+
+    // Corrupt a block read late in the restore: the simulation is left
+    // as it was and can continue.
+    solver::CPHeader const * header = reinterpret_cast<solver::CPHeader const *>(data.data());
+    solver::CPBlockInfo const * table =
+        reinterpret_cast<solver::CPBlockInfo const *>(data.data() + header->tableOffset);
+    flipped = data;
+    for (uint64_t b = 0; b < header->nblocks; ++b)
+        if (table[b].id == solver::CP_BLOCK_SOLVER_REALS) flipped[table[b].offset] ^= 0x1;
+    {
+        std::ofstream out(CP_FILE, std::ofstream::binary | std::ofstream::trunc);
+        out.write(flipped.data(), flipped.size());
+    }
+    dst.sim->setCompCount("comp", "A", 500);
+    ASSERT_THROW(dst.sim->restore(CP_FILE), steps::ArgErr);
+    ASSERT_EQ(dst.sim->getTime(), 0.0);
+    ASSERT_DOUBLE_EQ(dst.sim->getCompCount("comp", "A"), 500.0);
+    dst.sim->run(0.01);
+    ASSERT_GT(dst.sim->getNSteps(), 0);
+
+    // Truncate the file.
+    {
+        std::ofstream out(CP_FILE, std::ofstream::binary | std::ofstream::trunc);
+        out.write(data.data(), data.size() / 2);
+    }
+    ASSERT_THROW(dst.sim->restore(CP_FILE), steps::ArgErr);
+}
+
+TEST(CPCursorTest, columnsInMemory) {
+    solver::CPColumns cols;
+    cols.counts = {3, 4};
+    cols.flags = {1};
+    cols.ints = {-2};
+    cols.reals = {0.5, 1.5};
+
+    solver::CPCursor cur(cols);
+    ASSERT_EQ(cur.count(), 3);
+    uint counts[1];
+    cur.counts(counts, 1);
+    ASSERT_EQ(counts[0], 4);
+    ASSERT_EQ(cur.flag(), 1);
+    ASSERT_EQ(cur.integer(), -2);
+    ASSERT_THROW(cur.finish(), steps::ProgErr);
+    double reals[2];
+    cur.reals(reals, 2);
+    ASSERT_EQ(reals[1], 1.5);
+    cur.finish();
+    ASSERT_THROW(cur.real(), steps::ProgErr);
+    ASSERT_THROW(cur.seek(0), steps::ArgErr);
+}
@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/error.hpp"
+#include "steps/mpi/tetopsplit/tetopsplit.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+// Written by CheckpointMPIRanks.write, with the state it expects back in
+// EXPECTED_FILE, and read by CheckpointMPIRanks.restore, which ctest runs
+// on a different number of ranks.
+static const char *RANKS_CP_FILE = "test_checkpoint_mpi_ranks.cp";
+static const char *EXPECTED_FILE = "test_checkpoint_mpi_ranks.txt";
+
+static int mpi_rank(void) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// Tets dealt round-robin over the ranks, from the last rank if reversed.
+static std::vector<uint> tet_hosts(uint ntets, bool reversed = false) {
+    std::vector<uint> hosts(ntets);
+    uint nhosts = mpi_size();
+    for (uint t = 0; t < ntets; ++t)
+        hosts[t] = reversed ? nhosts - 1 - t % nhosts : t % nhosts;
+    return hosts;
+}
+
+// The A/B model under TetOpSplitP on a given partition.
+struct CheckpointMPISim: public ABModel {
+    std::unique_ptr<mpi::tetopsplit::TetOpSplitP> sim;
+
+    CheckpointMPISim(bool reversed = false, bool extra_spec = false) {
+        if (extra_spec) new model::Spec("D", mdl.get());
+        sim.reset(new mpi::tetopsplit::TetOpSplitP(mdl.get(), mesh.get(), r.get(),
+                                                   solver::API::EF_NONE,
+                                                   tet_hosts(mesh->countTets(), reversed)));
+    }
+};
+
+// The state compared across a restore: the time, the reaction extent
+// and the pools of every tet. The extent is only reduced onto rank 0,
+// so it is broadcast for every rank to compare alike.
+static std::vector<double> sim_state(mpi::tetopsplit::TetOpSplitP &sim, tetmesh::Tetmesh &mesh) {
+    std::vector<double> state;
+    state.push_back(sim.getTime());
+    double extent = sim.getReacExtent();
+    MPI_Bcast(&extent, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    state.push_back(extent);
+    for (uint t = 0; t < mesh.countTets(); ++t) {
+        state.push_back(sim.getTetCount(t, "A"));
+        state.push_back(sim.getTetCount(t, "B"));
+    }
+    return state;
+}
+
+static void remove_cp(std::string const & file_name, uint nranks) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (mpi_rank() != 0) return;
+    std::remove(file_name.c_str());
+    for (uint r = 0; r < nranks; ++r)
+        std::remove((file_name + "." + std::to_string(r)).c_str());
+}
+
+struct CheckpointMPITest: public ::testing::Test {
+    std::unique_ptr<CheckpointMPISim> src;
+
+    virtual void SetUp() {
+        src.reset(new CheckpointMPISim());
+        src->sim->setCompCount("comp", "A", 1000);
+        src->sim->run(0.01);
+    }
+};
+
+TEST_F(CheckpointMPITest, sameLayout) {
+    std::string file_name = "test_checkpoint_mpi_same.cp";
+    src->sim->checkpoint(file_name);
+
+    CheckpointMPISim dst;
+    dst.sim->restore(file_name);
+    remove_cp(file_name, mpi_size());
+    ASSERT_EQ(sim_state(*src->sim, *src->mesh), sim_state(*dst.sim, *dst.mesh));
+
+    // Generators and schedulers continue exactly where they were.
+    src->sim->run(0.02);
+    dst.sim->run(0.02);
+    ASSERT_EQ(sim_state(*src->sim, *src->mesh), sim_state(*dst.sim, *dst.mesh));
+}
+
+TEST_F(CheckpointMPITest, otherPartition) {
+    std::string file_name = "test_checkpoint_mpi_part.cp";
+    src->sim->checkpoint(file_name);
+
+    CheckpointMPISim dst(true);
+    dst.sim->restore(file_name);
+    remove_cp(file_name, mpi_size());
+    ASSERT_EQ(sim_state(*src->sim, *src->mesh), sim_state(*dst.sim, *dst.mesh));
+
+    // The rebuilt scheduler carries on.
+    dst.sim->run(0.02);
+    ASSERT_DOUBLE_EQ(dst.sim->getTime(), 0.02);
+    ASSERT_DOUBLE_EQ(dst.sim->getCompCount("comp", "A") + dst.sim->getCompCount("comp", "B"), 1000.0);
+}
+
+TEST_F(CheckpointMPITest, mismatch) {
+    std::string file_name = "test_checkpoint_mpi_bad.cp";
+    src->sim->checkpoint(file_name);
+
+    // A model with another species: every rank fails alike.
+    CheckpointMPISim other(false, true);
+    ASSERT_THROW(other.sim->restore(file_name), steps::ArgErr);
+    remove_cp(file_name, mpi_size());
+}
+
+TEST_F(CheckpointMPITest, missingPart) {
+    std::string file_name = "test_checkpoint_mpi_missing.cp";
+    src->sim->checkpoint(file_name);
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (mpi_rank() == 0)
+        std::remove((file_name + "." + std::to_string(mpi_size() - 1)).c_str());
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    // Only the last rank reads the missing part file, but every rank
+    // fails, and none changes its state.
+    CheckpointMPISim dst;
+    dst.sim->setCompCount("comp", "B", 500);
+    dst.sim->run(0.005);
+    std::vector<double> before = sim_state(*dst.sim, *dst.mesh);
+    ASSERT_THROW(dst.sim->restore(file_name), steps::ArgErr);
+    remove_cp(file_name, mpi_size());
+    ASSERT_EQ(before, sim_state(*dst.sim, *dst.mesh));
+}
+
+TEST(CheckpointMPIRanks, write) {
+    CheckpointMPISim src;
+    src.sim->setCompCount("comp", "A", 1000);
+    src.sim->run(0.01);
+    src.sim->checkpoint(RANKS_CP_FILE);
+
+    std::vector<double> state = sim_state(*src.sim, *src.mesh);
+    if (mpi_rank() == 0) {
+        std::ofstream out(EXPECTED_FILE);
+        out.precision(17);
+        out << mpi_size();
+        for (double x: state) out << " " << x;
+        out << "\n";
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+TEST(CheckpointMPIRanks, restore) {
+    std::ifstream in(EXPECTED_FILE);
+    ASSERT_TRUE(in.good());
+    uint nranks = 0;
+    in >> nranks;
+    std::vector<double> expected;
+    double x;
+    while (in >> x) expected.push_back(x);
+
+    CheckpointMPISim dst;
+    dst.sim->restore(RANKS_CP_FILE);
+    ASSERT_EQ(expected, sim_state(*dst.sim, *dst.mesh));
+
+    dst.sim->run(0.02);
+    ASSERT_DOUBLE_EQ(dst.sim->getTime(), 0.02);
+    ASSERT_DOUBLE_EQ(dst.sim->getCompCount("comp", "A") + dst.sim->getCompCount("comp", "B"), 1000.0);
+}
@@ -0,0 +1,112 @@
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include "steps/tetexact/crstruct.hpp"
+
+#include "gtest/gtest.h"
+
+using steps::tetexact::CRGroup;
+using steps::tetexact::CRSumTree;
+
+namespace {
+
+// linear scan equivalent to the original Tetexact group search
+uint linear_search(std::vector<CRGroup*> const & groups, double selector) {
+    double partial_sum = 0.0;
+    for (uint i = 0; i < groups.size(); i++) {
+        if (selector > partial_sum + groups[i]->sum) {
+            partial_sum += groups[i]->sum;
+            continue;
+        }
+        return i;
+    }
+    return groups.size();
+}
+
+}
+
+TEST(CRSumTree, ExtendAndTotal) {
+    std::vector<CRGroup*> groups;
+    CRSumTree tree;
+
+    for (uint i = 0; i < 37; i++) {
+        groups.push_back(new CRGroup(i, 1));
+        tree.extend(groups.size());
+        groups.back()->sum = i + 1;
+        tree.add(i, i + 1);
+        ASSERT_EQ(tree.size(), groups.size());
+        ASSERT_DOUBLE_EQ(tree.total(), (i + 1) * (i + 2) / 2.0);
+    }
+
+    CRSumTree rebuilt;
+    rebuilt.rebuild(groups);
+    ASSERT_EQ(rebuilt.nodes, tree.nodes);
+
+    for (auto g: groups) {
+        g->free_indices();
+        delete g;
+    }
+}
+
+TEST(CRSumTree, SearchMatchesLinearScan) {
+    std::mt19937 gen(23);
+    std::uniform_real_distribution<double> unf(0.0, 1.0);
+
+    std::vector<CRGroup*> groups;
+    for (uint i = 0; i < 50; i++) {
+        groups.push_back(new CRGroup(i, 1));
+        // leave some groups empty
+        groups.back()->sum = (i % 3 == 0) ? 0.0 : i;
+    }
+
+    CRSumTree tree;
+    tree.rebuild(groups);
+    double total = tree.total();
+
+    for (uint n = 0; n < 10000; n++) {
+        double selector = total * unf(gen);
+        double remainder = selector;
+        uint pos = tree.search(remainder);
+        ASSERT_EQ(pos, linear_search(groups, selector));
+        ASSERT_GE(remainder, 0.0);
+        ASSERT_LE(remainder, groups[pos]->sum * (1.0 + 1e-12));
+    }
+
+    double over = total * 2.0;
+    ASSERT_EQ(tree.search(over), groups.size());
+
+    for (auto g: groups) {
+        g->free_indices();
+        delete g;
+    }
+}
+
+TEST(CRSumTree, RefreshIsHistoryIndependent) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> unf(0.0, 1.0);
+
+    std::vector<CRGroup*> groups;
+    CRSumTree tree;
+    for (uint i = 0; i < 41; i++) {
+        groups.push_back(new CRGroup(i, 1));
+        tree.extend(groups.size());
+    }
+
+    // Sums spanning many orders of magnitude, changed in a random order,
+    // would leave rounding behind in nodes updated by deltas.
+    for (uint n = 0; n < 20000; n++) {
+        uint g = gen() % groups.size();
+        groups[g]->sum = (n % 7 == 0) ? 0.0 : std::ldexp(unf(gen), g - 20);
+        tree.refresh(g, groups);
+    }
+
+    CRSumTree rebuilt;
+    rebuilt.rebuild(groups);
+    ASSERT_EQ(rebuilt.nodes, tree.nodes);
+
+    for (auto g: groups) {
+        g->free_indices();
+        delete g;
+    }
+}
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "steps/error.hpp"
+#include "steps/tetexact/tetexact.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+static const uint NMOLS = 1000;
+static const double ENDTIME = 0.1;
+
+static void set_num_threads(int nthreads) {
+#ifdef _OPENMP
+    omp_set_num_threads(nthreads);
+#else
+    (void) nthreads;
+#endif
+}
+
+// The A/B model on a cube of 162 tets under Tetexact, in ndomains
+// spatial domains, with all molecules starting as A.
+struct DomainsSim: public ABModel {
+    std::unique_ptr<tetexact::Tetexact> sim;
+
+    explicit DomainsSim(uint ndomains)
+    : ABModel(CubeMesh(3, 0.1))
+    {
+        sim.reset(new tetexact::Tetexact(mdl.get(), mesh.get(), r.get(), 0));
+        sim->setNumDomains(ndomains);
+        sim->setCompCount("comp", "A", NMOLS);
+    }
+
+    std::vector<double> tet_counts(void) {
+        std::vector<double> counts;
+        for (uint t = 0; t < mesh->countTets(); ++t) {
+            counts.push_back(sim->getTetCount(t, "A"));
+            counts.push_back(sim->getTetCount(t, "B"));
+        }
+        return counts;
+    }
+};
+
+TEST(Domains, parameters) {
+    DomainsSim s(1);
+    ASSERT_EQ(s.sim->getNumDomains(), 1u);
+    ASSERT_THROW(s.sim->setNumDomains(0), steps::ArgErr);
+
+    s.sim->setNumDomains(4);
+    ASSERT_EQ(s.sim->getNumDomains(), 4u);
+    std::vector<uint> domains = s.sim->getTetDomains();
+    ASSERT_EQ(domains.size(), s.mesh->countTets());
+    for (uint d: domains) ASSERT_LT(d, 4u);
+}
+
+TEST(Domains, oneThreadMatchesSerial) {
+    // On one thread, domains follow the same kinetics as the serial
+    // scheduler: both keep every molecule and relax A <-> B to the same
+    // compartment counts, within the noise of one run.
+    set_num_threads(1);
+    DomainsSim serial(1);
+    DomainsSim domains(4);
+    serial.sim->run(ENDTIME);
+    domains.sim->run(ENDTIME);
+
+    ASSERT_DOUBLE_EQ(domains.sim->getTime(), ENDTIME);
+    double a_serial = serial.sim->getCompCount("comp", "A");
+    double a_domains = domains.sim->getCompCount("comp", "A");
+    ASSERT_DOUBLE_EQ(serial.sim->getCompCount("comp", "B") + a_serial, NMOLS);
+    ASSERT_DOUBLE_EQ(domains.sim->getCompCount("comp", "B") + a_domains, NMOLS);
+
+    double p = 1.0 / 3.0 + 2.0 / 3.0 * std::exp(-15.0 * ENDTIME);
+    double sd = std::sqrt(NMOLS * p * (1.0 - p));
+    ASSERT_NEAR(a_serial, NMOLS * p, 6.0 * sd);
+    ASSERT_NEAR(a_domains, NMOLS * p, 6.0 * sd);
+    ASSERT_NEAR(a_domains, a_serial, 6.0 * std::sqrt(2.0) * sd);
+
+    // The compartment count is the sum of the counts of its tets.
+    double sum = 0.0;
+    for (uint t = 0; t < domains.mesh->countTets(); ++t)
+        sum += domains.sim->getTetCount(t, "A");
+    ASSERT_DOUBLE_EQ(sum, a_domains);
+    ASSERT_DOUBLE_EQ(domains.sim->getCompReacExtent("comp", "fwd")
+                     - domains.sim->getCompReacExtent("comp", "rev"), NMOLS - a_domains);
+}
+
+TEST(Domains, threads) {
+    // The trajectory does not depend on the number of threads.
+    set_num_threads(1);
+    DomainsSim one(4);
+    one.sim->run(ENDTIME);
+
+    for (int nthreads: {2, 4}) {
+        set_num_threads(nthreads);
+        DomainsSim many(4);
+        many.sim->run(ENDTIME);
+        ASSERT_DOUBLE_EQ(many.sim->getTime(), ENDTIME);
+        ASSERT_EQ(many.tet_counts(), one.tet_counts());
+    }
+    set_num_threads(1);
+}
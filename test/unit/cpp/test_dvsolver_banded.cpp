@@ -0,0 +1,86 @@
+#include <memory>
+
+#include "steps/solver/efield/efield.hpp"
+#include "steps/solver/efield/dVsolver.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./prism_efield.hpp"
+
+using namespace steps::solver::efield;
+
+// The prism with a resting membrane and a current into one vertex.
+static void init_banded(EField & ef) {
+    init_prism(ef);
+    ef.setSurfaceResistivity(0, 1.0, -0.07);
+    ef.setVertIClamp(4, 0.2e-12);
+}
+
+// Advance both EFields by dt, the reference one with a new factorisation,
+// and check they agree.
+static void advance_both(EField & ef, EField & ref, double dt) {
+    ref.setMembCapac(0, 0.01);
+    ef.advance(dt);
+    ref.advance(dt);
+    for (uint v = 0; v < PRISM_NVERTS; ++v)
+        EXPECT_DOUBLE_EQ(ref.getVertV(v), ef.getVertV(v));
+}
+
+TEST(dVSolverBanded, Refactorisation) {
+    dVSolverBanded * solver = new dVSolverBanded;
+    std::unique_ptr<EField> ef(new EField(std::unique_ptr<EFieldSolver>(solver)));
+    std::unique_ptr<EField> ref = make_EField<dVSolverBanded>();
+    init_banded(*ef);
+    init_banded(*ref);
+
+    // Steps of the same length reuse the factorisation.
+    for (uint step = 0; step < 5; ++step)
+        advance_both(*ef, *ref, 1.0e-5);
+    EXPECT_EQ(1u, solver->countFactorisations());
+
+    // Clamping a vertex invalidates the matrix, clamping it again does not.
+    for (EField * e: {ef.get(), ref.get()}) {
+        e->setVertV(1, -0.05);
+        e->setVertVClamped(1, true);
+    }
+    advance_both(*ef, *ref, 1.0e-5);
+    EXPECT_EQ(2u, solver->countFactorisations());
+    for (EField * e: {ef.get(), ref.get()})
+        e->setVertVClamped(1, true);
+    advance_both(*ef, *ref, 1.0e-5);
+    EXPECT_EQ(2u, solver->countFactorisations());
+    EXPECT_DOUBLE_EQ(-0.05, ef->getVertV(1));
+
+    // So does unclamping it.
+    for (EField * e: {ef.get(), ref.get()})
+        e->setVertVClamped(1, false);
+    advance_both(*ef, *ref, 1.0e-5);
+    EXPECT_EQ(3u, solver->countFactorisations());
+
+    // A new capacitance.
+    for (EField * e: {ef.get(), ref.get()})
+        e->setMembCapac(0, 0.02);
+    ef->advance(1.0e-5);
+    ref->advance(1.0e-5);
+    EXPECT_EQ(4u, solver->countFactorisations());
+    for (uint v = 0; v < PRISM_NVERTS; ++v)
+        EXPECT_DOUBLE_EQ(ref->getVertV(v), ef->getVertV(v));
+
+    // New volume and surface conductances.
+    for (EField * e: {ef.get(), ref.get()})
+        e->setMembVolRes(0, 2.0);
+    ef->advance(1.0e-5);
+    ref->advance(1.0e-5);
+    EXPECT_EQ(5u, solver->countFactorisations());
+    for (EField * e: {ef.get(), ref.get()})
+        e->setSurfaceResistivity(0, 2.0, -0.07);
+    ef->advance(1.0e-5);
+    ref->advance(1.0e-5);
+    EXPECT_EQ(6u, solver->countFactorisations());
+    for (uint v = 0; v < PRISM_NVERTS; ++v)
+        EXPECT_DOUBLE_EQ(ref->getVertV(v), ef->getVertV(v));
+
+    // The same steps again reuse the last factorisation.
+    ef->advance(1.0e-5);
+    EXPECT_EQ(6u, solver->countFactorisations());
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/solver/efield/efield.hpp"
+#include "steps/solver/efield/dVsolver.hpp"
+#include "steps/solver/efield/dVsolver_dist.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./cube_mesh.hpp"
+#include "./prism_efield.hpp"
+
+using namespace steps::solver::efield;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+TEST(dVSolverDist, MatchesBanded) {
+    // On a single rank, without halo, the distributed solver holds the
+    // whole mesh and must agree with the direct one.
+    std::map<int, std::vector<uint>> halo;
+    std::unique_ptr<EField> dist = make_EField<dVSolverDist>(MPI_COMM_SELF, halo);
+    std::unique_ptr<EField> banded = make_EField<dVSolverBanded>();
+    init_prism(*dist, 0);
+    init_prism(*banded, 1);
+
+    for (uint step = 0; step < 10; ++step) {
+        dist->setTriI(0, 1.0e-12);
+        banded->setTriI(0, 1.0e-12);
+        dist->setTriI(1, -0.5e-12);
+        banded->setTriI(1, -0.5e-12);
+        dist->advance(1.0e-5);
+        banded->advance(1.0e-5);
+    }
+
+    for (uint v = 0; v < PRISM_NVERTS; ++v) {
+        double expected = banded->getVertV(v);
+        EXPECT_NEAR(expected, dist->getVertV(v), 1.0e-8 * std::fabs(expected));
+    }
+}
+
+TEST(dVSolverDist, ClampedVertexKeepsPotential) {
+    std::map<int, std::vector<uint>> halo;
+    std::unique_ptr<EField> dist = make_EField<dVSolverDist>(MPI_COMM_SELF, halo);
+    init_prism(*dist, 0);
+
+    dist->setVertV(0, -0.07);
+    dist->setVertVClamped(0, true);
+    for (uint step = 0; step < 5; ++step) {
+        dist->setTriI(0, 1.0e-12);
+        dist->advance(1.0e-5);
+    }
+
+    EXPECT_DOUBLE_EQ(-0.07, dist->getVertV(0));
+    EXPECT_GT(std::fabs(dist->getVertV(1) + 0.065), 1.0e-6);
+}
+
+static int mpi_rank(void) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    return rank;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// A cube of 4^3 cells with its bottom face as membrane, split among the
+// ranks by quadrant of the cells in i and j: on three ranks the vertices
+// along the middle of the cube are shared by all of them. Every rank
+// holds the vertices of its tets and tris in the global order, and
+// shares with every other rank the vertices that both hold.
+struct DistCube {
+    static const int N = 4;
+
+    CubeMesh cube;
+    std::vector<uint> tris;
+    std::vector<int> tri_hosts;
+    std::vector<int> tet_hosts;
+    // Ranks holding every global vertex, and the local index of every
+    // global vertex on this rank, or -1.
+    std::vector<std::vector<int>> vert_ranks;
+    std::vector<int> local;
+
+    std::vector<double> loc_verts;
+    std::vector<uint> loc_tris;
+    std::vector<uint> loc_tets;
+    std::vector<uint> loc_tri_gidx;
+    std::map<int, std::vector<uint>> halo;
+
+    DistCube()
+    : cube(N)
+    {
+        auto host = [](int i, int j) {
+            return std::min(mpi_size() - 1, (i >= N / 2) + 2 * (j >= N / 2));
+        };
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) {
+                uint a = cube.vert(i, j, 0), b = cube.vert(i + 1, j, 0);
+                uint c = cube.vert(i + 1, j + 1, 0), d = cube.vert(i, j + 1, 0);
+                tris.insert(tris.end(), {a, b, c, a, c, d});
+                tri_hosts.insert(tri_hosts.end(), {host(i, j), host(i, j)});
+            }
+        for (uint t = 0; t < cube.countTets(); ++t) {
+            uint cell = t / 6;
+            tet_hosts.push_back(host(cell / (N * N), (cell / N) % N));
+        }
+
+        vert_ranks.resize(cube.countVerts());
+        auto hold = [this](uint const * verts, uint n, int h) {
+            for (uint k = 0; k < n; ++k) {
+                std::vector<int> & ranks = vert_ranks[verts[k]];
+                if (std::find(ranks.begin(), ranks.end(), h) == ranks.end()) ranks.push_back(h);
+            }
+        };
+        for (uint t = 0; t < cube.countTets(); ++t) hold(&cube.tets[4 * t], 4, tet_hosts[t]);
+        for (uint t = 0; t < tri_hosts.size(); ++t) hold(&tris[3 * t], 3, tri_hosts[t]);
+
+        local.assign(cube.countVerts(), -1);
+        for (uint v = 0; v < cube.countVerts(); ++v) {
+            std::vector<int> const & ranks = vert_ranks[v];
+            if (std::find(ranks.begin(), ranks.end(), mpi_rank()) == ranks.end()) continue;
+            local[v] = loc_verts.size() / 3;
+            loc_verts.insert(loc_verts.end(), &cube.verts[3 * v], &cube.verts[3 * v + 3]);
+            for (int h: ranks)
+                if (h != mpi_rank()) halo[h].push_back(local[v]);
+        }
+        for (uint t = 0; t < cube.countTets(); ++t)
+            if (tet_hosts[t] == mpi_rank())
+                for (uint k = 0; k < 4; ++k) loc_tets.push_back(local[cube.tets[4 * t + k]]);
+        for (uint t = 0; t < tri_hosts.size(); ++t)
+            if (tri_hosts[t] == mpi_rank()) {
+                for (uint k = 0; k < 3; ++k) loc_tris.push_back(local[tris[3 * t + k]]);
+                loc_tri_gidx.push_back(t);
+            }
+    }
+
+    void init(EField & ef) {
+        ef.initMesh(loc_verts.size() / 3, loc_verts.data(), loc_tris.size() / 3, loc_tris.data(),
+                    loc_tets.size() / 4, loc_tets.data(), 0);
+    }
+
+    void init_whole(EField & ef) {
+        ef.initMesh(cube.countVerts(), cube.verts.data(), tris.size() / 3, tris.data(),
+                    cube.countTets(), cube.tets.data(), 1);
+    }
+};
+
+TEST(dVSolverDist, RanksMatchBanded) {
+    DistCube dc;
+    dVSolverDist *solver = new dVSolverDist(MPI_COMM_WORLD, dc.halo);
+    EField dist{std::unique_ptr<EFieldSolver>(solver)};
+    std::unique_ptr<EField> banded = make_EField<dVSolverBanded>();
+    dc.init(dist);
+    dc.init_whole(*banded);
+
+    // Every vertex is counted in global sums by the lowest rank holding it.
+    uint expect_owned = 0;
+    for (uint v = 0; v < dc.cube.countVerts(); ++v)
+        if (dc.local[v] != -1 && *std::min_element(dc.vert_ranks[v].begin(), dc.vert_ranks[v].end()) == mpi_rank())
+            ++expect_owned;
+    ASSERT_EQ(solver->countOwnedVerts(), expect_owned);
+    uint nowned = solver->countOwnedVerts();
+    MPI_Allreduce(MPI_IN_PLACE, &nowned, 1, MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
+    ASSERT_EQ(nowned, dc.cube.countVerts());
+
+    // A leak on every membrane tri, which each rank adds up for its
+    // own tris, and a clamp on a vertex in the middle of the cube, which
+    // every rank holding it sets.
+    banded->setSurfaceResistivity(0, 1.0, -0.07);
+    dist.setSurfaceResistivity(0, 1.0, -0.07);
+    uint clamped = dc.cube.vert(DistCube::N / 2, DistCube::N / 2, 1);
+    banded->setVertV(clamped, -0.05);
+    banded->setVertVClamped(clamped, true);
+    if (dc.local[clamped] != -1) {
+        dist.setVertV(dc.local[clamped], -0.05);
+        dist.setVertVClamped(dc.local[clamped], true);
+    }
+
+    for (uint step = 0; step < 10; ++step) {
+        for (uint t = 0; t < dc.tri_hosts.size(); ++t) banded->setTriI(t, (1 + t % 3) * 1.0e-12);
+        for (uint t = 0; t < dc.loc_tri_gidx.size(); ++t)
+            dist.setTriI(t, (1 + dc.loc_tri_gidx[t] % 3) * 1.0e-12);
+        banded->advance(1.0e-5);
+        dist.advance(1.0e-5);
+        if (step == 0) ASSERT_GT(solver->getNIterations(), 0u);
+    }
+
+    // Every held vertex agrees with the whole mesh, and the shared ones
+    // to the last bit on all ranks holding them.
+    uint nverts = dc.cube.countVerts();
+    std::vector<double> lo(nverts, std::numeric_limits<double>::infinity());
+    std::vector<double> hi(nverts, -std::numeric_limits<double>::infinity());
+    for (uint v = 0; v < nverts; ++v) {
+        if (dc.local[v] == -1) continue;
+        double expected = banded->getVertV(v);
+        double got = dist.getVertV(dc.local[v]);
+        EXPECT_NEAR(expected, got, 1.0e-8 * std::fabs(expected));
+        lo[v] = hi[v] = got;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, lo.data(), nverts, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, hi.data(), nverts, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    ASSERT_EQ(lo, hi);
+    EXPECT_DOUBLE_EQ(-0.05, banded->getVertV(clamped));
+}
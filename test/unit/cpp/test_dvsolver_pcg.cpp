@@ -0,0 +1,49 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "steps/solver/efield/efield.hpp"
+#include "steps/solver/efield/dVsolver.hpp"
+#include "steps/solver/efield/dVsolver_pcg.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./prism_efield.hpp"
+
+using namespace steps::solver::efield;
+
+static void check_matches_banded(dVSolverPCG::Preconditioner precond) {
+    std::unique_ptr<EField> pcg = make_EField<dVSolverPCG>(precond);
+    std::unique_ptr<EField> banded = make_EField<dVSolverBanded>();
+    init_prism(*pcg);
+    init_prism(*banded);
+
+    pcg->setVertVClamped(5, true);
+    banded->setVertVClamped(5, true);
+    for (uint step = 0; step < 10; ++step) {
+        // Change of capacitance half way, to refactorise.
+        if (step == 5) {
+            pcg->setMembCapac(0, 0.02);
+            banded->setMembCapac(0, 0.02);
+        }
+        pcg->setTriI(0, 1.0e-12);
+        banded->setTriI(0, 1.0e-12);
+        pcg->setTriI(1, -0.5e-12);
+        banded->setTriI(1, -0.5e-12);
+        pcg->advance(1.0e-5);
+        banded->advance(1.0e-5);
+    }
+
+    for (uint v = 0; v < PRISM_NVERTS; ++v) {
+        double expected = banded->getVertV(v);
+        EXPECT_NEAR(expected, pcg->getVertV(v), 1.0e-8 * std::fabs(expected));
+    }
+}
+
+TEST(dVSolverPCG, IC0MatchesBanded) {
+    check_matches_banded(dVSolverPCG::PRECOND_IC0);
+}
+
+TEST(dVSolverPCG, JacobiMatchesBanded) {
+    check_matches_banded(dVSolverPCG::PRECOND_JACOBI);
+}
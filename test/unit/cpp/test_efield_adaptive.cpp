@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "steps/error.hpp"
+#include "steps/solver/efield/efield.hpp"
+#include "steps/solver/efield/dVsolver.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./prism_efield.hpp"
+
+using namespace steps::solver::efield;
+
+// A leaky membrane relaxing from -65mV to 0 with a time constant of 10ms.
+static std::unique_ptr<EField> leaky_prism(void) {
+    std::unique_ptr<EField> ef = make_EField<dVSolverBanded>();
+    init_prism(*ef);
+    ef->setSurfaceResistivity(0, 1.0, 0.0);
+    return ef;
+}
+
+// Largest difference from the fixed step solution after 20ms of relaxation.
+static double relaxation_error(EField & fixed, double tol, ulong & nsteps) {
+    std::unique_ptr<EField> adaptive = leaky_prism();
+    adaptive->setAdaptive(true, 1.0e-6, 1.0e-3, tol);
+    double t = 0.0;
+    while (t < 0.02 - 1.0e-12) {
+        double dt = std::min(adaptive->getNextDT(), 0.02 - t);
+        adaptive->advance(dt);
+        t += dt;
+    }
+
+    nsteps = adaptive->getNStepsWithinTolerance();
+    double err = 0.0;
+    for (uint v = 0; v < PRISM_NVERTS; ++v)
+        err = std::max(err, std::fabs(fixed.getVertV(v) - adaptive->getVertV(v)));
+    return err;
+}
+
+TEST(EFieldAdaptive, FollowsRelaxation) {
+    std::unique_ptr<EField> fixed = leaky_prism();
+    for (uint step = 0; step < 20000; ++step) fixed->advance(1.0e-6);
+
+    // Far fewer steps than the fixed solution, to within a fraction of a
+    // millivolt; closer for a smaller tolerance.
+    ulong nsteps_coarse, nsteps_fine;
+    double err_coarse = relaxation_error(*fixed, 1.0e-5, nsteps_coarse);
+    double err_fine = relaxation_error(*fixed, 1.0e-6, nsteps_fine);
+    EXPECT_LT(nsteps_coarse, 500u);
+    EXPECT_LT(err_coarse, 5.0e-4);
+    EXPECT_GT(nsteps_fine, nsteps_coarse);
+    EXPECT_LT(err_fine, 0.5 * err_coarse);
+}
+
+TEST(EFieldAdaptive, ShortensAfterCurrentStep) {
+    std::unique_ptr<EField> ef = leaky_prism();
+    ef->setAdaptive(true, 1.0e-6, 1.0e-3, 1.0e-5);
+
+    // At rest: the step grows to the longest.
+    ef->setMembPotential(0, 0.0);
+    for (uint step = 0; step < 50; ++step) ef->advance(ef->getNextDT());
+    EXPECT_DOUBLE_EQ(1.0e-3, ef->getNextDT());
+    EXPECT_EQ(0u, ef->getNStepsOverTolerance());
+
+    // A current switched on: the long step is taken whole, over the
+    // tolerance, and the next ones are shorter.
+    ulong nsteps = ef->getNStepsWithinTolerance();
+    ef->setTriI(0, 1.0e-11);
+    ef->advance(ef->getNextDT());
+    EXPECT_EQ(1u, ef->getNStepsOverTolerance());
+    EXPECT_EQ(nsteps, ef->getNStepsWithinTolerance());
+    EXPECT_LT(ef->getNextDT(), 1.0e-3);
+}
+
+// The banded solver keeps the factorisation for each of a few step lengths.
+TEST(EFieldAdaptive, FactorisationPerStep) {
+    std::unique_ptr<EField> alternating = leaky_prism();
+    std::unique_ptr<EField> fixed = leaky_prism();
+    for (uint step = 0; step < 20; ++step) {
+        double dt = step % 2 ? 2.0e-5 : 1.0e-5;
+        alternating->advance(dt);
+        fixed->advance(dt);
+        // A new factorisation for the fixed one at every step.
+        fixed->setMembCapac(0, 0.01);
+    }
+    for (uint v = 0; v < PRISM_NVERTS; ++v)
+        EXPECT_DOUBLE_EQ(fixed->getVertV(v), alternating->getVertV(v));
+}
+
+TEST(EFieldAdaptive, Bounds) {
+    std::unique_ptr<EField> ef = leaky_prism();
+    EXPECT_FALSE(ef->getAdaptive());
+    EXPECT_THROW(ef->setAdaptive(true, 0.0, 1.0e-3, 1.0e-5), steps::ArgErr);
+    EXPECT_THROW(ef->setAdaptive(true, 1.0e-3, 1.0e-6, 1.0e-5), steps::ArgErr);
+    EXPECT_THROW(ef->setAdaptive(true, 1.0e-6, 1.0e-3, 0.0), steps::ArgErr);
+
+    // Steps are the longest halved, down to no less than the shortest.
+    ef->setAdaptive(true, 1.0e-6, 1.0e-3, 1.0e-5);
+    EXPECT_TRUE(ef->getAdaptive());
+    EXPECT_DOUBLE_EQ(1.0e-3 / 512, ef->getNextDT());
+    ef->setAdaptive(false, 0.0, 0.0, 0.0);
+    EXPECT_FALSE(ef->getAdaptive());
+}
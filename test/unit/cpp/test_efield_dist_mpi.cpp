@@ -0,0 +1,106 @@
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/geom/memb.hpp"
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/diff.hpp"
+#include "steps/model/volsys.hpp"
+#include "steps/mpi/tetopsplit/tetopsplit.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// The A/B model on a cube of 162 tets, 3um across, with its whole
+// surface as membrane, under TetOpSplitP with the given EField solver.
+// The tets are dealt to the ranks in slabs and every membrane tri is
+// hosted with its tet.
+struct EFieldDistSim: public ABModel {
+    std::vector<uint> tris;
+    std::unique_ptr<mpi::tetopsplit::TetOpSplitP> sim;
+
+    EFieldDistSim(int efield)
+    : ABModel(CubeMesh(3, 1.0e-6))
+    {
+        // a diffusion constant for a mesh in microns
+        vsys->getDiff("diffA")->setDcst(1.0e-12);
+
+        for (auto t: mesh->getSurfTris()) tris.push_back(t);
+        tetmesh::TmPatch *patch = new tetmesh::TmPatch("patch", mesh.get(), tris, comp);
+        new tetmesh::Memb("memb", mesh.get(), {patch});
+
+        uint ntets = mesh->countTets();
+        std::vector<uint> tet_hosts(ntets);
+        for (uint t = 0; t < ntets; ++t) tet_hosts[t] = t * mpi_size() / ntets;
+        std::map<uint, uint> tri_hosts;
+        for (uint t: tris) tri_hosts[t] = tet_hosts[mesh->getTriTetNeighb(t)[0]];
+
+        sim.reset(new mpi::tetopsplit::TetOpSplitP(mdl.get(), mesh.get(), r.get(),
+                                                   efield, tet_hosts, tri_hosts));
+        sim->setMembPotential("memb", -0.065);
+        sim->setMembCapac("memb", 0.01);
+        sim->setMembVolRes("memb", 1.0);
+        sim->setEfieldDT(1.0e-6);
+
+        // Currents into some tris on every rank, into a vertex in the
+        // middle of the cube, shared by neighbouring ranks, and a
+        // clamped vertex on the surface.
+        for (uint i = 0; i < tris.size(); i += 5)
+            sim->setTriIClamp(tris[i], (1 + i % 3) * 1.0e-12);
+        sim->setVertIClamp(centre(), 2.0e-12);
+        sim->setVertV(0, -0.05);
+        sim->setVertVClamped(0, true);
+    }
+
+    // A vertex of the middle cell, shared by every slab on three ranks.
+    uint centre(void) {
+        CubeMesh cube(3);
+        return cube.vert(1, 1, 1);
+    }
+};
+
+TEST(EFieldDistMPI, matchesBanded) {
+    EFieldDistSim dist(solver::API::EF_DV_DIST);
+    EFieldDistSim banded(solver::API::EF_DV_BDSYS);
+    ASSERT_TRUE(dist.sim->efdist());
+    ASSERT_FALSE(banded.sim->efdist());
+
+    dist.sim->run(2.0e-5);
+    banded.sim->run(2.0e-5);
+
+    auto expect_near = [](double expected, double got) {
+        EXPECT_NEAR(expected, got, 1.0e-8 * std::fabs(expected));
+    };
+    for (uint v = 0; v < dist.mesh->countVertices(); ++v)
+        expect_near(banded.sim->getVertV(v), dist.sim->getVertV(v));
+    for (uint t = 0; t < dist.mesh->countTets(); ++t)
+        expect_near(banded.sim->getTetV(t), dist.sim->getTetV(t));
+    for (uint t: dist.tris)
+        expect_near(banded.sim->getTriV(t), dist.sim->getTriV(t));
+
+    // The potentials moved away from the resting one.
+    EXPECT_GT(std::fabs(banded.sim->getVertV(dist.centre()) + 0.065), 1.0e-4);
+    EXPECT_DOUBLE_EQ(-0.05, dist.sim->getVertV(0));
+}
@@ -0,0 +1,78 @@
+#include <memory>
+#include <vector>
+
+#include "steps/solver/kprocprofile.hpp"
+#include "steps/tetexact/tetexact.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+using steps::solver::KProcProfile;
+using steps::solver::KProcProfileRow;
+
+struct KProcProfileTest: public ::testing::Test, public ABModel {
+    std::unique_ptr<tetexact::Tetexact> sim;
+
+    virtual void SetUp() {
+        sim.reset(new tetexact::Tetexact(mdl.get(), mesh.get(), r.get(), 0));
+        sim->setCompCount("comp", "A", 1000);
+    }
+};
+
+TEST_F(KProcProfileTest, layout) {
+    ASSERT_FALSE(sim->getProfiling());
+    ASSERT_EQ(sim->countProfileRows(), 0);
+
+    sim->setProfiling(true);
+    ASSERT_TRUE(sim->getProfiling());
+    ASSERT_EQ(sim->countProfileRows(), 3);
+
+    std::vector<KProcProfileRow> rows = sim->getProfile();
+    ASSERT_EQ(rows[0].type, steps::solver::PROFILE_REAC);
+    ASSERT_EQ(rows[1].type, steps::solver::PROFILE_REAC);
+    ASSERT_EQ(rows[2].type, steps::solver::PROFILE_DIFF);
+    for (uint i = 0; i < rows.size(); ++i) {
+        ASSERT_EQ(rows[i].container, 0);
+        ASSERT_EQ(rows[i].nevents, 0);
+    }
+    ASSERT_EQ(rows[0].rule, 0);
+    ASSERT_EQ(rows[1].rule, 1);
+    ASSERT_EQ(rows[2].rule, 0);
+}
+
+TEST_F(KProcProfileTest, counts) {
+    sim->setProfiling(true);
+    sim->run(0.01);
+
+    std::vector<KProcProfileRow> rows = sim->getProfile();
+    ASSERT_EQ(rows[0].nevents, sim->getCompReacExtent("comp", "fwd"));
+    ASSERT_EQ(rows[1].nevents, sim->getCompReacExtent("comp", "rev"));
+
+    ulong nevents = 0;
+    for (auto const & row: rows) {
+        ASSERT_EQ(row.napplies, row.nevents);
+        ASSERT_GE(row.time, 0.0);
+        nevents += row.nevents;
+    }
+    ASSERT_EQ(nevents, sim->getNSteps());
+    ASSERT_GT(rows[2].nevents, 0);
+    ASSERT_GT(rows[2].nupdates, rows[2].nevents);
+
+    std::vector<double> table(rows.size() * KProcProfile::NCOLS);
+    sim->getProfileNP(table.data(), table.size());
+    for (uint i = 0; i < rows.size(); ++i) {
+        ASSERT_EQ(table[i * KProcProfile::NCOLS], rows[i].type);
+        ASSERT_EQ(table[i * KProcProfile::NCOLS + 3], rows[i].nevents);
+        ASSERT_EQ(table[i * KProcProfile::NCOLS + 6], rows[i].time);
+    }
+    ASSERT_THROW(sim->getProfileNP(table.data(), table.size() - 1), steps::ArgErr);
+
+    sim->resetProfile();
+    for (auto const & row: sim->getProfile())
+        ASSERT_EQ(row.nevents, 0);
+
+    sim->setProfiling(false);
+    ASSERT_THROW(sim->getProfile(), steps::ArgErr);
+}
@@ -0,0 +1,81 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/model/diff.hpp"
+#include "steps/mpi/tetopsplit/tetopsplit.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// The A/B model under TetOpSplitP with tets dealt round-robin over the
+// ranks and the given number of update period levels, with B diffusing
+// dcstB times as fast as A if dcstB is not 0.
+struct MultiRateSim: public ABModel {
+    std::unique_ptr<mpi::tetopsplit::TetOpSplitP> sim;
+
+    MultiRateSim(CubeMesh const & cube, uint nlevels, double dcstB = 0.0)
+    : ABModel(cube)
+    {
+        if (dcstB != 0.0) new model::Diff("diffB", vsys, B, dcstB);
+
+        std::vector<uint> hosts(mesh->countTets());
+        for (uint t = 0; t < hosts.size(); ++t) hosts[t] = t % mpi_size();
+        sim.reset(new mpi::tetopsplit::TetOpSplitP(mdl.get(), mesh.get(), r.get(),
+                                                   solver::API::EF_NONE, hosts));
+        sim->setUpdPeriodLevels(nlevels);
+        sim->setCompCount("comp", "A", 2000);
+    }
+};
+
+TEST(MultiRate, periodOne) {
+    // Every tet of the cube diffuses A at more than half the fastest
+    // rate, so all rules stay at level 0 however many levels are allowed
+    // and the multi-rate loop must take the same steps as with one level.
+    CubeMesh cube(3, 0.1);
+    MultiRateSim single(cube, 1);
+    MultiRateSim multi(cube, 4);
+
+    single.sim->run(0.05);
+    multi.sim->run(0.05);
+
+    ASSERT_EQ(single.sim->getUpdPeriod(), multi.sim->getUpdPeriod());
+    ASSERT_EQ(single.sim->getNIteration(), multi.sim->getNIteration());
+    for (uint t = 0; t < single.mesh->countTets(); ++t) {
+        ASSERT_EQ(single.sim->getTetCount(t, "A"), multi.sim->getTetCount(t, "A"));
+        ASSERT_EQ(single.sim->getTetCount(t, "B"), multi.sim->getTetCount(t, "B"));
+    }
+}
+
+TEST(MultiRate, slowRule) {
+    // B diffuses 16 times slower than A, so its rules are applied every
+    // few base periods; the kinetics and the molecule count are unchanged.
+    CubeMesh cube(3, 0.1);
+    MultiRateSim multi(cube, 4, 1.0 / 16);
+    multi.sim->run(0.1);
+
+    double expectA = 2000.0 * (1.0 / 3.0 + 2.0 / 3.0 * std::exp(-15.0 * 0.1));
+    ASSERT_NEAR(multi.sim->getCompCount("comp", "A"), expectA, 110.0);
+    ASSERT_DOUBLE_EQ(multi.sim->getCompCount("comp", "A") + multi.sim->getCompCount("comp", "B"), 2000.0);
+}
@@ -0,0 +1,167 @@
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/sreac.hpp"
+#include "steps/model/surfsys.hpp"
+#include "steps/mpi/tetopsplit/tetopsplit.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+static int mpi_size(void) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    return size;
+}
+
+// The A/B model with A binding to C on the boundary of a cube of 162
+// tets, under TetOpSplitP with the tets dealt to the ranks in contiguous
+// blocks and every boundary tri hosted with its tet. All molecules start
+// in the tets of rank 0, so that rank does nearly all the work. B
+// diffuses dcstB times as fast as A if dcstB is not 0, with the given
+// number of update period levels.
+struct RebalanceSim: public ABModel {
+    std::vector<uint> tris;
+    std::unique_ptr<mpi::tetopsplit::TetOpSplitP> sim;
+
+    RebalanceSim(uint nlevels = 1, double dcstB = 0.0)
+    : ABModel(CubeMesh(3, 0.1))
+    {
+        if (dcstB != 0.0) new model::Diff("diffB", vsys, B, dcstB);
+        model::Spec *C = new model::Spec("C", mdl.get());
+        model::Surfsys *ssys = new model::Surfsys("ssys", mdl.get());
+        new model::SReac("bind", ssys, {}, {A}, {}, {}, {C}, {}, 1.0);
+
+        for (auto t: mesh->getSurfTris()) tris.push_back(t);
+        tetmesh::TmPatch *patch = new tetmesh::TmPatch("patch", mesh.get(), tris, comp);
+        patch->addSurfsys("ssys");
+
+        uint ntets = mesh->countTets();
+        std::vector<uint> tet_hosts(ntets);
+        for (uint t = 0; t < ntets; ++t) tet_hosts[t] = t * mpi_size() / ntets;
+        std::map<uint, uint> tri_hosts;
+        for (uint t: tris) tri_hosts[t] = tet_hosts[mesh->getTriTetNeighb(t)[0]];
+
+        sim.reset(new mpi::tetopsplit::TetOpSplitP(mdl.get(), mesh.get(), r.get(),
+                                                   solver::API::EF_NONE, tet_hosts, tri_hosts));
+        sim->setUpdPeriodLevels(nlevels);
+        for (uint t = 0; t < ntets; ++t)
+            if (tet_hosts[t] == 0) sim->setTetCount(t, "A", 200);
+    }
+
+    // Every count and the reaction extent, which getReacExtent() only
+    // reduces onto rank 0.
+    std::vector<double> state(void) {
+        std::vector<double> s;
+        s.push_back(sim->getTime());
+        double extent = sim->getReacExtent();
+        MPI_Bcast(&extent, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        s.push_back(extent);
+        for (uint t = 0; t < mesh->countTets(); ++t) {
+            s.push_back(sim->getTetCount(t, "A"));
+            s.push_back(sim->getTetCount(t, "B"));
+        }
+        for (uint t: tris) s.push_back(sim->getTriCount(t, "C"));
+        return s;
+    }
+
+    double total(void) {
+        double n = sim->getCompCount("comp", "A") + sim->getCompCount("comp", "B");
+        return n + sim->getPatchCount("patch", "C");
+    }
+
+    std::vector<uint> tet_hosts(void) {
+        std::vector<uint> hosts(mesh->countTets());
+        for (uint t = 0; t < hosts.size(); ++t) hosts[t] = sim->getTetHostRank(t);
+        return hosts;
+    }
+
+    // Every tet and tri has one host that all ranks agree on, and every
+    // boundary tri is hosted with its tet.
+    void check_ownership(void) {
+        std::vector<uint> hosts = tet_hosts();
+        for (uint t: tris) {
+            hosts.push_back(sim->getTriHostRank(t));
+            ASSERT_EQ(sim->getTriHostRank(t), sim->getTetHostRank(mesh->getTriTetNeighb(t)[0]));
+        }
+        std::vector<uint> lo(hosts.size()), hi(hosts.size());
+        MPI_Allreduce(&hosts.front(), &lo.front(), hosts.size(), MPI_UNSIGNED, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(&hosts.front(), &hi.front(), hosts.size(), MPI_UNSIGNED, MPI_MAX, MPI_COMM_WORLD);
+        ASSERT_EQ(lo, hi);
+        for (uint h: hosts) ASSERT_LT(h, static_cast<uint>(mpi_size()));
+    }
+};
+
+TEST(RebalanceMPI, forced) {
+    RebalanceSim s;
+    s.sim->setRebalanceThreshold(1.1);
+    s.sim->run(0.01);
+
+    double total = s.total();
+    std::vector<double> before = s.state();
+    std::vector<uint> hosts_before = s.tet_hosts();
+
+    ASSERT_TRUE(s.sim->rebalance());
+
+    // Elements moved but the state they carry did not change.
+    ASSERT_NE(s.tet_hosts(), hosts_before);
+    s.check_ownership();
+    ASSERT_EQ(s.state(), before);
+    ASSERT_DOUBLE_EQ(s.total(), total);
+
+    // And the simulation carries on from it.
+    s.sim->run(0.02);
+    s.check_ownership();
+    ASSERT_DOUBLE_EQ(s.total(), total);
+}
+
+TEST(RebalanceMPI, periodic) {
+    RebalanceSim s;
+    s.sim->setRebalanceThreshold(1.1);
+    s.sim->setRebalancePeriods(5);
+    double total = s.total();
+    std::vector<uint> hosts_before = s.tet_hosts();
+
+    s.sim->run(0.02);
+    ASSERT_NE(s.tet_hosts(), hosts_before);
+    s.check_ownership();
+    ASSERT_DOUBLE_EQ(s.total(), total);
+}
+
+// With B 16 times slower than A, a cycle of update periods is longer
+// than the rebalancing period, which is then due part way into a cycle:
+// the load must still be checked at the end of that cycle, and again
+// every period after it, over consecutive calls to run().
+TEST(RebalanceMPI, periodicAcrossRuns) {
+    RebalanceSim s(4, 1.0 / 16);
+    s.sim->setRebalanceThreshold(1.1);
+    s.sim->setRebalancePeriods(5);
+    double total = s.total();
+
+    ulong nchecks = 0;
+    for (uint i = 1; i <= 4; ++i) {
+        s.sim->run(0.01 * i);
+        ASSERT_GT(s.sim->getNRebalanceChecks(), nchecks);
+        nchecks = s.sim->getNRebalanceChecks();
+    }
+    ASSERT_GT(nchecks, 1u);
+    s.check_ownership();
+    ASSERT_DOUBLE_EQ(s.total(), total);
+}
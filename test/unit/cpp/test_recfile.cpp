@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "steps/error.hpp"
+#include "steps/mpi/recfile.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace steps::mpi;
+
+int main(int argc, char **argv) {
+    int r=0;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc,&argv);
+    r=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return r;
+}
+
+static std::vector<char> read_file(std::string const & file_name) {
+    std::ifstream f(file_name.c_str(), std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+static T read_at(std::vector<char> const & buf, uint64_t pos) {
+    T v;
+    std::memcpy(&v, buf.data() + pos, sizeof(T));
+    return v;
+}
+
+static std::vector<RecSelection> sample_selections(void) {
+    RecSelection tets;
+    tets.kind = REC_ELEM_TET;
+    tets.elems = {3, 1};
+    tets.specs = {"A", "B"};
+    RecSelection tris;
+    tris.kind = REC_ELEM_TRI;
+    tris.elems = {7};
+    tris.specs = {"C"};
+    return {tets, tris};
+}
+
+// Column c at sample s of a recording: counts rising and falling.
+static double sample_value(uint c, uint s) {
+    return (s % 2 == 0) ? 100.0 * c + s : 100.0 * c - 3.0 * s;
+}
+
+// Write 5 samples in chunks of 2 and check every column read back.
+static void check_recording(bool compress) {
+    std::string file_name = compress ? "test_recfile_z.rec" : "test_recfile.rec";
+    std::vector<RecSelection> sels = sample_selections();
+    {
+        RecWriter w(MPI_COMM_SELF, file_name, sels, 2, compress);
+        ASSERT_EQ(5u, w.countColumns());
+        w.setColumns({0, 1, 2, 3, 4});
+        for (uint s = 0; s < 5; ++s) {
+            double values[5];
+            for (uint c = 0; c < 5; ++c) values[c] = sample_value(c, s);
+            w.sample(0.1 * s, values);
+        }
+        w.close();
+    }
+
+    std::vector<char> buf = read_file(file_name);
+    std::remove(file_name.c_str());
+    ASSERT_GE(buf.size(), sizeof(RecHeader));
+    RecHeader h = read_at<RecHeader>(buf, 0);
+    EXPECT_EQ(0, std::memcmp(h.magic + 1, "STEPSRC", 7));
+    EXPECT_EQ(2u, h.nselections);
+    EXPECT_EQ(5u, h.ncolumns);
+    EXPECT_EQ(compress ? uint32_t(REC_FLAG_DELTA_VARINT) : 0u, h.flags);
+
+    RecSelectionInfo si = read_at<RecSelectionInfo>(buf, sizeof(RecHeader));
+    EXPECT_EQ(uint32_t(REC_ELEM_TET), si.kind);
+    EXPECT_EQ(2u, si.nspecs);
+    EXPECT_EQ(2u, si.nelems);
+    EXPECT_EQ(3u, read_at<uint32_t>(buf, sizeof(RecHeader) + sizeof(RecSelectionInfo)));
+
+    uint64_t pos = h.dataOffset;
+    uint s0 = 0;
+    std::vector<uint> chunk_sizes;
+    while (pos < buf.size()) {
+        RecChunkHeader ch = read_at<RecChunkHeader>(buf, pos);
+        chunk_sizes.push_back(ch.nsamples);
+        uint64_t times = pos + sizeof(RecChunkHeader);
+        uint64_t index = times + ch.nsamples * sizeof(double);
+        uint64_t data = index + h.ncolumns * sizeof(RecColumnInfo);
+        for (uint s = 0; s < ch.nsamples; ++s)
+            EXPECT_DOUBLE_EQ(0.1 * (s0 + s), read_at<double>(buf, times + s * sizeof(double)));
+
+        for (uint c = 0; c < h.ncolumns; ++c) {
+            RecColumnInfo ci = read_at<RecColumnInfo>(buf, index + c * sizeof(RecColumnInfo));
+            uint64_t p = data + ci.offset;
+            int64_t last = 0;
+            for (uint s = 0; s < ch.nsamples; ++s) {
+                double v;
+                if (compress) {
+                    uint64_t z = 0;
+                    uint shift = 0;
+                    unsigned char b;
+                    do {
+                        b = buf[p++];
+                        z |= uint64_t(b & 0x7f) << shift;
+                        shift += 7;
+                    } while (b >= 0x80);
+                    last += int64_t(z >> 1) ^ -int64_t(z & 1);
+                    v = last;
+                }
+                else {
+                    v = read_at<double>(buf, p);
+                    p += sizeof(double);
+                }
+                EXPECT_DOUBLE_EQ(sample_value(c, s0 + s), v);
+            }
+            EXPECT_EQ(data + ci.offset + ci.size, p);
+        }
+        s0 += ch.nsamples;
+        pos = data + ch.dataSize;
+    }
+    EXPECT_EQ(buf.size(), pos);
+    EXPECT_EQ(std::vector<uint>({2, 2, 1}), chunk_sizes);
+}
+
+TEST(RecFile, Doubles) {
+    check_recording(false);
+}
+
+TEST(RecFile, DeltaVarints) {
+    check_recording(true);
+}
+
+TEST(RecFile, Columns) {
+    std::vector<RecSelection> sels = sample_selections();
+    RecWriter w(MPI_COMM_SELF, "test_recfile_cols.rec", sels, 4, false);
+    EXPECT_THROW(w.setColumns({1, 0}), steps::ArgErr);
+    EXPECT_THROW(w.setColumns({5}), steps::ArgErr);
+    w.close();
+    std::remove("test_recfile_cols.rec");
+}
@@ -0,0 +1,90 @@
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "steps/mpi/tetopsplit/remotechanges.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace steps::mpi::tetopsplit;
+
+namespace {
+
+// the (slot, change) pairs seen by decodeRemoteChanges
+std::vector<std::pair<uint, uint>> decode(std::vector<unsigned char> const & buf, uint nslots) {
+    std::vector<std::pair<uint, uint>> out;
+    decodeRemoteChanges(&buf.front(), buf.size(), nslots,
+                        [&out](uint s, uint v) { out.emplace_back(s, v); });
+    return out;
+}
+
+std::vector<std::pair<uint, uint>> nonzero(std::vector<uint> const & changes) {
+    std::vector<std::pair<uint, uint>> out;
+    for (uint s = 0; s < changes.size(); ++s)
+        if (changes[s] != 0) out.emplace_back(s, changes[s]);
+    return out;
+}
+
+}
+
+TEST(RemoteChanges, Varint) {
+    const uint values[] = {0u, 1u, 127u, 128u, 16383u, 16384u,
+                           std::numeric_limits<uint>::max(),
+                           static_cast<uint>(-1), static_cast<uint>(-128)};
+    const size_t sizes[] = {1, 1, 1, 2, 2, 3, 5, 5, 5};
+
+    std::vector<unsigned char> buf;
+    for (uint v: values) putVarint(buf, v);
+
+    unsigned char const * p = &buf.front();
+    for (uint i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        unsigned char const * start = p;
+        ASSERT_EQ(getVarint(p), values[i]);
+        ASSERT_EQ(static_cast<size_t>(p - start), sizes[i]);
+    }
+    ASSERT_EQ(p, &buf.front() + buf.size());
+}
+
+TEST(RemoteChanges, SparseRoundTrip) {
+    // A few changes among many slots, with skips that need one and two
+    // bytes and changes at both ends.
+    std::vector<uint> changes(1000, 0);
+    changes[0] = 1;
+    changes[127] = 127;
+    changes[128] = 128;
+    changes[300] = std::numeric_limits<uint>::max();
+    changes[500] = static_cast<uint>(-3);
+    changes[999] = static_cast<uint>(-1);
+
+    std::vector<unsigned char> buf;
+    encodeRemoteChanges(changes, buf);
+    ASSERT_EQ(buf[0], REMOTE_CHANGES_SPARSE);
+    ASSERT_LT(buf.size(), 1 + changes.size() * sizeof(uint));
+    ASSERT_EQ(decode(buf, changes.size()), nonzero(changes));
+}
+
+TEST(RemoteChanges, RawRoundTrip) {
+    // Every slot changed by a large or negative amount is shorter raw.
+    std::vector<uint> changes(64);
+    for (uint s = 0; s < changes.size(); ++s)
+        changes[s] = (s % 2) ? static_cast<uint>(-int(s)) : std::numeric_limits<uint>::max() - s;
+
+    std::vector<unsigned char> buf;
+    encodeRemoteChanges(changes, buf);
+    ASSERT_EQ(buf[0], REMOTE_CHANGES_RAW);
+    ASSERT_EQ(buf.size(), 1 + changes.size() * sizeof(uint));
+    ASSERT_EQ(decode(buf, changes.size()), nonzero(changes));
+}
+
+TEST(RemoteChanges, Empty) {
+    std::vector<uint> changes(10, 0);
+    std::vector<unsigned char> buf;
+    encodeRemoteChanges(changes, buf);
+    ASSERT_EQ(buf.size(), 1u);
+    ASSERT_TRUE(decode(buf, changes.size()).empty());
+
+    changes.clear();
+    encodeRemoteChanges(changes, buf);
+    ASSERT_EQ(buf.size(), 1u);
+    ASSERT_TRUE(decode(buf, 0).empty());
+}
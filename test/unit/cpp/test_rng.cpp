@@ -172,3 +172,60 @@ TEST(rng, kendall_r123) {
     kendall_rank_correlation_check("r123", 1000, 0.95, 1, 2);
 }
 
+
+
+/// Sample mean and variance of batched binomials against t p and t p (1 - p)
+void binomials_check(const std::string &str, uint t, double p, const uint n_sample) {
+    RNG* rng = create(str, n_sample);
+    rng->initialize(12345u);
+
+    std::vector<uint>   vec_t(n_sample, t);
+    std::vector<double> vec_p(n_sample, p);
+    std::vector<uint>   vec_k(n_sample);
+    rng->getBinoms(n_sample, vec_t.data(), vec_p.data(), vec_k.data());
+
+    double mean = 0.0;
+    for (uint k: vec_k) {
+        ASSERT_LE(k, t);
+        mean += k;
+    }
+    mean /= n_sample;
+    double var = 0.0;
+    for (uint k: vec_k) var += (k - mean) * (k - mean);
+    var /= n_sample - 1;
+
+    /// Five standard errors of the mean, and a loose bound on the variance
+    const double exp_var = t * p * (1 - p);
+    ASSERT_NEAR(mean, t * p, 5.0 * std::sqrt(exp_var / n_sample));
+    ASSERT_NEAR(var, exp_var, 0.1 * exp_var);
+
+    delete rng;
+}
+
+TEST(rng, binomials_mt) {
+    binomials_check("mt19937", 10, 0.3, 100000);
+    binomials_check("mt19937", 40, 0.9, 100000);    /// inversion on 1 - p
+    binomials_check("mt19937", 1000, 0.4, 100000);  /// large mean, as getBinom
+}
+
+TEST(rng, binomials_r123) {
+    binomials_check("r123", 10, 0.3, 100000);
+    binomials_check("r123", 40, 0.9, 100000);
+    binomials_check("r123", 1000, 0.4, 100000);
+}
+
+TEST(rng, binomials_edge) {
+    RNG* rng = create("mt19937", 100);
+    rng->initialize(1u);
+
+    const uint   t[4] = {0, 7, 7, 3};
+    const double p[4] = {0.5, 0.0, 1.0, 0.2};
+    uint k[4];
+    rng->getBinoms(4, t, p, k);
+    ASSERT_EQ(k[0], 0u);
+    ASSERT_EQ(k[1], 0u);
+    ASSERT_EQ(k[2], 7u);
+    ASSERT_LE(k[3], 3u);
+
+    delete rng;
+}
@@ -0,0 +1,44 @@
+#include <vector>
+
+#include "steps/solver/sparsestoich.hpp"
+
+#include "gtest/gtest.h"
+
+using steps::solver::SparseStoich;
+
+TEST(SparseStoich, MatchesDenseRows) {
+    const uint nrules = 3, nspecs = 5;
+    const int dense[nrules * nspecs] = {
+        0, -1,  0, 2,  0,
+        0,  0,  0, 0,  0,
+        1,  0, -2, 0, -1
+    };
+
+    SparseStoich<int> sp;
+    sp.build(dense, nrules, nspecs);
+    ASSERT_EQ(sp.countRules(), nrules);
+
+    for (uint r = 0; r < nrules; ++r) {
+        std::vector<int> row(nspecs, 0);
+        uint last = 0, n = 0;
+        for (auto const & e: sp[r]) {
+            ASSERT_LT(e.idx, nspecs);
+            if (n > 0) ASSERT_GT(e.idx, last);
+            ASSERT_NE(e.coef, 0);
+            row[e.idx] = e.coef;
+            last = e.idx;
+            ++n;
+        }
+        for (uint s = 0; s < nspecs; ++s) ASSERT_EQ(row[s], dense[r * nspecs + s]);
+    }
+    ASSERT_TRUE(sp[1].empty());
+}
+
+TEST(SparseStoich, NullTableGivesEmptyRules) {
+    SparseStoich<uint> sp;
+    ASSERT_EQ(sp.countRules(), 0u);
+
+    sp.build(0, 4, 7);
+    ASSERT_EQ(sp.countRules(), 4u);
+    for (uint r = 0; r < 4; ++r) ASSERT_TRUE(sp[r].empty());
+}
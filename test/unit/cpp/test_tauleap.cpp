@@ -0,0 +1,109 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "steps/error.hpp"
+#include "steps/tetexact/diff.hpp"
+#include "steps/tetexact/tet.hpp"
+#include "steps/tetexact/tetexact.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./ab_model.hpp"
+
+using namespace steps;
+
+static const uint NMOLS = 20000;
+
+struct TauLeapTest: public ::testing::Test, public ABModel {
+    std::unique_ptr<tetexact::Tetexact> sim;
+
+    virtual void SetUp() {
+        sim.reset(new tetexact::Tetexact(mdl.get(), mesh.get(), r.get(), 0));
+        sim->setCompCount("comp", "A", NMOLS);
+    }
+};
+
+TEST_F(TauLeapTest, parameters) {
+    ASSERT_FALSE(sim->getTauLeaping());
+    ASSERT_DOUBLE_EQ(sim->getTauLeapEpsilon(), 0.03);
+    ASSERT_EQ(sim->getTauLeapCriticalCount(), 10);
+
+    sim->setTauLeapEpsilon(0.05);
+    ASSERT_DOUBLE_EQ(sim->getTauLeapEpsilon(), 0.05);
+    ASSERT_THROW(sim->setTauLeapEpsilon(0.0), steps::ArgErr);
+    ASSERT_THROW(sim->setTauLeapEpsilon(1.5), steps::ArgErr);
+
+    sim->setTauLeaping(true);
+    ASSERT_TRUE(sim->getTauLeaping());
+    ASSERT_THROW(sim->setNumDomains(2), steps::ArgErr);
+}
+
+TEST_F(TauLeapTest, equilibrium) {
+    sim->setTauLeaping(true);
+    sim->run(1.0);
+
+    double a = sim->getCompCount("comp", "A");
+    double b = sim->getCompCount("comp", "B");
+    ASSERT_DOUBLE_EQ(a + b, NMOLS);
+
+    // Binomial equilibrium of A <-> B, with a generous margin for the
+    // leaping error.
+    double mean = NMOLS * 5.0 / 15.0;
+    double sd = std::sqrt(NMOLS * (5.0 / 15.0) * (10.0 / 15.0));
+    ASSERT_NEAR(a, mean, 6.0 * sd);
+
+    // Most events are leaped; the extents account for every event.
+    ulong nleaped = sim->getNLeapedEvents();
+    ulong nexact = sim->getNExactEvents();
+    ASSERT_GT(nleaped, nexact);
+    ASSERT_EQ(nleaped + nexact, sim->getNSteps());
+    ASSERT_EQ(sim->getCompReacExtent("comp", "fwd") - sim->getCompReacExtent("comp", "rev"),
+              NMOLS - a);
+
+    sim->reset();
+    ASSERT_EQ(sim->getNLeapedEvents(), 0);
+    ASSERT_EQ(sim->getNExactEvents(), 0);
+}
+
+TEST_F(TauLeapTest, small_counts) {
+    // With few molecules every kproc is critical or too slow to leap,
+    // so the run has to fall back to exact steps.
+    sim->setCompCount("comp", "A", 5);
+    sim->setTauLeaping(true);
+    sim->run(1.0);
+
+    ASSERT_DOUBLE_EQ(sim->getCompCount("comp", "A") + sim->getCompCount("comp", "B"), 5);
+    ASSERT_GT(sim->getNExactEvents(), 0);
+    ASSERT_EQ(sim->getNLeapedEvents() + sim->getNExactEvents(), sim->getNSteps());
+}
+
+TEST_F(TauLeapTest, boundary_leap) {
+    // Leaped diffusions out of tets on the mesh boundary only move
+    // molecules to neighbours that exist, and conserve them.
+    uint nboundary = 0;
+    std::vector<tetexact::PoolChange> changes;
+    for (uint t = 0; t < mesh->countTets(); ++t) {
+        tetexact::Tet *tet = sim->_tet(t);
+        uint missing = 0;
+        for (uint i = 0; i < 4; ++i)
+            if (tet->nextTet(i) == 0) missing |= (1u << i);
+        if (missing == 0) continue;
+        ++nboundary;
+
+        tetexact::Diff *diff = tet->diff(0);
+        for (uint n = 0; n < 20; ++n) {
+            changes.clear();
+            uint rows = diff->leap(r.get(), 1000, changes);
+            ASSERT_EQ(rows & missing, 0u);
+
+            long net = 0;
+            for (auto const & c: changes) {
+                ASSERT_NE(c.pool, nullptr);
+                net += c.change;
+            }
+            ASSERT_EQ(net, 0);
+        }
+    }
+    ASSERT_GT(nboundary, 0u);
+}
@@ -0,0 +1,137 @@
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "steps/init.hpp"
+#include "steps/error.hpp"
+#include "steps/geom/tetmesh.hpp"
+#include "steps/geom/tetmesh_partition.hpp"
+#include "steps/geom/tmcomp.hpp"
+#include "steps/geom/tmpatch.hpp"
+#include "steps/model/diff.hpp"
+#include "steps/model/model.hpp"
+#include "steps/model/reac.hpp"
+#include "steps/model/spec.hpp"
+#include "steps/model/sreac.hpp"
+#include "steps/model/surfsys.hpp"
+#include "steps/model/volsys.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./cube_mesh.hpp"
+
+using namespace steps;
+
+// Unit cube of n x n x n cells of 6 tets each, split at x = 1/2 into two
+// compartments with a patch between them.
+struct TetmeshPartitionTest: public ::testing::Test {
+    static const uint n = 8;
+
+    std::unique_ptr<model::Model> mdl;
+    std::unique_ptr<tetmesh::Tetmesh> mesh;
+    std::vector<uint> patch_tris;
+
+    virtual void SetUp() {
+        steps::init();
+
+        mdl.reset(new model::Model());
+        model::Spec *A = new model::Spec("A", mdl.get());
+        model::Spec *B = new model::Spec("B", mdl.get());
+        model::Volsys *vsys = new model::Volsys("vsys", mdl.get());
+        new model::Reac("fwd", vsys, {A}, {B}, 10.0);
+        new model::Diff("diffA", vsys, A, 1e-12);
+        model::Surfsys *ssys = new model::Surfsys("ssys", mdl.get());
+        new model::SReac("bind", ssys, {A}, {}, {}, {B}, {}, {}, 1.0);
+
+        CubeMesh cube(n, 1.0 / n);
+        std::vector<uint> left, right;
+        for (uint t = 0; t < cube.countTets(); ++t)
+            ((cube.tetCellI(t) < int(n / 2)) ? left : right).push_back(t);
+        mesh.reset(new tetmesh::Tetmesh(cube.verts, cube.tets));
+
+        tetmesh::TmComp *inner = new tetmesh::TmComp("inner", mesh.get(), left);
+        inner->addVolsys("vsys");
+        tetmesh::TmComp *outer = new tetmesh::TmComp("outer", mesh.get(), right);
+        outer->addVolsys("vsys");
+
+        for (uint tri = 0; tri < mesh->countTris(); ++tri) {
+            const int *tn = mesh->_getTriTetNeighb(tri);
+            if (tn[0] < 0 || tn[1] < 0) continue;
+            if (mesh->getTetComp(tn[0]) != mesh->getTetComp(tn[1])) patch_tris.push_back(tri);
+        }
+        tetmesh::TmPatch *patch = new tetmesh::TmPatch("patch", mesh.get(), patch_tris, inner, outer);
+        patch->addSurfsys("ssys");
+    }
+};
+
+TEST_F(TetmeshPartitionTest, balanced) {
+    const uint nparts = 5;
+    std::vector<uint> parts = tetmesh::partitionTets(mesh.get(), nparts);
+    ASSERT_EQ(parts.size(), mesh->countTets());
+
+    std::vector<uint> sizes(nparts, 0);
+    for (uint p: parts) {
+        ASSERT_LT(p, nparts);
+        ++sizes[p];
+    }
+    for (uint s: sizes) {
+        ASSERT_GT(s, 0);
+        ASSERT_LE(s, 1.1 * mesh->countTets() / nparts);
+    }
+
+    // Far fewer tris are cut than by random assignment.
+    uint cut = 0;
+    uint ninterior = 0;
+    for (uint tri = 0; tri < mesh->countTris(); ++tri) {
+        const int *tn = mesh->_getTriTetNeighb(tri);
+        if (tn[0] < 0 || tn[1] < 0) continue;
+        ++ninterior;
+        if (parts[tn[0]] != parts[tn[1]]) ++cut;
+    }
+    ASSERT_LT(cut, ninterior / 4);
+
+    ASSERT_EQ(parts, tetmesh::partitionTets(mesh.get(), nparts));
+}
+
+TEST_F(TetmeshPartitionTest, patchTris) {
+    std::vector<uint> parts = tetmesh::partitionTets(mesh.get(), 4);
+    std::map<uint, uint> tri_parts = tetmesh::partitionTris(mesh.get(), parts);
+    ASSERT_EQ(tri_parts.size(), patch_tris.size());
+    for (uint tri: patch_tris) {
+        const int *tn = mesh->_getTriTetNeighb(tri);
+        ASSERT_EQ(parts[tn[0]], parts[tn[1]]);
+        ASSERT_EQ(tri_parts[tri], parts[tn[0]]);
+    }
+}
+
+TEST_F(TetmeshPartitionTest, weights) {
+    std::vector<double> tet_weights, tri_weights;
+    tetmesh::partitionWeights(mesh.get(), mdl.get(), tet_weights, tri_weights);
+    ASSERT_EQ(tet_weights.size(), mesh->countTets());
+    ASSERT_EQ(tri_weights.size(), mesh->countTris());
+
+    // Two processes per tet, one more for the tets next to the patch.
+    std::vector<uint> npatch(mesh->countTets(), 0);
+    for (uint tri: patch_tris) {
+        const int *tn = mesh->_getTriTetNeighb(tri);
+        ++npatch[(tn[0] >= 0) ? tn[0] : tn[1]];
+    }
+    for (uint t = 0; t < mesh->countTets(); ++t)
+        ASSERT_DOUBLE_EQ(tet_weights[t], 2.0 + npatch[t]);
+
+    std::vector<uint> parts = tetmesh::partitionTets(mesh.get(), 3, tet_weights, tri_weights);
+    std::vector<double> loads(3, 0.0);
+    double total = 0.0;
+    for (uint t = 0; t < parts.size(); ++t) {
+        loads[parts[t]] += tet_weights[t];
+        total += tet_weights[t];
+    }
+    for (double l: loads) ASSERT_LE(l, 1.1 * total / 3);
+}
+
+TEST_F(TetmeshPartitionTest, badArgs) {
+    ASSERT_THROW(tetmesh::partitionTets(mesh.get(), 0), steps::ArgErr);
+    ASSERT_THROW(tetmesh::partitionTets(mesh.get(), 2, std::vector<double>(3, 1.0)), steps::ArgErr);
+    ASSERT_THROW(tetmesh::partitionTets(mesh.get(), 2, {}, {}, 0.5), steps::ArgErr);
+    ASSERT_THROW(tetmesh::partitionTris(mesh.get(), std::vector<uint>(3, 0)), steps::ArgErr);
+}
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "steps/solver/efield/tetmesh.hpp"
+
+#include "gtest/gtest.h"
+
+#include "./cube_mesh.hpp"
+
+using namespace steps::solver::efield;
+
+// The cube with the vertices numbered at random.
+struct ScrambledCube: public CubeMesh {
+    explicit ScrambledCube(int n)
+    : CubeMesh(n, 1.0, true)
+    {
+        uint a = vert(0, 0, 0), b = vert(1, 0, 0), c = vert(1, 1, 0);
+        tris = {a, b, c};
+    }
+
+    TetMesh *ordered(uint opt_method) {
+        TetMesh *mesh = new TetMesh(countVerts(), verts.data(), tris.size() / 3, tris.data(),
+                                    countTets(), tets.data());
+        mesh->extractConnections();
+        mesh->axisOrderElements(opt_method);
+        return mesh;
+    }
+
+    std::vector<uint> tris;
+};
+
+static bool is_permutation(std::vector<uint> p) {
+    std::sort(p.begin(), p.end());
+    for (uint i = 0; i < p.size(); ++i)
+        if (p[i] != i) return false;
+    return true;
+}
+
+TEST(VertexOrdering, ReverseCuthillMcKee) {
+    ScrambledCube cube(8);
+    std::unique_ptr<TetMesh> keep(cube.ordered(0));
+    std::unique_ptr<TetMesh> axis(cube.ordered(1));
+    std::unique_ptr<TetMesh> rcm(cube.ordered(3));
+
+    EXPECT_TRUE(is_permutation(rcm->getVertexPermutation()));
+    EXPECT_LT(rcm->halfBandwidth(), axis->halfBandwidth());
+    EXPECT_LT(rcm->profile(), axis->profile());
+    EXPECT_LT(4 * rcm->profile(), keep->profile());
+
+    // Triangles follow the vertices.
+    std::vector<uint> perm = rcm->getVertexPermutation();
+    for (uint v = 0; v < 3; ++v)
+        EXPECT_EQ(perm[cube.tris[v]], rcm->getTriangleVertex(0, v));
+}
+
+TEST(VertexOrdering, NestedDissection) {
+    ScrambledCube cube(8);
+    std::unique_ptr<TetMesh> nd(cube.ordered(4));
+
+    EXPECT_TRUE(is_permutation(nd->getVertexPermutation()));
+    // The last separator, ordered last, splits the cube in two: its
+    // vertices have neighbours among the first and the last of the rest.
+    EXPECT_GT(nd->halfBandwidth(), nd->countVertices() / 4);
+}